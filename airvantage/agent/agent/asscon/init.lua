@@ -181,6 +181,8 @@ function connectionhandler(skt)
             end
         end
     end
+    -- assets may have several EMP requests in progress: don't delay the small responses
+    skt:setoption("tcp-nodelay", true)
     -- create and configure emp
     local emp = require "racon.empparser"
     local instance = emp.new(skt)
@@ -34,7 +34,16 @@ local M = { }
 
 global 'agent'; agent.srvcon = M
 
-local m3da_deserialize = require "m3da.bysant".deserializer()
+local m3da             = require "m3da.bysant"
+local m3da_deserialize = m3da.deserializer()
+
+-- Field names of the standard M3DA classes, indexed by class name.
+local m3da_fields = { }
+for _, classdef in ipairs(m3da.classes) do
+    local names = { }
+    for i, field in ipairs(classdef) do names[i] = field.name end
+    m3da_fields[classdef.name] = names
+end
 
 
 -- hook that is set to nil by default: if non nil this function is called prior to doing the connexion
@@ -46,44 +55,121 @@ M.preconnecthook = false
 -- the agent's config.
 M.session = nil
 
--- Dispatch deserialized server messages to the appropriate assets through EMP.
-local function dispatch_message(envelope_payload)
+-- Abort the dispatching of a truncated payload.
+local function truncated()
+    error("truncated server message")
+end
 
-    if not envelope_payload or #envelope_payload <= 0 then return 'ok' end
+-- Deserialize the next field of the object being read in `payload`.
+-- Returns the field value and the next offset, or `nil` and the offset after the
+-- object's closing when there is no field left.
+local function read_field(payload, offset)
+    local value, nextoffset = m3da_deserialize(payload, offset)
+    if not tonumber(nextoffset) then truncated() end
+    return value, nextoffset
+end
+
+-- Skip the rest of a container whose opening token has already been read,
+-- return the offset after its closing.
+local function skip_container(payload, offset)
+    local depth, t = 1
+    repeat
+        offset, t = m3da_deserialize:read(payload, offset)
+        if not offset then truncated() end
+        if t == 'close' then depth = depth - 1
+        elseif t == 'list' or t == 'map' or t == 'object' or t == 'chunked' then depth = depth + 1 end
+    until depth == 0
+    return offset
+end
+
+-- Deserialize the remaining fields of an object of class `class`, whose
+-- opening token has already been read.
+local function read_object(payload, offset, class)
+    local obj, names, i, value = { __class = class }, m3da_fields[class] or { }, 0
+    while true do
+        value, offset = read_field(payload, offset)
+        if value == nil then return obj, offset end
+        i = i + 1
+        obj[names[i] or i] = value
+    end
+end
+
+-- Send a NAK for a server message that could not be delivered.
+local function nak(ticketid, errmsg)
+    if ticketid and ticketid ~= 0 then require('racon').acknowledge(ticketid, false, errmsg, "now", false) end
+end
 
-    --base.global 'last_payload'
-    --base.last_payload = payload
+-- Dispatch the server messages of an envelope payload to the appropriate assets
+-- through EMP. Messages are pulled token by token: the body is only deserialized
+-- once its path has been routed to a registered asset, and skipped otherwise.
+local function dispatch_envelope(envelope_payload)
     local offset = 1
     while offset <= #envelope_payload do
-        local msg
-        msg, offset = m3da_deserialize(envelope_payload, offset)
-        if log.musttrace('SRVCON', 'DEBUG') then log('SRVCON', 'DEBUG', "Received message: [%s]", sprint(msg)) end
-        if msg==nil and tonumber(offset) or msg=='' then
-            log('SRVCON', 'DETAIL', 'Empty message from server')
-        elseif msg.__class == 'Message' then
-            if not msg.body or not next(msg.body) then
-                log("SRVCON", "ERROR", "invalid message: message body is nil or empty, message is rejected")
-                if msg.ticketid and msg.ticketid ~= 0 then require('racon').acknowledge(msg.ticketid, false, "invalid message: message body is nil or empty", "now", false) end
+        local nextoffset, t, _, class, last = m3da_deserialize:read(envelope_payload, offset)
+        if not nextoffset then truncated() end
+        offset = nextoffset
+        if t == 'object' and class == 'Message' then
+            local path, ticketid, body
+            path, offset     = read_field(envelope_payload, offset)
+            ticketid, offset = read_field(envelope_payload, offset)
+            local name = upath.split(path, 1)
+            if not asscon.assets[name] then
+                offset = m3da_deserialize:skip(envelope_payload, offset) or truncated() -- body
+                offset = skip_container(envelope_payload, offset)
+                log("SRVCON", "ERROR", "Failed to dispatch server message to %s: unknown assetid", tostring(path))
+                nak(ticketid, "unknown assetid")
             else
-                local name = upath.split(msg.path, 1)
-                local r, errmsg = asscon.sendcmd(name, "SendData", msg)
-                if not r then
-                    --build and send a NAK to the server through a session+transport
-                    log("SRVCON", "ERROR", "Failed to dispatch server message %s", sprint(msg))
-                    if msg.ticketid and msg.ticketid ~= 0 then require('racon').acknowledge(msg.ticketid, false, errmsg, "now", false) end
+                body, offset = read_field(envelope_payload, offset)
+                offset = skip_container(envelope_payload, offset)
+                local msg = { __class = 'Message', path = path, ticketid = ticketid, body = body }
+                if log.musttrace('SRVCON', 'DEBUG') then log('SRVCON', 'DEBUG', "Received message: [%s]", sprint(msg)) end
+                if type(body) ~= 'table' or not next(body) then
+                    log("SRVCON", "ERROR", "invalid message: message body is nil or empty, message is rejected")
+                    nak(ticketid, "invalid message: message body is nil or empty")
+                else
+                    local r, errmsg = asscon.sendcmd(name, "SendData", msg)
+                    if not r then
+                        --build and send a NAK to the server through a session+transport
+                        log("SRVCON", "ERROR", "Failed to dispatch server message %s", sprint(msg))
+                        nak(ticketid, errmsg)
+                    end
                 end
             end
-         elseif msg.__class == 'Response' then
+        elseif t == 'object' and class == 'Response' then
+            local msg
+            msg, offset = read_object(envelope_payload, offset, class)
             log('SRVCON', 'WARNING', "Received a response %d: %s to ticket %d",
                 msg.status, sprint(msg.data), msg.ticketid)
             log('SRVCON', 'WARNING', "No special handling of responses implemented")
-         else
-            log('SRVCON', 'ERROR', "Received unsupported envelope content: %s",
-                sprint(msg))
+        elseif t == 'object' then
+            local msg
+            msg, offset = read_object(envelope_payload, offset, class)
+            log('SRVCON', 'ERROR', "Received unsupported envelope content: %s", sprint(msg))
+        elseif t == 'list' or t == 'map' or t == 'chunked' then
+            offset = skip_container(envelope_payload, offset)
+            log('SRVCON', 'ERROR', "Received unsupported envelope content: %s", t)
+        elseif t == 'string' and last < class then -- `class` and `last` delimit the string
+            log('SRVCON', 'DETAIL', 'Empty message from server')
+        elseif t ~= 'classdef' then
+            log('SRVCON', 'ERROR', "Received unsupported envelope content: %s", t)
         end
     end
 end
 
+-- Dispatch deserialized server messages, see `dispatch_envelope`.
+local function dispatch_message(envelope_payload)
+
+    if not envelope_payload or #envelope_payload <= 0 then return 'ok' end
+
+    local ok, errmsg = copcall(dispatch_envelope, envelope_payload)
+    if not ok then
+        -- Whatever the error, the deserializer may be left in the middle of a
+        -- message: replace it, so that the next envelope is read from its start.
+        m3da_deserialize = m3da.deserializer()
+        error(errmsg, 0)
+    end
+end
+
 M.sourcefactories = { }
 
 M.pendingcallbacks = { }
@@ -18,6 +18,9 @@
 #include <sys/time.h>
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <arpa/inet.h>
 #include <unistd.h>
 #include <errno.h>
@@ -39,12 +42,14 @@
  * sent, the calling thread is blocked and then awake by the reader thread once the corresponding acknowledgement is received.
  * EMP can also handle command handlers, these callbacks are called when the agent explicity sends a command to an application,
  * typically a notification. The reader thread supports responses associated to a command and real commands coming from the agent.
+ * Each command in progress has its own request identifier, so several commands can be pipelined on the socket, either by
+ * several threads or by a single one using emp_send_request and emp_wait_response.
  *
  *
  * emp_send_and_wait_response:
  *
- * This function sends a command with a specified payload to the agent.
- * Once the command has been sent, the calling thread is blocked on a condition until the corresponding
+ * This function sends a command with a specified payload to the agent. The message header and the payload are sent
+ * with a single sendmsg call, without copying the payload. Once the command has been sent, the calling thread is blocked on a condition until the corresponding
  * response (with ou without payload) is received. For each new command, EMP associates each caller thread to a request identifier (rid).
  * When a message coming from the agent is received EMP wakes up the thread associated with received rid ,
  * if the awakened thread was waiting for this rid, then it quits the function, otherwise it waits on the condition until a new response is received or until
@@ -54,16 +59,18 @@
  *
  * This function is executed in a separated thread, called the reader thread, and waits for message coming from the agent.
  * When a new message is received, its header is completly read and parsed, the command and the payload are then retrieved. The message
- * is dispatched to the application by calling the function reader_dispatch_message.
+ * is dispatched to the application by calling the function reader_dispatch_response or reader_dispatch_command.
+ * Payloads of commands are received in buffers which emp_freemessage keeps for reuse. The extra payload of a response is
+ * received directly in the buffer returned to the caller.
  *
- * reader_dispatch_message:
+ * reader_dispatch_response, reader_dispatch_command:
  *
- * This functions is executed in the reader thread and dispatches the message received from the agent to the corresponding component of the running application.
+ * These functions are executed in the reader thread and dispatch the message received from the agent to the corresponding component of the running application.
  * This component can be either the caller thread  previously blocked on a condition or a software component registered with a command handler to EMP.
- * This functions parses the flags of the last received message to determine if this one is an explicit command sent from the agent to the application,
- * or just a response to a command coming from the application.
  * When the message is a response to a command sent from the application, the associated blocked thread is awake, then the reader thread continue to process new messages.
- * When the message is an explicit command sent by the agent to the application, the associated callback is invoked in a new thread and then detached.
+ * When the message is an explicit command sent by the agent to the application, the associated callback is invoked by one of the idle threads of
+ * the worker pool. When all workers are busy, e.g. waiting for the response to a command they sent, the callback is invoked in a new detached
+ * thread instead, as queueing it could deadlock.
  */
 
 #define EMP_RID_ERROR 0xff
@@ -71,13 +78,27 @@
 #define EMP_RID_ALLOCATED 1
 #define EMP_RID_TIMEDOUT 2
 
+#define EMP_DEFAULT_WORKERS 4
+#define EMP_MIN_BUFFER_SIZE 256 // smaller receive buffers are not allocated, to ease their reuse
+#define EMP_MAX_POOLED_SIZE 4096 // bigger receive buffers are not kept for reuse
+
+// Receive buffer header, the payload follows it
+typedef struct emp_buffer_s
+{
+  struct emp_buffer_s *next; // next free buffer
+  uint32_t capacity;
+} emp_buffer_t;
+
 static EmpParser *parser;
+// Set in a thread that destroyed the parser, so that a command handler running in a worker thread can
+// destroy it: the worker then neither replies to the command nor touches the parser any more.
+static __thread int parserDestroyed;
 
 #define min(a,b) (a) < (b) ? (a) : (b)
 
-static rc_ReturnCode_t reader_dispatch_message(EmpCommand command, uint32_t rid, uint8_t type, char* payload,
-    uint32_t payloadsize);
-static rc_ReturnCode_t ipc_send(const char* payload, uint32_t payloadsize);
+static void reader_dispatch_response(uint8_t rid, rc_ReturnCode_t status, char* payload, uint32_t payloadsize);
+static rc_ReturnCode_t reader_dispatch_command(EmpCommand command, uint8_t rid, char* payload, uint32_t payloadsize);
+static rc_ReturnCode_t ipc_send(const unsigned char* header, const char* payload, uint32_t payloadsize);
 static uint32_t ipc_read(char* buffer, uint32_t size);
 static void reader_emp_parse();
 static rc_ReturnCode_t emp_sendmessage(EmpCommand command, uint8_t type, uint8_t* rid, const char* payload,
@@ -85,6 +106,8 @@ static rc_ReturnCode_t emp_sendmessage(EmpCommand command, uint8_t type, uint8_t
 
 static rc_ReturnCode_t emp_addCmdHandler(EmpCommand cmd, emp_command_hdl_t h);
 static rc_ReturnCode_t emp_removeCmdHandler(EmpCommand cmd);
+static rc_ReturnCode_t start_workers();
+static void stop_workers();
 static struct sockaddr_in agent_addr;
 
 #ifdef __ARMEL__
@@ -103,28 +126,35 @@ static inline int compare_and_swap(volatile int *ptr, int oldval, int newval)
 #endif
 
 // Allocating atomically a bit fields representing available slots (lockfree)
+// The swap only succeeds if no other thread changed the bitfield since it was read, otherwise it is retried.
 static uint8_t atomic_rid_lookup()
 {
-  uint8_t i = 0, j = 0, idx = 0;
-  for (i = 0; i < 64; i++)
+  int32_t bits;
+  uint8_t idx = 0, j = 0;
+  for (idx = 0; idx < 2; idx++)
   {
-    idx = (i >= 32);
-    j = i % 32;
-    if ( ( ( compare_and_swap(&parser->ridBitfields[idx], parser->ridBitfields[idx], parser->ridBitfields[idx] | (1 << j)) >> j ) & 0x1 ) == 0)
-      return i;
+    while ((bits = parser->ridBitfields[idx]) != -1)
+    {
+      j = ffs(~bits) - 1;
+      if (compare_and_swap(&parser->ridBitfields[idx], bits, bits | (int32_t)(1u << j)) == bits)
+        return idx * 32 + j;
+    }
   }
   return 255;
 }
 
 static void freerequestid(uint8_t rid)
 {
+  int32_t bits;
   uint8_t idx = 0, i = 0;
 
   idx = (rid >= 32);
   i = rid % 32;
   sem_destroy(&parser->commandInProgress[rid].respSem);
   bzero(parser->commandInProgress + rid, sizeof(emp_command_ctx_t));
-  compare_and_swap(&parser->ridBitfields[idx], parser->ridBitfields[idx], parser->ridBitfields[idx] & ~(1 << i));
+  do
+    bits = parser->ridBitfields[idx];
+  while (compare_and_swap(&parser->ridBitfields[idx], bits, bits & ~(int32_t)(1u << i)) != bits);
   SWI_LOG("EMP", DEBUG, "%s: freed rid = %u\n", __FUNCTION__, rid);
 }
 
@@ -143,7 +173,6 @@ static rc_ReturnCode_t emp_sendmessage(EmpCommand command, uint8_t type, uint8_t
 {
   unsigned char header[8];
   rc_ReturnCode_t res;
-  uint8_t *buffer;
 
   if (parser->sockfd == -1)
     return RC_COMMUNICATION_ERROR;
@@ -172,36 +201,74 @@ static rc_ReturnCode_t emp_sendmessage(EmpCommand command, uint8_t type, uint8_t
   header[6] = (payloadsize >> 8) & 0xff;
   header[7] = payloadsize & 0xff;
 
-
-  buffer = malloc (8 + payloadsize);
-  if (buffer == NULL)
-  {
-    res = RC_NO_MEMORY;
-    goto quit;
-  }
-  memcpy(buffer, header, 8);
-  memcpy(buffer + 8, payload, payloadsize);
-
-  //now send the payload
+  //now send the header and the payload
   SWI_LOG("EMP", DEBUG, "%s: [%d] Sending message\n", __FUNCTION__, *rid);
-  res = ipc_send((const char *)buffer, 8+payloadsize);
+  res = ipc_send(header, payload, payloadsize);
 
-quit:
-  if (res != RC_OK)
+  // only free the rid allocated for a new Command, not the one of the Command being answered
+  if (res != RC_OK && (type & 1) == 0)
     freerequestid(*rid);
   SWI_LOG("EMP", DEBUG, "%s: [%d] exiting with res %d\n", __FUNCTION__, *rid, res);
-  free(buffer);
   return res;
 }
 
+/*
+ * Returns a buffer of at least size bytes, to be released by emp_freemessage.
+ * Buffers previously released are reused when possible.
+ */
+static char *emp_allocmessage(uint32_t size)
+{
+  emp_buffer_t *buf, **prev;
+
+  pthread_mutex_lock(&parser->bufferLock);
+  for (prev = &parser->freeBuffers; *prev && (*prev)->capacity < size; prev = &(*prev)->next)
+    ;
+  buf = *prev;
+  if (buf)
+  {
+    *prev = buf->next;
+    parser->nbFreeBuffers--;
+  }
+  pthread_mutex_unlock(&parser->bufferLock);
+
+  if (buf == NULL)
+  {
+    uint32_t capacity = size < EMP_MIN_BUFFER_SIZE ? EMP_MIN_BUFFER_SIZE : size;
+    buf = malloc(sizeof(*buf) + capacity);
+    if (buf == NULL)
+      return NULL;
+    buf->capacity = capacity;
+  }
+  return (char *)(buf + 1);
+}
+
+/*
+ * Reads exactly size bytes from the socket, or discards them if buffer is NULL.
+ * @return 0 if the connection was lost, 1 otherwise
+ */
+static int ipc_read_all(char *buffer, uint32_t size)
+{
+  char discarded[64];
+
+  while (size > 0)
+  {
+    uint32_t need = buffer ? size : min(size, sizeof(discarded));
+    uint32_t got = ipc_read(buffer ? buffer : discarded, need);
+    if (got == 0)
+      return 0;
+    if (buffer)
+      buffer += got;
+    size -= got;
+  }
+  return 1;
+}
+
 /*
  * used in reader thread
  */
 static void reader_emp_parse()
 {
   uint8_t  header[8]; // EMP header buffer (always 8 bytes long)
-  uint32_t hcnt = 0; // EMP header received bytes
-  uint32_t dcnt = 0; // EMP payload received bytes
   uint32_t dlen = 0;  // EMP payload size
   uint8_t  type = 0; // EMP command type (Command or Response)
   uint8_t  rid = 0; // EMP Request ID
@@ -214,15 +281,8 @@ static void reader_emp_parse()
   SWI_LOG("EMP", DEBUG, "%s: start\n", __FUNCTION__);
 
   // Receiving header of the message
-  do
-  {
-    uint32_t size, need;
-    need = 8 - hcnt;
-    size = ipc_read((char*) header + hcnt, need);
-    if (size == 0)
-      return;
-    hcnt += size;
-  } while (hcnt < 8);
+  if (!ipc_read_all((char *) header, sizeof(header)))
+    return;
 
   command = ((uint16_t) header[0] << 8) + header[1];
   type = header[2];
@@ -233,45 +293,89 @@ static void reader_emp_parse()
   SWI_LOG("EMP", DEBUG, "%s: new header! command=[%d], type=[%d], rid=[%d], dlen=[%d]\n",
       __FUNCTION__, command, type, rid, dlen);
 
-  // If a payload is found in the message, allocating buffer
-  if (dlen)
+  if (type) // that'is a response
   {
-    data = malloc(dlen + 8);
-    if (data == NULL)
+    uint8_t status[2]; // command status is transmitted as a big endian signed short
+    rc_ReturnCode_t res = RC_OK;
+
+    //status must always be in response
+    if (dlen < 2)
     {
-      SWI_LOG("EMP", ERROR, "Failed to alloc data for the received message\n");
+      SWI_LOG("EMP", ERROR, "%s: Response for rid[%d], payloadsize = %d, error: payload too small to get error\n",
+          __FUNCTION__, rid, dlen);
+      if (!ipc_read_all(NULL, dlen))
+        return;
+      //setting default status, might not be the perfect value:
+      reader_dispatch_response(rid, RC_UNSPECIFIED_ERROR, NULL, 0);
       return;
     }
-    memcpy(data, header, 8);
-    data += 8;
+    if (!ipc_read_all((char *) status, sizeof(status)))
+      return;
+    dlen -= 2;
 
-    // Receiving payload
-    do
+    // Extra data (in addition to status) is received in the buffer given to the command sender
+    if (dlen)
     {
-      uint32_t need, size;
-      need = dlen - dcnt;
-      size = ipc_read((char *) data + dcnt, need);
-      if (size == 0)
+      data = malloc(dlen);
+      if (data == NULL)
+      {
+        SWI_LOG("EMP", ERROR, "Failed to alloc data for the received message\n");
+        //don't return here: at least the cmd sender will get emp status, but not additional data.
+        res = RC_NO_MEMORY;
+      }
+      if (!ipc_read_all(data, dlen))
+      {
+        free(data);
         return;
-      dcnt += size;
-    } while (dcnt < dlen);
+      }
+    }
+    reader_dispatch_response(rid, res == RC_OK ? (int16_t) (status[0] << 8 | status[1]) : res,
+        data, data ? dlen : 0);
+  }
+  else //that's new emp cmd coming from RA
+  {
+    // If a payload is found in the message, getting a buffer
+    if (dlen)
+    {
+      data = emp_allocmessage(dlen);
+      if (data == NULL)
+      {
+        SWI_LOG("EMP", ERROR, "Failed to alloc data for the received message\n");
+        ipc_read_all(NULL, dlen);
+        return;
+      }
+      if (!ipc_read_all(data, dlen))
+      {
+        emp_freemessage(data);
+        return;
+      }
+    }
+    reader_dispatch_command(command, rid, data, dlen);
   }
-
-  // Dispatching message to upper layers
-  char *dat = data;
-  reader_dispatch_message(command, rid, type, dat, dlen);
-
-  // Clearing data reading state vars
-  data = NULL;
-  hcnt = dcnt = dlen = rid = 0;
 
   SWI_LOG("EMP", DEBUG, "%s: exiting !!!\n", __FUNCTION__);
 }
 
 void emp_freemessage(char *buffer)
 {
-  if (buffer)
-    free(buffer - 8);
+  emp_buffer_t *buf;
+
+  if (buffer == NULL)
+    return;
+  buf = (emp_buffer_t *) buffer - 1;
+  if (parser && buf->capacity <= EMP_MAX_POOLED_SIZE)
+  {
+    pthread_mutex_lock(&parser->bufferLock);
+    if (parser->nbFreeBuffers < EMP_MAX_FREE_BUFFERS)
+    {
+      buf->next = parser->freeBuffers;
+      parser->freeBuffers = buf;
+      parser->nbFreeBuffers++;
+      buf = NULL;
+    }
+    pthread_mutex_unlock(&parser->bufferLock);
+  }
+  free(buf);
 }
 
 static void throw_and_broadcast_err(rc_ReturnCode_t status)
@@ -289,6 +393,14 @@ static void throw_and_broadcast_err(rc_ReturnCode_t status)
   }
 }
 
+// Messages are small and several ones may be in progress: send them without waiting for previous ones to be acked
+static void ipc_setnodelay()
+{
+  int one = 1;
+  if (setsockopt(parser->sockfd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one)))
+    SWI_LOG("EMP", WARNING, "%s: failed to disable Nagle algorithm [%s]\n", __FUNCTION__, strerror(errno));
+}
+
 static int ipc_reconnect()
 {
   int ret = 0, limit = 0, retry = 0, timeout = 0;
@@ -314,6 +426,7 @@ static int ipc_reconnect()
     ret = connect(parser->sockfd, (struct sockaddr*) &agent_addr, sizeof(agent_addr));
     if (ret == 0)
     {
+      ipc_setnodelay();
       pthread_mutex_unlock(&parser->sockLock);
       SWI_LOG("EMP", DEBUG, "%s: success, exiting, sockLock unlocked\n", __FUNCTION__);
       return 0;
@@ -413,6 +526,9 @@ rc_ReturnCode_t emp_parser_init(size_t nbCmds, EmpCommand* cmds, emp_command_hdl
   {
     SWI_LOG("EMP", DEBUG, "%s: No existing parser found, allocating a new one\n", __FUNCTION__);
     parser = calloc(1, sizeof(*parser));
+    pthread_mutex_init(&parser->jobLock, NULL);
+    pthread_cond_init(&parser->jobCond, NULL);
+    pthread_mutex_init(&parser->bufferLock, NULL);
     parser->sockfd = socket(AF_INET, SOCK_STREAM, 0);
     if (parser->sockfd < 0)
     {
@@ -437,6 +553,7 @@ rc_ReturnCode_t emp_parser_init(size_t nbCmds, EmpCommand* cmds, emp_command_hdl
       emp_parser_destroy(nbCmds, cmds, ipcHdlr);
       return RC_COMMUNICATION_ERROR;
     }
+    ipc_setnodelay();
 
     if(pthread_mutex_init(&parser->sockLock, 0)){
       SWI_LOG("EMP", ERROR, "parser mutex lock creation failed [%s]\n", strerror(errno));
@@ -451,6 +568,13 @@ rc_ReturnCode_t emp_parser_init(size_t nbCmds, EmpCommand* cmds, emp_command_hdl
           emp_parser_destroy(nbCmds, cmds, ipcHdlr);
           return RC_UNSPECIFIED_ERROR;
     }
+
+    SWI_LOG("EMP", DEBUG, "%s: Creating worker threads\n", __FUNCTION__);
+    if (start_workers() != RC_OK)
+    {
+      emp_parser_destroy(nbCmds, cmds, ipcHdlr);
+      return RC_UNSPECIFIED_ERROR;
+    }
   }
 
   int i;
@@ -503,8 +627,20 @@ rc_ReturnCode_t emp_parser_destroy(size_t nbCmds, EmpCommand* cmds, emp_ipc_brok
   if (parser->readerThread)
     pthread_join(parser->readerThread, NULL);
 
+  stop_workers();
+  while (parser->freeBuffers)
+  {
+    emp_buffer_t *buf = parser->freeBuffers;
+    parser->freeBuffers = buf->next;
+    free(buf);
+  }
+  pthread_mutex_destroy(&parser->jobLock);
+  pthread_cond_destroy(&parser->jobCond);
+  pthread_mutex_destroy(&parser->bufferLock);
+
   free(parser);
   parser = NULL;
+  parserDestroyed = 1;
   return RC_OK;
 }
 
@@ -530,168 +666,264 @@ static rc_ReturnCode_t emp_removeCmdHandler(EmpCommand cmd)
   return RC_OK;
 }
 
-typedef struct thread_cmd_data
-{
-  EmpCommand command;
-  uint32_t payloadsize;
-  char* payload;
-  uint8_t rid;
-} thread_cmd_data_t;
-
-static void * thread_cmd_routine(void* ud)
+static void run_command(emp_command_job_t *job)
 {
-
-  thread_cmd_data_t* data = (thread_cmd_data_t*) ud;
-  char* payload = data->payload;
-  uint32_t payloadsize = data->payloadsize;
-  EmpCommand command = data->command;
-  uint8_t rid = data->rid;
+  uint8_t rid = job->rid;
   int16_t cmd_status = 0;
 
   SWI_LOG("EMP", DEBUG, "%s: [%d] start\n", __FUNCTION__, rid);
 
-  free(data);
-
-  if (!parser->commandHdlrs[command])
+  if (!parser->commandHdlrs[job->command])
   {
-    SWI_LOG("EMP", ERROR, "no handler set for %d\n", command);
-    pthread_exit(NULL);
+    SWI_LOG("EMP", ERROR, "no handler set for %d\n", job->command);
+    emp_freemessage(job->payload);
+    return;
   }
 
-  rc_ReturnCode_t res = parser->commandHdlrs[command](payloadsize, payload);
+  rc_ReturnCode_t res = parser->commandHdlrs[job->command](job->payloadsize, job->payload);
+  if (parserDestroyed)
+  {
+    SWI_LOG("EMP", DEBUG, "%s: [%d] parser destroyed by the handler, no response sent\n", __FUNCTION__, rid);
+    return;
+  }
   //command status is transmitted as a big endian signed short
   cmd_status = htons(res);
-  emp_sendmessage(command, 1, &rid, (char *)&cmd_status, sizeof(cmd_status));
+  emp_sendmessage(job->command, 1, &rid, (char *)&cmd_status, sizeof(cmd_status));
 
   SWI_LOG("EMP", DEBUG, "%s: [%d] res = %d\n", __FUNCTION__, rid, res);
+}
+
+/*
+ * Runs a command in a dedicated thread, when all the workers are busy.
+ */
+static void * thread_cmd_routine(void* ud)
+{
+  emp_command_job_t* job = (emp_command_job_t*) ud;
+  run_command(job);
+  free(job);
   return NULL;
 }
 
 /*
- * dispatching incoming messages, both new cmds and response.
- * this function runs in reader thread.
+ * This function is executed in the threads of the worker pool
  */
-static rc_ReturnCode_t reader_dispatch_message(EmpCommand command, uint32_t rid, uint8_t type, char* payload,
-    uint32_t payloadsize)
+static void * worker_routine(void* ud)
 {
+  emp_command_job_t job;
 
-  if (type) // that'is a response
+  pthread_mutex_lock(&parser->jobLock);
+  while (1)
   {
-    unsigned char* p;
-    rc_ReturnCode_t status;
-    //status must always be in response
-    if (payloadsize < 2)
+    while (parser->nbJobs == 0 && !parser->stopWorkers)
+      pthread_cond_wait(&parser->jobCond, &parser->jobLock);
+    if (parser->nbJobs == 0)
+      break;
+    job = parser->jobs[parser->firstJob];
+    parser->firstJob = (parser->firstJob + 1) % EMP_MAX_WORKERS;
+    parser->nbJobs--;
+    parser->idleWorkers--;
+    pthread_mutex_unlock(&parser->jobLock);
+
+    run_command(&job);
+    if (parserDestroyed) // by the command handler, this thread has been detached
+      return NULL;
+
+    pthread_mutex_lock(&parser->jobLock);
+    parser->idleWorkers++;
+  }
+  pthread_mutex_unlock(&parser->jobLock);
+  return NULL;
+}
+
+static rc_ReturnCode_t start_workers()
+{
+  char *var = getenv("SWI_EMP_NB_WORKERS");
+  int nbWorkers = var ? atoi(var) : EMP_DEFAULT_WORKERS;
+
+  if (nbWorkers < 0)
+    nbWorkers = 0;
+  if (nbWorkers > EMP_MAX_WORKERS)
+    nbWorkers = EMP_MAX_WORKERS;
+
+  for (parser->nbWorkers = 0; parser->nbWorkers < nbWorkers; parser->nbWorkers++)
+  {
+    if (pthread_create(&parser->workers[parser->nbWorkers], NULL, worker_routine, NULL))
     {
-      SWI_LOG("EMP", ERROR, "%s: Response for rid[%d], payloadsize = %d, error: payload too small to get error\n",
-          __FUNCTION__, rid, payloadsize);
-      //setting default status, might not be the perfect value:
-      status = RC_UNSPECIFIED_ERROR;
+      SWI_LOG("EMP", ERROR, "worker thread creation failed [%s]\n", strerror(errno));
+      return RC_UNSPECIFIED_ERROR;
     }
+    pthread_mutex_lock(&parser->jobLock);
+    parser->idleWorkers++;
+    pthread_mutex_unlock(&parser->jobLock);
+  }
+  return RC_OK;
+}
+
+static void stop_workers()
+{
+  int i;
+
+  pthread_mutex_lock(&parser->jobLock);
+  parser->stopWorkers = 1;
+  pthread_cond_broadcast(&parser->jobCond);
+  pthread_mutex_unlock(&parser->jobLock);
+
+  for (i = 0; i < parser->nbWorkers; i++)
+  {
+    // a command handler may destroy the parser from a worker thread, see parserDestroyed
+    if (pthread_equal(parser->workers[i], pthread_self()))
+      pthread_detach(parser->workers[i]);
     else
+      pthread_join(parser->workers[i], NULL);
+  }
+  parser->nbWorkers = 0;
+}
+
+/*
+ * dispatching incoming responses.
+ * this function runs in reader thread.
+ */
+static void reader_dispatch_response(uint8_t rid, rc_ReturnCode_t status, char* payload, uint32_t payloadsize)
+{
+  SWI_LOG("EMP", DEBUG, "%s: Response for rid[%d], payloadsize = %d, status=%d\n",
+      __FUNCTION__, rid, payloadsize, status);
+
+  if (rid < EMP_MAX_CMD && parser->commandInProgress[rid].status == EMP_RID_ALLOCATED)
+  {
+    parser->commandInProgress[rid].respStatus = status;
+
+    if (payload)
     {
-      p = (unsigned char*) payload;
-      //command status is transmitted as a big endian signed short
-      status = (int16_t) ( p[0] << 8 | p[1] );
+      SWI_LOG("EMP", DEBUG, "%s: Response payload contains extra data (in addition to status)\n", __FUNCTION__);
+      parser->commandInProgress[rid].respPayload = payload;
+      parser->commandInProgress[rid].respPayloadLen = payloadsize;
     }
-    SWI_LOG("EMP", DEBUG, "%s: Response for rid[%d], payloadsize = %d, status=%d\n",
-        __FUNCTION__, rid, payloadsize, status);
 
-    if (parser->commandInProgress[rid].status == EMP_RID_ALLOCATED)
-    {
+    // Signal the response of a command. This may unblock some thread that are waiting on that response
+    SWI_LOG("EMP", DEBUG, "%s: broadcast to sender\n", __FUNCTION__);
+    sem_post(&parser->commandInProgress[rid].respSem);
+    SWI_LOG("EMP", DEBUG, "%s: broadcast done\n", __FUNCTION__);
+    return;
+  }
 
-      parser->commandInProgress[rid].respStatus = status;
+  if (rid < EMP_MAX_CMD && parser->commandInProgress[rid].status == EMP_RID_TIMEDOUT)
+  {
+    freerequestid(rid);
+  }
+  else
+  {
+    SWI_LOG("EMP", DEBUG, "Received an unexpected response: payload [%.*s], rid[%d]\n",
+        payloadsize, payload ? payload : "", rid);
+  }
+  free(payload);
+}
 
-      if (payloadsize > 2)
-      {
-        SWI_LOG("EMP", DEBUG, "%s: Response payload contains extra data (in addition to status)\n", __FUNCTION__);
-        parser->commandInProgress[rid].respPayload = payload + 2;
-        parser->commandInProgress[rid].respPayloadLen = payloadsize - 2;
-        parser->commandInProgress[rid].respPayload = malloc(parser->commandInProgress[rid].respPayloadLen);
-        if (NULL == parser->commandInProgress[rid].respPayload)
-        {
-          parser->commandInProgress[rid].respStatus = RC_NO_MEMORY;
-          //don't return here: at least the cmd sender will get emp status, but not additional data.
-        }
-        else
-        {
-          memcpy(parser->commandInProgress[rid].respPayload, payload + 2, parser->commandInProgress[rid].respPayloadLen);
-        }
-      }
+/*
+ * dispatching incoming new cmds.
+ * this function runs in reader thread.
+ */
+static rc_ReturnCode_t reader_dispatch_command(EmpCommand command, uint8_t rid, char* payload, uint32_t payloadsize)
+{
+  emp_command_job_t* ud;
+  pthread_t thread;
+  int res;
 
-      // Signal the response of a command. This may unblock some thread that are waiting on that response
-      SWI_LOG("EMP", DEBUG, "%s: broadcast to sender\n", __FUNCTION__);
-      sem_post(&parser->commandInProgress[rid].respSem);
-      SWI_LOG("EMP", DEBUG, "%s: broadcast done\n", __FUNCTION__);
-    }
-    else if (parser->commandInProgress[rid].status == EMP_RID_TIMEDOUT)
-    {
-      freerequestid(rid);
-    }
-    else
-    {
-      SWI_LOG("EMP", DEBUG, "Received an unexpected response: cmd [%d], payload [%s], rid[%d]\n",
-          command, payload, rid);
-    }
+  if (command >= EMP_NB_OF_COMMANDS || !parser->commandHdlrs[command])
+  {
+    SWI_LOG("EMP", DEBUG, "no handler set for %d\n", command);
     emp_freemessage(payload);
-    return RC_OK;
+    //todo check status!!
+    return RC_NOT_AVAILABLE;
   }
-  else //that's new emp cmd coming from RA
-  {
-    if (!parser->commandHdlrs[command])
-    {
-      SWI_LOG("EMP", DEBUG, "no handler set for %d\n", command);
-      //todo check status!!
-      return RC_NOT_AVAILABLE;
-    }
-    //spawn new thread
-    pthread_t thread;
-    thread_cmd_data_t* ud = malloc(sizeof(*ud));
-    if (NULL == ud)
-      return RC_NO_MEMORY;
 
+  // queue the command for an idle worker
+  pthread_mutex_lock(&parser->jobLock);
+  if (parser->nbJobs < parser->idleWorkers)
+  {
+    ud = &parser->jobs[(parser->firstJob + parser->nbJobs) % EMP_MAX_WORKERS];
     ud->command = command;
     ud->payloadsize = payloadsize;
     ud->payload = payload;
     ud->rid = rid;
-    int res = pthread_create(&thread, 0, thread_cmd_routine, (void*) ud);
-    if (res){
-      SWI_LOG("EMP", ERROR, "Failed to create thread to process incoming command, errno[%s]\n", strerror(errno));
-      //clean resources
-      emp_freemessage(payload);
-      //we could improve error reporting by returning RC error depending on actual errno error
-      return RC_UNSPECIFIED_ERROR;
-    }
+    parser->nbJobs++;
+    pthread_cond_signal(&parser->jobCond);
+    pthread_mutex_unlock(&parser->jobLock);
+    return RC_OK;
+  }
+  pthread_mutex_unlock(&parser->jobLock);
 
-    pthread_detach(thread);
-    //it's up to the thread to send the response and free the payload!!
+  //no idle worker, spawn new thread
+  ud = malloc(sizeof(*ud));
+  if (NULL == ud)
+  {
+    emp_freemessage(payload);
+    return RC_NO_MEMORY;
+  }
 
-    return RC_OK;
+  ud->command = command;
+  ud->payloadsize = payloadsize;
+  ud->payload = payload;
+  ud->rid = rid;
+  res = pthread_create(&thread, 0, thread_cmd_routine, (void*) ud);
+  if (res){
+    SWI_LOG("EMP", ERROR, "Failed to create thread to process incoming command, errno[%s]\n", strerror(errno));
+    //clean resources
+    emp_freemessage(payload);
+    free(ud);
+    //we could improve error reporting by returning RC error depending on actual errno error
+    return RC_UNSPECIFIED_ERROR;
   }
+
+  pthread_detach(thread);
+  //it's up to the thread to send the response and free the payload!!
+
+  return RC_OK;
 }
 
-static rc_ReturnCode_t ipc_send(const char* payload, uint32_t payloadsize)
+static rc_ReturnCode_t ipc_send(const unsigned char* header, const char* payload, uint32_t payloadsize)
 {
-  int s;
+  ssize_t s;
   rc_ReturnCode_t status;
+  struct iovec iov[2];
+  struct msghdr msg;
+
+  iov[0].iov_base = (void *) header;
+  iov[0].iov_len = 8;
+  iov[1].iov_base = (void *) payload;
+  iov[1].iov_len = payloadsize;
+  memset(&msg, 0, sizeof(msg));
+  msg.msg_iov = iov;
+  msg.msg_iovlen = payloadsize ? 2 : 1;
 
   pthread_mutex_lock(&parser->sockLock);
-  s = send(parser->sockfd, payload, payloadsize, MSG_NOSIGNAL);
-  if (s < 0)
+  while (msg.msg_iovlen > 0)
   {
-    if (errno == EPIPE || errno == ECONNRESET)
+    s = sendmsg(parser->sockfd, &msg, MSG_NOSIGNAL);
+    if (s < 0)
     {
-      status = RC_CLOSED;
+      if (errno == EINTR)
+        continue;
+      if (errno == EPIPE || errno == ECONNRESET)
+      {
+        status = RC_CLOSED;
+        goto quit;
+      }
+      SWI_LOG("EMP", DEBUG, "%s: fd=%d, errno=%d, error=%s\n", __FUNCTION__, parser->sockfd, errno, strerror(errno));
+      status = RC_IO_ERROR;
       goto quit;
     }
-    SWI_LOG("EMP", DEBUG, "%s: fd=%d, errno=%d, error=%s\n", __FUNCTION__, parser->sockfd, errno, strerror(errno));
-    status = RC_IO_ERROR;
-    goto quit;
-  }
-  if (s != payloadsize)
-  {
-    SWI_LOG("EMP", ERROR, "%s: send was partial, sent size=%d, expected payloadsize=%u\n", __FUNCTION__, s, payloadsize);
-    status = RC_BAD_FORMAT;
-    goto quit;
+    // send was partial: skip what has been sent, then send the rest of the message
+    while (msg.msg_iovlen > 0 && (size_t) s >= msg.msg_iov->iov_len)
+    {
+      s -= msg.msg_iov->iov_len;
+      msg.msg_iov++;
+      msg.msg_iovlen--;
+    }
+    if (msg.msg_iovlen > 0)
+    {
+      msg.msg_iov->iov_base = (char *) msg.msg_iov->iov_base + s;
+      msg.msg_iov->iov_len -= s;
+    }
   }
   status = RC_OK;
 quit:
@@ -745,40 +977,48 @@ static int wait_for_response(uint8_t rid, const struct timespec *abs_timeout)
   return ret;
 }
 
-rc_ReturnCode_t emp_send_and_wait_response(EmpCommand command, uint8_t type, const char* payload, uint32_t payloadsize,
-    char **respPayload, uint32_t* respPayloadLen)
+rc_ReturnCode_t emp_send_request(EmpCommand command, uint8_t type, const char* payload, uint32_t payloadsize,
+    uint8_t *rid)
 {
   rc_ReturnCode_t res;
-  int ret;
-  uint8_t rid = 0;
   struct timeval  tv;
-  struct timespec timeout = {0, 0};
 
   if (parser == NULL)
     return RC_NOT_INITIALIZED;
 
   // Construct the message and send it through IPC to the agent
-  res = emp_sendmessage(command, type, &rid, payload, payloadsize);
+  res = emp_sendmessage(command, type, rid, payload, payloadsize);
   if (res != RC_OK)
   {
     SWI_LOG("EMP", DEBUG, "%s: emp_sendmessage failed, res %d\n", __FUNCTION__, res);
     return res;
   }
-  SWI_LOG("EMP", DEBUG, "%s: rid=%d\n", __FUNCTION__, rid);
+  SWI_LOG("EMP", DEBUG, "%s: rid=%d\n", __FUNCTION__, *rid);
 
-  // Wait for a response associated to the current rid and block on a condition until
-  // the expected response is received or an error is thrown.
-  // If no such response is received, a timeout is triggered and an error is returned
+  // The response is expected within cmdTimeout seconds from now
   gettimeofday(&tv, NULL);
-  timeout.tv_nsec = tv.tv_usec * 1000;
-  timeout.tv_sec = tv.tv_sec + parser->cmdTimeout;
+  parser->commandInProgress[*rid].deadline.tv_nsec = tv.tv_usec * 1000;
+  parser->commandInProgress[*rid].deadline.tv_sec = tv.tv_sec + parser->cmdTimeout;
+  return RC_OK;
+}
 
+rc_ReturnCode_t emp_wait_response(uint8_t rid, char **respPayload, uint32_t* respPayloadLen)
+{
+  rc_ReturnCode_t res;
+  int ret;
+
+  if (parser == NULL)
+    return RC_NOT_INITIALIZED;
 
-  SWI_LOG("EMP", DEBUG, "%s: [%d] waiting for response, time = %lu\n", __FUNCTION__, rid, timeout.tv_sec);
+  // Wait for a response associated to the current rid and block on a condition until
+  // the expected response is received or an error is thrown.
+  // If no such response is received, a timeout is triggered and an error is returned
+  SWI_LOG("EMP", DEBUG, "%s: [%d] waiting for response, time = %lu\n", __FUNCTION__, rid,
+      parser->commandInProgress[rid].deadline.tv_sec);
   // Wait on this condition until the reader thread wakes up the caller thread, when a response is received
   // or until the condition raises a timeout
-  ret = wait_for_response(rid, &timeout);
-  SWI_LOG("EMP", DEBUG, "%s: [%d] got response, time = %lu\n", __FUNCTION__, rid, timeout.tv_sec);
+  ret = wait_for_response(rid, &parser->commandInProgress[rid].deadline);
+  SWI_LOG("EMP", DEBUG, "%s: [%d] got response\n", __FUNCTION__, rid);
 
   if (ret == -1 && errno == ETIMEDOUT)
   {
@@ -809,3 +1049,15 @@ rc_ReturnCode_t emp_send_and_wait_response(EmpCommand command, uint8_t type, con
     freerequestid(rid);
   return res;
 }
+
+rc_ReturnCode_t emp_send_and_wait_response(EmpCommand command, uint8_t type, const char* payload, uint32_t payloadsize,
+    char **respPayload, uint32_t* respPayloadLen)
+{
+  rc_ReturnCode_t res;
+  uint8_t rid = 0;
+
+  res = emp_send_request(command, type, payload, payloadsize, &rid);
+  if (res != RC_OK)
+    return res;
+  return emp_wait_response(rid, respPayload, respPayloadLen);
+}
@@ -96,15 +96,29 @@ typedef void (*emp_ipc_broken_hdl_t)(void);
 #define EMP_MAX_CMD 64
 #define EMP_MAX_IPC_HDLRS 8
 
+#define EMP_MAX_WORKERS 8 // max number of threads running command handlers (SWI_EMP_NB_WORKERS, default 4)
+#define EMP_MAX_FREE_BUFFERS 8 // max number of receive buffers kept for reuse
+
 typedef struct
 {
   uint8_t status;
   sem_t respSem;
+  struct timespec deadline;
   rc_ReturnCode_t respStatus;
   char *respPayload;
   uint32_t respPayloadLen;
 } emp_command_ctx_t;
 
+typedef struct
+{
+  EmpCommand command;
+  uint32_t payloadsize;
+  char* payload;
+  uint8_t rid;
+} emp_command_job_t;
+
+struct emp_buffer_s;
+
 typedef struct EmpParser_s
 {
   emp_command_ctx_t commandInProgress[EMP_MAX_CMD];
@@ -115,6 +129,22 @@ typedef struct EmpParser_s
 
   pthread_t readerThread;
 
+  // worker pool running command handlers
+  pthread_t workers[EMP_MAX_WORKERS];
+  int nbWorkers;
+  int idleWorkers;
+  emp_command_job_t jobs[EMP_MAX_WORKERS]; // circular queue, never holds more jobs than idle workers
+  int firstJob;
+  int nbJobs;
+  uint8_t stopWorkers;
+  pthread_mutex_t jobLock;
+  pthread_cond_t jobCond;
+
+  // receive buffers released by emp_freemessage, kept for reuse
+  struct emp_buffer_s *freeBuffers;
+  int nbFreeBuffers;
+  pthread_mutex_t bufferLock;
+
   uint16_t cmdTimeout;
   int sockfd;
   int32_t ridBitfields[2];
@@ -127,6 +157,14 @@ rc_ReturnCode_t emp_parser_init(size_t nbCmds, EmpCommand* cmds, emp_command_hdl
 rc_ReturnCode_t emp_parser_destroy(size_t nbCmds, EmpCommand* cmds, emp_ipc_broken_hdl_t ipcHdlr);
 rc_ReturnCode_t emp_send_and_wait_response(EmpCommand command, uint8_t type,
 const char* payload, uint32_t payloadsize, char **respPayload, uint32_t* respPayloadLen);
+/*
+ * Split version of emp_send_and_wait_response, which allows a thread to have several requests in progress:
+ * emp_send_request sends the command and returns its request id, the response is then retrieved by
+ * emp_wait_response. Every successfully sent request must be waited for exactly once.
+ */
+rc_ReturnCode_t emp_send_request(EmpCommand command, uint8_t type, const char* payload, uint32_t payloadsize,
+    uint8_t *rid);
+rc_ReturnCode_t emp_wait_response(uint8_t rid, char **respPayload, uint32_t* respPayloadLen);
 void emp_freemessage(char* buffer);
 
 #endif /* INCLUSION_GUARD_EMP_H */
@@ -16,6 +16,7 @@
 #include <pthread.h>
 #include <signal.h>
 #include <stdint.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <sys/time.h>
 #include <sys/types.h>
@@ -121,6 +122,39 @@ static rc_ReturnCode_t emp_trigger_response_timeout()
   return RC_OK;
 }
 
+static rc_ReturnCode_t emp_pipelined_cmd()
+{
+  char payloads[4][8];
+  uint8_t rids[4];
+  char *respPayload = NULL;
+  uint32_t respPayloadLen = 0;
+  rc_ReturnCode_t res;
+  int i;
+
+  // Sending all the requests before waiting for the first response
+  for (i = 0; i < 4; i++)
+  {
+    sprintf(payloads[i], "\"p%d\"", i);
+    res = emp_send_request(EMP_SEND_CMD, 0, payloads[i], strlen(payloads[i]), &rids[i]);
+    if (res != RC_OK)
+      return res;
+  }
+
+  for (i = 0; i < 4; i++)
+  {
+    res = emp_wait_response(rids[i], &respPayload, &respPayloadLen);
+    if (res != RC_OK)
+      return res;
+    if (respPayloadLen != strlen(payloads[i]) || strncmp(payloads[i], respPayload, respPayloadLen) != 0)
+      res = RC_BAD_FORMAT;
+    free(respPayload);
+    respPayload = NULL;
+    if (res != RC_OK)
+      return res;
+  }
+  return RC_OK;
+}
+
 static void * send_cmd(void *arg)
 {
   uintptr_t id = (uintptr_t)arg, i = 0, fd = -1;
@@ -245,6 +279,7 @@ int main(void)
   CHECK_TEST(emp_init());
   CHECK_TEST(emp_destroy());
   CHECK_TEST(emp_init_with_callbacks());
+  CHECK_TEST(emp_pipelined_cmd());
   CHECK_TEST(emp_start_mt_cmd());
   CHECK_TEST(emp_trigger_response_timeout());
 
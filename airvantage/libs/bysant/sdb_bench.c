@@ -0,0 +1,114 @@
+/*******************************************************************************
+ * Copyright (c) 2012 Sierra Wireless and others.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *   http://www.eclipse.org/legal/epl-v10.html
+ * The Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *     Sierra Wireless - initial API and implementation
+ *******************************************************************************/
+
+/* Staging DB benchmark: fill, consolidate and serialize a 64k rows table,
+ * stored in RAM with both row and columnar layouts, then in a file.
+ *
+ * usage: sdb_bench [nrows [nconsolidations]] */
+
+#include "stagedb.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define NCOLUMNS 4
+#define BENCH_FILE "sdb_bench.tmp"
+
+static double now( void) {
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, & ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* Serialization writer which only counts bytes. */
+static int count_writer( unsigned const char *data, int len, void *ctx) {
+    *(int *) ctx += len;
+    return len;
+}
+
+static int run( enum sdb_storage_kind_t storage, enum sdb_layout_t layout,
+        int nrows, int ncons) {
+    static const sdb_consolidation_method_t methods[] = {
+        SDB_CM_MIN, SDB_CM_MAX, SDB_CM_MEAN, SDB_CM_SUM, SDB_CM_MEDIAN, SDB_CM_LAST };
+    const int nmethods = sizeof( methods) / sizeof( methods[0]);
+    sdb_table_t src, dst;
+    bss_ctx_t bss;
+    int i, r, nbytes = 0;
+    double t0, t1, t2, t3;
+
+    remove( BENCH_FILE);
+    r = sdb_init( & src, BENCH_FILE, storage,
+            "timestamp", SDB_SM_LIST, "temperature", SDB_SM_LIST,
+            "pressure", SDB_SM_LIST, "counter", SDB_SM_LIST, NULL);
+    if( r) return r;
+    r = sdb_setlayout( & src, layout);
+    if( r) return r;
+    r = sdb_initwithoutcolumns( & dst, "bench_cons", NCOLUMNS * nmethods, SDB_SK_RAM);
+    if( r) return r;
+    for( i=0; i<NCOLUMNS * nmethods; i++) {
+        char label[8];
+        sprintf( label, "c%d", i);
+        sdb_setcolumn( & dst, label, SDB_SM_LIST, 0.0);
+    }
+    sdb_setconstable( & src, & dst);
+    for( i=0; i<NCOLUMNS * nmethods; i++) {
+        sdb_setconscolumn( & src, i / nmethods, methods[i % nmethods]);
+    }
+
+    srand( 1);
+    t0 = now();
+    for( i=0; i<nrows; i++) {
+        sdb_int(    & src, 1356998400 + i);
+        sdb_double( & src, 20.0 + (rand() % 1000) / 100.0);
+        sdb_double( & src, 1013.25 + (rand() % 500) / 10.0);
+        sdb_int(    & src, i % 1000);
+    }
+    t1 = now();
+    for( i=0; i<ncons; i++) {
+        r = sdb_consolidate( & src);
+        if( r) return r;
+        sdb_reset( & dst);
+    }
+    t2 = now();
+    bss_init( & bss, count_writer, & nbytes);
+    r = sdb_serialize( & src, & bss);
+    if( r) return r;
+    t3 = now();
+
+    printf( "%-7s %6d rows: fill %8.2f ms, consolidate %8.3f ms, serialize %8.2f ms"
+            " (%d bytes)\n", SDB_SK_FILE == storage ? "file" :
+            SDB_LY_COLUMNS == layout ? "columns" : "rows", nrows,
+            (t1-t0) * 1e3, (t2-t1) * 1e3 / ncons, (t3-t2) * 1e3, nbytes);
+
+    sdb_close( & src);
+    sdb_close( & dst);
+    remove( BENCH_FILE);
+    return SDB_EOK;
+}
+
+int main( int argc, char **argv) {
+    int nrows = argc > 1 ? atoi( argv[1]) : 0xffff;
+    int ncons = argc > 2 ? atoi( argv[2]) : 10;
+    int r;
+    if( nrows <= 0 || nrows > 0xffff || ncons <= 0) {
+        fprintf( stderr, "usage: %s [nrows (1-65535) [nconsolidations]]\n", argv[0]);
+        return 1;
+    }
+    r = run( SDB_SK_RAM, SDB_LY_ROWS, nrows, ncons);
+    if( ! r) r = run( SDB_SK_RAM, SDB_LY_COLUMNS, nrows, ncons);
+    if( ! r) r = run( SDB_SK_FILE, SDB_LY_ROWS, nrows, ncons);
+    if( r) fprintf( stderr, "benchmark failed: %d\n", r);
+    return r ? 1 : 0;
+}
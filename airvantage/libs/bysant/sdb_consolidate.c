@@ -14,7 +14,6 @@
  *     Fabien Fleutot for Sierra Wireless - initial API and implementation
  *******************************************************************************/
 #include "sdb_internal.h"
-#include <stdlib.h> // qsort
 
 
 
@@ -101,12 +100,23 @@ static void cons_reduce( struct sdb_cons_ctx_t *cons_ctx,
     }
 }
 
-/* Double comparator for the quicksort. */
-static int cmp_pdouble( const void *p1, const void *p2) {
-    double d1 = * (double *) p1, d2 = * (double *) p2;
-    if( d1==d2) return 0;
-    if( d1<d2) return -1;
-    else return 1;
+/* Return the k-th smallest of the n values in v, which are partially
+ * reordered in the process (Wirth's selection algorithm): the median
+ * doesn't need the whole column to be sorted. */
+static double select_kth( double *v, int n, int k) {
+    int l = 0, m = n-1;
+    while( l<m) {
+        double x = v[k];
+        int i = l, j = m;
+        do {
+            while( v[i]<x) i++;
+            while( x<v[j]) j--;
+            if( i<=j) { double t = v[i]; v[i] = v[j]; v[j] = t; i++; j--; }
+        } while( i<=j);
+        if( j<k) l = i;
+        if( k<i) m = j;
+    }
+    return v[k];
 }
 
 /* Copy an amount of data, at a given offset, from a source table
@@ -149,17 +159,34 @@ static int copy_data_ram( sdb_table_t *src, sdb_table_t *dst,
     return SDB_EOK;
 }
 
+#ifdef SDB_FILE_SUPPORT
+/* Files are mapped contiguously: data is written to dst straight from the
+ * mapped pages. */
 static int copy_data_file( sdb_table_t *src, sdb_table_t *dst,
         int offset, int length) {
-    return SDB_EINTERNAL;
+    struct sdb_read_ctx_t rctx;
+    int r;
+    sdb_read_init( & rctx, src);
+    if( rctx.source.file.size < 0) {
+        r = rctx.source.file.size;
+    } else if( offset + length > rctx.source.file.size) {
+        r = SDB_EBADFILE;
+    } else {
+        r = sdb_bss_writer( rctx.source.file.map + offset, length, dst);
+    }
+    sdb_read_close( & rctx);
+    return r<0 ? r : SDB_EOK;
 }
+#endif
 
 static int copy_data( sdb_table_t *src, sdb_table_t *dst,
         int offset, int length) {
     int r;
     switch( src->storage_kind) {
     case SDB_SK_RAM: r = copy_data_ram( src, dst, offset, length); break;
+#ifdef SDB_FILE_SUPPORT
     case SDB_SK_FILE: r = copy_data_file( src, dst, offset, length); break;
+#endif
     default: r = SDB_EINTERNAL; break;
     }
     if( SDB_EOK == r) {
@@ -168,6 +195,21 @@ static int copy_data( sdb_table_t *src, sdb_table_t *dst,
     }
     return r;
 }
+/* Copy the cell serialized at a given offset in the storage of a source
+ * table, through sdb_bsd() rather than as raw bytes, so that a columnar
+ * destination table can keep it in its column arrays. */
+static int copy_cell_typed( sdb_table_t *src, sdb_table_t *dst, int offset) {
+    struct sdb_read_ctx_t rctx;
+    struct bsd_data_t bsd_data;
+    int r;
+    sdb_read_init( & rctx, src);
+    sdb_read_seek( & rctx, src, offset);
+    r = sdb_read_storage_data( & rctx, & bsd_data, 0);
+    if( r>0) r = sdb_bsd( dst, & bsd_data, rctx.bytes, rctx.nbytes);
+    sdb_read_close( & rctx);
+    return r<0 ? r : SDB_EOK;
+}
+
 /* Finalize a consolidation by writing the result in the specified
  * column of the table. The consolidation context has been initialized
  * with cons_init(), and every value of the source column has been
@@ -189,7 +231,11 @@ static void cons_finalize( struct sdb_cons_ctx_t *ctx,
     case SDB_CM_FIRST:
     case SDB_CM_LAST:
     case SDB_CM_MIDDLE:
-        r = copy_data( src, dst, u->streampos.offset, u->streampos.length);
+        if( dst->columnar) {
+            r = copy_cell_typed( src, dst, u->streampos.offset);
+        } else {
+            r = copy_data( src, dst, u->streampos.offset, u->streampos.length);
+        }
         if( r != SDB_EOK) sdb_null( dst);
         return;
 
@@ -199,8 +245,7 @@ static void cons_finalize( struct sdb_cons_ctx_t *ctx,
     case SDB_CM_SUM:    r = sdb_number( dst, u->sum); return;
 
     case SDB_CM_MEDIAN:
-        qsort( u->median, ctx->nrows, sizeof( double), cmp_pdouble);
-        r = sdb_number( dst, u->median [ctx->nrows/2]);
+        r = sdb_number( dst, select_kth( u->median, ctx->nrows, ctx->nrows/2));
         free( u->median); u->median = NULL;
         return;
     }
@@ -213,6 +258,129 @@ static void cons_close( struct sdb_cons_ctx_t *ctx) {
     }
 }
 
+/* Copy the cell at a given row of a columnar table's column. */
+static int copy_column_cell( sdb_table_t *src, sdb_column_t *column, int row,
+        sdb_table_t *dst) {
+    double value = column->values[row];
+    switch( column->kinds[row]) {
+    case SDB_CK_INT:        return sdb_int(    dst, (int) value);
+    case SDB_CK_DOUBLE:     return sdb_double( dst, value);
+    case SDB_CK_NULL:       return sdb_null(   dst);
+    case SDB_CK_FALSE:      return sdb_bool(   dst, 0);
+    case SDB_CK_TRUE:       return sdb_bool(   dst, 1);
+    case SDB_CK_SERIALIZED: return copy_cell_typed( src, dst, (int) value);
+    }
+    return SDB_EINTERNAL;
+}
+
+/* Gather the first nrows values of a column which holds non-numeric
+ * cells in the table's consolidation buffer. Serialized cells might still
+ * hold numbers, e.g. when written with sdb_raw(); any other cell makes
+ * numeric consolidations fail with SDB_EINVALID. */
+static int gather_column_numbers( sdb_table_t *src, sdb_column_t *column,
+        sdb_nrow_t nrows) {
+    struct sdb_read_ctx_t rctx;
+    struct bsd_data_t bsd_data;
+    double *buff = src->cons_buff;
+    int i, r = SDB_EOK;
+    sdb_read_init( & rctx, src);
+    for( i=0; i<nrows && SDB_EOK==r; i++) {
+        switch( column->kinds[i]) {
+        case SDB_CK_INT:
+        case SDB_CK_DOUBLE:
+            buff[i] = column->values[i];
+            break;
+        case SDB_CK_SERIALIZED:
+            sdb_read_seek( & rctx, src, (int) column->values[i]);
+            r = sdb_read_storage_data( & rctx, & bsd_data, 0);
+            if( r<0) break;
+            r = SDB_EOK;
+            if( BSD_INT == bsd_data.type) buff[i] = (double) bsd_data.content.i;
+            else if( BSD_DOUBLE == bsd_data.type) buff[i] = bsd_data.content.d;
+            else r = SDB_EINVALID;
+            break;
+        default:
+            r = SDB_EINVALID;
+            break;
+        }
+    }
+    sdb_read_close( & rctx);
+    return r;
+}
+
+/* Reduce the first nrows cells of a columnar table's column into a number.
+ * Purely numeric columns are reduced straight from their array; the others
+ * are first gathered into the consolidation buffer. Sums are accumulated in
+ * row order, so that results are identical to those of row tables. */
+static int reduce_column( sdb_table_t *src, sdb_column_t *column,
+        enum sdb_consolidation_method_t method, sdb_nrow_t nrows, double *result) {
+    const double *v = column->values;
+    double acc;
+    int i;
+
+    if( column->nnonnumeric || SDB_CM_MEDIAN == method) {
+        if( ! src->cons_buff) {
+            src->cons_buff = malloc( src->ncolumnrows * sizeof( double));
+            if( ! src->cons_buff) return SDB_EMEM;
+        }
+        if( column->nnonnumeric) {
+            int r = gather_column_numbers( src, column, nrows);
+            if( r) return r;
+        } else {
+            memcpy( src->cons_buff, v, nrows * sizeof( double));
+        }
+        v = src->cons_buff;
+    }
+
+    switch( method) {
+    case SDB_CM_MAX:
+        for( acc = v[0], i=1; i<nrows; i++) acc = v[i]>acc ? v[i] : acc;
+        break;
+    case SDB_CM_MIN:
+        for( acc = v[0], i=1; i<nrows; i++) acc = v[i]<acc ? v[i] : acc;
+        break;
+    case SDB_CM_SUM:
+    case SDB_CM_MEAN:
+        for( acc = 0, i=0; i<nrows; i++) acc += v[i];
+        if( SDB_CM_MEAN == method) acc /= nrows;
+        break;
+    case SDB_CM_MEDIAN:
+        acc = select_kth( src->cons_buff, nrows, nrows/2);
+        break;
+    default:
+        return SDB_EINTERNAL;
+    }
+    *result = acc;
+    return SDB_EOK;
+}
+
+/* Consolidate a columnar table: every destination cell is computed from
+ * its source column array, without deserializing the table. As with row
+ * tables, cells which can't be computed are consolidated as nil. */
+static int consolidate_columns( sdb_table_t *src, sdb_nrow_t n_src_row) {
+    struct sdb_consolidation_t *cons = src->consolidation;
+    struct sdb_table_t         *dst  = cons->dst;
+    sdb_ncolumn_t               i_dst_col;
+
+    for( i_dst_col = 0;  i_dst_col < dst->ncolumns;  i_dst_col++) {
+        struct sdb_cons_column_t *cc = cons->dst_columns + i_dst_col;
+        sdb_column_t *column = src->columns + cc->src_column;
+        double result;
+        int r;
+        switch( cc->method) {
+        case SDB_CM_FIRST:  r = copy_column_cell( src, column, 0, dst); break;
+        case SDB_CM_LAST:   r = copy_column_cell( src, column, n_src_row-1, dst); break;
+        case SDB_CM_MIDDLE: r = copy_column_cell( src, column, n_src_row/2, dst); break;
+        default:
+            r = reduce_column( src, column, cc->method, n_src_row, & result);
+            if( SDB_EOK == r) r = sdb_number( dst, result);
+            break;
+        }
+        if( r != SDB_EOK) sdb_null( dst);
+    }
+    return SDB_EOK;
+}
+
 /* If the table is configured to consolidate itself into another,
  * consolidate each destination column from the source table. */
 int sdb_consolidate( sdb_table_t *src) {
@@ -231,6 +399,7 @@ int sdb_consolidate( sdb_table_t *src) {
     n_src_row = src->nwrittenobjects / src->ncolumns;
     if( n_src_row <= 0) return SDB_EEMPTY;
     if( (dst->state != SDB_ST_READING) || (src->state != SDB_ST_READING)) return SDB_EBADSTATE;
+    if( src->columnar) return consolidate_columns( src, n_src_row);
 
     /* Create one consolidation context per destination column. */
     cctx = malloc( n_dst_col * sizeof( *cctx));
@@ -291,7 +460,7 @@ int sdb_consolidate( sdb_table_t *src) {
             sdb_ncolumn_t n_cons = MATRIX_N_DST_COL( i_src_col), i_cons;
             struct bsd_data_t bsd_data;
             int offset = rctx.nreadbytes;
-            int length = sdb_read_data( & rctx, & bsd_data, n_cons>0);
+            int length = sdb_read_data( & rctx, & bsd_data, 0==n_cons);
             if( length<0) goto reading_fail;
             /* For each dst cell consolidating this src cell: */
             for( i_cons = 0;  i_cons < n_cons; i_cons++) {
@@ -306,6 +475,7 @@ int sdb_consolidate( sdb_table_t *src) {
         cons_finalize( cctx + i_dst_col, src, dst);
         cons_close(  cctx + i_dst_col);
     }
+    sdb_read_close( & rctx);
     free( cctx);
     free( matrix);
     return SDB_EOK;
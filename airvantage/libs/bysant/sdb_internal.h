@@ -80,8 +80,27 @@ typedef struct sdb_column_t {
       int all_integer:1;  // Flag set to true when any non integer data is stored.
       int all_numeric:1;  // Flag set to true when any non numeric data is stored.
   } data_analysis;
+  /* Cell storage for tables with a columnar layout, NULL otherwise.
+   * Both arrays hold 'ncolumnrows' entries, see sdb_setlayout(). */
+  double *values;   // cell value, or offset in chunks for serialized cells.
+  unsigned char *kinds;        // enum sdb_cell_kind_t, one per cell.
+  int nnonnumeric;     // # of cells in this column which aren't numbers.
 } sdb_column_t;
 
+/* How a cell is stored in the column arrays of a columnar table.
+ * Strings and raw cells are serialized in chunks, as in row tables. */
+enum sdb_cell_kind_t {
+  SDB_CK_INT,
+  SDB_CK_DOUBLE,           // all kinds above this one are non-numeric.
+  SDB_CK_NULL,
+  SDB_CK_FALSE,
+  SDB_CK_TRUE,
+  SDB_CK_SERIALIZED
+};
+
+/* Initial # of rows allocated in the arrays of a columnar table. */
+#define SDB_MIN_COLUMN_ROWS 0x10
+
 /* Serialized data in RAM is kept in chained fixed-size chunks. */
 #define SDB_CHUNK_SIZE 0x10000
 #if( SDB_CHUNK_SIZE > SDB_DATA_SIZE_LIMIT)
@@ -99,16 +118,23 @@ typedef struct sdb_read_ctx_t {
   enum sdb_storage_kind_t storage_kind;
   union {
     struct sdb_chunk_t *chunk;                         // chunk currently read.
-    FILE *file;                                         // file currently read.
+#ifdef SDB_FILE_SUPPORT
+    struct {
+      FILE *stream;                                     // file currently read.
+      unsigned char *map;  // read-only mapping of the whole file, maybe NULL.
+      int size;                         // # of bytes mapped, or a negative error.
+    } file;
+#endif
   } source;
   unsigned char *tmpbuff;// If a temporary buffer is ever needed, it goes here.
   unsigned nbytes;                       // # of bytes in the last read object.
   unsigned char *bytes;                   // raw bytes of the last read object.
   int   nreadbytes;                                // How many bytes been read.
   int   nreadobjects;                       // How many objects have been read.
+  struct sdb_table_t *columnar;     // table read, if it has a columnar layout.
+  struct bss_ctx_t *cell_bss; // serializes cells read from columnar tables.
+  unsigned char cellbuff[16];   // serialized form of the last columnar cell.
   unsigned char minibuff[BSD_MINBUFFSIZE];     // buffer used to get data size.
-  unsigned minibuff_len:2;  // # bytes left unused in minibuff, unused for RAM.
-  unsigned minibuff_offset:2;   // offset at which unused minibuff data starts.
   struct bsd_ctx_t bsd_ctx;                         // deserialization context.
 } sdb_read_ctx_t;
 
@@ -144,6 +170,10 @@ void sdb_read_init(  sdb_read_ctx_t *ctx, sdb_table_t *tbl);
 void sdb_read_close( sdb_read_ctx_t *ctx);
 /* Read the next data in the table. */
 int  sdb_read_data(  sdb_read_ctx_t *ctx, bsd_data_t *bsd_data, int skip);
+/* Read the next data serialized in the table storage, whatever its layout. */
+int  sdb_read_storage_data( sdb_read_ctx_t *ctx, bsd_data_t *bsd_data, int skip);
+/* Move a reading context to a given offset in the table storage. */
+void sdb_read_seek(  sdb_read_ctx_t *ctx, sdb_table_t *tbl, int offset);
 
 /* Write hessian serialization output in chunks. */
 int sdb_bss_writer( unsigned const char *data,  int len, void *ctx);
@@ -151,6 +181,14 @@ int sdb_bss_writer( unsigned const char *data,  int len, void *ctx);
 int sdb_untrim( sdb_table_t *tbl);
 int sdb_ram_trim( sdb_table_t *tbl);
 
+/* Reallocate the column arrays of a columnar table to hold nrows rows;
+ * 0 releases them. */
+int sdb_columns_resize( sdb_table_t *tbl, int nrows);
+
+/* Write back a cell read with sdb_read_data() at the end of a table. */
+int sdb_bsd( sdb_table_t *tbl, bsd_data_t *bsd_data,
+        unsigned const char *bytes, int nbytes);
+
 /* Data analysis for shortest serialization for on-the-fly analysis. These
  * functions must be called before nwrittenobjects is incremented as use it
  * to get column. */
@@ -16,6 +16,35 @@
 /* sbd_read_*: Reading back sequential data from sdb tables. */
 
 #include "sdb_internal.h"
+#ifdef SDB_FILE_SUPPORT
+#include <sys/mman.h> // mmap, munmap
+#include <sys/stat.h> // fstat
+#endif
+
+#ifdef SDB_FILE_SUPPORT
+/* Map the whole content of a table file, read-only. Pending writes are
+ * flushed first so that they are visible through the mapping. The file is
+ * only ever appended to, and never written while being read: the mapping
+ * remains valid until sdb_read_close(). */
+static void sdb_read_map_file( sdb_read_ctx_t *ctx, FILE *file) {
+    struct stat st;
+    void *map;
+    ctx->source.file.stream = file;
+    ctx->source.file.map    = NULL;
+    ctx->source.file.size   = 0;
+    if( fflush( file) || fstat( fileno( file), & st)) {
+        ctx->source.file.size = SDB_EBADFILE;
+    } else if( st.st_size > 0) {
+        map = mmap( NULL, st.st_size, PROT_READ, MAP_SHARED, fileno( file), 0);
+        if( MAP_FAILED == map) {
+            ctx->source.file.size = SDB_EBADFILE;
+        } else {
+            ctx->source.file.map  = map;
+            ctx->source.file.size = st.st_size;
+        }
+    }
+}
+#endif
 
 /* initialize a reading context. */
 void sdb_read_init( sdb_read_ctx_t *ctx, sdb_table_t *tbl) {
@@ -23,8 +52,8 @@ void sdb_read_init( sdb_read_ctx_t *ctx, sdb_table_t *tbl) {
     ctx->bytes           = NULL;
     ctx->nreadbytes      = 0;
     ctx->nreadobjects    = 0;
-    ctx->minibuff_len    = 0;
-    ctx->minibuff_offset = 0;
+    ctx->columnar        = tbl->columnar ? tbl : NULL;
+    ctx->cell_bss        = NULL;
 
     bsd_init( & ctx->bsd_ctx);
 
@@ -33,11 +62,12 @@ void sdb_read_init( sdb_read_ctx_t *ctx, sdb_table_t *tbl) {
         ctx->storage_kind = SDB_SK_RAM;
         ctx->source.chunk = tbl->storage.ram.first_chunk;
         break;
+#ifdef SDB_FILE_SUPPORT
     case SDB_SK_FILE:
         ctx->storage_kind = SDB_SK_FILE;
-        ctx->source.file = tbl->storage.file;
-        rewind( ctx->source.file);
+        sdb_read_map_file( ctx, tbl->storage.file);
         break;
+#endif
     }
 }
 
@@ -47,11 +77,21 @@ void sdb_read_close( sdb_read_ctx_t *ctx) {
       free( ctx->tmpbuff);
       ctx->tmpbuff = NULL;
     }
+    if( ctx->cell_bss) {
+      free( ctx->cell_bss);
+      ctx->cell_bss = NULL;
+    }
     switch( ctx->storage_kind) {
     case SDB_SK_RAM:  break;
-    case SDB_SK_FILE: break;
+#ifdef SDB_FILE_SUPPORT
+    case SDB_SK_FILE:
+        if( ctx->source.file.map) {
+            munmap( ctx->source.file.map, ctx->source.file.size);
+            ctx->source.file.map = NULL;
+        }
+        break;
+#endif
     }
-
 }
 
 /* Deserialize or skip the next data into bsd_data:
@@ -131,7 +171,7 @@ int sdb_read_ram_data( sdb_read_ctx_t *ctx, bsd_data_t *bsd_data, int skip) {
         sdb_chunk_t *nextchunk = ctx->source.chunk->next;
         if( ! nextchunk) return SDB_EINTERNAL;
         if( skip) { /* Just skip the cell, don't describe it in bsd_data. */
-            bsd_data->kind = BSD_ERROR;
+            bsd_data->type = BSD_ERROR;
             ctx->bytes = NULL;
         } else { /* Data actually needs to be deserialized. */
             /* reserve the buffer if not already done. */
@@ -158,102 +198,108 @@ int sdb_read_ram_data( sdb_read_ctx_t *ctx, bsd_data_t *bsd_data, int skip) {
     }
 }
 
-#ifdef SDB_FILE_SUPPORT
-int sdb_read_file_data( sdb_read_ctx_t *ctx, bsd_data_t *bsd_data, int skip) {
-    /* Read byte-per-byte, n_item==3, item_size=1:
-     * it's OK to read only 1 or 2 bytes. */
+/* Move the reading context to offset in the table storage, so that the
+ * next call to sdb_read_storage_data() reads the data stored there. */
+void sdb_read_seek( sdb_read_ctx_t *ctx, sdb_table_t *tbl, int offset) {
+    if( SDB_SK_RAM == ctx->storage_kind) {
+        sdb_chunk_t *chunk = tbl->storage.ram.first_chunk;
+        int n_skip_chunks;
+        for( n_skip_chunks = offset/SDB_CHUNK_SIZE; n_skip_chunks; n_skip_chunks--)
+            chunk = chunk->next;
+        ctx->source.chunk = chunk;
+    }
+    ctx->nreadbytes = offset;
+}
+
+/* Write serialized cells in the reading context's cellbuff. */
+static int sdb_cell_writer( unsigned const char *data, int length, void *writerctx) {
+    sdb_read_ctx_t *ctx = (sdb_read_ctx_t *) writerctx;
+    if( ctx->nbytes + length > sizeof( ctx->cellbuff)) return SDB_ETOOBIG;
+    memcpy( ctx->cellbuff + ctx->nbytes, data, length);
+    ctx->nbytes += length;
+    return length;
+}
+
+/* Read the next cell of a columnar table, in the same row-major order as
+ * sdb_read_ram_data() would. Cells kept in column arrays are serialized
+ * on the fly in cellbuff; serialized cells are read back from the chunks,
+ * where they are stored in the same order.
+ *
+ * Skipped cells aren't serialized: bytes is set to NULL and 0 is returned.
+ * nreadbytes only counts the bytes read from chunks. */
+static int sdb_read_columns_data( sdb_read_ctx_t *ctx, bsd_data_t *bsd_data, int skip) {
+    sdb_table_t  *tbl    = ctx->columnar;
+    sdb_column_t *column = tbl->columns + ctx->nreadobjects % tbl->ncolumns;
+    int row = ctx->nreadobjects / tbl->ncolumns;
+    int r;
+
+    if( ctx->nreadobjects >= tbl->nwrittenobjects) return 0;
+    if( SDB_CK_SERIALIZED == column->kinds[row])
+        return sdb_read_ram_data( ctx, bsd_data, skip);
 
-//    int ftellb4 = (int) ftell( ctx->source.file); // debug cruft
-    int nread,                 // # bytes read from buffer to bsd deserializer.
-        nfromfile,              // # bytes read from file to complete minibuff.
-        ninbuff;       // # bytes in minibuff (read from file + already there).
-    if( ctx->minibuff_len > 0) {
-        memmove(ctx->minibuff,
-                ctx->minibuff + ctx->minibuff_offset,
-                ctx->minibuff_len);
-//        printf( "moved %d minibuff bytes from 0x%x+%d to 0x%x\n",
-//                ctx->minibuff_len,
-//                (unsigned) ctx->minibuff, ctx->minibuff_offset,
-//                (unsigned) ctx->minibuff);
+    if( skip) {
+        ctx->bytes  = NULL;
+        ctx->nbytes = 0;
+        ctx->nreadobjects++;
+        return 0;
     }
-    nfromfile = fread(
-            ctx->minibuff + ctx->minibuff_len,
-            1, sizeof( ctx->minibuff) - ctx->minibuff_len,
-            ctx->source.file);
-//    printf( "%d objects, %d bytes, ftell %d->%d: Tried to get %d more bytes, "
-//            "there where already %d in it, to get a total of 3, got %d. "
-//            "%d bytes in minibuff.\n",
-//            ctx->nreadobjects, ctx->nreadbytes,
-//            ftellb4, (int) ftell(ctx->source.file),
-//            sizeof( ctx->minibuff) - ctx->minibuff_len, ctx->minibuff_len,
-//            nfromfile, ctx->minibuff_len);
-    ninbuff = ctx->minibuff_len + nfromfile;
-    if( ninbuff == 0) {
-        int r = ferror( ctx->source.file);
-        if( r>0) return SDB_EBADFILE;
-        else if( r<0) return r;
-        else return 0;
+    if( ! ctx->cell_bss) {
+        ctx->cell_bss = malloc( sizeof( *ctx->cell_bss));
+        if( ! ctx->cell_bss) return SDB_EMEM;
+        bss_init( ctx->cell_bss, sdb_cell_writer, ctx);
     }
-    nread = bsd_read( & ctx->bsd_ctx, bsd_data, ctx->minibuff, ninbuff);
-//    printf("bsd_read() returns %d\n", nread);
-    if( nread>=0) {
-        ctx->nreadbytes += nread;
-        ctx->nreadobjects++;
-        ctx->nbytes = nread;
-        ctx->bytes = ctx->minibuff;
-        if( nread < ninbuff) { // recycle extra bytes in minibuff
-            ctx->minibuff_offset = nread;
-            ctx->minibuff_len = ninbuff - nread;
-        } else {
-            ctx->minibuff_len = 0;
-        }
-//        {
-//            char buf[256];
-//            bsd_tostring( bsd_data, buf);
-//            printf("Retrieved this from minibuff: %s\n", buf);
-//        }
-        return nread;
-    } else if( skip) { /* more than 3 bytes, but no need to read them. */
-        int needed = -nread;
-        /* Correct seek position to take into account what's been already
-         * read in minibuf. */
-        fseek( ctx->source.file, needed - ninbuff, SEEK_CUR);
-        ctx->bytes = NULL;
-        ctx->nreadbytes += needed;
-        ctx->nreadobjects++;
-        ctx->nbytes = needed;
-        ctx->minibuff_len = 0;
-        return needed;
-    } else { /* more than 3 bytes, must read them. */
-        int r, needed = -nread;
-        unsigned char *b = ctx->tmpbuff;
-        if( ! b) { //TODO: increase buffer size progressively?
-            b = malloc( SDB_DATA_SIZE_LIMIT);
-            if( b) { ctx->tmpbuff = b; } else { return SDB_EMEM; }
-        }
-        memcpy( b, ctx->minibuff, sizeof( ctx->minibuff));
-        r = fread(
-                b + sizeof( ctx->minibuff),
-                needed - sizeof( ctx->minibuff), 1,
-                ctx->source.file);
-        if( ! r) {
-            r = ferror( ctx->source.file);
-            if( r) return r; else return SDB_EINTERNAL; }
-        r = bsd_read( & ctx->bsd_ctx, bsd_data, b, needed);
-        if( needed != r){ return SDB_EINTERNAL; }
-        ctx->bytes       = ctx->tmpbuff;
-        ctx->nreadbytes += needed;
-        ctx->nreadobjects++;
-        ctx->nbytes = needed;
-        ctx->minibuff_len = 0;
-//        {
-//            char buf[256];
-//            bsd_tostring( bsd_data, buf);
-//            printf("Retrieved this from big buff: %s\n", buf);
-//        }
-        return needed;
+    ctx->nbytes = 0;
+    bsd_data->kind = BSD_KTOPLEVEL;
+    switch( column->kinds[row]) {
+    case SDB_CK_INT:
+        bsd_data->type      = BSD_INT;
+        bsd_data->content.i = (int) column->values[row];
+        r = bss_int( ctx->cell_bss, bsd_data->content.i);
+        break;
+    case SDB_CK_DOUBLE:
+        bsd_data->type      = BSD_DOUBLE;
+        bsd_data->content.d = column->values[row];
+        r = bss_double( ctx->cell_bss, bsd_data->content.d);
+        break;
+    case SDB_CK_NULL:
+        bsd_data->type = BSD_NULL;
+        r = bss_null( ctx->cell_bss);
+        break;
+    case SDB_CK_FALSE:
+    case SDB_CK_TRUE:
+        bsd_data->type         = BSD_BOOL;
+        bsd_data->content.bool = SDB_CK_TRUE == column->kinds[row];
+        r = bss_bool( ctx->cell_bss, bsd_data->content.bool);
+        break;
+    default:
+        return SDB_EINTERNAL;
     }
-    return SDB_EINTERNAL;
+    if( r) return SDB_EINTERNAL;
+    ctx->bytes = ctx->cellbuff;
+    ctx->nreadobjects++;
+    return ctx->nbytes;
+}
+
+#ifdef SDB_FILE_SUPPORT
+/* Read the next data straight from the file mapping: bytes points into the
+ * mapped pages, no copy is ever needed, so there's nothing to save when
+ * skipping. Return 0 at the end of the file. */
+static int sdb_read_file_data( sdb_read_ctx_t *ctx, bsd_data_t *bsd_data) {
+    int left = ctx->source.file.size - ctx->nreadbytes;
+    int r;
+    if( ctx->source.file.size < 0) return ctx->source.file.size;
+    if( left <= 0) return 0;
+    r = bsd_read( & ctx->bsd_ctx, bsd_data, ctx->source.file.map + ctx->nreadbytes, left);
+    if( 0 == r) { /* deserialization error. */
+        return bsd_data->content.error;
+    } else if( r < 0) { /* last data truncated, e.g. by a crash while writing it. */
+        return SDB_EBADFILE;
+    }
+    ctx->bytes        = ctx->source.file.map + ctx->nreadbytes;
+    ctx->nbytes       = r;
+    ctx->nreadbytes  += r;
+    ctx->nreadobjects++;
+    return r;
 }
 #endif
 
@@ -263,10 +309,17 @@ int sdb_read_flash_data( sdb_read_ctx_t *ctx, bsd_data_t *bsd_data, int skip) {
 }
 #endif
 
-int sdb_read_data( sdb_read_ctx_t *ctx, bsd_data_t *bsd_data, int skip) {
+int sdb_read_storage_data( sdb_read_ctx_t *ctx, bsd_data_t *bsd_data, int skip) {
     switch( ctx->storage_kind) {
     case SDB_SK_RAM:  return sdb_read_ram_data( ctx, bsd_data, skip);
-    case SDB_SK_FILE: return sdb_read_file_data( ctx, bsd_data, skip);
+#ifdef SDB_FILE_SUPPORT
+    case SDB_SK_FILE: return sdb_read_file_data( ctx, bsd_data);
+#endif
     }
     return SDB_EINTERNAL;
 }
+
+int sdb_read_data( sdb_read_ctx_t *ctx, bsd_data_t *bsd_data, int skip) {
+    if( ctx->columnar) return sdb_read_columns_data( ctx, bsd_data, skip);
+    return sdb_read_storage_data( ctx, bsd_data, skip);
+}
@@ -436,6 +436,7 @@ static int compute_serialization_methods( struct sdb_table_t *tbl) {
     }
 
     // Second pass: compute QPV size now that we know the most frequent delta
+    sdb_read_close( & read_ctx);
     sdb_read_init( & read_ctx, tbl);
     for( i=0, current_smallest=0; i<tbl->nwrittenobjects; i++) {
         int column_index = read_ctx.nreadobjects % tbl->ncolumns;
@@ -50,7 +50,7 @@ static void sdb_restore_file_cells( sdb_table_t *tbl) {
     sdb_read_init( & rctx, tbl);
     while( (nread = sdb_read_data( & rctx, & bsd, 1)) > 0) {
         // restore data analysis
-        switch( bsd.kind) {
+        switch( bsd.type) {
         case BSD_INT:    sdb_analyze_integer(tbl, bsd.content.i); break;
         case BSD_DOUBLE: sdb_analyze_noninteger(tbl, 1); break;
         default:         sdb_analyze_noninteger(tbl, 0); break;
@@ -85,7 +85,7 @@ int sdb_initwithoutcolumns( sdb_table_t *tbl, const char *id, sdb_ncolumn_t ncol
     if( r<0) goto fail_id;
 
     /* Allocate dynamic arrays. */
-    tbl->columns = malloc( ncolumns * sizeof( tbl->columns[0]));
+    tbl->columns = calloc( ncolumns, sizeof( tbl->columns[0]));
     if( ! tbl->columns) goto fail_columns;
 
     /* Other initializations. */
@@ -175,6 +175,10 @@ int sdb_trim( sdb_table_t *tbl) {
     case SDB_SK_RAM: sdb_ram_trim( tbl); break;
     default: break;
     }
+    if( tbl->columnar) {
+        int nrows = (tbl->nwrittenobjects + tbl->ncolumns - 1) / tbl->ncolumns;
+        return sdb_columns_resize( tbl, nrows);
+    }
     return SDB_EOK;
 }
 
@@ -186,6 +190,7 @@ void sdb_close( sdb_table_t *tbl) {
     if( tbl->state == SDB_ST_SERIALIZING) sdb_serialize_cancel( tbl);
     tbl->state = SDB_ST_BROKEN;
     if( tbl->columns) {
+      sdb_columns_resize( tbl, 0);
       free( tbl->columns);
       tbl->columns = NULL;
     }
@@ -288,6 +293,7 @@ int sdb_reset( sdb_table_t *tbl) {
     // reset data analysis
     for( i=0; i<tbl->ncolumns; i++) {
         sdb_column_t *c = tbl->columns + i;
+        c->nnonnumeric = 0;
         if( SDB_SM_SMALLEST == SDB_SM_CONTAINER(c->serialization_method)) {
             c->data_analysis.delta_sum = 0;
             c->data_analysis.all_integer = 1;
@@ -330,6 +336,21 @@ int sdb_setcolumn(  sdb_table_t *tbl, const char *label,
     return SDB_EOK;
 }
 
+int sdb_setlayout( sdb_table_t *tbl, enum sdb_layout_t layout) {
+    if( (tbl->state == SDB_ST_BROKEN) || (tbl->state == SDB_ST_SERIALIZING)) return SDB_EBADSTATE;
+    if( tbl->nwrittenobjects) return SDB_EBADSTATE;
+    switch( layout) {
+    case SDB_LY_ROWS:
+        tbl->columnar = 0;
+        return sdb_columns_resize( tbl, 0);
+    case SDB_LY_COLUMNS:
+        if( tbl->storage_kind != SDB_SK_RAM) return SDB_EINVALID;
+        tbl->columnar = 1;
+        return SDB_EOK;
+    }
+    return SDB_EINVALID;
+}
+
 int sdb_setconstable(  sdb_table_t *src,  sdb_table_t *dst) {
     struct sdb_consolidation_t *cons;
     if( (src->state == SDB_ST_BROKEN) || (src->state == SDB_ST_UNCONFIGURED)) return SDB_EBADSTATE;
@@ -0,0 +1,192 @@
+/*******************************************************************************
+ * Copyright (c) 2012 Sierra Wireless and others.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * and Eclipse Distribution License v1.0 which accompany this distribution.
+ *
+ * The Eclipse Public License is available at
+ *   http://www.eclipse.org/legal/epl-v10.html
+ * The Eclipse Distribution License is available at
+ *   http://www.eclipse.org/org/documents/edl-v10.php
+ *
+ * Contributors:
+ *     Sierra Wireless - initial API and implementation
+ *******************************************************************************/
+
+/* Staging DB test: row and columnar layouts must give byte-identical
+ * serializations, for both the source table and its consolidation table.
+ * Every combination of source and destination layouts is compared to
+ * row tables, with numbers, booleans, nils, strings and raw cells
+ * consolidated with the FIRST, LAST, MIDDLE and MEDIAN methods. */
+
+#include "stagedb.h"
+#include <stdio.h>
+#include <string.h>
+
+#define NCOLUMNS 4
+#define NMETHODS 4
+#define BUFFER_SIZE 4096
+
+static const sdb_consolidation_method_t methods[NMETHODS] = {
+    SDB_CM_FIRST, SDB_CM_LAST, SDB_CM_MIDDLE, SDB_CM_MEDIAN };
+
+/* Serialized bytes of a table or of a raw cell. */
+typedef struct buffer_t {
+    unsigned char data[BUFFER_SIZE];
+    int len;
+} buffer_t;
+
+static int buffer_writer( unsigned const char *data, int len, void *ctx) {
+    buffer_t *b = (buffer_t *) ctx;
+    if( b->len + len > BUFFER_SIZE) return -1;
+    memcpy( b->data + b->len, data, len);
+    b->len += len;
+    return len;
+}
+
+/* Serialize an int or a string, to be pushed in a table with sdb_raw(). */
+static void raw_int( buffer_t *b, int i) {
+    bss_ctx_t bss;
+    b->len = 0;
+    bss_init( & bss, buffer_writer, b);
+    bss_int( & bss, i);
+}
+
+static void raw_string( buffer_t *b, const char *str) {
+    bss_ctx_t bss;
+    b->len = 0;
+    bss_init( & bss, buffer_writer, b);
+    bss_string( & bss, str);
+}
+
+/* Push one row: a number column, a string column, a raw column holding
+ * numbers and strings, and a column mixing every kind of cell.
+ * Rows for which `withnils` is false hold no nil, so that the median of
+ * the number and raw columns can actually be computed. */
+static int push_row( sdb_table_t *tbl, int i, int withnils) {
+    char str[16];
+    buffer_t raw;
+    int r;
+
+    if( withnils && 1 == i % 3) r = sdb_null( tbl);
+    else if( i % 2) r = sdb_double( tbl, i * 1.5 - 7);
+    else r = sdb_int( tbl, (i * 37) % 11 - 5);
+    if( r) return r;
+
+    sprintf( str, "s%d", i);
+    r = withnils && 0 == i % 4 ? sdb_null( tbl) : sdb_string( tbl, str);
+    if( r) return r;
+
+    if( ! withnils || i % 3) raw_int( & raw, 1000 - i * i);
+    else raw_string( & raw, "raw");
+    r = sdb_raw( tbl, raw.data, raw.len);
+    if( r) return r;
+
+    switch( i % 5) {
+    case 0:  return sdb_bool( tbl, i % 2);
+    case 1:  return sdb_null( tbl);
+    case 2:  return sdb_string( tbl, "mixed");
+    case 3:  raw_int( & raw, i); return sdb_raw( tbl, raw.data, raw.len);
+    default: return sdb_int( tbl, i);
+    }
+}
+
+/* Fill a source table with given layout, consolidate it row by row and as
+ * a whole, into a destination table with given layout; serialize both. */
+static int run( enum sdb_layout_t src_layout, enum sdb_layout_t dst_layout,
+        buffer_t *src_out, buffer_t *dst_out) {
+    sdb_table_t src, dst;
+    bss_ctx_t bss;
+    int i, nrows, r;
+
+    r = sdb_init( & src, "sdb_test_src", SDB_SK_RAM,
+            "number", SDB_SM_LIST, "string", SDB_SM_LIST,
+            "raw", SDB_SM_LIST, "mixed", SDB_SM_LIST, NULL);
+    if( r) return r;
+    r = sdb_setlayout( & src, src_layout);
+    if( r) return r;
+    r = sdb_initwithoutcolumns( & dst, "sdb_test_dst", NCOLUMNS * NMETHODS, SDB_SK_RAM);
+    if( r) return r;
+    for( i=0; i<NCOLUMNS * NMETHODS; i++) {
+        char label[8];
+        sprintf( label, "c%d", i);
+        r = sdb_setcolumn( & dst, label, SDB_SM_LIST, 0.0);
+        if( r) return r;
+    }
+    r = sdb_setlayout( & dst, dst_layout);
+    if( r) return r;
+    sdb_setconstable( & src, & dst);
+    for( i=0; i<NCOLUMNS * NMETHODS; i++) {
+        r = sdb_setconscolumn( & src, i / NMETHODS, methods[i % NMETHODS]);
+        if( r) return r;
+    }
+
+    /* Consolidations of 1 to 7 rows without nils, then with them. */
+    for( nrows=1; nrows<=7; nrows++) {
+        for( i=0; i<nrows; i++) {
+            r = push_row( & src, nrows + i, 0);
+            if( r) return r;
+        }
+        r = sdb_consolidate( & src);
+        if( r) return r;
+        r = sdb_reset( & src);
+        if( r) return r;
+    }
+    for( i=0; i<20; i++) {
+        r = push_row( & src, i, 1);
+        if( r) return r;
+    }
+    r = sdb_consolidate( & src);
+    if( r) return r;
+
+    src_out->len = 0;
+    bss_init( & bss, buffer_writer, src_out);
+    r = sdb_serialize( & src, & bss);
+    if( r) return r;
+    dst_out->len = 0;
+    bss_init( & bss, buffer_writer, dst_out);
+    r = sdb_serialize( & dst, & bss);
+    if( r) return r;
+
+    sdb_close( & src);
+    sdb_close( & dst);
+    return SDB_EOK;
+}
+
+static int compare( const char *what, const buffer_t *expected, const buffer_t *got) {
+    if( expected->len == got->len && ! memcmp( expected->data, got->data, got->len)) return 0;
+    printf( "%s: serializations differ (%d bytes with rows, %d bytes)\n",
+            what, expected->len, got->len);
+    return 1;
+}
+
+int main( void) {
+    static const char *names[] = { "rows", "columns" };
+    static buffer_t ref_src, ref_dst, src, dst;
+    int src_layout, dst_layout, r, nfailures = 0;
+
+    r = run( SDB_LY_ROWS, SDB_LY_ROWS, & ref_src, & ref_dst);
+    if( r) {
+        printf( "rows/rows: failed with %d\n", r);
+        return 1;
+    }
+    for( src_layout=SDB_LY_ROWS; src_layout<=SDB_LY_COLUMNS; src_layout++) {
+        for( dst_layout=SDB_LY_ROWS; dst_layout<=SDB_LY_COLUMNS; dst_layout++) {
+            char what[32];
+            if( SDB_LY_ROWS == src_layout && SDB_LY_ROWS == dst_layout) continue;
+            sprintf( what, "%s/%s", names[src_layout], names[dst_layout]);
+            r = run( src_layout, dst_layout, & src, & dst);
+            if( r) {
+                printf( "%s: failed with %d\n", what, r);
+                nfailures++;
+                continue;
+            }
+            strcat( what, " source");
+            nfailures += compare( what, & ref_src, & src);
+            strcpy( what + strlen( what) - strlen( "source"), "consolidation");
+            nfailures += compare( what, & ref_dst, & dst);
+        }
+    }
+    printf( "%s\n", nfailures ? "FAIL" : "OK");
+    return nfailures ? 1 : 0;
+}
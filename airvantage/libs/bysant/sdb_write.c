@@ -216,19 +216,69 @@ void sdb_analyze_integer( sdb_table_t *tbl, int i) {
     }
 }
 
+/* Columnar layout. */
+
+int sdb_columns_resize( sdb_table_t *tbl, int nrows) {
+    int i;
+    /* The consolidation scratch buffer is sized after the columns. */
+    free( tbl->cons_buff);
+    tbl->cons_buff = NULL;
+    for( i=0; i<tbl->ncolumns; i++) {
+        sdb_column_t *column = tbl->columns + i;
+        if( 0 == nrows) {
+            free( column->values); column->values = NULL;
+            free( column->kinds);  column->kinds  = NULL;
+        } else {
+            double *values = realloc( column->values, nrows * sizeof( *values));
+            unsigned char *kinds;
+            if( ! values) return SDB_EMEM;
+            column->values = values;
+            kinds = realloc( column->kinds, nrows);
+            if( ! kinds) return SDB_EMEM;
+            column->kinds = kinds;
+        }
+    }
+    tbl->ncolumnrows = nrows;
+    return SDB_EOK;
+}
+
+/* Make sure the column arrays have room for the next cell. */
+static int sdb_columns_reserve( sdb_table_t *tbl) {
+    int row = tbl->nwrittenobjects / tbl->ncolumns;
+    if( row < tbl->ncolumnrows) return SDB_EOK;
+    return sdb_columns_resize( tbl,
+            tbl->ncolumnrows ? 2 * tbl->ncolumnrows : SDB_MIN_COLUMN_ROWS);
+}
+
+/* Store the next cell in its column; room must have been reserved. */
+static void sdb_columns_set( sdb_table_t *tbl, enum sdb_cell_kind_t kind, double value) {
+    sdb_column_t *column = tbl->columns + (tbl->nwrittenobjects % tbl->ncolumns);
+    int row = tbl->nwrittenobjects / tbl->ncolumns;
+    column->values[row] = value;
+    column->kinds[row]  = kind;
+    if( kind > SDB_CK_DOUBLE) column->nnonnumeric++;
+    tbl->nwrittenobjects++;
+}
+
 /* Public API. */
 
 int sdb_raw( sdb_table_t *tbl, unsigned const char *serialized_cell, int length) {
-  int r;
+  int r, offset;
   if( tbl->state != SDB_ST_READING) return SDB_EBADSTATE;
   if( tbl->maxwrittenobjects &&
       tbl->maxwrittenobjects >= tbl->nwrittenobjects)
     return SDB_EFULL;
+  if( tbl->columnar) {
+    r = sdb_columns_reserve( tbl);
+    if( r) return r;
+  }
   sdb_untrim( tbl);
   sdb_analyze_noninteger(tbl, 0);
+  offset = tbl->nwrittenbytes;
   r = sdb_bss_writer( serialized_cell, length, tbl);
   if( r<0) { return 0; }
   else if( r != length) { return SDB_EINTERNAL; }
+  else if( tbl->columnar) { sdb_columns_set( tbl, SDB_CK_SERIALIZED, offset); return SDB_EOK; }
   else { tbl->nwrittenobjects++; return SDB_EOK; }
 }
 
@@ -239,12 +289,19 @@ int sdb_double( sdb_table_t *tbl, double d) {
     if( tbl->maxwrittenobjects &&
         tbl->maxwrittenobjects >= tbl->nwrittenobjects)
         return SDB_EFULL;
-    sdb_untrim( tbl);
 
     if( tbl->columns[tbl->nwrittenobjects % tbl->ncolumns].serialization_method & SDB_SM_4_BYTES_FLOATS) {
         d = (double) (float) d;
     }
 
+    if( tbl->columnar) {
+        r = sdb_columns_reserve( tbl);
+        if( r) return r;
+        sdb_analyze_noninteger(tbl, 1);
+        sdb_columns_set( tbl, SDB_CK_DOUBLE, d);
+        return SDB_EOK;
+    }
+    sdb_untrim( tbl);
     sdb_analyze_noninteger(tbl, 1);
     r = bss_double(tbl->bss_ctx, d);
     if( r) {
@@ -255,28 +312,48 @@ int sdb_double( sdb_table_t *tbl, double d) {
     }
 }
 
-#define WRITER( name,  sdb_params, bss_args, analysis) \
+/* In columnar tables, cells of kind SDB_CK_SERIALIZED still go through
+ * bss, the others are only stored in their column array. */
+#define WRITER( name,  sdb_params, bss_args, analysis, cell_kind, cell_value) \
     int sdb_##name sdb_params { \
-        int r; \
+        int r, offset; \
         if( tbl->state != SDB_ST_READING) return SDB_EBADSTATE; \
         if( tbl->maxwrittenobjects && \
             tbl->maxwrittenobjects >= tbl->nwrittenobjects) \
             return SDB_EFULL; \
+        if( tbl->columnar) { \
+            r = sdb_columns_reserve( tbl); \
+            if( r) return r; \
+            if( SDB_CK_SERIALIZED != (cell_kind)) { \
+                analysis; \
+                sdb_columns_set( tbl, cell_kind, cell_value); \
+                return SDB_EOK; \
+            } \
+        } \
         sdb_untrim( tbl); \
         analysis; \
+        offset = tbl->nwrittenbytes; \
         r = bss_##name bss_args; \
-        if( r) { return r; } else { \
+        if( r) { return r; } else if( tbl->columnar) { \
+            sdb_columns_set( tbl, SDB_CK_SERIALIZED, offset); \
+            return SDB_EOK; \
+        } else { \
             tbl->nwrittenobjects++; \
             return SDB_EOK; \
         } \
     }
 
 WRITER( lstring, (sdb_table_t *tbl, const char *data, int length),
-                 (tbl->bss_ctx, data, length), sdb_analyze_noninteger(tbl, 0))
-WRITER( string,  (sdb_table_t *tbl, const char *data), (tbl->bss_ctx, data), sdb_analyze_noninteger(tbl, 0))
-WRITER( int,     (sdb_table_t *tbl, int i),            (tbl->bss_ctx, i),    sdb_analyze_integer(tbl, i))
-WRITER( bool,    (sdb_table_t *tbl, int b),            (tbl->bss_ctx, b),    sdb_analyze_noninteger(tbl, 0))
-WRITER( null,    (sdb_table_t *tbl),                   (tbl->bss_ctx),       sdb_analyze_noninteger(tbl, 0))
+                 (tbl->bss_ctx, data, length), sdb_analyze_noninteger(tbl, 0),
+                 SDB_CK_SERIALIZED, 0)
+WRITER( string,  (sdb_table_t *tbl, const char *data), (tbl->bss_ctx, data),
+                 sdb_analyze_noninteger(tbl, 0), SDB_CK_SERIALIZED, 0)
+WRITER( int,     (sdb_table_t *tbl, int i),            (tbl->bss_ctx, i),
+                 sdb_analyze_integer(tbl, i), SDB_CK_INT, i)
+WRITER( bool,    (sdb_table_t *tbl, int b),            (tbl->bss_ctx, b),
+                 sdb_analyze_noninteger(tbl, 0), b ? SDB_CK_TRUE : SDB_CK_FALSE, 0)
+WRITER( null,    (sdb_table_t *tbl),                   (tbl->bss_ctx),
+                 sdb_analyze_noninteger(tbl, 0), SDB_CK_NULL, 0)
 
 int sdb_number( sdb_table_t *tbl, double d) {
     int ix = (int) d;
@@ -286,3 +363,16 @@ int sdb_number( sdb_table_t *tbl, double d) {
         return sdb_double( tbl ,d);
     }
 }
+
+/* Write a cell read back with sdb_read_data(), typed when possible so that
+ * columnar tables keep it in their arrays. */
+int sdb_bsd( sdb_table_t *tbl, bsd_data_t *bsd_data,
+        unsigned const char *bytes, int nbytes) {
+    switch( bsd_data->type) {
+    case BSD_INT:    return sdb_int(    tbl, (int) bsd_data->content.i);
+    case BSD_DOUBLE: return sdb_double( tbl, bsd_data->content.d);
+    case BSD_BOOL:   return sdb_bool(   tbl, bsd_data->content.bool);
+    case BSD_NULL:   return sdb_null(   tbl);
+    default:         return sdb_raw(    tbl, bytes, nbytes);
+    }
+}
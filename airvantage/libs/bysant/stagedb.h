@@ -40,7 +40,7 @@
 // read/write from/to flash
 #endif
 #ifdef SDB_FILE_SUPPORT
-#include <stdio.h> // fopen, fread, fwrite, fclose
+#include <stdio.h> // fopen, fwrite, fclose
 #endif
 
 typedef unsigned char  sdb_ncolumn_t;   // max = 256 columns
@@ -109,6 +109,8 @@ typedef struct sdb_table_t {
     int nwrittenbytes;                 // # of bytes currently stored in chunks.
     int nwrittenobjects;             // # of objects currently stored in chunks.
     int maxwrittenobjects;         // max # of objects allowed. If 0, unlimited.
+    int ncolumnrows;          // # of rows allocated in columnar layout arrays.
+    double *cons_buff;         // columnar consolidation scratch, maybe NULL.
     sdb_ncolumn_t conf_col;              // tmp counter for table configuration.
     char  *conf_strings;                        // store column and table names.
     struct bss_ctx_t *bss_ctx;          // serialization to the staging storage.
@@ -116,6 +118,7 @@ typedef struct sdb_table_t {
     short  conf_string_idx;             // where id and column names are stored.
     unsigned nilforbidden: 1;  // if true, trying to push a nil causes an error.
     unsigned checkxtrakeys: 1;                     // (used by Lua exportation).
+    unsigned columnar: 1;             // if true, cells are stored by column.
 } sdb_table_t;
 
 // TODO could be converted to: union {
@@ -156,6 +159,12 @@ enum sdb_serialization_method_t {
 
 #define SDB_DEFAULT_SERIALIZATION_METHOD SDB_SM_SMALLEST
 
+/* How cells are kept in RAM until the table is serialized. */
+enum sdb_layout_t {
+    SDB_LY_ROWS,      // Cells serialized as they come, row after row (default).
+    SDB_LY_COLUMNS    // Numbers, booleans and nils kept in one array per column.
+};
+
 /* Initialize a table structure, return SDB_EOK or SDB_EMEM.
  * The result table must still have its columns configured with
  * calls to sdb_column() before it can accept data.
@@ -220,6 +229,16 @@ int sdb_setconscolumn( sdb_table_t *src,
  * more rows than would be allowed. */
 int sdb_setmaxrows( sdb_table_t *tbl, sdb_nrow_t nrows);
 
+/* Choose how an empty RAM table stores its cells.
+ * With SDB_LY_COLUMNS, numeric cells are kept unserialized in typed arrays,
+ * one per column: consolidations then run directly on these arrays, and
+ * cells are only serialized when the table itself is serialized. This
+ * costs 9 bytes per numeric cell, more than the serialized form of small
+ * integers. Strings and raw cells are still serialized as they come.
+ * Return SDB_EBADSTATE if the table already holds data, SDB_EINVALID if
+ * it isn't stored in RAM. */
+int sdb_setlayout( sdb_table_t *tbl, enum sdb_layout_t layout);
+
 int sdb_consolidate( sdb_table_t *src);
 
 /* Retrieve a column number from its name.
@@ -100,6 +100,11 @@ end
 -- It deserializes data, passed as a string or list of strings parameter, through
 -- method `:deserialize(data)`.
 --
+-- Method `:read(data, offset)` pulls a single token instead, and returns the
+-- strings it reads as offsets into `data` rather than as new strings; see
+-- `bysant_core_deserialize.c`. It can be mixed with `:deserialize()` and
+-- `:skip()`, which then handle the next value of the container being read.
+--
 -- @usage
 --
 -- m3da = require 'm3da.bysant'
@@ -25,6 +25,25 @@
 #define MT_NAME "m3da.bysant.core.dctx"
 #define CKSTACK(L, x) luaL_checkstack( L, x, "M3DA Bysant deserializer")
 
+/* Deserializer userdata: the decoding context, and the number of its stack
+ * frames that belong to containers opened by `read` and not closed yet.
+ * Frames above `readdepth` belong to a value whose deserialization has been
+ * interrupted, i.e. to a hibernated state. */
+typedef struct dctx_t {
+    bsd_ctx_t ctx;
+    int readdepth;
+} dctx_t;
+
+static dctx_t *checkdctx( lua_State *L, int idx) {
+    return (dctx_t *) luaL_checkudata( L, idx, MT_NAME);
+}
+
+/* Reset the context, e.g. after an error left it in an unknown state. */
+static void reset_dctx( dctx_t *d) {
+    bsd_init( & d->ctx);
+    d->readdepth = 0;
+}
+
 //store shortcut in reference system, containing niltoken, set at init
 static int niltoken_reg = 0;
 //push onto the stack the niltoken set at init
@@ -194,10 +213,19 @@ static int dehibernate( lua_State *L, int idx) {
 }
 
 
+/* Deserialize or skip the next value. When the context is inside a
+ * container, typically after some tokens have been pulled with `read`, only
+ * the next value of that container is handled; if that container is closed
+ * instead, the closing is consumed and no value is returned.
+ * `base` is the nesting level of the value being handled: stack frames below
+ * it belong to containers opened by `read` and must be neither closed nor
+ * stored in the value. */
 // TODO: protect against invalid offsets
 static int deserialize_or_skip( lua_State *L, int skip) {
-    bsd_ctx_t *ctx = (bsd_ctx_t *) luaL_checkudata( L, 1, MT_NAME);
+    dctx_t *d = checkdctx( L, 1);
+    bsd_ctx_t *ctx = & d->ctx;
     size_t len, initial_depth;
+    int base = d->readdepth;
     const uint8_t *buffer;
 
     /* Retrieve optional args: offset and partial deserialization */
@@ -231,13 +259,14 @@ static int deserialize_or_skip( lua_State *L, int skip) {
 
     // TODO: not good enough. It must be impossible for users to mix up an hibernation
     // step with the wrong deserializer, as it can cause core dumps.
-    if( ! partial && ctx->stacksize) {
+    if( ! partial && ctx->stacksize > base) {
         luaL_error( L, "Attempt to deserialize new data with an hibernated state");
-    } else if( partial && ! ctx->stacksize) {
+    } else if( partial && ctx->stacksize <= base) {
         luaL_error( L, "Attempt to resume a deserialization with an empty deserializer");
     }
 
-    if( len <= offset) { /* Nothing to read */
+    /* Nothing to read; inside a container, its closing may need no byte */
+    if( len <= offset && (partial || ! ctx->stacksize)) {
         lua_pushnil( L);
         lua_pushnumber( L, offset);
         return 2;
@@ -250,10 +279,14 @@ static int deserialize_or_skip( lua_State *L, int skip) {
             int r = bsd_read( ctx, & data, buffer + offset, len - offset);
             if( r < 0) {
                 return 0;  // end-of-string reached
+            } else if( BSD_ERROR == data.type) {
+                reset_dctx( d);
+                return luaL_error( L, "invalid bysant data at offset %d", offset + 1);
             } else {
                 offset += r;
             }
-        } while( ctx->stacksize > 0 || data.type == BSD_CLASSDEF);
+        } while( ctx->stacksize > base || data.type == BSD_CLASSDEF);
+        if( ctx->stacksize < base) d->readdepth = ctx->stacksize; /* enclosing container closed */
         lua_pushinteger( L, offset+1);
         return 1;
 
@@ -278,12 +311,20 @@ static int deserialize_or_skip( lua_State *L, int skip) {
                 lua_pushvalue(  L, -3); // hibernated_stack, nil, "partial", hibernated_stack
                 return 3;
             }
+            if( ctx->stacksize < base) { /* enclosing container closed */
+                d->readdepth = ctx->stacksize;
+                lua_pushnil( L);
+                lua_pushinteger( L, offset + r + 1);
+                return 2;
+            }
+            /* values completed at the base level are not part of any container */
+            if( ctx->stacksize == base) data.kind = BSD_KTOPLEVEL;
             if( bysant2lua( L, &data)) {
-                bsd_init( ctx);
+                reset_dctx( d);
                 lua_error( L);
             }
             offset += r;
-        } while( ctx->stacksize > 0 || data.type == BSD_CLASSDEF);
+        } while( ctx->stacksize > base || data.type == BSD_CLASSDEF);
         lua_pushinteger( L, offset+1);
         return 2;
     }
@@ -304,29 +345,153 @@ static int api_skip( lua_State *L) {
     return deserialize_or_skip( L, 1);
 }
 
+/* Names returned by `read`, kept as upvalues of its closure so that they
+ * don't need to be hashed again for every token. */
+enum token_name_t {
+    TN_TOP = 1, TN_ITEM, TN_KEY, TN_VALUE, TN_CHUNK,
+    TN_NUMBER, TN_BOOLEAN, TN_NULL, TN_STRING, TN_CHUNKED,
+    TN_LIST, TN_MAP, TN_OBJECT, TN_CLOSE, TN_CLASSDEF, TN_UNKNOWN, TN_LAST
+};
+static const char *const token_names[] = { NULL, "top", "item", "key", "value", "chunk",
+    "number", "boolean", "null", "string", "chunked",
+    "list", "map", "object", "close", "classdef", "unknown" };
+
+/* Token names indexed by enum bsd_data_type_t. */
+static const enum token_name_t data_type_names[] = {
+    TN_UNKNOWN, TN_CLOSE, TN_NULL, TN_NUMBER, TN_BOOLEAN,   // BSD_ERROR...
+    TN_NUMBER, TN_STRING, TN_CHUNKED, TN_CHUNK, TN_LIST,    // BSD_DOUBLE...
+    TN_LIST, TN_MAP, TN_MAP, TN_OBJECT, TN_CLASSDEF };      // BSD_ZLIST...
+
+#define PUSH_TOKEN_NAME( L, n) lua_pushvalue( L, lua_upvalueindex( n))
+
+/* Pushes the kind of the next value to be read in the innermost container:
+ * the field name (or 1-based field index for unnamed classes) in objects,
+ * a kind name otherwise. Must be called before that value is read. */
+static void push_slotkind( lua_State *L, bsd_ctx_t *ctx) {
+    const struct bsd_stackframe_t *f = ctx->stack + ctx->stacksize;
+    switch( f->kind) {
+    case BS_FMAP: case BS_FZMAP:
+        PUSH_TOKEN_NAME( L, f->content.map.even ? TN_KEY : TN_VALUE);
+        break;
+    case BS_FOBJECT: {
+        const bs_class_t *classdef = f->content.object.classdef;
+        int idx = classdef->nfields - f->missing;
+        if( idx >= classdef->nfields) PUSH_TOKEN_NAME( L, TN_TOP); // object about to be closed
+        else if( NULL != classdef->fields[idx].name) lua_pushstring( L, classdef->fields[idx].name);
+        else lua_pushinteger( L, idx + 1);
+        break;
+    }
+    case BS_FLIST: case BS_FZLIST: PUSH_TOKEN_NAME( L, TN_ITEM);  break;
+    case BS_FCHUNKED:              PUSH_TOKEN_NAME( L, TN_CHUNK); break;
+    default:                       PUSH_TOKEN_NAME( L, TN_TOP);   break;
+    }
+}
+
+/* Pull a single token from a Bysant string, without building any Lua value:
+ * `ctx:read(buffer [, offset])` returns `next_offset, type, kind, a, b`.
+ *
+ * `kind` is the token's position in its container: "top", "item", "key",
+ * "value", "chunk", or, inside objects, the field's name (its 1-based index
+ * for unnamed classes). Depending on `type`:
+ *  - "number", "boolean": `a` is the value;
+ *  - "null": no value;
+ *  - "string", "chunk": `a` and `b` are the first and last offsets of the
+ *    bytes in `buffer`, i.e. a view which `buffer:sub(a, b)` turns into a string;
+ *  - "list", "map": `a` is the number of elements, nil for variable size;
+ *  - "object": `a` is the class name, or the class id for unnamed classes;
+ *  - "chunked": start of a chunked string, whose chunks and "close" follow;
+ *  - "close": end of a container, whose type is `a`;
+ *  - "classdef": a class definition, now known by the deserializer.
+ * Returns `nil, "partial"` if `buffer` doesn't hold the whole token: the
+ * context is left untouched and the read can be retried at the same offset
+ * once more data is appended to the buffer.
+ * Throws errors on invalid data, or if a partial deserialization is pending.
+ * `deserialize` and `skip` can be mixed with `read` to handle the next value
+ * of the current container as a whole. */
+static int api_read( lua_State *L) {
+    dctx_t *d = checkdctx( L, 1);
+    bsd_ctx_t *ctx = & d->ctx;
+    size_t len;
+    const char *buffer = luaL_checklstring( L, 2, & len);
+    int offset = luaL_optinteger( L, 3, 1) - 1, kind, r;
+    bsd_data_t data;
+
+    if( offset < 0 || offset > len) luaL_argerror( L, 3, "offset out of buffer");
+    if( ctx->stacksize > d->readdepth) {
+        return luaL_error( L, "Attempt to read tokens with an hibernated state");
+    }
+    CKSTACK( L, 6);
+    push_slotkind( L, ctx); // must be known before reading, for new containers
+    kind = lua_gettop( L);
+    r = bsd_read( ctx, & data, (const uint8_t *) buffer + offset, len - offset);
+    if( r < 0) {
+        lua_pushnil( L);
+        lua_pushstring( L, "partial");
+        return 2;
+    }
+    if( BSD_ERROR == data.type) {
+        reset_dctx( d);
+        return luaL_error( L, "invalid bysant data at offset %d", offset + 1);
+    }
+    d->readdepth = ctx->stacksize;
+    lua_pushinteger( L, offset + r + 1);
+    PUSH_TOKEN_NAME( L, data_type_names[data.type]);
+    if( BSD_CLOSE != data.type) {
+        lua_pushvalue( L, kind);
+    } else { /* the closed container's own kind is only known now */
+        const struct bsd_stackframe_t *f = ctx->stack + ctx->stacksize;
+        switch( data.kind) {
+        case BSD_KOBJFIELD:
+            if( NULL != data.fieldname) lua_pushstring( L, data.fieldname);
+            else lua_pushinteger( L, f->content.object.classdef->nfields - f->missing);
+            break;
+        case BSD_KLISTITEM: PUSH_TOKEN_NAME( L, TN_ITEM);  break;
+        case BSD_KMAPKEY:   PUSH_TOKEN_NAME( L, TN_KEY);   break;
+        case BSD_KMAPVALUE: PUSH_TOKEN_NAME( L, TN_VALUE); break;
+        default:            PUSH_TOKEN_NAME( L, TN_TOP);   break;
+        }
+    }
+    switch( data.type) {
+    case BSD_INT:    lua_pushnumber( L, data.content.i);     return 4;
+    case BSD_DOUBLE: lua_pushnumber( L, data.content.d);     return 4;
+    case BSD_BOOL:   lua_pushboolean( L, data.content.bool); return 4;
+    case BSD_STRING: case BSD_CHUNK: /* view into the buffer */
+        lua_pushinteger( L, data.content.string.data - buffer + 1);
+        lua_pushinteger( L, data.content.string.data - buffer + data.content.string.length);
+        return 5;
+    case BSD_LIST: case BSD_MAP: lua_pushinteger( L, data.content.length); return 4;
+    case BSD_OBJECT:
+        if( NULL == data.content.classdef->classname) lua_pushinteger( L, data.content.classdef->classid);
+        else lua_pushstring( L, data.content.classdef->classname);
+        return 4;
+    case BSD_CLOSE: PUSH_TOKEN_NAME( L, data_type_names[data.content.cont_type]); return 4;
+    default: return 3;
+    }
+}
+
 static int api_collect( lua_State *L) {
-    bsd_reset( (bsd_ctx_t *) luaL_checkudata( L, 1, MT_NAME));
+    bsd_reset( & checkdctx( L, 1)->ctx);
     return 0;
 }
 
 static int api_init( lua_State *L) {
-    bsd_ctx_t *ctx = (bsd_ctx_t *) lua_newuserdata( L, sizeof( bsd_ctx_t)); // udata
+    dctx_t *d = (dctx_t *) lua_newuserdata( L, sizeof( dctx_t)); // udata
     lua_getfield( L, LUA_REGISTRYINDEX, MT_NAME); // mt, udata
     lua_setmetatable( L, -2); // udata
-    bsd_init( ctx);
+    reset_dctx( d);
     return 1;
 }
 
 static int api_dump( lua_State *L) {
     size_t len;
-    bsd_ctx_t *ctx = (bsd_ctx_t *) luaL_checkudata( L, 1, MT_NAME);
+    bsd_ctx_t *ctx = & checkdctx( L, 1)->ctx;
     const uint8_t *buffer = (const uint8_t *) luaL_checklstring( L, 2, &len);
     bsd_dump( ctx, stdout, buffer, len);
     return 0;
 }
 
 static int api_addClass( lua_State *L) {
-    bsd_ctx_t *ctx = (bsd_ctx_t *) luaL_checkudata( L, 1, MT_NAME); // 1=>udata
+    bsd_ctx_t *ctx = & checkdctx( L, 1)->ctx; // 1=>udata
     bs_class_t *classdef = lua_bs_toclassdef( L, 2);
     int r = bsd_addClass( ctx, classdef);
     if( 0 != r) free(classdef);
@@ -335,6 +500,7 @@ static int api_addClass( lua_State *L) {
 }
 
 int luaopen_m3da_bysant_core_deserialize( lua_State *L) {
+    int i;
     luaL_findtable( L, LUA_GLOBALSINDEX, "m3da.bysant.core", 14); // m3da.bysant.core
 
     //TODO: check if this m3da.niltoken 'global' is still needed! -> likely to be removed
@@ -371,7 +537,7 @@ int luaopen_m3da_bysant_core_deserialize( lua_State *L) {
 
     luaL_newmetatable( L, MT_NAME);        // m3da.bysant.core, mt
     lua_pushcfunction( L, api_collect); lua_setfield( L, -2, "__gc");
-    lua_createtable( L, 0, 3);             // m3da.bysant.core, mt, __index
+    lua_createtable( L, 0, 5);             // m3da.bysant.core, mt, __index
 
 
     lua_pushcfunction( L, api_deserialize);// m3da.bysant.core, mt, __index, deserialize
@@ -382,6 +548,8 @@ int luaopen_m3da_bysant_core_deserialize( lua_State *L) {
     lua_pushcfunction( L, api_dump);     lua_setfield( L, -2, "dump");
     lua_pushcfunction( L, api_addClass); lua_setfield( L, -2, "addClass");
     lua_pushcfunction( L, api_skip);     lua_setfield( L, -2, "skip");
+    for( i=1; i<TN_LAST; i++) lua_pushstring( L, token_names[i]);
+    lua_pushcclosure( L, api_read, TN_LAST-1); lua_setfield( L, -2, "read");
 
     lua_setfield( L, -2, "__index");           // m3da.bysant.core, mt[__index]
     lua_pushstring( L, "bysant.deserializer"); // m3da.bysant.core, mt, "bysant.deserializer"
@@ -15,16 +15,17 @@
 
 ------------------------------------------------------------------------------
 -- This module allows to save and retrieve Lua values in table-like objects, in
--- a non-volatile way. Once stored in a persisted table, these Lua values can
--- be retrieved even after the Lua process and/or the CPU running it have been
--- rebooted.
+-- a non-volatile way. Once stored in a persisted table, and committed to the
+-- file system, these Lua values can be retrieved even after the Lua process
+-- and/or the CPU running it have been rebooted (see `persist.DURABILITY`
+-- below for when writes are committed).
 --
 -- Compared to raw files, the `persist` module offers a higher level of
 -- abstraction, allowing to save and retrieve Lua objects directly, without
 -- explicitly dealing with serialization, deserialization or other filesystem
 -- issues. It can also be ported to environmnets which don't have a filesystem.
 --
--- This version of the module naively writes data in a file, and keeps whole
+-- This version of the module appends writes to a log file, and keeps whole
 -- tables' content in RAM. Its purpose is to avoid using the more efficient QDBM
 -- version, whose LGPL license might be problematic to some use cases.
 --
@@ -119,8 +120,32 @@
 -- POSIX implementation details.
 -- -----------------------------
 --
--- All objects are saved in a SQLITE3 database file called
--- persist/persist.sqlite3.
+-- Each table is saved in a file called persist/<name>.l2b. Writes are kept
+-- in RAM then group-committed to the file as a single checksummed record,
+-- according to `persist.DURABILITY`:
+--
+-- * `"sync"`: every write is committed before the assignment returns. It
+--   survives a reboot as soon as it's done;
+-- * `"batch"` (default): writes are committed at most `persist.COMMIT_DELAY`
+--   seconds after they happened. A crash or power loss within that delay
+--   loses them;
+-- * `"lazy"`: writes are only committed by @{#table.commit} or
+--   @{#table.commitall}. A crash or power loss loses all the writes made
+--   since the last commit.
+--
+-- Whatever the level, writes are committed as soon as `persist.COMMIT_SIZE`
+-- bytes are pending, and when the agent stops. Assignments to a persisted
+-- table never throw because of the file: the errors of commits made in the
+-- background are only logged, @{#table.commit} returns them. @{#persist.save}
+-- always commits before returning, and throws on failure.
+--
+-- "Committed" means written and flushed to the file system: data still in the
+-- OS cache can be lost on power loss. A record interrupted by a crash is
+-- detected by its checksum and discarded, along with the writes it held, when
+-- the table is loaded again.
+--
+-- Overwritten entries are removed from the file by a recompaction, which
+-- runs as a background task once they outnumber live entries.
 --
 -- @module persist
 --
@@ -128,6 +153,8 @@
 local l2b      = require 'luatobin'
 local checks   = require 'checks'
 local log      = require 'log'
+local sched    = require 'sched'
+local timer    = require 'timer'
 
 require "pack"
 
@@ -146,13 +173,34 @@ local M = { }
 M.MAX_LOSS_RATIO = 1
 M.MIN_LOSS = 256
 
+-- durability level of writes: "sync", "batch" or "lazy" (see module doc).
+M.DURABILITY = 'batch'
+-- max delay in seconds between a write and its commit, in "batch" mode.
+M.COMMIT_DELAY = 1
+-- pending writes are committed as soon as their serialized size reaches this.
+M.COMMIT_SIZE = 4096
+-- number of entries rewritten by each step of a background recompaction.
+M.RECOMPACT_STEP = 64
+
+-- Every file starts with MAGIC, followed by records. A record is a 4 bytes
+-- big endian payload length, the payload's 4 bytes Adler-32 checksum, then
+-- the payload: the luatobin serialization of a sequence of key/value pairs.
+-- Files without MAGIC are in the former format, i.e. bare key/value pairs.
+local MAGIC = "persist.file\1\n"
+local HEADER_SIZE = 8
+
 -- Cache to share multiple instances of the same table
 local cache = setmetatable({},{__mode = "v"})
 
+-- Tables with pending writes, kept alive until they are committed
+local dirty = { }
+
 -- initialize the whole persist module
 function M.init()
     if M.initialized then return 'already initialized' end
     M.initialized = true
+    -- don't lose pending writes when the agent is stopped or rebooted
+    sched.sigHook('system', 'stop', function() M.table.commitall() end)
     return 'ok'
 end
 
@@ -169,19 +217,137 @@ end
 
 M.table = { } -- sub-module persist.table
 
+local function adler32(s)
+    local a, b = 1, 0
+    -- sums can't exceed 2^53 within a 1024 bytes block: reduce once per block
+    for i = 1, #s, 1024 do
+        local bytes = { s :byte(i, i+1023) }
+        for j = 1, #bytes do a = a + bytes[j]; b = b + a end
+        a, b = a % 65521, b % 65521
+    end
+    return b * 65536 + a
+end
+
+-- Builds a record from a list of serialized keys and values
+local function makerecord(chunks)
+    local payload = table.concat(chunks)
+    return string.pack(">II", #payload, adler32(payload)) .. payload
+end
+
+local function filename(self)
+    return persist_path..self.__id..'.l2b'
+end
+
+-- Writes all pending writes in the file, as a single record.
+-- Returns true, or nil + error message if the record couldn't be written.
+local function commit(self)
+    dirty[self] = nil
+    if next(self.__pending) == nil then return true end
+    local chunks = { }
+    for _, kv in pairs(self.__pending) do table.insert(chunks, kv) end
+    local record = makerecord(chunks)
+    self.__pending = { }
+    self.__pendingsize = 0
+    local ok, errmsg = self.__file :write(record)
+    if ok then ok, errmsg = self.__file :flush() end
+    if not ok then
+        log('PERSIST-FILE', 'ERROR', "Can't commit table %s: %s", self.__id, tostring(errmsg))
+    end
+    local rc = self.__recompaction
+    if rc then table.insert(rc.tail, record) end
+    if not ok then return nil, errmsg end
+    return true
+end
+
+-- Replaces the table's file with the complete file `tmpname`
+local function swapfile(self, tmpname)
+    local ok, errmsg = os.rename(tmpname, filename(self))
+    if not ok then
+        log('PERSIST-FILE', 'ERROR', "Can't replace file of table %s: %s", self.__id, tostring(errmsg))
+        os.remove(tmpname)
+        return nil, errmsg
+    end
+    self.__file :close()
+    self.__file = assert(io.open(filename(self), 'ab'))
+    return 'ok'
+end
+
+-- Synchronously rewrites the whole table in a new file. Used when loading a
+-- file whose tail is damaged or which uses the former format.
+local function rewrite(self)
+    local chunks = { }
+    for k, v in pairs(self.__cache) do
+        table.insert(chunks, l2b.serialize(k))
+        table.insert(chunks, l2b.serialize(v))
+    end
+    local tmpname = filename(self)..'.tmp'
+    local file, errmsg = io.open(tmpname, 'wb')
+    local ok = file
+    if file then
+        ok, errmsg = file :write(MAGIC, makerecord(chunks))
+        file :close()
+    end
+    if not ok then
+        log('PERSIST-FILE', 'ERROR', "Can't rewrite table %s: %s", self.__id, tostring(errmsg))
+        os.remove(tmpname)
+        return nil, errmsg
+    end
+    return swapfile(self, tmpname)
+end
+
+-- Background recompaction: rewrites the entries listed in `rc.keys` in a new
+-- file, a few at a time, then appends the records committed meanwhile,
+-- which have been saved in `rc.tail`, and replaces the table's file with it.
+local function recompact(self, rc)
+    local tmpname = filename(self)..'.tmp'
+    local file, errmsg = io.open(tmpname, 'wb')
+    local ok = file
+    if file then ok, errmsg = file :write(MAGIC) end
+    local keys = rc.keys
+    local i = 1
+    while ok and not rc.cancelled and i <= #keys do
+        local chunks = { }
+        local last = math.min(i+M.RECOMPACT_STEP-1, #keys)
+        for j = i, last do
+            local k = keys[j]
+            local v = self.__cache[k]
+            if v ~= nil then
+                table.insert(chunks, l2b.serialize(k))
+                table.insert(chunks, l2b.serialize(v))
+            end
+        end
+        if chunks[1] then ok, errmsg = file :write(makerecord(chunks)) end
+        i = last + 1
+        sched.wait()
+    end
+    for _, record in ipairs(rc.tail) do
+        if not ok or rc.cancelled then break end
+        ok, errmsg = file :write(record)
+    end
+    if file then file :close() end
+    -- only release our own state, never a recompaction started after this one
+    if self.__recompaction == rc then self.__recompaction = false end
+    if rc.cancelled then
+        os.remove(tmpname)
+    elseif not ok then
+        log('PERSIST-FILE', 'ERROR', "Can't recompact table %s: %s", self.__id, tostring(errmsg))
+        os.remove(tmpname)
+    elseif swapfile(self, tmpname) then
+        -- entries overridden during the recompaction are still in the file
+        self.__overridden = self.__overridden - rc.overridden
+    end
+end
+
 -- Remove useless entries from a table
-local function recompact(self)
+local function startrecompaction(self)
     log('PERSIST-FILE', 'DEBUG',
         "%d entries wasted for %d entries, recompacting table %s",
         self.__overridden, self.__length, self.__id)
-    local file = io.open(persist_path..self.__id..'.l2b', 'wb') -- overwrite
-    for k, v in pairs(self.__cache) do
-        file :write(l2b.serialize(k))
-        file :write(l2b.serialize(v))
-    end
-    self.__file :flush()
-    self.__file = file
-    self.__overridden = 0
+    local keys = { }
+    for k in pairs(self.__cache) do table.insert(keys, k) end
+    local rc = { keys = keys, tail = { }, overridden = self.__overridden }
+    self.__recompaction = rc
+    sched.run(recompact, self, rc)
 end
 
 local TABLE_MT = { __type = 'persist.file' }
@@ -189,20 +355,27 @@ local TABLE_MT = { __type = 'persist.file' }
 -- Sets or deletes keys/values in DB
 function TABLE_MT :__newindex (k, v)
     --printf("Writing table %d (deserialized): [%s]=%s", self.__id, sprint(k), sprint(v))
-    if self.__cache[k]
+    -- a write replacing a pending one never reaches the file
+    local previous = self.__pending[k]
+    if previous then
+        self.__pendingsize = self.__pendingsize - #previous
+    elseif self.__cache[k]
     then self.__overridden = self.__overridden + 1
     else self.__length = self.__length + 1 end
     self.__cache[k] = v
-    if self.__overridden > M.MIN_LOSS
+    log('PERSIST-FILE', 'DEBUG', "wrote %s=%s", tostring(k), tostring(v))
+    local kv = l2b.serialize(k)..l2b.serialize(v)
+    self.__pending[k] = kv
+    self.__pendingsize = self.__pendingsize + #kv
+    if M.DURABILITY == 'sync' or self.__pendingsize >= M.COMMIT_SIZE then
+        commit(self)
+    elseif not dirty[self] then
+        dirty[self] = true
+        if M.DURABILITY == 'batch' then timer.latencyExec(self.__commitjob, M.COMMIT_DELAY) end
+    end
+    if not self.__recompaction and self.__overridden > M.MIN_LOSS
     and self.__overridden/self.__length > M.MAX_LOSS_RATIO then
-        recompact(self)
-    else
-        log('PERSIST-FILE', 'DEBUG', "wrote %s=%s", tostring(k), tostring(v))
-        local sk = l2b.serialize(k)
-        self.__file :write(sk)
-        local sv = l2b.serialize(v)
-        self.__file :write(sv)
-        self.__file :flush()
+        startrecompaction(self)
     end
 end
 
@@ -219,6 +392,47 @@ function TABLE_MT:__ipairs(...)
     return ipairs(self.__cache)
 end
 
+-- Adds to the table's cache the key/value pairs serialized in `s`, from
+-- `offset` to the end of `s`
+local function loadpairs(self, s, offset)
+    while offset <= #s do
+        local k, v
+        offset, k, v = l2b.deserialize(s, 2, offset)
+        if k==nil then break end
+        if self.__cache[k] then
+            self.__overridden = self.__overridden+1
+        else self.__length = self.__length + 1 end
+        self.__cache[k] = v
+    end
+end
+
+-- Loads the content of a table's file.
+-- Returns true if the file must be rewritten, because it uses the former
+-- format or ends with a damaged record.
+local function loadfile(self, content)
+    if content :sub(1, #MAGIC) ~= MAGIC then
+        local ok, errmsg = pcall(loadpairs, self, content, 1)
+        if not ok then
+            log('PERSIST-FILE', 'WARNING', "Table %s: damaged tail ignored: %s", self.__id, errmsg)
+        end
+        return true
+    end
+    local offset = #MAGIC + 1
+    while offset <= #content do
+        local _, len, sum = string.unpack(content, ">II", offset)
+        local first = offset + HEADER_SIZE
+        local payload = len and content :sub(first, first+len-1)
+        if not payload or #payload ~= len or adler32(payload) ~= sum then
+            log('PERSIST-FILE', 'WARNING', "Table %s: damaged record at offset %d ignored, with %d bytes after it",
+                self.__id, offset-1, #content-offset+1)
+            return true
+        end
+        loadpairs(self, payload, 1)
+        offset = first + len
+    end
+    return false
+end
+
 ------------------------------------------------------------------------------
 -- Creates or loads a new persisted table.
 --
@@ -255,30 +469,51 @@ function M.table.new(name)
     end
 
     local self = {
-        __id         = name,
-        __cache      = { },
-        __overridden = 0,
-        __length     = 0,
-        __file       = file }
+        __id            = name,
+        __cache         = { },
+        __overridden    = 0,
+        __length        = 0,
+        __file          = file,
+        __pending       = { }, -- key -> serialized key/value pair not committed yet
+        __pendingsize   = 0,
+        __recompaction  = false } -- running recompaction's state, if any
+    self.__commitjob = function() commit(self) end
 
     cache[name] = self
 
-    if filecontent then
-        local offset=1
-        while true do
-            local k, v
-            offset, k, v = l2b.deserialize(filecontent, 2, offset)
-            if k==nil then break end
-            if self.__cache[k] then
-                self.__overridden = self.__overridden+1
-            else self.__length = self.__length + 1 end
-            self.__cache[k] = v
-        end
+    if not filecontent or filecontent == "" then
+        file :write(MAGIC)
+        file :flush()
+    elseif loadfile(self, filecontent) then
+        rewrite(self)
     end
     setmetatable(self, TABLE_MT)
     return self
 end
 
+------------------------------------------------------------------------------
+-- Writes the pending writes of a table in its file.
+--
+-- @function [parent=#table] commit
+-- @param t persited table returned by @{#table.new} call.
+-- @return `true` on success.
+-- @return `nil` + error message otherwise.
+--
+
+function M.table.commit(self)
+    return commit(self)
+end
+
+------------------------------------------------------------------------------
+-- Writes the pending writes of all tables in their files.
+--
+-- @function [parent=#table] commitall
+--
+
+function M.table.commitall()
+    for t in pairs(dirty) do commit(t) end
+end
+
 ------------------------------------------------------------------------------
 -- Empties a table and releases associateed resources.
 --
@@ -289,8 +524,14 @@ end
 function M.table.empty(self)
     self.__length = 0
     self.__overridden = 0
+    self.__pending = { }
+    self.__pendingsize = 0
+    dirty[self] = nil
+    if self.__recompaction then self.__recompaction.cancelled = true end
     self.__file :close()
     self.__file = assert(io.open(persist_path..self.__id..'.l2b', 'wb')); -- truncate file to 0
+    self.__file :write(MAGIC)
+    self.__file :flush()
     self.__cache = { }
 end
 
@@ -314,9 +555,11 @@ end
 ------------------------------------------------------------------------------
 -- Saves an object for later retrieval.
 --
--- If the saving operation cannot be performed successfully, an error is thrown.
--- Objects saved with this function can be retrieved with @{#persist.load}, by
--- giving back the same name, even after a reboot.
+-- The object is written in the file before this function returns, whatever
+-- `persist.DURABILITY`. If the saving operation cannot be performed
+-- successfully, an error is thrown. Objects saved with this function can be
+-- retrieved with @{#persist.load}, by giving back the same name, even after a
+-- reboot.
 --
 -- @function [parent=#persist] save
 -- @param name the name of the persisted object to save.
@@ -332,6 +575,8 @@ end
 function M.save(name, obj)
     checks('string', '?')
     store[name] = obj
+    local ok, errmsg = commit(store)
+    if not ok then error("can't save "..name..": "..tostring(errmsg)) end
 end
 
 ------------------------------------------------------------------------------
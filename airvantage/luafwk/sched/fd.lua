@@ -34,14 +34,66 @@ proc.fd = fdt
 sched.fd = { }
 
 local monotonic_time = require 'sched.timer.core'.time
+-- Loaded before any socket is created: at lua_close(), the library must be
+-- unloaded after the sockets, whose finalizers unregister them from epoll.
+local psignal = require 'sched.posixsignal'
 local math_min = math.min
 
+------------------------------------------------------------------------------
+-- Readiness backend: "epoll" where available, "select" otherwise.
+-- Set `sched.fd.BACKEND` to "select" before any file descriptor is watched
+-- to force select().
+--
+-- With select(), every watched file descriptor is scanned at every scheduler
+-- loop iteration. With epoll, file descriptors are (un)registered in the
+-- kernel when they're watched / unwatched, and waiting only costs the number
+-- of ready ones.
+------------------------------------------------------------------------------
+sched.fd.BACKEND = false
+
+local epoll -- true when the epoll backend is used, nil until the backend is chosen
+
+-- Objects watched for reading which have buffered data: they won't be
+-- reported by epoll, so they're reported readable at the next step.
+local dirty = { }
+
+------------------------------------------------------------------------------
+-- Update the epoll registration of a file descriptor after a watch list change
+------------------------------------------------------------------------------
+local function epoll_update(fd)
+  return psignal.epoll_ctl(fd, fdt.wait_read[fd], fdt.wait_write[fd], fdt.wait_except[fd])
+end
+
+local function init_backend()
+  epoll = sched.fd.BACKEND ~= "select" and psignal.epoll_wait and true or false
+  if epoll then -- a first non-blocking wait creates the epoll set, or fails
+    local ok, errmsg = psignal.epoll_wait(0)
+    if not ok then
+      log('SCHED', 'ERROR', "Can't use epoll, falling back to select(): %s", tostring(errmsg))
+      epoll = false
+    end
+  end
+  sched.fd.BACKEND = epoll and "epoll" or "select"
+  if epoll then -- register the file descriptors watched so far
+    for _, rw in ipairs{ "read", "write", "except" } do
+      for _, fd in ipairs(fdt["wait_"..rw]) do epoll_update(fd) end
+    end
+  end
+end
+
 ------------------------------------------------------------------------------
 -- Add a file descriptor to a watch list (wait_read, wait_write or wait_except)
 ------------------------------------------------------------------------------
 local function add_watch(rw, fd, func)
   local t = fdt["wait_"..rw]
   if t[fd] then return nil, "file descriptor already registered" end
+  if epoll == nil then init_backend() end
+  if epoll then
+    local r, err = psignal.epoll_ctl(fd, rw=="read" or fdt.wait_read[fd],
+      rw=="write" or fdt.wait_write[fd], rw=="except" or fdt.wait_except[fd])
+    if not r then return nil, err end
+    if rw=="read" and fd.dirty and fd:dirty() then table.insert(dirty, fd) end
+  end
   local i = #t+1
   t[i] = fd
   t[fd] = i
@@ -67,6 +119,7 @@ local function remove_watch(rw, fd)
   t[lasti] = nil
   t[fd] = nil
   fdt[rw.."_func"][fd] = nil
+  if epoll then epoll_update(fd) end
 
   return true
 end
@@ -189,15 +242,46 @@ end
 
 
 ------------------------------------------------------------------------------
--- the 'require' is performed inside `sched.fd.step`, then the select
--- function is memorized in `fd_select`, in order to avoid a
--- circular dependency.
+-- Wait with epoll; objects with buffered data are reported readable
+-- without waiting.
+------------------------------------------------------------------------------
+local function epoll_wait(timeout)
+  if not dirty[1] then return psignal.epoll_wait(timeout) end
+  local can_read, can_write, has_except = psignal.epoll_wait(0)
+  if not can_read then return nil, can_write end
+  local ready = { }
+  for _, fd in ipairs(can_read) do ready[fd] = true end
+  for _, fd in ipairs(dirty) do
+    if fdt.wait_read[fd] and not ready[fd] then table.insert(can_read, fd) end
+  end
+  dirty = { }
+  return can_read, can_write, has_except
+end
+
 ------------------------------------------------------------------------------
-local fd_select
+-- the backend is chosen at the first watch or `sched.fd.step` call, so that
+-- `sched.fd.BACKEND` can be set after loading sched; the backend's wait
+-- function is then memorized in `fd_wait`.
+------------------------------------------------------------------------------
+local function select_wait(timeout)
+  return psignal.select(fdt.wait_read, fdt.wait_write, fdt.wait_except, timeout)
+end
+
+local fd_wait
 function sched.fd.step(timeout)
-  if not fd_select then local psignal = require 'sched.posixsignal'; fd_select = psignal.select; end -- executed once at first call only !
+  if not fd_wait then -- executed once at first call only !
+    if epoll == nil then init_backend() end
+    fd_wait = epoll and epoll_wait or select_wait
+  end
+
+  local can_read, can_write, has_except, msg = fd_wait(timeout)
 
-  local can_read, can_write, has_except, msg = fd_select(fdt.wait_read, fdt.wait_write, fdt.wait_except, timeout)
+  if not can_read then -- epoll failed: the watch lists are still usable by select()
+    log('SCHED', 'ERROR', "epoll failed, falling back to select(): %s", tostring(can_write))
+    epoll, dirty, fd_wait = false, { }, select_wait
+    sched.fd.BACKEND = "select"
+    return nil, can_write
+  end
 
   if msg=='timeout' then return 'timeout' end
 
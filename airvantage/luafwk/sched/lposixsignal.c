@@ -29,6 +29,13 @@
 #include <sys/types.h>
 #include <sys/socket.h>
 #include <sys/time.h>
+#ifdef __linux__
+#include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#endif
 
 
 #define MAX_SIGNALS     64
@@ -519,6 +526,220 @@ static int l_select(lua_State *L) {
     return top;
 }
 
+#ifdef __linux__
+/* EPOLL BACKEND
+ * The watched objects are registered once in a kernel epoll set instead of
+ * being collected at every select() call: waiting costs O(1) per watched
+ * object change and per ready object, whatever the number of idle objects.
+ * Timeouts are handled by a timerfd in the same set, which keeps select()'s
+ * sub-millisecond precision. */
+
+#define EPOLL_MAX_EVENTS 64
+
+static int epoll_fd = -1;           /* epoll set, created on first use */
+static int epoll_timerfd = -1;      /* wakes epoll_pwait() up when the timeout expires */
+static int epoll_timerarmed = 0;
+static int epoll_objs = LUA_NOREF;  /* registry table: fd -> object and object -> fd */
+static uint32_t *epoll_interest;    /* events registered, indexed by fd */
+static int epoll_ninterest;
+
+static int push_errno(lua_State *L) {
+    lua_pushnil(L);
+    lua_pushstring(L, strerror(errno));
+    return 2;
+}
+
+static int epoll_init(lua_State *L) {
+    struct epoll_event ev;
+    if (epoll_fd >= 0)
+        return 0;
+    epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd < 0)
+        return -1;
+    epoll_timerfd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    ev.events = EPOLLIN;
+    ev.data.fd = epoll_timerfd;
+    if (epoll_timerfd < 0 || epoll_ctl(epoll_fd, EPOLL_CTL_ADD, epoll_timerfd, &ev)) {
+        int err = errno;
+        if (epoll_timerfd >= 0)
+            close(epoll_timerfd);
+        close(epoll_fd);
+        epoll_fd = epoll_timerfd = -1;
+        errno = err;
+        return -1;
+    }
+    lua_newtable(L);
+    epoll_objs = luaL_ref(L, LUA_REGISTRYINDEX);
+    return 0;
+}
+
+/* Remember the events registered for fd, to dispatch hang-ups and errors. */
+static int epoll_setinterest(int fd, uint32_t events) {
+    if (fd >= epoll_ninterest) {
+        int n = fd < 64 ? 64 : 2 * fd;
+        uint32_t *interest = realloc(epoll_interest, n * sizeof(*interest));
+        if (!interest)
+            return -1;
+        memset(interest + epoll_ninterest, 0, (n - epoll_ninterest) * sizeof(*interest));
+        epoll_interest = interest;
+        epoll_ninterest = n;
+    }
+    epoll_interest[fd] = events;
+    return 0;
+}
+
+/**
+ * epoll_ctl
+ *  obj: object to watch, with a getfd() method (as luasocket objects)
+ *  read, write, except: whether to watch obj for each condition; all false
+ *  removes obj from the epoll set.
+ * returns:
+ *  "ok" on success
+ *  nil, <error> on failure.
+ */
+static int l_epoll_ctl(lua_State *L) {
+    struct epoll_event ev;
+    int fd, registered, r;
+    if (epoll_init(L))
+        return push_errno(L);
+    ev.events = (lua_toboolean(L, 2) ? EPOLLIN : 0) | (lua_toboolean(L, 3) ? EPOLLOUT : 0)
+            | (lua_toboolean(L, 4) ? EPOLLPRI : 0);
+    lua_settop(L, 1);
+    lua_rawgeti(L, LUA_REGISTRYINDEX, epoll_objs); // obj, objs
+    lua_pushvalue(L, 1);
+    lua_rawget(L, 2); // obj, objs, objs[obj]
+    /* the registered fd is kept, as a closed object can't tell its fd anymore */
+    registered = lua_isnumber(L, -1);
+    lua_pop(L, 1);
+    if (registered) {
+        lua_pushvalue(L, 1);
+        lua_rawget(L, 2);
+        fd = lua_tointeger(L, -1);
+        lua_pop(L, 1);
+    } else {
+        lua_pushvalue(L, 1);
+        fd = getfd(L);
+        lua_pop(L, 1);
+    }
+    if (!ev.events) {
+        if (registered) {
+            lua_rawgeti(L, 2, fd); // obj, objs, objs[fd]
+            if (lua_rawequal(L, 1, -1)) { /* otherwise fd was closed and now belongs to another object */
+                epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, &ev); /* fails harmlessly if fd is already closed */
+                epoll_interest[fd] = 0;
+                lua_pushnil(L);
+                lua_rawseti(L, 2, fd);
+            }
+            lua_pushvalue(L, 1);
+            lua_pushnil(L);
+            lua_rawset(L, 2);
+        }
+        lua_pushstring(L, "ok");
+        return 1;
+    }
+    if (fd == SOCKET_INVALID) {
+        lua_pushnil(L);
+        lua_pushstring(L, "invalid file descriptor");
+        return 2;
+    }
+    if (epoll_setinterest(fd, ev.events))
+        return push_errno(L);
+    ev.data.fd = fd;
+    /* the kernel forgets closed fds, and the same fd may be watched through another object */
+    r = epoll_ctl(epoll_fd, registered ? EPOLL_CTL_MOD : EPOLL_CTL_ADD, fd, &ev);
+    if (r && registered && errno == ENOENT)
+        r = epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev);
+    else if (r && !registered && errno == EEXIST)
+        r = epoll_ctl(epoll_fd, EPOLL_CTL_MOD, fd, &ev);
+    if (r)
+        return push_errno(L);
+    lua_pushvalue(L, 1);
+    lua_pushinteger(L, fd);
+    lua_rawset(L, 2); // objs[obj] = fd
+    lua_pushvalue(L, 1);
+    lua_rawseti(L, 2, fd); // objs[fd] = obj
+    lua_pushstring(L, "ok");
+    return 1;
+}
+
+/* Arm the timerfd to expire after t seconds, or disarm it if t < 0. */
+static void epoll_settimeout(double t) {
+    struct itimerspec its;
+    if (t < 0 && !epoll_timerarmed)
+        return;
+    memset(&its, 0, sizeof(its));
+    if (t >= 0) {
+        its.it_value.tv_sec = (time_t) t;
+        its.it_value.tv_nsec = (long) ((t - its.it_value.tv_sec) * 1.0e9);
+        if (!its.it_value.tv_sec && !its.it_value.tv_nsec)
+            its.it_value.tv_nsec = 1; /* a zero value would disarm the timer */
+    }
+    timerfd_settime(epoll_timerfd, 0, &its, NULL);
+    epoll_timerarmed = t >= 0;
+}
+
+/**
+ * epoll_wait
+ *  [timeout]: maximum time to wait, in seconds; wait forever when nil
+ * returns, like select:
+ *  the lists of readable, writable and excepted objects,
+ *  followed by "timeout" or an error message when no object is ready.
+ */
+static int l_epoll_wait(lua_State *L) {
+    struct epoll_event events[EPOLL_MAX_EVENTS];
+    sigset_t mask, orig_mask, emptymask;
+    double t = luaL_optnumber(L, 1, -1);
+    int i, n, err, ms, nr = 0, nw = 0, ne = 0, tab;
+    if (epoll_init(L))
+        return push_errno(L);
+
+    sigfillset(&mask);
+    sigemptyset(&emptymask);
+    sigprocmask(SIG_SETMASK, &mask, &orig_mask);
+    ms = step(L) || t == 0 ? 0 : -1; /* don't block when signals must be handled */
+    epoll_settimeout(ms ? t : -1);
+    n = epoll_pwait(epoll_fd, events, EPOLL_MAX_EVENTS, ms, &emptymask);
+    err = errno;
+    sigprocmask(SIG_SETMASK, &orig_mask, NULL);
+
+    lua_settop(L, 0);
+    lua_rawgeti(L, LUA_REGISTRYINDEX, epoll_objs); // objs
+    lua_newtable(L);
+    lua_newtable(L);
+    lua_newtable(L); // objs, rtab, wtab, etab
+    for (i = 0; i < n; i++) {
+        int fd = events[i].data.fd;
+        uint32_t ev = events[i].events, interest;
+        if (fd == epoll_timerfd) {
+            uint64_t expirations;
+            if (read(epoll_timerfd, &expirations, sizeof(expirations)) > 0)
+                epoll_timerarmed = 0;
+            continue;
+        }
+        interest = fd < epoll_ninterest ? epoll_interest[fd] : 0;
+        if (ev & (EPOLLHUP | EPOLLERR)) /* as select, report them to the watchers */
+            ev |= interest & (EPOLLIN | EPOLLOUT) ? interest & (EPOLLIN | EPOLLOUT) : interest;
+        lua_rawgeti(L, 1, fd); // objs, rtab, wtab, etab, obj
+        if (lua_isnil(L, -1)) {
+            lua_pop(L, 1);
+            continue;
+        }
+        for (tab = 2; tab <= 4; tab++) {
+            uint32_t flag = 2 == tab ? EPOLLIN : 3 == tab ? EPOLLOUT : EPOLLPRI;
+            if (ev & interest & flag) {
+                lua_pushvalue(L, -1);
+                lua_rawseti(L, tab, 2 == tab ? ++nr : 3 == tab ? ++nw : ++ne);
+            }
+        }
+        lua_pop(L, 1);
+    }
+    if (nr || nw || ne)
+        return 3;
+    lua_pushstring(L, n >= 0 ? "timeout" : strerror(err));
+    return 4;
+}
+#endif
+
 /**
  * Register functions.
  */
@@ -527,6 +748,10 @@ static const luaL_Reg R[] = {
         { "raise", l_raise },
         { "kill", l_kill },
         { "select", l_select},
+#ifdef __linux__
+        { "epoll_ctl", l_epoll_ctl},
+        { "epoll_wait", l_epoll_wait},
+#endif
         { NULL, NULL } };
 
 int luaopen_sched_posixsignal(lua_State* L) {
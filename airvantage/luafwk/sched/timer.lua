@@ -72,10 +72,13 @@ local function addevent(timer)
     if events[nd] then
         events[nd][timer] = true
     else
-        local n = #events+1
-        for i = 1, n-1 do
-            if events[i] > nd then n = i break end
+        -- binary search of the insertion index in the sorted list of dates
+        local lo, hi = 1, #events+1
+        while lo < hi do
+            local mid = math.floor((lo+hi)/2)
+            if events[mid] > nd then hi = mid else lo = mid+1 end
         end
+        local n = lo
         table.insert(events, n, nd)
         events[nd] = { [timer] = true }
 
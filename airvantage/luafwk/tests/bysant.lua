@@ -719,3 +719,106 @@ function floatd :test()
     bysantd_assert_double('ffffffffffffffff00', niltoken)
     u.assert_true(isnan(bysantd('3605ffffffffffffffff01')[1]))
 end
+
+--------------------------------------------------------------------------------
+--- Token reader
+--------------------------------------------------------------------------------
+local tokend = u.newtestsuite 'Bysant Deserializer - token reader'
+
+-- read every token of `str`, return them as a list of {type, kind, a, b}
+local function readall(d, str, offset)
+    local tokens = { }
+    offset = offset or 1
+    while offset <= #str do
+        local nextoffset, t, kind, a, b = d:read(str, offset)
+        u.assert_number(nextoffset, t)
+        table.insert(tokens, {t, kind, a, b})
+        offset = nextoffset
+    end
+    return tokens, offset
+end
+
+function tokend :test_scalars()
+    local d = core.deserializer()
+    local str = encode('9f0108"hello"00')
+    u.assert_clone_tables({ {'number', 'top', 0}, {'boolean', 'top', true}, {'string', 'top', 4, 8}, {'null', 'top'} },
+                          readall(d, str))
+    u.assert_equal('hello', str:sub(4, 8))
+end
+
+function tokend :test_containers()
+    local d = core.deserializer()
+    local str = bysants():map():string("foo"):list(2):number(1):number(2):close():close():serialize()
+    local tokens = readall(d, str)
+    u.assert_clone_tables({
+        {'map', 'top'}, {'string', 'key', 3, 5}, {'list', 'value', 2},
+        {'number', 'item', 1}, {'number', 'item', 2}, {'close', 'value', 'list'},
+        {'close', 'top', 'map'} }, tokens)
+end
+
+function tokend :test_object()
+    local d = core.deserializer()
+    d:addClass{
+        name = "MyInternalClass", id = 2,
+        { name = "time",  context = "unsignedstring" },
+        { name = "value", context = "number"         },
+    }
+    local tokens, offset = readall(d, encode('62ce44d402'))
+    u.assert_clone_tables({ {'object', 'top', 'MyInternalClass'}, {'number', 'time', 2000},
+                            {'number', 'value', -100} }, tokens)
+    -- fixed size containers are closed without reading any byte
+    u.assert_clone_tables({6, 'close', 'top', 'object'}, {d:read(encode('62ce44d402'), offset)})
+end
+
+function tokend :test_partial()
+    local d = core.deserializer()
+    local str = encode('2c08"hello"9f')
+    u.assert_equal(2, d:read(str, 1))
+    local nextoffset, status = d:read(str:sub(1, 5), 2)
+    u.assert_nil(nextoffset)
+    u.assert_equal('partial', status)
+    local nextoffset, t, kind, first, last = d:read(str, 2)
+    u.assert_equal(8, nextoffset)
+    u.assert_equal('item', kind)
+    u.assert_equal('hello', str:sub(first, last))
+end
+
+function tokend :test_mixed()
+    -- pull tokens, then deserialize or skip a nested value as a whole
+    local str = bysants():map()
+        :string("k1"):list(2):number(1):number(2):close()
+        :string("k2"):map():string("x"):number(3):close()
+    :close():serialize()
+    local d = core.deserializer()
+    local offset = d:read(str, 1)
+    offset = d:read(str, offset)
+    local value, offset = d:deserialize(str, offset)
+    u.assert_clone_tables({1, 2}, value)
+    local offset, t, kind, first, last = d:read(str, offset)
+    u.assert_equal('k2', str:sub(first, last))
+    offset = d:skip(str, offset)
+    local value, offset = d:deserialize(str, offset) -- end of the map: nothing left
+    u.assert_nil(value)
+    u.assert_equal(#str+1, offset)
+    -- the deserializer is back at top-level
+    u.assert_clone_tables({x=3}, d:deserialize(bysants():map():string("x"):number(3):close():serialize()))
+end
+
+function tokend :test_hibernated()
+    -- a pending partial deserialization is not mistaken for a container opened by `read`
+    local str = bysants():map():string("x"):number(3):close():serialize()
+    local d = core.deserializer()
+    local value, status, partial = d:deserialize(str:sub(1, 3))
+    u.assert_nil(value)
+    u.assert_equal('partial', status)
+    u.assert_error(function() d:deserialize(str) end)
+    u.assert_error(function() d:read(str, 1) end)
+    u.assert_clone_tables({x=3}, d:deserialize(str, partial))
+    -- once a partial deserialization is over, the context is back at top-level
+    u.assert_clone_tables({x=3}, d:deserialize(str))
+
+    -- inside a container opened by `read`, there is nothing to resume
+    local offset = d:read(str, 1)
+    u.assert_error(function() d:deserialize(str, offset, partial) end)
+    u.assert_equal('x', d:deserialize(str, offset))
+end
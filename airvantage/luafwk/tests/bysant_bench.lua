@@ -0,0 +1,96 @@
+--------------------------------------------------------------------------------
+-- Copyright (c) 2012 Sierra Wireless and others.
+-- All rights reserved. This program and the accompanying materials
+-- are made available under the terms of the Eclipse Public License v1.0
+-- and Eclipse Distribution License v1.0 which accompany this distribution.
+--
+-- The Eclipse Public License is available at
+--   http://www.eclipse.org/legal/epl-v10.html
+-- The Eclipse Distribution License is available at
+--   http://www.eclipse.org/org/documents/edl-v10.php
+--
+-- Contributors:
+--     Sierra Wireless - initial API and implementation
+-------------------------------------------------------------------------------
+
+-- M3DA deserialization benchmark: route envelopes of large multi-path
+-- messages, half of them addressed to unknown assets, by deserializing whole
+-- messages and by pulling tokens as srvcon does. Also compares a full
+-- deserialization with a token walk which only looks at string views.
+--
+-- usage: lua bysant_bench.lua [nmessages [npaths [nrounds]]]
+
+local m3da = require 'm3da.bysant'
+
+local nmessages, npaths, nrounds = tonumber(arg[1]) or 64, tonumber(arg[2]) or 256, tonumber(arg[3]) or 20
+
+local registered = { }
+local function envelope_payload()
+    local serialize, acc = m3da.serializer{ }
+    for i = 1, nmessages do
+        local asset = "asset"..(i % 8)
+        if i % 2 == 0 then registered[asset] = true end
+        local body = { }
+        for j = 1, npaths do
+            body["sensor"..j..".value"] = j * 1.5
+            body["sensor"..j..".label"] = string.rep(string.char(65 + j % 26), 32)
+        end
+        assert(serialize{ __class = 'Message', path = asset..".data", ticketid = i, body = body })
+    end
+    return table.concat(acc)
+end
+
+-- Deserialize every message, route it on its path.
+local function route_tables(d, payload)
+    local offset, routed, msg = 1, 0
+    while offset <= #payload do
+        msg, offset = d(payload, offset)
+        if registered[msg.path:match "^[^.]*"] then routed = routed + 1 end
+    end
+    return routed
+end
+
+-- Pull the path, only deserialize the bodies of messages to registered assets.
+local function route_tokens(d, payload)
+    local offset, routed, path, body = 1, 0
+    while offset <= #payload do
+        offset = d:read(payload, offset)   -- Message object
+        path, offset = d(payload, offset)  -- path
+        offset = select(2, d(payload, offset)) -- ticketid
+        if registered[path:match "^[^.]*"] then
+            body, offset = d(payload, offset)
+            routed = routed + 1
+        else
+            offset = d:skip(payload, offset)
+        end
+        offset = d:read(payload, offset)   -- closing
+    end
+    return routed
+end
+
+-- Total string length, through string views.
+local function walk_tokens(d, payload)
+    local offset, total, t, _, first, last = 1, 0
+    while offset <= #payload do
+        offset, t, _, first, last = d:read(payload, offset)
+        if t == 'string' then total = total + last - first + 1 end
+    end
+    return total
+end
+
+local function bench(name, f, payload)
+    local d = m3da.deserializer()
+    local r
+    collectgarbage 'collect'
+    local mem0, t0 = collectgarbage 'count', os.clock()
+    for i = 1, nrounds do r = f(d, payload) end
+    local t1 = os.clock()
+    print(string.format("%-14s %8.2f ms/envelope (result %d)", name, (t1 - t0) * 1e3 / nrounds, r))
+end
+
+local payload = envelope_payload()
+print(string.format("%d messages of %d paths, %d bytes", nmessages, 2 * npaths, #payload))
+bench("route/tables", route_tables, payload)
+bench("route/tokens", route_tokens, payload)
+bench("walk/tables",  function(d, p) local n, o, v = 0, 1; while o <= #p do v, o = d(p, o); n = n + 1 end; return n end, payload)
+bench("walk/tokens",  walk_tokens, payload)
@@ -78,6 +78,132 @@ local function  persist_testsuite(persist_impl, name)
         u.assert_nil(val)
     end
 
+    function t:test_commit()
+        if not target.table.commit then return end -- no write buffering in this impl
+        local durability = target.DURABILITY
+        target.DURABILITY = 'lazy'
+        for i=1,100 do
+            nt["key"..(i%10)] = i
+        end
+        target.table.commit(nt)
+        target.DURABILITY = durability
+        for i=1,10 do
+            u.assert_equal(90+i, nt["key"..(i%10)])
+        end
+    end
+
+    if name == "file" then
+        -- file format tests: tables are dropped then reloaded from their file
+        local l2b = require 'luatobin'
+        local MAGIC = "persist.file\1\n"
+
+        local function path(tname)
+            return (rawget(_G, "LUA_AF_RW_PATH") or "./").."persist/"..tname..".l2b"
+        end
+
+        local function readfile(tname)
+            local f = assert(io.open(path(tname), "rb"))
+            local content = f :read '*a'
+            f :close()
+            return content
+        end
+
+        local function writefile(tname, content)
+            local f = assert(io.open(path(tname), "wb"))
+            f :write(content)
+            f :close()
+        end
+
+        -- Drops the last reference to a table, then loads it again from its file
+        local function reload(tname, id)
+            collectgarbage 'collect'
+            local t = target.table.new(tname)
+            u.assert_not_equal(id, tostring(t)) -- not served from the cache
+            return t
+        end
+
+        -- Writes key1..key10 in a first record, key11 in a second one
+        local function fill(tname)
+            local t = target.table.new(tname)
+            target.table.empty(t)
+            for i=1,10 do t["key"..i] = "value"..i end
+            t.key1 = "value1bis"
+            u.assert_equal(true, target.table.commit(t))
+            local size = #readfile(tname)
+            t.key11 = "value11"
+            u.assert_equal(true, target.table.commit(t))
+            return tostring(t), size
+        end
+
+        local function assert_content(t, n)
+            u.assert_equal("value1bis", t.key1)
+            for i=2,n do u.assert_equal("value"..i, t["key"..i]) end
+            for i=n+1,11 do u.assert_nil(t["key"..i]) end
+        end
+
+        function t:test_reload()
+            local durability = target.DURABILITY
+            target.DURABILITY = 'lazy'
+            local id = fill("testReload")
+            local rt = reload("testReload", id)
+            target.DURABILITY = durability
+            assert_content(rt, 11)
+            u.assert_equal(MAGIC, readfile("testReload") :sub(1, #MAGIC))
+            target.table.empty(rt)
+        end
+
+        function t:test_reload_truncated_record()
+            local durability = target.DURABILITY
+            target.DURABILITY = 'lazy'
+            local id, size = fill("testTruncated")
+            local content = readfile("testTruncated")
+            writefile("testTruncated", content :sub(1, #content-3))
+            local rt = reload("testTruncated", id)
+            assert_content(rt, 10)
+            -- the damaged record has been removed from the file
+            rt.key11 = "value11"
+            target.table.commit(rt)
+            id = tostring(rt); rt = nil
+            rt = reload("testTruncated", id)
+            target.DURABILITY = durability
+            assert_content(rt, 11)
+            target.table.empty(rt)
+        end
+
+        function t:test_reload_corrupted_record()
+            local durability = target.DURABILITY
+            target.DURABILITY = 'lazy'
+            local id, size = fill("testCorrupted")
+            local content = readfile("testCorrupted")
+            local last = #content
+            writefile("testCorrupted", content :sub(1, last-1)..string.char((content :byte(last)+1) % 256))
+            local rt = reload("testCorrupted", id)
+            target.DURABILITY = durability
+            assert_content(rt, 10)
+            u.assert_equal(size, #readfile("testCorrupted"))
+            target.table.empty(rt)
+        end
+
+        function t:test_reload_legacy_file()
+            local content = { }
+            for i=1,11 do
+                table.insert(content, l2b.serialize("key"..i))
+                table.insert(content, l2b.serialize("value"..i))
+            end
+            table.insert(content, l2b.serialize("key1"))
+            table.insert(content, l2b.serialize("value1bis"))
+            writefile("testLegacy", table.concat(content))
+            local rt = reload("testLegacy")
+            assert_content(rt, 11)
+            -- the file has been converted to the current format
+            u.assert_equal(MAGIC, readfile("testLegacy") :sub(1, #MAGIC))
+            local id = tostring(rt); rt = nil
+            rt = reload("testLegacy", id)
+            assert_content(rt, 11)
+            target.table.empty(rt)
+        end
+    end
+
     function t:teardown()
         target.table.empty(nt)
         nt = nil
@@ -0,0 +1,87 @@
+--------------------------------------------------------------------------------
+-- Copyright (c) 2012 Sierra Wireless and others.
+-- All rights reserved. This program and the accompanying materials
+-- are made available under the terms of the Eclipse Public License v1.0
+-- and Eclipse Distribution License v1.0 which accompany this distribution.
+--
+-- The Eclipse Public License is available at
+--   http://www.eclipse.org/legal/epl-v10.html
+-- The Eclipse Distribution License is available at
+--   http://www.eclipse.org/org/documents/edl-v10.php
+--
+-- Contributors:
+--     Sierra Wireless - initial API and implementation
+-------------------------------------------------------------------------------
+
+-- Scheduler I/O benchmark: ping-pong lines over a few active sockets while
+-- many idle sockets are watched for reading, with the select() and epoll
+-- backends of sched.fd. The peer ends of the sockets are held by a child
+-- process running this script in peer mode, so that the scheduler process
+-- stays below select()'s FD_SETSIZE.
+--
+-- usage: lua sched_bench.lua [select|epoll [nidle [nactive [nrounds]]]]
+
+-- sched must be loaded before socket to get scheduler-aware sockets; the
+-- peer uses plain blocking ones.
+if arg[1] ~= "peer" then require 'sched' end
+local socket = require 'socket'
+
+if arg[1] == "peer" then
+    -- Connect the active sockets first, then the idle ones; echo lines on
+    -- the active ones until the scheduler process closes them.
+    local port, nidle, nactive = tonumber(arg[2]), tonumber(arg[3]), tonumber(arg[4])
+    local active, idle = { }, { }
+    for i = 1, nactive + nidle do
+        local skt = assert(socket.connect('127.0.0.1', port))
+        table.insert(i <= nactive and active or idle, skt)
+    end
+    while #active > 0 do
+        local readable = socket.select(active)
+        for _, skt in ipairs(readable) do
+            local line = skt:receive '*l'
+            if line then skt:send(line.."\n") else
+                for i, s in ipairs(active) do if s == skt then table.remove(active, i) break end end
+            end
+        end
+    end
+    os.exit(0)
+end
+
+local backend = arg[1] or "epoll"
+local nidle, nactive, nrounds = tonumber(arg[2]) or 1000, tonumber(arg[3]) or 10, tonumber(arg[4]) or 2000
+
+sched.fd.BACKEND = backend
+local srv = assert(socket.bind('127.0.0.1', 0, nidle + nactive))
+local _, port = srv:getsockname()
+local peer = io.popen(string.format("%q %q peer %d %d %d", arg[-1], arg[0], port, nidle, nactive), "w")
+
+sched.run(function()
+    local active = { }
+    for i = 1, nactive do active[i] = assert(srv:accept()) end
+    for i = 1, nidle do
+        local skt = assert(srv:accept())
+        sched.run(function() skt:receive '*l' end)
+    end
+
+    local done, t0 = 0, socket.gettime()
+    for i = 1, nactive do
+        sched.run(function()
+            local skt = active[i]
+            for r = 1, nrounds do
+                assert(skt:send("ping "..r.."\n"))
+                assert(skt:receive '*l' == "ping "..r)
+            end
+            skt:close()
+            done = done + 1
+            if done == nactive then
+                local t = socket.gettime() - t0
+                print(string.format("%-6s %5d idle %3d active: %d round-trips in %.3f s, %.1f us each",
+                    sched.fd.BACKEND, nidle, nactive, nactive * nrounds, t, t * 1e6 / (nactive * nrounds)))
+                peer:close()
+                os.exit(0)
+            end
+        end)
+    end
+end)
+
+sched.loop()
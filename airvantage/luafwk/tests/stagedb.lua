@@ -519,15 +519,7 @@ function cont_ts.test_smallest_with_file_storage()
     u.assert_clone_tables(expected, result)
     db :close()
 
-    -- reload db and serialize again, we really expected this "expected" value ???
-    expected = {
-        col = {
-            1000,
-            1010,
-            1020,
-            1030,
-            1040 } }
-
+    -- reload db and serialize again: the reopened table serializes like the original
     db = stagedb("file:"..filename, { { name="col", serialization="smallest" } })
     result = flush_data(db)
     u.assert_clone_tables(expected, result)
@@ -0,0 +1,220 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * Unit test for the Coroutine API.
+ *
+ * Three coroutines are run in the main thread:
+ *  - Two "ping-pong" coroutines yield to each other a number of times, each adding its letter to
+ *    a trace string, which must come out interleaved.
+ *  - A "waiter" coroutine suspends itself until another thread resumes it, and checks that the
+ *    main thread's Event Loop ran other work in the meantime.  It also checks that a resume that
+ *    arrives before the suspend isn't lost, and that a big buffer fits in a coroutine with a
+ *    large stack.
+ *
+ * When all three have finished, their (now stale) references are resumed again, which must do
+ * nothing, and the test exits.
+ *
+ * Copyright (C) Sierra Wireless, Inc. 2014.  Use of this work is subject to license.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+
+/// Number of times each ping-pong coroutine yields.
+#define NUM_YIELDS          5
+
+/// Number of coroutines in the test.
+#define NUM_COROUTINES      3
+
+/// Size of the buffer that the waiter puts on its stack.
+#define BIG_BUFFER_BYTES    (100 * 1024)
+
+/// Letters added to the trace by the ping-pong coroutines.
+static char Trace[(NUM_YIELDS + 1) * 2 + 1];
+static size_t TraceLen = 0;
+
+static le_coro_Ref_t CoroRefs[NUM_COROUTINES];
+static le_coro_Ref_t WaiterRef;
+
+/// Number of coroutines whose main functions have finished.
+static size_t NumDone = 0;
+
+/// Set by the resumer thread just before it resumes the waiter.
+static bool IsWakeUpSent = false;
+
+/// Set by a function queued to the main thread's Event Loop while the waiter is suspended.
+static bool DidOtherWork = false;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Checks the results once all the coroutines have finished and been deleted.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CheckResults
+(
+    void* param1Ptr,
+    void* param2Ptr
+)
+{
+    LE_INFO("Trace = '%s'.", Trace);
+    LE_ASSERT(strcmp(Trace, "ABABABABABAB") == 0);
+
+    // Resuming finished coroutines must have no effect.
+    size_t i;
+    for (i = 0; i < NUM_COROUTINES; i++)
+    {
+        le_coro_Resume(CoroRefs[i]);
+    }
+
+    LE_INFO("======== Coroutine test PASSED ========");
+
+    exit(EXIT_SUCCESS);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Called at the end of each coroutine's main function.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CoroDone
+(
+    void
+)
+{
+    NumDone++;
+
+    if (NumDone == NUM_COROUTINES)
+    {
+        le_event_QueueFunction(CheckResults, NULL, NULL);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Main function of the ping-pong coroutines.  The context pointer is the letter to add to the
+ * trace.
+ */
+//--------------------------------------------------------------------------------------------------
+static void PingPongMain
+(
+    void* contextPtr
+)
+{
+    char letter = (char)(size_t)contextPtr;
+    le_coro_Ref_t myRef = le_coro_GetCurrent();
+
+    LE_ASSERT(myRef != NULL);
+
+    int i;
+    for (i = 0; i < NUM_YIELDS; i++)
+    {
+        Trace[TraceLen++] = letter;
+
+        le_coro_Yield();
+
+        // Local variables survive the switch.
+        LE_ASSERT(letter == (char)(size_t)contextPtr);
+        LE_ASSERT(le_coro_GetCurrent() == myRef);
+    }
+
+    Trace[TraceLen++] = letter;
+
+    CoroDone();
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Queued to the main thread's Event Loop while the waiter is suspended.
+ */
+//--------------------------------------------------------------------------------------------------
+static void OtherWork
+(
+    void* param1Ptr,
+    void* param2Ptr
+)
+{
+    LE_ASSERT(le_coro_GetCurrent() == NULL);
+
+    DidOtherWork = true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Main function of the thread that resumes the waiter.
+ */
+//--------------------------------------------------------------------------------------------------
+static void* ResumerThreadMain
+(
+    void* unused
+)
+{
+    usleep(10000);
+
+    __atomic_store_n(&IsWakeUpSent, true, __ATOMIC_RELEASE);
+
+    le_coro_Resume(WaiterRef);
+
+    return NULL;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Main function of the waiter coroutine.
+ */
+//--------------------------------------------------------------------------------------------------
+static void WaiterMain
+(
+    void* contextPtr
+)
+{
+    // A resume that arrives while the coroutine is running is remembered.
+    le_coro_Resume(le_coro_GetCurrent());
+    le_coro_Suspend();
+
+    // Uses most of the stack.
+    uint8_t buffer[BIG_BUFFER_BYTES];
+    memset(buffer, 0xA5, sizeof(buffer));
+
+    le_event_QueueFunction(OtherWork, NULL, NULL);
+
+    le_thread_Ref_t threadRef = le_thread_Create("resumer", ResumerThreadMain, NULL);
+    le_thread_SetJoinable(threadRef);
+    le_thread_Start(threadRef);
+
+    while (!__atomic_load_n(&IsWakeUpSent, __ATOMIC_ACQUIRE))
+    {
+        le_coro_Suspend();
+    }
+
+    LE_ASSERT(le_thread_Join(threadRef, NULL) == LE_OK);
+
+    LE_ASSERT(DidOtherWork);
+    LE_ASSERT(buffer[0] == 0xA5);
+    LE_ASSERT(buffer[sizeof(buffer) - 1] == 0xA5);
+
+    CoroDone();
+}
+
+
+COMPONENT_INIT
+{
+    LE_ASSERT(le_coro_GetCurrent() == NULL);
+
+    CoroRefs[0] = le_coro_Create("ping", PingPongMain, (void*)(size_t)'A');
+    CoroRefs[1] = le_coro_Create("pong", PingPongMain, (void*)(size_t)'B');
+    CoroRefs[2] = WaiterRef = le_coro_Create("waiter", WaiterMain, NULL);
+
+    LE_ASSERT(le_coro_SetStackSize(WaiterRef, 1) == LE_OVERFLOW);
+    LE_ASSERT(le_coro_SetStackSize(WaiterRef, BIG_BUFFER_BYTES + (32 * 1024)) == LE_OK);
+
+    size_t i;
+    for (i = 0; i < NUM_COROUTINES; i++)
+    {
+        le_coro_Start(CoroRefs[i]);
+    }
+}
@@ -0,0 +1,447 @@
+// -------------------------------------------------------------------------------------------------
+// File descriptor event dispatch benchmark.
+//
+// Creates a large number of connected socket pairs (1000 by default) and monitors both ends of
+// every pair with FD Monitors in the same thread.  The "client" end of each pair sends a burst of
+// small messages and the "server" end echoes them back.  When the client end has received the
+// whole burst back, it sends the next one, until the requested number of rounds has been done
+// on every pair.
+//
+// This is run twice:
+//  - level-triggered: the handlers read one message each time they are called (the usual style),
+//  - edge-triggered: the handlers read until EAGAIN (see le_event_SetFdMonitorEdgeTriggered()).
+//
+// For each run, the number of handler calls and the number of read and write system calls made
+// by the process (including the ones made by the Event Loop itself on its eventfd, but not
+// epoll_wait()) are reported per echoed message.  The system call counts come from
+// /proc/self/io.
+//
+// The number of socket pairs and the number of rounds per pair can be passed as the first and
+// second command-line arguments.
+//
+// Copyright (C) 2014, Sierra Wireless Inc.
+// -------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+
+#include <sys/resource.h>
+#include <sys/socket.h>
+
+/// Default number of socket pairs.
+#define DEFAULT_NUM_PAIRS   1000
+
+/// Default number of bursts sent on each socket pair.
+#define DEFAULT_NUM_ROUNDS  100
+
+/// Size of one message, in bytes.
+#define MSG_SIZE            64
+
+/// Number of messages sent in each burst.
+#define MSGS_PER_BURST      8
+
+/// Number of bytes in a burst.
+#define BURST_SIZE          (MSG_SIZE * MSGS_PER_BURST)
+
+/// Number of file descriptors to leave for everything else in the process.
+#define SPARE_FDS           32
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * One connected pair of sockets.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    int                     clientFd;           ///< End that sends bursts and checks the echoes.
+    int                     serverFd;           ///< End that echoes everything it receives.
+    le_event_FdMonitorRef_t clientMonitorRef;   ///< FD Monitor for clientFd.
+    le_event_FdMonitorRef_t serverMonitorRef;   ///< FD Monitor for serverFd.
+    size_t                  bytesReceived;      ///< Bytes of the current burst echoed back so far.
+    size_t                  roundsLeft;         ///< Bursts still to be sent after this one.
+}
+Pair_t;
+
+
+static size_t NumPairs = DEFAULT_NUM_PAIRS;
+static size_t NumRounds = DEFAULT_NUM_ROUNDS;
+
+static Pair_t* Pairs;
+
+/// true when running the edge-triggered version of the benchmark.
+static bool EdgeTriggered = false;
+
+/// Number of socket pairs that have finished all their rounds.
+static size_t PairsDone;
+
+/// Number of times an fd event handler was called.
+static uint64_t HandlerCalls;
+
+/// Process system call counts and time at the start of a run.
+static uint64_t StartSyscalls;
+static le_clk_Time_t StartTime;
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ * Get the number of read and write system calls made by this process so far.
+ */
+// -------------------------------------------------------------------------------------------------
+static uint64_t GetSyscallCount
+(
+    void
+)
+// -------------------------------------------------------------------------------------------------
+{
+    FILE* filePtr = fopen("/proc/self/io", "r");
+    LE_FATAL_IF(filePtr == NULL, "Failed to open /proc/self/io. errno = %d (%m).", errno);
+
+    char line[128];
+    unsigned long long value;
+    uint64_t count = 0;
+
+    while (fgets(line, sizeof(line), filePtr) != NULL)
+    {
+        if (   (sscanf(line, "syscr: %llu", &value) == 1)
+            || (sscanf(line, "syscw: %llu", &value) == 1) )
+        {
+            count += value;
+        }
+    }
+
+    fclose(filePtr);
+
+    return count;
+}
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ * Write a whole buffer to a socket.  The socket buffers are always big enough for a burst, so
+ * anything less than a complete write is a failure.
+ */
+// -------------------------------------------------------------------------------------------------
+static void WriteAll
+(
+    int         fd,
+    const void* buffPtr,
+    size_t      size
+)
+// -------------------------------------------------------------------------------------------------
+{
+    ssize_t result;
+
+    do
+    {
+        result = write(fd, buffPtr, size);
+    }
+    while ((result == -1) && (errno == EINTR));
+
+    LE_FATAL_IF(result != (ssize_t)size,
+                "write() to fd %d returned %zd. errno = %d (%m).",
+                fd,
+                result,
+                errno);
+}
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ * Read some data from a socket.
+ *
+ * @return Number of bytes read, or 0 if there was nothing to read.
+ */
+// -------------------------------------------------------------------------------------------------
+static size_t ReadSome
+(
+    int     fd,
+    void*   buffPtr,
+    size_t  size
+)
+// -------------------------------------------------------------------------------------------------
+{
+    ssize_t result;
+
+    do
+    {
+        result = read(fd, buffPtr, size);
+    }
+    while ((result == -1) && (errno == EINTR));
+
+    if ((result == -1) && ((errno == EAGAIN) || (errno == EWOULDBLOCK)))
+    {
+        return 0;
+    }
+
+    LE_FATAL_IF(result <= 0, "read() from fd %d returned %zd. errno = %d (%m).", fd, result, errno);
+
+    return result;
+}
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ * Send a burst of messages from the client end of a pair.
+ */
+// -------------------------------------------------------------------------------------------------
+static void SendBurst
+(
+    Pair_t* pairPtr
+)
+// -------------------------------------------------------------------------------------------------
+{
+    static const char burst[BURST_SIZE] = { 'x' };
+
+    pairPtr->bytesReceived = 0;
+    WriteAll(pairPtr->clientFd, burst, sizeof(burst));
+}
+
+
+static void StartRun(void* param1Ptr, void* param2Ptr);
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ * Deletes all the socket pairs and reports the results of the run that just finished.  Then
+ * starts the next run or exits.
+ *
+ * This is queued from a handler, so that the FD Monitors aren't deleted out from under the
+ * handler that is still running.
+ */
+// -------------------------------------------------------------------------------------------------
+static void FinishRun
+(
+    void* param1Ptr,
+    void* param2Ptr
+)
+// -------------------------------------------------------------------------------------------------
+{
+    le_clk_Time_t elapsed = le_clk_Sub(le_clk_GetRelativeTime(), StartTime);
+    uint64_t syscalls = GetSyscallCount() - StartSyscalls;
+    double numMsgs = (double)NumPairs * NumRounds * MSGS_PER_BURST * 2; // Sent and echoed.
+    double seconds = elapsed.sec + (elapsed.usec / 1000000.0);
+    size_t i;
+
+    for (i = 0; i < NumPairs; i++)
+    {
+        le_event_DeleteFdMonitor(Pairs[i].clientMonitorRef);
+        le_event_DeleteFdMonitor(Pairs[i].serverMonitorRef);
+        close(Pairs[i].clientFd);
+        close(Pairs[i].serverFd);
+    }
+
+    LE_INFO("%s %zu fds x %zu rounds: %.0f msgs/s, %.2f handler calls/msg, %.2f read+write"
+            " syscalls/msg",
+            EdgeTriggered ? "Edge-triggered " : "Level-triggered",
+            NumPairs * 2,
+            NumRounds,
+            numMsgs / seconds,
+            HandlerCalls / numMsgs,
+            syscalls / numMsgs);
+
+    if (!EdgeTriggered)
+    {
+        EdgeTriggered = true;
+        le_event_QueueFunction(StartRun, NULL, NULL);
+    }
+    else
+    {
+        LE_INFO("======== FD ECHO BENCHMARK PASSED ========");
+        exit(EXIT_SUCCESS);
+    }
+}
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ * Readable handler for the server end of a pair.  Echoes whatever it reads.
+ */
+// -------------------------------------------------------------------------------------------------
+static void ServerReadable
+(
+    int fd
+)
+// -------------------------------------------------------------------------------------------------
+{
+    char buff[BURST_SIZE];
+    size_t size;
+
+    HandlerCalls++;
+
+    if (EdgeTriggered)
+    {
+        while ((size = ReadSome(fd, buff, sizeof(buff))) > 0)
+        {
+            WriteAll(fd, buff, size);
+        }
+    }
+    else if ((size = ReadSome(fd, buff, MSG_SIZE)) > 0)
+    {
+        WriteAll(fd, buff, size);
+    }
+}
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ * Readable handler for the client end of a pair.  Counts the echoed bytes and sends the next
+ * burst when the whole of the current one has come back.
+ */
+// -------------------------------------------------------------------------------------------------
+static void ClientReadable
+(
+    int fd
+)
+// -------------------------------------------------------------------------------------------------
+{
+    Pair_t* pairPtr = le_event_GetContextPtr();
+    char buff[BURST_SIZE];
+    size_t size;
+
+    HandlerCalls++;
+
+    do
+    {
+        size = ReadSome(fd, buff, EdgeTriggered ? sizeof(buff) : MSG_SIZE);
+        pairPtr->bytesReceived += size;
+    }
+    while (EdgeTriggered && (size > 0));
+
+    LE_ASSERT(pairPtr->bytesReceived <= BURST_SIZE);
+
+    if (pairPtr->bytesReceived == BURST_SIZE)
+    {
+        if (pairPtr->roundsLeft > 0)
+        {
+            pairPtr->roundsLeft--;
+            SendBurst(pairPtr);
+        }
+        else
+        {
+            pairPtr->bytesReceived = 0;
+
+            PairsDone++;
+            if (PairsDone == NumPairs)
+            {
+                le_event_QueueFunction(FinishRun, NULL, NULL);
+            }
+        }
+    }
+}
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ * Creates all the socket pairs and sends the first burst on each of them.
+ */
+// -------------------------------------------------------------------------------------------------
+static void StartRun
+(
+    void* param1Ptr,
+    void* param2Ptr
+)
+// -------------------------------------------------------------------------------------------------
+{
+    size_t i;
+
+    PairsDone = 0;
+    HandlerCalls = 0;
+
+    for (i = 0; i < NumPairs; i++)
+    {
+        Pair_t* pairPtr = &Pairs[i];
+        int fds[2];
+
+        LE_FATAL_IF(socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, fds) != 0,
+                    "socketpair() failed. errno = %d (%m).",
+                    errno);
+
+        pairPtr->clientFd = fds[0];
+        pairPtr->serverFd = fds[1];
+        pairPtr->bytesReceived = 0;
+        pairPtr->roundsLeft = NumRounds - 1;
+
+        pairPtr->clientMonitorRef = le_event_CreateFdMonitor("client", pairPtr->clientFd);
+        pairPtr->serverMonitorRef = le_event_CreateFdMonitor("server", pairPtr->serverFd);
+
+        if (EdgeTriggered)
+        {
+            le_event_SetFdMonitorEdgeTriggered(pairPtr->clientMonitorRef);
+            le_event_SetFdMonitorEdgeTriggered(pairPtr->serverMonitorRef);
+        }
+
+        le_event_FdHandlerRef_t handlerRef = le_event_SetFdHandler(pairPtr->clientMonitorRef,
+                                                                   LE_EVENT_FD_READABLE,
+                                                                   ClientReadable);
+        le_event_SetFdHandlerContextPtr(handlerRef, pairPtr);
+        le_event_SetFdHandler(pairPtr->serverMonitorRef, LE_EVENT_FD_READABLE, ServerReadable);
+    }
+
+    StartSyscalls = GetSyscallCount();
+    StartTime = le_clk_GetRelativeTime();
+
+    for (i = 0; i < NumPairs; i++)
+    {
+        SendBurst(&Pairs[i]);
+    }
+}
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ * Makes sure the process can open enough file descriptors, reducing the number of socket pairs
+ * if necessary.
+ */
+// -------------------------------------------------------------------------------------------------
+static void RaiseFdLimit
+(
+    void
+)
+// -------------------------------------------------------------------------------------------------
+{
+    struct rlimit lim;
+    rlim_t needed = (NumPairs * 2) + SPARE_FDS;
+
+    LE_ASSERT(getrlimit(RLIMIT_NOFILE, &lim) == 0);
+
+    if (lim.rlim_cur < needed)
+    {
+        lim.rlim_cur = (lim.rlim_max < needed) ? lim.rlim_max : needed;
+        LE_ASSERT(setrlimit(RLIMIT_NOFILE, &lim) == 0);
+
+        if (lim.rlim_cur < needed)
+        {
+            NumPairs = (lim.rlim_cur - SPARE_FDS) / 2;
+            LE_WARN("Only %zu socket pairs allowed by RLIMIT_NOFILE.", NumPairs);
+        }
+    }
+}
+
+
+// -------------------------------------------------------------------------------------------------
+// -------------------------------------------------------------------------------------------------
+COMPONENT_INIT
+{
+    char arg[32];
+
+    if ((le_arg_NumArgs() > 0) && (le_arg_GetArg(0, arg, sizeof(arg)) == LE_OK))
+    {
+        NumPairs = strtoul(arg, NULL, 0);
+        LE_FATAL_IF(NumPairs == 0, "Invalid socket pair count '%s'.", arg);
+    }
+
+    if ((le_arg_NumArgs() > 1) && (le_arg_GetArg(1, arg, sizeof(arg)) == LE_OK))
+    {
+        NumRounds = strtoul(arg, NULL, 0);
+        LE_FATAL_IF(NumRounds == 0, "Invalid round count '%s'.", arg);
+    }
+
+    RaiseFdLimit();
+
+    Pairs = calloc(NumPairs, sizeof(Pair_t));
+    LE_ASSERT(Pairs != NULL);
+
+    LE_INFO("======== BEGIN FD ECHO BENCHMARK ========");
+
+    le_event_QueueFunction(StartRun, NULL, NULL);
+}
@@ -0,0 +1,253 @@
+// -------------------------------------------------------------------------------------------------
+// Semaphore contention benchmark.
+//
+// Measures the cost of Legato semaphore operations in three scenarios:
+//  - uncontended: a single thread posting and then waiting on the same semaphore,
+//  - ping-pong: two threads handing control back and forth using a pair of semaphores, so every
+//    wait actually blocks,
+//  - contended: several threads all using the same semaphore as a lock around a shared counter.
+//
+// The counter is checked at the end of each contended run, so this also doubles as a stress test
+// of the semaphore implementation.
+//
+// The number of iterations per thread can be passed as the first command-line argument.
+//
+// Copyright (C) 2014, Sierra Wireless Inc.
+// -------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+
+/// Default number of iterations per thread.
+#define DEFAULT_ITERATIONS  1000000
+
+/// Thread counts to run the contended benchmark with.
+static const int ThreadCounts[] = { 2, 4, 8 };
+
+/// Largest thread count in ThreadCounts.
+#define MAX_THREADS 8
+
+static size_t Iterations = DEFAULT_ITERATIONS;
+
+static le_sem_Ref_t PingSemRef;
+static le_sem_Ref_t PongSemRef;
+
+static le_sem_Ref_t LockSemRef;
+
+static size_t Counter;
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ * Get the number of nanoseconds elapsed since a given start time.
+ */
+// -------------------------------------------------------------------------------------------------
+static uint64_t NsSince
+(
+    le_clk_Time_t startTime
+)
+// -------------------------------------------------------------------------------------------------
+{
+    le_clk_Time_t elapsed = le_clk_Sub(le_clk_GetRelativeTime(), startTime);
+
+    return ((uint64_t)elapsed.sec * 1000000000ULL) + ((uint64_t)elapsed.usec * 1000ULL);
+}
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ * Run the uncontended benchmark.
+ */
+// -------------------------------------------------------------------------------------------------
+static void RunUncontended
+(
+    void
+)
+// -------------------------------------------------------------------------------------------------
+{
+    size_t i;
+    le_sem_Ref_t semRef = le_sem_Create("benchUncontended", 0);
+    le_clk_Time_t startTime = le_clk_GetRelativeTime();
+
+    for (i = 0; i < Iterations; i++)
+    {
+        le_sem_Post(semRef);
+        le_sem_Wait(semRef);
+    }
+
+    uint64_t ns = NsSince(startTime);
+
+    le_sem_Delete(semRef);
+
+    LE_INFO("Uncontended           %zu post/wait pairs: %.1f ns/pair",
+            Iterations,
+            (double)ns / Iterations);
+}
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ * Main function of the "pong" side of the ping-pong benchmark.
+ */
+// -------------------------------------------------------------------------------------------------
+static void* PongMain
+(
+    void* unused
+)
+// -------------------------------------------------------------------------------------------------
+{
+    size_t i;
+
+    for (i = 0; i < Iterations; i++)
+    {
+        le_sem_Wait(PingSemRef);
+        le_sem_Post(PongSemRef);
+    }
+
+    return NULL;
+}
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ * Run the ping-pong benchmark.
+ */
+// -------------------------------------------------------------------------------------------------
+static void RunPingPong
+(
+    void
+)
+// -------------------------------------------------------------------------------------------------
+{
+    size_t i;
+
+    PingSemRef = le_sem_Create("benchPing", 0);
+    PongSemRef = le_sem_Create("benchPong", 0);
+
+    le_thread_Ref_t pongThread = le_thread_Create("pong", PongMain, NULL);
+    le_thread_SetJoinable(pongThread);
+    le_thread_Start(pongThread);
+
+    le_clk_Time_t startTime = le_clk_GetRelativeTime();
+
+    for (i = 0; i < Iterations; i++)
+    {
+        le_sem_Post(PingSemRef);
+        le_sem_Wait(PongSemRef);
+    }
+
+    uint64_t ns = NsSince(startTime);
+
+    LE_ASSERT(le_thread_Join(pongThread, NULL) == LE_OK);
+
+    le_sem_Delete(PingSemRef);
+    le_sem_Delete(PongSemRef);
+
+    LE_INFO("Ping-pong             %zu round trips: %.1f ns/round trip",
+            Iterations,
+            (double)ns / Iterations);
+}
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ * Main function of the contending threads.
+ */
+// -------------------------------------------------------------------------------------------------
+static void* ContenderMain
+(
+    void* unused
+)
+// -------------------------------------------------------------------------------------------------
+{
+    size_t i;
+
+    for (i = 0; i < Iterations; i++)
+    {
+        le_sem_Wait(LockSemRef);
+        Counter++;
+        le_sem_Post(LockSemRef);
+    }
+
+    return NULL;
+}
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ * Run the contended benchmark with a given number of threads.
+ */
+// -------------------------------------------------------------------------------------------------
+static void RunContended
+(
+    int numThreads
+)
+// -------------------------------------------------------------------------------------------------
+{
+    le_thread_Ref_t threads[MAX_THREADS];
+    int i;
+
+    Counter = 0;
+    LockSemRef = le_sem_Create("benchContended", 1);
+
+    le_clk_Time_t startTime = le_clk_GetRelativeTime();
+
+    for (i = 0; i < numThreads; i++)
+    {
+        char name[32];
+        snprintf(name, sizeof(name), "contender-%d", i);
+        threads[i] = le_thread_Create(name, ContenderMain, NULL);
+        le_thread_SetJoinable(threads[i]);
+        le_thread_Start(threads[i]);
+    }
+
+    for (i = 0; i < numThreads; i++)
+    {
+        LE_ASSERT(le_thread_Join(threads[i], NULL) == LE_OK);
+    }
+
+    uint64_t ns = NsSince(startTime);
+
+    LE_FATAL_IF(Counter != Iterations * numThreads,
+                "Counter is %zu (expected %zu).  Mutual exclusion is broken!",
+                Counter,
+                Iterations * numThreads);
+
+    LE_FATAL_IF(le_sem_GetValue(LockSemRef) != 1,
+                "Semaphore value is %d (expected 1).",
+                le_sem_GetValue(LockSemRef));
+
+    le_sem_Delete(LockSemRef);
+
+    LE_INFO("Contended   %d threads x %zu wait/post pairs: %.1f ns/pair",
+            numThreads,
+            Iterations,
+            (double)ns / (Iterations * numThreads));
+}
+
+
+// -------------------------------------------------------------------------------------------------
+// -------------------------------------------------------------------------------------------------
+COMPONENT_INIT
+{
+    char arg[32];
+    size_t i;
+
+    if ((le_arg_NumArgs() > 0) && (le_arg_GetArg(0, arg, sizeof(arg)) == LE_OK))
+    {
+        Iterations = strtoul(arg, NULL, 0);
+        LE_FATAL_IF(Iterations == 0, "Invalid iteration count '%s'.", arg);
+    }
+
+    LE_INFO("======== BEGIN SEMAPHORE BENCHMARK ========");
+
+    RunUncontended();
+    RunPingPong();
+
+    for (i = 0; i < NUM_ARRAY_MEMBERS(ThreadCounts); i++)
+    {
+        RunContended(ThreadCounts[i]);
+    }
+
+    LE_INFO("======== SEMAPHORE BENCHMARK PASSED ========");
+    exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,187 @@
+// -------------------------------------------------------------------------------------------------
+// Mutex contention benchmark.
+//
+// Measures the cost of locking and unlocking Legato mutexes, first with no contention (a single
+// thread locking and unlocking in a tight loop) and then with several threads all hammering the
+// same mutex to increment a shared counter.  The counter is checked at the end of each contended
+// run, so this also doubles as a stress test of the mutex implementation.
+//
+// The number of iterations per thread can be passed as the first command-line argument.
+//
+// Copyright (C) 2014, Sierra Wireless Inc.
+// -------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+
+/// Default number of lock/unlock iterations per thread.
+#define DEFAULT_ITERATIONS  1000000
+
+/// Thread counts to run the contended benchmark with.
+static const int ThreadCounts[] = { 2, 4, 8 };
+
+/// Largest thread count in ThreadCounts.
+#define MAX_THREADS 8
+
+static size_t Iterations = DEFAULT_ITERATIONS;
+
+static le_mutex_Ref_t MutexRef;
+
+static size_t Counter;
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ * Get the number of nanoseconds elapsed since a given start time.
+ */
+// -------------------------------------------------------------------------------------------------
+static uint64_t NsSince
+(
+    le_clk_Time_t startTime
+)
+// -------------------------------------------------------------------------------------------------
+{
+    le_clk_Time_t elapsed = le_clk_Sub(le_clk_GetRelativeTime(), startTime);
+
+    return ((uint64_t)elapsed.sec * 1000000000ULL) + ((uint64_t)elapsed.usec * 1000ULL);
+}
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ * Run the uncontended benchmark on a given mutex.
+ */
+// -------------------------------------------------------------------------------------------------
+static void RunUncontended
+(
+    const char*     typeName,
+    le_mutex_Ref_t  mutexRef
+)
+// -------------------------------------------------------------------------------------------------
+{
+    size_t i;
+    le_clk_Time_t startTime = le_clk_GetRelativeTime();
+
+    for (i = 0; i < Iterations; i++)
+    {
+        le_mutex_Lock(mutexRef);
+        le_mutex_Unlock(mutexRef);
+    }
+
+    uint64_t ns = NsSince(startTime);
+
+    LE_INFO("Uncontended %-24s %zu lock/unlock pairs: %.1f ns/pair",
+            typeName,
+            Iterations,
+            (double)ns / Iterations);
+}
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ * Main function of the contending threads.
+ */
+// -------------------------------------------------------------------------------------------------
+static void* ContenderMain
+(
+    void* unused
+)
+// -------------------------------------------------------------------------------------------------
+{
+    size_t i;
+
+    for (i = 0; i < Iterations; i++)
+    {
+        le_mutex_Lock(MutexRef);
+        Counter++;
+        le_mutex_Unlock(MutexRef);
+    }
+
+    return NULL;
+}
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ * Run the contended benchmark with a given number of threads.
+ */
+// -------------------------------------------------------------------------------------------------
+static void RunContended
+(
+    int numThreads
+)
+// -------------------------------------------------------------------------------------------------
+{
+    le_thread_Ref_t threads[MAX_THREADS];
+    int i;
+
+    Counter = 0;
+
+    le_clk_Time_t startTime = le_clk_GetRelativeTime();
+
+    for (i = 0; i < numThreads; i++)
+    {
+        char name[32];
+        snprintf(name, sizeof(name), "contender-%d", i);
+        threads[i] = le_thread_Create(name, ContenderMain, NULL);
+        le_thread_SetJoinable(threads[i]);
+        le_thread_Start(threads[i]);
+    }
+
+    for (i = 0; i < numThreads; i++)
+    {
+        LE_ASSERT(le_thread_Join(threads[i], NULL) == LE_OK);
+    }
+
+    uint64_t ns = NsSince(startTime);
+
+    LE_FATAL_IF(Counter != Iterations * numThreads,
+                "Counter is %zu (expected %zu).  Mutual exclusion is broken!",
+                Counter,
+                Iterations * numThreads);
+
+    LE_INFO("Contended   %d threads x %zu lock/unlock pairs: %.1f ns/pair",
+            numThreads,
+            Iterations,
+            (double)ns / (Iterations * numThreads));
+}
+
+
+// -------------------------------------------------------------------------------------------------
+// -------------------------------------------------------------------------------------------------
+COMPONENT_INIT
+{
+    char arg[32];
+    size_t i;
+
+    if ((le_arg_NumArgs() > 0) && (le_arg_GetArg(0, arg, sizeof(arg)) == LE_OK))
+    {
+        Iterations = strtoul(arg, NULL, 0);
+        LE_FATAL_IF(Iterations == 0, "Invalid iteration count '%s'.", arg);
+    }
+
+    LE_INFO("======== BEGIN MUTEX BENCHMARK ========");
+
+    le_mutex_Ref_t nonRecursiveRef = le_mutex_CreateNonRecursive("benchNonRecursive");
+    le_mutex_Ref_t recursiveRef = le_mutex_CreateRecursive("benchRecursive");
+    le_mutex_Ref_t traceableRef = le_mutex_CreateTraceableNonRecursive("benchTraceable");
+
+    RunUncontended("non-recursive", nonRecursiveRef);
+    RunUncontended("recursive", recursiveRef);
+    RunUncontended("traceable non-recursive", traceableRef);
+
+    le_mutex_Delete(nonRecursiveRef);
+    le_mutex_Delete(recursiveRef);
+    le_mutex_Delete(traceableRef);
+
+    MutexRef = le_mutex_CreateNonRecursive("benchContended");
+
+    for (i = 0; i < NUM_ARRAY_MEMBERS(ThreadCounts); i++)
+    {
+        RunContended(ThreadCounts[i]);
+    }
+
+    le_mutex_Delete(MutexRef);
+
+    LE_INFO("======== MUTEX BENCHMARK PASSED ========");
+    exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,201 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * Unit test for the Thread Pool API and for thread CPU affinity.
+ *
+ * A pool of worker threads is created and a batch of jobs is submitted to it from the main
+ * thread.  Some of those jobs submit more jobs from inside the worker threads (which exercises
+ * the work-stealing between workers).  Each job submitted from the main thread has a completion
+ * function that must be run back in the main thread.  When all the completion functions have run,
+ * the pool is deleted (which waits for any remaining nested jobs), and the test signals completion.
+ *
+ * Before that, a thread is started pinned to CPU 0 and checks that its affinity really is CPU 0.
+ *
+ * Copyright 2014, Sierra Wireless Inc.  Use of this work is subject to license.
+ **/
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "threadPool.h"
+
+/// Number of jobs submitted from the main thread.
+#define NUM_JOBS            1000
+
+/// Every Nth job submitted from the main thread submits one more job from its worker thread.
+#define NESTED_JOB_INTERVAL 10
+
+/// Number of worker threads in the pool.
+#define NUM_WORKERS         4
+
+static le_threadPool_Ref_t PoolRef;
+
+static le_thread_Ref_t MainThreadRef;
+
+static void* CompletionObjPtr;
+
+/// Number of work functions that have run (updated atomically by the workers).
+static size_t WorkCount = 0;
+
+/// Number of completion functions that have run (only updated by the main thread).
+static size_t CompletionCount = 0;
+
+/// true when the CPU affinity thread has verified its affinity.
+static bool AffinityChecked = false;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Work function for nested jobs (submitted by a worker thread).
+ **/
+//--------------------------------------------------------------------------------------------------
+static void NestedWork
+(
+    void* param1Ptr,
+    void* param2Ptr
+)
+{
+    __atomic_add_fetch(&WorkCount, 1, __ATOMIC_RELAXED);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Work function for jobs submitted from the main thread.
+ **/
+//--------------------------------------------------------------------------------------------------
+static void Work
+(
+    void* param1Ptr,
+    void* param2Ptr
+)
+{
+    size_t jobNum = (size_t)param1Ptr;
+
+    LE_FATAL_IF(le_thread_GetCurrent() == MainThreadRef, "Work function ran in the main thread.");
+
+    if ((jobNum % NESTED_JOB_INTERVAL) == 0)
+    {
+        le_threadPool_Submit(PoolRef, NestedWork, NULL, NULL, NULL);
+    }
+
+    __atomic_add_fetch(&WorkCount, 1, __ATOMIC_RELAXED);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Completion function for jobs submitted from the main thread.
+ **/
+//--------------------------------------------------------------------------------------------------
+static void Completion
+(
+    void* param1Ptr,
+    void* param2Ptr
+)
+{
+    LE_FATAL_IF(le_thread_GetCurrent() != MainThreadRef,
+                "Completion function ran in thread '%s'.",
+                le_thread_GetMyName());
+
+    LE_ASSERT((size_t)param2Ptr == ((size_t)param1Ptr) * 2);
+
+    CompletionCount++;
+
+    if (CompletionCount == NUM_JOBS)
+    {
+        LE_INFO("All %d thread pool jobs completed.", NUM_JOBS);
+
+        le_threadPool_Delete(PoolRef);
+
+        le_mem_Release(CompletionObjPtr);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Main function of the thread that checks its own CPU affinity.
+ **/
+//--------------------------------------------------------------------------------------------------
+static void* AffinityThreadMain
+(
+    void* unused
+)
+{
+    cpu_set_t cpuSet;
+
+    LE_ASSERT(pthread_getaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet) == 0);
+    LE_ASSERT(CPU_COUNT(&cpuSet) == 1);
+    LE_ASSERT(CPU_ISSET(0, &cpuSet));
+
+    AffinityChecked = true;
+
+    return NULL;
+}
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ * Starts the test.
+ *
+ * Increments the reference count on a given memory pool object, then releases it when the test is
+ * complete.
+ */
+// -------------------------------------------------------------------------------------------------
+void tp_Start
+(
+    void* completionObjPtr  ///< [in] Pointer to the object whose reference count is used to signal
+                            ///       the completion of the test.
+)
+{
+    MainThreadRef = le_thread_GetCurrent();
+
+    // CPU affinity.
+    le_thread_Ref_t threadRef = le_thread_Create("affinity", AffinityThreadMain, NULL);
+    LE_ASSERT(le_thread_SetCpuAffinity(threadRef, 0) == LE_OUT_OF_RANGE);
+    if (sysconf(_SC_NPROCESSORS_CONF) < 64)
+    {
+        // CPUs that don't exist are never online.
+        LE_ASSERT(le_thread_SetCpuAffinity(threadRef, 1ULL << 63) == LE_OUT_OF_RANGE);
+    }
+    LE_ASSERT(le_thread_SetCpuAffinity(threadRef, 0x1) == LE_OK);
+    le_thread_SetJoinable(threadRef);
+    le_thread_Start(threadRef);
+    LE_ASSERT(le_thread_Join(threadRef, NULL) == LE_OK);
+
+    // Thread pool.
+    CompletionObjPtr = completionObjPtr;
+    le_mem_AddRef(completionObjPtr);
+
+    PoolRef = le_threadPool_Create("tpTest", NUM_WORKERS);
+    LE_ASSERT(le_threadPool_SetCpuAffinity(PoolRef, 0) == LE_OUT_OF_RANGE);
+    LE_ASSERT(le_threadPool_SetStackSize(PoolRef, 1) == LE_OVERFLOW);
+    LE_ASSERT(le_threadPool_SetStackSize(PoolRef, 64 * 1024) == LE_OK);
+
+    // Submit half the jobs before the workers are started, and half after.
+    size_t i;
+    for (i = 0; i < NUM_JOBS; i++)
+    {
+        if (i == (NUM_JOBS / 2))
+        {
+            le_threadPool_Start(PoolRef);
+        }
+
+        le_threadPool_Submit(PoolRef, Work, Completion, (void*)i, (void*)(i * 2));
+    }
+}
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ * Checks the completion status of the test.
+ */
+// -------------------------------------------------------------------------------------------------
+void tp_CheckResults
+(
+    void
+)
+{
+    LE_ASSERT(AffinityChecked);
+    LE_ASSERT(CompletionCount == NUM_JOBS);
+    LE_ASSERT(WorkCount == NUM_JOBS + (NUM_JOBS / NESTED_JOB_INTERVAL));
+}
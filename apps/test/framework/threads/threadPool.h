@@ -0,0 +1,37 @@
+// -------------------------------------------------------------------------------------------------
+// Header file for thread pool test.
+//
+// (C) Copyright 2014, Sierra Wireless Inc.  Use of this work is subject to license.
+// -------------------------------------------------------------------------------------------------
+
+#ifndef THREAD_POOL_TEST_H_INCLUDE_GUARD
+#define THREAD_POOL_TEST_H_INCLUDE_GUARD
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ * Starts the test.
+ *
+ * Increments the reference count on a given memory pool object, then releases it when the test is
+ * complete.
+ */
+// -------------------------------------------------------------------------------------------------
+void tp_Start
+(
+    void* objPtr    ///< [in] Pointer to the object whose reference count is used to signal
+                    ///       the completion of the test.
+);
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ * Checks the completion status of the test.
+ */
+// -------------------------------------------------------------------------------------------------
+void tp_CheckResults
+(
+    void
+);
+
+
+#endif // THREAD_POOL_TEST_H_INCLUDE_GUARD
@@ -136,6 +136,26 @@ void TriggerTestA
 }
 
 
+static uint32_t Counter = 0;
+
+void AddToCounter
+(
+    uint32_t amount
+)
+{
+    Counter += amount;
+}
+
+void GetCounter
+(
+    ServerCmdRef_t cmdRef
+)
+{
+    LE_PRINT_VALUE("%u", Counter);
+    GetCounterRespond(cmdRef, Counter);
+}
+
+
 // Add these two functions to satisfy the compiler, but don't need to do
 // anything with them, since they are just used to verify bug fixes in
 // the handler specification.
@@ -73,6 +73,32 @@ void test1(void)
     }
 }
 
+void test3(void)
+{
+    // The one-way calls don't wait for the server, but it still handles them before the
+    // requests that follow them.
+    AddToCounter(1);
+    AddToCounter(2);
+    AddToCounter(3);
+
+    // Send all the requests before waiting for any of the responses.
+    int fdToServer = open("/usr/include/stdio.h", O_RDONLY);
+    int fdFromServer;
+
+    PendingRef_t counterRef = GetCounterStart();
+    PendingRef_t fileRef = FileTestStart(fdToServer);
+    AddToCounter(4);
+    PendingRef_t counterRef2 = GetCounterStart();
+
+    // The responses can be collected in any order.
+    LE_ASSERT(GetCounterFinish(counterRef2) == 10);
+    FileTestFinish(fileRef, &fdFromServer);
+    LE_ASSERT(GetCounterFinish(counterRef) == 6);
+
+    LE_PRINT_VALUE("%i", fdFromServer);
+    close(fdFromServer);
+}
+
 static TestARef_t HandlerRef;
 static uint32_t SomeData = 100;
 
@@ -149,6 +175,9 @@ void StartTest
     banner("Test 1");
     test1();
 
+    banner("Test One-Way and Pipelined Functions");
+    test3();
+
     // Verify that the client session can be stopped.
     banner("Test Stop/Restart Client");
     DisconnectService();
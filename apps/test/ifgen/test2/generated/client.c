@@ -13,272 +13,125 @@
 
 
 //--------------------------------------------------------------------------------------------------
-// Generic Pack/Unpack Functions
+// Message Layouts
 //--------------------------------------------------------------------------------------------------
 
-// todo: These functions could be moved to a separate library, to reduce overall code size and RAM
-//       usage because they are common to each client and server.  However, they would then likely
-//       need to be more generic, and provide better parameter checking and return results.  With
-//       the way they are now, they can be customized to the specific needs of the generated code,
-//       so for now, they will be kept with the generated code.  This may need revisiting later.
-
-// Unused attribute is needed because this function may not always get used
-__attribute__((unused)) static void* PackData(void* msgBufPtr, const void* dataPtr, size_t dataSize)
+typedef struct
 {
-    // todo: should check for buffer overflow, but not sure what to do if it happens
-    //       i.e. is it a fatal error, or just return a result
-
-    memcpy( msgBufPtr, dataPtr, dataSize );
-    return ( msgBufPtr + dataSize );
+    void* contextPtr;
 }
+_Req_AddTestA_t;
+_Static_assert( LE_IPC_ALIGN_SIZE(sizeof(_Req_AddTestA_t)) + 0 <= _MAX_MSG_SIZE,
+                "_Req_AddTestA_t does not fit in a message" );
 
-// Unused attribute is needed because this function may not always get used
-__attribute__((unused)) static void* UnpackData(void* msgBufPtr, void* dataPtr, size_t dataSize)
+typedef struct
 {
-    memcpy( dataPtr, msgBufPtr, dataSize );
-    return ( msgBufPtr + dataSize );
+    TestARef_t _result;
 }
+_Rsp_AddTestA_t;
+_Static_assert( LE_IPC_ALIGN_SIZE(sizeof(_Rsp_AddTestA_t)) + 0 <= _MAX_MSG_SIZE,
+                "_Rsp_AddTestA_t does not fit in a message" );
 
-// Unused attribute is needed because this function may not always get used
-__attribute__((unused)) static void* PackString(void* msgBufPtr, const char* dataStr)
+typedef struct
 {
-    // todo: should check for buffer overflow, but not sure what to do if it happens
-    //       i.e. is it a fatal error, or just return a result
-
-    // Add one for the null character
-    size_t dataSize = strlen(dataStr) + 1;
-
-    memcpy( msgBufPtr, dataStr, dataSize );
-    return ( msgBufPtr + dataSize );
+    void* _clientContextPtr;
+    int32_t x;
 }
+_Ind_AddTestA_t;
+_Static_assert( LE_IPC_ALIGN_SIZE(sizeof(_Ind_AddTestA_t)) + 0 <= _MAX_MSG_SIZE,
+                "_Ind_AddTestA_t does not fit in a message" );
 
-// Unused attribute is needed because this function may not always get used
-__attribute__((unused)) static void* UnpackString(void* msgBufPtr, const char** dataStrPtr)
+typedef struct
 {
-    // Add one for the null character
-    size_t dataSize = strlen(msgBufPtr) + 1;
-
-    // Strings do not have to be word aligned, so just return a pointer
-    // into the message buffer
-    *dataStrPtr = msgBufPtr;
-    return ( msgBufPtr + dataSize );
+    TestARef_t addHandlerRef;
 }
+_Req_RemoveTestA_t;
+_Static_assert( LE_IPC_ALIGN_SIZE(sizeof(_Req_RemoveTestA_t)) + 0 <= _MAX_MSG_SIZE,
+                "_Req_RemoveTestA_t does not fit in a message" );
 
-// todo: This function may eventually replace all usage of UnpackString() above.
-//       Maybe there should also be a PackDataString() function as well?
-// Unused attribute is needed because this function may not always get used
-__attribute__((unused)) static void* UnpackDataString(void* msgBufPtr, void* dataPtr, size_t dataSize)
+typedef struct
 {
-    // Number of bytes copied from msg buffer, not including null terminator
-    size_t numBytes;
-
-    // todo: For now, assume the string will always fit in the buffer. This may not always be true.
-    le_utf8_Copy( dataPtr, msgBufPtr, dataSize, &numBytes );
-    return ( msgBufPtr + (numBytes + 1) );
+    common_EnumExample_t a;
+    size_t dataNumElements;
+    size_t outputNumElements;
+    size_t responseNumElements;
+    size_t moreNumElements;
 }
+_Req_allParameters_t;
+_Static_assert( LE_IPC_ALIGN_SIZE(sizeof(_Req_allParameters_t)) + 80 <= _MAX_MSG_SIZE,
+                "_Req_allParameters_t does not fit in a message" );
 
-
-//--------------------------------------------------------------------------------------------------
-// Generic Client Types, Variables and Functions
-//--------------------------------------------------------------------------------------------------
-
-//--------------------------------------------------------------------------------------------------
-/**
- * Client Data Objects
- *
- * This object is used for each registered handler.  This is needed since we are not using
- * events, but are instead queueing functions directly with the event loop.
- */
-//--------------------------------------------------------------------------------------------------
 typedef struct
 {
-    le_event_HandlerFunc_t handlerPtr;          ///< Registered handler function
-    void*                  contextPtr;          ///< ContextPtr registered with handler
-    le_event_HandlerRef_t  handlerRef;          ///< HandlerRef for the registered handler
-    le_thread_Ref_t        callersThreadRef;    ///< Caller's thread.
+    uint32_t b;
+    size_t outputNumElements;
 }
-_ClientData_t;
-
-
-//--------------------------------------------------------------------------------------------------
-/**
- * The memory pool for client data objects
- */
-//--------------------------------------------------------------------------------------------------
-static le_mem_PoolRef_t _ClientDataPool;
+_Rsp_allParameters_t;
+_Static_assert( LE_IPC_ALIGN_SIZE(sizeof(_Rsp_allParameters_t)) + 112 <= _MAX_MSG_SIZE,
+                "_Rsp_allParameters_t does not fit in a message" );
 
-
-//--------------------------------------------------------------------------------------------------
-/**
- * Client Thread Objects
- *
- * This object is used to contain thread specific data for each IPC client.
- */
-//--------------------------------------------------------------------------------------------------
 typedef struct
 {
-    le_msg_SessionRef_t sessionRef;     ///< Client Session Reference
-    int                 clientCount;    ///< Number of clients sharing this thread
+    uint32_t amount;
 }
-_ClientThreadData_t;
-
-
-//--------------------------------------------------------------------------------------------------
-/**
- * The memory pool for client thread objects
- */
-//--------------------------------------------------------------------------------------------------
-static le_mem_PoolRef_t _ClientThreadDataPool;
-
+_Req_AddToCounter_t;
+_Static_assert( LE_IPC_ALIGN_SIZE(sizeof(_Req_AddToCounter_t)) + 0 <= _MAX_MSG_SIZE,
+                "_Req_AddToCounter_t does not fit in a message" );
 
-//--------------------------------------------------------------------------------------------------
-/**
- * Key under which the pointer to the Thread Object (_ClientThreadData_t) will be kept in
- * thread-local storage.  This allows a thread to quickly get a pointer to its own Thread Object.
- */
-//--------------------------------------------------------------------------------------------------
-static pthread_key_t _ThreadDataKey;
-
-
-//--------------------------------------------------------------------------------------------------
-/**
- * Safe Reference Map for use with Add/Remove handler references
- *
- * @warning Use _Mutex, defined below, to protect accesses to this data.
- */
-//--------------------------------------------------------------------------------------------------
-static le_ref_MapRef_t _HandlerRefMap;
-
-
-//--------------------------------------------------------------------------------------------------
-/**
- * Mutex and associated macros for use with the above HandlerRefMap.
- *
- * Unused attribute is needed because this variable may not always get used.
- */
-//--------------------------------------------------------------------------------------------------
-__attribute__((unused)) static pthread_mutex_t _Mutex = PTHREAD_MUTEX_INITIALIZER;   // POSIX "Fast" mutex.
-
-/// Locks the mutex.
-#define _LOCK    LE_ASSERT(pthread_mutex_lock(&_Mutex) == 0);
-
-/// Unlocks the mutex.
-#define _UNLOCK  LE_ASSERT(pthread_mutex_unlock(&_Mutex) == 0);
-
-
-//--------------------------------------------------------------------------------------------------
-/* This global flag is shared by all client threads, and is used to indicate whether the common
- * data has been initialized.  It is only initialized once by the main thread, and is only read by
- * the other threads.  Thus, a mutex is not needed for accesses to this variable.
- */
-//--------------------------------------------------------------------------------------------------
-static bool CommonDataInitialized = false;
-
-
-//--------------------------------------------------------------------------------------------------
-/**
- * Forward declaration needed by InitClientThreadData
- */
-//--------------------------------------------------------------------------------------------------
-static void ClientIndicationRecvHandler
-(
-    le_msg_MessageRef_t  msgRef,
-    void*                contextPtr
-);
-
-
-//--------------------------------------------------------------------------------------------------
-/**
- * Init thread specific data
- */
-//--------------------------------------------------------------------------------------------------
-static void InitClientThreadData
-(
-    void
-)
+typedef struct
 {
-    // Open a session.
-    le_msg_ProtocolRef_t protocolRef;
-    le_msg_SessionRef_t sessionRef;
-
-    protocolRef = le_msg_GetProtocolRef(PROTOCOL_ID_STR, sizeof(_Message_t));
-    sessionRef = le_msg_CreateSession(protocolRef, SERVICE_INSTANCE_NAME);
-    le_msg_SetSessionRecvHandler(sessionRef, ClientIndicationRecvHandler, NULL);
-    le_msg_OpenSessionSync(sessionRef);
-
-    // Store the client sessionRef in thread-local storage, since each thread requires
-    // its own sessionRef.
-    _ClientThreadData_t* clientThreadPtr = le_mem_ForceAlloc(_ClientThreadDataPool);
-    clientThreadPtr->sessionRef = sessionRef;
-    if (pthread_setspecific(_ThreadDataKey, clientThreadPtr) != 0)
-    {
-        LE_FATAL("pthread_setspecific() failed!");
-    }
-
-    // This is the first client for the current thread
-    clientThreadPtr->clientCount = 1;
+    uint32_t _result;
 }
+_Rsp_GetCounter_t;
+_Static_assert( LE_IPC_ALIGN_SIZE(sizeof(_Rsp_GetCounter_t)) + 0 <= _MAX_MSG_SIZE,
+                "_Rsp_GetCounter_t does not fit in a message" );
 
+typedef struct
+{
+    void* contextPtr;
+}
+_Req_AddBugTest_t;
+_Static_assert( LE_IPC_ALIGN_SIZE(sizeof(_Req_AddBugTest_t)) + 528 <= _MAX_MSG_SIZE,
+                "_Req_AddBugTest_t does not fit in a message" );
 
-//--------------------------------------------------------------------------------------------------
-/**
- * Get a pointer to the client thread data for the current thread.
- *
- * If the current thread does not have client data, then NULL is returned
- */
-//--------------------------------------------------------------------------------------------------
-static _ClientThreadData_t* GetClientThreadDataPtr
-(
-    void
-)
+typedef struct
 {
-    return pthread_getspecific(_ThreadDataKey);
+    BugTestRef_t _result;
 }
+_Rsp_AddBugTest_t;
+_Static_assert( LE_IPC_ALIGN_SIZE(sizeof(_Rsp_AddBugTest_t)) + 0 <= _MAX_MSG_SIZE,
+                "_Rsp_AddBugTest_t does not fit in a message" );
 
+typedef struct
+{
+    void* _clientContextPtr;
+}
+_Ind_AddBugTest_t;
+_Static_assert( LE_IPC_ALIGN_SIZE(sizeof(_Ind_AddBugTest_t)) + 0 <= _MAX_MSG_SIZE,
+                "_Ind_AddBugTest_t does not fit in a message" );
 
-//--------------------------------------------------------------------------------------------------
-/**
- * Return the sessionRef for the current thread.
- *
- * If the current thread does not have a session ref, then this is a fatal error.
- */
-//--------------------------------------------------------------------------------------------------
-__attribute__((unused)) static le_msg_SessionRef_t GetCurrentSessionRef
-(
-    void
-)
+typedef struct
 {
-    _ClientThreadData_t* clientThreadPtr = GetClientThreadDataPtr();
+    BugTestRef_t addHandlerRef;
+}
+_Req_RemoveBugTest_t;
+_Static_assert( LE_IPC_ALIGN_SIZE(sizeof(_Req_RemoveBugTest_t)) + 0 <= _MAX_MSG_SIZE,
+                "_Req_RemoveBugTest_t does not fit in a message" );
 
-    // If the thread specific data is NULL, then the session ref has not been created.
-    LE_FATAL_IF(clientThreadPtr==NULL, "No client session for current thread");
 
-    return clientThreadPtr->sessionRef;
-}
 
+//--------------------------------------------------------------------------------------------------
+// Generic Client Types, Variables and Functions
+//--------------------------------------------------------------------------------------------------
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Init data that is common across all threads.
+ * The client side of the interface.  The IPC runtime (see le_ipc.h) keeps each thread's session
+ * with the server, and the handlers that have been registered with the server.
  */
 //--------------------------------------------------------------------------------------------------
-static void InitCommonData(void)
-{
-    // Allocate the client data pool
-    _ClientDataPool = le_mem_CreatePool("ClientData", sizeof(_ClientData_t));
-
-    // Allocate the client thread pool
-    _ClientThreadDataPool = le_mem_CreatePool("ClientThreadData", sizeof(_ClientThreadData_t));
-
-    // Create the thread-local data key to be used to store a pointer to each thread object.
-    LE_ASSERT(pthread_key_create(&_ThreadDataKey, NULL) == 0);
-
-    // Create safe reference map for handler references.
-    // The size of the map should be based on the number of handlers defined multiplied by
-    // the number of client threads.  Since this number can't be completely determined at
-    // build time, just make a reasonable guess.
-    _HandlerRefMap = le_ref_CreateMap("ClientHandlers", 5);
-}
+static le_ipc_Client_t _Client =
+    LE_IPC_CLIENT_INIT(PROTOCOL_ID_STR, SERVICE_INSTANCE_NAME, sizeof(_Message_t));
 
 
 //--------------------------------------------------------------------------------------------------
@@ -291,28 +144,7 @@ void ConnectService
     void
 )
 {
-    // If this is the first time the function is called, init the client common data.
-    if ( ! CommonDataInitialized )
-    {
-        InitCommonData();
-        CommonDataInitialized = true;
-    }
-
-    _ClientThreadData_t* clientThreadPtr = GetClientThreadDataPtr();
-
-    // If the thread specific data is NULL, then there is no current client session.
-    if (clientThreadPtr == NULL)
-    {
-        InitClientThreadData();
-        LE_DEBUG("======= Starting client for '%s' service ========", SERVICE_INSTANCE_NAME);
-    }
-    else
-    {
-        // Keep track of the number of clients for the current thread.  There is only one
-        // connection per thread, and it is shared by all clients.
-        clientThreadPtr->clientCount++;
-        LE_DEBUG("======= Starting another client for '%s' service ========", SERVICE_INSTANCE_NAME);
-    }
+    le_ipc_ConnectService(&_Client);
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -325,40 +157,7 @@ void DisconnectService
     void
 )
 {
-    _ClientThreadData_t* clientThreadPtr = GetClientThreadDataPtr();
-
-    // If the thread specific data is NULL, then there is no current client session.
-    if (clientThreadPtr == NULL)
-    {
-        LE_CRIT("Trying to stop non-existent client session for '%s' service",
-                SERVICE_INSTANCE_NAME);
-    }
-    else
-    {
-        // This is the last client for this thread, so close the session.
-        if ( clientThreadPtr->clientCount == 1 )
-        {
-            le_msg_CloseSession( clientThreadPtr->sessionRef );
-
-            // Need to delete the thread specific data, since it is no longer valid.  If a new
-            // client session is started, new thread specific data will be allocated.
-            le_mem_Release(clientThreadPtr);
-            if (pthread_setspecific(_ThreadDataKey, NULL) != 0)
-            {
-                LE_FATAL("pthread_setspecific() failed!");
-            }
-
-            LE_DEBUG("======= Stopping client for '%s' service ========", SERVICE_INSTANCE_NAME);
-        }
-        else
-        {
-            // There is one less client sharing this thread's connection.
-            clientThreadPtr->clientCount--;
-
-            LE_DEBUG("======= Stopping another client for '%s' service ========",
-                     SERVICE_INSTANCE_NAME);
-        }
-    }
+    le_ipc_DisconnectService(&_Client);
 }
 
 
@@ -368,29 +167,31 @@ void DisconnectService
 
 
 // This function parses the message buffer received from the server, and then calls the user
-// registered handler, which is stored in a client data object.
+// registered handler, which is stored in a client handler object.
 static void _Handle_AddTestA
 (
     void* _reportPtr,
-    void* _notUsed
+    void* _dataPtr
 )
 {
     le_msg_MessageRef_t _msgRef = _reportPtr;
     _Message_t* _msgPtr = le_msg_GetPayloadPtr(_msgRef);
-    uint8_t* _msgBufPtr = _msgPtr->buffer;
+    __attribute__((unused)) uint8_t* _msgBufPtr = _msgPtr->buffer;
+    __attribute__((unused)) uint8_t* _msgBufEndPtr = _msgPtr->buffer + _MAX_MSG_SIZE;
 
-    // The clientContextPtr always exists and is always first.
-    void* _clientContextPtr;
-    _msgBufPtr = UnpackData( _msgBufPtr, &_clientContextPtr, sizeof(void*) );
+    // The fixed-size fields are at the start of the message
+    __attribute__((unused)) _Ind_AddTestA_t* _rxFieldsPtr =
+        (_Ind_AddTestA_t*)_msgBufPtr;
+    _msgBufPtr += LE_IPC_ALIGN_SIZE(sizeof(_Ind_AddTestA_t));
 
-    // Pull out additional data from the context pointer
-    _ClientData_t* _clientDataPtr = _clientContextPtr;
-    TestAFunc_t _handlerRef_AddTestA = (TestAFunc_t)_clientDataPtr->handlerPtr;
-    void* contextPtr = _clientDataPtr->contextPtr;
+    // The IPC runtime has already looked up the client handler object, which the server sends
+    // back as the first field of the message.
+    le_ipc_ClientHandler_t* _clientHandlerPtr = _dataPtr;
+    TestAFunc_t _handlerRef_AddTestA = (TestAFunc_t)_clientHandlerPtr->handlerPtr;
+    void* contextPtr = _clientHandlerPtr->contextPtr;
 
     // Unpack the remaining parameters
-    int32_t x;
-    _msgBufPtr = UnpackData( _msgBufPtr, &x, sizeof(int32_t) );
+    int32_t x = _rxFieldsPtr->x;
 
 
     // Call the registered handler
@@ -428,6 +229,7 @@ TestARef_t AddTestA
 
     // Will not be used if no data is sent/received from server.
     __attribute__((unused)) uint8_t* _msgBufPtr;
+    __attribute__((unused)) uint8_t* _msgBufEndPtr;
 
     TestARef_t _result;
 
@@ -435,21 +237,25 @@ TestARef_t AddTestA
 
 
     // Create a new message object and get the message buffer
-    _msgRef = le_msg_CreateMsg(GetCurrentSessionRef());
+    _msgRef = le_msg_CreateMsg(le_ipc_GetSessionRef(&_Client));
     _msgPtr = le_msg_GetPayloadPtr(_msgRef);
     _msgPtr->id = _MSGID_AddTestA;
     _msgBufPtr = _msgPtr->buffer;
+    _msgBufEndPtr = _msgPtr->buffer + _MAX_MSG_SIZE;
+
+    // The fixed-size fields are at the start of the message
+    _Req_AddTestA_t* _txFieldsPtr = (_Req_AddTestA_t*)_msgBufPtr;
+    _msgBufPtr += LE_IPC_ALIGN_SIZE(sizeof(_Req_AddTestA_t));
 
     // Pack the input parameters
-    // The input parameters are stored in the client data object, and it is
+    // The input parameters are stored in a client handler object, and it is
     // a pointer to this object that is passed down.
-    // Create a new client data object and fill it in
-    _ClientData_t* _clientDataPtr = le_mem_ForceAlloc(_ClientDataPool);
-    _clientDataPtr->handlerPtr = (le_event_HandlerFunc_t)handlerPtr;
-    _clientDataPtr->contextPtr = contextPtr;
-    _clientDataPtr->callersThreadRef = le_thread_GetCurrent();
-    contextPtr = _clientDataPtr;
-    _msgBufPtr = PackData( _msgBufPtr, &contextPtr, sizeof(void*) );
+    le_ipc_ClientHandler_t* _clientHandlerPtr =
+        le_ipc_NewClientHandler((le_event_HandlerFunc_t)handlerPtr,
+                                contextPtr,
+                                _Handle_AddTestA);
+    contextPtr = _clientHandlerPtr;
+    _txFieldsPtr->contextPtr = contextPtr;
 
     // Send a request to the server and get the response.
     LE_DEBUG("Sending message to server and waiting for response");
@@ -460,15 +266,17 @@ TestARef_t AddTestA
     // Process the result and/or output parameters, if there are any.
     _msgPtr = le_msg_GetPayloadPtr(_responseMsgRef);
     _msgBufPtr = _msgPtr->buffer;
+    _msgBufEndPtr = _msgPtr->buffer + _MAX_MSG_SIZE;
+
+    // The fixed-size fields are at the start of the message
+    _Rsp_AddTestA_t* _rxFieldsPtr = (_Rsp_AddTestA_t*)_msgBufPtr;
+    _msgBufPtr += LE_IPC_ALIGN_SIZE(sizeof(_Rsp_AddTestA_t));
 
     // Unpack the result first
-    _msgBufPtr = UnpackData( _msgBufPtr, &_result, sizeof(_result) );
-    // Put the handler reference result into the client data object, and
-    // then return a safe reference to the client data object as the reference.
-    _clientDataPtr->handlerRef = (le_event_HandlerRef_t)_result;
-    _LOCK
-    _result = le_ref_CreateRef(_HandlerRefMap, _clientDataPtr);
-    _UNLOCK
+    _result = _rxFieldsPtr->_result;
+    // Put the handler reference result into the client handler object, and
+    // then return a safe reference to the client handler object as the reference.
+    _result = le_ipc_AddClientHandler(_clientHandlerPtr, (le_event_HandlerRef_t)_result);
 
     // Unpack any "out" parameters
 
@@ -497,6 +305,7 @@ void RemoveTestA
 
     // Will not be used if no data is sent/received from server.
     __attribute__((unused)) uint8_t* _msgBufPtr;
+    __attribute__((unused)) uint8_t* _msgBufEndPtr;
 
 
 
@@ -504,22 +313,22 @@ void RemoveTestA
 
 
     // Create a new message object and get the message buffer
-    _msgRef = le_msg_CreateMsg(GetCurrentSessionRef());
+    _msgRef = le_msg_CreateMsg(le_ipc_GetSessionRef(&_Client));
     _msgPtr = le_msg_GetPayloadPtr(_msgRef);
     _msgPtr->id = _MSGID_RemoveTestA;
     _msgBufPtr = _msgPtr->buffer;
+    _msgBufEndPtr = _msgPtr->buffer + _MAX_MSG_SIZE;
+
+    // The fixed-size fields are at the start of the message
+    _Req_RemoveTestA_t* _txFieldsPtr = (_Req_RemoveTestA_t*)_msgBufPtr;
+    _msgBufPtr += LE_IPC_ALIGN_SIZE(sizeof(_Req_RemoveTestA_t));
 
     // Pack the input parameters
-    // The passed in handlerRef is a safe reference for the client data object.  Need to get the
-    // real handlerRef from the client data object and then delete both the safe reference and
-    // the object since they are no longer needed.
-    _LOCK
-    _ClientData_t* clientDataPtr = le_ref_Lookup(_HandlerRefMap, addHandlerRef);
-    le_ref_DeleteRef(_HandlerRefMap, addHandlerRef);
-    _UNLOCK
-    addHandlerRef = (TestARef_t)clientDataPtr->handlerRef;
-    le_mem_Release(clientDataPtr);
-    _msgBufPtr = PackData( _msgBufPtr, &addHandlerRef, sizeof(TestARef_t) );
+    // The passed in handlerRef is a safe reference for the client handler object.  Need to get the
+    // real handlerRef from the client handler object, which is then deleted, since it is no longer
+    // needed.
+    addHandlerRef = (TestARef_t)le_ipc_RemoveClientHandler(addHandlerRef);
+    _txFieldsPtr->addHandlerRef = addHandlerRef;
 
     // Send a request to the server and get the response.
     LE_DEBUG("Sending message to server and waiting for response");
@@ -530,6 +339,7 @@ void RemoveTestA
     // Process the result and/or output parameters, if there are any.
     _msgPtr = le_msg_GetPayloadPtr(_responseMsgRef);
     _msgBufPtr = _msgPtr->buffer;
+    _msgBufEndPtr = _msgPtr->buffer + _MAX_MSG_SIZE;
 
 
     // Unpack any "out" parameters
@@ -594,28 +404,33 @@ void allParameters
 
     // Will not be used if no data is sent/received from server.
     __attribute__((unused)) uint8_t* _msgBufPtr;
+    __attribute__((unused)) uint8_t* _msgBufEndPtr;
 
 
 
     // Range check values, if appropriate
     if ( dataNumElements > 10 ) LE_FATAL("dataNumElements > 10");
-    if ( strlen(label) > 20 ) LE_FATAL("strlen(label) > 20");
 
 
     // Create a new message object and get the message buffer
-    _msgRef = le_msg_CreateMsg(GetCurrentSessionRef());
+    _msgRef = le_msg_CreateMsg(le_ipc_GetSessionRef(&_Client));
     _msgPtr = le_msg_GetPayloadPtr(_msgRef);
     _msgPtr->id = _MSGID_allParameters;
     _msgBufPtr = _msgPtr->buffer;
+    _msgBufEndPtr = _msgPtr->buffer + _MAX_MSG_SIZE;
+
+    // The fixed-size fields are at the start of the message
+    _Req_allParameters_t* _txFieldsPtr = (_Req_allParameters_t*)_msgBufPtr;
+    _msgBufPtr += LE_IPC_ALIGN_SIZE(sizeof(_Req_allParameters_t));
 
     // Pack the input parameters
-    _msgBufPtr = PackData( _msgBufPtr, &a, sizeof(common_EnumExample_t) );
-    _msgBufPtr = PackData( _msgBufPtr, &dataNumElements, sizeof(size_t) );
-    _msgBufPtr = PackData( _msgBufPtr, dataPtr, dataNumElements*sizeof(uint32_t) );
-    _msgBufPtr = PackData( _msgBufPtr, outputNumElementsPtr, sizeof(size_t) );
-    _msgBufPtr = PackString( _msgBufPtr, label );
-    _msgBufPtr = PackData( _msgBufPtr, &responseNumElements, sizeof(size_t) );
-    _msgBufPtr = PackData( _msgBufPtr, &moreNumElements, sizeof(size_t) );
+    _txFieldsPtr->a = a;
+    _txFieldsPtr->dataNumElements = dataNumElements;
+    le_ipc_PackArray( &_msgBufPtr, _msgBufEndPtr, dataPtr, dataNumElements*sizeof(uint32_t) );
+    _txFieldsPtr->outputNumElements = *outputNumElementsPtr;
+    le_ipc_PackString( &_msgBufPtr, _msgBufEndPtr, label, 20 );
+    _txFieldsPtr->responseNumElements = responseNumElements;
+    _txFieldsPtr->moreNumElements = moreNumElements;
 
     // Send a request to the server and get the response.
     LE_DEBUG("Sending message to server and waiting for response");
@@ -626,14 +441,21 @@ void allParameters
     // Process the result and/or output parameters, if there are any.
     _msgPtr = le_msg_GetPayloadPtr(_responseMsgRef);
     _msgBufPtr = _msgPtr->buffer;
+    _msgBufEndPtr = _msgPtr->buffer + _MAX_MSG_SIZE;
+
+    // The fixed-size fields are at the start of the message
+    _Rsp_allParameters_t* _rxFieldsPtr = (_Rsp_allParameters_t*)_msgBufPtr;
+    _msgBufPtr += LE_IPC_ALIGN_SIZE(sizeof(_Rsp_allParameters_t));
 
 
     // Unpack any "out" parameters
-    _msgBufPtr = UnpackData( _msgBufPtr, bPtr, sizeof(uint32_t) );
-    _msgBufPtr = UnpackData( _msgBufPtr, outputNumElementsPtr, sizeof(size_t) );
-    _msgBufPtr = UnpackData( _msgBufPtr, outputPtr, *outputNumElementsPtr*sizeof(uint32_t) );
-    _msgBufPtr = UnpackDataString( _msgBufPtr, response, responseNumElements*sizeof(char) );
-    _msgBufPtr = UnpackDataString( _msgBufPtr, more, moreNumElements*sizeof(char) );
+    *bPtr = _rxFieldsPtr->b;
+    if ( _rxFieldsPtr->outputNumElements > *outputNumElementsPtr ) _msgBufPtr = NULL;
+    *outputNumElementsPtr = _rxFieldsPtr->outputNumElements;
+    le_ipc_UnpackArrayCopy( &_msgBufPtr, _msgBufEndPtr, outputPtr, *outputNumElementsPtr*sizeof(uint32_t) );
+    le_ipc_UnpackStringCopy( &_msgBufPtr, _msgBufEndPtr, response, responseNumElements*sizeof(char) );
+    le_ipc_UnpackStringCopy( &_msgBufPtr, _msgBufEndPtr, more, moreNumElements*sizeof(char) );
+    LE_FATAL_IF(_msgBufPtr == NULL, "Invalid response received from server");
 
     // Release the message object, now that all results/output has been copied.
     le_msg_ReleaseMsg(_responseMsgRef);
@@ -662,6 +484,7 @@ void FileTest
 
     // Will not be used if no data is sent/received from server.
     __attribute__((unused)) uint8_t* _msgBufPtr;
+    __attribute__((unused)) uint8_t* _msgBufEndPtr;
 
 
 
@@ -669,10 +492,11 @@ void FileTest
 
 
     // Create a new message object and get the message buffer
-    _msgRef = le_msg_CreateMsg(GetCurrentSessionRef());
+    _msgRef = le_msg_CreateMsg(le_ipc_GetSessionRef(&_Client));
     _msgPtr = le_msg_GetPayloadPtr(_msgRef);
     _msgPtr->id = _MSGID_FileTest;
     _msgBufPtr = _msgPtr->buffer;
+    _msgBufEndPtr = _msgPtr->buffer + _MAX_MSG_SIZE;
 
     // Pack the input parameters
     le_msg_SetFd(_msgRef, dataFile);
@@ -686,6 +510,85 @@ void FileTest
     // Process the result and/or output parameters, if there are any.
     _msgPtr = le_msg_GetPayloadPtr(_responseMsgRef);
     _msgBufPtr = _msgPtr->buffer;
+    _msgBufEndPtr = _msgPtr->buffer + _MAX_MSG_SIZE;
+
+
+    // Unpack any "out" parameters
+    *dataOutPtr = le_msg_GetFd(_responseMsgRef);
+
+    // Release the message object, now that all results/output has been copied.
+    le_msg_ReleaseMsg(_responseMsgRef);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Pipelined client function: sends the request for FileTest() without waiting for the
+ * response, which must be collected with FileTestFinish()
+ */
+//--------------------------------------------------------------------------------------------------
+PendingRef_t FileTestStart
+(
+    int dataFile
+)
+{
+    le_msg_MessageRef_t _msgRef;
+    _Message_t* _msgPtr;
+
+    // Will not be used if no data is sent to the server.
+    __attribute__((unused)) uint8_t* _msgBufPtr;
+    __attribute__((unused)) uint8_t* _msgBufEndPtr;
+
+    // Range check values, if appropriate
+
+
+    // Create a new message object and get the message buffer
+    _msgRef = le_msg_CreateMsg(le_ipc_GetSessionRef(&_Client));
+    _msgPtr = le_msg_GetPayloadPtr(_msgRef);
+    _msgPtr->id = _MSGID_FileTest;
+    _msgBufPtr = _msgPtr->buffer;
+    _msgBufEndPtr = _msgPtr->buffer + _MAX_MSG_SIZE;
+
+    // Pack the input parameters
+    le_msg_SetFd(_msgRef, dataFile);
+
+    // Send the request to the server, without waiting for the response.
+    LE_DEBUG("Sending message to server");
+    return (PendingRef_t)le_ipc_StartRequest(_msgRef);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Pipelined client function: waits for the response to FileTestStart(), unless it has
+ * already arrived, and returns the result and OUT parameters of FileTest()
+ */
+//--------------------------------------------------------------------------------------------------
+void FileTestFinish
+(
+    PendingRef_t _pendingRef,
+    int* dataOutPtr
+)
+{
+    le_msg_MessageRef_t _responseMsgRef;
+    _Message_t* _msgPtr;
+
+    // Will not be used if no data is received from server.
+    __attribute__((unused)) uint8_t* _msgBufPtr;
+    __attribute__((unused)) uint8_t* _msgBufEndPtr;
+
+
+
+    // Get the response to the request, waiting for it if it hasn't arrived yet.
+    LE_DEBUG("Waiting for response from server");
+    _responseMsgRef = le_ipc_FinishRequest((le_ipc_PendingRef_t)_pendingRef, _MSGID_FileTest);
+    // It is a serious error if we don't get a valid response from the server
+    LE_FATAL_IF(_responseMsgRef == NULL, "Valid response was not received from server");
+
+    // Process the result and/or output parameters, if there are any.
+    _msgPtr = le_msg_GetPayloadPtr(_responseMsgRef);
+    _msgBufPtr = _msgPtr->buffer;
+    _msgBufEndPtr = _msgPtr->buffer + _MAX_MSG_SIZE;
 
 
     // Unpack any "out" parameters
@@ -713,6 +616,7 @@ void TriggerTestA
 
     // Will not be used if no data is sent/received from server.
     __attribute__((unused)) uint8_t* _msgBufPtr;
+    __attribute__((unused)) uint8_t* _msgBufEndPtr;
 
 
 
@@ -720,10 +624,11 @@ void TriggerTestA
 
 
     // Create a new message object and get the message buffer
-    _msgRef = le_msg_CreateMsg(GetCurrentSessionRef());
+    _msgRef = le_msg_CreateMsg(le_ipc_GetSessionRef(&_Client));
     _msgPtr = le_msg_GetPayloadPtr(_msgRef);
     _msgPtr->id = _MSGID_TriggerTestA;
     _msgBufPtr = _msgPtr->buffer;
+    _msgBufEndPtr = _msgPtr->buffer + _MAX_MSG_SIZE;
 
     // Pack the input parameters
 
@@ -737,6 +642,7 @@ void TriggerTestA
     // Process the result and/or output parameters, if there are any.
     _msgPtr = le_msg_GetPayloadPtr(_responseMsgRef);
     _msgBufPtr = _msgPtr->buffer;
+    _msgBufEndPtr = _msgPtr->buffer + _MAX_MSG_SIZE;
 
 
     // Unpack any "out" parameters
@@ -747,26 +653,293 @@ void TriggerTestA
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Pipelined client function: sends the request for TriggerTestA() without waiting for the
+ * response, which must be collected with TriggerTestAFinish()
+ */
+//--------------------------------------------------------------------------------------------------
+PendingRef_t TriggerTestAStart
+(
+    void
+)
+{
+    le_msg_MessageRef_t _msgRef;
+    _Message_t* _msgPtr;
+
+    // Will not be used if no data is sent to the server.
+    __attribute__((unused)) uint8_t* _msgBufPtr;
+    __attribute__((unused)) uint8_t* _msgBufEndPtr;
+
+    // Range check values, if appropriate
+
+
+    // Create a new message object and get the message buffer
+    _msgRef = le_msg_CreateMsg(le_ipc_GetSessionRef(&_Client));
+    _msgPtr = le_msg_GetPayloadPtr(_msgRef);
+    _msgPtr->id = _MSGID_TriggerTestA;
+    _msgBufPtr = _msgPtr->buffer;
+    _msgBufEndPtr = _msgPtr->buffer + _MAX_MSG_SIZE;
+
+    // Pack the input parameters
+
+
+    // Send the request to the server, without waiting for the response.
+    LE_DEBUG("Sending message to server");
+    return (PendingRef_t)le_ipc_StartRequest(_msgRef);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Pipelined client function: waits for the response to TriggerTestAStart(), unless it has
+ * already arrived, and returns the result and OUT parameters of TriggerTestA()
+ */
+//--------------------------------------------------------------------------------------------------
+void TriggerTestAFinish
+(
+    PendingRef_t _pendingRef
+)
+{
+    le_msg_MessageRef_t _responseMsgRef;
+    _Message_t* _msgPtr;
+
+    // Will not be used if no data is received from server.
+    __attribute__((unused)) uint8_t* _msgBufPtr;
+    __attribute__((unused)) uint8_t* _msgBufEndPtr;
+
+
+
+    // Get the response to the request, waiting for it if it hasn't arrived yet.
+    LE_DEBUG("Waiting for response from server");
+    _responseMsgRef = le_ipc_FinishRequest((le_ipc_PendingRef_t)_pendingRef, _MSGID_TriggerTestA);
+    // It is a serious error if we don't get a valid response from the server
+    LE_FATAL_IF(_responseMsgRef == NULL, "Valid response was not received from server");
+
+    // Process the result and/or output parameters, if there are any.
+    _msgPtr = le_msg_GetPayloadPtr(_responseMsgRef);
+    _msgBufPtr = _msgPtr->buffer;
+    _msgBufEndPtr = _msgPtr->buffer + _MAX_MSG_SIZE;
+
+
+    // Unpack any "out" parameters
+
+
+    // Release the message object, now that all results/output has been copied.
+    le_msg_ReleaseMsg(_responseMsgRef);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Adds to a counter on the server.  The client doesn't wait for the server to do it.
+ */
+//--------------------------------------------------------------------------------------------------
+void AddToCounter
+(
+    uint32_t amount
+        ///< [IN]
+)
+{
+    le_msg_MessageRef_t _msgRef;
+    _Message_t* _msgPtr;
+
+    // Will not be used if no data is sent to the server.
+    __attribute__((unused)) uint8_t* _msgBufPtr;
+    __attribute__((unused)) uint8_t* _msgBufEndPtr;
+
+    // Range check values, if appropriate
+
+
+    // Create a new message object and get the message buffer
+    _msgRef = le_msg_CreateMsg(le_ipc_GetSessionRef(&_Client));
+    _msgPtr = le_msg_GetPayloadPtr(_msgRef);
+    _msgPtr->id = _MSGID_AddToCounter;
+    _msgBufPtr = _msgPtr->buffer;
+    _msgBufEndPtr = _msgPtr->buffer + _MAX_MSG_SIZE;
+
+    // The fixed-size fields are at the start of the message
+    _Req_AddToCounter_t* _txFieldsPtr = (_Req_AddToCounter_t*)_msgBufPtr;
+    _msgBufPtr += LE_IPC_ALIGN_SIZE(sizeof(_Req_AddToCounter_t));
+
+    // Pack the input parameters
+    _txFieldsPtr->amount = amount;
+
+    // Send the request to the server.  The server doesn't respond to a one-way function.
+    LE_DEBUG("Sending one-way message to server");
+    le_msg_Send(_msgRef);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the counter, which includes the amounts from all the earlier calls to AddToCounter().
+ */
+//--------------------------------------------------------------------------------------------------
+uint32_t GetCounter
+(
+    void
+)
+{
+    le_msg_MessageRef_t _msgRef;
+    le_msg_MessageRef_t _responseMsgRef;
+    _Message_t* _msgPtr;
+
+    // Will not be used if no data is sent/received from server.
+    __attribute__((unused)) uint8_t* _msgBufPtr;
+    __attribute__((unused)) uint8_t* _msgBufEndPtr;
+
+    uint32_t _result;
+
+    // Range check values, if appropriate
+
+
+    // Create a new message object and get the message buffer
+    _msgRef = le_msg_CreateMsg(le_ipc_GetSessionRef(&_Client));
+    _msgPtr = le_msg_GetPayloadPtr(_msgRef);
+    _msgPtr->id = _MSGID_GetCounter;
+    _msgBufPtr = _msgPtr->buffer;
+    _msgBufEndPtr = _msgPtr->buffer + _MAX_MSG_SIZE;
+
+    // Pack the input parameters
+
+
+    // Send a request to the server and get the response.
+    LE_DEBUG("Sending message to server and waiting for response");
+    _responseMsgRef = le_msg_RequestSyncResponse(_msgRef);
+    // It is a serious error if we don't get a valid response from the server
+    LE_FATAL_IF(_responseMsgRef == NULL, "Valid response was not received from server");
+
+    // Process the result and/or output parameters, if there are any.
+    _msgPtr = le_msg_GetPayloadPtr(_responseMsgRef);
+    _msgBufPtr = _msgPtr->buffer;
+    _msgBufEndPtr = _msgPtr->buffer + _MAX_MSG_SIZE;
+
+    // The fixed-size fields are at the start of the message
+    _Rsp_GetCounter_t* _rxFieldsPtr = (_Rsp_GetCounter_t*)_msgBufPtr;
+    _msgBufPtr += LE_IPC_ALIGN_SIZE(sizeof(_Rsp_GetCounter_t));
+
+    // Unpack the result first
+    _result = _rxFieldsPtr->_result;
+
+    // Unpack any "out" parameters
+
+
+    // Release the message object, now that all results/output has been copied.
+    le_msg_ReleaseMsg(_responseMsgRef);
+
+    return _result;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Pipelined client function: sends the request for GetCounter() without waiting for the
+ * response, which must be collected with GetCounterFinish()
+ */
+//--------------------------------------------------------------------------------------------------
+PendingRef_t GetCounterStart
+(
+    void
+)
+{
+    le_msg_MessageRef_t _msgRef;
+    _Message_t* _msgPtr;
+
+    // Will not be used if no data is sent to the server.
+    __attribute__((unused)) uint8_t* _msgBufPtr;
+    __attribute__((unused)) uint8_t* _msgBufEndPtr;
+
+    // Range check values, if appropriate
+
+
+    // Create a new message object and get the message buffer
+    _msgRef = le_msg_CreateMsg(le_ipc_GetSessionRef(&_Client));
+    _msgPtr = le_msg_GetPayloadPtr(_msgRef);
+    _msgPtr->id = _MSGID_GetCounter;
+    _msgBufPtr = _msgPtr->buffer;
+    _msgBufEndPtr = _msgPtr->buffer + _MAX_MSG_SIZE;
+
+    // Pack the input parameters
+
+
+    // Send the request to the server, without waiting for the response.
+    LE_DEBUG("Sending message to server");
+    return (PendingRef_t)le_ipc_StartRequest(_msgRef);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Pipelined client function: waits for the response to GetCounterStart(), unless it has
+ * already arrived, and returns the result and OUT parameters of GetCounter()
+ */
+//--------------------------------------------------------------------------------------------------
+uint32_t GetCounterFinish
+(
+    PendingRef_t _pendingRef
+)
+{
+    le_msg_MessageRef_t _responseMsgRef;
+    _Message_t* _msgPtr;
+
+    // Will not be used if no data is received from server.
+    __attribute__((unused)) uint8_t* _msgBufPtr;
+    __attribute__((unused)) uint8_t* _msgBufEndPtr;
+
+    uint32_t _result;
+
+    // Get the response to the request, waiting for it if it hasn't arrived yet.
+    LE_DEBUG("Waiting for response from server");
+    _responseMsgRef = le_ipc_FinishRequest((le_ipc_PendingRef_t)_pendingRef, _MSGID_GetCounter);
+    // It is a serious error if we don't get a valid response from the server
+    LE_FATAL_IF(_responseMsgRef == NULL, "Valid response was not received from server");
+
+    // Process the result and/or output parameters, if there are any.
+    _msgPtr = le_msg_GetPayloadPtr(_responseMsgRef);
+    _msgBufPtr = _msgPtr->buffer;
+    _msgBufEndPtr = _msgPtr->buffer + _MAX_MSG_SIZE;
+
+    // The fixed-size fields are at the start of the message
+    _Rsp_GetCounter_t* _rxFieldsPtr = (_Rsp_GetCounter_t*)_msgBufPtr;
+    _msgBufPtr += LE_IPC_ALIGN_SIZE(sizeof(_Rsp_GetCounter_t));
+
+    // Unpack the result first
+    _result = _rxFieldsPtr->_result;
+
+    // Unpack any "out" parameters
+
+
+    // Release the message object, now that all results/output has been copied.
+    le_msg_ReleaseMsg(_responseMsgRef);
+
+    return _result;
+}
+
+
 // This function parses the message buffer received from the server, and then calls the user
-// registered handler, which is stored in a client data object.
+// registered handler, which is stored in a client handler object.
 static void _Handle_AddBugTest
 (
     void* _reportPtr,
-    void* _notUsed
+    void* _dataPtr
 )
 {
     le_msg_MessageRef_t _msgRef = _reportPtr;
     _Message_t* _msgPtr = le_msg_GetPayloadPtr(_msgRef);
-    uint8_t* _msgBufPtr = _msgPtr->buffer;
+    __attribute__((unused)) uint8_t* _msgBufPtr = _msgPtr->buffer;
+    __attribute__((unused)) uint8_t* _msgBufEndPtr = _msgPtr->buffer + _MAX_MSG_SIZE;
 
-    // The clientContextPtr always exists and is always first.
-    void* _clientContextPtr;
-    _msgBufPtr = UnpackData( _msgBufPtr, &_clientContextPtr, sizeof(void*) );
+    // The fixed-size fields are at the start of the message
+    __attribute__((unused)) _Ind_AddBugTest_t* _rxFieldsPtr =
+        (_Ind_AddBugTest_t*)_msgBufPtr;
+    _msgBufPtr += LE_IPC_ALIGN_SIZE(sizeof(_Ind_AddBugTest_t));
 
-    // Pull out additional data from the context pointer
-    _ClientData_t* _clientDataPtr = _clientContextPtr;
-    BugTestFunc_t _handlerRef_AddBugTest = (BugTestFunc_t)_clientDataPtr->handlerPtr;
-    void* contextPtr = _clientDataPtr->contextPtr;
+    // The IPC runtime has already looked up the client handler object, which the server sends
+    // back as the first field of the message.
+    le_ipc_ClientHandler_t* _clientHandlerPtr = _dataPtr;
+    BugTestFunc_t _handlerRef_AddBugTest = (BugTestFunc_t)_clientHandlerPtr->handlerPtr;
+    void* contextPtr = _clientHandlerPtr->contextPtr;
 
     // Unpack the remaining parameters
 
@@ -809,30 +982,34 @@ BugTestRef_t AddBugTest
 
     // Will not be used if no data is sent/received from server.
     __attribute__((unused)) uint8_t* _msgBufPtr;
+    __attribute__((unused)) uint8_t* _msgBufEndPtr;
 
     BugTestRef_t _result;
 
     // Range check values, if appropriate
-    if ( strlen(newPathPtr) > 512 ) LE_FATAL("strlen(newPathPtr) > 512");
 
 
     // Create a new message object and get the message buffer
-    _msgRef = le_msg_CreateMsg(GetCurrentSessionRef());
+    _msgRef = le_msg_CreateMsg(le_ipc_GetSessionRef(&_Client));
     _msgPtr = le_msg_GetPayloadPtr(_msgRef);
     _msgPtr->id = _MSGID_AddBugTest;
     _msgBufPtr = _msgPtr->buffer;
+    _msgBufEndPtr = _msgPtr->buffer + _MAX_MSG_SIZE;
+
+    // The fixed-size fields are at the start of the message
+    _Req_AddBugTest_t* _txFieldsPtr = (_Req_AddBugTest_t*)_msgBufPtr;
+    _msgBufPtr += LE_IPC_ALIGN_SIZE(sizeof(_Req_AddBugTest_t));
 
     // Pack the input parameters
-    _msgBufPtr = PackString( _msgBufPtr, newPathPtr );
-    // The input parameters are stored in the client data object, and it is
+    le_ipc_PackString( &_msgBufPtr, _msgBufEndPtr, newPathPtr, 512 );
+    // The input parameters are stored in a client handler object, and it is
     // a pointer to this object that is passed down.
-    // Create a new client data object and fill it in
-    _ClientData_t* _clientDataPtr = le_mem_ForceAlloc(_ClientDataPool);
-    _clientDataPtr->handlerPtr = (le_event_HandlerFunc_t)handlerPtr;
-    _clientDataPtr->contextPtr = contextPtr;
-    _clientDataPtr->callersThreadRef = le_thread_GetCurrent();
-    contextPtr = _clientDataPtr;
-    _msgBufPtr = PackData( _msgBufPtr, &contextPtr, sizeof(void*) );
+    le_ipc_ClientHandler_t* _clientHandlerPtr =
+        le_ipc_NewClientHandler((le_event_HandlerFunc_t)handlerPtr,
+                                contextPtr,
+                                _Handle_AddBugTest);
+    contextPtr = _clientHandlerPtr;
+    _txFieldsPtr->contextPtr = contextPtr;
 
     // Send a request to the server and get the response.
     LE_DEBUG("Sending message to server and waiting for response");
@@ -843,15 +1020,17 @@ BugTestRef_t AddBugTest
     // Process the result and/or output parameters, if there are any.
     _msgPtr = le_msg_GetPayloadPtr(_responseMsgRef);
     _msgBufPtr = _msgPtr->buffer;
+    _msgBufEndPtr = _msgPtr->buffer + _MAX_MSG_SIZE;
+
+    // The fixed-size fields are at the start of the message
+    _Rsp_AddBugTest_t* _rxFieldsPtr = (_Rsp_AddBugTest_t*)_msgBufPtr;
+    _msgBufPtr += LE_IPC_ALIGN_SIZE(sizeof(_Rsp_AddBugTest_t));
 
     // Unpack the result first
-    _msgBufPtr = UnpackData( _msgBufPtr, &_result, sizeof(_result) );
-    // Put the handler reference result into the client data object, and
-    // then return a safe reference to the client data object as the reference.
-    _clientDataPtr->handlerRef = (le_event_HandlerRef_t)_result;
-    _LOCK
-    _result = le_ref_CreateRef(_HandlerRefMap, _clientDataPtr);
-    _UNLOCK
+    _result = _rxFieldsPtr->_result;
+    // Put the handler reference result into the client handler object, and
+    // then return a safe reference to the client handler object as the reference.
+    _result = le_ipc_AddClientHandler(_clientHandlerPtr, (le_event_HandlerRef_t)_result);
 
     // Unpack any "out" parameters
 
@@ -880,6 +1059,7 @@ void RemoveBugTest
 
     // Will not be used if no data is sent/received from server.
     __attribute__((unused)) uint8_t* _msgBufPtr;
+    __attribute__((unused)) uint8_t* _msgBufEndPtr;
 
 
 
@@ -887,22 +1067,22 @@ void RemoveBugTest
 
 
     // Create a new message object and get the message buffer
-    _msgRef = le_msg_CreateMsg(GetCurrentSessionRef());
+    _msgRef = le_msg_CreateMsg(le_ipc_GetSessionRef(&_Client));
     _msgPtr = le_msg_GetPayloadPtr(_msgRef);
     _msgPtr->id = _MSGID_RemoveBugTest;
     _msgBufPtr = _msgPtr->buffer;
+    _msgBufEndPtr = _msgPtr->buffer + _MAX_MSG_SIZE;
+
+    // The fixed-size fields are at the start of the message
+    _Req_RemoveBugTest_t* _txFieldsPtr = (_Req_RemoveBugTest_t*)_msgBufPtr;
+    _msgBufPtr += LE_IPC_ALIGN_SIZE(sizeof(_Req_RemoveBugTest_t));
 
     // Pack the input parameters
-    // The passed in handlerRef is a safe reference for the client data object.  Need to get the
-    // real handlerRef from the client data object and then delete both the safe reference and
-    // the object since they are no longer needed.
-    _LOCK
-    _ClientData_t* clientDataPtr = le_ref_Lookup(_HandlerRefMap, addHandlerRef);
-    le_ref_DeleteRef(_HandlerRefMap, addHandlerRef);
-    _UNLOCK
-    addHandlerRef = (BugTestRef_t)clientDataPtr->handlerRef;
-    le_mem_Release(clientDataPtr);
-    _msgBufPtr = PackData( _msgBufPtr, &addHandlerRef, sizeof(BugTestRef_t) );
+    // The passed in handlerRef is a safe reference for the client handler object.  Need to get the
+    // real handlerRef from the client handler object, which is then deleted, since it is no longer
+    // needed.
+    addHandlerRef = (BugTestRef_t)le_ipc_RemoveClientHandler(addHandlerRef);
+    _txFieldsPtr->addHandlerRef = addHandlerRef;
 
     // Send a request to the server and get the response.
     LE_DEBUG("Sending message to server and waiting for response");
@@ -913,6 +1093,7 @@ void RemoveBugTest
     // Process the result and/or output parameters, if there are any.
     _msgPtr = le_msg_GetPayloadPtr(_responseMsgRef);
     _msgBufPtr = _msgPtr->buffer;
+    _msgBufEndPtr = _msgPtr->buffer + _MAX_MSG_SIZE;
 
 
     // Unpack any "out" parameters
@@ -922,38 +1103,3 @@ void RemoveBugTest
     le_msg_ReleaseMsg(_responseMsgRef);
 }
 
-
-static void ClientIndicationRecvHandler
-(
-    le_msg_MessageRef_t  msgRef,
-    void*                contextPtr
-)
-{
-    // Get the message payload
-    _Message_t* msgPtr = le_msg_GetPayloadPtr(msgRef);
-    uint8_t* _msgBufPtr = msgPtr->buffer;
-
-    // Have to partially unpack the received message in order to know which thread
-    // the queued function should actually go to.
-    void* clientContextPtr;
-    _msgBufPtr = UnpackData( _msgBufPtr, &clientContextPtr, sizeof(void*) );
-
-    // Pull out the callers thread
-    _ClientData_t* clientDataPtr = clientContextPtr;
-    le_thread_Ref_t callersThreadRef = clientDataPtr->callersThreadRef;
-
-    // Trigger the appropriate event
-    switch (msgPtr->id)
-    {
-        case _MSGID_AddTestA :
-            le_event_QueueFunctionToThread(callersThreadRef, _Handle_AddTestA, msgRef, NULL);
-            break;
-
-        case _MSGID_AddBugTest :
-            le_event_QueueFunctionToThread(callersThreadRef, _Handle_AddBugTest, msgRef, NULL);
-            break;
-
-        default: LE_ERROR("Unknowm msg id = %i for client thread = %p", msgPtr->id, callersThreadRef);
-    }
-}
-
@@ -28,6 +28,14 @@
 
 #include "legato.h"
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reference to a request sent by a pipelined client function (see the Start functions).  The
+ * corresponding Finish function must be called exactly once with it, to collect the response.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct Pending* PendingRef_t;
+
 // Interface specific includes
 #include "common_interface.h"
 
@@ -224,6 +232,29 @@ void FileTest
         ///< file descriptor as OUT parameter
 );
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Pipelined client function: sends the request for FileTest() without waiting for the
+ * response, which must be collected with FileTestFinish()
+ */
+//--------------------------------------------------------------------------------------------------
+PendingRef_t FileTestStart
+(
+    int dataFile
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Pipelined client function: waits for the response to FileTestStart(), unless it has
+ * already arrived, and returns the result and OUT parameters of FileTest()
+ */
+//--------------------------------------------------------------------------------------------------
+void FileTestFinish
+(
+    PendingRef_t _pendingRef,
+    int* dataOutPtr
+);
+
 //--------------------------------------------------------------------------------------------------
 /**
  * This function fakes an event, so that the handler will be called.
@@ -235,6 +266,71 @@ void TriggerTestA
     void
 );
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Pipelined client function: sends the request for TriggerTestA() without waiting for the
+ * response, which must be collected with TriggerTestAFinish()
+ */
+//--------------------------------------------------------------------------------------------------
+PendingRef_t TriggerTestAStart
+(
+    void
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Pipelined client function: waits for the response to TriggerTestAStart(), unless it has
+ * already arrived, and returns the result and OUT parameters of TriggerTestA()
+ */
+//--------------------------------------------------------------------------------------------------
+void TriggerTestAFinish
+(
+    PendingRef_t _pendingRef
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Adds to a counter on the server.  The client doesn't wait for the server to do it.
+ */
+//--------------------------------------------------------------------------------------------------
+void AddToCounter
+(
+    uint32_t amount
+        ///< [IN]
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the counter, which includes the amounts from all the earlier calls to AddToCounter().
+ */
+//--------------------------------------------------------------------------------------------------
+uint32_t GetCounter
+(
+    void
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Pipelined client function: sends the request for GetCounter() without waiting for the
+ * response, which must be collected with GetCounterFinish()
+ */
+//--------------------------------------------------------------------------------------------------
+PendingRef_t GetCounterStart
+(
+    void
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Pipelined client function: waits for the response to GetCounterStart(), unless it has
+ * already arrived, and returns the result and OUT parameters of GetCounter()
+ */
+//--------------------------------------------------------------------------------------------------
+uint32_t GetCounterFinish
+(
+    PendingRef_t _pendingRef
+);
+
 //--------------------------------------------------------------------------------------------------
 /**
  * BugTest handler ADD function
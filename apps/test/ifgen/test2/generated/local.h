@@ -14,21 +14,20 @@
 
 #include "legato.h"
 
-#define PROTOCOL_ID_STR "c9337ed4525894becbab4dd2c594a184a1016b4a356c0a4940880820f91d5897"
+#define PROTOCOL_ID_STR "e3d78bcca6e4217f5ce565bc8278a7c1a2cb0605e1e2f3ebdb5da540e0105d0a"
 
 #define SERVICE_INSTANCE_NAME "example"
 
 
-// todo: This will need to depend on the particular protocol, but the exact size is not easy to
-//       calculate right now, so in the meantime, pick a reasonably large size.  Once interface
-//       type support has been added, this will be replaced by a more appropriate size.
-#define _MAX_MSG_SIZE 1000
+// Upper bound on the size of any of the messages, worked out from the sizes given in the
+// interface.  The generated code checks that each message's fields fit.
+#define _MAX_MSG_SIZE 536
 
 // Define the message type for communicating between client and server
 typedef struct
 {
     uint32_t id;
-    uint8_t buffer[_MAX_MSG_SIZE];
+    uint8_t buffer[_MAX_MSG_SIZE] __attribute__((aligned(8)));
 }
 _Message_t;
 
@@ -37,8 +36,10 @@ _Message_t;
 #define _MSGID_allParameters 2
 #define _MSGID_FileTest 3
 #define _MSGID_TriggerTestA 4
-#define _MSGID_AddBugTest 5
-#define _MSGID_RemoveBugTest 6
+#define _MSGID_AddToCounter 5
+#define _MSGID_GetCounter 6
+#define _MSGID_AddBugTest 7
+#define _MSGID_RemoveBugTest 8
 
 
 #endif // LOCAL_H_INCLUDE_GUARD
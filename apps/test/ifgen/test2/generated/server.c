@@ -13,280 +13,111 @@
 
 
 //--------------------------------------------------------------------------------------------------
-// Generic Pack/Unpack Functions
+// Message Layouts
 //--------------------------------------------------------------------------------------------------
 
-// todo: These functions could be moved to a separate library, to reduce overall code size and RAM
-//       usage because they are common to each client and server.  However, they would then likely
-//       need to be more generic, and provide better parameter checking and return results.  With
-//       the way they are now, they can be customized to the specific needs of the generated code,
-//       so for now, they will be kept with the generated code.  This may need revisiting later.
-
-// Unused attribute is needed because this function may not always get used
-__attribute__((unused)) static void* PackData(void* msgBufPtr, const void* dataPtr, size_t dataSize)
+typedef struct
 {
-    // todo: should check for buffer overflow, but not sure what to do if it happens
-    //       i.e. is it a fatal error, or just return a result
-
-    memcpy( msgBufPtr, dataPtr, dataSize );
-    return ( msgBufPtr + dataSize );
+    void* contextPtr;
 }
+_Req_AddTestA_t;
+_Static_assert( LE_IPC_ALIGN_SIZE(sizeof(_Req_AddTestA_t)) + 0 <= _MAX_MSG_SIZE,
+                "_Req_AddTestA_t does not fit in a message" );
 
-// Unused attribute is needed because this function may not always get used
-__attribute__((unused)) static void* UnpackData(void* msgBufPtr, void* dataPtr, size_t dataSize)
+typedef struct
 {
-    memcpy( dataPtr, msgBufPtr, dataSize );
-    return ( msgBufPtr + dataSize );
+    TestARef_t _result;
 }
+_Rsp_AddTestA_t;
+_Static_assert( LE_IPC_ALIGN_SIZE(sizeof(_Rsp_AddTestA_t)) + 0 <= _MAX_MSG_SIZE,
+                "_Rsp_AddTestA_t does not fit in a message" );
 
-// Unused attribute is needed because this function may not always get used
-__attribute__((unused)) static void* PackString(void* msgBufPtr, const char* dataStr)
+typedef struct
 {
-    // todo: should check for buffer overflow, but not sure what to do if it happens
-    //       i.e. is it a fatal error, or just return a result
-
-    // Add one for the null character
-    size_t dataSize = strlen(dataStr) + 1;
-
-    memcpy( msgBufPtr, dataStr, dataSize );
-    return ( msgBufPtr + dataSize );
+    void* _clientContextPtr;
+    int32_t x;
 }
+_Ind_AddTestA_t;
+_Static_assert( LE_IPC_ALIGN_SIZE(sizeof(_Ind_AddTestA_t)) + 0 <= _MAX_MSG_SIZE,
+                "_Ind_AddTestA_t does not fit in a message" );
 
-// Unused attribute is needed because this function may not always get used
-__attribute__((unused)) static void* UnpackString(void* msgBufPtr, const char** dataStrPtr)
+typedef struct
 {
-    // Add one for the null character
-    size_t dataSize = strlen(msgBufPtr) + 1;
-
-    // Strings do not have to be word aligned, so just return a pointer
-    // into the message buffer
-    *dataStrPtr = msgBufPtr;
-    return ( msgBufPtr + dataSize );
+    TestARef_t addHandlerRef;
 }
+_Req_RemoveTestA_t;
+_Static_assert( LE_IPC_ALIGN_SIZE(sizeof(_Req_RemoveTestA_t)) + 0 <= _MAX_MSG_SIZE,
+                "_Req_RemoveTestA_t does not fit in a message" );
 
-// todo: This function may eventually replace all usage of UnpackString() above.
-//       Maybe there should also be a PackDataString() function as well?
-// Unused attribute is needed because this function may not always get used
-__attribute__((unused)) static void* UnpackDataString(void* msgBufPtr, void* dataPtr, size_t dataSize)
+typedef struct
 {
-    // Number of bytes copied from msg buffer, not including null terminator
-    size_t numBytes;
-
-    // todo: For now, assume the string will always fit in the buffer. This may not always be true.
-    le_utf8_Copy( dataPtr, msgBufPtr, dataSize, &numBytes );
-    return ( msgBufPtr + (numBytes + 1) );
+    common_EnumExample_t a;
+    size_t dataNumElements;
+    size_t outputNumElements;
+    size_t responseNumElements;
+    size_t moreNumElements;
 }
+_Req_allParameters_t;
+_Static_assert( LE_IPC_ALIGN_SIZE(sizeof(_Req_allParameters_t)) + 80 <= _MAX_MSG_SIZE,
+                "_Req_allParameters_t does not fit in a message" );
 
-
-//--------------------------------------------------------------------------------------------------
-// Generic Server Types, Variables and Functions
-//--------------------------------------------------------------------------------------------------
-
-//--------------------------------------------------------------------------------------------------
-/**
- * Type definition for generic function to remove a handler, given the handler ref.
- */
-//--------------------------------------------------------------------------------------------------
-typedef void(* RemoveHandlerFunc_t)(void *handlerRef);
-
-
-//--------------------------------------------------------------------------------------------------
-/**
- * Server Data Objects
- *
- * This object is used to store additional context info for each request
- */
-//--------------------------------------------------------------------------------------------------
 typedef struct
 {
-    le_msg_SessionRef_t   clientSessionRef;     ///< The client to send the response to
-    void*                 contextPtr;           ///< ContextPtr registered with handler
-    le_event_HandlerRef_t handlerRef;           ///< HandlerRef for the registered handler
-    RemoveHandlerFunc_t   removeHandlerFunc;    ///< Function to remove the registered handler
+    uint32_t b;
+    size_t outputNumElements;
 }
-_ServerData_t;
-
-
-//--------------------------------------------------------------------------------------------------
-/**
- * The memory pool for server data objects
- */
-//--------------------------------------------------------------------------------------------------
-static le_mem_PoolRef_t _ServerDataPool;
-
-
-//--------------------------------------------------------------------------------------------------
-/**
- * Safe Reference Map for use with Add/Remove handler references
- *
- * @warning Use _Mutex, defined below, to protect accesses to this data.
- */
-//--------------------------------------------------------------------------------------------------
-static le_ref_MapRef_t _HandlerRefMap;
-
-
-//--------------------------------------------------------------------------------------------------
-/**
- * Mutex and associated macros for use with the above HandlerRefMap.
- *
- * Unused attribute is needed because this variable may not always get used.
- */
-//--------------------------------------------------------------------------------------------------
-__attribute__((unused)) static pthread_mutex_t _Mutex = PTHREAD_MUTEX_INITIALIZER;   // POSIX "Fast" mutex.
+_Rsp_allParameters_t;
+_Static_assert( LE_IPC_ALIGN_SIZE(sizeof(_Rsp_allParameters_t)) + 112 <= _MAX_MSG_SIZE,
+                "_Rsp_allParameters_t does not fit in a message" );
 
-/// Locks the mutex.
-#define _LOCK    LE_ASSERT(pthread_mutex_lock(&_Mutex) == 0);
-
-/// Unlocks the mutex.
-#define _UNLOCK  LE_ASSERT(pthread_mutex_unlock(&_Mutex) == 0);
-
-
-//--------------------------------------------------------------------------------------------------
-/**
- * Forward declaration needed by StartServer
- */
-//--------------------------------------------------------------------------------------------------
-static void ServerMsgRecvHandler
-(
-    le_msg_MessageRef_t msgRef,
-    void*               contextPtr
-);
-
-
-//--------------------------------------------------------------------------------------------------
-/**
- * Server Service Reference
- */
-//--------------------------------------------------------------------------------------------------
-static le_msg_ServiceRef_t _ServerServiceRef;
-
-
-//--------------------------------------------------------------------------------------------------
-/**
- * Client Session Reference for the current message received from a client
- */
-//--------------------------------------------------------------------------------------------------
-static le_msg_SessionRef_t _ClientSessionRef;
-
-
-//--------------------------------------------------------------------------------------------------
-/**
- * Cleanup client data if the client is no longer connected
- */
-//--------------------------------------------------------------------------------------------------
-static void CleanupClientData
-(
-    le_msg_SessionRef_t sessionRef,
-    void *contextPtr
-)
+typedef struct
 {
-    LE_DEBUG("Client %p is closed !!!", sessionRef);
-
-    // Iterate over the server data reference map and remove anything that matches
-    // the client session.
-    _LOCK
-
-    le_ref_IterRef_t iterRef = le_ref_GetIterator(_HandlerRefMap);
-    le_result_t result = le_ref_NextNode(iterRef);
-    _ServerData_t const* serverDataPtr;
-
-    while ( result == LE_OK )
-    {
-        serverDataPtr =  le_ref_GetValue(iterRef);
-
-        if ( sessionRef != serverDataPtr->clientSessionRef )
-        {
-            LE_DEBUG("Found session ref %p; does not match",
-                     serverDataPtr->clientSessionRef);
-        }
-        else
-        {
-            LE_DEBUG("Found session ref %p; match found, so needs cleanup",
-                     serverDataPtr->clientSessionRef);
-
-            // Remove the handler
-            serverDataPtr->removeHandlerFunc( serverDataPtr->handlerRef );
-
-            // Release the server data block
-            le_mem_Release((void*)serverDataPtr);
-
-            // Delete the associated safeRef
-            le_ref_DeleteRef( _HandlerRefMap, (void*)le_ref_GetSafeRef(iterRef) );
-
-            // Since the reference map was modified, the iterator is no longer valid and
-            // so has to be re-initalized.  This means that some values may get revisited,
-            // but eventually this will iterate over the whole reference map.
-            // todo: Is there an easier way?
-            iterRef = le_ref_GetIterator(_HandlerRefMap);
-        }
-
-        // Get the next value in the reference mpa
-        result = le_ref_NextNode(iterRef);
-    }
-
-    _UNLOCK
+    uint32_t amount;
 }
+_Req_AddToCounter_t;
+_Static_assert( LE_IPC_ALIGN_SIZE(sizeof(_Req_AddToCounter_t)) + 0 <= _MAX_MSG_SIZE,
+                "_Req_AddToCounter_t does not fit in a message" );
 
-
-//--------------------------------------------------------------------------------------------------
-/**
- * Get the server service reference
- */
-//--------------------------------------------------------------------------------------------------
-le_msg_ServiceRef_t GetServiceRef
-(
-    void
-)
+typedef struct
 {
-    return _ServerServiceRef;
+    uint32_t _result;
 }
+_Rsp_GetCounter_t;
+_Static_assert( LE_IPC_ALIGN_SIZE(sizeof(_Rsp_GetCounter_t)) + 0 <= _MAX_MSG_SIZE,
+                "_Rsp_GetCounter_t does not fit in a message" );
 
-
-//--------------------------------------------------------------------------------------------------
-/**
- * Get the client session reference for the current message
- */
-//--------------------------------------------------------------------------------------------------
-le_msg_SessionRef_t GetClientSessionRef
-(
-    void
-)
+typedef struct
 {
-    return _ClientSessionRef;
+    void* contextPtr;
 }
+_Req_AddBugTest_t;
+_Static_assert( LE_IPC_ALIGN_SIZE(sizeof(_Req_AddBugTest_t)) + 528 <= _MAX_MSG_SIZE,
+                "_Req_AddBugTest_t does not fit in a message" );
 
-
-//--------------------------------------------------------------------------------------------------
-/**
- * Initialize the server and advertise the service.
- */
-//--------------------------------------------------------------------------------------------------
-void AdvertiseService
-(
-    void
-)
+typedef struct
 {
-    LE_DEBUG("======= Starting Server %s ========", SERVICE_INSTANCE_NAME);
-
-    le_msg_ProtocolRef_t protocolRef;
-
-    // Create the server data pool
-    _ServerDataPool = le_mem_CreatePool("ServerData", sizeof(_ServerData_t));
-
-    // Create safe reference map for handler references.
-    // The size of the map should be based on the number of handlers defined for the server.
-    // Don't expect that to be more than 2-3, so use 3 as a reasonable guess.
-    _HandlerRefMap = le_ref_CreateMap("ServerHandlers", 3);
+    BugTestRef_t _result;
+}
+_Rsp_AddBugTest_t;
+_Static_assert( LE_IPC_ALIGN_SIZE(sizeof(_Rsp_AddBugTest_t)) + 0 <= _MAX_MSG_SIZE,
+                "_Rsp_AddBugTest_t does not fit in a message" );
 
-    // Start the server side of the service
-    protocolRef = le_msg_GetProtocolRef(PROTOCOL_ID_STR, sizeof(_Message_t));
-    _ServerServiceRef = le_msg_CreateService(protocolRef, SERVICE_INSTANCE_NAME);
-    le_msg_SetServiceRecvHandler(_ServerServiceRef, ServerMsgRecvHandler, NULL);
-    le_msg_AdvertiseService(_ServerServiceRef);
+typedef struct
+{
+    void* _clientContextPtr;
+}
+_Ind_AddBugTest_t;
+_Static_assert( LE_IPC_ALIGN_SIZE(sizeof(_Ind_AddBugTest_t)) + 0 <= _MAX_MSG_SIZE,
+                "_Ind_AddBugTest_t does not fit in a message" );
 
-    // Register for client sessions being closed
-    le_msg_SetServiceCloseHandler(_ServerServiceRef, CleanupClientData, NULL);
+typedef struct
+{
+    BugTestRef_t addHandlerRef;
 }
+_Req_RemoveBugTest_t;
+_Static_assert( LE_IPC_ALIGN_SIZE(sizeof(_Req_RemoveBugTest_t)) + 0 <= _MAX_MSG_SIZE,
+                "_Req_RemoveBugTest_t does not fit in a message" );
+
 
 
 //--------------------------------------------------------------------------------------------------
@@ -302,25 +133,31 @@ static void AsyncResponse_AddTestA
 {
     le_msg_MessageRef_t _msgRef;
     _Message_t* _msgPtr;
-    _ServerData_t* serverDataPtr = (_ServerData_t*)contextPtr;
+    le_ipc_ServerHandler_t* _serverHandlerPtr = contextPtr;
 
     // Will not be used if no data is sent back to client
     __attribute__((unused)) uint8_t* _msgBufPtr;
+    __attribute__((unused)) uint8_t* _msgBufEndPtr;
 
     // Create a new message object and get the message buffer
-    _msgRef = le_msg_CreateMsg(serverDataPtr->clientSessionRef);
+    _msgRef = le_msg_CreateMsg(_serverHandlerPtr->clientSessionRef);
     _msgPtr = le_msg_GetPayloadPtr(_msgRef);
     _msgPtr->id = _MSGID_AddTestA;
     _msgBufPtr = _msgPtr->buffer;
+    _msgBufEndPtr = _msgPtr->buffer + _MAX_MSG_SIZE;
+
+    // The fixed-size fields are at the start of the message
+    _Ind_AddTestA_t* _txFieldsPtr = (_Ind_AddTestA_t*)_msgBufPtr;
+    _msgBufPtr += LE_IPC_ALIGN_SIZE(sizeof(_Ind_AddTestA_t));
 
     // Always pack the client context pointer first
-    _msgBufPtr = PackData( _msgBufPtr, &(serverDataPtr->contextPtr), sizeof(void*) );
+    _txFieldsPtr->_clientContextPtr = _serverHandlerPtr->contextPtr;
 
     // Pack the input parameters
-    _msgBufPtr = PackData( _msgBufPtr, &x, sizeof(int32_t) );
+    _txFieldsPtr->x = x;
 
     // Send the async response to the client
-    LE_DEBUG("Sending message to client session %p", serverDataPtr->clientSessionRef);
+    LE_DEBUG("Sending message to client session %p", _serverHandlerPtr->clientSessionRef);
     le_msg_Send(_msgRef);
 }
 
@@ -332,22 +169,24 @@ static void Handle_AddTestA
 )
 {
     // Get the message buffer pointer
-    uint8_t* _msgBufPtr = ((_Message_t*)le_msg_GetPayloadPtr(_msgRef))->buffer;
+    __attribute__((unused)) uint8_t* _msgBufPtr = ((_Message_t*)le_msg_GetPayloadPtr(_msgRef))->buffer;
+    __attribute__((unused)) uint8_t* _msgBufEndPtr = _msgBufPtr + _MAX_MSG_SIZE;
 
     // Needed if we are returning a result or output values
     uint8_t* _msgBufStartPtr = _msgBufPtr;
 
+    // The fixed-size fields are at the start of the message
+    _Req_AddTestA_t* _rxFieldsPtr = (_Req_AddTestA_t*)_msgBufPtr;
+    _msgBufPtr += LE_IPC_ALIGN_SIZE(sizeof(_Req_AddTestA_t));
+
     // Unpack the input parameters from the message
 
 
-    void* contextPtr;
-    _msgBufPtr = UnpackData( _msgBufPtr, &contextPtr, sizeof(void*) );
+    void* contextPtr = _rxFieldsPtr->contextPtr;
 
-    // Create a new server data object and fill it in
-    _ServerData_t* serverDataPtr = le_mem_ForceAlloc(_ServerDataPool);
-    serverDataPtr->clientSessionRef = le_msg_GetSession(_msgRef);
-    serverDataPtr->contextPtr = contextPtr;
-    contextPtr = serverDataPtr;
+    // Create a new server handler object, which is passed to the function as the context pointer
+    le_ipc_ServerHandler_t* _serverHandlerPtr = le_ipc_NewServerHandler(_msgRef, contextPtr);
+    contextPtr = _serverHandlerPtr;
 
     // Define storage for output parameters
 
@@ -357,22 +196,23 @@ static void Handle_AddTestA
     _result = AddTestA ( AsyncResponse_AddTestA, contextPtr );
 
     // Put the handler reference result and a pointer to the associated remove function
-    // into the server data object.  This function pointer is needed in case the client
-    // is closed and the handlers need to be removed.
-    serverDataPtr->handlerRef = (le_event_HandlerRef_t)_result;
-    serverDataPtr->removeHandlerFunc = (RemoveHandlerFunc_t)RemoveTestA;
-
-    // Return a safe reference to the server data object as the reference.
-    _LOCK
-    _result = le_ref_CreateRef(_HandlerRefMap, serverDataPtr);
-    _UNLOCK
+    // into the server handler object.  This function pointer is needed in case the client
+    // is closed and the handlers need to be removed.  A safe reference to the server handler
+    // object is returned as the reference.
+    _result = le_ipc_AddServerHandler(_serverHandlerPtr,
+                                      (le_event_HandlerRef_t)_result,
+                                      (le_ipc_RemoveHandlerFunc_t)RemoveTestA);
 
 
     // Re-use the message buffer for the response
     _msgBufPtr = _msgBufStartPtr;
 
+    // The fixed-size fields are at the start of the message
+    _Rsp_AddTestA_t* _txFieldsPtr = (_Rsp_AddTestA_t*)_msgBufPtr;
+    _msgBufPtr += LE_IPC_ALIGN_SIZE(sizeof(_Rsp_AddTestA_t));
+
     // Pack the result first
-    _msgBufPtr = PackData( _msgBufPtr, &_result, sizeof(_result) );
+    _txFieldsPtr->_result = _result;
 
     // Pack any "out" parameters
 
@@ -390,23 +230,27 @@ static void Handle_RemoveTestA
 )
 {
     // Get the message buffer pointer
-    uint8_t* _msgBufPtr = ((_Message_t*)le_msg_GetPayloadPtr(_msgRef))->buffer;
+    __attribute__((unused)) uint8_t* _msgBufPtr = ((_Message_t*)le_msg_GetPayloadPtr(_msgRef))->buffer;
+    __attribute__((unused)) uint8_t* _msgBufEndPtr = _msgBufPtr + _MAX_MSG_SIZE;
 
     // Needed if we are returning a result or output values
     uint8_t* _msgBufStartPtr = _msgBufPtr;
 
+    // The fixed-size fields are at the start of the message
+    _Req_RemoveTestA_t* _rxFieldsPtr = (_Req_RemoveTestA_t*)_msgBufPtr;
+    _msgBufPtr += LE_IPC_ALIGN_SIZE(sizeof(_Req_RemoveTestA_t));
+
     // Unpack the input parameters from the message
-    TestARef_t addHandlerRef;
-    _msgBufPtr = UnpackData( _msgBufPtr, &addHandlerRef, sizeof(TestARef_t) );
-    // The passed in handlerRef is a safe reference for the server data object.  Need to get the
-    // real handlerRef from the server data object and then delete both the safe reference and
-    // the object since they are no longer needed.
-    _LOCK
-    _ServerData_t* serverDataPtr = le_ref_Lookup(_HandlerRefMap, addHandlerRef);
-    le_ref_DeleteRef(_HandlerRefMap, addHandlerRef);
-    _UNLOCK
-    addHandlerRef = (TestARef_t)serverDataPtr->handlerRef;
-    le_mem_Release(serverDataPtr);
+    TestARef_t addHandlerRef = _rxFieldsPtr->addHandlerRef;
+    // The passed in handlerRef is a safe reference for the server handler object.  Need to get the
+    // real handlerRef from the server handler object, which is then deleted, since it is no longer
+    // needed.  The client is dropped if the reference is not valid or is not its own.
+    addHandlerRef = (TestARef_t)le_ipc_RemoveServerHandler(_msgRef, addHandlerRef);
+    if ( addHandlerRef == NULL )
+    {
+        le_msg_ReleaseMsg(_msgRef);
+        return;
+    }
 
 
     // Define storage for output parameters
@@ -436,32 +280,42 @@ static void Handle_allParameters
 )
 {
     // Get the message buffer pointer
-    uint8_t* _msgBufPtr = ((_Message_t*)le_msg_GetPayloadPtr(_msgRef))->buffer;
+    __attribute__((unused)) uint8_t* _msgBufPtr = ((_Message_t*)le_msg_GetPayloadPtr(_msgRef))->buffer;
+    __attribute__((unused)) uint8_t* _msgBufEndPtr = _msgBufPtr + _MAX_MSG_SIZE;
 
     // Needed if we are returning a result or output values
     uint8_t* _msgBufStartPtr = _msgBufPtr;
 
+    // The fixed-size fields are at the start of the message
+    _Req_allParameters_t* _rxFieldsPtr = (_Req_allParameters_t*)_msgBufPtr;
+    _msgBufPtr += LE_IPC_ALIGN_SIZE(sizeof(_Req_allParameters_t));
+
     // Unpack the input parameters from the message
-    common_EnumExample_t a;
-    _msgBufPtr = UnpackData( _msgBufPtr, &a, sizeof(common_EnumExample_t) );
+    common_EnumExample_t a = _rxFieldsPtr->a;
 
-    size_t dataNumElements;
-    _msgBufPtr = UnpackData( _msgBufPtr, &dataNumElements, sizeof(size_t) );
+    size_t dataNumElements = _rxFieldsPtr->dataNumElements;
+    if ( dataNumElements > 10 ) _msgBufPtr = NULL;
 
-    uint32_t data[dataNumElements];
-    _msgBufPtr = UnpackData( _msgBufPtr, data, dataNumElements*sizeof(uint32_t) );
+    const uint32_t* data = le_ipc_UnpackArray( &_msgBufPtr, _msgBufEndPtr, dataNumElements*sizeof(uint32_t) );
 
-    size_t outputNumElements;
-    _msgBufPtr = UnpackData( _msgBufPtr, &outputNumElements, sizeof(size_t) );
+    size_t outputNumElements = _rxFieldsPtr->outputNumElements;
+    if ( outputNumElements > 10 ) outputNumElements = 10;
 
-    const char* label;
-    _msgBufPtr = UnpackString( _msgBufPtr, &label );
+    const char* label = le_ipc_UnpackString( &_msgBufPtr, _msgBufEndPtr, 20 );
 
-    size_t responseNumElements;
-    _msgBufPtr = UnpackData( _msgBufPtr, &responseNumElements, sizeof(size_t) );
+    size_t responseNumElements = _rxFieldsPtr->responseNumElements;
+    if ( responseNumElements > 21 ) responseNumElements = 21;
 
-    size_t moreNumElements;
-    _msgBufPtr = UnpackData( _msgBufPtr, &moreNumElements, sizeof(size_t) );
+    size_t moreNumElements = _rxFieldsPtr->moreNumElements;
+    if ( moreNumElements > 21 ) moreNumElements = 21;
+
+    // The client is dropped if anything in the message is not valid
+    if ( _msgBufPtr == NULL )
+    {
+        LE_KILL_CLIENT("Invalid message received from client");
+        le_msg_ReleaseMsg(_msgRef);
+        return;
+    }
 
 
     // Define storage for output parameters
@@ -478,13 +332,17 @@ static void Handle_allParameters
     // Re-use the message buffer for the response
     _msgBufPtr = _msgBufStartPtr;
 
+    // The fixed-size fields are at the start of the message
+    _Rsp_allParameters_t* _txFieldsPtr = (_Rsp_allParameters_t*)_msgBufPtr;
+    _msgBufPtr += LE_IPC_ALIGN_SIZE(sizeof(_Rsp_allParameters_t));
+
 
     // Pack any "out" parameters
-    _msgBufPtr = PackData( _msgBufPtr, &b, sizeof(uint32_t) );
-    _msgBufPtr = PackData( _msgBufPtr, &outputNumElements, sizeof(size_t) );
-    _msgBufPtr = PackData( _msgBufPtr, output, outputNumElements*sizeof(uint32_t) );
-    _msgBufPtr = PackString( _msgBufPtr, response );
-    _msgBufPtr = PackString( _msgBufPtr, more );
+    _txFieldsPtr->b = b;
+    _txFieldsPtr->outputNumElements = outputNumElements;
+    le_ipc_PackArray( &_msgBufPtr, _msgBufEndPtr, output, outputNumElements*sizeof(uint32_t) );
+    le_ipc_PackString( &_msgBufPtr, _msgBufEndPtr, response, 20 );
+    le_ipc_PackString( &_msgBufPtr, _msgBufEndPtr, more, 20 );
 
     // Return the response
     LE_DEBUG("Sending response to client session %p", le_msg_GetSession(_msgRef));
@@ -499,7 +357,8 @@ static void Handle_FileTest
 )
 {
     // Get the message buffer pointer
-    uint8_t* _msgBufPtr = ((_Message_t*)le_msg_GetPayloadPtr(_msgRef))->buffer;
+    __attribute__((unused)) uint8_t* _msgBufPtr = ((_Message_t*)le_msg_GetPayloadPtr(_msgRef))->buffer;
+    __attribute__((unused)) uint8_t* _msgBufEndPtr = _msgBufPtr + _MAX_MSG_SIZE;
 
     // Needed if we are returning a result or output values
     uint8_t* _msgBufStartPtr = _msgBufPtr;
@@ -536,7 +395,8 @@ static void Handle_TriggerTestA
 )
 {
     // Get the message buffer pointer
-    uint8_t* _msgBufPtr = ((_Message_t*)le_msg_GetPayloadPtr(_msgRef))->buffer;
+    __attribute__((unused)) uint8_t* _msgBufPtr = ((_Message_t*)le_msg_GetPayloadPtr(_msgRef))->buffer;
+    __attribute__((unused)) uint8_t* _msgBufEndPtr = _msgBufPtr + _MAX_MSG_SIZE;
 
     // Needed if we are returning a result or output values
     uint8_t* _msgBufStartPtr = _msgBufPtr;
@@ -565,6 +425,75 @@ static void Handle_TriggerTestA
 }
 
 
+static void Handle_AddToCounter
+(
+    le_msg_MessageRef_t _msgRef
+)
+{
+    // Get the message buffer pointer
+    __attribute__((unused)) uint8_t* _msgBufPtr = ((_Message_t*)le_msg_GetPayloadPtr(_msgRef))->buffer;
+    __attribute__((unused)) uint8_t* _msgBufEndPtr = _msgBufPtr + _MAX_MSG_SIZE;
+
+    // The fixed-size fields are at the start of the message
+    _Req_AddToCounter_t* _rxFieldsPtr = (_Req_AddToCounter_t*)_msgBufPtr;
+    _msgBufPtr += LE_IPC_ALIGN_SIZE(sizeof(_Req_AddToCounter_t));
+
+    // Unpack the input parameters from the message
+    uint32_t amount = _rxFieldsPtr->amount;
+
+    // Call the function
+    AddToCounter ( amount );
+
+    // The client doesn't wait for a response to a one-way function.
+    le_msg_ReleaseMsg(_msgRef);
+}
+
+
+static void Handle_GetCounter
+(
+    le_msg_MessageRef_t _msgRef
+
+)
+{
+    // Get the message buffer pointer
+    __attribute__((unused)) uint8_t* _msgBufPtr = ((_Message_t*)le_msg_GetPayloadPtr(_msgRef))->buffer;
+    __attribute__((unused)) uint8_t* _msgBufEndPtr = _msgBufPtr + _MAX_MSG_SIZE;
+
+    // Needed if we are returning a result or output values
+    uint8_t* _msgBufStartPtr = _msgBufPtr;
+
+    // Unpack the input parameters from the message
+
+
+
+    // Define storage for output parameters
+
+
+    // Call the function
+    uint32_t _result;
+    _result = GetCounter (  );
+
+
+
+    // Re-use the message buffer for the response
+    _msgBufPtr = _msgBufStartPtr;
+
+    // The fixed-size fields are at the start of the message
+    _Rsp_GetCounter_t* _txFieldsPtr = (_Rsp_GetCounter_t*)_msgBufPtr;
+    _msgBufPtr += LE_IPC_ALIGN_SIZE(sizeof(_Rsp_GetCounter_t));
+
+    // Pack the result first
+    _txFieldsPtr->_result = _result;
+
+    // Pack any "out" parameters
+
+
+    // Return the response
+    LE_DEBUG("Sending response to client session %p", le_msg_GetSession(_msgRef));
+    le_msg_Respond(_msgRef);
+}
+
+
 static void AsyncResponse_AddBugTest
 (
     void* contextPtr
@@ -572,25 +501,31 @@ static void AsyncResponse_AddBugTest
 {
     le_msg_MessageRef_t _msgRef;
     _Message_t* _msgPtr;
-    _ServerData_t* serverDataPtr = (_ServerData_t*)contextPtr;
+    le_ipc_ServerHandler_t* _serverHandlerPtr = contextPtr;
 
     // Will not be used if no data is sent back to client
     __attribute__((unused)) uint8_t* _msgBufPtr;
+    __attribute__((unused)) uint8_t* _msgBufEndPtr;
 
     // Create a new message object and get the message buffer
-    _msgRef = le_msg_CreateMsg(serverDataPtr->clientSessionRef);
+    _msgRef = le_msg_CreateMsg(_serverHandlerPtr->clientSessionRef);
     _msgPtr = le_msg_GetPayloadPtr(_msgRef);
     _msgPtr->id = _MSGID_AddBugTest;
     _msgBufPtr = _msgPtr->buffer;
+    _msgBufEndPtr = _msgPtr->buffer + _MAX_MSG_SIZE;
+
+    // The fixed-size fields are at the start of the message
+    _Ind_AddBugTest_t* _txFieldsPtr = (_Ind_AddBugTest_t*)_msgBufPtr;
+    _msgBufPtr += LE_IPC_ALIGN_SIZE(sizeof(_Ind_AddBugTest_t));
 
     // Always pack the client context pointer first
-    _msgBufPtr = PackData( _msgBufPtr, &(serverDataPtr->contextPtr), sizeof(void*) );
+    _txFieldsPtr->_clientContextPtr = _serverHandlerPtr->contextPtr;
 
     // Pack the input parameters
 
 
     // Send the async response to the client
-    LE_DEBUG("Sending message to client session %p", serverDataPtr->clientSessionRef);
+    LE_DEBUG("Sending message to client session %p", _serverHandlerPtr->clientSessionRef);
     le_msg_Send(_msgRef);
 }
 
@@ -602,25 +537,34 @@ static void Handle_AddBugTest
 )
 {
     // Get the message buffer pointer
-    uint8_t* _msgBufPtr = ((_Message_t*)le_msg_GetPayloadPtr(_msgRef))->buffer;
+    __attribute__((unused)) uint8_t* _msgBufPtr = ((_Message_t*)le_msg_GetPayloadPtr(_msgRef))->buffer;
+    __attribute__((unused)) uint8_t* _msgBufEndPtr = _msgBufPtr + _MAX_MSG_SIZE;
 
     // Needed if we are returning a result or output values
     uint8_t* _msgBufStartPtr = _msgBufPtr;
 
+    // The fixed-size fields are at the start of the message
+    _Req_AddBugTest_t* _rxFieldsPtr = (_Req_AddBugTest_t*)_msgBufPtr;
+    _msgBufPtr += LE_IPC_ALIGN_SIZE(sizeof(_Req_AddBugTest_t));
+
     // Unpack the input parameters from the message
-    const char* newPathPtr;
-    _msgBufPtr = UnpackString( _msgBufPtr, &newPathPtr );
+    const char* newPathPtr = le_ipc_UnpackString( &_msgBufPtr, _msgBufEndPtr, 512 );
 
 
 
-    void* contextPtr;
-    _msgBufPtr = UnpackData( _msgBufPtr, &contextPtr, sizeof(void*) );
+    void* contextPtr = _rxFieldsPtr->contextPtr;
 
-    // Create a new server data object and fill it in
-    _ServerData_t* serverDataPtr = le_mem_ForceAlloc(_ServerDataPool);
-    serverDataPtr->clientSessionRef = le_msg_GetSession(_msgRef);
-    serverDataPtr->contextPtr = contextPtr;
-    contextPtr = serverDataPtr;
+    // The client is dropped if anything in the message is not valid
+    if ( _msgBufPtr == NULL )
+    {
+        LE_KILL_CLIENT("Invalid message received from client");
+        le_msg_ReleaseMsg(_msgRef);
+        return;
+    }
+
+    // Create a new server handler object, which is passed to the function as the context pointer
+    le_ipc_ServerHandler_t* _serverHandlerPtr = le_ipc_NewServerHandler(_msgRef, contextPtr);
+    contextPtr = _serverHandlerPtr;
 
     // Define storage for output parameters
 
@@ -630,22 +574,23 @@ static void Handle_AddBugTest
     _result = AddBugTest ( newPathPtr, AsyncResponse_AddBugTest, contextPtr );
 
     // Put the handler reference result and a pointer to the associated remove function
-    // into the server data object.  This function pointer is needed in case the client
-    // is closed and the handlers need to be removed.
-    serverDataPtr->handlerRef = (le_event_HandlerRef_t)_result;
-    serverDataPtr->removeHandlerFunc = (RemoveHandlerFunc_t)RemoveBugTest;
-
-    // Return a safe reference to the server data object as the reference.
-    _LOCK
-    _result = le_ref_CreateRef(_HandlerRefMap, serverDataPtr);
-    _UNLOCK
+    // into the server handler object.  This function pointer is needed in case the client
+    // is closed and the handlers need to be removed.  A safe reference to the server handler
+    // object is returned as the reference.
+    _result = le_ipc_AddServerHandler(_serverHandlerPtr,
+                                      (le_event_HandlerRef_t)_result,
+                                      (le_ipc_RemoveHandlerFunc_t)RemoveBugTest);
 
 
     // Re-use the message buffer for the response
     _msgBufPtr = _msgBufStartPtr;
 
+    // The fixed-size fields are at the start of the message
+    _Rsp_AddBugTest_t* _txFieldsPtr = (_Rsp_AddBugTest_t*)_msgBufPtr;
+    _msgBufPtr += LE_IPC_ALIGN_SIZE(sizeof(_Rsp_AddBugTest_t));
+
     // Pack the result first
-    _msgBufPtr = PackData( _msgBufPtr, &_result, sizeof(_result) );
+    _txFieldsPtr->_result = _result;
 
     // Pack any "out" parameters
 
@@ -663,23 +608,27 @@ static void Handle_RemoveBugTest
 )
 {
     // Get the message buffer pointer
-    uint8_t* _msgBufPtr = ((_Message_t*)le_msg_GetPayloadPtr(_msgRef))->buffer;
+    __attribute__((unused)) uint8_t* _msgBufPtr = ((_Message_t*)le_msg_GetPayloadPtr(_msgRef))->buffer;
+    __attribute__((unused)) uint8_t* _msgBufEndPtr = _msgBufPtr + _MAX_MSG_SIZE;
 
     // Needed if we are returning a result or output values
     uint8_t* _msgBufStartPtr = _msgBufPtr;
 
+    // The fixed-size fields are at the start of the message
+    _Req_RemoveBugTest_t* _rxFieldsPtr = (_Req_RemoveBugTest_t*)_msgBufPtr;
+    _msgBufPtr += LE_IPC_ALIGN_SIZE(sizeof(_Req_RemoveBugTest_t));
+
     // Unpack the input parameters from the message
-    BugTestRef_t addHandlerRef;
-    _msgBufPtr = UnpackData( _msgBufPtr, &addHandlerRef, sizeof(BugTestRef_t) );
-    // The passed in handlerRef is a safe reference for the server data object.  Need to get the
-    // real handlerRef from the server data object and then delete both the safe reference and
-    // the object since they are no longer needed.
-    _LOCK
-    _ServerData_t* serverDataPtr = le_ref_Lookup(_HandlerRefMap, addHandlerRef);
-    le_ref_DeleteRef(_HandlerRefMap, addHandlerRef);
-    _UNLOCK
-    addHandlerRef = (BugTestRef_t)serverDataPtr->handlerRef;
-    le_mem_Release(serverDataPtr);
+    BugTestRef_t addHandlerRef = _rxFieldsPtr->addHandlerRef;
+    // The passed in handlerRef is a safe reference for the server handler object.  Need to get the
+    // real handlerRef from the server handler object, which is then deleted, since it is no longer
+    // needed.  The client is dropped if the reference is not valid or is not its own.
+    addHandlerRef = (BugTestRef_t)le_ipc_RemoveServerHandler(_msgRef, addHandlerRef);
+    if ( addHandlerRef == NULL )
+    {
+        le_msg_ReleaseMsg(_msgRef);
+        return;
+    }
 
 
     // Define storage for output parameters
@@ -702,36 +651,87 @@ static void Handle_RemoveBugTest
 }
 
 
-static void ServerMsgRecvHandler
+//--------------------------------------------------------------------------------------------------
+// Generic Server Types, Variables and Functions
+//--------------------------------------------------------------------------------------------------
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * The server function for each message ID.  The IPC runtime (see le_ipc.h) dispatches the requests
+ * from clients through this table.
+ */
+//--------------------------------------------------------------------------------------------------
+static const le_ipc_ServerFunc_t _ServerFuncs[] =
+{
+    [_MSGID_AddTestA] = { "AddTestA", Handle_AddTestA },
+    [_MSGID_RemoveTestA] = { "RemoveTestA", Handle_RemoveTestA },
+    [_MSGID_allParameters] = { "allParameters", Handle_allParameters },
+    [_MSGID_FileTest] = { "FileTest", Handle_FileTest },
+    [_MSGID_TriggerTestA] = { "TriggerTestA", Handle_TriggerTestA },
+    [_MSGID_AddToCounter] = { "AddToCounter", Handle_AddToCounter },
+    [_MSGID_GetCounter] = { "GetCounter", Handle_GetCounter },
+    [_MSGID_AddBugTest] = { "AddBugTest", Handle_AddBugTest },
+    [_MSGID_RemoveBugTest] = { "RemoveBugTest", Handle_RemoveBugTest },
+};
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of calls to each server function, and the time spent in them (see "inspect ipc").
+ */
+//--------------------------------------------------------------------------------------------------
+static le_ipc_ServerFuncStats_t _ServerFuncStats[NUM_ARRAY_MEMBERS(_ServerFuncs)];
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * The server side of the interface.  The IPC runtime keeps the handlers that clients have
+ * registered, and removes them when the clients' sessions close.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_ipc_Server_t _Server =
+    LE_IPC_SERVER_INIT(PROTOCOL_ID_STR, SERVICE_INSTANCE_NAME, sizeof(_Message_t),
+                       _ServerFuncs, _ServerFuncStats);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the server service reference
+ */
+//--------------------------------------------------------------------------------------------------
+le_msg_ServiceRef_t GetServiceRef
 (
-    le_msg_MessageRef_t msgRef,
-    void*               contextPtr
+    void
 )
 {
-    // Get the message payload so that we can get the message "id"
-    _Message_t* msgPtr = le_msg_GetPayloadPtr(msgRef);
+    return _Server.serviceRef;
+}
 
-    // Get the client session ref for the current message.  This ref is used by the server to
-    // get info about the client process, such as user id.  If there are multiple clients, then
-    // the session ref may be different for each message, hence it has to be queried each time.
-    _ClientSessionRef = le_msg_GetSession(msgRef);
 
-    // Dispatch to appropriate message handler and get response
-    switch (msgPtr->id)
-    {
-        case _MSGID_AddTestA : Handle_AddTestA(msgRef); break;
-        case _MSGID_RemoveTestA : Handle_RemoveTestA(msgRef); break;
-        case _MSGID_allParameters : Handle_allParameters(msgRef); break;
-        case _MSGID_FileTest : Handle_FileTest(msgRef); break;
-        case _MSGID_TriggerTestA : Handle_TriggerTestA(msgRef); break;
-        case _MSGID_AddBugTest : Handle_AddBugTest(msgRef); break;
-        case _MSGID_RemoveBugTest : Handle_RemoveBugTest(msgRef); break;
-
-        default: LE_ERROR("Unknowm msg id = %i", msgPtr->id);
-    }
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the client session reference for the current message
+ */
+//--------------------------------------------------------------------------------------------------
+le_msg_SessionRef_t GetClientSessionRef
+(
+    void
+)
+{
+    return _Server.clientSessionRef;
+}
+
 
-    // Clear the client session ref associated with the current message, since the message
-    // has now been processed.
-    _ClientSessionRef = 0;
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initialize the server and advertise the service.
+ */
+//--------------------------------------------------------------------------------------------------
+void AdvertiseService
+(
+    void
+)
+{
+    le_ipc_AdvertiseService(&_Server);
 }
 
@@ -235,6 +235,27 @@ void TriggerTestA
     void
 );
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Adds to a counter on the server.  The client doesn't wait for the server to do it.
+ */
+//--------------------------------------------------------------------------------------------------
+void AddToCounter
+(
+    uint32_t amount
+        ///< [IN]
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the counter, which includes the amounts from all the earlier calls to AddToCounter().
+ */
+//--------------------------------------------------------------------------------------------------
+uint32_t GetCounter
+(
+    void
+);
+
 //--------------------------------------------------------------------------------------------------
 /**
  * BugTest handler ADD function
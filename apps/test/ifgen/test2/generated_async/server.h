@@ -238,6 +238,38 @@ void TriggerTestA
     ServerCmdRef_t _cmdRef
 );
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Adds to a counter on the server.  The client doesn't wait for the server to do it.
+ */
+//--------------------------------------------------------------------------------------------------
+void AddToCounter
+(
+    uint32_t amount
+        ///< [IN]
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Server-side respond function for GetCounter
+ */
+//--------------------------------------------------------------------------------------------------
+void GetCounterRespond
+(
+    ServerCmdRef_t _cmdRef,
+    uint32_t _result
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Prototype for server-side async interface function
+ */
+//--------------------------------------------------------------------------------------------------
+void GetCounter
+(
+    ServerCmdRef_t _cmdRef
+);
+
 //--------------------------------------------------------------------------------------------------
 /**
  * BugTest handler ADD function
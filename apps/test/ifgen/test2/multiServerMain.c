@@ -125,6 +125,26 @@ void TriggerTestA
 }
 
 
+static uint32_t Counter = 0;
+
+void AddToCounter
+(
+    uint32_t amount
+)
+{
+    Counter += amount;
+}
+
+uint32_t GetCounter
+(
+    void
+)
+{
+    LE_PRINT_VALUE("%u", Counter);
+    return Counter;
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Add these two functions to satisfy the compiler, but don't need to do
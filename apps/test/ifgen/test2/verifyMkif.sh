@@ -0,0 +1,25 @@
+#
+# Simple script to verify that mkif generates the same code as ifgen did for the golden files.
+#
+# Usage: verifyMkif.sh <dir>
+#
+# where <dir> is the output directory, whose generated, generated_async and generated_nested
+# subdirectories are then compared against the ones here.
+#
+
+destdir=$1
+
+mkif common.api --gen-interface --gen-server-interface --output-dir $destdir/generated
+mkif example.api --gen-all --no-default-prefix --pipelined-client --output-dir $destdir/generated
+
+mkif common.api --gen-interface --gen-server-interface --output-dir $destdir/generated_async
+mkif example.api --gen-all --no-default-prefix --async-server --output-dir $destdir/generated_async
+
+mkif nested.api --gen-interface --output-dir $destdir/generated_nested
+mkif nested2.api --gen-interface --output-dir $destdir/generated_nested
+mkif nested3.api --gen-interface --output-dir $destdir/generated_nested
+mkif nested4.api --gen-interface --output-dir $destdir/generated_nested
+
+diff -r generated $destdir/generated &&
+diff -r generated_async $destdir/generated_async &&
+diff -r generated_nested $destdir/generated_nested
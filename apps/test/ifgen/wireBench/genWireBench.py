@@ -0,0 +1,412 @@
+#!/usr/bin/python2.7 -E
+#
+# Generates the code for the IPC message serialization benchmark (see wireBench.c).
+#
+# For each .api file found under the given directories, the interface and local header files are
+# generated as ifgen would generate them, along with a <name>_wireBench.c file.  That file has, for
+# each function in the .api file, a benchmark function that does everything the generated client
+# and server code do to a message, but without sending it anywhere: the client packs the request,
+# the server unpacks it and packs the response, and then the client unpacks the response.  The
+# packing and unpacking code comes from the same templates that ifgen uses for the real thing.
+#
+# Also generates wireBenchTable.c, which lists the benchmark functions of all the .api files.
+#
+# Usage: genWireBench.py --ifgen-dir <dir> --output-dir <dir> <dir or .api file> ...
+#
+# Copyright (C) Sierra Wireless, Inc. 2014. Use of this work is subject to license.
+#
+
+import os
+import sys
+import argparse
+import collections
+
+
+def GetArguments():
+    parser = argparse.ArgumentParser(description='Generate the IPC serialization benchmark')
+
+    parser.add_argument('apiPaths',
+                        metavar='PATH',
+                        nargs='+',
+                        help='.api file, or directory to search for .api files')
+
+    parser.add_argument('--ifgen-dir',
+                        dest='ifgenDir',
+                        default=os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                                             '../../../../framework/tools/ifgen'),
+                        help='directory holding the ifgen modules')
+
+    parser.add_argument('--output-dir',
+                        dest='outputDir',
+                        default='',
+                        help='output directory for the generated files')
+
+    return parser.parse_args()
+
+
+# The ifgen modules are loaded from the directory given on the command line, after it is parsed.
+codeTypes = None
+interfaceParser = None
+codeGen = None
+InitialInterfaceTypes = None
+
+def LoadIfgen(ifgenDir):
+    global codeTypes, interfaceParser, codeGen, InitialInterfaceTypes
+
+    sys.path.insert(0, os.path.abspath(ifgenDir))
+
+    import codeTypes
+    import interfaceParser
+    import codeGen
+
+    InitialInterfaceTypes = dict(codeTypes.DefinedInterfaceTypes)
+
+
+#---------------------------------------------------------------------------------------------------
+# Parsing
+#---------------------------------------------------------------------------------------------------
+
+def FindApiFiles(apiPaths):
+    apiFiles = []
+
+    for path in apiPaths:
+        if os.path.isfile(path):
+            apiFiles.append(path)
+            continue
+
+        for dirPath, dirNames, fileNames in os.walk(path):
+            dirNames.sort()
+            apiFiles.extend( os.path.join(dirPath, f) for f in sorted(fileNames)
+                             if f.endswith('.api') )
+
+    return apiFiles
+
+
+def GetImportPaths(data, importDirs):
+    importPaths = []
+
+    for name in interfaceParser.GetImportList(data):
+        for d in importDirs:
+            path = os.path.join(d, name+'.api')
+            if os.path.isfile(path):
+                break
+        else:
+            sys.stderr.write("ERROR: '%s.api' not found in %s\n" % (name, importDirs))
+            sys.exit(1)
+
+        # Nested imports are processed first, and each file is only processed once.
+        importPaths = GetImportPaths(open(path, 'r').read(), importDirs) + importPaths + [ path ]
+
+    return list( collections.OrderedDict.fromkeys(importPaths) )
+
+
+# Parse an .api file the way ifgen does, with the default name prefix.
+def ParseApi(path, importDirs):
+    codeTypes.DefinedInterfaceTypes = dict(InitialInterfaceTypes)
+    codeTypes.DefinedValues = dict()
+
+    data = open(path, 'r').read()
+    importedCodeList = []
+
+    for importPath in GetImportPaths(data, importDirs):
+        name = os.path.splitext( os.path.basename(importPath) )[0]
+        codeTypes.SetImportName(name)
+        codeTypes.SetNamePrefix(name)
+        importedCodeList += interfaceParser.ParseCode(open(importPath, 'r').read(),
+                                                      importPath)['codeList']
+
+    codeTypes.SetNamePrefix( os.path.splitext( os.path.basename(path) )[0] )
+    codeTypes.SetImportName("")
+
+    parsedData = interfaceParser.ParseCode(data, path)
+    hashValue = codeTypes.GetHash(importedCodeList + parsedData['codeList'])
+
+    return parsedData, hashValue
+
+
+class HeaderArgs(object):
+    """
+    Command line arguments for codeGen.WriteAllCode(), to generate the interface and local headers.
+    """
+    def __init__(self, path, outputDir):
+        self.interfaceFile = path
+        self.filePrefix = os.path.splitext( os.path.basename(path) )[0]
+        self.serviceName = self.filePrefix
+        self.outputDir = outputDir
+        self.genInterface = True
+        self.genLocal = True
+        self.genClient = False
+        self.genServerInterface = False
+        self.genServer = False
+
+
+#---------------------------------------------------------------------------------------------------
+# Benchmark code
+#---------------------------------------------------------------------------------------------------
+
+# Add handler functions are not benchmarked, since their messages hold handler references that only
+# mean something in a real session, and neither are functions that send file descriptors.
+def IsBenchmarked(func):
+    if type(func) is not codeTypes.FunctionData:
+        return False
+
+    return not any( isinstance(p, (codeTypes.FileInData, codeTypes.FileOutData,
+                                   codeTypes.HandlerParmData))
+                    for p in func.parmList )
+
+
+# Declare and initialize the client's arguments: IN strings and arrays are as big as they can be,
+# and OUT strings and arrays are the minimum size that the server must accept.
+def GetClientArgs(func):
+    sizes = dict()
+    for p in func.parmList:
+        if isinstance(p, codeTypes.StringData) and p.direction == codeTypes.DIR_OUT:
+            sizes[p.sizeVar] = p.minSize
+        elif isinstance(p, codeTypes.ArrayData):
+            sizes[p.sizeVar] = p.maxSize if p.direction == codeTypes.DIR_IN else p.minSize
+
+    lines = []
+    for p in func.parmList:
+        if isinstance(p, codeTypes.VoidData):
+            continue
+        elif p.name in sizes:
+            if isinstance(p, codeTypes.PointerData):
+                lines.append( "size_t %s = %s;" % (p.name, sizes[p.name]) )
+                lines.append( "size_t* %s = &%s;" % (p.parmName, p.name) )
+            else:
+                lines.append( "size_t %s = %s;" % (p.parmName, sizes[p.name]) )
+        elif isinstance(p, codeTypes.StringData):
+            if p.direction == codeTypes.DIR_IN:
+                # Split long strings into several literals, to keep the lines short.
+                chunks = [ '"%s"' % ('x' * min(64, p.maxValue - i))
+                           for i in range(0, p.maxValue, 64) ] or [ '""' ]
+                lines.append( "%s %s = %s;" % (p.parmType, p.parmName,
+                                               "\n    ".join(chunks)) )
+            else:
+                lines.append( "char %s[%s];" % (p.parmName, p.minSize) )
+        elif isinstance(p, codeTypes.ArrayData):
+            if p.direction == codeTypes.DIR_IN:
+                lines.append( "static %s %s[%s];" % (p.type, p.name, p.maxSize) )
+            else:
+                lines.append( "%s %s[%s];" % (p.type, p.name, p.minSize) )
+            lines.append( "%s %s = %s;" % (p.parmType, p.parmName, p.name) )
+        elif isinstance(p, codeTypes.PointerData):
+            lines.append( "%s %s;" % (p.type, p.name) )
+            lines.append( "%s %s = &%s;" % (p.parmType, p.parmName, p.name) )
+        else:
+            lines.append( "%s %s;" % (p.parmType, p.parmName) )
+            lines.append( "memset(&%s, 0, sizeof(%s));" % (p.parmName, p.parmName) )
+
+    return "\n".join(lines)
+
+
+# Fill in the server's OUT strings and arrays, using all the space the client gave.
+def GetServerOutputs(func):
+    lines = []
+    for p in func.parmListOut:
+        if isinstance(p, codeTypes.StringData):
+            lines.append( "memset(%s, 'x', %s - 1);" % (p.name, p.sizeVar) )
+            lines.append( "%s[%s - 1] = '\\0';" % (p.name, p.sizeVar) )
+        elif isinstance(p, codeTypes.ArrayData):
+            lines.append( "memset(%s, 0, %s);" % (p.name, p.numBytes) )
+
+    return "\n".join(lines)
+
+
+BenchFuncTemplate = """
+static void Bench_{{func.name}}
+(
+    void
+)
+{
+    {{ clientArgs | indent }}
+    {{func.resultStorage}}
+
+    __attribute__((unused)) uint8_t* _msgBufPtr;
+    __attribute__((unused)) uint8_t* _msgBufEndPtr = Message.buffer + _MAX_MSG_SIZE;
+
+    // Client: range check and pack the request
+    $ for p in func.parmListIn
+    $ if p.maxValue and p.maxValueCheck
+    {{ p.maxValueCheck.format(parm=p) }}
+    $ endif
+    $ endfor
+    _msgBufPtr = Message.buffer;
+    $ if request.typeName
+    {{request.typeName}}* _txFieldsPtr = ({{request.typeName}}*)_msgBufPtr;
+    _msgBufPtr += LE_IPC_ALIGN_SIZE(sizeof({{request.typeName}}));
+    $ endif
+    {{ func.parmListIn | printParmList("clientPack", sep="\n") | indent }}
+
+    // Server: unpack the request, "call" the function, and pack the response
+    {
+        _msgBufPtr = Message.buffer;
+        $ if request.typeName
+        {{request.typeName}}* _rxFieldsPtr = ({{request.typeName}}*)_msgBufPtr;
+        _msgBufPtr += LE_IPC_ALIGN_SIZE(sizeof({{request.typeName}}));
+        $ endif
+        {{ func.parmListIn | printParmList("handlerUnpack", sep="\n") | indent(8) }}
+        $ if request.hasData
+        LE_FATAL_IF(_msgBufPtr == NULL, "Invalid request");
+        $ endif
+        $ if func.parmListOut
+        {{ func.parmListOut | printParmList("handlerParmList", sep="\n") | indent(8) }}
+        {{ serverOutputs | indent(8) }}
+        $ endif
+        $ if func.type != "void"
+        {{func.type}} _result;
+        memset(&_result, 0, sizeof(_result));
+        $ endif
+        WireBench_Call(0{{serverCallArgs}});
+
+        _msgBufPtr = Message.buffer;
+        $ if response.typeName
+        {{response.typeName}}* _txFieldsPtr = ({{response.typeName}}*)_msgBufPtr;
+        _msgBufPtr += LE_IPC_ALIGN_SIZE(sizeof({{response.typeName}}));
+        $ endif
+        $ if func.type != "void"
+        _txFieldsPtr->_result = _result;
+        $ endif
+        {{ func.parmListOut | printParmList("handlerPack", sep="\n") | indent(8) }}
+    }
+
+    // Client: unpack the response
+    _msgBufPtr = Message.buffer;
+    $ if response.typeName
+    {{response.typeName}}* _rxFieldsPtr = ({{response.typeName}}*)_msgBufPtr;
+    _msgBufPtr += LE_IPC_ALIGN_SIZE(sizeof({{response.typeName}}));
+    $ endif
+    $ if func.type != "void"
+    _result = _rxFieldsPtr->_result;
+    $ endif
+    {{ func.parmListOut | printParmList("clientUnpack", sep="\n") | indent }}
+    $ if response.hasData
+    LE_FATAL_IF(_msgBufPtr == NULL, "Invalid response");
+    $ endif
+    WireBench_Call(0{{clientCallArgs}});
+}
+"""
+
+
+BenchFileTemplate = """\
+/*
+ * ====================== WARNING ======================
+ *
+ * THIS FILE IS AUTOMATICALLY GENERATED BY genWireBench.py.
+ * DO NOT MODIFY IT BY HAND.
+ */
+
+#include "legato.h"
+#include "{{name}}_interface.h"
+#include "{{name}}_local.h"
+#include "wireBench.h"
+
+{{ layouts }}
+
+{% if benchFuncs %}
+// All the messages are built in this buffer.
+static _Message_t Message;
+{% endif %}
+{% for code in benchFuncs %}
+{{ code }}
+
+{% endfor %}
+
+const WireBench_Func_t {{name}}_WireBenchFuncs[] =
+{
+{% for func in funcs %}
+    { "{{func.name}}", Bench_{{func.name}} },
+{% endfor %}
+    { NULL, NULL }
+};
+"""
+
+
+TableFileTemplate = """\
+/*
+ * ====================== WARNING ======================
+ *
+ * THIS FILE IS AUTOMATICALLY GENERATED BY genWireBench.py.
+ * DO NOT MODIFY IT BY HAND.
+ */
+
+#include "legato.h"
+#include "wireBench.h"
+
+{% for name in names %}
+extern const WireBench_Func_t {{name}}_WireBenchFuncs[];
+{% endfor %}
+
+const WireBench_Api_t WireBench_Apis[] =
+{
+{% for name in names %}
+    { "{{name}}", {{name}}_WireBenchFuncs },
+{% endfor %}
+    { NULL, NULL }
+};
+"""
+
+
+def GetCallArgs(parmList, attribute):
+    args = codeGen.PrintParmList(parmList, attribute, sep=", ")
+    return ", " + args if args else ""
+
+
+def GetBenchFuncCode(func):
+    request, response = codeGen.GetMessageLayouts(func)[:2]
+
+    return codeGen.FormatCode(BenchFuncTemplate,
+                              func=func,
+                              request=request,
+                              response=response,
+                              clientArgs=GetClientArgs(func),
+                              serverOutputs=GetServerOutputs(func),
+                              serverCallArgs=GetCallArgs(func.parmList, "unpackCallName"),
+                              clientCallArgs=GetCallArgs(func.parmList, "parmName")
+                                             + (", _result" if func.type != "void" else ""))
+
+
+def WriteBenchFile(path, parsedData, outputDir):
+    name = os.path.splitext( os.path.basename(path) )[0]
+
+    funcs = collections.OrderedDict( (f.name, f) for f in parsedData['codeList']
+                                     if IsBenchmarked(f) )
+
+    layouts = codeGen.FormatCode(codeGen.MessageLayoutTemplate,
+                                 layouts=codeGen.GetAllMessageLayouts(funcs, {}))
+
+    code = codeGen.FormatCode(BenchFileTemplate,
+                              name=name,
+                              layouts=layouts,
+                              funcs=list(funcs.values()),
+                              benchFuncs=[ GetBenchFuncCode(f) for f in funcs.values() ])
+
+    open(os.path.join(outputDir, name+'_wireBench.c'), 'w').write(code)
+
+
+def Main():
+    args = GetArguments()
+    LoadIfgen(args.ifgenDir)
+
+    if args.outputDir and not os.path.exists(args.outputDir):
+        os.makedirs(args.outputDir)
+
+    apiFiles = FindApiFiles(args.apiPaths)
+
+    # Imports are looked for in all the directories that hold .api files.
+    importDirs = list( collections.OrderedDict.fromkeys( os.path.dirname(os.path.abspath(p))
+                                                         for p in apiFiles ) )
+
+    for path in apiFiles:
+        parsedData, hashValue = ParseApi(path, importDirs)
+
+        codeGen.WriteAllCode(HeaderArgs(path, args.outputDir), parsedData, hashValue)
+        WriteBenchFile(path, parsedData, args.outputDir)
+
+    names = [ os.path.splitext( os.path.basename(p) )[0] for p in apiFiles ]
+    open(os.path.join(args.outputDir, 'wireBenchTable.c'), 'w').write(
+        codeGen.FormatCode(TableFileTemplate, names=names) )
+
+
+if __name__ == '__main__':
+    Main()
@@ -0,0 +1,141 @@
+// -------------------------------------------------------------------------------------------------
+// IPC message serialization benchmark.
+//
+// Measures the cost of packing and unpacking the messages of every function in the .api files in
+// the interfaces directory, using the code that ifgen generates for them.  Each iteration of a
+// function's benchmark does what the client and server do to the messages of one call: the client
+// packs the request, the server unpacks it and packs the response, and the client unpacks the
+// response.  No messages are actually sent, so this measures only the serialization.
+//
+// Strings and arrays sent by the client are as big as the .api file allows, and those sent back by
+// the server fill the buffers that the client must provide, so these are worst-case messages.
+//
+// The number of iterations per function can be passed as the first command-line argument.
+//
+// Copyright (C) 2014, Sierra Wireless Inc.
+// -------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "wireBench.h"
+
+/// Default number of iterations per function.
+#define DEFAULT_ITERATIONS  100000
+
+static size_t Iterations = DEFAULT_ITERATIONS;
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ * Get the number of nanoseconds elapsed since a given start time.
+ */
+// -------------------------------------------------------------------------------------------------
+static uint64_t NsSince
+(
+    le_clk_Time_t startTime
+)
+// -------------------------------------------------------------------------------------------------
+{
+    le_clk_Time_t elapsed = le_clk_Sub(le_clk_GetRelativeTime(), startTime);
+
+    return ((uint64_t)elapsed.sec * 1000000000ULL) + ((uint64_t)elapsed.usec * 1000ULL);
+}
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ * Does nothing.  See wireBench.h.
+ */
+// -------------------------------------------------------------------------------------------------
+void WireBench_Call
+(
+    int unused,
+    ...
+)
+// -------------------------------------------------------------------------------------------------
+{
+}
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ * Run the benchmark for all the functions of one .api file.
+ *
+ * @return The total number of nanoseconds taken by one iteration of every function.
+ */
+// -------------------------------------------------------------------------------------------------
+static double RunApi
+(
+    const WireBench_Api_t* apiPtr,
+    size_t* numFuncsPtr     ///< [out] Incremented by the number of functions.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    const WireBench_Func_t* funcPtr;
+    double totalNs = 0;
+    size_t numFuncs = 0;
+
+    for (funcPtr = apiPtr->funcs; funcPtr->name != NULL; funcPtr++)
+    {
+        size_t i;
+        le_clk_Time_t startTime = le_clk_GetRelativeTime();
+
+        for (i = 0; i < Iterations; i++)
+        {
+            funcPtr->func();
+        }
+
+        double ns = (double)NsSince(startTime) / Iterations;
+
+        LE_DEBUG("%-48s %8.1f ns/call", funcPtr->name, ns);
+
+        totalNs += ns;
+        numFuncs++;
+    }
+
+    if (numFuncs > 0)
+    {
+        LE_INFO("%-20s %3zu functions: %8.1f ns/call on average",
+                apiPtr->name,
+                numFuncs,
+                totalNs / numFuncs);
+    }
+
+    *numFuncsPtr += numFuncs;
+
+    return totalNs;
+}
+
+
+// -------------------------------------------------------------------------------------------------
+// -------------------------------------------------------------------------------------------------
+COMPONENT_INIT
+{
+    char arg[32];
+    const WireBench_Api_t* apiPtr;
+    double totalNs = 0;
+    size_t numFuncs = 0;
+
+    if ((le_arg_NumArgs() > 0) && (le_arg_GetArg(0, arg, sizeof(arg)) == LE_OK))
+    {
+        Iterations = strtoul(arg, NULL, 0);
+        LE_FATAL_IF(Iterations == 0, "Invalid iteration count '%s'.", arg);
+    }
+
+    LE_INFO("======== BEGIN IPC SERIALIZATION BENCHMARK ========");
+
+    for (apiPtr = WireBench_Apis; apiPtr->name != NULL; apiPtr++)
+    {
+        totalNs += RunApi(apiPtr, &numFuncs);
+    }
+
+    LE_FATAL_IF(numFuncs == 0, "No functions to benchmark.");
+
+    LE_INFO("All %zu functions, %zu iterations each: %.1f ns/call on average, %.1f us in total",
+            numFuncs,
+            Iterations,
+            totalNs / numFuncs,
+            totalNs / 1000);
+
+    LE_INFO("======== IPC SERIALIZATION BENCHMARK PASSED ========");
+    exit(EXIT_SUCCESS);
+}
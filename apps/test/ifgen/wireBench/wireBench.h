@@ -0,0 +1,55 @@
+// -------------------------------------------------------------------------------------------------
+// Header file for the IPC message serialization benchmark.  The benchmark functions and the table
+// that lists them are generated by genWireBench.py.
+//
+// Copyright (C) 2014, Sierra Wireless Inc.
+// -------------------------------------------------------------------------------------------------
+
+#ifndef LE_WIRE_BENCH_H_INCLUSION_GUARD
+#define LE_WIRE_BENCH_H_INCLUSION_GUARD
+
+// -------------------------------------------------------------------------------------------------
+/**
+ * A benchmark function, which does one request/response round trip for one API function.
+ */
+// -------------------------------------------------------------------------------------------------
+typedef struct
+{
+    const char* name;       ///< Name of the API function.
+    void (*func)(void);     ///< Benchmark function.
+}
+WireBench_Func_t;
+
+// -------------------------------------------------------------------------------------------------
+/**
+ * The benchmark functions for one .api file.
+ */
+// -------------------------------------------------------------------------------------------------
+typedef struct
+{
+    const char* name;               ///< Name of the .api file, without the extension.
+    const WireBench_Func_t* funcs;  ///< Benchmark functions, ending with one whose name is NULL.
+}
+WireBench_Api_t;
+
+// -------------------------------------------------------------------------------------------------
+/**
+ * All the .api files, ending with one whose name is NULL.
+ */
+// -------------------------------------------------------------------------------------------------
+extern const WireBench_Api_t WireBench_Apis[];
+
+// -------------------------------------------------------------------------------------------------
+/**
+ * Stands in for the call to the server function, and for the client's use of the results.  It does
+ * nothing, but since it is in a different file, the compiler can't tell that the unpacked values
+ * aren't needed.
+ */
+// -------------------------------------------------------------------------------------------------
+void WireBench_Call
+(
+    int unused,
+    ...
+);
+
+#endif // LE_WIRE_BENCH_H_INCLUSION_GUARD
@@ -0,0 +1,1204 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * Implementation of the classes that represent the contents of a parsed .api file.
+ *
+ * Copyright (C) Sierra Wireless, Inc. 2014.  Use of this work is subject to license.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "LegatoObjectModel.h"
+
+
+namespace legato
+{
+
+namespace api
+{
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Default parameter code templates.  Any of these can be overridden for a particular parameter
+ * by setting the attribute of the same name.
+ **/
+//--------------------------------------------------------------------------------------------------
+static const std::map<std::string, std::string> DefaultTemplates =
+{
+    // Member of the struct that holds the fixed-size fields at the start of each message.
+    // Strings, arrays and file descriptors are not in the struct, so they don't have one.
+    { "fieldDefinition", "{parm.type} {parm.name};" },
+
+    // Fields are read and written in place, through _txFieldsPtr in the message being sent, and
+    // _rxFieldsPtr in the message that was received.
+    { "clientParmList", "{parm.parmType} {parm.parmName}" },
+    { "clientPack", "_txFieldsPtr->{parm.name} = {parm.value};" },
+    { "clientUnpack", "{parm.value} = _rxFieldsPtr->{parm.name};" },
+    { "handlerParmList", "{parm.unpackType} {parm.unpackName};" },
+    { "handlerUnpack", "{parm.unpackType} {parm.unpackName} = _rxFieldsPtr->{parm.name};" },
+    { "handlerPack", "_txFieldsPtr->{parm.name} = {parm.name};" },
+    { "asyncServerParmList", "{parm.asyncServerParmType} {parm.asyncServerParmName}" },
+    { "asyncServerPack", "_txFieldsPtr->{parm.name} = {parm.name};" },
+
+    // Ensure that the array/string length is not greater than the maximum from the API
+    // definition.  This only applies to IN arrays/strings, because only they have a maxValue.
+    { "maxValueCheck",
+      "if ( {parm.value} > {parm.maxValue} ) LE_FATAL(\"{parm.value} > {parm.maxValue}\");" },
+};
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Code templates that are different for all OUT file descriptor parameters.
+ **/
+//--------------------------------------------------------------------------------------------------
+static const std::map<std::string, std::string> FileOutTemplates =
+{
+    // The file descriptor is sent with the message, rather than in it.
+    { "fieldDefinition", "" },
+    { "clientUnpack", "{parm.value} = le_msg_GetFd(_responseMsgRef);" },
+    { "handlerPack", "le_msg_SetFd(_msgRef, {parm.name});" },
+    { "asyncServerPack", "le_msg_SetFd(_msgRef, {parm.name});\n" },
+};
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * @return The name with the given prefix and an underscore added to the front, or the name
+ *         alone if the prefix is empty.
+ **/
+//--------------------------------------------------------------------------------------------------
+std::string AddNamePrefix
+(
+    const std::string& namePrefix,
+    const std::string& name
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (namePrefix.empty())
+    {
+        return name;
+    }
+
+    return namePrefix + "_" + name;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * @return A copy of a string with all lower-case ASCII letters converted to upper-case.
+ **/
+//--------------------------------------------------------------------------------------------------
+static std::string ToUpper
+(
+    const std::string& text
+)
+//--------------------------------------------------------------------------------------------------
+{
+    std::string result = text;
+
+    for (auto& c : result)
+    {
+        if ((c >= 'a') && (c <= 'z'))
+        {
+            c = c - 'a' + 'A';
+        }
+    }
+
+    return result;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Constructor
+ **/
+//--------------------------------------------------------------------------------------------------
+Parameter_t::Parameter_t
+(
+    Kind_t kind,
+    const std::string& name,
+    const std::string& type,
+    const std::string& direction
+)
+//--------------------------------------------------------------------------------------------------
+:   kind(kind),
+    name(name),
+    type(type),
+    direction(direction)
+//--------------------------------------------------------------------------------------------------
+{
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set the value of an attribute, overriding the default value.
+ **/
+//--------------------------------------------------------------------------------------------------
+void Parameter_t::Set
+(
+    const std::string& attribute,
+    const std::string& value
+)
+//--------------------------------------------------------------------------------------------------
+{
+    m_Attributes[attribute] = value;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * @return true if the attribute has been explicitly set.
+ **/
+//--------------------------------------------------------------------------------------------------
+bool Parameter_t::Has
+(
+    const std::string& attribute
+)
+const
+//--------------------------------------------------------------------------------------------------
+{
+    return (m_Attributes.find(attribute) != m_Attributes.end());
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * @return true if the attribute has been set to a value that isn't empty or zero.
+ **/
+//--------------------------------------------------------------------------------------------------
+bool Parameter_t::IsTrue
+(
+    const std::string& attribute
+)
+const
+//--------------------------------------------------------------------------------------------------
+{
+    auto i = m_Attributes.find(attribute);
+
+    return (i != m_Attributes.end()) && !i->second.empty() && (i->second != "0");
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the value of an attribute, which is either the explicitly set value, or else the default.
+ *
+ * @return The value.
+ *
+ * @throw legato::Exception if the attribute has no value.
+ **/
+//--------------------------------------------------------------------------------------------------
+std::string Parameter_t::Get
+(
+    const std::string& attribute
+)
+const
+//--------------------------------------------------------------------------------------------------
+{
+    auto i = m_Attributes.find(attribute);
+    if (i != m_Attributes.end())
+    {
+        return i->second;
+    }
+
+    if (kind == FILE_OUT)
+    {
+        i = FileOutTemplates.find(attribute);
+        if (i != FileOutTemplates.end())
+        {
+            return i->second;
+        }
+    }
+
+    i = DefaultTemplates.find(attribute);
+    if (i != DefaultTemplates.end())
+    {
+        return i->second;
+    }
+
+    if (   (attribute == "parmName")
+        || (attribute == "value")
+        || (attribute == "unpackName")
+        || (attribute == "unpackCallName")
+        || (attribute == "asyncServerCallName") )
+    {
+        return name;
+    }
+    if ((attribute == "parmType") || (attribute == "unpackType"))
+    {
+        return type;
+    }
+    if (attribute == "numBytes")
+    {
+        return "sizeof(" + type + ")";
+    }
+    if (attribute == "address")
+    {
+        return "&" + name;
+    }
+    if (attribute == "unpackAddr")
+    {
+        return Get("address");
+    }
+    if (attribute == "asyncServerParmName")
+    {
+        return Get("parmName");
+    }
+    if (attribute == "asyncServerParmType")
+    {
+        return Get("parmType");
+    }
+    if (attribute == "name")
+    {
+        return name;
+    }
+    if (attribute == "type")
+    {
+        return type;
+    }
+    if (attribute == "direction")
+    {
+        return direction;
+    }
+    if (attribute == "comment")
+    {
+        return comment;
+    }
+
+    throw Exception("Parameter '" + name + "' has no attribute '" + attribute + "'.");
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Replace each "{parm.x}" in a piece of text with the value of attribute "x".  As with Python's
+ * str.format(), "{{" and "}}" stand for literal braces.
+ *
+ * @return The resulting text.
+ **/
+//--------------------------------------------------------------------------------------------------
+std::string Parameter_t::Substitute
+(
+    const std::string& text
+)
+const
+//--------------------------------------------------------------------------------------------------
+{
+    static const std::string fieldStart = "{parm.";
+
+    std::string result;
+    size_t pos = 0;
+
+    while (pos < text.size())
+    {
+        char c = text[pos];
+
+        if ((c == '{' || c == '}') && (pos + 1 < text.size()) && (text[pos + 1] == c))
+        {
+            result += c;
+            pos += 2;
+        }
+        else if (text.compare(pos, fieldStart.size(), fieldStart) == 0)
+        {
+            size_t endPos = text.find('}', pos);
+            if (endPos == std::string::npos)
+            {
+                throw Exception("Unterminated field in template '" + text + "'.");
+            }
+
+            size_t attrPos = pos + fieldStart.size();
+            result += Get(text.substr(attrPos, endPos - attrPos));
+            pos = endPos + 1;
+        }
+        else
+        {
+            result += c;
+            pos++;
+        }
+    }
+
+    return result;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * @return The text of one of the parameter's code templates, with the fields filled in.
+ **/
+//--------------------------------------------------------------------------------------------------
+std::string Parameter_t::Format
+(
+    const std::string& templateName
+)
+const
+//--------------------------------------------------------------------------------------------------
+{
+    return Substitute(Get(templateName));
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * @return The parameter's contribution to the protocol hash.
+ **/
+//--------------------------------------------------------------------------------------------------
+std::string Parameter_t::HashString
+(
+)
+const
+//--------------------------------------------------------------------------------------------------
+{
+    // The variable name doesn't matter to the protocol.
+    std::string result = type + " " + direction;
+
+    // The baseMinValue takes precedence over minValue, since baseMinValue is the original value
+    // given in the interface, whereas minValue may have been adjusted.
+    if (Has("baseMinValue"))
+    {
+        result += " " + Get("baseMinValue");
+    }
+    else if (Has("minValue"))
+    {
+        result += " " + Get("minValue");
+    }
+
+    if (Has("maxValue"))
+    {
+        result += " " + Get("maxValue");
+    }
+
+    return result;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * @return Human-readable description of the parameter.
+ **/
+//--------------------------------------------------------------------------------------------------
+std::string Parameter_t::ToString
+(
+)
+const
+//--------------------------------------------------------------------------------------------------
+{
+    return type + " " + name;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Create a parameter that is passed by value.  Always an IN parameter.
+ **/
+//--------------------------------------------------------------------------------------------------
+ParameterPtr_t NewSimpleParameter
+(
+    const std::string& name,
+    const std::string& type
+)
+//--------------------------------------------------------------------------------------------------
+{
+    return std::make_shared<Parameter_t>(Parameter_t::SIMPLE, name, type, DirIn);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set the attributes common to all parameters that are passed by pointer.
+ **/
+//--------------------------------------------------------------------------------------------------
+static void SetPointerAttributes
+(
+    Parameter_t& parm
+)
+//--------------------------------------------------------------------------------------------------
+{
+    // todo: IN pointers should be "const"
+    parm.Set("parmName", parm.name + "Ptr");
+    parm.Set("parmType", parm.type + "*");
+
+    parm.Set("address", parm.Get("parmName"));
+    parm.Set("value", "*" + parm.Get("parmName"));
+
+    parm.Set("unpackAddr", "&" + parm.name);
+    parm.Set("unpackCallName", parm.Get("unpackAddr"));
+
+    // For support of server-side async functions
+    parm.Set("asyncServerParmType", parm.type);
+    parm.Set("asyncServerParmName", parm.name);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Create a parameter that is passed by pointer.
+ **/
+//--------------------------------------------------------------------------------------------------
+ParameterPtr_t NewPointerParameter
+(
+    const std::string& name,
+    const std::string& type,
+    const std::string& direction
+)
+//--------------------------------------------------------------------------------------------------
+{
+    auto parmPtr = std::make_shared<Parameter_t>(Parameter_t::POINTER, name, type, direction);
+
+    SetPointerAttributes(*parmPtr);
+
+    return parmPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Create a file descriptor parameter.
+ **/
+//--------------------------------------------------------------------------------------------------
+ParameterPtr_t NewFileParameter
+(
+    const std::string& name,
+    const std::string& direction
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (direction == DirIn)
+    {
+        auto parmPtr = std::make_shared<Parameter_t>(Parameter_t::FILE_IN, name, "int", direction);
+
+        // The file descriptor is sent with the message, rather than in it.
+        parmPtr->Set("fieldDefinition", "");
+        parmPtr->Set("clientPack", "le_msg_SetFd(_msgRef, {parm.parmName});");
+        parmPtr->Set("handlerUnpack", "{parm.parmType} {parm.parmName};\n"
+                                      "{parm.parmName} = le_msg_GetFd(_msgRef);");
+        return parmPtr;
+    }
+
+    auto parmPtr = std::make_shared<Parameter_t>(Parameter_t::FILE_OUT, name, "int", direction);
+
+    SetPointerAttributes(*parmPtr);
+
+    return parmPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Create an array parameter.  IN arrays can have both a maximum and a minimum size, whereas OUT
+ * arrays only have a minimum size (the size of the buffer the caller has to provide).
+ **/
+//--------------------------------------------------------------------------------------------------
+ParameterPtr_t NewArrayParameter
+(
+    const std::string& name,
+    const std::string& type,
+    const std::string& direction,
+    const std::string* maxSizePtr,
+    const std::string* minSizePtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    auto parmPtr = std::make_shared<Parameter_t>(Parameter_t::ARRAY, name, type, direction);
+    auto& parm = *parmPtr;
+
+    if (maxSizePtr != NULL)
+    {
+        parm.Set("maxSize", *maxSizePtr);
+    }
+    if (minSizePtr != NULL)
+    {
+        parm.Set("minSize", *minSizePtr);
+    }
+
+    parm.Set("parmName", name + "Ptr");
+    parm.Set("parmType", type + "*");
+
+    // Name of the auto-generated size variable.
+    std::string sizeVar = name + "NumElements";
+    parm.Set("sizeVar", sizeVar);
+
+    parm.Set("numBytes", sizeVar + "*sizeof(" + type + ")");
+    parm.Set("address", parm.Get("parmName"));
+
+    parm.Set("unpackName", name + "[" + sizeVar + "]");
+    parm.Set("unpackAddr", name);
+
+    // Arrays follow the message's fields.
+    parm.Set("fieldDefinition", "");
+
+    if (direction == DirIn)
+    {
+        // IN arrays should be "const"
+        parm.Set("parmType", "const " + parm.Get("parmType"));
+
+        parm.Set("clientPack",
+                 "le_ipc_PackArray( &_msgBufPtr, _msgBufEndPtr, {parm.parmName}, "
+                 "{parm.numBytes} );");
+
+        // The server uses the array in place, in the message buffer.
+        parm.Set("handlerUnpack", "const {parm.type}* {parm.name} = "
+                                  "le_ipc_UnpackArray( &_msgBufPtr, _msgBufEndPtr, "
+                                  "{parm.numBytes} );");
+    }
+    else
+    {
+        // OUT arrays have INOUT size parameters, so numBytes is a different expression on the
+        // client and server sides.  The templates are filled in now, with each expression.
+
+        // Client side: the size is a pointer variable.
+        parm.Set("numBytes", "*" + sizeVar + "Ptr*sizeof(" + type + ")");
+        parm.Set("clientUnpack",
+                 parm.Substitute("le_ipc_UnpackArrayCopy( &_msgBufPtr, _msgBufEndPtr, "
+                                 "{parm.address}, {parm.numBytes} );"));
+
+        // Server side: the size is not a pointer variable.
+        parm.Set("numBytes", sizeVar + "*sizeof(" + type + ")");
+        parm.Set("handlerPack",
+                 parm.Substitute("le_ipc_PackArray( &_msgBufPtr, _msgBufEndPtr, {parm.unpackAddr}, "
+                                 "{parm.numBytes} );"));
+
+        // The respond function needs a slightly different packing rule.
+        parm.Set("asyncServerPack",
+                 parm.Substitute("le_ipc_PackArray( &_msgBufPtr, _msgBufEndPtr, "
+                                 "{parm.unpackAddr}Ptr, {parm.numBytes} );"));
+    }
+
+    return parmPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add one to the text of an integer value.
+ *
+ * @return The text of the result.
+ *
+ * @throw legato::Exception if the text is not an integer.
+ **/
+//--------------------------------------------------------------------------------------------------
+static std::string Increment
+(
+    const std::string& text
+)
+//--------------------------------------------------------------------------------------------------
+{
+    bool isNegative = (!text.empty() && (text[0] == '-'));
+    std::string digits = text.substr(isNegative ? 1 : 0);
+
+    if (digits.empty() || (digits.find_first_not_of("0123456789") != std::string::npos))
+    {
+        throw Exception("String size '" + text + "' is not a number.");
+    }
+
+    // Work with the magnitude: add one to it for positive values, and subtract one for negative.
+    int pos = digits.size() - 1;
+    if (!isNegative)
+    {
+        while ((pos >= 0) && (digits[pos] == '9'))
+        {
+            digits[pos--] = '0';
+        }
+        if (pos < 0)
+        {
+            digits.insert(0, "1");
+        }
+        else
+        {
+            digits[pos]++;
+        }
+
+        return digits;
+    }
+
+    while (digits[pos] == '0')
+    {
+        digits[pos--] = '9';
+    }
+    digits[pos]--;
+
+    digits.erase(0, std::min(digits.find_first_not_of('0'), digits.size() - 1));
+
+    return (digits == "0") ? digits : ("-" + digits);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Create a string parameter.
+ *
+ * For IN strings, the size limits apply to the length of the string.  OUT strings only have a
+ * minimum size, which is the size of the buffer the caller has to provide, not counting the
+ * terminating null character.
+ **/
+//--------------------------------------------------------------------------------------------------
+ParameterPtr_t NewStringParameter
+(
+    const std::string& name,
+    const std::string& direction,
+    const std::string* maxSizePtr,
+    const std::string* minSizePtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    auto parmPtr = std::make_shared<Parameter_t>(Parameter_t::STRING, name, "char", direction);
+    auto& parm = *parmPtr;
+
+    if (direction == DirIn)
+    {
+        // The "value" of a string is its length, which is what the limits are checked against.
+        parm.Set("value", "strlen(" + name + ")");
+
+        if (maxSizePtr != NULL)
+        {
+            parm.Set("maxValue", *maxSizePtr);
+        }
+        if (minSizePtr != NULL)
+        {
+            parm.Set("minValue", *minSizePtr);
+        }
+
+        // IN strings should be "const"
+        parm.Set("parmType", "const char*");
+
+        // Strings follow the message's fields.
+        parm.Set("fieldDefinition", "");
+
+        // le_ipc_PackString() checks the length against maxValue, so that the client only has to
+        // look through the string once.
+        parm.Set("maxValueCheck", "");
+
+        parm.Set("clientPack",
+                 "le_ipc_PackString( &_msgBufPtr, _msgBufEndPtr, {parm.parmName}, "
+                 "{parm.maxValue} );");
+
+        // The server uses the string in place, in the message buffer.
+        parm.Set("handlerUnpack", "{parm.parmType} {parm.parmName} = "
+                                  "le_ipc_UnpackString( &_msgBufPtr, _msgBufEndPtr, "
+                                  "{parm.maxValue} );");
+    }
+    else
+    {
+        // Add one to the minimum size to account for the terminating null character, but keep
+        // the original value too.
+        if (minSizePtr != NULL)
+        {
+            parm.Set("baseMinSize", *minSizePtr);
+            parm.Set("minSize", Increment(*minSizePtr));
+        }
+
+        parm.Set("parmType", "char*");
+
+        std::string sizeVar = name + "NumElements";
+        parm.Set("sizeVar", sizeVar);
+
+        parm.Set("numBytes", sizeVar + "*sizeof(char)");
+        parm.Set("address", parm.Get("parmName"));
+
+        parm.Set("unpackName", name + "[" + sizeVar + "]");
+        parm.Set("unpackAddr", name);
+
+        // Strings follow the message's fields.
+        parm.Set("fieldDefinition", "");
+
+        // The respond function of an async server doesn't know the size of the client's buffer,
+        // so the server sends the string with its length, up to the size given in the interface,
+        // and the client copies as much of it as fits in its buffer (truncating it if need be).
+        // The regular server-side function packs strings the same way.
+        parm.Set("asyncServerPack", "le_ipc_PackString( &_msgBufPtr, _msgBufEndPtr, "
+                                    "{parm.unpackAddr}, {parm.baseMinSize} );");
+        parm.Set("handlerPack", parm.Get("asyncServerPack"));
+        parm.Set("clientUnpack", "le_ipc_UnpackStringCopy( &_msgBufPtr, _msgBufEndPtr, "
+                                 "{parm.address}, {parm.numBytes} );");
+    }
+
+    return parmPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Create the placeholder parameter used for empty parameter lists.
+ **/
+//--------------------------------------------------------------------------------------------------
+ParameterPtr_t NewVoidParameter
+(
+)
+//--------------------------------------------------------------------------------------------------
+{
+    auto parmPtr = std::make_shared<Parameter_t>(Parameter_t::VOID, "", "void", DirIn);
+
+    // Nothing to pack or unpack
+    parmPtr->Set("fieldDefinition", "");
+    parmPtr->Set("clientPack", "");
+    parmPtr->Set("handlerUnpack", "");
+
+    return parmPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Constructor.
+ *
+ * For functions, the size parameters of arrays and strings are added to the parameter list, and
+ * the lists of parameters to pack and unpack in each direction are created.  Handlers get a
+ * context pointer parameter added.
+ **/
+//--------------------------------------------------------------------------------------------------
+Function_t::Function_t
+(
+    Kind_t kind,
+    const std::string& name,
+    const std::string& type,
+    const ParameterList_t& parms,
+    const std::string& comment,
+    const std::string& namePrefix
+)
+//--------------------------------------------------------------------------------------------------
+:   kind(kind),
+    name(AddNamePrefix(namePrefix, name)),
+    type(type),
+    baseName(name),
+    baseType(type),
+    comment(comment),
+    isRemoveHandler(false),
+    isOneWay(false)
+//--------------------------------------------------------------------------------------------------
+{
+    if (kind == ADD_HANDLER)
+    {
+        this->type = AddNamePrefix(namePrefix, type);
+        parmList = parms;
+    }
+    else if (kind == HANDLER)
+    {
+        // The context pointer is always explicitly packed and unpacked, so the templates used for
+        // the rest of the handler's parameters don't apply to it.
+        auto contextParmPtr = NewSimpleParameter("contextPtr", "void*");
+        contextParmPtr->Set("fieldDefinition", "");
+        contextParmPtr->Set("handlerUnpack", "");
+        contextParmPtr->Set("clientPack", "");
+
+        if ((parms.size() != 1) || (parms.front()->kind != Parameter_t::VOID))
+        {
+            parmList = parms;
+        }
+        parmList.push_back(contextParmPtr);
+    }
+    else
+    {
+        // The size parameters of arrays and strings have to be packed and unpacked before the
+        // data, so that the receiver knows how big the data is, but they go after the data in
+        // calls to the server-side function.
+        for (auto parmPtr : parms)
+        {
+            parmList.push_back(parmPtr);
+
+            if (parmPtr->direction == DirIn)
+            {
+                if (parmPtr->kind == Parameter_t::ARRAY)
+                {
+                    // todo: It is probably wrong to use size_t here and below.
+                    auto sizeParmPtr = NewSimpleParameter(parmPtr->Get("sizeVar"), "size_t");
+
+                    sizeParmPtr->Set("maxValue", parmPtr->Get("maxSize"));
+                    if (parmPtr->Has("minSize"))
+                    {
+                        sizeParmPtr->Set("minValue", parmPtr->Get("minSize"));
+                    }
+
+                    // The server can't trust the size it is sent, so if it is too big, the
+                    // message is treated as invalid (see le_ipc_UnpackArray()).
+                    sizeParmPtr->Set("handlerUnpack",
+                                     sizeParmPtr->Get("handlerUnpack") +
+                                     "\nif ( {parm.name} > {parm.maxValue} ) _msgBufPtr = NULL;");
+
+                    parmList.push_back(sizeParmPtr);
+
+                    parmListIn.push_back(sizeParmPtr);
+                    parmListIn.push_back(parmPtr);
+
+                    parmListInCall.push_back(parmPtr);
+                    parmListInCall.push_back(sizeParmPtr);
+                }
+                else
+                {
+                    parmListIn.push_back(parmPtr);
+                    parmListInCall.push_back(parmPtr);
+                }
+            }
+            else if (parmPtr->kind == Parameter_t::ARRAY)
+            {
+                // The size of an OUT array goes both ways: the caller's buffer size goes to the
+                // server, and the number of elements filled in comes back.
+                auto sizeParmPtr = NewPointerParameter(parmPtr->Get("sizeVar"), "size_t", DirInOut);
+
+                // It is in both the IN and OUT lists, so the server must only define it once.
+                sizeParmPtr->Set("handlerParmList", "");
+
+                if (parmPtr->Has("minSize"))
+                {
+                    sizeParmPtr->Set("minValue", parmPtr->Get("minSize"));
+
+                    // The server never has to return more elements than the interface allows.
+                    sizeParmPtr->Set("handlerUnpack",
+                                     sizeParmPtr->Get("handlerUnpack") +
+                                     "\nif ( {parm.name} > {parm.minValue} ) "
+                                     "{parm.name} = {parm.minValue};");
+                }
+
+                // The client only accepts as many elements as fit in its buffer.
+                sizeParmPtr->Set("clientUnpack",
+                                 "if ( _rxFieldsPtr->{parm.name} > {parm.value} ) "
+                                 "_msgBufPtr = NULL;\n"
+                                 "{parm.value} = _rxFieldsPtr->{parm.name};");
+
+                parmList.push_back(sizeParmPtr);
+
+                parmListIn.push_back(sizeParmPtr);
+                parmListInCall.push_back(sizeParmPtr);
+                parmListOut.push_back(sizeParmPtr);
+                parmListOut.push_back(parmPtr);
+            }
+            else if (parmPtr->kind == Parameter_t::STRING)
+            {
+                // The size of an OUT string's buffer only goes to the server.
+                auto sizeParmPtr = NewSimpleParameter(parmPtr->Get("sizeVar"), "size_t");
+
+                if (parmPtr->Has("minSize"))
+                {
+                    sizeParmPtr->Set("minValue", parmPtr->Get("minSize"));
+
+                    // The server never has to return a longer string than the interface allows.
+                    sizeParmPtr->Set("handlerUnpack",
+                                     sizeParmPtr->Get("handlerUnpack") +
+                                     "\nif ( {parm.name} > {parm.minValue} ) "
+                                     "{parm.name} = {parm.minValue};");
+                }
+                if (parmPtr->Has("baseMinSize"))
+                {
+                    sizeParmPtr->Set("baseMinValue", parmPtr->Get("baseMinSize"));
+                }
+
+                parmList.push_back(sizeParmPtr);
+
+                parmListIn.push_back(sizeParmPtr);
+                parmListInCall.push_back(sizeParmPtr);
+                parmListOut.push_back(parmPtr);
+            }
+            else
+            {
+                parmListOut.push_back(parmPtr);
+            }
+        }
+
+        if (type != "void")
+        {
+            resultStorage = type + " _result;";
+        }
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * @return The function's contribution to the protocol hash.
+ **/
+//--------------------------------------------------------------------------------------------------
+std::string Function_t::HashString
+(
+)
+const
+//--------------------------------------------------------------------------------------------------
+{
+    static const char* const classNames[] = { "FUNCTION", "HANDLER", "ADD_HANDLER" };
+
+    std::string result = classNames[kind];
+
+    // Client and server have to agree on whether there is a response.
+    if (isOneWay)
+    {
+        result += " ONE_WAY";
+    }
+
+    // Handlers don't have a type.
+    if (!baseType.empty())
+    {
+        result += " " + baseType;
+    }
+    if (!baseName.empty())
+    {
+        result += " " + baseName;
+    }
+
+    for (auto parmPtr : parmList)
+    {
+        result += " " + parmPtr->HashString();
+    }
+
+    return result;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * @return Human-readable description of the function.
+ **/
+//--------------------------------------------------------------------------------------------------
+std::string Function_t::ToString
+(
+)
+const
+//--------------------------------------------------------------------------------------------------
+{
+    std::string result = type + "\n" + name + "\n";
+
+    for (auto parmPtr : parmList)
+    {
+        result += "    " + parmPtr->ToString() + "\n";
+    }
+
+    return result;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * @return The type's contribution to the protocol hash.
+ **/
+//--------------------------------------------------------------------------------------------------
+std::string Type_t::HashString
+(
+)
+const
+//--------------------------------------------------------------------------------------------------
+{
+    switch (kind)
+    {
+        case DEFINE:
+            return baseName + " " + value;
+
+        case ENUM:
+        case BITMASK:
+        {
+            std::string result = baseName + " ";
+            for (auto i = memberList.begin(); i != memberList.end(); i++)
+            {
+                if (i != memberList.begin())
+                {
+                    result += " ";
+                }
+                result += i->baseName;
+            }
+            return result;
+        }
+
+        default:
+            return baseName;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * @return Human-readable description of the type.
+ **/
+//--------------------------------------------------------------------------------------------------
+std::string Type_t::ToString
+(
+)
+const
+//--------------------------------------------------------------------------------------------------
+{
+    if ((kind == REFERENCE) || (kind == DEFINE))
+    {
+        return definition + "\n";
+    }
+
+    std::string result = typeName + "\n";
+    for (auto& member : memberList)
+    {
+        result += "    " + member.name + (member.hasValue ? (" = " + member.value) : "") + "\n";
+    }
+
+    return result;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Create a REFERENCE type.
+ **/
+//--------------------------------------------------------------------------------------------------
+TypePtr_t NewReferenceType
+(
+    const std::string& name,
+    const std::string& comment,
+    const std::string& namePrefix
+)
+//--------------------------------------------------------------------------------------------------
+{
+    auto typePtr = std::make_shared<Type_t>();
+
+    typePtr->kind = Type_t::REFERENCE;
+    typePtr->baseName = name;
+    typePtr->name = AddNamePrefix(namePrefix, name);
+    typePtr->refName = typePtr->name + "Ref_t";
+    typePtr->comment = comment;
+    typePtr->definition = "typedef struct " + typePtr->name + "* " + typePtr->refName + ";";
+
+    return typePtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Create a DEFINE value.
+ **/
+//--------------------------------------------------------------------------------------------------
+TypePtr_t NewDefineType
+(
+    const std::string& name,
+    const std::string& value,
+    const std::string& comment,
+    const std::string& namePrefix
+)
+//--------------------------------------------------------------------------------------------------
+{
+    auto typePtr = std::make_shared<Type_t>();
+
+    typePtr->kind = Type_t::DEFINE;
+    typePtr->baseName = name;
+    typePtr->name = ToUpper(AddNamePrefix(namePrefix, name));
+    typePtr->value = value;
+    typePtr->comment = comment;
+    typePtr->definition = "#define " + typePtr->name + " " + value;
+
+    return typePtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Create an ENUM or BITMASK type.  The members of a BITMASK are given values for successive bits.
+ **/
+//--------------------------------------------------------------------------------------------------
+TypePtr_t NewEnumType
+(
+    Type_t::Kind_t kind,
+    const std::string& name,
+    const std::list<EnumMember_t>& memberList,
+    const std::string& comment,
+    const std::string& namePrefix
+)
+//--------------------------------------------------------------------------------------------------
+{
+    auto typePtr = std::make_shared<Type_t>();
+
+    typePtr->kind = kind;
+    typePtr->baseName = name;
+    typePtr->name = AddNamePrefix(namePrefix, name);
+    typePtr->typeName = typePtr->name + "_t";
+    typePtr->memberList = memberList;
+    typePtr->comment = comment;
+
+    if (kind == Type_t::BITMASK)
+    {
+        // Values are written the way Python's hex() writes them, which adds an 'L' to values too
+        // big for a (64-bit) int.
+        size_t bit = 0;
+        for (auto& member : typePtr->memberList)
+        {
+            static const char* const leadingDigits[] = { "1", "2", "4", "8" };
+
+            member.value = std::string("0x") + leadingDigits[bit % 4]
+                         + std::string(bit / 4, '0') + (bit >= 63 ? "L" : "");
+            member.hasValue = true;
+            bit++;
+        }
+    }
+
+    return typePtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Create an ENUM or BITMASK member.
+ **/
+//--------------------------------------------------------------------------------------------------
+EnumMember_t NewEnumMember
+(
+    const std::string& name,
+    const std::string& comment,
+    const std::string& namePrefix
+)
+//--------------------------------------------------------------------------------------------------
+{
+    EnumMember_t member;
+
+    member.baseName = name;
+    member.name = ToUpper(AddNamePrefix(namePrefix, name));
+    member.comment = comment;
+    member.hasValue = false;
+
+    return member;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Convert a type name, as used in the .api file, to the corresponding C type.  Names that aren't
+ * defined are assumed to already be C types.
+ *
+ * @return The C type.
+ **/
+//--------------------------------------------------------------------------------------------------
+std::string Definition_t::ConvertType
+(
+    const std::string& apiType
+)
+const
+//--------------------------------------------------------------------------------------------------
+{
+    auto i = types.find(apiType);
+    if (i != types.end())
+    {
+        return i->second;
+    }
+
+    return apiType;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * @return The text that the protocol hash is computed from: the version of the message layout,
+ *         then one line for each thing declared in the imported files and then this file.
+ **/
+//--------------------------------------------------------------------------------------------------
+std::string Definition_t::HashString
+(
+)
+const
+//--------------------------------------------------------------------------------------------------
+{
+    std::string result = "WIRE_FORMAT " + std::to_string(WireFormatVersion);
+
+    for (auto codeListPtr : { &importedCode, &code })
+    {
+        for (auto itemPtr : *codeListPtr)
+        {
+            result += "\n";
+            result += itemPtr->HashString();
+        }
+    }
+
+    return result;
+}
+
+
+}   // namespace api
+
+}   // namespace legato
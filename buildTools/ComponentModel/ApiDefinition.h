@@ -0,0 +1,326 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * Definition of the classes that represent the contents of a parsed .api file: the types,
+ * handlers and functions that it declares, and the parameters of those functions.
+ *
+ * These are built by the .api file parser (see legato::parser::GetApiDefinition()) and read by
+ * the IPC code generator.  They follow the structure of the classes in ifgen's codeTypes.py, so
+ * that the code and protocol hashes generated from them are the same as ifgen's.
+ *
+ * Copyright (C) Sierra Wireless, Inc. 2014.  Use of this work is subject to license.
+ **/
+//--------------------------------------------------------------------------------------------------
+
+#ifndef API_DEFINITION_H_INCLUDE_GUARD
+#define API_DEFINITION_H_INCLUDE_GUARD
+
+namespace legato
+{
+
+namespace api
+{
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Parameter directions.  IN and OUT can be given in .api files, but INOUT is only used for
+ * auto-generated size parameters.
+ **/
+//--------------------------------------------------------------------------------------------------
+const char* const DirIn = "IN";
+const char* const DirOut = "OUT";
+const char* const DirInOut = "INOUT";
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Version of the layout of the messages sent by the generated code.  It is part of the protocol
+ * hash, so that client and server code generated for different message layouts can't be used
+ * together.  Must match WireFormatVersion in ifgen's codeTypes.py.
+ **/
+//--------------------------------------------------------------------------------------------------
+const int WireFormatVersion = 2;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A function parameter.
+ *
+ * Most of what the code generator needs to know about a parameter is held in named attributes
+ * ("parmName", "numBytes", "clientPack", etc.).  Attributes that haven't been explicitly set get a
+ * default value that depends on the kind of parameter and on other attributes, so that, for
+ * example, changing "name" also changes the default "parmName".  Attributes whose names end in
+ * "Pack", "Unpack" or "List" are code templates, in which "{parm.x}" is replaced by the value of
+ * attribute "x" when the template is formatted.
+ **/
+//--------------------------------------------------------------------------------------------------
+class Parameter_t
+{
+    public:
+
+        enum Kind_t
+        {
+            SIMPLE,     ///< Passed by value.
+            POINTER,    ///< Passed by reference (OUT).
+            FILE_IN,    ///< File descriptor sent with the message.
+            FILE_OUT,   ///< File descriptor received with the response.
+            ARRAY,      ///< Array with a separate size parameter.
+            STRING,     ///< Null-terminated string.
+            VOID        ///< Placeholder for an empty parameter list.
+        };
+
+        Parameter_t(Kind_t kind,
+                    const std::string& name,
+                    const std::string& type,
+                    const std::string& direction);
+
+    public:
+
+        const Kind_t kind;
+        const std::string name;
+        const std::string type;         ///< C type.
+        const std::string direction;    ///< DirIn, DirOut or DirInOut.
+        std::string comment;            ///< Doxygen comments that followed the parameter.
+
+    private:
+
+        std::map<std::string, std::string> m_Attributes;    ///< Explicitly set attributes.
+
+    public:
+
+        void Set(const std::string& attribute, const std::string& value);
+        bool Has(const std::string& attribute) const;
+        std::string Get(const std::string& attribute) const;
+
+        std::string Substitute(const std::string& text) const;
+        std::string Format(const std::string& templateName) const;
+
+        bool IsTrue(const std::string& attribute) const;
+
+        std::string HashString() const;
+        std::string ToString() const;
+};
+
+typedef std::shared_ptr<Parameter_t> ParameterPtr_t;
+typedef std::vector<ParameterPtr_t> ParameterList_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Parameter factories.  Types are C types (already converted from .api types).  Sizes are the
+ * text of the (evaluated) size values, or NULL if not given.
+ **/
+//--------------------------------------------------------------------------------------------------
+ParameterPtr_t NewSimpleParameter(const std::string& name, const std::string& type);
+
+ParameterPtr_t NewPointerParameter(const std::string& name,
+                                   const std::string& type,
+                                   const std::string& direction);
+
+ParameterPtr_t NewFileParameter(const std::string& name, const std::string& direction);
+
+ParameterPtr_t NewArrayParameter(const std::string& name,
+                                 const std::string& type,
+                                 const std::string& direction,
+                                 const std::string* maxSizePtr,
+                                 const std::string* minSizePtr);
+
+ParameterPtr_t NewStringParameter(const std::string& name,
+                                  const std::string& direction,
+                                  const std::string* maxSizePtr,
+                                  const std::string* minSizePtr);
+
+ParameterPtr_t NewVoidParameter();
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Base class for the things declared in a .api file (functions, handlers and types).
+ **/
+//--------------------------------------------------------------------------------------------------
+class CodeItem_t
+{
+    public:
+
+        virtual ~CodeItem_t() {}
+
+        /// Text that represents the item in the interface's protocol hash.
+        virtual std::string HashString() const = 0;
+
+        /// Human-readable description, for debugging.
+        virtual std::string ToString() const = 0;
+};
+
+typedef std::shared_ptr<const CodeItem_t> CodeItemPtr_t;
+typedef std::list<CodeItemPtr_t> CodeList_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A function, a handler function type (HANDLER), or the "add handler" function that goes with a
+ * handler type (ADD_HANDLER).
+ **/
+//--------------------------------------------------------------------------------------------------
+class Function_t : public CodeItem_t
+{
+    public:
+
+        enum Kind_t
+        {
+            FUNCTION,
+            HANDLER,
+            ADD_HANDLER
+        };
+
+        Function_t(Kind_t kind,
+                   const std::string& name,
+                   const std::string& type,
+                   const ParameterList_t& parmList,
+                   const std::string& comment,
+                   const std::string& namePrefix);
+
+    public:
+
+        const Kind_t kind;
+        std::string name;               ///< Name, with the prefix.
+        std::string type;               ///< Return type (C type).
+        const std::string baseName;     ///< Name as given in the .api file.
+        const std::string baseType;     ///< Return type as given in the .api file (converted).
+        const std::string comment;
+
+        ParameterList_t parmList;       ///< All parameters, including generated size parameters.
+        ParameterList_t parmListIn;     ///< Parameters to pack into the request, in order.
+        ParameterList_t parmListInCall; ///< Parameters to pass to the server function, in order.
+        ParameterList_t parmListOut;    ///< Parameters to pack into the response, in order.
+
+        std::string resultStorage;      ///< Declaration of the _result variable, if any.
+        std::string addHandlerName;     ///< Handler type added by this function, if any.
+        bool isRemoveHandler;           ///< true if this is a generated "remove handler" function.
+        bool isOneWay;                  ///< true if the server doesn't send a response (ONE_WAY).
+
+    public:
+
+        std::string HashString() const;
+        std::string ToString() const;
+};
+
+typedef std::shared_ptr<Function_t> FunctionPtr_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * One member of an ENUM or BITMASK.
+ **/
+//--------------------------------------------------------------------------------------------------
+struct EnumMember_t
+{
+    std::string baseName;   ///< Name as given in the .api file.
+    std::string name;       ///< Upper-case name, with the prefix.
+    std::string comment;    ///< Doxygen comments that followed the member.
+    std::string value;      ///< Explicit value (BITMASK members only).
+    bool hasValue;
+};
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A type or value: REFERENCE, DEFINE, ENUM or BITMASK.
+ **/
+//--------------------------------------------------------------------------------------------------
+class Type_t : public CodeItem_t
+{
+    public:
+
+        enum Kind_t
+        {
+            REFERENCE,
+            DEFINE,
+            ENUM,
+            BITMASK
+        };
+
+    public:
+
+        Kind_t kind;
+        std::string baseName;       ///< Name as given in the .api file.
+        std::string name;           ///< Name, with the prefix.
+        std::string comment;
+        std::string refName;        ///< REFERENCE: the C reference type.
+        std::string value;          ///< DEFINE: the text of the value.
+        std::string definition;     ///< REFERENCE and DEFINE: the C definition.
+        std::string typeName;       ///< ENUM and BITMASK: the C type.
+        std::list<EnumMember_t> memberList; ///< ENUM and BITMASK members.
+
+    public:
+
+        std::string HashString() const;
+        std::string ToString() const;
+};
+
+typedef std::shared_ptr<Type_t> TypePtr_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Type factories.  The returned object's C type is not registered anywhere; that is up to the
+ * caller.
+ **/
+//--------------------------------------------------------------------------------------------------
+TypePtr_t NewReferenceType(const std::string& name,
+                           const std::string& comment,
+                           const std::string& namePrefix);
+
+TypePtr_t NewDefineType(const std::string& name,
+                        const std::string& value,
+                        const std::string& comment,
+                        const std::string& namePrefix);
+
+TypePtr_t NewEnumType(Type_t::Kind_t kind,
+                      const std::string& name,
+                      const std::list<EnumMember_t>& memberList,
+                      const std::string& comment,
+                      const std::string& namePrefix);
+
+EnumMember_t NewEnumMember(const std::string& name,
+                           const std::string& comment,
+                           const std::string& namePrefix);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * @return The name with the given prefix and an underscore added to the front, or the name
+ *         alone if the prefix is empty.
+ **/
+//--------------------------------------------------------------------------------------------------
+std::string AddNamePrefix(const std::string& namePrefix, const std::string& name);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Everything known about a .api file after it and the files it imports have been parsed for a
+ * given name prefix.
+ **/
+//--------------------------------------------------------------------------------------------------
+struct Definition_t
+{
+    std::string filePath;                   ///< Path of the .api file.
+    std::string namePrefix;                 ///< Prefix for generated function and type names.
+    std::list<std::string> headerComments;  ///< Doxygen comments at the top of the file.
+    std::list<std::string> importNames;     ///< Names of the files given to USETYPES in this file.
+    std::list<std::string> importPaths;     ///< Paths of all imported files, in parsing order.
+    CodeList_t importedCode;                ///< Contents of the imported files.
+    CodeList_t code;                        ///< Contents of this file.
+    std::map<std::string, std::string> types;   ///< C types, by .api type name.
+    std::string hash;                       ///< Protocol hash (hex SHA-256 of HashString()).
+    std::string messages;                   ///< Text that ifgen would print while parsing.
+
+    std::string ConvertType(const std::string& apiType) const;
+    std::string HashString() const;
+};
+
+
+}   // namespace api
+
+}   // namespace legato
+
+#endif // API_DEFINITION_H_INCLUDE_GUARD
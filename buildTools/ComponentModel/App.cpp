@@ -564,7 +564,7 @@ ClientInterface& App::FindClientInterface
 
         return componentInstance.FindClientInterface(interfaceName);
     }
-    catch (legato::Exception e)
+    catch (legato::Exception& e)
     {
         std::string name = exeName + '.' + componentName + '.' + interfaceName;
 
@@ -603,7 +603,7 @@ ServerInterface& App::FindServerInterface
 
         return componentInstance.FindServerInterface(interfaceName);
     }
-    catch (legato::Exception e)
+    catch (legato::Exception& e)
     {
         std::string name = exeName + '.' + componentName + '.' + interfaceName;
 
@@ -636,7 +636,7 @@ ClientInterface& App::FindClientInterface
     {
         legato::Interface::SplitAppUniqueName(name, exeName, componentName, interfaceName);
     }
-    catch (legato::Exception e)
+    catch (legato::Exception& e)
     {
         throw legato::Exception ("Client-side IPC API interface '" + name + "'"
                                 " not found in app '" + m_Name + "'.  " + e.what() );
@@ -669,7 +669,7 @@ ServerInterface& App::FindServerInterface
     {
         legato::Interface::SplitAppUniqueName(name, exeName, componentName, interfaceName);
     }
-    catch (legato::Exception e)
+    catch (legato::Exception& e)
     {
         throw legato::Exception ("Server-side IPC API interface '" + name + "'"
                                 " not found in app '" + m_Name + "'.  " + e.what() );
@@ -59,7 +59,8 @@ BuildParams_t::BuildParams_t
     m_CCompilerFlags(original.m_CCompilerFlags),
     m_CxxCompilerFlags(original.m_CxxCompilerFlags),
     m_LinkerFlags(original.m_LinkerFlags),
-    m_DoStaticLink(original.m_DoStaticLink)
+    m_DoStaticLink(original.m_DoStaticLink),
+    m_Optimization(original.m_Optimization)
 
 //--------------------------------------------------------------------------------------------------
 {
@@ -88,7 +89,8 @@ BuildParams_t::BuildParams_t
     m_CCompilerFlags(std::move(original.m_CCompilerFlags)),
     m_CxxCompilerFlags(std::move(original.m_CxxCompilerFlags)),
     m_LinkerFlags(std::move(original.m_LinkerFlags)),
-    m_DoStaticLink(std::move(original.m_DoStaticLink))
+    m_DoStaticLink(std::move(original.m_DoStaticLink)),
+    m_Optimization(std::move(original.m_Optimization))
 //--------------------------------------------------------------------------------------------------
 {
 }
@@ -120,6 +122,7 @@ BuildParams_t& BuildParams_t::operator =
         m_CxxCompilerFlags = original.m_CxxCompilerFlags;
         m_LinkerFlags = original.m_LinkerFlags;
         m_DoStaticLink = original.m_DoStaticLink;
+        m_Optimization = original.m_Optimization;
     }
 
     return *this;
@@ -152,6 +155,7 @@ BuildParams_t& BuildParams_t::operator =
         m_CxxCompilerFlags = std::move(original.m_CxxCompilerFlags);
         m_LinkerFlags = std::move(original.m_LinkerFlags);
         m_DoStaticLink = std::move(original.m_DoStaticLink);
+        m_Optimization = std::move(original.m_Optimization);
     }
 
     return *this;
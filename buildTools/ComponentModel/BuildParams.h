@@ -28,6 +28,7 @@ class BuildParams_t
         std::string             m_CxxCompilerFlags; ///< Flags to be passed to the C++ compiler.
         std::string             m_LinkerFlags;      ///< Flags to be passed to the linker.
         bool                    m_DoStaticLink;     ///< True = do static, false = use DLLs (.so).
+        std::string             m_Optimization;     ///< "size", "speed" or "" (no optimization).
 
     public:
         BuildParams_t();
@@ -74,6 +75,8 @@ class BuildParams_t
 
         void DoStaticLink(bool doStaticLink) { m_DoStaticLink = doStaticLink; }
 
+        void Optimization(const std::string& goal) { m_Optimization = goal; }
+
     public: // Functions for retrieving the parameters.
         bool IsVerbose() const { return m_IsVerbose; }
         const std::string& Target() const { return m_Target; }
@@ -87,6 +90,7 @@ class BuildParams_t
         const std::string& CxxCompilerFlags() const { return m_CxxCompilerFlags; }
         const std::string& LinkerFlags() const { return m_LinkerFlags; }
         bool DoStaticLink() const { return m_DoStaticLink; }
+        const std::string& Optimization() const { return m_Optimization; }
 };
 
 
@@ -38,8 +38,10 @@ class ComponentInstance
         /// Copied here from the Component object when the Component Instance is created.
         ServerInterfaceMap m_ProvidedApis;
 
-        /// Set of pointers to sub-component instances that this component instance depends on.
-        std::set<ComponentInstance*> m_SubInstances;
+        /// Pointers to the sub-component instances that this component instance depends on, in
+        /// the order they were added (not pointer order, so the build doesn't depend on where
+        /// things happen to have been allocated).
+        std::list<ComponentInstance*> m_SubInstances;
 
         /// Pointer to the Executable that this component instance is a part of.
         Executable* m_ExePtr;
@@ -72,8 +74,8 @@ class ComponentInstance
         ClientInterface& FindClientInterface(const std::string& name);
         ServerInterface& FindServerInterface(const std::string& name);
 
-        const std::set<ComponentInstance*>& SubInstances() const { return m_SubInstances; }
-        std::set<ComponentInstance*>& SubInstances() { return m_SubInstances; }
+        const std::list<ComponentInstance*>& SubInstances() const { return m_SubInstances; }
+        std::list<ComponentInstance*>& SubInstances() { return m_SubInstances; }
 
         void SetExe(Executable* exePtr);
         Executable* Exe() { return m_ExePtr; }
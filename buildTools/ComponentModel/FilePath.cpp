@@ -14,6 +14,10 @@
 #include <string.h>
 #include <limits.h>
 #include <stdlib.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <linux/fs.h>
 
 namespace legato
 {
@@ -663,6 +667,77 @@ void MakeDir
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Delete a directory and everything in it.  Symbolic links are deleted, not followed.
+ *
+ * @throw legato::Exception if something goes wrong.
+ **/
+//--------------------------------------------------------------------------------------------------
+static void RemoveTree
+(
+    const std::string& path
+)
+//--------------------------------------------------------------------------------------------------
+{
+    // Don't follow a symlink that replaced the directory since it was checked.
+    int dirFd = open(path.c_str(), O_RDONLY | O_NOFOLLOW | O_DIRECTORY | O_CLOEXEC);
+    DIR* dirPtr = (dirFd < 0) ? NULL : fdopendir(dirFd);
+
+    if (dirPtr == NULL)
+    {
+        std::string msg = "Failed to open directory '" + path + "' (" + strerror(errno) + ").";
+        if (dirFd >= 0)
+        {
+            close(dirFd);
+        }
+        throw legato::Exception(msg);
+    }
+
+    struct dirent* entryPtr;
+
+    while ((entryPtr = readdir(dirPtr)) != NULL)
+    {
+        std::string name = entryPtr->d_name;
+
+        if ((name == ".") || (name == ".."))
+        {
+            continue;
+        }
+
+        std::string entryPath = CombinePath(path, name);
+        struct stat statBuffer;
+
+        if ((lstat(entryPath.c_str(), &statBuffer) == 0) && S_ISDIR(statBuffer.st_mode))
+        {
+            try
+            {
+                RemoveTree(entryPath);
+            }
+            catch (...)
+            {
+                closedir(dirPtr);
+                throw;
+            }
+        }
+        else if ((unlink(entryPath.c_str()) != 0) && (errno != ENOENT))
+        {
+            std::string msg = "Failed to delete '" + entryPath + "' (" + strerror(errno) + ").";
+            closedir(dirPtr);
+            throw legato::Exception(msg);
+        }
+    }
+
+    closedir(dirPtr);
+
+    if ((rmdir(path.c_str()) != 0) && (errno != ENOENT))
+    {
+        throw legato::Exception("Failed to delete directory '" + path + "' (" + strerror(errno)
+                                + ").");
+    }
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Recursively delete a directory.  That is, delete everything in the directory,
@@ -670,7 +745,8 @@ void MakeDir
  *
  * If nothing exists at the path, quietly returns without error.
  *
- * If something other than a directory exists at the given path, it's an error.
+ * If something other than a directory exists at the given path, it's an error.  If it's a
+ * symbolic link to a directory, the link is deleted and the directory it points to is left alone.
  *
  * @throw legato::Exception if something goes wrong.
  **/
@@ -688,20 +764,35 @@ void CleanDir
         throw legato::Exception("Attempt to delete using an empty path.");
     }
 
-    // Get the status of whatever exists at that path.
-    if (stat(path.c_str(), &statBuffer) == 0)
+    // Get the status of whatever exists at that path, without following symlinks.
+    if (lstat(path.c_str(), &statBuffer) == 0)
     {
         // If it's a directory, delete it.
         if (S_ISDIR(statBuffer.st_mode))
         {
-            std::string commandLine = "rm -rf " + path;
-            int result = system(commandLine.c_str());
-            if (result != EXIT_SUCCESS)
+            RemoveTree(path);
+        }
+        // If it's a symlink to a directory, delete the link, not what it points to.
+        else if (S_ISLNK(statBuffer.st_mode))
+        {
+            if (stat(path.c_str(), &statBuffer) != 0)
+            {
+                // Dangling link: nothing exists at the path.
+                if (errno != ENOENT)
+                {
+                    throw legato::Exception("Failed to delete directory at '" + path + "'"
+                                            " (" + strerror(errno) + ").");
+                }
+            }
+            else if (!S_ISDIR(statBuffer.st_mode))
+            {
+                throw legato::Exception("Object at path '" + path + "' is not a directory."
+                                        " Aborting deletion.");
+            }
+            else if ((unlink(path.c_str()) != 0) && (errno != ENOENT))
             {
-                std::stringstream buffer;
-                buffer << "Failed to execute command '" << commandLine << "'"
-                       << " result: " << result;
-                throw legato::Exception(buffer.str());
+                throw legato::Exception("Failed to delete '" + path + "' (" + strerror(errno)
+                                        + ").");
             }
         }
         else
@@ -748,14 +839,10 @@ void CleanFile
         // If it's a regular file, delete it.
         if (S_ISREG(statBuffer.st_mode))
         {
-            std::string commandLine = "rm -f " + path;
-            int result = system(commandLine.c_str());
-            if (result != EXIT_SUCCESS)
+            if ((unlink(path.c_str()) != 0) && (errno != ENOENT))
             {
-                std::stringstream buffer;
-                buffer << "Failed to execute command '" << commandLine << "'"
-                       << " result: " << result;
-                throw legato::Exception(buffer.str());
+                throw legato::Exception("Failed to delete file '" + path + "' ("
+                                        + strerror(errno) + ").");
             }
         }
         else
@@ -772,6 +859,273 @@ void CleanFile
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Copy the contents of one open file to another.  Where the file system supports it (e.g., btrfs
+ * or XFS), the copy is a reflink that shares the source file's data blocks until either file is
+ * changed.  Otherwise, the data is copied inside the kernel if possible.
+ *
+ * @return 0 on success, or an errno value on failure.
+ **/
+//--------------------------------------------------------------------------------------------------
+static int CopyFileContents
+(
+    int sourceFd,
+    int destFd
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (ioctl(destFd, FICLONE, sourceFd) == 0)
+    {
+        return 0;
+    }
+
+    bool isKernelCopyOk = true;
+
+    for (;;)
+    {
+        ssize_t result;
+
+        if (isKernelCopyOk)
+        {
+            result = copy_file_range(sourceFd, NULL, destFd, NULL, 1024 * 1024, 0);
+
+            // Fall back to read() and write() if the kernel can't copy between these files.
+            if ((result < 0) && ((errno == EXDEV) || (errno == EINVAL) || (errno == ENOSYS)))
+            {
+                isKernelCopyOk = false;
+                continue;
+            }
+        }
+        else
+        {
+            char buffer[64 * 1024];
+
+            result = read(sourceFd, buffer, sizeof(buffer));
+
+            for (ssize_t written = 0; (result > 0) && (written < result); )
+            {
+                ssize_t writeResult = write(destFd, buffer + written, result - written);
+
+                if (writeResult < 0)
+                {
+                    if (errno != EINTR)
+                    {
+                        return errno;
+                    }
+                }
+                else
+                {
+                    written += writeResult;
+                }
+            }
+        }
+
+        if (result == 0)
+        {
+            return 0;
+        }
+        else if ((result < 0) && (errno != EINTR))
+        {
+            return errno;
+        }
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the names of the entries in a directory, except "." and "..".
+ *
+ * @throw legato::Exception if the directory can't be read.
+ **/
+//--------------------------------------------------------------------------------------------------
+static std::list<std::string> GetDirEntryNames
+(
+    const std::string& path
+)
+//--------------------------------------------------------------------------------------------------
+{
+    // Don't follow a symlink that replaced the directory since it was checked.
+    int dirFd = open(path.c_str(), O_RDONLY | O_NOFOLLOW | O_DIRECTORY | O_CLOEXEC);
+    DIR* dirPtr = (dirFd < 0) ? NULL : fdopendir(dirFd);
+
+    if (dirPtr == NULL)
+    {
+        std::string msg = "Failed to open directory '" + path + "' (" + strerror(errno) + ").";
+        if (dirFd >= 0)
+        {
+            close(dirFd);
+        }
+        throw legato::Exception(msg);
+    }
+
+    std::list<std::string> names;
+    struct dirent* entryPtr;
+
+    while ((entryPtr = readdir(dirPtr)) != NULL)
+    {
+        if ((strcmp(entryPtr->d_name, ".") != 0) && (strcmp(entryPtr->d_name, "..") != 0))
+        {
+            names.push_back(entryPtr->d_name);
+        }
+    }
+
+    closedir(dirPtr);
+
+    return names;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Copy a file, symbolic link or directory (with everything in it) to a given path.  A directory
+ * copied onto an existing directory is merged into it.  Anything else at the destination path is
+ * deleted first.
+ *
+ * @throw legato::Exception if something goes wrong.
+ **/
+//--------------------------------------------------------------------------------------------------
+static void CopyToPath
+(
+    const std::string& sourcePath,
+    const std::string& destPath,
+    bool isRecursive            ///< true = copy symbolic links as links, and directories too.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    struct stat sourceStat;
+
+    int result = isRecursive ? lstat(sourcePath.c_str(), &sourceStat)
+                             : stat(sourcePath.c_str(), &sourceStat);
+    if (result != 0)
+    {
+        throw legato::Exception("Can't copy '" + sourcePath + "' (" + strerror(errno) + ").");
+    }
+
+    struct stat destStat;
+    bool destExists = (lstat(destPath.c_str(), &destStat) == 0);
+
+    if (destExists && S_ISDIR(destStat.st_mode) != S_ISDIR(sourceStat.st_mode))
+    {
+        throw legato::Exception("Can't overwrite '" + destPath + "' with '" + sourcePath + "'.");
+    }
+
+    if (S_ISDIR(sourceStat.st_mode))
+    {
+        if (!isRecursive)
+        {
+            throw legato::Exception("Can't copy directory '" + sourcePath + "' without copying"
+                                    " its contents.");
+        }
+
+        if (!destExists && (mkdir(destPath.c_str(), sourceStat.st_mode & 07777) != 0))
+        {
+            throw legato::Exception("Failed to create directory '" + destPath + "' ("
+                                    + strerror(errno) + ").");
+        }
+
+        for (const auto& name : GetDirEntryNames(sourcePath))
+        {
+            CopyToPath(CombinePath(sourcePath, name), CombinePath(destPath, name), true);
+        }
+
+        return;
+    }
+
+    if (destExists && (unlink(destPath.c_str()) != 0))
+    {
+        throw legato::Exception("Failed to replace '" + destPath + "' (" + strerror(errno)
+                                + ").");
+    }
+
+    if (S_ISLNK(sourceStat.st_mode))
+    {
+        std::vector<char> target(sourceStat.st_size + 1);
+        ssize_t length = readlink(sourcePath.c_str(), target.data(), target.size());
+
+        if ((length < 0) || ((size_t)length >= target.size()))
+        {
+            throw legato::Exception("Failed to read symbolic link '" + sourcePath + "'.");
+        }
+        target[length] = '\0';
+
+        if (symlink(target.data(), destPath.c_str()) != 0)
+        {
+            throw legato::Exception("Failed to create symbolic link '" + destPath + "' ("
+                                    + strerror(errno) + ").");
+        }
+
+        return;
+    }
+
+    int sourceFd = open(sourcePath.c_str(), O_RDONLY | O_CLOEXEC);
+
+    if (sourceFd < 0)
+    {
+        throw legato::Exception("Failed to open '" + sourcePath + "' (" + strerror(errno) + ").");
+    }
+
+    int destFd = open(destPath.c_str(),
+                      O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC,
+                      sourceStat.st_mode & 07777);
+
+    if (destFd < 0)
+    {
+        int error = errno;
+        close(sourceFd);
+        throw legato::Exception("Failed to create '" + destPath + "' (" + strerror(error) + ").");
+    }
+
+    int error = CopyFileContents(sourceFd, destFd);
+
+    close(sourceFd);
+
+    if ((close(destFd) != 0) && (error == 0))
+    {
+        error = errno;
+    }
+
+    if (error != 0)
+    {
+        throw legato::Exception("Failed to copy '" + sourcePath + "' to '" + destPath + "' ("
+                                + strerror(error) + ").");
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Copy a file or directory, like 'cp' (or 'cp -r' if isRecursive is true) does: if something is
+ * to be copied to an existing directory, it is copied into that directory; otherwise, it replaces
+ * whatever file is at the destination path.  Files are copied using reflinks where the file
+ * system supports it.
+ *
+ * Replaced files are deleted, not overwritten, so a file that shares data with another (e.g., a
+ * hard link) isn't changed.
+ *
+ * @throw legato::Exception if something goes wrong.
+ **/
+//--------------------------------------------------------------------------------------------------
+void CopyPath
+(
+    const std::string& sourcePath,
+    const std::string& destPath,
+    bool isRecursive
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (DirectoryExists(destPath))
+    {
+        CopyToPath(sourcePath, CombinePath(destPath, GetLastPathNode(sourcePath)), isRecursive);
+    }
+    else
+    {
+        CopyToPath(sourcePath, destPath, isRecursive);
+    }
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Gets the absolute file system path of the current working directory.
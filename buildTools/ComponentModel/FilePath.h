@@ -332,6 +332,27 @@ void CleanFile
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Copy a file or directory, like 'cp' (or 'cp -r' if isRecursive is true) does: if something is
+ * to be copied to an existing directory, it is copied into that directory; otherwise, it replaces
+ * whatever file is at the destination path.  Files are copied using reflinks where the file
+ * system supports it.
+ *
+ * Replaced files are deleted, not overwritten, so a file that shares data with another (e.g., a
+ * hard link) isn't changed.
+ *
+ * @throw legato::Exception if something goes wrong.
+ **/
+//--------------------------------------------------------------------------------------------------
+void CopyPath
+(
+    const std::string& sourcePath,
+    const std::string& destPath,
+    bool isRecursive = false
+);
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Gets the absolute file system path of the current working directory.
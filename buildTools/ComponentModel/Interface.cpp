@@ -257,7 +257,9 @@ ClientInterface::ClientInterface
 //--------------------------------------------------------------------------------------------------
 :   Interface(name, apiPtr),
     m_IsBound(false),
-    m_TypesOnly(false)
+    m_TypesOnly(false),
+    m_IsAwait(false),
+    m_IsPipelined(false)
 //--------------------------------------------------------------------------------------------------
 {
     m_Library.ShortName("IF_" + m_InternalName + "_client");
@@ -276,7 +278,9 @@ ClientInterface::ClientInterface
 //--------------------------------------------------------------------------------------------------
 :   Interface(original),
     m_IsBound(original.m_IsBound),
-    m_TypesOnly(original.m_TypesOnly)
+    m_TypesOnly(original.m_TypesOnly),
+    m_IsAwait(original.m_IsAwait),
+    m_IsPipelined(original.m_IsPipelined)
 //--------------------------------------------------------------------------------------------------
 {
 }
@@ -295,7 +299,9 @@ ClientInterface::ClientInterface
 //--------------------------------------------------------------------------------------------------
 :   Interface(rvalue),
     m_IsBound(std::move(rvalue.m_IsBound)),
-    m_TypesOnly(std::move(rvalue.m_TypesOnly))
+    m_TypesOnly(std::move(rvalue.m_TypesOnly)),
+    m_IsAwait(std::move(rvalue.m_IsAwait)),
+    m_IsPipelined(std::move(rvalue.m_IsPipelined))
 //--------------------------------------------------------------------------------------------------
 {
 }
@@ -326,6 +332,8 @@ ClientInterface& ClientInterface::operator =
         m_ComponentInstancePtr = std::move(rvalue.m_ComponentInstancePtr);
         m_IsBound = std::move(rvalue.m_IsBound);
         m_TypesOnly = std::move(rvalue.m_TypesOnly);
+        m_IsAwait = std::move(rvalue.m_IsAwait);
+        m_IsPipelined = std::move(rvalue.m_IsPipelined);
     }
 
     return *this;
@@ -357,6 +365,8 @@ ClientInterface& ClientInterface::operator =
         m_ComponentInstancePtr = original.m_ComponentInstancePtr;
         m_IsBound = original.m_IsBound;
         m_TypesOnly = original.m_TypesOnly;
+        m_IsAwait = original.m_IsAwait;
+        m_IsPipelined = original.m_IsPipelined;
     }
 
     return *this;
@@ -92,7 +92,7 @@ class ClientInterface : public Interface
 {
     public:
 
-        ClientInterface(): m_IsBound(false) {};
+        ClientInterface(): m_IsBound(false), m_IsAwait(false), m_IsPipelined(false) {};
         ClientInterface(const std::string& name, Api_t* apiPtr);
         ClientInterface(const ClientInterface& original);
         ClientInterface(ClientInterface&& rvalue);
@@ -103,6 +103,8 @@ class ClientInterface : public Interface
 
         bool m_IsBound;
         bool m_TypesOnly;
+        bool m_IsAwait;     ///< true if calls should only suspend the calling coroutine.
+        bool m_IsPipelined; ///< true if pipelined Start and Finish functions are wanted too.
 
     public:
 
@@ -114,6 +116,12 @@ class ClientInterface : public Interface
         bool TypesOnly() const { return m_TypesOnly; }
         void MarkTypesOnly() { m_TypesOnly = true; }
 
+        bool IsAwait() const { return m_IsAwait; }
+        void MarkAwait() { m_IsAwait = true; }
+
+        bool IsPipelined() const { return m_IsPipelined; }
+        void MarkPipelined() { m_IsPipelined = true; }
+
         bool IsBound() const { return m_IsBound; }
         void MarkBound() { m_IsBound = true; }
 
@@ -71,6 +71,7 @@ App --+--> File Imports List --*---------+
 #include <stdexcept>
 #include <string>
 #include <list>
+#include <vector>
 #include <map>
 #include <set>
 #include <memory>
@@ -82,6 +83,7 @@ App --+--> File Imports List --*---------+
 #include "Limit.h"      // Classes for various limits settings.
 #include "Library.h"
 #include "Api.h"
+#include "ApiDefinition.h" // Contents of parsed .api files.
 #include "Permissions.h"
 #include "ConfigItem.h"
 #include "MemoryPool.h"
@@ -25,7 +25,8 @@ ProcessEnvironment::ProcessEnvironment
 :   m_MaxFileBytes(100 * 1024), // 100 K
     m_MaxCoreDumpFileBytes(m_MaxFileBytes.Get()),
     m_MaxLockedMemoryBytes(8 * 1024),   // 8 KB
-    m_MaxFileDescriptors(256)
+    m_MaxFileDescriptors(256),
+    m_MaxStackBytes(8 * 1024 * 1024)    // 8 MB (the usual Linux default)
 //--------------------------------------------------------------------------------------------------
 {
 }
@@ -50,6 +51,8 @@ ProcessEnvironment::ProcessEnvironment
     m_MaxCoreDumpFileBytes(std::move(original.m_MaxCoreDumpFileBytes)),
     m_MaxLockedMemoryBytes(std::move(original.m_MaxLockedMemoryBytes)),
     m_MaxFileDescriptors(std::move(original.m_MaxFileDescriptors)),
+    m_MaxStackBytes(std::move(original.m_MaxStackBytes)),
+    m_CpuAffinity(std::move(original.m_CpuAffinity)),
     m_WatchdogTimeout(std::move(original.m_WatchdogTimeout)),
     m_WatchdogAction(std::move(original.m_WatchdogAction))
 //--------------------------------------------------------------------------------------------------
@@ -105,6 +108,27 @@ void ProcessEnvironment::StartPriority
 
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add a CPU to the set of CPUs that processes in this process environment are allowed to run on.
+ **/
+//--------------------------------------------------------------------------------------------------
+void ProcessEnvironment::AddCpuAffinity
+(
+    int cpu     ///< CPU number, as numbered by the kernel (0 = first CPU).
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if ((cpu < 0) || (cpu >= 64))
+    {
+        throw Exception("CPU number " + std::to_string(cpu) + " is out of range (0 to 63).");
+    }
+
+    m_CpuAffinity.insert(cpu);
+}
+
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * @return  true if this process environment allows any threads to run at real-time priority levels.
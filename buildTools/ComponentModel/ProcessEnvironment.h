@@ -51,6 +51,10 @@ class ProcessEnvironment
         NonNegativeIntLimit_t m_MaxCoreDumpFileBytes; ///< Maximum core dump file size in bytes.
         NonNegativeIntLimit_t m_MaxLockedMemoryBytes; ///< Maximum bytes that can be locked in RAM.
         PositiveIntLimit_t    m_MaxFileDescriptors;   ///< Maximum number of open file descriptors.
+        PositiveIntLimit_t    m_MaxStackBytes;        ///< Maximum (and default thread) stack size.
+
+        /// CPUs that the processes are allowed to run on (empty = any CPU).
+        std::set<int> m_CpuAffinity;
 
         /// Watchdog
         WatchdogTimeout_t m_WatchdogTimeout;
@@ -87,6 +91,12 @@ class ProcessEnvironment
         void MaxFileDescriptors(int limit) { m_MaxFileDescriptors = limit; }
         const PositiveIntLimit_t& MaxFileDescriptors() const { return m_MaxFileDescriptors; }
 
+        void MaxStackBytes(int limit) { m_MaxStackBytes = limit; }
+        const PositiveIntLimit_t& MaxStackBytes() const { return m_MaxStackBytes; }
+
+        void AddCpuAffinity(int cpu);
+        const std::set<int>& CpuAffinity() const { return m_CpuAffinity; }
+
         void WatchdogTimeout(int timeout) { m_WatchdogTimeout = timeout; }
         void WatchdogTimeout(const std::string& timeout) { m_WatchdogTimeout = timeout; }
         const WatchdogTimeout_t& WatchdogTimeout() const { return m_WatchdogTimeout; }
@@ -0,0 +1,1385 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * Syntax parser for .api files.
+ *
+ * The grammar, and the way comments and whitespace are handled, follow ifgen's pyparsing grammar
+ * (framework/tools/ifgen/interfaceParser.py) exactly, because the code generated from the parsed
+ * declarations has to match ifgen's output byte for byte.
+ *
+ * Copyright (C) Sierra Wireless, Inc. 2014.  Use of this work is subject to license.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "LegatoObjectModel.h"
+#include "ApiParserInternals.h"
+#include <string.h>
+#include <ctype.h>
+#include <algorithm>
+
+
+namespace legato
+{
+
+namespace parser
+{
+
+namespace api
+{
+
+
+/// Contents of the .api files that have been read, by file path.
+static std::map<std::string, std::string> FileContents;
+
+/// Parsed .api files, by file path.
+static std::map<std::string, File_t> ParsedFiles;
+
+/// Names of the files imported by each .api file, by file path.
+static std::map<std::string, std::list<std::string>> ImportNames;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Keywords that can be preceded by a doxygen comment.  A comment that is followed by one of these
+ * is the declaration's comment rather than a file header comment.
+ **/
+//--------------------------------------------------------------------------------------------------
+static const char* const CommentedKeywords[] =
+{
+    "FUNCTION", "HANDLER", "REFERENCE", "DEFINE", "ENUM", "BITMASK"
+};
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Make an error message for a location in a .api file, in the format used by GCC.
+ *
+ * @return The message.
+ **/
+//--------------------------------------------------------------------------------------------------
+std::string ErrorMessage
+(
+    const std::string& path,
+    const Location_t& location,
+    const std::string& message
+)
+//--------------------------------------------------------------------------------------------------
+{
+    std::stringstream msg;
+
+    msg << path << ":" << location.line << ":" << location.column << ": error: " << message;
+
+    return msg.str();
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the contents of a .api file.  Each file is only read once.
+ *
+ * @return The contents.
+ *
+ * @throw legato::Exception if the file can't be read.
+ **/
+//--------------------------------------------------------------------------------------------------
+static const std::string& ReadFile
+(
+    const std::string& path
+)
+//--------------------------------------------------------------------------------------------------
+{
+    auto i = FileContents.find(path);
+    if (i != FileContents.end())
+    {
+        return i->second;
+    }
+
+    std::ifstream file(path.c_str(), std::ios::binary);
+    if (!file.is_open())
+    {
+        throw legato::Exception("Failed to open file '" + path + "'.");
+    }
+
+    std::stringstream contents;
+    contents << file.rdbuf();
+
+    if (file.bad())
+    {
+        throw legato::Exception("Failed to read file '" + path + "'.");
+    }
+
+    return FileContents[path] = contents.str();
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * @return true if a character can be part of a keyword or identifier, as far as deciding where
+ *         keywords start and end is concerned.
+ **/
+//--------------------------------------------------------------------------------------------------
+static bool IsIdentChar
+(
+    char c
+)
+//--------------------------------------------------------------------------------------------------
+{
+    return isalnum((unsigned char)c) || (c == '_') || (c == '$');
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Find the end of the C or C++ style comment that starts at a given position, if there is one.
+ *
+ * @return The position just past the end of the comment, or std::string::npos if there is no
+ *         comment at that position.
+ **/
+//--------------------------------------------------------------------------------------------------
+static size_t CommentEnd
+(
+    const std::string& text,
+    size_t pos,
+    bool cStyleOnly = false
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if ((pos + 1 >= text.size()) || (text[pos] != '/'))
+    {
+        return std::string::npos;
+    }
+
+    if (text[pos + 1] == '*')
+    {
+        size_t endPos = text.find("*/", pos + 2);
+
+        return (endPos == std::string::npos) ? endPos : (endPos + 2);
+    }
+
+    if (cStyleOnly || (text[pos + 1] != '/'))
+    {
+        return std::string::npos;
+    }
+
+    // A "//" comment continues onto the next line if the line ends in a backslash.
+    pos += 2;
+    while (pos < text.size())
+    {
+        if ((text[pos] == '\\') && (pos + 1 < text.size()) && (text[pos + 1] == '\n'))
+        {
+            pos += 2;
+        }
+        else if (text[pos] != '\n')
+        {
+            pos++;
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    return pos;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Remove all comments except doxygen comments ("/ **" and "///<") from the contents of a file,
+ * and expand tabs.  Removed comments are replaced by as many newlines as they contained, so that
+ * line numbers don't change.
+ *
+ * @return The resulting text.
+ **/
+//--------------------------------------------------------------------------------------------------
+static std::string Preprocess
+(
+    const std::string& text
+)
+//--------------------------------------------------------------------------------------------------
+{
+    std::string stripped;
+    size_t pos = 0;
+
+    while (pos < text.size())
+    {
+        size_t endPos = CommentEnd(text, pos);
+
+        if (endPos == std::string::npos)
+        {
+            stripped += text[pos];
+            pos++;
+        }
+        else
+        {
+            std::string comment = text.substr(pos, endPos - pos);
+
+            if ((comment.compare(0, 3, "/**") == 0) || (comment.compare(0, 4, "///<") == 0))
+            {
+                stripped += comment;
+            }
+            else
+            {
+                stripped.append(std::count(comment.begin(), comment.end(), '\n'), '\n');
+            }
+            pos = endPos;
+        }
+    }
+
+    // Tab stops are every 8 columns.
+    std::string result;
+    size_t column = 0;
+
+    for (auto c : stripped)
+    {
+        if (c == '\t')
+        {
+            size_t numSpaces = 8 - (column % 8);
+            result.append(numSpaces, ' ');
+            column += numSpaces;
+        }
+        else
+        {
+            result += c;
+            column = ((c == '\n') || (c == '\r')) ? 0 : (column + 1);
+        }
+    }
+
+    return result;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Recursive descent parser for the contents of one file.  Each Match function either matches
+ * something at the current position, consuming it and any whitespace in front of it, or returns
+ * false without changing the position.
+ **/
+//--------------------------------------------------------------------------------------------------
+class Parser_t
+{
+    public:
+
+        Parser_t(const std::string& path, const std::string& text)
+        :   m_Path(path),
+            m_Text(text),
+            m_Pos(0),
+            m_IgnoreComments(false)
+        {
+        }
+
+        void Parse(File_t& file);
+        void ScanImports(std::list<std::string>& names);
+
+    private:
+
+        const std::string& m_Path;
+        const std::string& m_Text;
+        size_t m_Pos;
+        bool m_IgnoreComments;  ///< true if comments are skipped along with whitespace.
+
+        size_t SkipWhitespace(size_t pos) const;
+        Location_t GetLocation(size_t pos) const;
+        void Error(size_t pos, const std::string& message) const;
+        void Expect(bool isMatched, const std::string& what) const;
+
+        bool MatchLiteral(const char* literalPtr);
+        bool MatchKeyword(const char* keywordPtr);
+        bool MatchIdentifier(std::string& name);
+        bool MatchTypeIdentifier(std::string& name);
+        bool MatchNumber(std::string& value);
+        bool MatchComment(std::string& comment, bool cStyleOnly);
+        bool MatchQuotedString(std::string& text);
+        bool MatchDirection(std::string& direction);
+        bool MatchImportName(std::string& name);
+
+        bool IsCommentedKeywordNext() const;
+
+        bool MatchSize(Size_t& size);
+        bool MatchSizedParameter(Parameter_t& parm, bool isString);
+        bool MatchParameter(Parameter_t& parm);
+        bool MatchHandlerParameter(Parameter_t& parm);
+        bool MatchEnumMember(EnumMember_t& member);
+
+        template <class T>
+        void ParseList(std::list<T>& list,
+                       const char* openerPtr,
+                       const char* closerPtr,
+                       bool allowTrailingSep,
+                       bool (Parser_t::*matchFunc)(T&));
+
+        void ParseFunction(Declaration_t& decl);
+        void ParseHandler(Declaration_t& decl);
+        void ParseReference(Declaration_t& decl);
+        void ParseDefine(Declaration_t& decl);
+        void ParseEnum(Declaration_t& decl);
+        void ParseImport(Declaration_t& decl);
+};
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * @return The position of the first non-whitespace character at or after a given position.  If
+ *         comments are being ignored, the first character that isn't part of a comment either.
+ **/
+//--------------------------------------------------------------------------------------------------
+size_t Parser_t::SkipWhitespace
+(
+    size_t pos
+)
+const
+//--------------------------------------------------------------------------------------------------
+{
+    for (;;)
+    {
+        while ((pos < m_Text.size()) && strchr(" \t\n\r", m_Text[pos]) && (m_Text[pos] != '\0'))
+        {
+            pos++;
+        }
+
+        size_t endPos = m_IgnoreComments ? CommentEnd(m_Text, pos) : std::string::npos;
+        if (endPos == std::string::npos)
+        {
+            return pos;
+        }
+        pos = endPos;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * @return The line and column numbers (starting from 1) of a position in the text.
+ **/
+//--------------------------------------------------------------------------------------------------
+Location_t Parser_t::GetLocation
+(
+    size_t pos
+)
+const
+//--------------------------------------------------------------------------------------------------
+{
+    Location_t location;
+
+    location.line = std::count(m_Text.begin(), m_Text.begin() + pos, '\n') + 1;
+
+    size_t lineStart = m_Text.rfind('\n', (pos == 0) ? 0 : (pos - 1));
+    if ((pos == 0) || (lineStart == std::string::npos))
+    {
+        location.column = pos + 1;
+    }
+    else
+    {
+        location.column = pos - lineStart;
+    }
+
+    return location;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Throw an exception for a syntax error at a given position.
+ *
+ * @throw legato::Exception
+ **/
+//--------------------------------------------------------------------------------------------------
+void Parser_t::Error
+(
+    size_t pos,
+    const std::string& message
+)
+const
+//--------------------------------------------------------------------------------------------------
+{
+    throw legato::Exception(ErrorMessage(m_Path, GetLocation(pos), message));
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Throw an exception for a syntax error at the current position if something that is required
+ * wasn't matched.
+ *
+ * @throw legato::Exception
+ **/
+//--------------------------------------------------------------------------------------------------
+void Parser_t::Expect
+(
+    bool isMatched,
+    const std::string& what
+)
+const
+//--------------------------------------------------------------------------------------------------
+{
+    if (!isMatched)
+    {
+        Error(SkipWhitespace(m_Pos), "Expected " + what);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Match a literal piece of text, like "(" or "..".
+ **/
+//--------------------------------------------------------------------------------------------------
+bool Parser_t::MatchLiteral
+(
+    const char* literalPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    size_t pos = SkipWhitespace(m_Pos);
+
+    if (m_Text.compare(pos, strlen(literalPtr), literalPtr) != 0)
+    {
+        return false;
+    }
+
+    m_Pos = pos + strlen(literalPtr);
+    return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Match a keyword, which must not be part of a longer word.
+ **/
+//--------------------------------------------------------------------------------------------------
+bool Parser_t::MatchKeyword
+(
+    const char* keywordPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    size_t pos = SkipWhitespace(m_Pos);
+    size_t len = strlen(keywordPtr);
+
+    if (   (m_Text.compare(pos, len, keywordPtr) != 0)
+        || ((pos > 0) && IsIdentChar(m_Text[pos - 1]))
+        || ((pos + len < m_Text.size()) && IsIdentChar(m_Text[pos + len])) )
+    {
+        return false;
+    }
+
+    m_Pos = pos + len;
+    return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Match an identifier: a letter followed by any number of letters, digits and underscores.
+ **/
+//--------------------------------------------------------------------------------------------------
+bool Parser_t::MatchIdentifier
+(
+    std::string& name
+)
+//--------------------------------------------------------------------------------------------------
+{
+    size_t pos = SkipWhitespace(m_Pos);
+
+    if ((pos >= m_Text.size()) || !isalpha((unsigned char)m_Text[pos]))
+    {
+        return false;
+    }
+
+    size_t endPos = pos + 1;
+    while (   (endPos < m_Text.size())
+           && (isalnum((unsigned char)m_Text[endPos]) || (m_Text[endPos] == '_')) )
+    {
+        endPos++;
+    }
+
+    name = m_Text.substr(pos, endPos - pos);
+    m_Pos = endPos;
+    return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Match a type name, which is an identifier optionally followed by a '.' and another identifier
+ * (for types defined in imported files), with no whitespace in between.
+ **/
+//--------------------------------------------------------------------------------------------------
+bool Parser_t::MatchTypeIdentifier
+(
+    std::string& name
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (!MatchIdentifier(name))
+    {
+        return false;
+    }
+
+    size_t pos = m_Pos;
+    if (   (pos + 1 < m_Text.size())
+        && (m_Text[pos] == '.')
+        && isalpha((unsigned char)m_Text[pos + 1]) )
+    {
+        std::string subName;
+
+        m_Pos = pos + 1;
+        MatchIdentifier(subName);
+        name += "." + subName;
+    }
+
+    return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Match a decimal or hexadecimal number.  As with ifgen, decimal numbers with leading zeros are
+ * octal.
+ *
+ * @param value The value of the number, in decimal.
+ **/
+//--------------------------------------------------------------------------------------------------
+bool Parser_t::MatchNumber
+(
+    std::string& value
+)
+//--------------------------------------------------------------------------------------------------
+{
+    size_t pos = SkipWhitespace(m_Pos);
+    size_t digitsPos = pos;
+    int base = 10;
+
+    if (   (pos + 2 < m_Text.size())
+        && (m_Text[pos] == '0')
+        && ((m_Text[pos + 1] == 'x') || (m_Text[pos + 1] == 'X'))
+        && isxdigit((unsigned char)m_Text[pos + 2]) )
+    {
+        base = 16;
+        digitsPos = pos + 2;
+    }
+    else if ((pos >= m_Text.size()) || !isdigit((unsigned char)m_Text[pos]))
+    {
+        return false;
+    }
+
+    size_t endPos = digitsPos;
+    while (   (endPos < m_Text.size())
+           && ((base == 16) ? isxdigit((unsigned char)m_Text[endPos])
+                            : isdigit((unsigned char)m_Text[endPos])) )
+    {
+        endPos++;
+    }
+
+    if ((base == 10) && (m_Text[pos] == '0') && (endPos - pos > 1))
+    {
+        base = 8;
+        digitsPos++;
+    }
+
+    unsigned long long number = 0;
+    for (size_t i = digitsPos; i < endPos; i++)
+    {
+        char c = tolower(m_Text[i]);
+        int digit = isdigit((unsigned char)c) ? (c - '0') : (c - 'a' + 10);
+
+        if (digit >= base)
+        {
+            Error(pos, "invalid number '" + m_Text.substr(pos, endPos - pos) + "'");
+        }
+        number = number * base + digit;
+    }
+
+    value = std::to_string(number);
+    m_Pos = endPos;
+    return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Match a comment.  Only doxygen comments are left in the text by the time it is parsed.
+ *
+ * @param cStyleOnly true if only C style comments should be matched.
+ **/
+//--------------------------------------------------------------------------------------------------
+bool Parser_t::MatchComment
+(
+    std::string& comment,
+    bool cStyleOnly
+)
+//--------------------------------------------------------------------------------------------------
+{
+    size_t pos = SkipWhitespace(m_Pos);
+    size_t endPos = CommentEnd(m_Text, pos, cStyleOnly);
+
+    if (endPos == std::string::npos)
+    {
+        return false;
+    }
+
+    comment = m_Text.substr(pos, endPos - pos);
+    m_Pos = endPos;
+    return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Match a single or double quoted string.  Within the quotes, a doubled quote stands for the
+ * quote character, and backslash escapes are allowed.
+ *
+ * @param text The string, including the quotes and without processing escapes.
+ **/
+//--------------------------------------------------------------------------------------------------
+bool Parser_t::MatchQuotedString
+(
+    std::string& text
+)
+//--------------------------------------------------------------------------------------------------
+{
+    size_t pos = SkipWhitespace(m_Pos);
+
+    if ((pos >= m_Text.size()) || ((m_Text[pos] != '"') && (m_Text[pos] != '\'')))
+    {
+        return false;
+    }
+
+    char quote = m_Text[pos];
+    size_t endPos = std::string::npos;
+
+    // Position of the last doubled quote, which could also be taken as the closing quote if the
+    // string turns out not to be terminated otherwise.
+    size_t lastDoubledPos = std::string::npos;
+
+    size_t i = pos + 1;
+    while (i < m_Text.size())
+    {
+        char c = m_Text[i];
+
+        if (c == quote)
+        {
+            if ((i + 1 < m_Text.size()) && (m_Text[i + 1] == quote))
+            {
+                lastDoubledPos = i;
+                i += 2;
+            }
+            else
+            {
+                endPos = i + 1;
+                break;
+            }
+        }
+        else if ((c == '\\') && (i + 1 < m_Text.size()) && (m_Text[i + 1] != '\n'))
+        {
+            i += 2;
+        }
+        else if ((c == '\\') || (c == '\n') || (c == '\r'))
+        {
+            break;
+        }
+        else
+        {
+            i++;
+        }
+    }
+
+    if (endPos == std::string::npos)
+    {
+        if (lastDoubledPos == std::string::npos)
+        {
+            return false;
+        }
+        endPos = lastDoubledPos + 1;
+    }
+
+    text = m_Text.substr(pos, endPos - pos);
+    m_Pos = endPos;
+    return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Match a parameter direction: IN or OUT.
+ **/
+//--------------------------------------------------------------------------------------------------
+bool Parser_t::MatchDirection
+(
+    std::string& direction
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (MatchKeyword(legato::api::DirIn))
+    {
+        direction = legato::api::DirIn;
+        return true;
+    }
+
+    if (MatchKeyword(legato::api::DirOut))
+    {
+        direction = legato::api::DirOut;
+        return true;
+    }
+
+    return false;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * @return true if the next thing in the text is a keyword that can be preceded by a comment.
+ **/
+//--------------------------------------------------------------------------------------------------
+bool Parser_t::IsCommentedKeywordNext
+(
+)
+const
+//--------------------------------------------------------------------------------------------------
+{
+    Parser_t lookAhead(*this);
+
+    for (auto keywordPtr : CommentedKeywords)
+    {
+        if (lookAhead.MatchKeyword(keywordPtr))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Match an array or string size: a number or the name of a DEFINE.
+ **/
+//--------------------------------------------------------------------------------------------------
+bool Parser_t::MatchSize
+(
+    Size_t& size
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (MatchTypeIdentifier(size.text))
+    {
+        size.isName = true;
+        return true;
+    }
+
+    if (MatchNumber(size.text))
+    {
+        size.isName = false;
+        return true;
+    }
+
+    return false;
+}
+
+
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Match the name of an imported file, which may have ".api" on the end.
+ *
+ * @param name The name, without the ".api".
+ **/
+//--------------------------------------------------------------------------------------------------
+bool Parser_t::MatchImportName
+(
+    std::string& name
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (!MatchIdentifier(name))
+    {
+        return false;
+    }
+
+    if (m_Text.compare(m_Pos, 4, ".api") == 0)
+    {
+        m_Pos += 4;
+    }
+
+    return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Match an array or string parameter:
+ *
+ *   string NAME [ SIZE_RANGE ] DIRECTION
+ *   TYPE NAME [ SIZE_RANGE ] DIRECTION
+ *
+ * where SIZE_RANGE is either a maximum size, or a minimum and maximum size separated by "..".
+ **/
+//--------------------------------------------------------------------------------------------------
+bool Parser_t::MatchSizedParameter
+(
+    Parameter_t& parm,
+    bool isString
+)
+//--------------------------------------------------------------------------------------------------
+{
+    size_t startPos = m_Pos;
+
+    parm.kind = isString ? Parameter_t::STRING : Parameter_t::ARRAY;
+    parm.type.clear();
+
+    if (   (isString ? MatchKeyword("string") : MatchTypeIdentifier(parm.type))
+        && MatchIdentifier(parm.name)
+        && MatchLiteral("[") )
+    {
+        size_t rangePos = m_Pos;
+
+        parm.hasMinSize = (MatchSize(parm.minSize) && MatchLiteral(".."));
+        if (!parm.hasMinSize)
+        {
+            m_Pos = rangePos;
+        }
+
+        if (MatchSize(parm.maxSize) && MatchLiteral("]") && MatchDirection(parm.direction))
+        {
+            // The minimum size of an OUT array or string is the size given, so a range can't be
+            // given.
+            if (parm.hasMinSize && (parm.direction == legato::api::DirOut))
+            {
+                Error(SkipWhitespace(startPos),
+                      "A size range can't be given for OUT parameter '" + parm.name + "'.");
+            }
+            return true;
+        }
+    }
+
+    m_Pos = startPos;
+    return false;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Match a function parameter.  The forms are tried in this order, and the first one that matches
+ * is used:
+ *
+ *   string NAME [ SIZE_RANGE ] DIRECTION
+ *   TYPE NAME [ SIZE_RANGE ] DIRECTION
+ *   file NAME DIRECTION
+ *   TYPE NAME [ DIRECTION ]
+ **/
+//--------------------------------------------------------------------------------------------------
+bool Parser_t::MatchParameter
+(
+    Parameter_t& parm
+)
+//--------------------------------------------------------------------------------------------------
+{
+    size_t startPos = m_Pos;
+
+    parm.location = GetLocation(SkipWhitespace(m_Pos));
+
+    if (MatchSizedParameter(parm, true) || MatchSizedParameter(parm, false))
+    {
+        return true;
+    }
+
+    parm.hasMinSize = false;
+    parm.type.clear();
+
+    if (MatchKeyword("file") && MatchIdentifier(parm.name) && MatchDirection(parm.direction))
+    {
+        parm.kind = Parameter_t::FILE;
+        return true;
+    }
+
+    m_Pos = startPos;
+    return MatchHandlerParameter(parm);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Match a handler parameter.  These are the same as function parameters, except that files aren't
+ * allowed.
+ **/
+//--------------------------------------------------------------------------------------------------
+bool Parser_t::MatchHandlerParameter
+(
+    Parameter_t& parm
+)
+//--------------------------------------------------------------------------------------------------
+{
+    size_t startPos = m_Pos;
+
+    parm.location = GetLocation(SkipWhitespace(m_Pos));
+
+    if (MatchSizedParameter(parm, true) || MatchSizedParameter(parm, false))
+    {
+        return true;
+    }
+
+    parm.kind = Parameter_t::SIMPLE;
+    parm.hasMinSize = false;
+
+    if (MatchTypeIdentifier(parm.type) && MatchIdentifier(parm.name))
+    {
+        if (!MatchDirection(parm.direction))
+        {
+            parm.direction = legato::api::DirIn;
+        }
+        return true;
+    }
+
+    m_Pos = startPos;
+    return false;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Match an ENUM or BITMASK member.
+ **/
+//--------------------------------------------------------------------------------------------------
+bool Parser_t::MatchEnumMember
+(
+    EnumMember_t& member
+)
+//--------------------------------------------------------------------------------------------------
+{
+    return MatchIdentifier(member.name);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Parse a comma-separated list of items between an opener and a closer.  Each item can be
+ * followed by comments (after the comma, if there is one), which become the item's comment.
+ *
+ * @throw legato::Exception if there is a syntax error.
+ **/
+//--------------------------------------------------------------------------------------------------
+template <class T>
+void Parser_t::ParseList
+(
+    std::list<T>& list,
+    const char* openerPtr,
+    const char* closerPtr,
+    bool allowTrailingSep,
+    bool (Parser_t::*matchFunc)(T&)
+)
+//--------------------------------------------------------------------------------------------------
+{
+    Expect(MatchLiteral(openerPtr), std::string("'") + openerPtr + "'");
+
+    if (MatchLiteral(closerPtr))
+    {
+        return;
+    }
+
+    // Match each item with its comments, and add it to the list.
+    auto matchItem = [&](bool isSeparatorRequired) -> bool
+    {
+        size_t startPos = m_Pos;
+        T item;
+
+        if (!(this->*matchFunc)(item) || (isSeparatorRequired && !MatchLiteral(",")))
+        {
+            m_Pos = startPos;
+            return false;
+        }
+
+        std::string comment;
+        while (MatchComment(comment, false))
+        {
+            item.comment += (item.comment.empty() ? "" : "\n") + comment;
+        }
+
+        list.push_back(item);
+        return true;
+    };
+
+    while (matchItem(true))
+    {
+    }
+
+    if (!matchItem(false) && !allowTrailingSep)
+    {
+        Expect(false, "a list item");
+    }
+
+    Expect(MatchLiteral(closerPtr), std::string("'") + closerPtr + "'");
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Parse the rest of a FUNCTION declaration, after the keyword:
+ *
+ *   [ ONE_WAY ] [ TYPE ] NAME ( PARAMETERS ) ;
+ **/
+//--------------------------------------------------------------------------------------------------
+void Parser_t::ParseFunction
+(
+    Declaration_t& decl
+)
+//--------------------------------------------------------------------------------------------------
+{
+    decl.isOneWay = MatchKeyword("ONE_WAY");
+
+    size_t startPos = m_Pos;
+
+    if (!(MatchTypeIdentifier(decl.type) && MatchIdentifier(decl.name)))
+    {
+        m_Pos = startPos;
+        decl.type.clear();
+        Expect(MatchIdentifier(decl.name), "a function name");
+    }
+
+    ParseList(decl.parmList, "(", ")", false, &Parser_t::MatchParameter);
+
+    Expect(MatchLiteral(";"), "';'");
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Parse the rest of a HANDLER declaration, after the keyword:
+ *
+ *   NAME { [ HANDLER_PARAMS ( PARAMETERS ) ; ] [ ADD_HANDLER_PARAMS ( PARAMETERS ) ; ] } ;
+ *
+ * where the two parameter lists can be in either order.
+ **/
+//--------------------------------------------------------------------------------------------------
+void Parser_t::ParseHandler
+(
+    Declaration_t& decl
+)
+//--------------------------------------------------------------------------------------------------
+{
+    Expect(MatchIdentifier(decl.name), "a handler name");
+    Expect(MatchLiteral("{"), "'{'");
+
+    bool hasHandlerParams = false;
+    bool hasAddHandlerParams = false;
+
+    for (;;)
+    {
+        if (!hasHandlerParams && MatchKeyword("HANDLER_PARAMS"))
+        {
+            ParseList(decl.parmList, "(", ")", false, &Parser_t::MatchHandlerParameter);
+            Expect(MatchLiteral(";"), "';'");
+            hasHandlerParams = true;
+        }
+        else if (!hasAddHandlerParams && MatchKeyword("ADD_HANDLER_PARAMS"))
+        {
+            ParseList(decl.addParmList, "(", ")", false, &Parser_t::MatchHandlerParameter);
+            Expect(MatchLiteral(";"), "';'");
+            hasAddHandlerParams = true;
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    Expect(MatchLiteral("}"), "'}'");
+    Expect(MatchLiteral(";"), "';'");
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Parse the rest of a REFERENCE declaration, after the keyword:
+ *
+ *   NAME ;
+ **/
+//--------------------------------------------------------------------------------------------------
+void Parser_t::ParseReference
+(
+    Declaration_t& decl
+)
+//--------------------------------------------------------------------------------------------------
+{
+    Expect(MatchIdentifier(decl.name), "a reference name");
+    Expect(MatchLiteral(";"), "';'");
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Parse the rest of a DEFINE declaration, after the keyword:
+ *
+ *   NAME = VALUE ;
+ *
+ * where VALUE is a quoted string or an expression.  Expressions are evaluated later.
+ **/
+//--------------------------------------------------------------------------------------------------
+void Parser_t::ParseDefine
+(
+    Declaration_t& decl
+)
+//--------------------------------------------------------------------------------------------------
+{
+    Expect(MatchIdentifier(decl.name), "a definition name");
+    Expect(MatchLiteral("="), "'='");
+
+    decl.isQuoted = MatchQuotedString(decl.value);
+
+    if (!decl.isQuoted)
+    {
+        size_t pos = SkipWhitespace(m_Pos);
+        size_t endPos = std::min(m_Text.find(';', pos), m_Text.size());
+
+        if (endPos == pos)
+        {
+            Error(pos, "Expected a value");
+        }
+
+        decl.value = m_Text.substr(pos, endPos - pos);
+        m_Pos = endPos;
+    }
+
+    Expect(MatchLiteral(";"), "';'");
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Parse the rest of an ENUM or BITMASK declaration, after the keyword:
+ *
+ *   NAME { MEMBERS } ;
+ **/
+//--------------------------------------------------------------------------------------------------
+void Parser_t::ParseEnum
+(
+    Declaration_t& decl
+)
+//--------------------------------------------------------------------------------------------------
+{
+    Expect(MatchIdentifier(decl.name), "a name");
+
+    ParseList(decl.memberList, "{", "}", true, &Parser_t::MatchEnumMember);
+
+    Expect(MatchLiteral(";"), "';'");
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Parse the rest of a USETYPES declaration, after the keyword:
+ *
+ *   NAME[.api] ;
+ **/
+//--------------------------------------------------------------------------------------------------
+void Parser_t::ParseImport
+(
+    Declaration_t& decl
+)
+//--------------------------------------------------------------------------------------------------
+{
+    Expect(MatchImportName(decl.name), "a file name");
+    Expect(MatchLiteral(";"), "';'");
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Parse the whole file: header comments followed by declarations.
+ *
+ * @throw legato::Exception if there is a syntax error.
+ **/
+//--------------------------------------------------------------------------------------------------
+void Parser_t::Parse
+(
+    File_t& file
+)
+//--------------------------------------------------------------------------------------------------
+{
+    // Comments at the start of the file are header comments, unless they belong to a declaration.
+    for (;;)
+    {
+        size_t startPos = m_Pos;
+        std::string comment;
+
+        if (!MatchComment(comment, true) || IsCommentedKeywordNext())
+        {
+            m_Pos = startPos;
+            break;
+        }
+
+        file.headerComments.push_back(comment);
+    }
+
+    while (SkipWhitespace(m_Pos) < m_Text.size())
+    {
+        size_t startPos = m_Pos;
+        Declaration_t decl;
+
+        decl.isQuoted = false;
+        decl.isOneWay = false;
+
+        // Everything but USETYPES can have a comment in front of it.
+        MatchComment(decl.comment, true);
+        decl.location = GetLocation(SkipWhitespace(m_Pos));
+
+        if (MatchKeyword("FUNCTION"))
+        {
+            decl.kind = Declaration_t::FUNCTION;
+            ParseFunction(decl);
+        }
+        else if (MatchKeyword("HANDLER"))
+        {
+            decl.kind = Declaration_t::HANDLER;
+            ParseHandler(decl);
+        }
+        else if (MatchKeyword("REFERENCE"))
+        {
+            decl.kind = Declaration_t::REFERENCE;
+            ParseReference(decl);
+        }
+        else if (MatchKeyword("DEFINE"))
+        {
+            decl.kind = Declaration_t::DEFINE;
+            ParseDefine(decl);
+        }
+        else if (MatchKeyword("ENUM"))
+        {
+            decl.kind = Declaration_t::ENUM;
+            ParseEnum(decl);
+        }
+        else if (MatchKeyword("BITMASK"))
+        {
+            decl.kind = Declaration_t::BITMASK;
+            ParseEnum(decl);
+        }
+        else
+        {
+            size_t keywordPos = SkipWhitespace(m_Pos);
+
+            m_Pos = startPos;
+            decl.comment.clear();
+            decl.location = GetLocation(SkipWhitespace(m_Pos));
+
+            if (!MatchKeyword("USETYPES"))
+            {
+                size_t endPos = keywordPos;
+                while ((endPos < m_Text.size()) && !isspace((unsigned char)m_Text[endPos]))
+                {
+                    endPos++;
+                }
+                Error(keywordPos,
+                      "unknown keyword '" + m_Text.substr(keywordPos, endPos - keywordPos) + "'");
+            }
+
+            decl.kind = Declaration_t::USETYPES;
+            ParseImport(decl);
+        }
+
+        file.declarations.push_back(decl);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Find the USETYPES statements in the text, skipping any that are in comments or that aren't
+ * complete.
+ **/
+//--------------------------------------------------------------------------------------------------
+void Parser_t::ScanImports
+(
+    std::list<std::string>& names
+)
+//--------------------------------------------------------------------------------------------------
+{
+    m_IgnoreComments = true;
+
+    size_t pos = 0;
+    while (pos < m_Text.size())
+    {
+        std::string name;
+
+        m_Pos = SkipWhitespace(pos);
+
+        if (MatchKeyword("USETYPES") && MatchImportName(name) && MatchLiteral(";"))
+        {
+            names.push_back(name);
+            pos = m_Pos;
+        }
+        else
+        {
+            pos = SkipWhitespace(pos) + 1;
+        }
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Parse a .api file.  Each file is only read and parsed once; the result is kept for later
+ * calls.
+ *
+ * @return The contents of the file.
+ *
+ * @throw legato::Exception if the file can't be read or has a syntax error.
+ **/
+//--------------------------------------------------------------------------------------------------
+const File_t& ParseFile
+(
+    const std::string& path
+)
+//--------------------------------------------------------------------------------------------------
+{
+    auto i = ParsedFiles.find(path);
+    if (i != ParsedFiles.end())
+    {
+        return i->second;
+    }
+
+    std::string text = Preprocess(ReadFile(path));
+
+    File_t file;
+    file.path = path;
+
+    Parser_t(path, text).Parse(file);
+
+    return ParsedFiles[path] = file;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the names of the files imported by a .api file, without the ".api".  USETYPES statements
+ * in comments are skipped, but the file is not otherwise checked for errors.
+ *
+ * @return The names, in the order they appear.
+ *
+ * @throw legato::Exception if the file can't be read.
+ **/
+//--------------------------------------------------------------------------------------------------
+const std::list<std::string>& GetImportNames
+(
+    const std::string& path
+)
+//--------------------------------------------------------------------------------------------------
+{
+    auto i = ImportNames.find(path);
+    if (i != ImportNames.end())
+    {
+        return i->second;
+    }
+
+    std::list<std::string> names;
+
+    Parser_t(path, ReadFile(path)).ScanImports(names);
+
+    return ImportNames[path] = names;
+}
+
+
+}   // namespace api
+
+}   // namespace parser
+
+}   // namespace legato
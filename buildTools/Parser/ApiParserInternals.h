@@ -0,0 +1,188 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * Definitions needed by the .api file parser's internals.  Not to be shared outside the parser.
+ *
+ * Parsing is done in two steps.  First, the text of a file is parsed into the declarations
+ * defined here, which don't depend on anything outside the file.  Then, the declarations of the
+ * file and of the files it imports are resolved into an api::Definition_t, which involves
+ * looking up types, evaluating DEFINE expressions, and adding name prefixes.
+ *
+ * Copyright (C) Sierra Wireless, Inc. 2014.  Use of this work is subject to license.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#ifndef API_PARSER_INTERNALS_H_INCLUDE_GUARD
+#define API_PARSER_INTERNALS_H_INCLUDE_GUARD
+
+namespace legato
+{
+
+namespace parser
+{
+
+namespace api
+{
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A location in a .api file, for error messages.
+ **/
+//--------------------------------------------------------------------------------------------------
+struct Location_t
+{
+    size_t line;
+    size_t column;
+};
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A size limit given for an array or string parameter.
+ **/
+//--------------------------------------------------------------------------------------------------
+struct Size_t
+{
+    bool isName;        ///< true if the size is the name of a DEFINE; false if it's a number.
+    std::string text;   ///< The name, or the value of the number in decimal.
+};
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A function or handler parameter declaration.
+ **/
+//--------------------------------------------------------------------------------------------------
+struct Parameter_t
+{
+    enum Kind_t
+    {
+        SIMPLE,
+        ARRAY,
+        STRING,
+        FILE
+    };
+
+    Kind_t kind;
+    std::string type;           ///< .api type name (SIMPLE and ARRAY only).
+    std::string name;
+    std::string direction;      ///< "IN" or "OUT".
+    bool hasMinSize;
+    Size_t minSize;             ///< ARRAY and STRING only, if hasMinSize.
+    Size_t maxSize;             ///< ARRAY and STRING only.
+    std::string comment;        ///< Doxygen comments that followed the parameter.
+    Location_t location;
+};
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * An ENUM or BITMASK member declaration.
+ **/
+//--------------------------------------------------------------------------------------------------
+struct EnumMember_t
+{
+    std::string name;
+    std::string comment;        ///< Doxygen comments that followed the member.
+};
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A top-level declaration.
+ **/
+//--------------------------------------------------------------------------------------------------
+struct Declaration_t
+{
+    enum Kind_t
+    {
+        FUNCTION,
+        HANDLER,
+        REFERENCE,
+        DEFINE,
+        ENUM,
+        BITMASK,
+        USETYPES
+    };
+
+    Kind_t kind;
+    std::string comment;                ///< Doxygen comment in front of the declaration, if any.
+    std::string name;
+    std::string type;                   ///< FUNCTION: .api return type, if any.
+    bool isOneWay;                      ///< FUNCTION: true if declared ONE_WAY.
+    std::list<Parameter_t> parmList;    ///< FUNCTION parameters or HANDLER_PARAMS.
+    std::list<Parameter_t> addParmList; ///< HANDLER: ADD_HANDLER_PARAMS.
+    bool isQuoted;                      ///< DEFINE: true if the value is a quoted string.
+    std::string value;                  ///< DEFINE: the quoted string or the expression.
+    std::list<EnumMember_t> memberList; ///< ENUM and BITMASK.
+    Location_t location;
+};
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * The contents of one .api file.
+ **/
+//--------------------------------------------------------------------------------------------------
+struct File_t
+{
+    std::string path;
+    std::list<std::string> headerComments;  ///< Doxygen comments at the top of the file.
+    std::list<Declaration_t> declarations;
+};
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Parse a .api file.  Each file is only read and parsed once; the result is kept for later
+ * calls.
+ *
+ * @return The contents of the file.
+ *
+ * @throw legato::Exception if the file can't be read or has a syntax error.
+ **/
+//--------------------------------------------------------------------------------------------------
+const File_t& ParseFile
+(
+    const std::string& path
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the names of the files imported by a .api file, without the ".api".  USETYPES statements
+ * in comments are skipped, but the file is not otherwise checked for errors.
+ *
+ * @return The names, in the order they appear.
+ *
+ * @throw legato::Exception if the file can't be read.
+ **/
+//--------------------------------------------------------------------------------------------------
+const std::list<std::string>& GetImportNames
+(
+    const std::string& path
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Make an error message for a location in a .api file, in the format used by GCC.
+ *
+ * @return The message.
+ **/
+//--------------------------------------------------------------------------------------------------
+std::string ErrorMessage
+(
+    const std::string& path,
+    const Location_t& location,
+    const std::string& message
+);
+
+
+}   // namespace api
+
+}   // namespace parser
+
+}   // namespace legato
+
+#endif // API_PARSER_INTERNALS_H_INCLUDE_GUARD
@@ -0,0 +1,1997 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * Resolution of parsed .api files into api::Definition_t objects.
+ *
+ * A .api file is resolved together with all the files it imports (directly or indirectly).  The
+ * imported files are resolved first, in the order ifgen uses, then the file itself.  Resolving
+ * looks up .api type names, evaluates DEFINE expressions (which ifgen evaluates with Python, so
+ * the same subset of Python expression syntax is supported here), and adds name prefixes.
+ *
+ * Copyright (C) Sierra Wireless, Inc. 2014.  Use of this work is subject to license.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "LegatoObjectModel.h"
+#include "Parser.h"
+#include "ApiParserInternals.h"
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+#include <stdint.h>
+#include <sys/stat.h>
+#include <algorithm>
+
+
+namespace legato
+{
+
+namespace parser
+{
+
+namespace api
+{
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Types that are built into the .api language, and their C types.
+ **/
+//--------------------------------------------------------------------------------------------------
+static const std::map<std::string, std::string> BuiltInTypes =
+{
+    { "uint8", "uint8_t" },
+    { "uint16", "uint16_t" },
+    { "uint32", "uint32_t" },
+    { "uint64", "uint64_t" },
+    { "int8", "int8_t" },
+    { "int16", "int16_t" },
+    { "int32", "int32_t" },
+    { "int64", "int64_t" },
+    { "bool", "bool" },
+    { "char", "char" },
+};
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Resolved definitions, by file path, name prefix and import directories.
+ **/
+//--------------------------------------------------------------------------------------------------
+static std::map<std::string, legato::api::Definition_t> Definitions;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * The value of a DEFINE, or of an expression.  Names of imported files evaluate to a namespace
+ * that holds the values DEFINEd in that file.
+ **/
+//--------------------------------------------------------------------------------------------------
+struct Value_t;
+
+typedef std::map<std::string, Value_t> Namespace_t;
+
+struct Value_t
+{
+    enum Kind_t
+    {
+        INT,
+        FLOAT,
+        STRING,
+        NAMESPACE
+    };
+
+    Kind_t kind;
+    __int128 intValue;
+    double floatValue;
+    std::string stringValue;
+    std::shared_ptr<Namespace_t> namespacePtr;
+
+    static Value_t Int(__int128 value);
+    static Value_t Float(double value);
+    static Value_t String(const std::string& value);
+};
+
+
+Value_t Value_t::Int(__int128 value)
+{
+    Value_t result;
+    result.kind = INT;
+    result.intValue = value;
+    return result;
+}
+
+
+Value_t Value_t::Float(double value)
+{
+    Value_t result;
+    result.kind = FLOAT;
+    result.floatValue = value;
+    return result;
+}
+
+
+Value_t Value_t::String(const std::string& value)
+{
+    Value_t result;
+    result.kind = STRING;
+    result.stringValue = value;
+    return result;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Exception thrown when an expression can't be evaluated.  The kinds correspond to the Python
+ * exceptions that ifgen reports differently.
+ **/
+//--------------------------------------------------------------------------------------------------
+struct EvalError_t
+{
+    enum Kind_t
+    {
+        NAME,       ///< Undefined name.
+        SYNTAX,     ///< Syntax error.
+        OTHER       ///< Anything else (type errors, division by zero, etc.)
+    };
+
+    Kind_t kind;
+    std::string name;   ///< The undefined name (NAME only).
+};
+
+
+static void Fail
+(
+    EvalError_t::Kind_t kind,
+    const std::string& name = ""
+)
+{
+    EvalError_t error;
+    error.kind = kind;
+    error.name = name;
+    throw error;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * @return The decimal text of an integer.
+ **/
+//--------------------------------------------------------------------------------------------------
+static std::string IntToString
+(
+    __int128 value
+)
+//--------------------------------------------------------------------------------------------------
+{
+    unsigned __int128 magnitude = (value < 0) ? -(unsigned __int128)value : value;
+    std::string result;
+
+    do
+    {
+        result.insert(result.begin(), '0' + (char)(magnitude % 10));
+        magnitude /= 10;
+    }
+    while (magnitude != 0);
+
+    return (value < 0) ? ("-" + result) : result;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * @return The text of a value, as Python's str() would produce it.
+ **/
+//--------------------------------------------------------------------------------------------------
+static std::string ToString
+(
+    const Value_t& value
+)
+//--------------------------------------------------------------------------------------------------
+{
+    switch (value.kind)
+    {
+        case Value_t::INT:
+            return IntToString(value.intValue);
+
+        case Value_t::FLOAT:
+        {
+            if (isinf(value.floatValue))
+            {
+                return (value.floatValue < 0) ? "-inf" : "inf";
+            }
+            if (isnan(value.floatValue))
+            {
+                return "nan";
+            }
+
+            char buffer[64];
+            snprintf(buffer, sizeof(buffer), "%.12g", value.floatValue);
+
+            std::string result = buffer;
+            if (result.find_first_of(".e") == std::string::npos)
+            {
+                result += ".0";
+            }
+            return result;
+        }
+
+        case Value_t::STRING:
+            return value.stringValue;
+
+        default:
+            // Python would give the address of the object, which is no use to anyone.
+            Fail(EvalError_t::OTHER);
+            return "";
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Evaluator for DEFINE expressions.  Supports the parts of Python 2 expression syntax that are
+ * useful for defining constants: integer, floating point and string literals, names of other
+ * DEFINEs (including "file.NAME" for imported ones), parentheses, and the unary and binary
+ * arithmetic and bitwise operators, with Python's precedence and semantics (e.g., integer division
+ * rounds towards negative infinity).
+ **/
+//--------------------------------------------------------------------------------------------------
+class Evaluator_t
+{
+    public:
+
+        Evaluator_t(const std::string& text, const Namespace_t& globals)
+        :   m_Text(text),
+            m_Globals(globals),
+            m_Pos(0),
+            m_ParenDepth(0)
+        {
+        }
+
+        Value_t Evaluate();
+
+    private:
+
+        enum TokenKind_t
+        {
+            END,
+            NUMBER,
+            STRING,
+            NAME,
+            OP
+        };
+
+        const std::string& m_Text;
+        const Namespace_t& m_Globals;
+        size_t m_Pos;
+        int m_ParenDepth;
+
+        TokenKind_t m_TokenKind;
+        std::string m_Token;        ///< Text of the current NAME or OP token.
+        Value_t m_TokenValue;       ///< Value of the current NUMBER or STRING token.
+
+        void NextToken();
+        void ScanNumber();
+        void ScanString(size_t prefixLen);
+        bool IsOp(const char* opPtr) const;
+
+        Value_t ParseOr();
+        Value_t ParseXor();
+        Value_t ParseAnd();
+        Value_t ParseShift();
+        Value_t ParseArith();
+        Value_t ParseTerm();
+        Value_t ParseFactor();
+        Value_t ParsePower();
+        Value_t ParseAtom();
+};
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * @return true if the current token is the given operator.
+ **/
+//--------------------------------------------------------------------------------------------------
+bool Evaluator_t::IsOp
+(
+    const char* opPtr
+)
+const
+//--------------------------------------------------------------------------------------------------
+{
+    return (m_TokenKind == OP) && (m_Token == opPtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Move on to the next token.
+ **/
+//--------------------------------------------------------------------------------------------------
+void Evaluator_t::NextToken
+(
+)
+//--------------------------------------------------------------------------------------------------
+{
+    // Skip whitespace, comments, line continuations and (inside parentheses) line breaks.
+    for (;;)
+    {
+        while ((m_Pos < m_Text.size()) && strchr(" \t\f", m_Text[m_Pos]) && m_Text[m_Pos])
+        {
+            m_Pos++;
+        }
+
+        if (m_Pos >= m_Text.size())
+        {
+            break;
+        }
+
+        char c = m_Text[m_Pos];
+        if (c == '#')
+        {
+            m_Pos = std::min(m_Text.find_first_of("\r\n", m_Pos), m_Text.size());
+        }
+        else if ((c == '\\') && (m_Pos + 1 < m_Text.size()) && (m_Text[m_Pos + 1] == '\n'))
+        {
+            m_Pos += 2;
+        }
+        else if ((c == '\n') || (c == '\r'))
+        {
+            m_Pos++;
+
+            // Outside of parentheses, a line break ends the expression, so only blank lines and
+            // comments may follow.
+            if (m_ParenDepth == 0)
+            {
+                size_t pos = m_Pos;
+                for (;;)
+                {
+                    pos = m_Text.find_first_not_of(" \t\f\r\n", pos);
+                    if ((pos == std::string::npos) || (m_Text[pos] != '#'))
+                    {
+                        break;
+                    }
+                    pos = m_Text.find_first_of("\r\n", pos);
+                }
+                if (pos != std::string::npos)
+                {
+                    Fail(EvalError_t::SYNTAX);
+                }
+                m_Pos = m_Text.size();
+            }
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    m_Token.clear();
+
+    if (m_Pos >= m_Text.size())
+    {
+        m_TokenKind = END;
+        return;
+    }
+
+    char c = m_Text[m_Pos];
+
+    if (isalpha((unsigned char)c) || (c == '_'))
+    {
+        size_t endPos = m_Pos;
+        while (   (endPos < m_Text.size())
+               && (isalnum((unsigned char)m_Text[endPos]) || (m_Text[endPos] == '_')) )
+        {
+            endPos++;
+        }
+
+        // String literal prefixes.
+        std::string prefix = m_Text.substr(m_Pos, endPos - m_Pos);
+        for (auto& prefixChar : prefix)
+        {
+            prefixChar = tolower(prefixChar);
+        }
+        if (   (endPos < m_Text.size())
+            && ((m_Text[endPos] == '"') || (m_Text[endPos] == '\''))
+            && (   (prefix == "r") || (prefix == "u") || (prefix == "b")
+                || (prefix == "ur") || (prefix == "br") ) )
+        {
+            ScanString(prefix.size());
+            return;
+        }
+
+        m_TokenKind = NAME;
+        m_Token = m_Text.substr(m_Pos, endPos - m_Pos);
+        m_Pos = endPos;
+        return;
+    }
+
+    if (   isdigit((unsigned char)c)
+        || ((c == '.') && (m_Pos + 1 < m_Text.size()) && isdigit((unsigned char)m_Text[m_Pos + 1])))
+    {
+        ScanNumber();
+        return;
+    }
+
+    if ((c == '"') || (c == '\''))
+    {
+        ScanString(0);
+        return;
+    }
+
+    static const char* const operators[] =
+    {
+        "**", "//", "<<", ">>", "+", "-", "*", "/", "%", "&", "|", "^", "~", "(", ")", "."
+    };
+
+    for (auto opPtr : operators)
+    {
+        if (m_Text.compare(m_Pos, strlen(opPtr), opPtr) == 0)
+        {
+            m_TokenKind = OP;
+            m_Token = opPtr;
+            m_Pos += strlen(opPtr);
+
+            if (m_Token == "(")
+            {
+                m_ParenDepth++;
+            }
+            else if (m_Token == ")")
+            {
+                m_ParenDepth--;
+            }
+            return;
+        }
+    }
+
+    // Anything else is either not valid Python, or is Python that isn't supported here (e.g.,
+    // comparisons, function calls, or containers).
+    Fail(strchr("<>=!,[]{}:;@`", c) ? EvalError_t::OTHER : EvalError_t::SYNTAX);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Scan a numeric literal.
+ **/
+//--------------------------------------------------------------------------------------------------
+void Evaluator_t::ScanNumber
+(
+)
+//--------------------------------------------------------------------------------------------------
+{
+    size_t startPos = m_Pos;
+    size_t pos = m_Pos;
+
+    auto digitsEnd = [&](size_t pos, const char* digitsPtr) -> size_t
+    {
+        while ((pos < m_Text.size()) && m_Text[pos] && strchr(digitsPtr, tolower(m_Text[pos])))
+        {
+            pos++;
+        }
+        return pos;
+    };
+
+    m_TokenKind = NUMBER;
+
+    // Integers with a base prefix.
+    if ((m_Text[pos] == '0') && (pos + 1 < m_Text.size()) && strchr("xXoObB", m_Text[pos + 1])
+        && m_Text[pos + 1])
+    {
+        char baseChar = tolower(m_Text[pos + 1]);
+        int base = (baseChar == 'x') ? 16 : ((baseChar == 'o') ? 8 : 2);
+        const char* digitsPtr = (base == 16) ? "0123456789abcdef"
+                                             : ((base == 8) ? "01234567" : "01");
+
+        size_t endPos = digitsEnd(pos + 2, digitsPtr);
+        if (endPos == pos + 2)
+        {
+            Fail(EvalError_t::SYNTAX);
+        }
+
+        __int128 value = 0;
+        for (size_t i = pos + 2; i < endPos; i++)
+        {
+            char c = tolower(m_Text[i]);
+            int digit = isdigit((unsigned char)c) ? (c - '0') : (c - 'a' + 10);
+
+            if (   __builtin_mul_overflow(value, base, &value)
+                || __builtin_add_overflow(value, digit, &value) )
+            {
+                Fail(EvalError_t::OTHER);
+            }
+        }
+
+        if ((endPos < m_Text.size()) && ((m_Text[endPos] == 'l') || (m_Text[endPos] == 'L')))
+        {
+            endPos++;
+        }
+
+        m_TokenValue = Value_t::Int(value);
+        m_Pos = endPos;
+        return;
+    }
+
+    size_t endPos = digitsEnd(pos, "0123456789");
+    bool isFloat = false;
+
+    if ((endPos < m_Text.size()) && (m_Text[endPos] == '.'))
+    {
+        isFloat = true;
+        endPos = digitsEnd(endPos + 1, "0123456789");
+    }
+    if ((endPos < m_Text.size()) && ((m_Text[endPos] == 'e') || (m_Text[endPos] == 'E')))
+    {
+        size_t expPos = endPos + 1;
+        if ((expPos < m_Text.size()) && ((m_Text[expPos] == '+') || (m_Text[expPos] == '-')))
+        {
+            expPos++;
+        }
+
+        size_t expEndPos = digitsEnd(expPos, "0123456789");
+        if (expEndPos == expPos)
+        {
+            Fail(EvalError_t::SYNTAX);
+        }
+
+        isFloat = true;
+        endPos = expEndPos;
+    }
+
+    if ((endPos < m_Text.size()) && ((m_Text[endPos] == 'j') || (m_Text[endPos] == 'J')))
+    {
+        // Complex numbers aren't supported.
+        Fail(EvalError_t::OTHER);
+    }
+
+    std::string text = m_Text.substr(startPos, endPos - startPos);
+
+    if (isFloat)
+    {
+        m_TokenValue = Value_t::Float(strtod(text.c_str(), NULL));
+    }
+    else
+    {
+        // In Python 2, a leading zero means octal.
+        int base = 10;
+        if ((text.size() > 1) && (text[0] == '0'))
+        {
+            base = 8;
+        }
+
+        __int128 value = 0;
+        for (auto c : text)
+        {
+            int digit = c - '0';
+            if (digit >= base)
+            {
+                Fail(EvalError_t::SYNTAX);
+            }
+            if (   __builtin_mul_overflow(value, base, &value)
+                || __builtin_add_overflow(value, digit, &value) )
+            {
+                Fail(EvalError_t::OTHER);
+            }
+        }
+
+        if ((endPos < m_Text.size()) && ((m_Text[endPos] == 'l') || (m_Text[endPos] == 'L')))
+        {
+            endPos++;
+        }
+
+        m_TokenValue = Value_t::Int(value);
+    }
+
+    m_Pos = endPos;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Scan a string literal, after any prefix characters (which have the given length).
+ **/
+//--------------------------------------------------------------------------------------------------
+void Evaluator_t::ScanString
+(
+    size_t prefixLen
+)
+//--------------------------------------------------------------------------------------------------
+{
+    std::string prefix = m_Text.substr(m_Pos, prefixLen);
+    bool isRaw = (prefix.find_first_of("rR") != std::string::npos);
+
+    size_t pos = m_Pos + prefixLen;
+    char quote = m_Text[pos];
+    bool isTriple = (m_Text.compare(pos, 3, std::string(3, quote)) == 0);
+    size_t quoteLen = isTriple ? 3 : 1;
+    std::string closer(quoteLen, quote);
+
+    pos += quoteLen;
+
+    std::string value;
+
+    for (;;)
+    {
+        if (pos >= m_Text.size())
+        {
+            Fail(EvalError_t::SYNTAX);
+        }
+
+        char c = m_Text[pos];
+
+        if (m_Text.compare(pos, quoteLen, closer) == 0)
+        {
+            pos += quoteLen;
+            break;
+        }
+
+        if (((c == '\n') || (c == '\r')) && !isTriple)
+        {
+            Fail(EvalError_t::SYNTAX);
+        }
+
+        if ((c != '\\') || (pos + 1 >= m_Text.size()))
+        {
+            value += c;
+            pos++;
+            continue;
+        }
+
+        char next = m_Text[pos + 1];
+        pos += 2;
+
+        if (isRaw)
+        {
+            value += c;
+            value += next;
+            continue;
+        }
+
+        switch (next)
+        {
+            case '\n':  break;
+            case '\\':  value += '\\'; break;
+            case '\'':  value += '\''; break;
+            case '"':   value += '"'; break;
+            case 'a':   value += '\a'; break;
+            case 'b':   value += '\b'; break;
+            case 'f':   value += '\f'; break;
+            case 'n':   value += '\n'; break;
+            case 'r':   value += '\r'; break;
+            case 't':   value += '\t'; break;
+            case 'v':   value += '\v'; break;
+
+            case 'x':
+                if (   (pos + 1 >= m_Text.size())
+                    || !isxdigit((unsigned char)m_Text[pos])
+                    || !isxdigit((unsigned char)m_Text[pos + 1]) )
+                {
+                    Fail(EvalError_t::OTHER);
+                }
+                value += (char)strtol(m_Text.substr(pos, 2).c_str(), NULL, 16);
+                pos += 2;
+                break;
+
+            default:
+                if ((next >= '0') && (next <= '7'))
+                {
+                    int number = next - '0';
+                    for (int i = 0; (i < 2) && (pos < m_Text.size()); i++, pos++)
+                    {
+                        if ((m_Text[pos] < '0') || (m_Text[pos] > '7'))
+                        {
+                            break;
+                        }
+                        number = number * 8 + (m_Text[pos] - '0');
+                    }
+                    value += (char)number;
+                }
+                else
+                {
+                    // Unknown escapes are left alone.
+                    value += c;
+                    value += next;
+                }
+                break;
+        }
+    }
+
+    m_TokenKind = STRING;
+    m_TokenValue = Value_t::String(value);
+    m_Pos = pos;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Evaluate the whole expression.
+ *
+ * @return The value.
+ *
+ * @throw EvalError_t if the expression can't be evaluated.
+ **/
+//--------------------------------------------------------------------------------------------------
+Value_t Evaluator_t::Evaluate
+(
+)
+//--------------------------------------------------------------------------------------------------
+{
+    // Like Python's eval(), ignore leading spaces and tabs.
+    m_Pos = std::min(m_Text.find_first_not_of(" \t"), m_Text.size());
+
+    NextToken();
+
+    Value_t result = ParseOr();
+
+    if (m_TokenKind != END)
+    {
+        Fail(EvalError_t::SYNTAX);
+    }
+
+    return result;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * @return The integer value of an operand of a bitwise operator.
+ **/
+//--------------------------------------------------------------------------------------------------
+static __int128 IntOperand
+(
+    const Value_t& value
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (value.kind != Value_t::INT)
+    {
+        Fail(EvalError_t::OTHER);
+    }
+
+    return value.intValue;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * @return The floating point value of an operand of an arithmetic operator.
+ **/
+//--------------------------------------------------------------------------------------------------
+static double FloatOperand
+(
+    const Value_t& value
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (value.kind == Value_t::INT)
+    {
+        return (double)value.intValue;
+    }
+    if (value.kind != Value_t::FLOAT)
+    {
+        Fail(EvalError_t::OTHER);
+    }
+
+    return value.floatValue;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * @return true if both operands are numbers and at least one is floating point.
+ **/
+//--------------------------------------------------------------------------------------------------
+static bool IsFloatOperation
+(
+    const Value_t& left,
+    const Value_t& right
+)
+//--------------------------------------------------------------------------------------------------
+{
+    return (   ((left.kind == Value_t::FLOAT) || (right.kind == Value_t::FLOAT))
+            && (left.kind != Value_t::STRING) && (right.kind != Value_t::STRING) );
+}
+
+
+Value_t Evaluator_t::ParseOr()
+{
+    Value_t result = ParseXor();
+
+    while (IsOp("|"))
+    {
+        NextToken();
+        result = Value_t::Int(IntOperand(result) | IntOperand(ParseXor()));
+    }
+
+    return result;
+}
+
+
+Value_t Evaluator_t::ParseXor()
+{
+    Value_t result = ParseAnd();
+
+    while (IsOp("^"))
+    {
+        NextToken();
+        result = Value_t::Int(IntOperand(result) ^ IntOperand(ParseAnd()));
+    }
+
+    return result;
+}
+
+
+Value_t Evaluator_t::ParseAnd()
+{
+    Value_t result = ParseShift();
+
+    while (IsOp("&"))
+    {
+        NextToken();
+        result = Value_t::Int(IntOperand(result) & IntOperand(ParseShift()));
+    }
+
+    return result;
+}
+
+
+Value_t Evaluator_t::ParseShift()
+{
+    Value_t result = ParseArith();
+
+    while (IsOp("<<") || IsOp(">>"))
+    {
+        bool isLeft = IsOp("<<");
+        NextToken();
+
+        __int128 value = IntOperand(result);
+        __int128 shift = IntOperand(ParseArith());
+
+        if (shift < 0)
+        {
+            Fail(EvalError_t::OTHER);
+        }
+
+        if (isLeft)
+        {
+            for (__int128 i = 0; (i < shift) && (value != 0); i++)
+            {
+                if (__builtin_mul_overflow(value, 2, &value))
+                {
+                    Fail(EvalError_t::OTHER);
+                }
+            }
+        }
+        else
+        {
+            // Arithmetic shift, which rounds towards negative infinity like Python does.
+            value = (shift >= 127) ? ((value < 0) ? -1 : 0) : (value >> (int)shift);
+        }
+
+        result = Value_t::Int(value);
+    }
+
+    return result;
+}
+
+
+Value_t Evaluator_t::ParseArith()
+{
+    Value_t result = ParseTerm();
+
+    while (IsOp("+") || IsOp("-"))
+    {
+        bool isAdd = IsOp("+");
+        NextToken();
+
+        Value_t right = ParseTerm();
+
+        if (isAdd && (result.kind == Value_t::STRING) && (right.kind == Value_t::STRING))
+        {
+            result.stringValue += right.stringValue;
+        }
+        else if (IsFloatOperation(result, right))
+        {
+            double left = FloatOperand(result);
+            result = Value_t::Float(isAdd ? (left + FloatOperand(right))
+                                          : (left - FloatOperand(right)));
+        }
+        else
+        {
+            __int128 value;
+            if (isAdd ? __builtin_add_overflow(IntOperand(result), IntOperand(right), &value)
+                      : __builtin_sub_overflow(IntOperand(result), IntOperand(right), &value))
+            {
+                Fail(EvalError_t::OTHER);
+            }
+            result = Value_t::Int(value);
+        }
+    }
+
+    return result;
+}
+
+
+Value_t Evaluator_t::ParseTerm()
+{
+    Value_t result = ParseFactor();
+
+    while (IsOp("*") || IsOp("/") || IsOp("//") || IsOp("%"))
+    {
+        std::string op = m_Token;
+        NextToken();
+
+        Value_t right = ParseFactor();
+
+        if (op == "*")
+        {
+            // Repeating a string.
+            if ((result.kind == Value_t::STRING) != (right.kind == Value_t::STRING))
+            {
+                const Value_t& text = (result.kind == Value_t::STRING) ? result : right;
+                __int128 count = IntOperand((result.kind == Value_t::STRING) ? right : result);
+
+                std::string value;
+                for (__int128 i = 0; i < count; i++)
+                {
+                    value += text.stringValue;
+                }
+                result = Value_t::String(value);
+            }
+            else if (IsFloatOperation(result, right))
+            {
+                result = Value_t::Float(FloatOperand(result) * FloatOperand(right));
+            }
+            else
+            {
+                __int128 value;
+                if (__builtin_mul_overflow(IntOperand(result), IntOperand(right), &value))
+                {
+                    Fail(EvalError_t::OTHER);
+                }
+                result = Value_t::Int(value);
+            }
+        }
+        else if (IsFloatOperation(result, right))
+        {
+            double left = FloatOperand(result);
+            double divisor = FloatOperand(right);
+
+            if (divisor == 0)
+            {
+                Fail(EvalError_t::OTHER);
+            }
+
+            if (op == "/")
+            {
+                result = Value_t::Float(left / divisor);
+            }
+            else if (op == "//")
+            {
+                result = Value_t::Float(floor(left / divisor));
+            }
+            else
+            {
+                double remainder = fmod(left, divisor);
+                if ((remainder != 0) && ((remainder < 0) != (divisor < 0)))
+                {
+                    remainder += divisor;
+                }
+                result = Value_t::Float(remainder);
+            }
+        }
+        else
+        {
+            // In Python 2, '/' on integers is the same as '//'.  Both round towards negative
+            // infinity, and the remainder has the sign of the divisor.
+            __int128 left = IntOperand(result);
+            __int128 divisor = IntOperand(right);
+
+            if (divisor == 0)
+            {
+                Fail(EvalError_t::OTHER);
+            }
+
+            __int128 quotient = left / divisor;
+            __int128 remainder = left % divisor;
+            if ((remainder != 0) && ((remainder < 0) != (divisor < 0)))
+            {
+                quotient--;
+                remainder += divisor;
+            }
+
+            result = Value_t::Int((op == "%") ? remainder : quotient);
+        }
+    }
+
+    return result;
+}
+
+
+Value_t Evaluator_t::ParseFactor()
+{
+    if (IsOp("-") || IsOp("+") || IsOp("~"))
+    {
+        std::string op = m_Token;
+        NextToken();
+
+        Value_t operand = ParseFactor();
+
+        if (op == "~")
+        {
+            return Value_t::Int(~IntOperand(operand));
+        }
+        if (operand.kind == Value_t::FLOAT)
+        {
+            return (op == "-") ? Value_t::Float(-operand.floatValue) : operand;
+        }
+        return (op == "-") ? Value_t::Int(-IntOperand(operand)) : Value_t::Int(IntOperand(operand));
+    }
+
+    return ParsePower();
+}
+
+
+Value_t Evaluator_t::ParsePower()
+{
+    Value_t result = ParseAtom();
+
+    // Attribute references, for values DEFINEd in imported files.
+    while (IsOp("."))
+    {
+        NextToken();
+        if (m_TokenKind != NAME)
+        {
+            Fail(EvalError_t::SYNTAX);
+        }
+        if (result.kind != Value_t::NAMESPACE)
+        {
+            Fail(EvalError_t::OTHER);
+        }
+
+        auto i = result.namespacePtr->find(m_Token);
+        if (i == result.namespacePtr->end())
+        {
+            Fail(EvalError_t::OTHER);
+        }
+
+        result = i->second;
+        NextToken();
+    }
+
+    if (IsOp("**"))
+    {
+        NextToken();
+
+        Value_t exponent = ParseFactor();
+
+        if (   IsFloatOperation(result, exponent)
+            || ((exponent.kind == Value_t::INT) && (exponent.intValue < 0)) )
+        {
+            double base = FloatOperand(result);
+            if ((base == 0) && (FloatOperand(exponent) < 0))
+            {
+                Fail(EvalError_t::OTHER);
+            }
+            result = Value_t::Float(pow(base, FloatOperand(exponent)));
+        }
+        else
+        {
+            __int128 base = IntOperand(result);
+            __int128 count = IntOperand(exponent);
+            __int128 value = 1;
+
+            for (__int128 i = 0; i < count; i++)
+            {
+                if (__builtin_mul_overflow(value, base, &value))
+                {
+                    Fail(EvalError_t::OTHER);
+                }
+                if ((value == 0) || (value == 1))
+                {
+                    break;
+                }
+            }
+            result = Value_t::Int(value);
+        }
+    }
+
+    return result;
+}
+
+
+Value_t Evaluator_t::ParseAtom()
+{
+    Value_t result;
+
+    switch (m_TokenKind)
+    {
+        case NUMBER:
+            result = m_TokenValue;
+            NextToken();
+            return result;
+
+        case STRING:
+            // Adjacent string literals are joined.
+            result = m_TokenValue;
+            NextToken();
+            while (m_TokenKind == STRING)
+            {
+                result.stringValue += m_TokenValue.stringValue;
+                NextToken();
+            }
+            return result;
+
+        case NAME:
+        {
+            static const std::set<std::string> keywords =
+            {
+                "and", "as", "assert", "break", "class", "continue", "def", "del", "elif",
+                "else", "except", "exec", "finally", "for", "from", "global", "if", "import",
+                "in", "is", "lambda", "not", "or", "pass", "print", "raise", "return", "try",
+                "while", "with", "yield"
+            };
+
+            if (keywords.find(m_Token) != keywords.end())
+            {
+                Fail(EvalError_t::SYNTAX);
+            }
+
+            auto i = m_Globals.find(m_Token);
+            if (i == m_Globals.end())
+            {
+                Fail(EvalError_t::NAME, m_Token);
+            }
+
+            result = i->second;
+            NextToken();
+            return result;
+        }
+
+        case OP:
+            if (IsOp("("))
+            {
+                NextToken();
+                if (IsOp(")"))
+                {
+                    // Empty tuple.
+                    Fail(EvalError_t::OTHER);
+                }
+
+                result = ParseOr();
+
+                if (!IsOp(")"))
+                {
+                    Fail(EvalError_t::SYNTAX);
+                }
+                NextToken();
+                return result;
+            }
+            break;
+
+        default:
+            break;
+    }
+
+    Fail(EvalError_t::SYNTAX);
+    return result;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Compute the SHA-256 digest of some text.
+ *
+ * @return The digest, in lower-case hex.
+ **/
+//--------------------------------------------------------------------------------------------------
+static std::string Sha256
+(
+    const std::string& text
+)
+//--------------------------------------------------------------------------------------------------
+{
+    static const uint32_t k[64] =
+    {
+        0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4,
+        0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe,
+        0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f,
+        0x4a7484aa, 0x5cb0a9dc, 0x76f988da, 0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7,
+        0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc,
+        0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85, 0xa2bfe8a1, 0xa81a664b,
+        0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070, 0x19a4c116,
+        0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+        0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7,
+        0xc67178f2
+    };
+
+    uint32_t h[8] =
+    {
+        0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+        0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+    };
+
+    // Pad the message to a multiple of 64 bytes: a 1 bit, zeros, then the length in bits.
+    std::string message = text;
+    uint64_t numBits = (uint64_t)text.size() * 8;
+
+    message += (char)0x80;
+    while ((message.size() % 64) != 56)
+    {
+        message += (char)0;
+    }
+    for (int i = 7; i >= 0; i--)
+    {
+        message += (char)((numBits >> (i * 8)) & 0xff);
+    }
+
+    auto rotate = [](uint32_t x, int n) { return (x >> n) | (x << (32 - n)); };
+
+    for (size_t chunk = 0; chunk < message.size(); chunk += 64)
+    {
+        uint32_t w[64];
+
+        for (int i = 0; i < 16; i++)
+        {
+            w[i] = 0;
+            for (int j = 0; j < 4; j++)
+            {
+                w[i] = (w[i] << 8) | (uint8_t)message[chunk + i * 4 + j];
+            }
+        }
+        for (int i = 16; i < 64; i++)
+        {
+            uint32_t s0 = rotate(w[i - 15], 7) ^ rotate(w[i - 15], 18) ^ (w[i - 15] >> 3);
+            uint32_t s1 = rotate(w[i - 2], 17) ^ rotate(w[i - 2], 19) ^ (w[i - 2] >> 10);
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+        }
+
+        uint32_t a[8];
+        std::copy(h, h + 8, a);
+
+        for (int i = 0; i < 64; i++)
+        {
+            uint32_t s1 = rotate(a[4], 6) ^ rotate(a[4], 11) ^ rotate(a[4], 25);
+            uint32_t choice = (a[4] & a[5]) ^ (~a[4] & a[6]);
+            uint32_t temp1 = a[7] + s1 + choice + k[i] + w[i];
+            uint32_t s0 = rotate(a[0], 2) ^ rotate(a[0], 13) ^ rotate(a[0], 22);
+            uint32_t majority = (a[0] & a[1]) ^ (a[0] & a[2]) ^ (a[1] & a[2]);
+            uint32_t temp2 = s0 + majority;
+
+            std::copy_backward(a, a + 7, a + 8);
+            a[4] += temp1;
+            a[0] = temp1 + temp2;
+        }
+
+        for (int i = 0; i < 8; i++)
+        {
+            h[i] += a[i];
+        }
+    }
+
+    std::string result;
+    for (auto word : h)
+    {
+        char buffer[9];
+        snprintf(buffer, sizeof(buffer), "%08x", word);
+        result += buffer;
+    }
+
+    return result;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Path functions that behave like Python's os.path functions, so that paths come out the same as
+ * ifgen's (they are used in generated #include directives and in messages).
+ **/
+//--------------------------------------------------------------------------------------------------
+static std::string PyDirName
+(
+    const std::string& path
+)
+//--------------------------------------------------------------------------------------------------
+{
+    size_t slashPos = path.rfind('/');
+    if (slashPos == std::string::npos)
+    {
+        return "";
+    }
+
+    std::string head = path.substr(0, slashPos + 1);
+
+    // Trailing slashes are removed, unless the head is nothing but slashes.
+    if (head.find_first_not_of('/') != std::string::npos)
+    {
+        head.erase(head.find_last_not_of('/') + 1);
+    }
+
+    return head;
+}
+
+
+static std::string PyBaseName
+(
+    const std::string& path
+)
+//--------------------------------------------------------------------------------------------------
+{
+    size_t slashPos = path.rfind('/');
+
+    return (slashPos == std::string::npos) ? path : path.substr(slashPos + 1);
+}
+
+
+static std::string PyJoin
+(
+    const std::string& dir,
+    const std::string& name
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (dir.empty() || (dir[dir.size() - 1] == '/'))
+    {
+        return dir + name;
+    }
+
+    return dir + "/" + name;
+}
+
+
+static std::string StripExtension
+(
+    const std::string& name
+)
+//--------------------------------------------------------------------------------------------------
+{
+    size_t dotPos = name.rfind('.');
+
+    if ((dotPos == std::string::npos) || (name.find_first_not_of('.') >= dotPos))
+    {
+        return name;
+    }
+
+    return name.substr(0, dotPos);
+}
+
+
+static bool IsFile
+(
+    const std::string& path
+)
+//--------------------------------------------------------------------------------------------------
+{
+    struct stat fileInfo;
+
+    return (stat(path.c_str(), &fileInfo) == 0) && S_ISREG(fileInfo.st_mode);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Make the list of files imported by a .api file, including those imported indirectly, in the
+ * order in which they need to be processed (files are processed before the files that import
+ * them).
+ *
+ * @throw legato::Exception if an imported file can't be found.
+ **/
+//--------------------------------------------------------------------------------------------------
+static std::list<std::string> MakeImportList
+(
+    const std::string& filePath,
+    const std::list<std::string>& importDirs,
+    std::list<std::string>& importStack     ///< Files being processed, to catch import loops.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    std::list<std::string> pathList;
+
+    importStack.push_back(filePath);
+
+    for (const auto& name : GetImportNames(filePath))
+    {
+        std::string fileName = name + ".api";
+        std::string path;
+
+        for (const auto& dir : importDirs)
+        {
+            if (IsFile(PyJoin(dir, fileName)))
+            {
+                path = PyJoin(dir, fileName);
+                break;
+            }
+        }
+
+        if (path.empty())
+        {
+            std::string dirList;
+            for (const auto& dir : importDirs)
+            {
+                dirList += (dirList.empty() ? "'" : ", '") + dir + "'";
+            }
+
+            throw legato::Exception("'" + fileName + "' not found in [" + dirList + "]");
+        }
+
+        if (std::find(importStack.begin(), importStack.end(), path) != importStack.end())
+        {
+            throw legato::Exception("'" + filePath + "' is part of a loop of USETYPES "
+                                    "statements that includes '" + path + "'.");
+        }
+
+        // Files imported by the imported file are processed first.
+        pathList.push_back(path);
+        pathList.splice(pathList.begin(), MakeImportList(path, importDirs, importStack));
+    }
+
+    importStack.pop_back();
+
+    // Remove any duplicates, keeping the first.
+    std::list<std::string> result;
+    std::set<std::string> paths;
+
+    for (const auto& path : pathList)
+    {
+        if (paths.insert(path).second)
+        {
+            result.push_back(path);
+        }
+    }
+
+    return result;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Resolves the contents of the files that make up one api::Definition_t.
+ **/
+//--------------------------------------------------------------------------------------------------
+class Resolver_t
+{
+    public:
+
+        Resolver_t(legato::api::Definition_t& definition)
+        :   m_Definition(definition),
+            m_FilePtr(NULL)
+        {
+        }
+
+        void ResolveFile(const File_t& file,
+                         const std::string& importName,
+                         const std::string& namePrefix,
+                         legato::api::CodeList_t& codeList);
+
+    private:
+
+        legato::api::Definition_t& m_Definition;
+        Namespace_t m_Values;           ///< Values of DEFINEs in the file and imported files.
+        const File_t* m_FilePtr;        ///< File being resolved.
+        std::string m_ImportName;       ///< Name of the file being resolved, if imported.
+        std::string m_NamePrefix;
+
+        void AddType(const std::string& apiType, const std::string& cType);
+        void AddValue(const std::string& name, const Value_t& value);
+        Value_t Evaluate(const std::string& expression, const Location_t& location);
+        std::string EvaluateSize(const Size_t& size, const Location_t& location);
+
+        legato::api::ParameterPtr_t ResolveParameter(const Parameter_t& parm);
+        legato::api::ParameterList_t ResolveParameterList(const std::list<Parameter_t>& parmList);
+};
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add a type that was declared in the file being resolved.  Types from imported files are
+ * referred to as "file.type".
+ **/
+//--------------------------------------------------------------------------------------------------
+void Resolver_t::AddType
+(
+    const std::string& apiType,
+    const std::string& cType
+)
+//--------------------------------------------------------------------------------------------------
+{
+    std::string name = m_ImportName.empty() ? apiType : (m_ImportName + "." + apiType);
+
+    if (!m_Definition.types.insert(std::make_pair(name, cType)).second)
+    {
+        m_Definition.messages += "ERROR: " + name + " already defined as " + cType + "\n";
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add a DEFINEd value.  Values from an imported file go in a namespace named after the file,
+ * which also gets (at the time it is created) the namespaces of the files imported before it.
+ **/
+//--------------------------------------------------------------------------------------------------
+void Resolver_t::AddValue
+(
+    const std::string& name,
+    const Value_t& value
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (m_ImportName.empty())
+    {
+        m_Values[name] = value;
+        return;
+    }
+
+    auto i = m_Values.find(m_ImportName);
+    if (i == m_Values.end())
+    {
+        Value_t namespaceValue;
+        namespaceValue.kind = Value_t::NAMESPACE;
+        namespaceValue.namespacePtr = std::make_shared<Namespace_t>();
+
+        for (const auto& entry : m_Values)
+        {
+            if (entry.second.kind == Value_t::NAMESPACE)
+            {
+                namespaceValue.namespacePtr->insert(entry);
+            }
+        }
+
+        i = m_Values.insert(std::make_pair(m_ImportName, namespaceValue)).first;
+    }
+
+    (*i->second.namespacePtr)[name] = value;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Evaluate an expression, using the values DEFINEd so far.
+ *
+ * @return The value.
+ *
+ * @throw legato::Exception if the expression can't be evaluated.
+ **/
+//--------------------------------------------------------------------------------------------------
+Value_t Resolver_t::Evaluate
+(
+    const std::string& expression,
+    const Location_t& location
+)
+//--------------------------------------------------------------------------------------------------
+{
+    // Expressions in an imported file are evaluated in that file's namespace, once it has one.
+    const Namespace_t* globalsPtr = &m_Values;
+    if (!m_ImportName.empty())
+    {
+        auto i = m_Values.find(m_ImportName);
+        if ((i != m_Values.end()) && (i->second.kind == Value_t::NAMESPACE))
+        {
+            globalsPtr = i->second.namespacePtr.get();
+        }
+    }
+
+    std::string text = expression;
+    text.erase(0, std::min(text.find_first_not_of(" \t\n\r"), text.size()));
+    text.erase(text.find_last_not_of(" \t\n\r") + 1);
+
+    try
+    {
+        Value_t result = Evaluator_t(expression, *globalsPtr).Evaluate();
+
+        // The value has to be printable.
+        ToString(result);
+
+        return result;
+    }
+    catch (EvalError_t& error)
+    {
+        std::string message;
+
+        switch (error.kind)
+        {
+            case EvalError_t::NAME:
+                message = "name error in expression '" + text + "' : name '" + error.name
+                        + "' is not defined";
+                break;
+
+            case EvalError_t::SYNTAX:
+                message = "syntax error in expression '" + text + "'";
+                break;
+
+            default:
+                message = "unknown error in expression '" + text + "'";
+                break;
+        }
+
+        throw legato::Exception(ErrorMessage(m_FilePtr->path, location, message));
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the text of an array or string size.
+ *
+ * @throw legato::Exception if the size is a name that can't be evaluated.
+ **/
+//--------------------------------------------------------------------------------------------------
+std::string Resolver_t::EvaluateSize
+(
+    const Size_t& size,
+    const Location_t& location
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (!size.isName)
+    {
+        return size.text;
+    }
+
+    return ToString(Evaluate(size.text, location));
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Create a function or handler parameter from its declaration.
+ *
+ * @throw legato::Exception if the parameter is not valid.
+ **/
+//--------------------------------------------------------------------------------------------------
+legato::api::ParameterPtr_t Resolver_t::ResolveParameter
+(
+    const Parameter_t& parm
+)
+//--------------------------------------------------------------------------------------------------
+{
+    legato::api::ParameterPtr_t parmPtr;
+    bool isIn = (parm.direction == legato::api::DirIn);
+
+    switch (parm.kind)
+    {
+        case Parameter_t::SIMPLE:
+            if (isIn)
+            {
+                parmPtr = legato::api::NewSimpleParameter(parm.name,
+                                                          m_Definition.ConvertType(parm.type));
+            }
+            else
+            {
+                parmPtr = legato::api::NewPointerParameter(parm.name,
+                                                           m_Definition.ConvertType(parm.type),
+                                                           parm.direction);
+            }
+            break;
+
+        case Parameter_t::FILE:
+            parmPtr = legato::api::NewFileParameter(parm.name, parm.direction);
+            break;
+
+        case Parameter_t::ARRAY:
+        case Parameter_t::STRING:
+        {
+            // The size given for an OUT parameter is the minimum size of the caller's buffer.
+            std::string maxSize;
+            std::string minSize;
+            bool hasMaxSize = isIn;
+            bool hasMinSize = !isIn || parm.hasMinSize;
+
+            if (isIn)
+            {
+                maxSize = EvaluateSize(parm.maxSize, parm.location);
+                if (parm.hasMinSize)
+                {
+                    minSize = EvaluateSize(parm.minSize, parm.location);
+                }
+            }
+            else
+            {
+                minSize = EvaluateSize(parm.maxSize, parm.location);
+            }
+
+            if (parm.kind == Parameter_t::ARRAY)
+            {
+                parmPtr = legato::api::NewArrayParameter(parm.name,
+                                                         m_Definition.ConvertType(parm.type),
+                                                         parm.direction,
+                                                         hasMaxSize ? &maxSize : NULL,
+                                                         hasMinSize ? &minSize : NULL);
+            }
+            else
+            {
+                try
+                {
+                    parmPtr = legato::api::NewStringParameter(parm.name,
+                                                              parm.direction,
+                                                              hasMaxSize ? &maxSize : NULL,
+                                                              hasMinSize ? &minSize : NULL);
+                }
+                catch (legato::Exception& e)
+                {
+                    throw legato::Exception(ErrorMessage(m_FilePtr->path, parm.location, e.what()));
+                }
+            }
+            break;
+        }
+    }
+
+    parmPtr->comment = parm.comment;
+
+    return parmPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Create a function or handler parameter list from its declaration.  An empty list gets a single
+ * void parameter.
+ *
+ * @throw legato::Exception if a parameter is not valid.
+ **/
+//--------------------------------------------------------------------------------------------------
+legato::api::ParameterList_t Resolver_t::ResolveParameterList
+(
+    const std::list<Parameter_t>& parmList
+)
+//--------------------------------------------------------------------------------------------------
+{
+    legato::api::ParameterList_t result;
+
+    for (const auto& parm : parmList)
+    {
+        result.push_back(ResolveParameter(parm));
+    }
+
+    if (result.empty())
+    {
+        result.push_back(legato::api::NewVoidParameter());
+    }
+
+    return result;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Resolve the declarations in a file, adding the resulting code items to a list.
+ *
+ * @throw legato::Exception if there's an error.
+ **/
+//--------------------------------------------------------------------------------------------------
+void Resolver_t::ResolveFile
+(
+    const File_t& file,
+    const std::string& importName,  ///< Name of the file, if imported, or empty if not.
+    const std::string& namePrefix,
+    legato::api::CodeList_t& codeList
+)
+//--------------------------------------------------------------------------------------------------
+{
+    using namespace legato::api;
+
+    m_FilePtr = &file;
+    m_ImportName = importName;
+    m_NamePrefix = namePrefix;
+
+    for (const auto& decl : file.declarations)
+    {
+        switch (decl.kind)
+        {
+            case Declaration_t::FUNCTION:
+            {
+                auto parmList = ResolveParameterList(decl.parmList);
+                std::string type = m_Definition.ConvertType(decl.type.empty() ? "void" : decl.type);
+
+                // The client doesn't wait for a one-way function, so there is nothing to send
+                // back to it.
+                if (decl.isOneWay)
+                {
+                    bool hasOutParm = false;
+
+                    for (const auto& parm : decl.parmList)
+                    {
+                        hasOutParm = hasOutParm || (parm.direction == DirOut);
+                    }
+
+                    if (!decl.type.empty() || hasOutParm)
+                    {
+                        throw legato::Exception(ErrorMessage(m_FilePtr->path,
+                                                             decl.location,
+                                                             "ONE_WAY function '" + decl.name
+                                                             + "' can't have a return type or OUT"
+                                                             " parameters"));
+                    }
+                }
+
+                auto functionPtr = std::make_shared<Function_t>(Function_t::FUNCTION,
+                                                                decl.name,
+                                                                type,
+                                                                parmList,
+                                                                decl.comment,
+                                                                namePrefix);
+                functionPtr->isOneWay = decl.isOneWay;
+                codeList.push_back(functionPtr);
+                break;
+            }
+
+            case Declaration_t::HANDLER:
+            {
+                auto parmList = ResolveParameterList(decl.parmList);
+                auto addParmList = ResolveParameterList(decl.addParmList);
+
+                codeList.push_back(std::make_shared<Function_t>(Function_t::HANDLER,
+                                                                decl.name + "Func_t",
+                                                                m_Definition.ConvertType(""),
+                                                                parmList,
+                                                                decl.comment,
+                                                                namePrefix));
+
+                std::string handlerType = m_Definition.ConvertType(decl.name + "Func_t");
+
+                codeList.push_back(std::make_shared<Function_t>(Function_t::ADD_HANDLER,
+                                                                decl.name,
+                                                                handlerType,
+                                                                addParmList,
+                                                                "",
+                                                                namePrefix));
+                break;
+            }
+
+            case Declaration_t::REFERENCE:
+            {
+                auto typePtr = NewReferenceType(decl.name, decl.comment, namePrefix);
+
+                AddType(decl.name, typePtr->refName);
+                codeList.push_back(typePtr);
+                break;
+            }
+
+            case Declaration_t::DEFINE:
+            {
+                Value_t value = decl.isQuoted ? Value_t::String(decl.value)
+                                              : Evaluate(decl.value, decl.location);
+
+                auto typePtr = NewDefineType(decl.name, ToString(value), decl.comment, namePrefix);
+
+                AddType(decl.name, typePtr->name);
+                AddValue(decl.name, value);
+                codeList.push_back(typePtr);
+                break;
+            }
+
+            case Declaration_t::ENUM:
+            case Declaration_t::BITMASK:
+            {
+                std::list<legato::api::EnumMember_t> memberList;
+                for (const auto& member : decl.memberList)
+                {
+                    memberList.push_back(NewEnumMember(member.name, member.comment, namePrefix));
+                }
+
+                auto typePtr = NewEnumType((decl.kind == Declaration_t::ENUM) ? Type_t::ENUM
+                                                                              : Type_t::BITMASK,
+                                           decl.name,
+                                           memberList,
+                                           decl.comment,
+                                           namePrefix);
+
+                AddType(decl.name, typePtr->typeName);
+                codeList.push_back(typePtr);
+                break;
+            }
+
+            case Declaration_t::USETYPES:
+                // Imported files have all been resolved already.
+                break;
+        }
+    }
+}
+
+
+}   // namespace api
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the paths of all the files imported by a .api file, directly or indirectly, in the order
+ * they need to be processed.
+ *
+ * The file's own directory is searched for imported files first, then the given directories.
+ *
+ * @return The list of paths.
+ *
+ * @throw legato::Exception if a file can't be read or an imported file can't be found.
+ **/
+//--------------------------------------------------------------------------------------------------
+std::list<std::string> GetApiImportList
+(
+    const std::string& filePath,
+    const std::list<std::string>& importDirs
+)
+//--------------------------------------------------------------------------------------------------
+{
+    std::list<std::string> dirs = importDirs;
+    dirs.push_front(api::PyDirName(filePath));
+
+    std::list<std::string> importStack;
+
+    return api::MakeImportList(filePath, dirs, importStack);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the definition of a .api file: what it declares, and what the files it imports declare,
+ * with the given prefix added to the names of the things it declares.
+ *
+ * Each .api file is only read and parsed once, and each definition is only resolved once.  The
+ * definitions are kept until the program exits, so the returned reference stays valid.
+ *
+ * @return The definition.
+ *
+ * @throw legato::Exception if there is an error in one of the files, or an imported file can't
+ *        be found.
+ **/
+//--------------------------------------------------------------------------------------------------
+const legato::api::Definition_t& GetApiDefinition
+(
+    const std::string& filePath,
+    const std::string& namePrefix,
+    const std::list<std::string>& importDirs
+)
+//--------------------------------------------------------------------------------------------------
+{
+    std::string key = filePath + '\n' + namePrefix;
+    for (const auto& dir : importDirs)
+    {
+        key += '\n' + dir;
+    }
+
+    auto i = api::Definitions.find(key);
+    if (i != api::Definitions.end())
+    {
+        return i->second;
+    }
+
+    legato::api::Definition_t definition;
+
+    definition.filePath = filePath;
+    definition.namePrefix = namePrefix;
+    definition.importPaths = GetApiImportList(filePath, importDirs);
+    definition.types = api::BuiltInTypes;
+
+    api::Resolver_t resolver(definition);
+
+    // Imported files are resolved with their own names as prefixes.
+    for (const auto& path : definition.importPaths)
+    {
+        std::string name = api::PyBaseName(path);
+
+        definition.messages += "importing " + name + "\n";
+
+        name = api::StripExtension(name);
+        resolver.ResolveFile(api::ParseFile(path), name, name, definition.importedCode);
+    }
+
+    const api::File_t& file = api::ParseFile(filePath);
+
+    definition.headerComments = file.headerComments;
+    for (const auto& decl : file.declarations)
+    {
+        if (decl.kind == api::Declaration_t::USETYPES)
+        {
+            definition.importNames.push_back(decl.name);
+        }
+    }
+
+    resolver.ResolveFile(file, "", namePrefix, definition.code);
+
+    definition.hash = api::Sha256(definition.HashString());
+
+    return api::Definitions[key] = definition;
+}
+
+
+}   // namespace parser
+
+}   // namespace legato
@@ -11,6 +11,7 @@
 
 extern "C"
 {
+    #include "ParsedFile.h"
     #include "ApplicationParser.tab.h"
     #include "ParserCommonInternals.h"
     #include "ApplicationParserInternals.h"
@@ -19,6 +20,8 @@ extern "C"
     #include "lex.ayy.h"
 }
 
+#include "DefinitionCache.h"
+
 
 //--------------------------------------------------------------------------------------------------
 /**
@@ -297,6 +300,268 @@ static void FinalizeApp
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Name of the file that is currently being parsed.
+ */
+//--------------------------------------------------------------------------------------------------
+const char* ayy_FileName = "";
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of the line that the statement currently being applied was found on.
+ */
+//--------------------------------------------------------------------------------------------------
+int ayy_LineNum = 0;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Count of the number of errors that have been reported for the file being parsed.
+ */
+//--------------------------------------------------------------------------------------------------
+size_t ayy_ErrorCount = 0;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Scans and parses the contents of an .adef file, recording the statements found in it.
+ * Runs on the definition cache's worker threads too, so must not touch any global state.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ScanFile
+(
+    yy_ParsedFile_t* filePtr,       ///< [IN/OUT] Object to record the statements in.
+    const std::string& contents     ///< [IN] Contents of the file.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    yyscan_t scanner;
+
+    ayy_lex_init_extra(filePtr, &scanner);
+    YY_BUFFER_STATE buffer = ayy__scan_bytes(contents.data(), contents.size(), scanner);
+    ayy_set_lineno(1, scanner);
+
+    // Until the parsing is done,
+    int parsingResult;
+    do
+    {
+        // Start parsing.
+        parsingResult = ayy_parse(scanner);
+    }
+    while (   (parsingResult != 0)
+           && (!filePtr->isEndOfFile)
+           && (filePtr->errorCount <= AYY_MAX_ERROR_COUNT) );
+
+    ayy__delete_buffer(buffer, scanner);
+    ayy_lex_destroy(scanner);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Starts scanning and parsing an application's .adef file on a worker thread.
+ */
+//--------------------------------------------------------------------------------------------------
+void yy_PrefetchApp
+(
+    const std::string& adefPath     ///< Path of the .adef file.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    yy_PrefetchParsedFile(adefPath, ScanFile);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Applies a statement recorded by the parser to the App currently being parsed.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ApplyStatement
+(
+    const legato::parser::Statement_t& statement
+)
+//--------------------------------------------------------------------------------------------------
+{
+    const std::vector<std::string>& args = statement.args;
+
+    ayy_LineNum = statement.lineNum;
+
+    switch (statement.type)
+    {
+        case YY_ERROR_STATEMENT:
+            ayy_error(args[0].c_str());
+            break;
+
+        case AYY_SET_VERSION:
+            ayy_SetVersion(args[0].c_str());
+            break;
+
+        case AYY_SET_SANDBOXED:
+            ayy_SetSandboxed(args[0].c_str());
+            break;
+
+        case AYY_SET_START_MODE:
+            ayy_SetStartMode(args[0].c_str());
+            break;
+
+        case AYY_SET_MAX_THREADS:
+            ayy_SetMaxThreads(yy_GetNumber(args[0].c_str()));
+            break;
+
+        case AYY_SET_MAX_MQUEUE_BYTES:
+            ayy_SetMaxMQueueBytes(yy_GetNumber(args[0].c_str()));
+            break;
+
+        case AYY_SET_MAX_QUEUED_SIGNALS:
+            ayy_SetMaxQueuedSignals(yy_GetNumber(args[0].c_str()));
+            break;
+
+        case AYY_SET_MAX_MEMORY_BYTES:
+            ayy_SetMaxMemoryBytes(yy_GetNumber(args[0].c_str()));
+            break;
+
+        case AYY_SET_CPU_SHARE:
+            ayy_SetCpuShare(yy_GetNumber(args[0].c_str()));
+            break;
+
+        case AYY_SET_MAX_FILE_SYSTEM_BYTES:
+            ayy_SetMaxFileSystemBytes(yy_GetNumber(args[0].c_str()));
+            break;
+
+        case AYY_ADD_GROUP:
+            ayy_AddGroup(args[0].c_str());
+            break;
+
+        case AYY_ADD_COMPONENT:
+            ayy_AddComponent(args[0].c_str(), args[1].c_str());
+            break;
+
+        case AYY_ADD_BUNDLED_FILE:
+            ayy_AddBundledFile(args[0].c_str(), args[1].c_str(), args[2].c_str());
+            break;
+
+        case AYY_ADD_BUNDLED_DIR:
+            ayy_AddBundledDir(args[0].c_str(), args[1].c_str(), args[2].c_str());
+            break;
+
+        case AYY_FINALIZE_EXECUTABLE:
+            ayy_FinalizeExecutable();
+            break;
+
+        case AYY_ADD_EXECUTABLE:
+            ayy_AddExecutable(args[0].c_str());
+            break;
+
+        case AYY_ADD_EXE_CONTENT:
+            ayy_AddExeContent(args[0].c_str());
+            break;
+
+        case AYY_FINISH_PROCESSES_SECTION:
+            ayy_FinishProcessesSection();
+            break;
+
+        case AYY_FINALIZE_PROCESS:
+            ayy_FinalizeProcess(yy_OptionalArg(args[0]));
+            break;
+
+        case AYY_SET_PROCESS_EXE:
+            ayy_SetProcessExe(args[0].c_str());
+            break;
+
+        case AYY_ADD_PROCESS_ARG:
+            ayy_AddProcessArg(args[0].c_str());
+            break;
+
+        case AYY_ADD_ENV_VAR:
+            ayy_AddEnvVar(args[0].c_str(), args[1].c_str());
+            break;
+
+        case AYY_SET_PRIORITY:
+            ayy_SetPriority(args[0].c_str());
+            break;
+
+        case AYY_SET_MAX_CORE_DUMP_FILE_BYTES:
+            ayy_SetMaxCoreDumpFileBytes(yy_GetNumber(args[0].c_str()));
+            break;
+
+        case AYY_SET_MAX_FILE_BYTES:
+            ayy_SetMaxFileBytes(yy_GetNumber(args[0].c_str()));
+            break;
+
+        case AYY_SET_MAX_LOCKED_MEMORY_BYTES:
+            ayy_SetMaxLockedMemoryBytes(yy_GetNumber(args[0].c_str()));
+            break;
+
+        case AYY_SET_MAX_FILE_DESCRIPTORS:
+            ayy_SetMaxFileDescriptors(yy_GetNumber(args[0].c_str()));
+            break;
+
+        case AYY_SET_MAX_STACK_BYTES:
+            ayy_SetMaxStackBytes(yy_GetNumber(args[0].c_str()));
+            break;
+
+        case AYY_ADD_CPU_AFFINITY:
+            ayy_AddCpuAffinity(yy_GetNumber(args[0].c_str()));
+            break;
+
+        case AYY_SET_FAULT_ACTION:
+            ayy_SetFaultAction(args[0].c_str());
+            break;
+
+        case AYY_SET_WATCHDOG_ACTION:
+            ayy_SetWatchdogAction(args[0].c_str());
+            break;
+
+        case AYY_ADD_REQUIRED_API:
+            ayy_AddRequiredApi(yy_OptionalArg(args[0]), args[1].c_str());
+            break;
+
+        case AYY_ADD_REQUIRED_FILE:
+            ayy_AddRequiredFile(args[0].c_str(), args[1].c_str());
+            break;
+
+        case AYY_ADD_REQUIRED_DIR:
+            ayy_AddRequiredDir(args[0].c_str(), args[1].c_str());
+            break;
+
+        case AYY_ADD_CONFIG_TREE_ACCESS:
+            ayy_AddConfigTreeAccess(args[0].c_str(), args[1].c_str());
+            break;
+
+        case AYY_SET_WATCHDOG_TIMEOUT:
+            ayy_SetWatchdogTimeout(yy_GetNumber(args[0].c_str()));
+            break;
+
+        case AYY_SET_WATCHDOG_DISABLED:
+            ayy_SetWatchdogDisabled(args[0].c_str());
+            break;
+
+        case AYY_ADD_PROVIDED_API:
+            ayy_AddProvidedApi(yy_OptionalArg(args[0]), args[1].c_str());
+            break;
+
+        case AYY_SET_POOL_SIZE:
+            ayy_SetPoolSize(args[0].c_str(), yy_GetNumber(args[1].c_str()));
+            break;
+
+        case AYY_ADD_BIND:
+            ayy_AddBind(args[0].c_str(), args[1].c_str());
+            break;
+
+        case AYY_ADD_BIND_OUT_TO_USER:
+            ayy_AddBindOutToUser(args[0].c_str(), args[1].c_str(), args[2].c_str());
+            break;
+
+        default:
+            throw legato::Exception("Unknown statement type " + std::to_string(statement.type)
+                                    + " found while parsing '" + ayy_FileName + "'.");
+    }
+}
+
+
 namespace legato
 {
 
@@ -324,42 +589,35 @@ void ParseApp
 
     const std::string& path = appPtr->DefFilePath();
 
-    // Open the .adef file for reading.
-    FILE* file = fopen(path.c_str(), "r");
-    if (file == NULL)
+    // Get the file scanned and parsed (unless that's already been done), then start on the files
+    // of the components it uses, so they're ready by the time they're needed.
+    const yy_ParsedFile_t& parsedFile = yy_GetParsedFile(path, ScanFile);
+
+    for (const auto& statement : parsedFile.statements)
     {
-        int error = errno;
-        std::stringstream errorMessage;
-        errorMessage << "Failed to open file '" << path << "'." <<
-                        " Errno = " << error << "(" << strerror(error) << ").";
-        throw Exception(errorMessage.str());
+        if (statement.type == AYY_ADD_EXE_CONTENT)
+        {
+            yy_PrefetchComponent(statement.args[0], buildParams.SourceDirs());
+        }
     }
 
+    yy_AddParsedFile(path);
+
     if (buildParams.IsVerbose())
     {
         std::cout << "Parsing '" << path << "'\n";
     }
 
-    // Tell the parser to reset itself and connect to the new file stream for future parsing.
+    // Apply what was found in the file to the app.
     ayy_FileName = path.c_str();
 
     ayy_IsVerbose = (BuildParamsPtr->IsVerbose() ? 1 : 0);
-    ayy_EndOfFile = 0;
     ayy_ErrorCount = 0;
-    ayy_set_lineno(1);
-    ayy_restart(file);
 
-    // Until the parsing is done,
-    int parsingResult;
-    do
+    for (const auto& statement : parsedFile.statements)
     {
-        // Start parsing.
-        parsingResult = ayy_parse();
+        ApplyStatement(statement);
     }
-    while ((parsingResult != 0) && (!ayy_EndOfFile));
-
-    // Close the file
-    fclose(file);
 
     // Do final processing.
     FinalizeApp();
@@ -385,10 +643,41 @@ void ParseApp
 }
 
 //--------------------------------------------------------------------------------------------------
-// NOTE: The following functions are called from C code inside the bison-generated parser code.
+// NOTE: The following functions are called by ApplyStatement(), for the statements recorded by the
+//       bison-generated parser code.
 //--------------------------------------------------------------------------------------------------
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Error handling function.  Prints an error message to the standard error stream and counts
+ * errors.  If the number of errors gets too high, terminates the program.
+ **/
+//--------------------------------------------------------------------------------------------------
+void ayy_error
+(
+    const char* errorString
+)
+//--------------------------------------------------------------------------------------------------
+{
+    // Make error messages stand out from the clutter when running in verbose mode.
+    if (ayy_IsVerbose)
+    {
+        fprintf(stderr, " [-- ERROR --]\n");
+    }
+
+    fprintf(stderr, "%s:%d: ERROR: %s\n", ayy_FileName, ayy_LineNum, errorString);
+
+    ayy_ErrorCount++;
+
+    if (ayy_ErrorCount > AYY_MAX_ERROR_COUNT)
+    {
+        fprintf(stderr, "Error limit reached.  Stopping at line %d.\n", ayy_LineNum);
+        exit(ayy_ErrorCount);
+    }
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Set the application version.
@@ -1404,6 +1693,67 @@ void ayy_SetMaxFileDescriptors
 
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set the maximum stack size (in bytes) of each process in the processes section.  This is also
+ * the default stack size of threads created by those processes.
+ */
+//--------------------------------------------------------------------------------------------------
+void ayy_SetMaxStackBytes
+(
+    int limit   ///< Must be a positive integer.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (ayy_IsVerbose)
+    {
+        std::cout << "    Maximum stack size: " << limit << " bytes" << std::endl;
+    }
+
+    try
+    {
+        legato::ProcessEnvironment& env = GetProcessEnvironment();
+
+        env.MaxStackBytes(limit);
+    }
+    catch (legato::Exception e)
+    {
+        ayy_error(e.what());
+    }
+}
+
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add a CPU to the set of CPUs that processes in the processes section are allowed to run on.
+ */
+//--------------------------------------------------------------------------------------------------
+void ayy_AddCpuAffinity
+(
+    int cpu     ///< CPU number (0 = first CPU).
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (ayy_IsVerbose)
+    {
+        std::cout << "    Allowed to run on CPU " << cpu << std::endl;
+    }
+
+    try
+    {
+        legato::ProcessEnvironment& env = GetProcessEnvironment();
+
+        env.AddCpuAffinity(cpu);
+    }
+    catch (legato::Exception e)
+    {
+        ayy_error(e.what());
+    }
+}
+
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Set the action that should be taken if a process in the process group currently being parsed
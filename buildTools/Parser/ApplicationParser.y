@@ -3,12 +3,25 @@
 %{
 
 #include <stdio.h>
+#include "ParsedFile.h"
 #include "ApplicationParser.tab.h"
 #include "lex.ayy.h"
 #include "ApplicationParserInternals.h"
 
+// The rules don't act on what they parse; they record it in the parsed file object that was
+// handed to the scanner (see ParsedFile.h).  Syntax errors are recorded the same way.
+#define ayy_error(scanner, errorString) \
+    yy_AddError(ayy_get_extra(scanner), ayy_get_lineno(scanner), errorString)
+
+#define STATEMENT(...) \
+    yy_AddStatement(ayy_get_extra(scanner), ayy_get_lineno(scanner), __VA_ARGS__, NULL)
+
 %}
 
+%define api.pure
+%lex-param {void* scanner}
+%parse-param {void* scanner}
+
 %error-verbose
 
 %union
@@ -38,6 +51,8 @@
 %token  MAX_FILE_BYTES_SECTION_LABEL;
 %token  MAX_LOCKED_MEMORY_BYTES_SECTION_LABEL;
 %token  MAX_FILE_DESCRIPTORS_SECTION_LABEL;
+%token  MAX_STACK_BYTES_SECTION_LABEL;
+%token  CPU_AFFINITY_SECTION_LABEL;
 %token  FAULT_ACTION_SECTION_LABEL;
 %token  WATCHDOG_ACTION_SECTION_LABEL;
 %token  WATCHDOG_TIMEOUT_SECTION_LABEL;
@@ -97,39 +112,39 @@ section
     ;
 
 version_section
-    : VERSION_SECTION_LABEL ver_string    { ayy_SetVersion($2); }
+    : VERSION_SECTION_LABEL ver_string    { STATEMENT(AYY_SET_VERSION, $2); }
     ;
 
 sandboxed_section
-    : SANDBOXED_SECTION_LABEL NAME    { ayy_SetSandboxed($2); }
+    : SANDBOXED_SECTION_LABEL NAME    { STATEMENT(AYY_SET_SANDBOXED, $2); }
     ;
 
 start_section
-    : START_SECTION_LABEL NAME    { ayy_SetStartMode($2); }
+    : START_SECTION_LABEL NAME    { STATEMENT(AYY_SET_START_MODE, $2); }
     ;
 
 max_threads_section
-    : MAX_THREADS_SECTION_LABEL NUMBER      { ayy_SetMaxThreads(yy_GetNumber($2)); }
+    : MAX_THREADS_SECTION_LABEL NUMBER      { STATEMENT(AYY_SET_MAX_THREADS, $2); }
     ;
 
 max_mqueue_bytes_section
-    : MAX_MQUEUE_BYTES_SECTION_LABEL NUMBER { ayy_SetMaxMQueueBytes(yy_GetNumber($2)); }
+    : MAX_MQUEUE_BYTES_SECTION_LABEL NUMBER { STATEMENT(AYY_SET_MAX_MQUEUE_BYTES, $2); }
     ;
 
 max_queued_signals_section
-    : MAX_QUEUED_SIGNALS_SECTION_LABEL NUMBER { ayy_SetMaxQueuedSignals(yy_GetNumber($2)); }
+    : MAX_QUEUED_SIGNALS_SECTION_LABEL NUMBER { STATEMENT(AYY_SET_MAX_QUEUED_SIGNALS, $2); }
     ;
 
 max_memory_bytes_section
-    : MAX_MEMORY_BYTES_SECTION_LABEL NUMBER   { ayy_SetMaxMemoryBytes(yy_GetNumber($2)); }
+    : MAX_MEMORY_BYTES_SECTION_LABEL NUMBER   { STATEMENT(AYY_SET_MAX_MEMORY_BYTES, $2); }
     ;
 
 cpu_share_section
-    : CPU_SHARE_SECTION_LABEL NUMBER   { ayy_SetCpuShare(yy_GetNumber($2)); }
+    : CPU_SHARE_SECTION_LABEL NUMBER   { STATEMENT(AYY_SET_CPU_SHARE, $2); }
     ;
 
 max_file_system_bytes_section
-    : MAX_FILE_SYSTEM_BYTES_SECTION_LABEL NUMBER { ayy_SetMaxFileSystemBytes(yy_GetNumber($2)); }
+    : MAX_FILE_SYSTEM_BYTES_SECTION_LABEL NUMBER { STATEMENT(AYY_SET_MAX_FILE_SYSTEM_BYTES, $2); }
     ;
 
 groups_section
@@ -142,8 +157,8 @@ group_list
     ;
 
 group
-    : FILE_PATH { ayy_AddGroup($1); }
-    | NAME      { ayy_AddGroup($1); }
+    : FILE_PATH { STATEMENT(AYY_ADD_GROUP, $1); }
+    | NAME      { STATEMENT(AYY_ADD_GROUP, $1); }
     ;
 
 
@@ -160,8 +175,8 @@ component_list
 
 
 component
-    : NAME '=' file_path    { ayy_AddComponent($1, $3); }
-    | file_path             { ayy_AddComponent("", $1); }
+    : NAME '=' file_path    { STATEMENT(AYY_ADD_COMPONENT, $1, $3); }
+    | file_path             { STATEMENT(AYY_ADD_COMPONENT, "", $1); }
     ;
 
 
@@ -196,8 +211,8 @@ bundled_file_list
 
 
 bundled_file
-    : file_path file_path               { ayy_AddBundledFile("[r]", $1, $2); }
-    | PERMISSIONS file_path file_path   { ayy_AddBundledFile($1, $2, $3); }
+    : file_path file_path               { STATEMENT(AYY_ADD_BUNDLED_FILE, "[r]", $1, $2); }
+    | PERMISSIONS file_path file_path   { STATEMENT(AYY_ADD_BUNDLED_FILE, $1, $2, $3); }
     ;
 
 
@@ -215,8 +230,8 @@ bundled_dir_list
 
 
 bundled_dir
-    : file_path file_path               { ayy_AddBundledDir("[r]", $1, $2); }
-    | PERMISSIONS file_path file_path   { ayy_AddBundledDir($1, $2, $3); }
+    : file_path file_path               { STATEMENT(AYY_ADD_BUNDLED_DIR, "[r]", $1, $2); }
+    | PERMISSIONS file_path file_path   { STATEMENT(AYY_ADD_BUNDLED_DIR, $1, $2, $3); }
     ;
 
 
@@ -231,21 +246,22 @@ executables_list
     ;
 
 exe_spec
-    : exe_name '=' '(' exe_content_list ')'     { ayy_FinalizeExecutable(); }
+    : exe_name '=' '(' exe_content_list ')'     { STATEMENT(AYY_FINALIZE_EXECUTABLE); }
     ;
 
 exe_name
-    : file_path         { ayy_AddExecutable($1); }
+    : file_path         { STATEMENT(AYY_ADD_EXECUTABLE, $1); }
     ;
 
 exe_content_list
-    : file_path                         { ayy_AddExeContent($1); }
-    | exe_content_list file_path        { ayy_AddExeContent($2); }
+    : file_path                         { STATEMENT(AYY_ADD_EXE_CONTENT, $1); }
+    | exe_content_list file_path        { STATEMENT(AYY_ADD_EXE_CONTENT, $2); }
     ;
 
 processes_section
     : PROCESSES_SECTION_LABEL '{' '}'
-    | PROCESSES_SECTION_LABEL '{' processes_subsection_list '}'  { ayy_FinishProcessesSection(); }
+    | PROCESSES_SECTION_LABEL '{' processes_subsection_list '}'
+                                                    { STATEMENT(AYY_FINISH_PROCESSES_SECTION); }
     ;
 
 processes_subsection_list
@@ -261,6 +277,8 @@ processes_subsection
     | max_file_bytes_subsection
     | max_locked_memory_bytes_subsection
     | max_file_descriptors_subsection
+    | max_stack_bytes_subsection
+    | cpu_affinity_subsection
     | fault_action_subsection
     | watchdog_action_subsection
     | watchdog_timeout_subsection
@@ -277,18 +295,18 @@ process_list
     ;
 
 process
-    : '(' command_line ')'              { ayy_FinalizeProcess(NULL); }
-    | NAME '=' '(' command_line ')'     { ayy_FinalizeProcess($1); }
+    : '(' command_line ')'              { STATEMENT(AYY_FINALIZE_PROCESS, ""); }
+    | NAME '=' '(' command_line ')'     { STATEMENT(AYY_FINALIZE_PROCESS, $1); }
     ;
 
 command_line
-    : file_path             { ayy_SetProcessExe($1); }
-    | file_path args_list   { ayy_SetProcessExe($1); }
+    : file_path             { STATEMENT(AYY_SET_PROCESS_EXE, $1); }
+    | file_path args_list   { STATEMENT(AYY_SET_PROCESS_EXE, $1); }
     ;
 
 args_list
-    : file_path             { ayy_AddProcessArg($1); }
-    | args_list file_path   { ayy_AddProcessArg($2); }
+    : file_path             { STATEMENT(AYY_ADD_PROCESS_ARG, $1); }
+    | args_list file_path   { STATEMENT(AYY_ADD_PROCESS_ARG, $2); }
     ;
 
 env_vars_subsection
@@ -302,37 +320,55 @@ env_var_list
     ;
 
 env_var
-    : NAME '=' file_path    { ayy_AddEnvVar($1, $3); }
+    : NAME '=' file_path    { STATEMENT(AYY_ADD_ENV_VAR, $1, $3); }
     ;
 
 priority_subsection
-    : PRIORITY_SECTION_LABEL NAME     { ayy_SetPriority($2); }
+    : PRIORITY_SECTION_LABEL NAME     { STATEMENT(AYY_SET_PRIORITY, $2); }
     ;
 
 max_core_dump_file_bytes_subsection
     : MAX_CORE_DUMP_FILE_BYTES_SECTION_LABEL NUMBER
-                                                { ayy_SetMaxCoreDumpFileBytes(yy_GetNumber($2)); }
+                                                { STATEMENT(AYY_SET_MAX_CORE_DUMP_FILE_BYTES, $2); }
     ;
 
 max_file_bytes_subsection
-    : MAX_FILE_BYTES_SECTION_LABEL NUMBER      { ayy_SetMaxFileBytes(yy_GetNumber($2)); }
+    : MAX_FILE_BYTES_SECTION_LABEL NUMBER      { STATEMENT(AYY_SET_MAX_FILE_BYTES, $2); }
     ;
 
 max_locked_memory_bytes_subsection
     : MAX_LOCKED_MEMORY_BYTES_SECTION_LABEL NUMBER
-                                                { ayy_SetMaxLockedMemoryBytes(yy_GetNumber($2)); }
+                                                { STATEMENT(AYY_SET_MAX_LOCKED_MEMORY_BYTES, $2); }
     ;
 
 max_file_descriptors_subsection
-    : MAX_FILE_DESCRIPTORS_SECTION_LABEL NUMBER { ayy_SetMaxFileDescriptors(yy_GetNumber($2)); }
+    : MAX_FILE_DESCRIPTORS_SECTION_LABEL NUMBER { STATEMENT(AYY_SET_MAX_FILE_DESCRIPTORS, $2); }
+    ;
+
+max_stack_bytes_subsection
+    : MAX_STACK_BYTES_SECTION_LABEL NUMBER  { STATEMENT(AYY_SET_MAX_STACK_BYTES, $2); }
+    ;
+
+cpu_affinity_subsection
+    : CPU_AFFINITY_SECTION_LABEL '{' '}'
+    | CPU_AFFINITY_SECTION_LABEL '{' cpu_list '}'
+    ;
+
+cpu_list
+    : cpu
+    | cpu_list cpu
+    ;
+
+cpu
+    : NUMBER    { STATEMENT(AYY_ADD_CPU_AFFINITY, $1); }
     ;
 
 fault_action_subsection
-    : FAULT_ACTION_SECTION_LABEL NAME     { ayy_SetFaultAction($2); }
+    : FAULT_ACTION_SECTION_LABEL NAME     { STATEMENT(AYY_SET_FAULT_ACTION, $2); }
     ;
 
 watchdog_action_subsection
-    : WATCHDOG_ACTION_SECTION_LABEL NAME  { ayy_SetWatchdogAction($2); }
+    : WATCHDOG_ACTION_SECTION_LABEL NAME  { STATEMENT(AYY_SET_WATCHDOG_ACTION, $2); }
     ;
 
 requires_section
@@ -363,8 +399,8 @@ required_api_list
     ;
 
 required_api_spec
-    : file_path             { ayy_AddRequiredApi(NULL, $1); }
-    | NAME '=' file_path    { ayy_AddRequiredApi($1, $3); }
+    : file_path             { STATEMENT(AYY_ADD_REQUIRED_API, "", $1); }
+    | NAME '=' file_path    { STATEMENT(AYY_ADD_REQUIRED_API, $1, $3); }
     ;
 
 required_file_subsection
@@ -379,7 +415,7 @@ required_file_list
 
 
 required_file
-    : file_path file_path               { ayy_AddRequiredFile($1, $2); }
+    : file_path file_path               { STATEMENT(AYY_ADD_REQUIRED_FILE, $1, $2); }
     ;
 
 
@@ -394,7 +430,7 @@ required_dir_list
     ;
 
 required_dir_mapping
-    : file_path file_path               { ayy_AddRequiredDir($1, $2); }
+    : file_path file_path               { STATEMENT(AYY_ADD_REQUIRED_DIR, $1, $2); }
     ;
 
 required_config_tree_subsection
@@ -408,14 +444,14 @@ required_config_tree_list
     ;
 
 required_config_tree
-    : NAME                  { ayy_AddConfigTreeAccess("[r]", $1); }
-    | PERMISSIONS NAME      { ayy_AddConfigTreeAccess($1, $2); }
+    : NAME                  { STATEMENT(AYY_ADD_CONFIG_TREE_ACCESS, "[r]", $1); }
+    | PERMISSIONS NAME      { STATEMENT(AYY_ADD_CONFIG_TREE_ACCESS, $1, $2); }
     ;
 
 watchdog_timeout_subsection
     : WATCHDOG_TIMEOUT_SECTION_LABEL
-    | WATCHDOG_TIMEOUT_SECTION_LABEL NUMBER  { ayy_SetWatchdogTimeout(yy_GetNumber($2)); }
-    | WATCHDOG_TIMEOUT_SECTION_LABEL NAME    { ayy_SetWatchdogDisabled($2); }
+    | WATCHDOG_TIMEOUT_SECTION_LABEL NUMBER  { STATEMENT(AYY_SET_WATCHDOG_TIMEOUT, $2); }
+    | WATCHDOG_TIMEOUT_SECTION_LABEL NAME    { STATEMENT(AYY_SET_WATCHDOG_DISABLED, $2); }
     ;
 
 file_path
@@ -449,8 +485,8 @@ provided_api_list
     ;
 
 provided_api_spec
-    : file_path             { ayy_AddProvidedApi(NULL, $1); }
-    | NAME '=' file_path    { ayy_AddProvidedApi($1, $3); }
+    : file_path             { STATEMENT(AYY_ADD_PROVIDED_API, "", $1); }
+    | NAME '=' file_path    { STATEMENT(AYY_ADD_PROVIDED_API, $1, $3); }
     ;
 
 pools_section
@@ -464,7 +500,7 @@ pool_list
     ;
 
 pool
-    : NAME '=' NUMBER       { ayy_SetPoolSize($1, yy_GetNumber($3)); }
+    : NAME '=' NUMBER       { STATEMENT(AYY_SET_POOL_SIZE, $1, $3); }
     ;
 
 bindings_section
@@ -478,8 +514,9 @@ bind_list
     ;
 
 bind_spec
-    : file_path ARROW file_path                     { ayy_AddBind($1, $3); }
-    | file_path ARROW '<' file_path '>' file_path   { ayy_AddBindOutToUser($1, $4, $6); }
+    : file_path ARROW file_path                     { STATEMENT(AYY_ADD_BIND, $1, $3); }
+    | file_path ARROW '<' file_path '>' file_path
+                                                { STATEMENT(AYY_ADD_BIND_OUT_TO_USER, $1, $4, $6); }
     ;
 
 ver_string
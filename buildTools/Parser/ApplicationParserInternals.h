@@ -19,30 +19,83 @@
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Application parsing function, implemented by the Bison-generated parser.
+ * Types of statements recorded by the parser (see ParsedFile.h).  Each is applied by calling the
+ * function of the same name, below, with the statement's arguments.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef enum
+{
+    AYY_SET_VERSION = 1,                        ///< ayy_SetVersion()
+    AYY_SET_SANDBOXED,                          ///< ayy_SetSandboxed()
+    AYY_SET_START_MODE,                         ///< ayy_SetStartMode()
+    AYY_SET_MAX_THREADS,                        ///< ayy_SetMaxThreads()
+    AYY_SET_MAX_MQUEUE_BYTES,                   ///< ayy_SetMaxMQueueBytes()
+    AYY_SET_MAX_QUEUED_SIGNALS,                 ///< ayy_SetMaxQueuedSignals()
+    AYY_SET_MAX_MEMORY_BYTES,                   ///< ayy_SetMaxMemoryBytes()
+    AYY_SET_CPU_SHARE,                          ///< ayy_SetCpuShare()
+    AYY_SET_MAX_FILE_SYSTEM_BYTES,              ///< ayy_SetMaxFileSystemBytes()
+    AYY_ADD_GROUP,                              ///< ayy_AddGroup()
+    AYY_ADD_COMPONENT,                          ///< ayy_AddComponent()
+    AYY_ADD_BUNDLED_FILE,                       ///< ayy_AddBundledFile()
+    AYY_ADD_BUNDLED_DIR,                        ///< ayy_AddBundledDir()
+    AYY_FINALIZE_EXECUTABLE,                    ///< ayy_FinalizeExecutable()
+    AYY_ADD_EXECUTABLE,                         ///< ayy_AddExecutable()
+    AYY_ADD_EXE_CONTENT,                        ///< ayy_AddExeContent()
+    AYY_FINISH_PROCESSES_SECTION,               ///< ayy_FinishProcessesSection()
+    AYY_FINALIZE_PROCESS,                       ///< ayy_FinalizeProcess()
+    AYY_SET_PROCESS_EXE,                        ///< ayy_SetProcessExe()
+    AYY_ADD_PROCESS_ARG,                        ///< ayy_AddProcessArg()
+    AYY_ADD_ENV_VAR,                            ///< ayy_AddEnvVar()
+    AYY_SET_PRIORITY,                           ///< ayy_SetPriority()
+    AYY_SET_MAX_CORE_DUMP_FILE_BYTES,           ///< ayy_SetMaxCoreDumpFileBytes()
+    AYY_SET_MAX_FILE_BYTES,                     ///< ayy_SetMaxFileBytes()
+    AYY_SET_MAX_LOCKED_MEMORY_BYTES,            ///< ayy_SetMaxLockedMemoryBytes()
+    AYY_SET_MAX_FILE_DESCRIPTORS,               ///< ayy_SetMaxFileDescriptors()
+    AYY_SET_MAX_STACK_BYTES,                    ///< ayy_SetMaxStackBytes()
+    AYY_ADD_CPU_AFFINITY,                       ///< ayy_AddCpuAffinity()
+    AYY_SET_FAULT_ACTION,                       ///< ayy_SetFaultAction()
+    AYY_SET_WATCHDOG_ACTION,                    ///< ayy_SetWatchdogAction()
+    AYY_ADD_REQUIRED_API,                       ///< ayy_AddRequiredApi()
+    AYY_ADD_REQUIRED_FILE,                      ///< ayy_AddRequiredFile()
+    AYY_ADD_REQUIRED_DIR,                       ///< ayy_AddRequiredDir()
+    AYY_ADD_CONFIG_TREE_ACCESS,                 ///< ayy_AddConfigTreeAccess()
+    AYY_SET_WATCHDOG_TIMEOUT,                   ///< ayy_SetWatchdogTimeout()
+    AYY_SET_WATCHDOG_DISABLED,                  ///< ayy_SetWatchdogDisabled()
+    AYY_ADD_PROVIDED_API,                       ///< ayy_AddProvidedApi()
+    AYY_SET_POOL_SIZE,                          ///< ayy_SetPoolSize()
+    AYY_ADD_BIND,                               ///< ayy_AddBind()
+    AYY_ADD_BIND_OUT_TO_USER                    ///< ayy_AddBindOutToUser()
+}
+ayy_StatementType_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Application parsing function, implemented by the Bison-generated parser.  Records the statements
+ * found by a reentrant scanner in the scanner's parsed file object (its "extra" data).
  *
  * @note    ayy_parse() may return a non-zero value before parsing has finished, because an error
  *          was encountered.  To aide in troubleshooting, ayy_parse() can be called again to look
  *          for further errors.  However, there's no point in doing this if the end-of-file has
- *          been reached.  ayy_EndOfFile can be used to check for end of file.
+ *          been reached.
  *
  * @return 0 when parsing successfully completes.  Non-zero when an error is encountered.
  */
 //--------------------------------------------------------------------------------------------------
-int ayy_parse(void);
+int ayy_parse(void* scanner);
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * End of file flag.  This is set when ayy_parse() returns due to an end of file condition.
+ * Number of the line that the statement currently being applied was found on.
  */
 //--------------------------------------------------------------------------------------------------
-extern int ayy_EndOfFile;
+extern int ayy_LineNum;
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Count of the number of errors that have been reported during scanning.
+ * Count of the number of errors that have been reported for the file being parsed.
  */
 //--------------------------------------------------------------------------------------------------
 extern size_t ayy_ErrorCount;
@@ -66,8 +119,8 @@ extern int ayy_IsVerbose;
 
 //--------------------------------------------------------------------------------------------------
 /**
- * The standard error reporting function that will be called by both the
- * lexer and the parser when they detect errors or when the YYERROR macro is invoked.
+ * The standard error reporting function.  Called for each error recorded by the scanner and the
+ * parser, and by the functions below when they detect errors.
  */
 //--------------------------------------------------------------------------------------------------
 void ayy_error(const char* errorString);
@@ -437,6 +490,29 @@ void ayy_SetMaxFileDescriptors
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set the maximum stack size (in bytes) of each process in the processes section.  This is also
+ * the default stack size of threads created by those processes.
+ */
+//--------------------------------------------------------------------------------------------------
+void ayy_SetMaxStackBytes
+(
+    int limit   ///< Must be a positive integer.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add a CPU to the set of CPUs that processes in the processes section are allowed to run on.
+ */
+//--------------------------------------------------------------------------------------------------
+void ayy_AddCpuAffinity
+(
+    int cpu     ///< CPU number (0 = first CPU).
+);
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Set the action that should be taken if a process in the process group currently being parsed
@@ -11,6 +11,7 @@
 
 extern "C"
 {
+    #include "ParsedFile.h"
     #include "ComponentParser.tab.h"
     #include "ParserCommonInternals.h"
     #include "ComponentParserInternals.h"
@@ -19,6 +20,8 @@ extern "C"
     #include "lex.cyy.h"
 }
 
+#include "DefinitionCache.h"
+
 
 //--------------------------------------------------------------------------------------------------
 /**
@@ -44,6 +47,201 @@ static const legato::BuildParams_t* BuildParamsPtr;
 static legato::Component* ComponentPtr;
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Name of the file that is currently being parsed.
+ */
+//--------------------------------------------------------------------------------------------------
+const char* cyy_FileName = "";
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of the line that the statement currently being applied was found on.
+ */
+//--------------------------------------------------------------------------------------------------
+int cyy_LineNum = 0;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Count of the number of errors that have been reported for the file being parsed.
+ */
+//--------------------------------------------------------------------------------------------------
+size_t cyy_ErrorCount = 0;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Scans and parses the contents of a Component.cdef file, recording the statements found in it.
+ * Runs on the definition cache's worker threads too, so must not touch any global state.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ScanFile
+(
+    yy_ParsedFile_t* filePtr,       ///< [IN/OUT] Object to record the statements in.
+    const std::string& contents     ///< [IN] Contents of the file.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    yyscan_t scanner;
+
+    cyy_lex_init_extra(filePtr, &scanner);
+    YY_BUFFER_STATE buffer = cyy__scan_bytes(contents.data(), contents.size(), scanner);
+    cyy_set_lineno(1, scanner);
+
+    // Until the parsing is done,
+    int parsingResult;
+    do
+    {
+        // Start parsing.
+        parsingResult = cyy_parse(scanner);
+    }
+    while (   (parsingResult != 0)
+           && (!filePtr->isEndOfFile)
+           && (filePtr->errorCount <= CYY_MAX_ERROR_COUNT) );
+
+    cyy__delete_buffer(buffer, scanner);
+    cyy_lex_destroy(scanner);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Starts scanning and parsing a component's Component.cdef file on a worker thread, if the
+ * component can be found.  Nothing is reported if it can't; that's done when it is parsed.
+ */
+//--------------------------------------------------------------------------------------------------
+void yy_PrefetchComponent
+(
+    const std::string& path,                    ///< Path of the component, as found in a file.
+    const std::list<std::string>& searchDirs    ///< Where to look for the component.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    try
+    {
+        std::string dirPath = legato::FindComponent(legato::DoEnvVarSubstitution(path),
+                                                    searchDirs);
+        if (dirPath != "")
+        {
+            // Components are parsed under their canonical path (see Component::CreateComponent()),
+            // so the file has to be cached under that path too, or it will be parsed twice.
+            dirPath = legato::CanonicalPath(dirPath);
+            yy_PrefetchParsedFile(legato::CombinePath(dirPath, "/Component.cdef"), ScanFile);
+        }
+    }
+    catch (const legato::Exception&)
+    {
+        // Ignore it.
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Applies a statement recorded by the parser to the Component currently being parsed.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ApplyStatement
+(
+    const legato::parser::Statement_t& statement
+)
+//--------------------------------------------------------------------------------------------------
+{
+    const std::vector<std::string>& args = statement.args;
+
+    cyy_LineNum = statement.lineNum;
+
+    switch (statement.type)
+    {
+        case YY_ERROR_STATEMENT:
+            cyy_error(args[0].c_str());
+            break;
+
+        case CYY_ADD_SOURCE_FILE:
+            cyy_AddSourceFile(args[0].c_str());
+            break;
+
+        case CYY_ADD_CFLAG:
+            cyy_AddCFlag(args[0].c_str());
+            break;
+
+        case CYY_ADD_CXXFLAG:
+            cyy_AddCxxFlag(args[0].c_str());
+            break;
+
+        case CYY_ADD_LDFLAG:
+            cyy_AddLdFlag(args[0].c_str());
+            break;
+
+        case CYY_ADD_BUNDLED_FILE:
+            cyy_AddBundledFile(args[0].c_str(), args[1].c_str(), args[2].c_str());
+            break;
+
+        case CYY_ADD_BUNDLED_DIR:
+            cyy_AddBundledDir(args[0].c_str(), args[1].c_str(), args[2].c_str());
+            break;
+
+        case CYY_ADD_REQUIRED_API:
+            cyy_AddRequiredApi(yy_OptionalArg(args[0]), args[1].c_str());
+            break;
+
+        case CYY_ADD_TYPES_ONLY_REQUIRED_API:
+            cyy_AddTypesOnlyRequiredApi(yy_OptionalArg(args[0]), args[1].c_str());
+            break;
+
+        case CYY_ADD_MANUAL_START_REQUIRED_API:
+            cyy_AddManualStartRequiredApi(yy_OptionalArg(args[0]), args[1].c_str());
+            break;
+
+        case CYY_ADD_AWAIT_REQUIRED_API:
+            cyy_AddAwaitRequiredApi(yy_OptionalArg(args[0]), args[1].c_str());
+            break;
+
+        case CYY_ADD_PIPELINED_REQUIRED_API:
+            cyy_AddPipelinedRequiredApi(yy_OptionalArg(args[0]), args[1].c_str());
+            break;
+
+        case CYY_ADD_REQUIRED_FILE:
+            cyy_AddRequiredFile(args[0].c_str(), args[1].c_str());
+            break;
+
+        case CYY_ADD_REQUIRED_DIR:
+            cyy_AddRequiredDir(args[0].c_str(), args[1].c_str());
+            break;
+
+        case CYY_ADD_REQUIRED_LIB:
+            cyy_AddRequiredLib(args[0].c_str());
+            break;
+
+        case CYY_ADD_REQUIRED_COMPONENT:
+            cyy_AddRequiredComponent(args[0].c_str());
+            break;
+
+        case CYY_ADD_PROVIDED_API:
+            cyy_AddProvidedApi(yy_OptionalArg(args[0]), args[1].c_str());
+            break;
+
+        case CYY_ADD_ASYNC_PROVIDED_API:
+            cyy_AddAsyncProvidedApi(yy_OptionalArg(args[0]), args[1].c_str());
+            break;
+
+        case CYY_ADD_MANUAL_START_PROVIDED_API:
+            cyy_AddManualStartProvidedApi(yy_OptionalArg(args[0]), args[1].c_str());
+            break;
+
+        case CYY_ADD_MANUAL_START_ASYNC_PROVIDED_API:
+            cyy_AddManualStartAsyncProvidedApi(yy_OptionalArg(args[0]), args[1].c_str());
+            break;
+
+        default:
+            throw legato::Exception("Unknown statement type " + std::to_string(statement.type)
+                                    + " found while parsing '" + cyy_FileName + "'.");
+    }
+}
+
+
 namespace legato
 {
 
@@ -79,40 +277,35 @@ void ParseComponent
     componentPtr->Path(path);
 
     std::string cdefFilePath = CombinePath(path, "/Component.cdef");
-    FILE* file = fopen(cdefFilePath.c_str(), "r");
-    if (file == NULL)
+
+    // Get the file scanned and parsed (unless that's already been done), then start on the files
+    // of its sub-components, so they're ready by the time they're needed.
+    const yy_ParsedFile_t& parsedFile = yy_GetParsedFile(cdefFilePath, ScanFile);
+
+    for (const auto& statement : parsedFile.statements)
     {
-        int error = errno;
-        std::stringstream errorMessage;
-        errorMessage << "Failed to open file '" << cdefFilePath << "'." <<
-                        " Errno = " << error << "(" << strerror(error) << ").";
-        throw Exception(errorMessage.str());
+        if (statement.type == CYY_ADD_REQUIRED_COMPONENT)
+        {
+            yy_PrefetchComponent(statement.args[0], buildParams.SourceDirs());
+        }
     }
 
+    yy_AddParsedFile(cdefFilePath);
+
     if (buildParams.IsVerbose())
     {
         std::cout << "Parsing '" << cdefFilePath << "'\n";
     }
 
-    // Tell the parser to reset itself and connect to the new file stream for future parsing.
+    // Apply what was found in the file to the component.
     cyy_FileName = cdefFilePath.c_str();
     cyy_IsVerbose = (BuildParamsPtr->IsVerbose() ? 1 : 0);
-    cyy_EndOfFile = 0;
     cyy_ErrorCount = 0;
-    cyy_set_lineno(1);
-    cyy_restart(file);
 
-    // Until the parsing is done,
-    int parsingResult;
-    do
+    for (const auto& statement : parsedFile.statements)
     {
-        // Start parsing.
-        parsingResult = cyy_parse();
+        ApplyStatement(statement);
     }
-    while ((parsingResult != 0) && (!cyy_EndOfFile));
-
-    // Close the file
-    fclose(file);
 
     // Halt if there were errors.
     if (cyy_ErrorCount > 0)
@@ -148,10 +341,41 @@ void ParseComponent
 } // namespace legato
 
 //--------------------------------------------------------------------------------------------------
-// NOTE: The following functions are called from C code inside the bison-generated parser code.
+// NOTE: The following functions are called by ApplyStatement(), for the statements recorded by the
+//       bison-generated parser code.
 //--------------------------------------------------------------------------------------------------
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Error handling function.  Prints an error message to the standard error stream and counts
+ * errors.  If the number of errors gets too high, terminates the program.
+ **/
+//--------------------------------------------------------------------------------------------------
+void cyy_error
+(
+    const char* errorString
+)
+//--------------------------------------------------------------------------------------------------
+{
+    // Make error messages stand out from the clutter when running in verbose mode.
+    if (cyy_IsVerbose)
+    {
+        fprintf(stderr, " [-- ERROR --]\n");
+    }
+
+    fprintf(stderr, "%s:%d: ERROR: %s\n", cyy_FileName, cyy_LineNum, errorString);
+
+    cyy_ErrorCount++;
+
+    if (cyy_ErrorCount > CYY_MAX_ERROR_COUNT)
+    {
+        fprintf(stderr, "Error limit reached.  Stopping at line %d.\n", cyy_LineNum);
+        exit(cyy_ErrorCount);
+    }
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Add a source code file to a Component.
@@ -644,6 +868,81 @@ void cyy_AddManualStartRequiredApi
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add an await-style required (client-side) IPC API interface to a Component.
+ *
+ * The generated client-side functions will only suspend the calling coroutine (if any), rather
+ * than the whole thread, while waiting for the server to respond.
+ **/
+//--------------------------------------------------------------------------------------------------
+void cyy_AddAwaitRequiredApi
+(
+    const char* instanceName,   ///< Interface instance name or
+                                ///  NULL if should be derived from .api file name.
+
+    const char* apiFile         ///< Path to the .api file.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    try
+    {
+        auto& interface = AddRequiredApi(instanceName, apiFile);
+
+        if (cyy_IsVerbose)
+        {
+            std::cout << "  Client (await-style) of API defined in '" << interface.Api().FilePath()
+                      << "' with local interface name '" << interface.InternalName() << "'"
+                      << std::endl;
+        }
+
+        interface.MarkAwait();
+    }
+    catch (legato::Exception e)
+    {
+        cyy_error(e.what());
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add a required (client-side) IPC API interface to a Component, with pipelined client-side
+ * functions.
+ *
+ * Besides the usual functions, Start and Finish functions are generated, which send a request
+ * and collect its response separately, so that several requests can be in flight at once.
+ **/
+//--------------------------------------------------------------------------------------------------
+void cyy_AddPipelinedRequiredApi
+(
+    const char* instanceName,   ///< Interface instance name or
+                                ///  NULL if should be derived from .api file name.
+
+    const char* apiFile         ///< Path to the .api file.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    try
+    {
+        auto& interface = AddRequiredApi(instanceName, apiFile);
+
+        if (cyy_IsVerbose)
+        {
+            std::cout << "  Client (pipelined) of API defined in '" << interface.Api().FilePath()
+                      << "' with local interface name '" << interface.InternalName() << "'"
+                      << std::endl;
+        }
+
+        interface.MarkPipelined();
+    }
+    catch (legato::Exception e)
+    {
+        cyy_error(e.what());
+    }
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Add a provided (server-side) IPC API interface to a Component.
@@ -3,12 +3,25 @@
 %{
 
 #include <stdio.h>
+#include "ParsedFile.h"
 #include "ComponentParser.tab.h"
 #include "lex.cyy.h"
 #include "ComponentParserInternals.h"
 
+// The rules don't act on what they parse; they record it in the parsed file object that was
+// handed to the scanner (see ParsedFile.h).  Syntax errors are recorded the same way.
+#define cyy_error(scanner, errorString) \
+    yy_AddError(cyy_get_extra(scanner), cyy_get_lineno(scanner), errorString)
+
+#define STATEMENT(...) \
+    yy_AddStatement(cyy_get_extra(scanner), cyy_get_lineno(scanner), __VA_ARGS__, NULL)
+
 %}
 
+%define api.pure
+%lex-param {void* scanner}
+%parse-param {void* scanner}
+
 %error-verbose
 
 %union
@@ -28,6 +41,8 @@
 %token  BUNDLES_SECTION_LABEL;
 %token  API_SECTION_LABEL;
 %token  ASYNC_MODIFIER;
+%token  AWAIT_MODIFIER;
+%token  PIPELINED_MODIFIER;
 %token  TYPES_ONLY_MODIFIER;
 %token  MANUAL_START_MODIFIER;
 %token  FILE_SECTION_LABEL;
@@ -60,14 +75,17 @@ section
     | cflags_section
     | cxxflags_section
     | ldflags_section
-    | import_section        { cyy_error("'import:' section no longer supported.  Use 'api:' "
-                                        "subsection in 'requires:' section instead."); }
-    | export_section        { cyy_error("'export:' section no longer supported.  Use 'api:' "
-                                        "subsection in 'provides:' section instead."); }
+    | import_section        { cyy_error(scanner, "'import:' section no longer supported.  "
+                                                  "Use 'api:' subsection in 'requires:' section "
+                                                  "instead."); }
+    | export_section        { cyy_error(scanner, "'export:' section no longer supported.  "
+                                                  "Use 'api:' subsection in 'provides:' section "
+                                                  "instead."); }
     | requires_section
     | provides_section
-    | files_section         { cyy_error("'files:' section no longer supported.  Use 'file:' "
-                                        "subsection in 'bundles:' section instead."); }
+    | files_section         { cyy_error(scanner, "'files:' section no longer supported.  "
+                                                  "Use 'file:' subsection in 'bundles:' section "
+                                                  "instead."); }
     | bundles_section
     | pools_section
     | config_section
@@ -81,8 +99,8 @@ sources_section
 
 
 source_file_list
-    : file_path                     { cyy_AddSourceFile($1); }
-    | source_file_list file_path    { cyy_AddSourceFile($2); }
+    : file_path                     { STATEMENT(CYY_ADD_SOURCE_FILE, $1); }
+    | source_file_list file_path    { STATEMENT(CYY_ADD_SOURCE_FILE, $2); }
     ;
 
 
@@ -99,8 +117,8 @@ cflags_section
     ;
 
 cflags_list
-    : file_path                 { cyy_AddCFlag($1); }
-    | file_path cflags_list     { cyy_AddCFlag($1); }
+    : file_path                 { STATEMENT(CYY_ADD_CFLAG, $1); }
+    | file_path cflags_list     { STATEMENT(CYY_ADD_CFLAG, $1); }
     ;
 
 
@@ -110,8 +128,8 @@ cxxflags_section
     ;
 
 cxxflags_list
-    : file_path                 { cyy_AddCxxFlag($1); }
-    | file_path cxxflags_list   { cyy_AddCxxFlag($1); }
+    : file_path                 { STATEMENT(CYY_ADD_CXXFLAG, $1); }
+    | file_path cxxflags_list   { STATEMENT(CYY_ADD_CXXFLAG, $1); }
     ;
 
 
@@ -121,8 +139,8 @@ ldflags_section
     ;
 
 ldflags_list
-    : file_path                 { cyy_AddLdFlag($1); }
-    | file_path ldflags_list    { cyy_AddLdFlag($1); }
+    : file_path                 { STATEMENT(CYY_ADD_LDFLAG, $1); }
+    | file_path ldflags_list    { STATEMENT(CYY_ADD_LDFLAG, $1); }
     ;
 
 
@@ -210,8 +228,8 @@ bundled_file_list
 
 
 bundled_file
-    : file_path file_path               { cyy_AddBundledFile("[r]", $1, $2); }
-    | PERMISSIONS file_path file_path   { cyy_AddBundledFile($1, $2, $3); }
+    : file_path file_path               { STATEMENT(CYY_ADD_BUNDLED_FILE, "[r]", $1, $2); }
+    | PERMISSIONS file_path file_path   { STATEMENT(CYY_ADD_BUNDLED_FILE, $1, $2, $3); }
     ;
 
 
@@ -228,8 +246,8 @@ bundled_dir_list
 
 
 bundled_dir
-    : file_path file_path               { cyy_AddBundledDir("[r]", $1, $2); }
-    | PERMISSIONS file_path file_path   { cyy_AddBundledDir($1, $2, $3); }
+    : file_path file_path               { STATEMENT(CYY_ADD_BUNDLED_DIR, "[r]", $1, $2); }
+    | PERMISSIONS file_path file_path   { STATEMENT(CYY_ADD_BUNDLED_DIR, $1, $2, $3); }
     ;
 
 
@@ -267,12 +285,22 @@ required_api_list
 
 
 required_api
-    : file_path                                 { cyy_AddRequiredApi(NULL, $1); }
-    | file_path TYPES_ONLY_MODIFIER             { cyy_AddTypesOnlyRequiredApi(NULL, $1); }
-    | file_path MANUAL_START_MODIFIER           { cyy_AddManualStartRequiredApi(NULL, $1); }
-    | NAME '=' file_path                        { cyy_AddRequiredApi($1, $3); }
-    | NAME '=' file_path TYPES_ONLY_MODIFIER    { cyy_AddTypesOnlyRequiredApi($1, $3); }
-    | NAME '=' file_path MANUAL_START_MODIFIER  { cyy_AddManualStartRequiredApi($1, $3); }
+    : file_path                                 { STATEMENT(CYY_ADD_REQUIRED_API, "", $1); }
+    | file_path TYPES_ONLY_MODIFIER
+                                             { STATEMENT(CYY_ADD_TYPES_ONLY_REQUIRED_API, "", $1); }
+    | file_path MANUAL_START_MODIFIER
+                                           { STATEMENT(CYY_ADD_MANUAL_START_REQUIRED_API, "", $1); }
+    | file_path AWAIT_MODIFIER                  { STATEMENT(CYY_ADD_AWAIT_REQUIRED_API, "", $1); }
+    | file_path PIPELINED_MODIFIER
+                                              { STATEMENT(CYY_ADD_PIPELINED_REQUIRED_API, "", $1); }
+    | NAME '=' file_path                        { STATEMENT(CYY_ADD_REQUIRED_API, $1, $3); }
+    | NAME '=' file_path TYPES_ONLY_MODIFIER
+                                             { STATEMENT(CYY_ADD_TYPES_ONLY_REQUIRED_API, $1, $3); }
+    | NAME '=' file_path MANUAL_START_MODIFIER
+                                           { STATEMENT(CYY_ADD_MANUAL_START_REQUIRED_API, $1, $3); }
+    | NAME '=' file_path AWAIT_MODIFIER         { STATEMENT(CYY_ADD_AWAIT_REQUIRED_API, $1, $3); }
+    | NAME '=' file_path PIPELINED_MODIFIER
+                                              { STATEMENT(CYY_ADD_PIPELINED_REQUIRED_API, $1, $3); }
     ;
 
 
@@ -289,7 +317,7 @@ required_file_list
 
 
 required_file
-    : file_path file_path               { cyy_AddRequiredFile($1, $2); }
+    : file_path file_path               { STATEMENT(CYY_ADD_REQUIRED_FILE, $1, $2); }
     ;
 
 
@@ -306,7 +334,7 @@ required_dir_list
 
 
 required_dir
-    : file_path file_path               { cyy_AddRequiredDir($1, $2); }
+    : file_path file_path               { STATEMENT(CYY_ADD_REQUIRED_DIR, $1, $2); }
     ;
 
 
@@ -323,7 +351,7 @@ required_lib_list
 
 
 required_lib
-    : file_path     { cyy_AddRequiredLib($1); }
+    : file_path     { STATEMENT(CYY_ADD_REQUIRED_LIB, $1); }
     ;
 
 
@@ -340,7 +368,7 @@ required_component_list
 
 
 required_component
-    : file_path                 { cyy_AddRequiredComponent($1); }
+    : file_path                 { STATEMENT(CYY_ADD_REQUIRED_COMPONENT, $1); }
     ;
 
 
@@ -376,32 +404,35 @@ provided_api_list
 
 
 provided_api
-    : file_path                         { cyy_AddProvidedApi(NULL, $1); }
-    | file_path ASYNC_MODIFIER          { cyy_AddAsyncProvidedApi(NULL, $1); }
-    | file_path MANUAL_START_MODIFIER   { cyy_AddManualStartProvidedApi(NULL, $1); }
+    : file_path                         { STATEMENT(CYY_ADD_PROVIDED_API, "", $1); }
+    | file_path ASYNC_MODIFIER          { STATEMENT(CYY_ADD_ASYNC_PROVIDED_API, "", $1); }
+    | file_path MANUAL_START_MODIFIER   { STATEMENT(CYY_ADD_MANUAL_START_PROVIDED_API, "", $1); }
     | file_path ASYNC_MODIFIER MANUAL_START_MODIFIER
-                                                   { cyy_AddManualStartAsyncProvidedApi(NULL, $1); }
+                                     { STATEMENT(CYY_ADD_MANUAL_START_ASYNC_PROVIDED_API, "", $1); }
     | file_path MANUAL_START_MODIFIER ASYNC_MODIFIER
-                                                   { cyy_AddManualStartAsyncProvidedApi(NULL, $1); }
-    | NAME '=' file_path                { cyy_AddProvidedApi($1, $3); }
-    | NAME '=' file_path ASYNC_MODIFIER { cyy_AddAsyncProvidedApi($1, $3); }
-    | NAME '=' file_path MANUAL_START_MODIFIER      { cyy_AddManualStartProvidedApi($1, $3); }
+                                     { STATEMENT(CYY_ADD_MANUAL_START_ASYNC_PROVIDED_API, "", $1); }
+    | NAME '=' file_path                { STATEMENT(CYY_ADD_PROVIDED_API, $1, $3); }
+    | NAME '=' file_path ASYNC_MODIFIER { STATEMENT(CYY_ADD_ASYNC_PROVIDED_API, $1, $3); }
+    | NAME '=' file_path MANUAL_START_MODIFIER
+                                           { STATEMENT(CYY_ADD_MANUAL_START_PROVIDED_API, $1, $3); }
     | NAME '=' file_path ASYNC_MODIFIER MANUAL_START_MODIFIER
-                                                    { cyy_AddManualStartAsyncProvidedApi($1, $3); }
+                                     { STATEMENT(CYY_ADD_MANUAL_START_ASYNC_PROVIDED_API, $1, $3); }
     | NAME '=' file_path MANUAL_START_MODIFIER ASYNC_MODIFIER
-                                                    { cyy_AddManualStartAsyncProvidedApi($1, $3); }
+                                     { STATEMENT(CYY_ADD_MANUAL_START_ASYNC_PROVIDED_API, $1, $3); }
     ;
 
 
 provided_file_section
     : FILE_SECTION_LABEL
-                    { cyy_error("'file:' subsection not permitted inside 'provides:' section."); }
+                    { cyy_error(scanner,
+                                "'file:' subsection not permitted inside 'provides:' section."); }
     ;
 
 
 provided_dir_section
     : DIR_SECTION_LABEL
-                    { cyy_error("'dir:' subsection not permitted inside 'provides:' section."); }
+                    { cyy_error(scanner,
+                                "'dir:' subsection not permitted inside 'provides:' section."); }
     ;
 
 
@@ -418,12 +449,12 @@ pool_list
 
 
 pool
-    : NAME '=' NUMBER   { cyy_error("'pools:' section not yet implemented."); }
+    : NAME '=' NUMBER   { cyy_error(scanner, "'pools:' section not yet implemented."); }
     ;
 
 
 config_section
-    : CONFIG_SECTION_LABEL  { cyy_error("'config:' section not yet implemented."); }
+    : CONFIG_SECTION_LABEL  { cyy_error(scanner, "'config:' section not yet implemented."); }
     ;
 
 %%
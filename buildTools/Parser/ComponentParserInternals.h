@@ -19,30 +19,62 @@
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Component parsing function, implemented by the Bison-generated parser.
+ * Types of statements recorded by the parser (see ParsedFile.h).  Each is applied by calling the
+ * function of the same name, below, with the statement's arguments.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef enum
+{
+    CYY_ADD_SOURCE_FILE = 1,                    ///< cyy_AddSourceFile()
+    CYY_ADD_CFLAG,                              ///< cyy_AddCFlag()
+    CYY_ADD_CXXFLAG,                            ///< cyy_AddCxxFlag()
+    CYY_ADD_LDFLAG,                             ///< cyy_AddLdFlag()
+    CYY_ADD_BUNDLED_FILE,                       ///< cyy_AddBundledFile()
+    CYY_ADD_BUNDLED_DIR,                        ///< cyy_AddBundledDir()
+    CYY_ADD_REQUIRED_API,                       ///< cyy_AddRequiredApi()
+    CYY_ADD_TYPES_ONLY_REQUIRED_API,            ///< cyy_AddTypesOnlyRequiredApi()
+    CYY_ADD_MANUAL_START_REQUIRED_API,          ///< cyy_AddManualStartRequiredApi()
+    CYY_ADD_AWAIT_REQUIRED_API,                 ///< cyy_AddAwaitRequiredApi()
+    CYY_ADD_PIPELINED_REQUIRED_API,             ///< cyy_AddPipelinedRequiredApi()
+    CYY_ADD_REQUIRED_FILE,                      ///< cyy_AddRequiredFile()
+    CYY_ADD_REQUIRED_DIR,                       ///< cyy_AddRequiredDir()
+    CYY_ADD_REQUIRED_LIB,                       ///< cyy_AddRequiredLib()
+    CYY_ADD_REQUIRED_COMPONENT,                 ///< cyy_AddRequiredComponent()
+    CYY_ADD_PROVIDED_API,                       ///< cyy_AddProvidedApi()
+    CYY_ADD_ASYNC_PROVIDED_API,                 ///< cyy_AddAsyncProvidedApi()
+    CYY_ADD_MANUAL_START_PROVIDED_API,          ///< cyy_AddManualStartProvidedApi()
+    CYY_ADD_MANUAL_START_ASYNC_PROVIDED_API     ///< cyy_AddManualStartAsyncProvidedApi()
+}
+cyy_StatementType_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Component parsing function, implemented by the Bison-generated parser.  Records the statements
+ * found by a reentrant scanner in the scanner's parsed file object (its "extra" data).
  *
  * @note    cyy_parse() may return a non-zero value before parsing has finished, because an error
  *          was encountered.  To aide in troubleshooting, cyy_parse() can be called again to look
  *          for further errors.  However, there's no point in doing this if the end-of-file has
- *          been reached.  cyy_EndOfFile can be used to check for end of file.
+ *          been reached.
  *
  * @return 0 when parsing successfully completes.  Non-zero when an error is encountered.
  */
 //--------------------------------------------------------------------------------------------------
-int cyy_parse(void);
+int cyy_parse(void* scanner);
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * End of file flag.  This is set when cyy_parse() returns due to an end of file condition.
+ * Number of the line that the statement currently being applied was found on.
  */
 //--------------------------------------------------------------------------------------------------
-extern int cyy_EndOfFile;
+extern int cyy_LineNum;
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Count of the number of errors that have been reported during scanning.
+ * Count of the number of errors that have been reported for the file being parsed.
  */
 //--------------------------------------------------------------------------------------------------
 extern size_t cyy_ErrorCount;
@@ -67,8 +99,8 @@ extern int cyy_IsVerbose;
 
 //--------------------------------------------------------------------------------------------------
 /**
- * The standard error reporting function that will be called by both the
- * lexer and the parser when they detect errors or when the YYERROR macro is invoked.
+ * The standard error reporting function.  Called for each error recorded by the scanner and the
+ * parser, and by the functions below when they detect errors.
  */
 //--------------------------------------------------------------------------------------------------
 void cyy_error(const char* errorString);
@@ -252,6 +284,41 @@ void cyy_AddManualStartRequiredApi
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add an await-style required (client-side) IPC API interface to a Component.
+ *
+ * The generated client-side functions will only suspend the calling coroutine (if any), rather
+ * than the whole thread, while waiting for the server to respond.
+ **/
+//--------------------------------------------------------------------------------------------------
+void cyy_AddAwaitRequiredApi
+(
+    const char* instanceName,   ///< Interface instance name or
+                                ///  NULL if should be derived from .api file name.
+
+    const char* apiFile         ///< Path to the .api file.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add a required (client-side) IPC API interface to a Component, with pipelined client-side
+ * functions.
+ *
+ * Besides the usual functions, Start and Finish functions are generated, which send a request
+ * and collect its response separately, so that several requests can be in flight at once.
+ **/
+//--------------------------------------------------------------------------------------------------
+void cyy_AddPipelinedRequiredApi
+(
+    const char* instanceName,   ///< Interface instance name or
+                                ///  NULL if should be derived from .api file name.
+
+    const char* apiFile         ///< Path to the .api file.
+);
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Add a provided (server-side) IPC API interface to a Component.
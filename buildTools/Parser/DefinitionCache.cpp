@@ -0,0 +1,711 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * Implementation of the cache of parsed definition files shared by the System, Application and
+ * Component Parsers.
+ *
+ * Every file that is asked for gets an entry in the cache.  A file is parsed either by the thread
+ * that asks for it or, if it was prefetched, by a worker thread.  Worker threads are started as
+ * files are prefetched, up to one per CPU (or as set by
+ * legato::parser::SetMaxParseThreads()), and wait for more work until the program exits.
+ *
+ * Copyright (C) 2014, Sierra Wireless Inc.  Use of this work is subject to license.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "LegatoObjectModel.h"
+#include "Parser.h"
+#include "DefinitionCache.h"
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <stdarg.h>
+#include <string.h>
+#include <sys/stat.h>
+
+
+namespace
+{
+
+/// Start of the first line of the cache file.
+const char CacheFileHeaderPrefix[] = "# mk definition cache 1";
+
+/// 64-bit FNV-1a hash parameters.
+const uint64_t FnvOffsetBasis = 0xcbf29ce484222325ULL;
+const uint64_t FnvPrime = 0x100000001b3ULL;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Where a file in the cache is at.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef enum
+{
+    QUEUED,         ///< Waiting for a worker thread to parse it.
+    PARSING,        ///< Being parsed.
+    DONE            ///< Parsed (or failed to be read).
+}
+EntryState_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A file in the cache.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    EntryState_t state;
+    yy_ParseFunc_t parseFunc;       ///< Function to use to parse the file.
+    yy_ParsedFile_t file;           ///< The parsed file (once state is DONE).
+    std::string errorMsg;           ///< Why the file couldn't be read ("" = it could).
+}
+Entry_t;
+
+
+/// Cached files, by path.  std::map never moves its elements, so references to the parsed files
+/// stay valid as more files are added.
+std::map<std::string, Entry_t> Entries;
+
+/// Paths of the files waiting to be parsed by a worker thread, oldest first.
+std::list<std::string> Queue;
+
+/// Worker threads that have been started.
+std::list<std::thread> Workers;
+
+/// Number of worker threads waiting for something to parse.
+size_t NumIdleWorkers = 0;
+
+/// Maximum number of worker threads (0 = files are only parsed when they are asked for).
+size_t MaxWorkers = std::max(std::thread::hardware_concurrency(), 1u);
+
+/// true = the program is exiting, so the worker threads should too.
+bool IsShuttingDown = false;
+
+/// Protects all of the above.
+std::mutex Mutex;
+
+/// Signalled whenever a file is queued for the workers, or they should exit.
+std::condition_variable WorkQueued;
+
+/// Signalled whenever a file is done being parsed.
+std::condition_variable FileDone;
+
+/// Parsed files loaded from the cache file, by path.  Never changed once parsing starts, so the
+/// worker threads can read it without holding the mutex.
+std::map<std::string, yy_ParsedFile_t> LoadedFiles;
+
+/// Path of the cache file ("" = LoadDefinitionCache() hasn't been called).
+std::string CacheFilePath;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Stops the worker threads at exit, so they don't outlive the things they use.  A worker that is
+ * in the middle of parsing a file finishes it first.
+ */
+//--------------------------------------------------------------------------------------------------
+class WorkerReaper_t
+{
+    public:
+
+        ~WorkerReaper_t()
+        {
+            {
+                std::lock_guard<std::mutex> lock(Mutex);
+                IsShuttingDown = true;
+                Queue.clear();
+            }
+
+            WorkQueued.notify_all();
+
+            for (auto& thread : Workers)
+            {
+                thread.join();
+            }
+        }
+};
+
+/// Must be defined after everything the workers use, so it is destroyed before them.
+WorkerReaper_t WorkerReaper;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the cache entry for a file, creating a new one (waiting to be parsed) if there isn't one.
+ * The mutex must be held.
+ *
+ * @return The entry.
+ */
+//--------------------------------------------------------------------------------------------------
+Entry_t& GetEntry
+(
+    const std::string& filePath,
+    yy_ParseFunc_t parseFunc
+)
+//--------------------------------------------------------------------------------------------------
+{
+    auto i = Entries.find(filePath);
+
+    if (i == Entries.end())
+    {
+        Entry_t& entry = Entries[filePath];
+
+        entry.state = QUEUED;
+        entry.parseFunc = parseFunc;
+
+        return entry;
+    }
+
+    return i->second;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the first line of the cache file.  The statement types recorded in the cache depend on the
+ * parsers' grammars, so the line identifies the mk executable that wrote it, and cache files
+ * written by any other build of mk are ignored.
+ *
+ * @return The header line.
+ */
+//--------------------------------------------------------------------------------------------------
+std::string GetCacheFileHeader
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    std::stringstream header;
+
+    header << CacheFileHeaderPrefix;
+
+    struct stat exeStat;
+
+    if (stat("/proc/self/exe", &exeStat) == 0)
+    {
+        header << ' ' << exeStat.st_size << ' ' << exeStat.st_mtime;
+    }
+
+    return header.str();
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Compute the FNV-1a hash of the contents of a file.
+ *
+ * @return The hash.
+ */
+//--------------------------------------------------------------------------------------------------
+uint64_t HashContents
+(
+    const std::string& contents
+)
+//--------------------------------------------------------------------------------------------------
+{
+    uint64_t hash = FnvOffsetBasis;
+
+    for (unsigned char c : contents)
+    {
+        hash ^= c;
+        hash *= FnvPrime;
+    }
+
+    return hash;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read and parse a file, or reuse the statements loaded from the cache file if the file hasn't
+ * changed.  Can be run by any thread, without holding the mutex.
+ */
+//--------------------------------------------------------------------------------------------------
+void ParseFile
+(
+    const std::string& filePath,
+    yy_ParseFunc_t parseFunc,
+    yy_ParsedFile_t& file,          ///< [OUT] The parsed file.
+    std::string& errorMsg           ///< [OUT] Why the file couldn't be read (if it couldn't).
+)
+//--------------------------------------------------------------------------------------------------
+{
+    std::ifstream stream(filePath);
+
+    if (!stream.is_open())
+    {
+        int error = errno;
+        std::stringstream errorMessage;
+        errorMessage << "Failed to open file '" << filePath << "'." <<
+                        " Errno = " << error << "(" << strerror(error) << ").";
+        errorMsg = errorMessage.str();
+        return;
+    }
+
+    std::stringstream contents;
+    contents << stream.rdbuf();
+
+    file.hash = HashContents(contents.str());
+    file.errorCount = 0;
+    file.isEndOfFile = false;
+
+    auto i = LoadedFiles.find(filePath);
+
+    if ((i != LoadedFiles.end()) && (i->second.hash == file.hash))
+    {
+        file.statements = i->second.statements;
+        file.isEndOfFile = true;
+    }
+    else
+    {
+        parseFunc(&file, contents.str());
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Worker thread main function.  Parses queued files until the program exits.
+ */
+//--------------------------------------------------------------------------------------------------
+void RunWorker
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    std::unique_lock<std::mutex> lock(Mutex);
+
+    for (;;)
+    {
+        while (Queue.empty() && !IsShuttingDown)
+        {
+            NumIdleWorkers++;
+            WorkQueued.wait(lock);
+            NumIdleWorkers--;
+        }
+
+        if (IsShuttingDown)
+        {
+            return;
+        }
+
+        std::string filePath = Queue.front();
+        Queue.pop_front();
+
+        Entry_t& entry = Entries[filePath];
+
+        // The thread that wants the file may have got tired of waiting and parsed it itself.
+        if (entry.state != QUEUED)
+        {
+            continue;
+        }
+
+        entry.state = PARSING;
+
+        lock.unlock();
+        ParseFile(filePath, entry.parseFunc, entry.file, entry.errorMsg);
+        lock.lock();
+
+        entry.state = DONE;
+        FileDone.notify_all();
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write a string to the cache file, prefixed by its length, so it can contain anything.
+ */
+//--------------------------------------------------------------------------------------------------
+void WriteString
+(
+    std::ostream& stream,
+    const std::string& string
+)
+//--------------------------------------------------------------------------------------------------
+{
+    stream << string.size() << ' ' << string << '\n';
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read a string written by WriteString().
+ *
+ * @return true if successful.
+ */
+//--------------------------------------------------------------------------------------------------
+bool ReadString
+(
+    std::istream& stream,
+    std::string& string
+)
+//--------------------------------------------------------------------------------------------------
+{
+    size_t length;
+
+    if (!(stream >> length) || (stream.get() != ' ') || (length > 0x100000))
+    {
+        return false;
+    }
+
+    string.resize(length);
+
+    return (stream.read(&string[0], length) && (stream.get() == '\n'));
+}
+
+
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// NOTE: The following functions are called from C code inside the bison-generated parser and the
+//       flex-generated scanner code, possibly on several threads at once.
+//--------------------------------------------------------------------------------------------------
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Record a statement in a parsed file.  The statement's arguments follow the statement type and
+ * must be followed by a NULL.
+ */
+//--------------------------------------------------------------------------------------------------
+void yy_AddStatement
+(
+    yy_ParsedFile_t* filePtr,
+    int lineNum,
+    int type,
+    ...
+)
+//--------------------------------------------------------------------------------------------------
+{
+    legato::parser::Statement_t statement;
+
+    statement.type = type;
+    statement.lineNum = lineNum;
+
+    va_list args;
+    va_start(args, type);
+
+    const char* argPtr;
+    while ((argPtr = va_arg(args, const char*)) != NULL)
+    {
+        statement.args.push_back(argPtr);
+    }
+
+    va_end(args);
+
+    filePtr->statements.push_back(std::move(statement));
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Record an error found while scanning or parsing a file.
+ */
+//--------------------------------------------------------------------------------------------------
+void yy_AddError
+(
+    yy_ParsedFile_t* filePtr,
+    int lineNum,
+    const char* errorString
+)
+//--------------------------------------------------------------------------------------------------
+{
+    yy_AddStatement(filePtr, lineNum, YY_ERROR_STATEMENT, errorString, NULL);
+
+    filePtr->errorCount++;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Record that the scanner has reached the end of a file.
+ */
+//--------------------------------------------------------------------------------------------------
+void yy_MarkEndOfFile
+(
+    yy_ParsedFile_t* filePtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    filePtr->isEndOfFile = true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get a parsed file, parsing the file now if it hasn't been parsed yet (or waiting for it to
+ * finish if it is being parsed on a worker thread).
+ *
+ * @return The parsed file.  It stays valid until the program exits.
+ *
+ * @throw legato::Exception if the file can't be read.
+ */
+//--------------------------------------------------------------------------------------------------
+const yy_ParsedFile_t& yy_GetParsedFile
+(
+    const std::string& filePath,
+    yy_ParseFunc_t parseFunc
+)
+//--------------------------------------------------------------------------------------------------
+{
+    std::unique_lock<std::mutex> lock(Mutex);
+
+    Entry_t& entry = GetEntry(filePath, parseFunc);
+
+    // If no-one has started parsing it, do it ourselves rather than wait for a worker.
+    if (entry.state == QUEUED)
+    {
+        entry.state = PARSING;
+
+        lock.unlock();
+        ParseFile(filePath, parseFunc, entry.file, entry.errorMsg);
+        lock.lock();
+
+        entry.state = DONE;
+        FileDone.notify_all();
+    }
+
+    while (entry.state != DONE)
+    {
+        FileDone.wait(lock);
+    }
+
+    if (!entry.errorMsg.empty())
+    {
+        throw legato::Exception(entry.errorMsg);
+    }
+
+    return entry.file;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start parsing a file on a worker thread, unless it has already been (or is being) parsed.
+ * Errors are only reported when the parsed file is fetched using yy_GetParsedFile().
+ */
+//--------------------------------------------------------------------------------------------------
+void yy_PrefetchParsedFile
+(
+    const std::string& filePath,
+    yy_ParseFunc_t parseFunc
+)
+//--------------------------------------------------------------------------------------------------
+{
+    std::lock_guard<std::mutex> lock(Mutex);
+
+    if ((MaxWorkers == 0) || (Entries.find(filePath) != Entries.end()))
+    {
+        return;
+    }
+
+    GetEntry(filePath, parseFunc);
+
+    Queue.push_back(filePath);
+
+    if (NumIdleWorkers > 0)
+    {
+        WorkQueued.notify_one();
+    }
+    else if (Workers.size() < MaxWorkers)
+    {
+        Workers.push_back(std::thread(RunWorker));
+    }
+}
+
+
+namespace legato
+{
+
+namespace parser
+{
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set the maximum number of definition files that can be parsed at the same time, counting the
+ * thread that asks for them.  With 1, each file is parsed on the thread that asks for it, when
+ * it asks for it.  Must be called before anything is parsed.
+ **/
+//--------------------------------------------------------------------------------------------------
+void SetMaxParseThreads
+(
+    int maxThreads      ///< [in] Maximum number of threads, or 0 (or less) for one per CPU.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    std::lock_guard<std::mutex> lock(Mutex);
+
+    if (maxThreads <= 0)
+    {
+        MaxWorkers = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+    else
+    {
+        MaxWorkers = maxThreads - 1;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Load the cache of parsed definition files (.sdef, .adef, .cdef) from a file written by an
+ * earlier run.  Files whose contents match a cached file's won't have to be parsed again.  A
+ * missing or unreadable cache file is ignored.  Must be called before anything is parsed.
+ **/
+//--------------------------------------------------------------------------------------------------
+void LoadDefinitionCache
+(
+    const std::string& cacheFilePath    ///< [in] Path of the cache file.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    CacheFilePath = cacheFilePath;
+
+    std::ifstream cacheFile(CacheFilePath);
+    std::string line;
+
+    if (!std::getline(cacheFile, line) || (line != GetCacheFileHeader()))
+    {
+        return;
+    }
+
+    // Each file is a line with its hash and number of statements, followed by its path.  Each
+    // statement is a line with its type, line number and number of arguments, followed by the
+    // arguments.
+    std::string path;
+    yy_ParsedFile_t file;
+    size_t numStatements;
+
+    while (   (cacheFile >> std::hex >> file.hash >> std::dec >> numStatements)
+           && ReadString(cacheFile, path) )
+    {
+        file.statements.clear();
+
+        for (size_t i = 0; i < numStatements; i++)
+        {
+            Statement_t statement;
+            size_t numArgs;
+
+            if (!(cacheFile >> statement.type >> statement.lineNum >> numArgs))
+            {
+                return;
+            }
+
+            statement.args.resize(numArgs);
+
+            for (auto& arg : statement.args)
+            {
+                if (!ReadString(cacheFile, arg))
+                {
+                    return;
+                }
+            }
+
+            file.statements.push_back(std::move(statement));
+        }
+
+        LoadedFiles[path] = file;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Save the definition files parsed without errors to the cache file given to
+ * LoadDefinitionCache().  Does nothing if LoadDefinitionCache() hasn't been called.
+ *
+ * @throw legato::Exception if the file can't be written.
+ **/
+//--------------------------------------------------------------------------------------------------
+void SaveDefinitionCache
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (CacheFilePath.empty())
+    {
+        return;
+    }
+
+    // Files that were loaded but not used this time are kept, in case they're needed next time.
+    std::map<std::string, yy_ParsedFile_t> savedFiles = LoadedFiles;
+
+    std::unique_lock<std::mutex> lock(Mutex);
+
+    for (auto& mapEntry : Entries)
+    {
+        Entry_t& entry = mapEntry.second;
+
+        while (entry.state == PARSING)
+        {
+            FileDone.wait(lock);
+        }
+
+        if (   (entry.state == DONE)
+            && entry.errorMsg.empty()
+            && (entry.file.errorCount == 0)
+            && entry.file.isEndOfFile )
+        {
+            savedFiles[mapEntry.first] = entry.file;
+        }
+    }
+
+    lock.unlock();
+
+    legato::MakeDir(legato::GetContainingDir(CacheFilePath));
+
+    // Write to a temporary file first, so an interrupted build can't leave a corrupted cache.
+    std::string tempFilePath = CacheFilePath + ".tmp";
+    {
+        std::ofstream cacheFile(tempFilePath, std::ofstream::trunc);
+
+        if (!cacheFile.is_open())
+        {
+            throw legato::Exception("Failed to open '" + tempFilePath + "' for writing.");
+        }
+
+        cacheFile << GetCacheFileHeader() << '\n';
+
+        for (const auto& mapEntry : savedFiles)
+        {
+            const yy_ParsedFile_t& file = mapEntry.second;
+
+            cacheFile << std::hex << file.hash << std::dec << ' ' << file.statements.size() << ' ';
+            WriteString(cacheFile, mapEntry.first);
+
+            for (const auto& statement : file.statements)
+            {
+                cacheFile << statement.type << ' ' << statement.lineNum << ' '
+                          << statement.args.size() << '\n';
+
+                for (const auto& arg : statement.args)
+                {
+                    WriteString(cacheFile, arg);
+                }
+            }
+        }
+
+        if (!cacheFile.flush())
+        {
+            throw legato::Exception("Failed to write to '" + tempFilePath + "'.");
+        }
+    }
+
+    if (rename(tempFilePath.c_str(), CacheFilePath.c_str()) != 0)
+    {
+        throw legato::Exception("Failed to rename '" + tempFilePath + "' to '" + CacheFilePath
+                                + "'.");
+    }
+}
+
+
+}   // namespace parser
+
+}   // namespace legato
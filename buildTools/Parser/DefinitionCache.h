@@ -0,0 +1,106 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * The cache of parsed definition files (.sdef, .adef, .cdef) shared by the System, Application
+ * and Component Parsers.  Not to be shared outside the parser.
+ *
+ * Each file is only scanned and parsed once per run, no matter how many times it is used.  Files
+ * that are known to be needed soon can be handed to yy_PrefetchParsedFile(), which parses them
+ * on worker threads while the parser carries on with the file it is working on.  Parsed files
+ * are also kept on disk between runs (see legato::parser::LoadDefinitionCache()), keyed by their
+ * contents, so files that haven't changed aren't parsed again.
+ *
+ * Copyright (C) 2014, Sierra Wireless Inc.  Use of this work is subject to license.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#ifndef DEFINITION_CACHE_H_INCLUDE_GUARD
+#define DEFINITION_CACHE_H_INCLUDE_GUARD
+
+extern "C"
+{
+    #include "ParsedFile.h"
+}
+
+
+namespace legato
+{
+
+namespace parser
+{
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A statement recorded by one of the parsers.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    int type;                       ///< Statement type (YY_ERROR_STATEMENT or parser-specific).
+    int lineNum;                    ///< Line number the statement was found on.
+    std::vector<std::string> args;  ///< Arguments (for errors, the error message).
+}
+Statement_t;
+
+}
+
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A scanned and parsed definition file.
+ */
+//--------------------------------------------------------------------------------------------------
+struct yy_ParsedFile
+{
+    uint64_t hash;                  ///< Hash of the contents of the file.
+    std::vector<legato::parser::Statement_t> statements;    ///< Statements, in file order.
+    size_t errorCount;              ///< Number of errors found while scanning and parsing.
+    bool isEndOfFile;               ///< true if the scanner has reached the end of the file.
+};
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Function that scans and parses the contents of a file, recording the statements found in it
+ * in a parsed file object.  Each parser has one.  It must not touch any global state.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef void (*yy_ParseFunc_t)
+(
+    yy_ParsedFile_t* filePtr,       ///< [IN/OUT] Object to record the statements in.
+    const std::string& contents     ///< [IN] Contents of the file.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get a parsed file, parsing the file now if it hasn't been parsed yet (or waiting for it to
+ * finish if it is being parsed on a worker thread).
+ *
+ * @return The parsed file.  It stays valid until the program exits.
+ *
+ * @throw legato::Exception if the file can't be read.
+ */
+//--------------------------------------------------------------------------------------------------
+const yy_ParsedFile_t& yy_GetParsedFile
+(
+    const std::string& filePath,
+    yy_ParseFunc_t parseFunc
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start parsing a file on a worker thread, unless it has already been (or is being) parsed.
+ * Errors are only reported when the parsed file is fetched using yy_GetParsedFile().
+ */
+//--------------------------------------------------------------------------------------------------
+void yy_PrefetchParsedFile
+(
+    const std::string& filePath,
+    yy_ParseFunc_t parseFunc
+);
+
+
+#endif // DEFINITION_CACHE_H_INCLUDE_GUARD
@@ -0,0 +1,79 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * Definitions used by the scanners and parsers to record what they find in a definition file
+ * (.sdef, .adef or .cdef).  Not to be shared outside the parser.
+ *
+ * The Bison-generated parsers don't act on what they parse.  Instead, each grammar rule records
+ * a statement (a statement type, the line number and the rule's string arguments) in a parsed
+ * file object.  The statements are later applied to the object model by the parser's own C++
+ * code, in the order they appear in the file.  This keeps the scanners and parsers free of any
+ * global state, so that several files can be parsed at the same time, and lets parsed files be
+ * cached.
+ *
+ * @warning THIS FILE IS INCLUDED FROM C CODE.
+ *
+ * Copyright (C) 2014, Sierra Wireless Inc.  Use of this work is subject to license.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#ifndef PARSED_FILE_H_INCLUDE_GUARD
+#define PARSED_FILE_H_INCLUDE_GUARD
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Statement type used for errors found while scanning or parsing.  Each parser's own statement
+ * types start at 1.
+ */
+//--------------------------------------------------------------------------------------------------
+#define YY_ERROR_STATEMENT 0
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A file that is being (or has been) scanned and parsed.  Opaque to C code.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct yy_ParsedFile yy_ParsedFile_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Record a statement in a parsed file.  The statement's arguments follow the statement type and
+ * must be followed by a NULL.  A NULL argument can't be recorded; use "" instead.
+ */
+//--------------------------------------------------------------------------------------------------
+void yy_AddStatement
+(
+    yy_ParsedFile_t* filePtr,
+    int lineNum,
+    int type,
+    ...
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Record an error found while scanning or parsing a file.
+ */
+//--------------------------------------------------------------------------------------------------
+void yy_AddError
+(
+    yy_ParsedFile_t* filePtr,
+    int lineNum,
+    const char* errorString
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Record that the scanner has reached the end of a file.
+ */
+//--------------------------------------------------------------------------------------------------
+void yy_MarkEndOfFile
+(
+    yy_ParsedFile_t* filePtr
+);
+
+
+#endif // PARSED_FILE_H_INCLUDE_GUARD
@@ -94,6 +94,101 @@ Api_t* GetApiObject
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the definition of a .api file: what it declares, and what the files it imports declare,
+ * with the given prefix added to the names of the things it declares.
+ *
+ * Each .api file is only read and parsed once, and each definition is only resolved once.  The
+ * definitions are kept until the program exits, so the returned reference stays valid.
+ *
+ * @return The definition.
+ *
+ * @throw legato::Exception if there is an error in one of the files, or an imported file can't
+ *        be found.
+ **/
+//--------------------------------------------------------------------------------------------------
+const api::Definition_t& GetApiDefinition
+(
+    const std::string& filePath,            ///< [in] Path of the .api file.
+    const std::string& namePrefix,          ///< [in] Prefix for the names of generated code.
+    const std::list<std::string>& importDirs///< [in] Where to look for imported files (after
+                                            ///       the .api file's own directory).
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the paths of all the files imported by a .api file, directly or indirectly, in the order
+ * they need to be processed.
+ *
+ * @return The list of paths.
+ *
+ * @throw legato::Exception if a file can't be read or an imported file can't be found.
+ **/
+//--------------------------------------------------------------------------------------------------
+std::list<std::string> GetApiImportList
+(
+    const std::string& filePath,            ///< [in] Path of the .api file.
+    const std::list<std::string>& importDirs///< [in] Where to look for imported files (after
+                                            ///       the .api file's own directory).
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the paths of all the definition (.sdef, .adef, .cdef) and .api files that have been parsed
+ * so far.
+ *
+ * @return The set of file paths.
+ **/
+//--------------------------------------------------------------------------------------------------
+const std::set<std::string>& GetParsedFiles
+(
+    void
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set the maximum number of definition files (.sdef, .adef, .cdef) that can be parsed at the same
+ * time, counting the thread that asks for them.  With 1, files are parsed one at a time, when
+ * they are needed.  Must be called before anything is parsed.
+ **/
+//--------------------------------------------------------------------------------------------------
+void SetMaxParseThreads
+(
+    int maxThreads      ///< [in] Maximum number of threads, or 0 (or less) for one per CPU.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Load the cache of parsed definition files (.sdef, .adef, .cdef) from a file written by an
+ * earlier run.  Files whose contents match a cached file's won't have to be parsed again.  A
+ * missing or unreadable cache file is ignored.  Must be called before anything is parsed.
+ **/
+//--------------------------------------------------------------------------------------------------
+void LoadDefinitionCache
+(
+    const std::string& cacheFilePath    ///< [in] Path of the cache file.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Save the definition files parsed without errors to the cache file given to
+ * LoadDefinitionCache().  Does nothing if LoadDefinitionCache() hasn't been called.
+ *
+ * @throw legato::Exception if the file can't be written.
+ **/
+//--------------------------------------------------------------------------------------------------
+void SaveDefinitionCache
+(
+    void
+);
+
+
 }   // namespace parser
 
 }   // namespace legato
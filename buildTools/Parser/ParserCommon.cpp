@@ -17,6 +17,7 @@ extern "C"
 }
 
 #include <limits.h>
+#include <algorithm>
 
 
 //=======================================================
@@ -24,6 +25,26 @@ extern "C"
 //=======================================================
 
 
+/// Paths of all the definition and .api files that have been parsed.
+static std::set<std::string> ParsedFiles;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Records the path of a definition (.sdef, .adef, .cdef) or .api file that has been parsed.
+ **/
+//--------------------------------------------------------------------------------------------------
+void yy_AddParsedFile
+(
+    const std::string& path
+)
+//--------------------------------------------------------------------------------------------------
+{
+    ParsedFiles.insert(path);
+}
+
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * File permissions flags translation function.  Converts text like "[rwx]" into a number which
@@ -165,6 +186,24 @@ std::string yy_StripQuotes
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets an optional argument of a statement recorded by a parser.  Omitted arguments are recorded
+ * as empty strings.
+ *
+ * @return  The argument, or NULL if it was omitted.
+ */
+//--------------------------------------------------------------------------------------------------
+const char* yy_OptionalArg
+(
+    const std::string& arg
+)
+//--------------------------------------------------------------------------------------------------
+{
+    return (arg.empty() ? NULL : arg.c_str());
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Checks whether a given required file's on-target file system path (outside the app's runtime
@@ -701,8 +740,13 @@ static legato::ComponentInstance* AddComponentToExe
 
             subInstancePtr = AddComponentToExe(appPtr, exePtr, mapEntry.second, isVerbose);
 
-            // Add the sub-instance to the instance's set of sub-instances.
-            instancePtr->SubInstances().insert(subInstancePtr);
+            // Add the sub-instance to the instance's list of sub-instances (once).
+            auto& subInstances = instancePtr->SubInstances();
+            if (std::find(subInstances.begin(), subInstances.end(), subInstancePtr)
+                == subInstances.end())
+            {
+                subInstances.push_back(subInstancePtr);
+            }
         }
     }
     // If a dependency loop was detected at a deeper level, catch the exception that was thrown
@@ -782,128 +826,69 @@ legato::Api_t* legato::parser::GetApiObject
 
     // Create a new object for this path.
     apiPtr = new legato::Api_t(filePath);
+    yy_AddParsedFile(filePath);
 
-    // Use ifgen to determine the dependencies and compute the hash.
-    std::stringstream commandLine;
-    commandLine << "ifgen --hash " << filePath;
-
-    // Specify all the interface search directories as places to look for interface files.
-    for (auto dir : buildParams.InterfaceDirs())
+    // Parse the .api file (and the files it imports) to find its dependencies and compute its
+    // hash.  Use the same name prefix that mkif uses by default, so the definition won't have to
+    // be resolved again when the code for this API is generated.
+    std::string namePrefix = GetLastPathNode(filePath);
+    size_t dotPos = namePrefix.rfind('.');
+    if ((dotPos != std::string::npos) && (namePrefix.find_first_not_of('.') < dotPos))
     {
-        commandLine << " --import-dir " << dir;
+        namePrefix.erase(dotPos);
     }
 
     if (buildParams.IsVerbose())
     {
-        std::cout << commandLine.str() << std::endl;
+        std::cout << "Parsing API '" << filePath << "'" << std::endl;
     }
 
-    FILE* output = popen(commandLine.str().c_str(), "r");
+    // Search the same directories, in the same order, as the mkif command-lines mk generates.
+    std::list<std::string> importDirs = buildParams.InterfaceDirs();
+    importDirs.push_back(GetContainingDir(filePath));
 
-    if (output == NULL)
-    {
-        throw Exception("Could not exec ifgen to generate an interface hash.");
-    }
+    const legato::api::Definition_t& definition =
+                                            GetApiDefinition(filePath, namePrefix, importDirs);
 
-    char buffer[1024] = { 0 };
-    static const size_t bufferSize = sizeof(buffer);
-
-    for (;;)
+    for (const auto& importPath : definition.importPaths)
     {
-        if (fgets(buffer, bufferSize, output) != buffer)
-        {
-            pclose(output); // Don't care about return code.
+        std::string otherApiFilePath = AbsolutePath(importPath);
 
-            std::stringstream msg;
-            msg << "Failed to receive the interface hash from ifgen. Errno = ";
-            msg << strerror(errno);
-            throw Exception(msg.str());
-        }
-
-        // Remove any trailing newline character.
-        size_t len = strlen(buffer);
-        if (buffer[len - 1] == '\n')
+        if (buildParams.IsVerbose())
         {
-            buffer[len - 1] = '\0';
+            std::cout << "    API '" << filePath << "' depends on API '"
+                      << otherApiFilePath << "'" << std::endl;
         }
 
-        // If we received "importing foo.api", then add "foo.api" to the list of dependencies.
-        const char importingString[] = "importing ";
-        if (strncmp(buffer, importingString, sizeof(importingString) - 1) == 0)
-        {
-            if (buffer[sizeof(importingString)] == '\0')
-            {
-                std::cerr << "WARNING: ifgen reported an empty dependency." << std::endl;
-            }
-            else
-            {
-                std::string otherApiFilePath;
-                otherApiFilePath = legato::FindFile((buffer + sizeof(importingString) - 1),
-                                                    buildParams.InterfaceDirs());
-
-                if (!IsAbsolutePath(otherApiFilePath))
-                {
-                    otherApiFilePath = CombinePath(GetContainingDir(filePath), otherApiFilePath);
-                }
-
-                if (buildParams.IsVerbose())
-                {
-                    std::cout << "    API '" << filePath << "' depends on API '"
-                              << otherApiFilePath << "'" << std::endl;
-                }
-
-                try
-                {
-                    apiPtr->AddDependency(GetApiObject(otherApiFilePath, buildParams));
-                }
-                catch (legato::Exception& e)
-                {
-                    // Close the connection and collect the exit code from ifgen.
-                    int result = pclose(output);
-                    if (result == -1)
-                    {
-                        std::stringstream msg;
-                        msg << "ifgen failed. errno = ";
-                        msg << strerror(errno);
-                        throw Exception(msg.str());
-                    }
-                    else if (!WIFEXITED(result) || (WEXITSTATUS(result) != EXIT_SUCCESS))
-                    {
-                        // Rely on ifgen's error message to help the user.  Don't confuse them
-                        // with whatever exception message we got from trying to add some
-                        // garbage dependency string onto the API's dependency list.
-                        throw Exception("ifgen failed.");
-                    }
-                    else
-                    {
-                        throw e;
-                    }
-                }
-            }
-        }
-        else
-        {
-            // Store the hash in the new API object.
-            apiPtr->Hash(buffer);
-
-            if (buildParams.IsVerbose())
-            {
-                std::cout << "    API '" << filePath << "' has hash '"
-                          << buffer << "'" << std::endl;
-            }
+        apiPtr->AddDependency(GetApiObject(otherApiFilePath, buildParams));
+    }
 
-            // Close the connection and collect the exit code from ifgen.
-            int result = pclose(output);
-            if (result == -1)
-            {
-                std::stringstream msg;
-                msg << "ifgen failed. errno = ";
-                msg << strerror(errno);
-                throw Exception(msg.str());
-            }
+    // Store the hash in the new API object.
+    apiPtr->Hash(std::string(definition.hash));
 
-            // DONE.
-            return apiPtr;
-        }
+    if (buildParams.IsVerbose())
+    {
+        std::cout << "    API '" << filePath << "' has hash '"
+                  << definition.hash << "'" << std::endl;
     }
+
+    return apiPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the paths of all the definition (.sdef, .adef, .cdef) and .api files that have been parsed
+ * so far.
+ *
+ * @return The set of file paths.
+ **/
+//--------------------------------------------------------------------------------------------------
+const std::set<std::string>& legato::parser::GetParsedFiles
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    return ParsedFiles;
 }
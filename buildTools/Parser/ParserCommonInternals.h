@@ -52,6 +52,20 @@ std::string yy_StripQuotes
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets an optional argument of a statement recorded by a parser.  Omitted arguments are recorded
+ * as empty strings.
+ *
+ * @return  The argument, or NULL if it was omitted.
+ */
+//--------------------------------------------------------------------------------------------------
+const char* yy_OptionalArg
+(
+    const std::string& arg
+);
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Creates a FileMapping object for a given "required" file.  This is a file that is to be
@@ -169,4 +183,39 @@ void yy_WarnAboutRealTimeAndCpuShare
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Records the path of a definition (.sdef, .adef, .cdef) or .api file that has been parsed.
+ **/
+//--------------------------------------------------------------------------------------------------
+void yy_AddParsedFile
+(
+    const std::string& path
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Starts scanning and parsing a component's Component.cdef file on a worker thread, if the
+ * component can be found.  Nothing is reported if it can't; that's done when it is parsed.
+ **/
+//--------------------------------------------------------------------------------------------------
+void yy_PrefetchComponent
+(
+    const std::string& path,                    ///< Path of the component, as found in a file.
+    const std::list<std::string>& searchDirs    ///< Where to look for the component.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Starts scanning and parsing an application's .adef file on a worker thread.
+ **/
+//--------------------------------------------------------------------------------------------------
+void yy_PrefetchApp
+(
+    const std::string& adefPath     ///< Path of the .adef file.
+);
+
+
 #endif // PARSER_COMMON_H_INCLUDE_GUARD
@@ -11,6 +11,7 @@
 
 extern "C"
 {
+    #include "ParsedFile.h"
     #include "SystemParser.tab.h"
     #include "ParserCommonInternals.h"
     #include "SystemParserInternals.h"
@@ -19,6 +20,8 @@ extern "C"
     #include "lex.syy.h"
 }
 
+#include "DefinitionCache.h"
+
 
 //--------------------------------------------------------------------------------------------------
 /**
@@ -153,6 +156,240 @@ static void FinalizeSystem
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the name of an app's .adef file from the app path given in an "apps:" section.
+ *
+ * @return The file name (or path).
+ */
+//--------------------------------------------------------------------------------------------------
+static std::string AppDefFileName
+(
+    const std::string& appPath
+)
+//--------------------------------------------------------------------------------------------------
+{
+    // If the app path doesn't end in a ".adef", add it.
+    if ((appPath.length() < 5) || (appPath.compare(appPath.length() - 5, 5, ".adef") != 0))
+    {
+        return appPath + ".adef";
+    }
+
+    return appPath;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Find an app's .adef file, given the app path from an "apps:" section.
+ *
+ * @return The path of the .adef file, or "" if it couldn't be found.
+ */
+//--------------------------------------------------------------------------------------------------
+static std::string FindAppDef
+(
+    const std::string& appPath
+)
+//--------------------------------------------------------------------------------------------------
+{
+    return legato::FindFile(AppDefFileName(appPath), BuildParamsPtr->SourceDirs());
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Name of the file that is currently being parsed.
+ */
+//--------------------------------------------------------------------------------------------------
+const char* syy_FileName = "";
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of the line that the statement currently being applied was found on.
+ */
+//--------------------------------------------------------------------------------------------------
+int syy_LineNum = 0;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Count of the number of errors that have been reported for the file being parsed.
+ */
+//--------------------------------------------------------------------------------------------------
+size_t syy_ErrorCount = 0;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Scans and parses the contents of an .sdef file, recording the statements found in it.
+ * Runs on the definition cache's worker threads too, so must not touch any global state.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ScanFile
+(
+    yy_ParsedFile_t* filePtr,       ///< [IN/OUT] Object to record the statements in.
+    const std::string& contents     ///< [IN] Contents of the file.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    yyscan_t scanner;
+
+    syy_lex_init_extra(filePtr, &scanner);
+    YY_BUFFER_STATE buffer = syy__scan_bytes(contents.data(), contents.size(), scanner);
+    syy_set_lineno(1, scanner);
+
+    // Until the parsing is done,
+    int parsingResult;
+    do
+    {
+        // Start parsing.
+        parsingResult = syy_parse(scanner);
+    }
+    while (   (parsingResult != 0)
+           && (!filePtr->isEndOfFile)
+           && (filePtr->errorCount <= SYY_MAX_ERROR_COUNT) );
+
+    syy__delete_buffer(buffer, scanner);
+    syy_lex_destroy(scanner);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Applies a statement recorded by the parser to the System currently being parsed.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ApplyStatement
+(
+    const legato::parser::Statement_t& statement
+)
+//--------------------------------------------------------------------------------------------------
+{
+    const std::vector<std::string>& args = statement.args;
+
+    syy_LineNum = statement.lineNum;
+
+    switch (statement.type)
+    {
+        case YY_ERROR_STATEMENT:
+            syy_error(args[0].c_str());
+            break;
+
+        case SYY_FINALIZE_APP:
+            syy_FinalizeApp();
+            break;
+
+        case SYY_ADD_APP:
+            syy_AddApp(args[0].c_str());
+            break;
+
+        case SYY_SET_SANDBOXED:
+            syy_SetSandboxed(args[0].c_str());
+            break;
+
+        case SYY_SET_START_MODE:
+            syy_SetStartMode(args[0].c_str());
+            break;
+
+        case SYY_SET_MAX_THREADS:
+            syy_SetMaxThreads(yy_GetNumber(args[0].c_str()));
+            break;
+
+        case SYY_SET_MAX_MQUEUE_BYTES:
+            syy_SetMaxMQueueBytes(yy_GetNumber(args[0].c_str()));
+            break;
+
+        case SYY_SET_MAX_QUEUED_SIGNALS:
+            syy_SetMaxQueuedSignals(yy_GetNumber(args[0].c_str()));
+            break;
+
+        case SYY_SET_MAX_MEMORY_BYTES:
+            syy_SetMaxMemoryBytes(yy_GetNumber(args[0].c_str()));
+            break;
+
+        case SYY_SET_CPU_SHARE:
+            syy_SetCpuShare(yy_GetNumber(args[0].c_str()));
+            break;
+
+        case SYY_SET_MAX_FILE_SYSTEM_BYTES:
+            syy_SetMaxFileSystemBytes(yy_GetNumber(args[0].c_str()));
+            break;
+
+        case SYY_SET_MAX_PRIORITY:
+            syy_SetMaxPriority(args[0].c_str());
+            break;
+
+        case SYY_SET_MAX_CORE_DUMP_FILE_BYTES:
+            syy_SetMaxCoreDumpFileBytes(yy_GetNumber(args[0].c_str()));
+            break;
+
+        case SYY_SET_MAX_FILE_BYTES:
+            syy_SetMaxFileBytes(yy_GetNumber(args[0].c_str()));
+            break;
+
+        case SYY_SET_MAX_LOCKED_MEMORY_BYTES:
+            syy_SetMaxLockedMemoryBytes(yy_GetNumber(args[0].c_str()));
+            break;
+
+        case SYY_SET_MAX_FILE_DESCRIPTORS:
+            syy_SetMaxFileDescriptors(yy_GetNumber(args[0].c_str()));
+            break;
+
+        case SYY_SET_FAULT_ACTION:
+            syy_SetFaultAction(args[0].c_str());
+            break;
+
+        case SYY_CLEAR_GROUPS:
+            syy_ClearGroups();
+            break;
+
+        case SYY_ADD_GROUP:
+            syy_AddGroup(args[0].c_str());
+            break;
+
+        case SYY_SET_VERSION:
+            syy_SetVersion(args[0].c_str());
+            break;
+
+        case SYY_SET_WATCHDOG_ACTION:
+            syy_SetWatchdogAction(args[0].c_str());
+            break;
+
+        case SYY_SET_WATCHDOG_TIMEOUT:
+            syy_SetWatchdogTimeout(yy_GetNumber(args[0].c_str()));
+            break;
+
+        case SYY_SET_WATCHDOG_DISABLED:
+            syy_SetWatchdogDisabled(args[0].c_str());
+            break;
+
+        case SYY_ADD_APP_TO_APP_BIND:
+            syy_AddAppToAppBind(args[0].c_str(), args[1].c_str());
+            break;
+
+        case SYY_ADD_APP_TO_USER_BIND:
+            syy_AddAppToUserBind(args[0].c_str(), args[1].c_str(), args[2].c_str());
+            break;
+
+        case SYY_ADD_USER_TO_APP_BIND:
+            syy_AddUserToAppBind(args[0].c_str(), args[1].c_str(), args[2].c_str());
+            break;
+
+        case SYY_ADD_USER_TO_USER_BIND:
+            syy_AddUserToUserBind(args[0].c_str(),
+                                  args[1].c_str(),
+                                  args[2].c_str(),
+                                  args[3].c_str());
+            break;
+
+        default:
+            throw legato::Exception("Unknown statement type " + std::to_string(statement.type)
+                                    + " found while parsing '" + syy_FileName + "'.");
+    }
+}
+
+
 namespace legato
 {
 
@@ -180,42 +417,40 @@ void ParseSystem
 
     const std::string& path = SystemPtr->DefFilePath();
 
-    // Open the .sdef file for reading.
-    FILE* file = fopen(path.c_str(), "r");
-    if (file == NULL)
+    // Get the file scanned and parsed (unless that's already been done), then start on the files
+    // of the apps in the system, so they're ready by the time they're needed.
+    const yy_ParsedFile_t& parsedFile = yy_GetParsedFile(path, ScanFile);
+
+    for (const auto& statement : parsedFile.statements)
     {
-        int error = errno;
-        std::stringstream errorMessage;
-        errorMessage << "Failed to open file '" << path << "'." <<
-                        " Errno = " << error << "(" << strerror(error) << ").";
-        throw Exception(errorMessage.str());
+        if (statement.type == SYY_ADD_APP)
+        {
+            std::string adefPath = FindAppDef(statement.args[0]);
+
+            if (!adefPath.empty())
+            {
+                yy_PrefetchApp(adefPath);
+            }
+        }
     }
 
+    yy_AddParsedFile(path);
+
     if (buildParams.IsVerbose())
     {
         std::cout << "Parsing '" << path << "'\n";
     }
 
-    // Tell the parser to reset itself and connect to the new file stream for future parsing.
+    // Apply what was found in the file to the system.
     syy_FileName = path.c_str();
 
     syy_IsVerbose = (BuildParamsPtr->IsVerbose() ? 1 : 0);
-    syy_EndOfFile = 0;
     syy_ErrorCount = 0;
-    syy_set_lineno(1);
-    syy_restart(file);
 
-    // Until the parsing is done,
-    int parsingResult;
-    do
+    for (const auto& statement : parsedFile.statements)
     {
-        // Start parsing.
-        parsingResult = syy_parse();
+        ApplyStatement(statement);
     }
-    while ((parsingResult != 0) && (!syy_EndOfFile));
-
-    // Close the file
-    fclose(file);
 
     // Do final processing.
     FinalizeSystem();
@@ -241,10 +476,41 @@ void ParseSystem
 }
 
 //--------------------------------------------------------------------------------------------------
-// NOTE: The following functions are called from C code inside the bison-generated parser code.
+// NOTE: The following functions are called by ApplyStatement(), for the statements recorded by the
+//       bison-generated parser code.
 //--------------------------------------------------------------------------------------------------
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Error handling function.  Prints an error message to the standard error stream and counts
+ * errors.  If the number of errors gets too high, terminates the program.
+ **/
+//--------------------------------------------------------------------------------------------------
+void syy_error
+(
+    const char* errorString
+)
+//--------------------------------------------------------------------------------------------------
+{
+    // Make error messages stand out from the clutter when running in verbose mode.
+    if (syy_IsVerbose)
+    {
+        fprintf(stderr, " [-- ERROR --]\n");
+    }
+
+    fprintf(stderr, "%s:%d: ERROR: %s\n", syy_FileName, syy_LineNum, errorString);
+
+    syy_ErrorCount++;
+
+    if (syy_ErrorCount > SYY_MAX_ERROR_COUNT)
+    {
+        fprintf(stderr, "Error limit reached.  Stopping at line %d.\n", syy_LineNum);
+        exit(syy_ErrorCount);
+    }
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Set the system version.
@@ -273,19 +539,12 @@ void syy_AddApp
 {
     try
     {
-        std::string path(adefPath);
-
-        // If the app path doesn't end in a ".adef", add it.
-        if ((path.length() < 5) || (path.compare(path.length() - 5, 5, ".adef") != 0))
-        {
-            path += ".adef";
-        }
-
-        std::string resolvedPath = legato::FindFile(path, BuildParamsPtr->SourceDirs());
+        std::string resolvedPath = FindAppDef(adefPath);
 
         if (resolvedPath.empty())
         {
-            throw legato::Exception("Application definition file '" + path + "' not found.");
+            throw legato::Exception("Application definition file '" + AppDefFileName(adefPath)
+                                    + "' not found.");
         }
 
         // Create a new App object in the System.
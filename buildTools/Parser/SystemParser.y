@@ -3,12 +3,25 @@
 %{
 
 #include <stdio.h>
+#include "ParsedFile.h"
 #include "SystemParser.tab.h"
-#include "lex.ayy.h"
+#include "lex.syy.h"
 #include "SystemParserInternals.h"
 
+// The rules don't act on what they parse; they record it in the parsed file object that was
+// handed to the scanner (see ParsedFile.h).  Syntax errors are recorded the same way.
+#define syy_error(scanner, errorString) \
+    yy_AddError(syy_get_extra(scanner), syy_get_lineno(scanner), errorString)
+
+#define STATEMENT(...) \
+    yy_AddStatement(syy_get_extra(scanner), syy_get_lineno(scanner), __VA_ARGS__, NULL)
+
 %}
 
+%define api.pure
+%lex-param {void* scanner}
+%parse-param {void* scanner}
+
 %error-verbose
 
 %union
@@ -76,13 +89,13 @@ apps_list
     ;
 
 app
-    : adef_path                               { syy_FinalizeApp(); }
-    | adef_path '{' '}'                       { syy_FinalizeApp(); }
-    | adef_path '{' app_subsection_list '}'   { syy_FinalizeApp(); }
+    : adef_path                               { STATEMENT(SYY_FINALIZE_APP); }
+    | adef_path '{' '}'                       { STATEMENT(SYY_FINALIZE_APP); }
+    | adef_path '{' app_subsection_list '}'   { STATEMENT(SYY_FINALIZE_APP); }
     ;
 
 adef_path
-    : file_path     { syy_AddApp($1); }
+    : file_path     { STATEMENT(SYY_ADD_APP, $1); }
 
 app_subsection_list
     : app_subsection
@@ -110,61 +123,61 @@ app_subsection
     ;
 
 sandboxed_subsection
-    : SANDBOXED_SECTION_LABEL NAME    { syy_SetSandboxed($2); }
+    : SANDBOXED_SECTION_LABEL NAME    { STATEMENT(SYY_SET_SANDBOXED, $2); }
     ;
 
 start_subsection
-    : START_SECTION_LABEL NAME    { syy_SetStartMode($2); }
+    : START_SECTION_LABEL NAME    { STATEMENT(SYY_SET_START_MODE, $2); }
     ;
 
 max_threads_subsection
-    : MAX_THREADS_SECTION_LABEL NUMBER    { syy_SetMaxThreads(yy_GetNumber($2)); }
+    : MAX_THREADS_SECTION_LABEL NUMBER    { STATEMENT(SYY_SET_MAX_THREADS, $2); }
     ;
 
 max_mqueue_bytes_subsection
-    : MAX_MQUEUE_BYTES_SECTION_LABEL NUMBER    { syy_SetMaxMQueueBytes(yy_GetNumber($2)); }
+    : MAX_MQUEUE_BYTES_SECTION_LABEL NUMBER    { STATEMENT(SYY_SET_MAX_MQUEUE_BYTES, $2); }
     ;
 
 max_queued_signals_subsection
-    : MAX_QUEUED_SIGNALS_SECTION_LABEL NUMBER { syy_SetMaxQueuedSignals(yy_GetNumber($2)); }
+    : MAX_QUEUED_SIGNALS_SECTION_LABEL NUMBER { STATEMENT(SYY_SET_MAX_QUEUED_SIGNALS, $2); }
     ;
 
 max_memory_bytes_subsection
-    : MAX_MEMORY_BYTES_SECTION_LABEL NUMBER   { syy_SetMaxMemoryBytes(yy_GetNumber($2)); }
+    : MAX_MEMORY_BYTES_SECTION_LABEL NUMBER   { STATEMENT(SYY_SET_MAX_MEMORY_BYTES, $2); }
     ;
 
 cpu_share_subsection
-    : CPU_SHARE_SECTION_LABEL NUMBER   { syy_SetCpuShare(yy_GetNumber($2)); }
+    : CPU_SHARE_SECTION_LABEL NUMBER   { STATEMENT(SYY_SET_CPU_SHARE, $2); }
     ;
 
 max_file_system_bytes_subsection
-    : MAX_FILE_SYSTEM_BYTES_SECTION_LABEL NUMBER  { syy_SetMaxFileSystemBytes(yy_GetNumber($2)); }
+    : MAX_FILE_SYSTEM_BYTES_SECTION_LABEL NUMBER  { STATEMENT(SYY_SET_MAX_FILE_SYSTEM_BYTES, $2); }
     ;
 
 max_priority_subsection
-    : MAX_PRIORITY_SECTION_LABEL NAME     { syy_SetMaxPriority($2); }
+    : MAX_PRIORITY_SECTION_LABEL NAME     { STATEMENT(SYY_SET_MAX_PRIORITY, $2); }
     ;
 
 max_core_dump_file_bytes_subsection
     : MAX_CORE_DUMP_FILE_BYTES_SECTION_LABEL NUMBER
-                                                { syy_SetMaxCoreDumpFileBytes(yy_GetNumber($2)); }
+                                                { STATEMENT(SYY_SET_MAX_CORE_DUMP_FILE_BYTES, $2); }
     ;
 
 max_file_bytes_subsection
-    : MAX_FILE_BYTES_SECTION_LABEL NUMBER     { syy_SetMaxFileBytes(yy_GetNumber($2)); }
+    : MAX_FILE_BYTES_SECTION_LABEL NUMBER     { STATEMENT(SYY_SET_MAX_FILE_BYTES, $2); }
     ;
 
 max_locked_memory_bytes_subsection
     : MAX_LOCKED_MEMORY_BYTES_SECTION_LABEL NUMBER
-                                                { syy_SetMaxLockedMemoryBytes(yy_GetNumber($2)); }
+                                                { STATEMENT(SYY_SET_MAX_LOCKED_MEMORY_BYTES, $2); }
     ;
 
 max_file_descriptors_subsection
-    : MAX_FILE_DESCRIPTORS_SECTION_LABEL NUMBER { syy_SetMaxFileDescriptors(yy_GetNumber($2)); }
+    : MAX_FILE_DESCRIPTORS_SECTION_LABEL NUMBER { STATEMENT(SYY_SET_MAX_FILE_DESCRIPTORS, $2); }
     ;
 
 fault_action_subsection
-    : FAULT_ACTION_SECTION_LABEL NAME     { syy_SetFaultAction($2); }
+    : FAULT_ACTION_SECTION_LABEL NAME     { STATEMENT(SYY_SET_FAULT_ACTION, $2); }
     ;
 
 groups_section
@@ -173,7 +186,7 @@ groups_section
     ;
 
 group_section_open_curly
-    : '{'                   { syy_ClearGroups(); }
+    : '{'                   { STATEMENT(SYY_CLEAR_GROUPS); }
     ;
 
 group_list
@@ -182,21 +195,21 @@ group_list
     ;
 
 group
-    : FILE_PATH { syy_AddGroup($1); }
-    | NAME      { syy_AddGroup($1); }
+    : FILE_PATH { STATEMENT(SYY_ADD_GROUP, $1); }
+    | NAME      { STATEMENT(SYY_ADD_GROUP, $1); }
     ;
 
 version_section
-    : VERSION_SECTION_LABEL file_path     { syy_SetVersion($2); }
+    : VERSION_SECTION_LABEL file_path     { STATEMENT(SYY_SET_VERSION, $2); }
     ;
 
 watchdog_action_subsection
-    : WATCHDOG_ACTION_SECTION_LABEL NAME  { syy_SetWatchdogAction($2); }
+    : WATCHDOG_ACTION_SECTION_LABEL NAME  { STATEMENT(SYY_SET_WATCHDOG_ACTION, $2); }
     ;
 
 watchdog_timeout_subsection
-    : WATCHDOG_TIMEOUT_SECTION_LABEL NUMBER  { syy_SetWatchdogTimeout(yy_GetNumber($2)); }
-    | WATCHDOG_TIMEOUT_SECTION_LABEL NAME    { syy_SetWatchdogDisabled($2); }
+    : WATCHDOG_TIMEOUT_SECTION_LABEL NUMBER  { STATEMENT(SYY_SET_WATCHDOG_TIMEOUT, $2); }
+    | WATCHDOG_TIMEOUT_SECTION_LABEL NAME    { STATEMENT(SYY_SET_WATCHDOG_DISABLED, $2); }
     ;
 
 bindings_section
@@ -210,11 +223,13 @@ bind_list
     ;
 
 bind_spec
-    : file_path ARROW file_path                     { syy_AddAppToAppBind($1, $3); }
-    | file_path ARROW '<' file_path '>' file_path   { syy_AddAppToUserBind($1, $4, $6); }
-    | '<' file_path '>' file_path ARROW file_path   { syy_AddUserToAppBind($2, $4, $6); }
+    : file_path ARROW file_path                     { STATEMENT(SYY_ADD_APP_TO_APP_BIND, $1, $3); }
+    | file_path ARROW '<' file_path '>' file_path
+                                                { STATEMENT(SYY_ADD_APP_TO_USER_BIND, $1, $4, $6); }
+    | '<' file_path '>' file_path ARROW file_path
+                                                { STATEMENT(SYY_ADD_USER_TO_APP_BIND, $2, $4, $6); }
     | '<' file_path '>' file_path ARROW '<' file_path '>' file_path
-                                                    { syy_AddUserToUserBind($2, $4, $7, $9); }
+                                           { STATEMENT(SYY_ADD_USER_TO_USER_BIND, $2, $4, $7, $9); }
     ;
 
 file_path
@@ -19,30 +19,69 @@
 
 //--------------------------------------------------------------------------------------------------
 /**
- * System parsing function, implemented by the Bison-generated parser.
+ * Types of statements recorded by the parser (see ParsedFile.h).  Each is applied by calling the
+ * function of the same name, below, with the statement's arguments.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef enum
+{
+    SYY_FINALIZE_APP = 1,                       ///< syy_FinalizeApp()
+    SYY_ADD_APP,                                ///< syy_AddApp()
+    SYY_SET_SANDBOXED,                          ///< syy_SetSandboxed()
+    SYY_SET_START_MODE,                         ///< syy_SetStartMode()
+    SYY_SET_MAX_THREADS,                        ///< syy_SetMaxThreads()
+    SYY_SET_MAX_MQUEUE_BYTES,                   ///< syy_SetMaxMQueueBytes()
+    SYY_SET_MAX_QUEUED_SIGNALS,                 ///< syy_SetMaxQueuedSignals()
+    SYY_SET_MAX_MEMORY_BYTES,                   ///< syy_SetMaxMemoryBytes()
+    SYY_SET_CPU_SHARE,                          ///< syy_SetCpuShare()
+    SYY_SET_MAX_FILE_SYSTEM_BYTES,              ///< syy_SetMaxFileSystemBytes()
+    SYY_SET_MAX_PRIORITY,                       ///< syy_SetMaxPriority()
+    SYY_SET_MAX_CORE_DUMP_FILE_BYTES,           ///< syy_SetMaxCoreDumpFileBytes()
+    SYY_SET_MAX_FILE_BYTES,                     ///< syy_SetMaxFileBytes()
+    SYY_SET_MAX_LOCKED_MEMORY_BYTES,            ///< syy_SetMaxLockedMemoryBytes()
+    SYY_SET_MAX_FILE_DESCRIPTORS,               ///< syy_SetMaxFileDescriptors()
+    SYY_SET_FAULT_ACTION,                       ///< syy_SetFaultAction()
+    SYY_CLEAR_GROUPS,                           ///< syy_ClearGroups()
+    SYY_ADD_GROUP,                              ///< syy_AddGroup()
+    SYY_SET_VERSION,                            ///< syy_SetVersion()
+    SYY_SET_WATCHDOG_ACTION,                    ///< syy_SetWatchdogAction()
+    SYY_SET_WATCHDOG_TIMEOUT,                   ///< syy_SetWatchdogTimeout()
+    SYY_SET_WATCHDOG_DISABLED,                  ///< syy_SetWatchdogDisabled()
+    SYY_ADD_APP_TO_APP_BIND,                    ///< syy_AddAppToAppBind()
+    SYY_ADD_APP_TO_USER_BIND,                   ///< syy_AddAppToUserBind()
+    SYY_ADD_USER_TO_APP_BIND,                   ///< syy_AddUserToAppBind()
+    SYY_ADD_USER_TO_USER_BIND                   ///< syy_AddUserToUserBind()
+}
+syy_StatementType_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * System parsing function, implemented by the Bison-generated parser.  Records the statements
+ * found by a reentrant scanner in the scanner's parsed file object (its "extra" data).
  *
  * @note    syy_parse() may return a non-zero value before parsing has finished, because an error
  *          was encountered.  To aide in troubleshooting, syy_parse() can be called again to look
  *          for further errors.  However, there's no point in doing this if the end-of-file has
- *          been reached.  syy_EndOfFile can be used to check for end of file.
+ *          been reached.
  *
  * @return 0 when parsing successfully completes.  Non-zero when an error is encountered.
  */
 //--------------------------------------------------------------------------------------------------
-int syy_parse(void);
+int syy_parse(void* scanner);
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * End of file flag.  This is set when syy_parse() returns due to an end of file condition.
+ * Number of the line that the statement currently being applied was found on.
  */
 //--------------------------------------------------------------------------------------------------
-extern int syy_EndOfFile;
+extern int syy_LineNum;
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Count of the number of errors that have been reported during scanning.
+ * Count of the number of errors that have been reported for the file being parsed.
  */
 //--------------------------------------------------------------------------------------------------
 extern size_t syy_ErrorCount;
@@ -66,8 +105,8 @@ extern int syy_IsVerbose;
 
 //--------------------------------------------------------------------------------------------------
 /**
- * The standard error reporting function that will be called by both the
- * lexer and the parser when they detect errors or when the YYERROR macro is invoked.
+ * The standard error reporting function.  Called for each error recorded by the scanner and the
+ * parser, and by the functions below when they detect errors.
  */
 //--------------------------------------------------------------------------------------------------
 void syy_error(const char* errorString);
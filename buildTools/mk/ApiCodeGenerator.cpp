@@ -0,0 +1,2579 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * Implementation of the IPC code generator used by mkif.
+ *
+ * The code templates below are ifgen's, with the effects of ifgen's template engine on white
+ * space already applied, so that exactly the same code comes out.  In a template, "{{x}}" is
+ * replaced by the value of "x", and the text between "{{#x}}" and "{{/x}}" is only kept if "x"
+ * has a non-empty value (or, between "{{^x}}" and "{{/x}}", an empty value).  Values are not
+ * themselves expanded.
+ *
+ * Copyright (C) Sierra Wireless, Inc. 2014.  Use of this work is subject to license.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "LegatoObjectModel.h"
+#include "ApiCodeGenerator.h"
+#include <fstream>
+#include <sstream>
+
+
+namespace mk
+{
+
+using legato::api::Definition_t;
+using legato::api::Function_t;
+using legato::api::Type_t;
+using legato::api::EnumMember_t;
+using legato::api::ParameterList_t;
+using legato::api::AddNamePrefix;
+
+
+/// Line of dashes that goes above and below comment headers in the generated code.
+#define SEPARATOR_LINE \
+    "//-------------------------------------------------" \
+    "-------------------------------------------------\n"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Canned code and code templates.
+ */
+//--------------------------------------------------------------------------------------------------
+static const char* const WarningNotice =
+    "/*\n"
+    " * ====================== WARNING ======================\n"
+    " *\n"
+    " * THE CONTENTS OF THIS FILE HAVE BEEN AUTO-GENERATED.\n"
+    " * DO NOT MODIFY IN ANY WAY.\n"
+    " *\n"
+    " * ====================== WARNING ======================\n"
+    " */\n"
+;
+
+static const char* const HeaderCommentTemplate =
+    "\n"
+    "/**\n"
+    " * {{comment}}\n"
+    " */\n"
+;
+
+static const char* const IncludeGuardBeginTemplate =
+    "\n"
+    "#ifndef {{fileName}}_H_INCLUDE_GUARD\n"
+    "#define {{fileName}}_H_INCLUDE_GUARD\n"
+;
+
+static const char* const IncludeGuardEndTemplate =
+    "\n"
+    "#endif // {{fileName}}_H_INCLUDE_GUARD\n"
+;
+
+static const char* const FuncPrototypeTemplate =
+    "\n"
+    SEPARATOR_LINE
+    "{{comment}}\n"
+    SEPARATOR_LINE
+    "{{type}} {{name}}\n"
+    "(\n"
+    "    {{parms}}\n"
+    ")\n"
+;
+
+static const char* const RespondFuncPrototypeTemplate =
+    "\n"
+    SEPARATOR_LINE
+    "/**\n"
+    " * Server-side respond function for {{name}}\n"
+    " */\n"
+    SEPARATOR_LINE
+    "void {{name}}Respond\n"
+    "(\n"
+    "    {{parms}}\n"
+    ")\n"
+;
+
+static const char* const ServerAsyncFuncPrototypeTemplate =
+    "\n"
+    SEPARATOR_LINE
+    "/**\n"
+    " * Prototype for server-side async interface function\n"
+    " */\n"
+    SEPARATOR_LINE
+    "void {{name}}\n"
+    "(\n"
+    "    {{serverCmdRef}} _cmdRef{{parms}}\n"
+    ")\n"
+;
+
+static const char* const PipelinedStartPrototypeTemplate =
+    "\n"
+    SEPARATOR_LINE
+    "/**\n"
+    " * Pipelined client function: sends the request for {{name}}() without waiting for the\n"
+    " * response, which must be collected with {{name}}Finish()\n"
+    " */\n"
+    SEPARATOR_LINE
+    "{{pendingRef}} {{name}}Start\n"
+    "(\n"
+    "    {{parms}}\n"
+    ")\n"
+;
+
+static const char* const PipelinedFinishPrototypeTemplate =
+    "\n"
+    SEPARATOR_LINE
+    "/**\n"
+    " * Pipelined client function: waits for the response to {{name}}Start(), unless it has\n"
+    " * already arrived, and returns the result and OUT parameters of {{name}}()\n"
+    " */\n"
+    SEPARATOR_LINE
+    "{{type}} {{name}}Finish\n"
+    "(\n"
+    "    {{parms}}\n"
+    ")\n"
+;
+
+static const char* const HandlerTypeTemplate =
+    "\n"
+    SEPARATOR_LINE
+    "{{headerComment}}\n"
+    SEPARATOR_LINE
+    "typedef void (*{{name}})\n"
+    "(\n"
+    "    {{parms}}\n"
+    ");\n"
+;
+
+static const char* const TypeDefinitionTemplate =
+    "\n"
+    SEPARATOR_LINE
+    "{{comment}}\n"
+    SEPARATOR_LINE
+    "{{definition}}\n"
+;
+
+static const char* const EnumDefinitionTemplate =
+    "\n"
+    SEPARATOR_LINE
+    "{{comment}}\n"
+    SEPARATOR_LINE
+    "typedef enum\n"
+    "{\n"
+    "    {{members}}\n"
+    "}\n"
+    "{{typeName}};\n"
+;
+
+static const char* const InterfaceHeaderStartTemplate =
+    "\n"
+    "#include \"legato.h\"\n"
+;
+
+static const char* const PipelinedInterfaceHeaderStartTemplate =
+    "\n"
+    "#include \"legato.h\"\n"
+    "\n"
+    SEPARATOR_LINE
+    "/**\n"
+    " * Reference to a request sent by a pipelined client function (see the Start functions).  "
+    "The\n"
+    " * corresponding Finish function must be called exactly once with it, to collect the "
+    "response.\n"
+    " */\n"
+    SEPARATOR_LINE
+    "typedef struct {{pending}} {{pendingRef}};\n"
+;
+
+static const char* const ServerHeaderStartTemplate =
+    "\n"
+    "#include \"legato.h\"\n"
+;
+
+static const char* const AsyncServerHeaderStartTemplate =
+    "\n"
+    "#include \"legato.h\"\n"
+    "\n"
+    SEPARATOR_LINE
+    "/**\n"
+    " * Command reference for async server-side function support.  The interface function "
+    "receives the\n"
+    " * reference, and must pass it to the corresponding respond function.\n"
+    " */\n"
+    SEPARATOR_LINE
+    "typedef struct {{serverCmd}} {{serverCmdRef}};\n"
+;
+
+static const char* const LocalHeaderStartTemplate =
+    "\n"
+    "#include \"legato.h\"\n"
+    "\n"
+    "#define PROTOCOL_ID_STR \"{{idString}}\"\n"
+    "\n"
+    "#define SERVICE_INSTANCE_NAME \"{{serviceName}}\"\n"
+    "\n"
+    "\n"
+    "// Upper bound on the size of any of the messages, worked out from the sizes given in the\n"
+    "// interface.  The generated code checks that each message's fields fit.\n"
+    "#define _MAX_MSG_SIZE {{maxMsgSize}}\n"
+    "\n"
+    "// Define the message type for communicating between client and server\n"
+    "typedef struct\n"
+    "{\n"
+    "    uint32_t id;\n"
+    "    uint8_t buffer[_MAX_MSG_SIZE] __attribute__((aligned(8)));\n"
+    "}\n"
+    "_Message_t;\n"
+;
+
+static const char* const MessageLayoutsHeader =
+    "\n"
+    SEPARATOR_LINE
+    "// Message Layouts\n"
+    SEPARATOR_LINE
+;
+
+static const char* const MessageLayoutTemplate =
+    "\n"
+    "typedef struct\n"
+    "{\n"
+    "    {{fields}}\n"
+    "}\n"
+    "{{typeName}};\n"
+    "_Static_assert( LE_IPC_ALIGN_SIZE(sizeof({{typeName}})) + {{dataSize}} <= _MAX_MSG_SIZE,\n"
+    "                \"{{typeName}} does not fit in a message\" );\n"
+;
+
+static const char* const ClientGenericCode =
+    "\n"
+    SEPARATOR_LINE
+    "// Generic Client Types, Variables and Functions\n"
+    SEPARATOR_LINE
+    "\n"
+    SEPARATOR_LINE
+    "/**\n"
+    " * The client side of the interface.  The IPC runtime (see le_ipc.h) keeps each thread's "
+    "session\n"
+    " * with the server, and the handlers that have been registered with the server.\n"
+    " */\n"
+    SEPARATOR_LINE
+    "static le_ipc_Client_t _Client =\n"
+    "    LE_IPC_CLIENT_INIT(PROTOCOL_ID_STR, SERVICE_INSTANCE_NAME, sizeof(_Message_t));\n"
+;
+
+static const char* const ClientStartFuncTemplate =
+    "\n"
+    "{{startClientFunc}}\n"
+    "{\n"
+    "    le_ipc_ConnectService(&_Client);\n"
+    "}\n"
+    "\n"
+    "{{stopClientFunc}}\n"
+    "{\n"
+    "    le_ipc_DisconnectService(&_Client);\n"
+    "}\n"
+;
+
+static const char* const ClientStartClientCode =
+    "\n"
+    SEPARATOR_LINE
+    "// Client Specific Client Code\n"
+    SEPARATOR_LINE
+;
+
+/// Part of the client functions that builds the request (see ClientFuncTemplate).
+#define CLIENT_REQUEST_CODE \
+    "\n" \
+    "    // Range check values, if appropriate\n" \
+    "{{rangeChecks}}\n" \
+    "\n" \
+    "    // Create a new message object and get the message buffer\n" \
+    "    _msgRef = le_msg_CreateMsg(le_ipc_GetSessionRef(&_Client));\n" \
+    "    _msgPtr = le_msg_GetPayloadPtr(_msgRef);\n" \
+    "    _msgPtr->id = _MSGID_{{name}};\n" \
+    "    _msgBufPtr = _msgPtr->buffer;\n" \
+    "    _msgBufEndPtr = _msgPtr->buffer + _MAX_MSG_SIZE;\n" \
+    "{{#requestType}}" \
+    "\n" \
+    "    // The fixed-size fields are at the start of the message\n" \
+    "    {{requestType}}* _txFieldsPtr = ({{requestType}}*)_msgBufPtr;\n" \
+    "    _msgBufPtr += LE_IPC_ALIGN_SIZE(sizeof({{requestType}}));\n" \
+    "{{/requestType}}" \
+    "\n" \
+    "    // Pack the input parameters\n" \
+    "    {{pack}}\n"
+
+/// Part of the client functions that unpacks the response (see ClientFuncTemplate).
+#define CLIENT_RESPONSE_CODE \
+    "\n" \
+    "    // Process the result and/or output parameters, if there are any.\n" \
+    "    _msgPtr = le_msg_GetPayloadPtr(_responseMsgRef);\n" \
+    "    _msgBufPtr = _msgPtr->buffer;\n" \
+    "    _msgBufEndPtr = _msgPtr->buffer + _MAX_MSG_SIZE;\n" \
+    "{{#responseType}}" \
+    "\n" \
+    "    // The fixed-size fields are at the start of the message\n" \
+    "    {{responseType}}* _rxFieldsPtr = ({{responseType}}*)_msgBufPtr;\n" \
+    "    _msgBufPtr += LE_IPC_ALIGN_SIZE(sizeof({{responseType}}));\n" \
+    "{{/responseType}}" \
+    "\n" \
+    "{{#hasResult}}" \
+    "    // Unpack the result first\n" \
+    "    _result = _rxFieldsPtr->_result;\n" \
+    "{{#isAddHandler}}" \
+    "    // Put the handler reference result into the client handler object, and\n" \
+    "    // then return a safe reference to the client handler object as the reference.\n" \
+    "    _result = le_ipc_AddClientHandler(_clientHandlerPtr, (le_event_HandlerRef_t)_result);\n" \
+    "{{/isAddHandler}}" \
+    "{{/hasResult}}" \
+    "\n" \
+    "    // Unpack any \"out\" parameters\n" \
+    "    {{unpack}}\n" \
+    "{{#responseHasData}}" \
+    "    LE_FATAL_IF(_msgBufPtr == NULL, \"Invalid response received from server\");\n" \
+    "{{/responseHasData}}" \
+    "\n" \
+    "    // Release the message object, now that all results/output has been copied.\n" \
+    "    le_msg_ReleaseMsg(_responseMsgRef);\n" \
+    "{{#hasResult}}" \
+    "\n" \
+    "    return _result;\n" \
+    "{{/hasResult}}" \
+    "}\n"
+
+static const char* const ClientFuncTemplate =
+    "\n"
+    "{{prototype}}\n"
+    "{\n"
+    "    le_msg_MessageRef_t _msgRef;\n"
+    "    le_msg_MessageRef_t _responseMsgRef;\n"
+    "    _Message_t* _msgPtr;\n"
+    "\n"
+    "    // Will not be used if no data is sent/received from server.\n"
+    "    __attribute__((unused)) uint8_t* _msgBufPtr;\n"
+    "    __attribute__((unused)) uint8_t* _msgBufEndPtr;\n"
+    "\n"
+    "    {{resultStorage}}\n"
+    CLIENT_REQUEST_CODE
+    "\n"
+    "    // Send a request to the server and get the response.\n"
+    "    LE_DEBUG(\"Sending message to server and waiting for response\");\n"
+    "    _responseMsgRef = {{requestFunc}}(_msgRef);\n"
+    "    // It is a serious error if we don't get a valid response from the server\n"
+    "    LE_FATAL_IF(_responseMsgRef == NULL, \"Valid response was not received from server\");\n"
+    CLIENT_RESPONSE_CODE
+;
+
+static const char* const ClientOneWayFuncTemplate =
+    "\n"
+    "{{prototype}}\n"
+    "{\n"
+    "    le_msg_MessageRef_t _msgRef;\n"
+    "    _Message_t* _msgPtr;\n"
+    "\n"
+    "    // Will not be used if no data is sent to the server.\n"
+    "    __attribute__((unused)) uint8_t* _msgBufPtr;\n"
+    "    __attribute__((unused)) uint8_t* _msgBufEndPtr;\n"
+    CLIENT_REQUEST_CODE
+    "\n"
+    "    // Send the request to the server.  The server doesn't respond to a one-way function.\n"
+    "    LE_DEBUG(\"Sending one-way message to server\");\n"
+    "    le_msg_Send(_msgRef);\n"
+    "}\n"
+;
+
+static const char* const ClientPipelinedStartTemplate =
+    "\n"
+    "{{prototype}}\n"
+    "{\n"
+    "    le_msg_MessageRef_t _msgRef;\n"
+    "    _Message_t* _msgPtr;\n"
+    "\n"
+    "    // Will not be used if no data is sent to the server.\n"
+    "    __attribute__((unused)) uint8_t* _msgBufPtr;\n"
+    "    __attribute__((unused)) uint8_t* _msgBufEndPtr;\n"
+    CLIENT_REQUEST_CODE
+    "\n"
+    "    // Send the request to the server, without waiting for the response.\n"
+    "    LE_DEBUG(\"Sending message to server\");\n"
+    "    return ({{pendingRef}})le_ipc_StartRequest(_msgRef);\n"
+    "}\n"
+;
+
+static const char* const ClientPipelinedFinishTemplate =
+    "\n"
+    "{{prototype}}\n"
+    "{\n"
+    "    le_msg_MessageRef_t _responseMsgRef;\n"
+    "    _Message_t* _msgPtr;\n"
+    "\n"
+    "    // Will not be used if no data is received from server.\n"
+    "    __attribute__((unused)) uint8_t* _msgBufPtr;\n"
+    "    __attribute__((unused)) uint8_t* _msgBufEndPtr;\n"
+    "\n"
+    "    {{resultStorage}}\n"
+    "\n"
+    "    // Get the response to the request, waiting for it if it hasn't arrived yet.\n"
+    "    LE_DEBUG(\"Waiting for response from server\");\n"
+    "    _responseMsgRef = le_ipc_FinishRequest((le_ipc_PendingRef_t)_pendingRef, "
+    "_MSGID_{{name}});\n"
+    "    // It is a serious error if we don't get a valid response from the server\n"
+    "    LE_FATAL_IF(_responseMsgRef == NULL, \"Valid response was not received from server\");\n"
+    CLIENT_RESPONSE_CODE
+;
+
+static const char* const ClientHandlerTemplate =
+    "\n"
+    "// This function parses the message buffer received from the server, and then calls the user\n"
+    "// registered handler, which is stored in a client handler object.\n"
+    "static void _Handle_{{name}}\n"
+    "(\n"
+    "    void* _reportPtr,\n"
+    "    void* _dataPtr\n"
+    ")\n"
+    "{\n"
+    "    le_msg_MessageRef_t _msgRef = _reportPtr;\n"
+    "    _Message_t* _msgPtr = le_msg_GetPayloadPtr(_msgRef);\n"
+    "    __attribute__((unused)) uint8_t* _msgBufPtr = _msgPtr->buffer;\n"
+    "    __attribute__((unused)) uint8_t* _msgBufEndPtr = _msgPtr->buffer + _MAX_MSG_SIZE;\n"
+    "\n"
+    "    // The fixed-size fields are at the start of the message\n"
+    "    __attribute__((unused)) {{indicationType}}* _rxFieldsPtr =\n"
+    "        ({{indicationType}}*)_msgBufPtr;\n"
+    "    _msgBufPtr += LE_IPC_ALIGN_SIZE(sizeof({{indicationType}}));\n"
+    "\n"
+    "    // The IPC runtime has already looked up the client handler object, which the server "
+    "sends\n"
+    "    // back as the first field of the message.\n"
+    "    le_ipc_ClientHandler_t* _clientHandlerPtr = _dataPtr;\n"
+    "    {{handlerName}} _handlerRef_{{name}} = ({{handlerName}})_clientHandlerPtr->handlerPtr;\n"
+    "    void* contextPtr = _clientHandlerPtr->contextPtr;\n"
+    "\n"
+    "    // Unpack the remaining parameters\n"
+    "    {{unpack}}\n"
+    "{{#indicationHasData}}"
+    "    LE_FATAL_IF(_msgBufPtr == NULL, \"Invalid message received from server\");\n"
+    "{{/indicationHasData}}"
+    "\n"
+    "    // Call the registered handler\n"
+    "    if ( _handlerRef_{{name}} != NULL )\n"
+    "    {\n"
+    "        _handlerRef_{{name}}( {{callArgs}} );\n"
+    "    }\n"
+    "    else\n"
+    "    {\n"
+    "        LE_ERROR(\"ERROR in client _Handle_{{name}}: no registered handler\");\n"
+    "    }\n"
+    "\n"
+    "    // Release the message, now that we are finished with it.\n"
+    "    le_msg_ReleaseMsg(_msgRef);\n"
+    "}\n"
+;
+
+static const char* const ServerFuncEntryTemplate =
+    "    [_MSGID_{{name}}] = { \"{{name}}\", Handle_{{name}} },\n"
+;
+
+static const char* const ServerGenericTemplate =
+    "\n"
+    SEPARATOR_LINE
+    "// Generic Server Types, Variables and Functions\n"
+    SEPARATOR_LINE
+    "\n"
+    SEPARATOR_LINE
+    "/**\n"
+    " * The server function for each message ID.  The IPC runtime (see le_ipc.h) dispatches the "
+    "requests\n"
+    " * from clients through this table.\n"
+    " */\n"
+    SEPARATOR_LINE
+    "static const le_ipc_ServerFunc_t _ServerFuncs[] =\n"
+    "{\n"
+    "{{entries}}};\n"
+    "\n"
+    "\n"
+    SEPARATOR_LINE
+    "/**\n"
+    " * Number of calls to each server function, and the time spent in them (see \"inspect "
+    "ipc\").\n"
+    " */\n"
+    SEPARATOR_LINE
+    "static le_ipc_ServerFuncStats_t _ServerFuncStats[NUM_ARRAY_MEMBERS(_ServerFuncs)];\n"
+    "\n"
+    "\n"
+    SEPARATOR_LINE
+    "/**\n"
+    " * The server side of the interface.  The IPC runtime keeps the handlers that clients have\n"
+    " * registered, and removes them when the clients' sessions close.\n"
+    " */\n"
+    SEPARATOR_LINE
+    "static le_ipc_Server_t _Server =\n"
+    "    LE_IPC_SERVER_INIT(PROTOCOL_ID_STR, SERVICE_INSTANCE_NAME, sizeof(_Message_t),\n"
+    "                       _ServerFuncs, _ServerFuncStats);\n"
+;
+
+static const char* const ServerStartFuncTemplate =
+    "\n"
+    "{{getServiceRef}}\n"
+    "{\n"
+    "    return _Server.serviceRef;\n"
+    "}\n"
+    "\n"
+    "\n"
+    "{{getSessionRef}}\n"
+    "{\n"
+    "    return _Server.clientSessionRef;\n"
+    "}\n"
+    "\n"
+    "\n"
+    "{{startServerFunc}}\n"
+    "{\n"
+    "    le_ipc_AdvertiseService(&_Server);\n"
+    "}\n"
+;
+
+static const char* const ServerStartClientCode =
+    "\n"
+    SEPARATOR_LINE
+    "// Client Specific Server Code\n"
+    SEPARATOR_LINE
+;
+
+static const char* const ServerAsyncResponseTemplate =
+    "\n"
+    "static void AsyncResponse_{{name}}\n"
+    "(\n"
+    "    {{parms}}\n"
+    ")\n"
+    "{\n"
+    "    le_msg_MessageRef_t _msgRef;\n"
+    "    _Message_t* _msgPtr;\n"
+    "    le_ipc_ServerHandler_t* _serverHandlerPtr = contextPtr;\n"
+    "\n"
+    "    // Will not be used if no data is sent back to client\n"
+    "    __attribute__((unused)) uint8_t* _msgBufPtr;\n"
+    "    __attribute__((unused)) uint8_t* _msgBufEndPtr;\n"
+    "\n"
+    "    // Create a new message object and get the message buffer\n"
+    "    _msgRef = le_msg_CreateMsg(_serverHandlerPtr->clientSessionRef);\n"
+    "    _msgPtr = le_msg_GetPayloadPtr(_msgRef);\n"
+    "    _msgPtr->id = _MSGID_{{name}};\n"
+    "    _msgBufPtr = _msgPtr->buffer;\n"
+    "    _msgBufEndPtr = _msgPtr->buffer + _MAX_MSG_SIZE;\n"
+    "\n"
+    "    // The fixed-size fields are at the start of the message\n"
+    "    {{indicationType}}* _txFieldsPtr = ({{indicationType}}*)_msgBufPtr;\n"
+    "    _msgBufPtr += LE_IPC_ALIGN_SIZE(sizeof({{indicationType}}));\n"
+    "\n"
+    "    // Always pack the client context pointer first\n"
+    "    _txFieldsPtr->_clientContextPtr = _serverHandlerPtr->contextPtr;\n"
+    "\n"
+    "    // Pack the input parameters\n"
+    "    {{pack}}\n"
+    "\n"
+    "    // Send the async response to the client\n"
+    "    LE_DEBUG(\"Sending message to client session %p\", _serverHandlerPtr->clientSessionRef);\n"
+    "    le_msg_Send(_msgRef);\n"
+    "}\n"
+;
+
+static const char* const ServerHandlerTemplate =
+    "\n"
+    "static void Handle_{{name}}\n"
+    "(\n"
+    "    le_msg_MessageRef_t _msgRef\n"
+    "\n"
+    ")\n"
+    "{\n"
+    "    // Get the message buffer pointer\n"
+    "    __attribute__((unused)) uint8_t* _msgBufPtr = "
+    "((_Message_t*)le_msg_GetPayloadPtr(_msgRef))->buffer;\n"
+    "    __attribute__((unused)) uint8_t* _msgBufEndPtr = _msgBufPtr + _MAX_MSG_SIZE;\n"
+    "\n"
+    "    // Needed if we are returning a result or output values\n"
+    "    uint8_t* _msgBufStartPtr = _msgBufPtr;\n"
+    "{{#requestType}}"
+    "\n"
+    "    // The fixed-size fields are at the start of the message\n"
+    "    {{requestType}}* _rxFieldsPtr = ({{requestType}}*)_msgBufPtr;\n"
+    "    _msgBufPtr += LE_IPC_ALIGN_SIZE(sizeof({{requestType}}));\n"
+    "{{/requestType}}"
+    "\n"
+    "    // Unpack the input parameters from the message\n"
+    "    {{unpack}}\n"
+    "{{#requestHasData}}"
+    "\n"
+    "    // The client is dropped if anything in the message is not valid\n"
+    "    if ( _msgBufPtr == NULL )\n"
+    "    {\n"
+    "        LE_KILL_CLIENT(\"Invalid message received from client\");\n"
+    "        le_msg_ReleaseMsg(_msgRef);\n"
+    "        return;\n"
+    "    }\n"
+    "{{/requestHasData}}"
+    "\n"
+    "{{#isAddHandler}}"
+    "    // Create a new server handler object, which is passed to the function as the context "
+    "pointer\n"
+    "    le_ipc_ServerHandler_t* _serverHandlerPtr = le_ipc_NewServerHandler(_msgRef, "
+    "contextPtr);\n"
+    "    contextPtr = _serverHandlerPtr;\n"
+    "{{/isAddHandler}}"
+    "\n"
+    "    // Define storage for output parameters\n"
+    "    {{outStorage}}\n"
+    "\n"
+    "    // Call the function\n"
+    "{{^hasResult}}"
+    "    {{name}} ( {{callArgs}} );\n"
+    "\n"
+    "{{/hasResult}}"
+    "{{#hasResult}}"
+    "    {{type}} _result;\n"
+    "    _result = {{name}} ( {{callArgs}} );\n"
+    "\n"
+    "{{#isAddHandler}}"
+    "    // Put the handler reference result and a pointer to the associated remove function\n"
+    "    // into the server handler object.  This function pointer is needed in case the client\n"
+    "    // is closed and the handlers need to be removed.  A safe reference to the server "
+    "handler\n"
+    "    // object is returned as the reference.\n"
+    "    _result = le_ipc_AddServerHandler(_serverHandlerPtr,\n"
+    "                                      (le_event_HandlerRef_t)_result,\n"
+    "                                      (le_ipc_RemoveHandlerFunc_t){{removeName}});\n"
+    "{{/isAddHandler}}"
+    "\n"
+    "{{/hasResult}}"
+    "\n"
+    "    // Re-use the message buffer for the response\n"
+    "    _msgBufPtr = _msgBufStartPtr;\n"
+    "{{#responseType}}"
+    "\n"
+    "    // The fixed-size fields are at the start of the message\n"
+    "    {{responseType}}* _txFieldsPtr = ({{responseType}}*)_msgBufPtr;\n"
+    "    _msgBufPtr += LE_IPC_ALIGN_SIZE(sizeof({{responseType}}));\n"
+    "{{/responseType}}"
+    "\n"
+    "{{#hasResult}}"
+    "    // Pack the result first\n"
+    "    _txFieldsPtr->_result = _result;\n"
+    "{{/hasResult}}"
+    "\n"
+    "    // Pack any \"out\" parameters\n"
+    "    {{outPack}}\n"
+    "\n"
+    "    // Return the response\n"
+    "    LE_DEBUG(\"Sending response to client session %p\", le_msg_GetSession(_msgRef));\n"
+    "    le_msg_Respond(_msgRef);\n"
+    "}\n"
+;
+
+static const char* const OneWayServerHandlerTemplate =
+    "\n"
+    "static void Handle_{{name}}\n"
+    "(\n"
+    "    le_msg_MessageRef_t _msgRef\n"
+    ")\n"
+    "{\n"
+    "    // Get the message buffer pointer\n"
+    "    __attribute__((unused)) uint8_t* _msgBufPtr = "
+    "((_Message_t*)le_msg_GetPayloadPtr(_msgRef))->buffer;\n"
+    "    __attribute__((unused)) uint8_t* _msgBufEndPtr = _msgBufPtr + _MAX_MSG_SIZE;\n"
+    "{{#requestType}}"
+    "\n"
+    "    // The fixed-size fields are at the start of the message\n"
+    "    {{requestType}}* _rxFieldsPtr = ({{requestType}}*)_msgBufPtr;\n"
+    "    _msgBufPtr += LE_IPC_ALIGN_SIZE(sizeof({{requestType}}));\n"
+    "{{/requestType}}"
+    "\n"
+    "    // Unpack the input parameters from the message\n"
+    "    {{unpack}}\n"
+    "{{#requestHasData}}"
+    "\n"
+    "    // The client is dropped if anything in the message is not valid\n"
+    "    if ( _msgBufPtr == NULL )\n"
+    "    {\n"
+    "        LE_KILL_CLIENT(\"Invalid message received from client\");\n"
+    "        le_msg_ReleaseMsg(_msgRef);\n"
+    "        return;\n"
+    "    }\n"
+    "{{/requestHasData}}"
+    "\n"
+    "    // Call the function\n"
+    "    {{name}} ( {{callArgs}} );\n"
+    "\n"
+    "    // The client doesn't wait for a response to a one-way function.\n"
+    "    le_msg_ReleaseMsg(_msgRef);\n"
+    "}\n"
+;
+
+static const char* const AsyncServerHandlerTemplate =
+    "\n"
+    "{{respondProto}}\n"
+    "{\n"
+    "    LE_ASSERT(_cmdRef != NULL);\n"
+    "\n"
+    "    // Get the message related data\n"
+    "    le_msg_MessageRef_t _msgRef = (le_msg_MessageRef_t)_cmdRef;\n"
+    "    _Message_t* _msgPtr = le_msg_GetPayloadPtr(_msgRef);\n"
+    "    __attribute__((unused)) uint8_t* _msgBufPtr = _msgPtr->buffer;\n"
+    "    __attribute__((unused)) uint8_t* _msgBufEndPtr = _msgPtr->buffer + _MAX_MSG_SIZE;\n"
+    "\n"
+    "    // Ensure the passed in msgRef is for the correct message\n"
+    "    LE_ASSERT(_msgPtr->id == _MSGID_{{name}});\n"
+    "\n"
+    "    // Ensure that this Respond function has not already been called\n"
+    "    LE_FATAL_IF( !le_msg_NeedsResponse(_msgRef), \"Response has already been sent\");\n"
+    "{{#responseType}}"
+    "\n"
+    "    // The fixed-size fields are at the start of the message\n"
+    "    {{responseType}}* _txFieldsPtr = ({{responseType}}*)_msgBufPtr;\n"
+    "    _msgBufPtr += LE_IPC_ALIGN_SIZE(sizeof({{responseType}}));\n"
+    "{{/responseType}}"
+    "\n"
+    "{{#hasResult}}"
+    "    // Pack the result first\n"
+    "    _txFieldsPtr->_result = _result;\n"
+    "{{/hasResult}}"
+    "\n"
+    "    // Pack any \"out\" parameters\n"
+    "    {{outPack}}\n"
+    "\n"
+    "    // Return the response\n"
+    "    LE_DEBUG(\"Sending response to client session %p\", le_msg_GetSession(_msgRef));\n"
+    "    le_msg_Respond(_msgRef);\n"
+    "}\n"
+    "\n"
+    "static void Handle_{{name}}\n"
+    "(\n"
+    "    le_msg_MessageRef_t _msgRef\n"
+    ")\n"
+    "{\n"
+    "    // Get the message buffer pointer\n"
+    "    __attribute__((unused)) uint8_t* _msgBufPtr = "
+    "((_Message_t*)le_msg_GetPayloadPtr(_msgRef))->buffer;\n"
+    "    __attribute__((unused)) uint8_t* _msgBufEndPtr = _msgBufPtr + _MAX_MSG_SIZE;\n"
+    "{{#requestType}}"
+    "\n"
+    "    // The fixed-size fields are at the start of the message\n"
+    "    {{requestType}}* _rxFieldsPtr = ({{requestType}}*)_msgBufPtr;\n"
+    "    _msgBufPtr += LE_IPC_ALIGN_SIZE(sizeof({{requestType}}));\n"
+    "{{/requestType}}"
+    "\n"
+    "    // Unpack the input parameters from the message\n"
+    "    {{unpack}}\n"
+    "{{#requestHasData}}"
+    "\n"
+    "    // The client is dropped if anything in the message is not valid\n"
+    "    if ( _msgBufPtr == NULL )\n"
+    "    {\n"
+    "        LE_KILL_CLIENT(\"Invalid message received from client\");\n"
+    "        le_msg_ReleaseMsg(_msgRef);\n"
+    "        return;\n"
+    "    }\n"
+    "{{/requestHasData}}"
+    "\n"
+    "    // Call the function\n"
+    "    {{name}} ( ({{serverCmdRef}})_msgRef{{callArgs}} );\n"
+    "}\n"
+;
+
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Values of template fields, by field name.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef std::map<std::string, std::string> Values_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * An ordered collection of named items, in which setting an item that already exists replaces it
+ * without changing its position.
+ */
+//--------------------------------------------------------------------------------------------------
+template <class T>
+class OrderedMap_t : public std::vector<std::pair<std::string, T>>
+{
+    public:
+
+        void Set(const std::string& name, const T& value)
+        {
+            for (auto& item : *this)
+            {
+                if (item.first == name)
+                {
+                    item.second = value;
+                    return;
+                }
+            }
+
+            this->push_back(std::make_pair(name, value));
+        }
+};
+
+typedef std::shared_ptr<const Function_t> FunctionConstPtr_t;
+typedef std::shared_ptr<const Type_t> TypeConstPtr_t;
+typedef OrderedMap_t<FunctionConstPtr_t> FunctionMap_t;
+typedef OrderedMap_t<TypeConstPtr_t> TypeMap_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Expand a code template.
+ *
+ * @return The expanded text.
+ *
+ * @throw legato::Exception if the template refers to a field that has no value.
+ */
+//--------------------------------------------------------------------------------------------------
+static std::string Expand
+(
+    const std::string& text,    ///< The template.
+    const Values_t& values      ///< The values of the template's fields.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    std::string result;
+    std::vector<bool> outerKeepStack;   // Whether the enclosing sections' text is being kept.
+    bool isKept = true;
+    size_t pos = 0;
+
+    while (pos < text.size())
+    {
+        size_t tagPos = text.find("{{", pos);
+        if (tagPos == std::string::npos)
+        {
+            tagPos = text.size();
+        }
+
+        if (isKept)
+        {
+            result.append(text, pos, tagPos - pos);
+        }
+
+        if (tagPos == text.size())
+        {
+            break;
+        }
+
+        size_t endPos = text.find("}}", tagPos);
+        std::string tag = text.substr(tagPos + 2, endPos - tagPos - 2);
+        pos = endPos + 2;
+
+        if (tag[0] == '/')
+        {
+            isKept = outerKeepStack.back();
+            outerKeepStack.pop_back();
+            continue;
+        }
+
+        std::string name = ((tag[0] == '#') || (tag[0] == '^')) ? tag.substr(1) : tag;
+
+        auto i = values.find(name);
+        if (i == values.end())
+        {
+            throw legato::Exception("Internal error: no value for code template field '" + name
+                                    + "'.");
+        }
+
+        if (tag[0] == '#')
+        {
+            outerKeepStack.push_back(isKept);
+            isKept = isKept && !i->second.empty();
+        }
+        else if (tag[0] == '^')
+        {
+            outerKeepStack.push_back(isKept);
+            isKept = isKept && i->second.empty();
+        }
+        else if (isKept)
+        {
+            result += i->second;
+        }
+    }
+
+    return result;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * @return A copy of some text with the spaces at the ends of its lines removed.
+ */
+//--------------------------------------------------------------------------------------------------
+static std::string StripTrailingSpaces
+(
+    const std::string& text
+)
+//--------------------------------------------------------------------------------------------------
+{
+    std::string result;
+    size_t spaceCount = 0;
+
+    for (auto c : text)
+    {
+        if (c == ' ')
+        {
+            spaceCount++;
+            continue;
+        }
+
+        if (c != '\n')
+        {
+            result.append(spaceCount, ' ');
+        }
+        spaceCount = 0;
+
+        result += c;
+    }
+
+    return result;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Expand a code template the way ifgen does, which removes the spaces at the ends of the lines.
+ *
+ * @return The code.
+ */
+//--------------------------------------------------------------------------------------------------
+static std::string FormatCode
+(
+    const std::string& text,    ///< The template.
+    const Values_t& values      ///< The values of the template's fields.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    return StripTrailingSpaces(Expand(text, values));
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * @return A copy of some text with white space removed from both ends.
+ */
+//--------------------------------------------------------------------------------------------------
+static std::string Strip
+(
+    const std::string& text
+)
+//--------------------------------------------------------------------------------------------------
+{
+    const char* whiteSpace = " \t\n\r\v\f";
+
+    size_t startPos = text.find_first_not_of(whiteSpace);
+    if (startPos == std::string::npos)
+    {
+        return "";
+    }
+
+    return text.substr(startPos, text.find_last_not_of(whiteSpace) + 1 - startPos);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Split text into lines.  Like Python's splitlines(), a line break at the end of the text doesn't
+ * start another line, so empty text has no lines.
+ *
+ * @return The lines, without their line breaks.
+ */
+//--------------------------------------------------------------------------------------------------
+static std::vector<std::string> SplitLines
+(
+    const std::string& text
+)
+//--------------------------------------------------------------------------------------------------
+{
+    std::vector<std::string> lines;
+    size_t pos = 0;
+
+    while (pos < text.size())
+    {
+        size_t breakPos = text.find_first_of("\r\n", pos);
+        if (breakPos == std::string::npos)
+        {
+            lines.push_back(text.substr(pos));
+            break;
+        }
+
+        lines.push_back(text.substr(pos, breakPos - pos));
+
+        pos = breakPos + 1;
+        if ((text[breakPos] == '\r') && (pos < text.size()) && (text[pos] == '\n'))
+        {
+            pos++;
+        }
+    }
+
+    return lines;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * @return The strings joined together, with a separator between each one and the next.
+ */
+//--------------------------------------------------------------------------------------------------
+static std::string Join
+(
+    const std::vector<std::string>& strings,
+    const std::string& separator
+)
+//--------------------------------------------------------------------------------------------------
+{
+    std::string result;
+
+    for (size_t i = 0; i < strings.size(); i++)
+    {
+        if (i > 0)
+        {
+            result += separator;
+        }
+        result += strings[i];
+    }
+
+    return result;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Indent all lines but the first by four spaces, for text that goes at the place of a template
+ * field that is already indented by four.  A line break at the end of the text is dropped.
+ *
+ * @return The indented text.
+ */
+//--------------------------------------------------------------------------------------------------
+static std::string Indent
+(
+    const std::string& text
+)
+//--------------------------------------------------------------------------------------------------
+{
+    return Join(SplitLines(text), "\n    ");
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * @return The text with the first occurrence of a string in it replaced by another string.
+ */
+//--------------------------------------------------------------------------------------------------
+static std::string ReplaceFirst
+(
+    const std::string& text,
+    const std::string& oldString,
+    const std::string& newString
+)
+//--------------------------------------------------------------------------------------------------
+{
+    std::string result = text;
+
+    size_t pos = result.find(oldString);
+    if (pos != std::string::npos)
+    {
+        result.replace(pos, oldString.size(), newString);
+    }
+
+    return result;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * @return A file name without the directory part and without the extension (if any).
+ */
+//--------------------------------------------------------------------------------------------------
+static std::string StripExtension
+(
+    const std::string& fileName
+)
+//--------------------------------------------------------------------------------------------------
+{
+    std::string name = legato::GetLastPathNode(fileName);
+
+    // A dot at the start of the name doesn't start an extension.
+    size_t dotPos = name.rfind('.');
+    if ((dotPos != std::string::npos) && (name.find_first_not_of('.') < dotPos))
+    {
+        name.erase(dotPos);
+    }
+
+    return name;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * @return A file name without the directory part and without the extension (if any), in upper
+ *         case, for use in include guards.
+ */
+//--------------------------------------------------------------------------------------------------
+static std::string IncludeGuardName
+(
+    const std::string& fileName
+)
+//--------------------------------------------------------------------------------------------------
+{
+    std::string name = StripExtension(fileName);
+
+    for (auto& c : name)
+    {
+        if ((c >= 'a') && (c <= 'z'))
+        {
+            c = c - 'a' + 'A';
+        }
+    }
+
+    return name;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Format each parameter of a list with one of its code templates, skipping void parameters.
+ *
+ * @return The formatted parameters, with a separator between each one and the next, and also in
+ *         front of the first one if isLeadSep is true.
+ */
+//--------------------------------------------------------------------------------------------------
+static std::string PrintParmList
+(
+    const ParameterList_t& parmList,
+    const std::string& templateName,
+    const std::string& separator = ",\n",
+    bool isLeadSep = false
+)
+//--------------------------------------------------------------------------------------------------
+{
+    std::vector<std::string> results;
+
+    for (const auto& parmPtr : parmList)
+    {
+        if (parmPtr->kind != legato::api::Parameter_t::VOID)
+        {
+            results.push_back(parmPtr->Format(templateName));
+        }
+    }
+
+    std::string result = Join(results, separator);
+
+    if (isLeadSep && !result.empty())
+    {
+        result = separator + result;
+    }
+
+    return result;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Put some text into a doxygen-style comment header.
+ *
+ * @return The comment header.
+ */
+//--------------------------------------------------------------------------------------------------
+static std::string FormatHeaderComment
+(
+    const std::string& comment
+)
+//--------------------------------------------------------------------------------------------------
+{
+    return Strip(FormatCode(HeaderCommentTemplate,
+                            { { "comment", Join(SplitLines(comment), "\n * ") } }));
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add the parameters and their comments to the comment header of a handler type.
+ *
+ * @return The new comment header.
+ */
+//--------------------------------------------------------------------------------------------------
+static std::string AddParamComments
+(
+    const std::string& header,
+    const ParameterList_t& parmList
+)
+//--------------------------------------------------------------------------------------------------
+{
+    auto headerLines = SplitLines(header.empty() ? FormatHeaderComment("This handler ...")
+                                                 : header);
+
+    std::vector<std::string> lines(headerLines.begin(), headerLines.end() - 1);
+    lines.push_back(" *");
+
+    for (const auto& parmPtr : parmList)
+    {
+        lines.push_back(" * @param " + parmPtr->name);
+
+        // Each line of a parameter's comments starts with "///<", which is replaced.
+        for (const auto& commentLine : SplitLines(parmPtr->comment))
+        {
+            std::string text = (commentLine.size() > 4) ? commentLine.substr(4) : "";
+            size_t startPos = text.find_first_not_of(" \t\n\r\v\f");
+
+            lines.push_back(" *        "
+                            + ((startPos == std::string::npos) ? "" : text.substr(startPos)));
+        }
+    }
+
+    lines.push_back(headerLines.back());
+
+    return Join(lines, "\n");
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * @return The prototype of a function, without the ending semicolon.
+ */
+//--------------------------------------------------------------------------------------------------
+static std::string GetFuncPrototype
+(
+    const Function_t& func
+)
+//--------------------------------------------------------------------------------------------------
+{
+    std::vector<std::string> parms;
+
+    for (size_t i = 0; i < func.parmList.size(); i++)
+    {
+        const auto& parm = *func.parmList[i];
+
+        std::string text = parm.Format("clientParmList");
+        if (i + 1 < func.parmList.size())
+        {
+            text += ",";
+        }
+
+        // Each parameter but void is followed by its direction and comments.
+        if (parm.type != "void")
+        {
+            std::vector<std::string> commentLines = SplitLines(parm.comment);
+            commentLines.insert(commentLines.begin(), "///< [" + parm.direction + "]");
+
+            text += "\n    " + Join(commentLines, "\n    ") + "\n";
+        }
+
+        parms.push_back(text);
+    }
+
+    return Strip(FormatCode(FuncPrototypeTemplate,
+                            {
+                                { "comment", func.comment },
+                                { "type", func.type },
+                                { "name", func.name },
+                                { "parms", Indent(Join(parms, "\n")) },
+                            }));
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * @return The prototype of the respond function of an asynchronous server-side function, without
+ *         the ending semicolon.
+ */
+//--------------------------------------------------------------------------------------------------
+static std::string GetRespondFuncPrototype
+(
+    const Function_t& func,
+    const std::string& namePrefix
+)
+//--------------------------------------------------------------------------------------------------
+{
+    std::vector<std::string> parms;
+
+    parms.push_back(AddNamePrefix(namePrefix, "ServerCmdRef_t") + " _cmdRef");
+
+    if (func.type != "void")
+    {
+        parms.push_back(func.type + " _result");
+    }
+
+    for (const auto& parmPtr : func.parmListOut)
+    {
+        parms.push_back(parmPtr->Format("asyncServerParmList"));
+    }
+
+    return Strip(FormatCode(RespondFuncPrototypeTemplate,
+                            {
+                                { "name", func.name },
+                                { "parms", Indent(Join(parms, ",\n")) },
+                            }));
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * @return The prototype of an asynchronous server-side function, without the ending semicolon.
+ */
+//--------------------------------------------------------------------------------------------------
+static std::string GetServerAsyncFuncPrototype
+(
+    const Function_t& func,
+    const std::string& namePrefix
+)
+//--------------------------------------------------------------------------------------------------
+{
+    return Strip(FormatCode(ServerAsyncFuncPrototypeTemplate,
+                            {
+                                { "name", func.name },
+                                { "serverCmdRef", AddNamePrefix(namePrefix, "ServerCmdRef_t") },
+                                { "parms", Indent(PrintParmList(func.parmListInCall,
+                                                                "asyncServerParmList",
+                                                                ",\n",
+                                                                true)) },
+                            }));
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * @return true if a client function gets pipelined Start and Finish variants.  Only the functions
+ *         that get a response, and whose OUT parameters don't need a buffer size in the request,
+ *         do.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool IsPipelined
+(
+    const Function_t& func
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (func.isOneWay || !func.addHandlerName.empty() || func.isRemoveHandler)
+    {
+        return false;
+    }
+
+    for (const auto& parmPtr : func.parmListOut)
+    {
+        bool isPointer = (parmPtr->kind == legato::api::Parameter_t::POINTER)
+                      || (parmPtr->kind == legato::api::Parameter_t::FILE_OUT);
+
+        if (!isPointer || (parmPtr->direction != legato::api::DirOut))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * @return The prototypes of the pipelined Start and Finish variants of a client function, without
+ *         the ending semicolons.
+ */
+//--------------------------------------------------------------------------------------------------
+static std::vector<std::string> GetPipelinedFuncPrototypes
+(
+    const Function_t& func,
+    const std::string& namePrefix
+)
+//--------------------------------------------------------------------------------------------------
+{
+    std::string pendingRef = AddNamePrefix(namePrefix, "PendingRef_t");
+    std::vector<std::string> startParms;
+    std::vector<std::string> finishParms = { pendingRef + " _pendingRef" };
+
+    for (const auto& parmPtr : func.parmList)
+    {
+        if (   (parmPtr->direction == legato::api::DirIn)
+            && (parmPtr->kind != legato::api::Parameter_t::VOID) )
+        {
+            startParms.push_back(parmPtr->Format("clientParmList"));
+        }
+    }
+
+    for (const auto& parmPtr : func.parmListOut)
+    {
+        finishParms.push_back(parmPtr->Format("clientParmList"));
+    }
+
+    return
+    {
+        Strip(FormatCode(PipelinedStartPrototypeTemplate,
+                         {
+                             { "pendingRef", pendingRef },
+                             { "name", func.name },
+                             { "parms", startParms.empty() ? "void"
+                                                           : Indent(Join(startParms, ",\n")) },
+                         })),
+        Strip(FormatCode(PipelinedFinishPrototypeTemplate,
+                         {
+                             { "type", func.type },
+                             { "name", func.name },
+                             { "parms", Indent(Join(finishParms, ",\n")) },
+                         })),
+    };
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * @return The definition of an ENUM or BITMASK type.
+ */
+//--------------------------------------------------------------------------------------------------
+static std::string GetEnumDefinition
+(
+    const Type_t& type
+)
+//--------------------------------------------------------------------------------------------------
+{
+    std::vector<std::string> members;
+    size_t count = 0;
+
+    for (const auto& member : type.memberList)
+    {
+        std::string text = member.name;
+
+        if (member.hasValue)
+        {
+            text += " = " + member.value;
+        }
+
+        if (++count < type.memberList.size())
+        {
+            text += ",";
+        }
+
+        if (!member.comment.empty())
+        {
+            text += "\n    " + Join(SplitLines(member.comment), "\n    ") + "\n";
+        }
+
+        members.push_back(text);
+    }
+
+    return FormatCode(EnumDefinitionTemplate,
+                      {
+                          { "comment", type.comment },
+                          { "members", Indent(Join(members, "\n")) },
+                          { "typeName", type.typeName },
+                      });
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Upper bounds on the sizes of C types that are not defined in the .api files.  Any type that is
+ * not listed here, or defined in the .api files, is assumed to be no bigger than 16 bytes.
+ */
+//--------------------------------------------------------------------------------------------------
+static const std::map<std::string, size_t> TypeSizeBounds =
+{
+    { "uint8_t", 1 }, { "int8_t", 1 }, { "bool", 1 }, { "char", 1 },
+    { "uint16_t", 2 }, { "int16_t", 2 },
+    { "uint32_t", 4 }, { "int32_t", 4 },
+    { "size_t", 8 }, { "le_result_t", 8 }, { "le_onoff_t", 8 }, { "void*", 8 },
+};
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * @return A size rounded up to a multiple of 8 bytes.
+ */
+//--------------------------------------------------------------------------------------------------
+static size_t AlignSize
+(
+    size_t size
+)
+//--------------------------------------------------------------------------------------------------
+{
+    return (size + 7) & ~(size_t)7;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Layout of one kind of message: the struct of fixed-size fields at the start of the message,
+ * followed by any strings and arrays.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    std::string typeName;               ///< Name of the struct ("" if there are no fields).
+    std::vector<std::string> fields;    ///< Definitions of the struct's members.
+    bool hasData;                       ///< true if strings or arrays follow the struct.
+    size_t fieldsSize;                  ///< Upper bound on the size of the struct.
+    size_t dataSize;                    ///< Upper bound on the size of the strings and arrays.
+}
+MessageLayout_t;
+
+
+/// Extra message fields (type and name) that are not parameters, such as the result.
+typedef std::vector<std::pair<std::string, std::string>> FieldList_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Generates the code for one .api file.
+ */
+//--------------------------------------------------------------------------------------------------
+class ApiCodeGenerator_t
+{
+    public:
+
+        ApiCodeGenerator_t(const Definition_t& definition, const ApiCodeOptions_t& options);
+
+        void Generate();
+
+    private:
+
+        const Definition_t& m_Definition;
+        const ApiCodeOptions_t& m_Options;
+
+        FunctionMap_t m_Functions;      ///< Functions, including handler ADD/REMOVE functions.
+        FunctionMap_t m_Handlers;       ///< Handler types.
+        TypeMap_t m_Types;              ///< Types, including handler reference types.
+
+        FunctionMap_t m_ClientFunctions;    ///< Generic client functions, by template field.
+        FunctionMap_t m_ServerFunctions;    ///< Generic server functions, by template field.
+
+    private:
+
+        void AddHandlerFunctions(const Function_t& addHandler);
+        FunctionConstPtr_t NewGenericFunction(const std::string& name,
+                                              const std::string& type,
+                                              const std::string& comment);
+
+        bool IsAsync(const Function_t& func) const;
+        const Function_t* FindHandler(const Function_t& addHandler) const;
+
+        size_t GetTypeSizeBound(const std::string& cType) const;
+        size_t GetDataSizeBound(const legato::api::Parameter_t& parm) const;
+        MessageLayout_t GetMessageLayout(const std::string& typeName,
+                                         const ParameterList_t& parmList,
+                                         const FieldList_t& extraFields) const;
+        std::vector<MessageLayout_t> GetMessageLayouts(const Function_t& func) const;
+        std::string GetMessageLayoutCode() const;
+
+        std::string GetCommonInterface(const std::string& startCode,
+                                       const FunctionMap_t& genericFunctions,
+                                       const std::list<std::string>& headerComments,
+                                       const std::string& importSuffix,
+                                       bool isAsync,
+                                       bool isPipelined) const;
+        std::string GetInterfaceHeader() const;
+        std::string GetServerHeader() const;
+        std::string GetLocalHeader(const std::string& fileName) const;
+        std::string GetClientCode(const std::string& localFileName,
+                                  const std::string& interfaceFileName) const;
+        std::string GetServerCode(const std::string& localFileName,
+                                  const std::string& serverHeaderFileName) const;
+};
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Constructor.  Sorts the things declared in the .api file into functions, handlers and types,
+ * adding the ADD and REMOVE functions and the reference type for each ADD_HANDLER, and creates
+ * the generic client and server functions.
+ */
+//--------------------------------------------------------------------------------------------------
+ApiCodeGenerator_t::ApiCodeGenerator_t
+(
+    const Definition_t& definition,
+    const ApiCodeOptions_t& options
+)
+//--------------------------------------------------------------------------------------------------
+:   m_Definition(definition),
+    m_Options(options)
+//--------------------------------------------------------------------------------------------------
+{
+    for (const auto& itemPtr : definition.code)
+    {
+        auto funcPtr = std::dynamic_pointer_cast<const Function_t>(itemPtr);
+        auto typePtr = std::dynamic_pointer_cast<const Type_t>(itemPtr);
+
+        if (typePtr)
+        {
+            m_Types.Set(typePtr->name, typePtr);
+        }
+        else if (funcPtr->kind == Function_t::HANDLER)
+        {
+            m_Handlers.Set(funcPtr->name, funcPtr);
+        }
+        else if (funcPtr->kind == Function_t::ADD_HANDLER)
+        {
+            AddHandlerFunctions(*funcPtr);
+        }
+        else
+        {
+            m_Functions.Set(funcPtr->name, funcPtr);
+        }
+    }
+
+    m_ClientFunctions.Set("startClientFunc",
+                          NewGenericFunction("ConnectService",
+                                             "void",
+                                             "Connect the client to the service"));
+    m_ClientFunctions.Set("stopClientFunc",
+                          NewGenericFunction("DisconnectService",
+                                             "void",
+                                             "Disconnect the client from the service"));
+
+    m_ServerFunctions.Set("getServiceRef",
+                          NewGenericFunction("GetServiceRef",
+                                             "le_msg_ServiceRef_t",
+                                             "Get the server service reference"));
+    m_ServerFunctions.Set("getSessionRef",
+                          NewGenericFunction("GetClientSessionRef",
+                                             "le_msg_SessionRef_t",
+                                             "Get the client session reference for the current "
+                                             "message"));
+    m_ServerFunctions.Set("startServerFunc",
+                          NewGenericFunction("AdvertiseService",
+                                             "void",
+                                             "Initialize the server and advertise the service."));
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Create a generic function, which has no parameters.
+ *
+ * @return The function.
+ */
+//--------------------------------------------------------------------------------------------------
+FunctionConstPtr_t ApiCodeGenerator_t::NewGenericFunction
+(
+    const std::string& name,
+    const std::string& type,
+    const std::string& comment
+)
+//--------------------------------------------------------------------------------------------------
+{
+    return std::make_shared<Function_t>(Function_t::FUNCTION,
+                                        name,
+                                        type,
+                                        ParameterList_t({ legato::api::NewVoidParameter() }),
+                                        FormatHeaderComment(comment),
+                                        m_Definition.namePrefix);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add the reference type and the ADD and REMOVE functions for an ADD_HANDLER declaration.
+ *
+ * The handler function pointer and context pointer parameters of the ADD function get special
+ * code, because what is passed to the server is a pointer to a client data object that holds
+ * them, and the reference returned to the client is a safe reference to that object.
+ */
+//--------------------------------------------------------------------------------------------------
+void ApiCodeGenerator_t::AddHandlerFunctions
+(
+    const Function_t& addHandler    ///< The ADD_HANDLER declaration.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    auto refTypePtr = legato::api::NewReferenceType(addHandler.baseName,
+                                                    FormatHeaderComment("Reference type for "
+                                                                        + addHandler.name
+                                                                        + " handler ADD/REMOVE "
+                                                                        "functions"),
+                                                    m_Definition.namePrefix);
+    m_Types.Set(addHandler.name, refTypePtr);
+
+    auto handlerParmPtr = legato::api::NewSimpleParameter("handlerPtr", addHandler.type);
+    auto contextParmPtr = legato::api::NewSimpleParameter("contextPtr", "void*");
+
+    ParameterList_t addParmList;
+    if ((addHandler.parmList.size() != 1)
+        || (addHandler.parmList.front()->kind != legato::api::Parameter_t::VOID))
+    {
+        addParmList = addHandler.parmList;
+    }
+    addParmList.push_back(handlerParmPtr);
+    addParmList.push_back(contextParmPtr);
+
+    auto addFuncPtr = std::make_shared<Function_t>(Function_t::FUNCTION,
+                                                   "Add" + addHandler.baseName,
+                                                   refTypePtr->refName,
+                                                   addParmList,
+                                                   FormatHeaderComment(addHandler.name
+                                                                       + " handler ADD function"),
+                                                   m_Definition.namePrefix);
+    addFuncPtr->addHandlerName = addHandler.type;
+
+    handlerParmPtr->Set("clientPack",
+                        "// The input parameters are stored in a client handler object, and it is\n"
+                        "// a pointer to this object that is passed down.\n"
+                        "le_ipc_ClientHandler_t* _clientHandlerPtr =\n"
+                        "    le_ipc_NewClientHandler((le_event_HandlerFunc_t)handlerPtr,\n"
+                        "                            contextPtr,\n"
+                        "                            _Handle_" + addFuncPtr->name + ");\n"
+                        "contextPtr = _clientHandlerPtr;");
+    handlerParmPtr->Set("handlerUnpack", "");
+    handlerParmPtr->Set("fieldDefinition", "");
+    handlerParmPtr->Set("unpackCallName", "AsyncResponse_" + addFuncPtr->name);
+
+    m_Functions.Set(addFuncPtr->name, addFuncPtr);
+
+    // The client passes a safe reference to the REMOVE function, which has to be swapped for the
+    // real handler reference before it is sent, and the server does the same with its own object.
+    auto refParmPtr = legato::api::NewSimpleParameter("addHandlerRef", refTypePtr->refName);
+
+    refParmPtr->Set("clientPack",
+                    "// The passed in handlerRef is a safe reference for the client handler "
+                    "object.  Need to get the\n"
+                    "// real handlerRef from the client handler object, which is then deleted, "
+                    "since it is no longer\n"
+                    "// needed.\n"
+                    "addHandlerRef = ({parm.parmType})le_ipc_RemoveClientHandler(addHandlerRef);\n"
+                    + refParmPtr->Get("clientPack"));
+    refParmPtr->Set("handlerUnpack",
+                    refParmPtr->Get("handlerUnpack") + "\n"
+                    "// The passed in handlerRef is a safe reference for the server handler "
+                    "object.  Need to get the\n"
+                    "// real handlerRef from the server handler object, which is then deleted, "
+                    "since it is no longer\n"
+                    "// needed.  The client is dropped if the reference is not valid or is not its "
+                    "own.\n"
+                    "addHandlerRef = ({parm.parmType})le_ipc_RemoveServerHandler(_msgRef, "
+                    "addHandlerRef);\n"
+                    "if ( addHandlerRef == NULL )\n"
+                    "{{\n"
+                    "    le_msg_ReleaseMsg(_msgRef);\n"
+                    "    return;\n"
+                    "}}\n");
+
+    auto removeFuncPtr = std::make_shared<Function_t>(Function_t::FUNCTION,
+                                                      "Remove" + addHandler.baseName,
+                                                      "void",
+                                                      ParameterList_t({ refParmPtr }),
+                                                      FormatHeaderComment(addHandler.name
+                                                                          + " handler REMOVE "
+                                                                          "function"),
+                                                      m_Definition.namePrefix);
+    removeFuncPtr->isRemoveHandler = true;
+
+    m_Functions.Set(removeFuncPtr->name, removeFuncPtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * @return true if a function is implemented asynchronously on the server side.  Handler ADD and
+ *         REMOVE functions never are, and neither are one-way functions, which have nothing to
+ *         respond with.
+ */
+//--------------------------------------------------------------------------------------------------
+bool ApiCodeGenerator_t::IsAsync
+(
+    const Function_t& func
+)
+const
+//--------------------------------------------------------------------------------------------------
+{
+    return m_Options.isAsyncServer && func.addHandlerName.empty() && !func.isRemoveHandler
+        && !func.isOneWay;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * @return The handler type added by a handler ADD function, or NULL if not found.
+ */
+//--------------------------------------------------------------------------------------------------
+const Function_t* ApiCodeGenerator_t::FindHandler
+(
+    const Function_t& addHandler
+)
+const
+//--------------------------------------------------------------------------------------------------
+{
+    for (const auto& item : m_Handlers)
+    {
+        if (item.second->name == addHandler.addHandlerName)
+        {
+            return item.second.get();
+        }
+    }
+
+    return NULL;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * @return An upper bound on the size of a value of a C type.  The types defined in the .api files
+ *         (including the handler reference types) are references, enums or integers.
+ */
+//--------------------------------------------------------------------------------------------------
+size_t ApiCodeGenerator_t::GetTypeSizeBound
+(
+    const std::string& cType
+)
+const
+//--------------------------------------------------------------------------------------------------
+{
+    auto i = TypeSizeBounds.find(cType);
+    if (i != TypeSizeBounds.end())
+    {
+        return i->second;
+    }
+
+    for (const auto& item : m_Definition.types)
+    {
+        if (item.second == cType)
+        {
+            return 8;
+        }
+    }
+
+    for (const auto& item : m_Types)
+    {
+        if ((item.second->kind == Type_t::REFERENCE) && (item.second->refName == cType))
+        {
+            return 8;
+        }
+    }
+
+    return 16;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * @return An upper bound on the size of a string or array parameter, when it is in a message.
+ */
+//--------------------------------------------------------------------------------------------------
+size_t ApiCodeGenerator_t::GetDataSizeBound
+(
+    const legato::api::Parameter_t& parm
+)
+const
+//--------------------------------------------------------------------------------------------------
+{
+    size_t count;
+
+    if (parm.kind == legato::api::Parameter_t::STRING)
+    {
+        if (parm.direction == legato::api::DirIn)
+        {
+            count = std::stoul(parm.Get("maxValue")) + 1;
+        }
+        else
+        {
+            count = std::stoul(parm.Get("minSize"));
+        }
+    }
+    else if (parm.direction == legato::api::DirIn)
+    {
+        count = std::stoul(parm.Get("maxSize")) * GetTypeSizeBound(parm.type);
+    }
+    else
+    {
+        count = std::stoul(parm.Get("minSize")) * GetTypeSizeBound(parm.type);
+    }
+
+    // Each item has an 8 byte length header, and is padded to a multiple of 8 bytes.
+    return 8 + AlignSize(count);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * @return The layout of a message that holds some parameters, after any extra fields.
+ */
+//--------------------------------------------------------------------------------------------------
+MessageLayout_t ApiCodeGenerator_t::GetMessageLayout
+(
+    const std::string& typeName,    ///< Name of the message's struct.
+    const ParameterList_t& parmList,
+    const FieldList_t& extraFields
+)
+const
+//--------------------------------------------------------------------------------------------------
+{
+    MessageLayout_t layout = { "", {}, false, 0, 0 };
+    std::vector<std::string> fieldTypes;
+
+    for (const auto& field : extraFields)
+    {
+        layout.fields.push_back(field.first + " " + field.second + ";");
+        fieldTypes.push_back(field.first);
+    }
+
+    for (const auto& parmPtr : parmList)
+    {
+        if (parmPtr->kind == legato::api::Parameter_t::VOID)
+        {
+            continue;
+        }
+
+        if (!parmPtr->Get("fieldDefinition").empty())
+        {
+            layout.fields.push_back(parmPtr->Format("fieldDefinition"));
+            fieldTypes.push_back(parmPtr->type);
+        }
+
+        if (   (parmPtr->kind == legato::api::Parameter_t::ARRAY)
+            || (parmPtr->kind == legato::api::Parameter_t::STRING) )
+        {
+            layout.hasData = true;
+            layout.dataSize += GetDataSizeBound(*parmPtr);
+        }
+    }
+
+    if (!layout.fields.empty())
+    {
+        layout.typeName = typeName;
+    }
+
+    for (const auto& type : fieldTypes)
+    {
+        layout.fieldsSize += (GetTypeSizeBound(type) <= 8) ? 8 : 16;
+    }
+
+    return layout;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * @return The layouts of the request and response messages of a function, and also of the
+ *         messages sent to the handler, for handler ADD functions.
+ */
+//--------------------------------------------------------------------------------------------------
+std::vector<MessageLayout_t> ApiCodeGenerator_t::GetMessageLayouts
+(
+    const Function_t& func
+)
+const
+//--------------------------------------------------------------------------------------------------
+{
+    FieldList_t resultFields;
+    if (func.type != "void")
+    {
+        resultFields.push_back(std::make_pair(func.type, std::string("_result")));
+    }
+
+    std::vector<MessageLayout_t> layouts =
+    {
+        GetMessageLayout("_Req_" + func.name + "_t", func.parmListIn, FieldList_t()),
+        GetMessageLayout("_Rsp_" + func.name + "_t", func.parmListOut, resultFields),
+    };
+
+    if (!func.addHandlerName.empty())
+    {
+        const Function_t* handlerPtr = FindHandler(func);
+        if (handlerPtr != NULL)
+        {
+            layouts.push_back(GetMessageLayout("_Ind_" + func.name + "_t",
+                                               handlerPtr->parmList,
+                                               { { "void*", "_clientContextPtr" } }));
+        }
+    }
+
+    return layouts;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * @return The definitions of the structs that hold the messages' fields, which are the same in
+ *         the client and the server.
+ */
+//--------------------------------------------------------------------------------------------------
+std::string ApiCodeGenerator_t::GetMessageLayoutCode
+(
+)
+const
+//--------------------------------------------------------------------------------------------------
+{
+    std::string text = MessageLayoutsHeader;
+
+    for (const auto& item : m_Functions)
+    {
+        for (const auto& layout : GetMessageLayouts(*item.second))
+        {
+            if (!layout.typeName.empty())
+            {
+                text += Expand(MessageLayoutTemplate,
+                               {
+                                   { "typeName", layout.typeName },
+                                   { "fields", Indent(Join(layout.fields, "\n")) },
+                                   { "dataSize", std::to_string(layout.dataSize) },
+                               });
+            }
+        }
+    }
+
+    return text;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * @return The contents of an interface header file (client or server).
+ */
+//--------------------------------------------------------------------------------------------------
+std::string ApiCodeGenerator_t::GetCommonInterface
+(
+    const std::string& startCode,               ///< Code that goes first, after the include guard.
+    const FunctionMap_t& genericFunctions,      ///< Generic function prototypes to include.
+    const std::list<std::string>& headerComments,   ///< Comments that go before everything.
+    const std::string& importSuffix,            ///< Suffix of the imported files' header files.
+    bool isAsync,                               ///< true if for an asynchronous server.
+    bool isPipelined                            ///< true to include pipelined client functions.
+)
+const
+//--------------------------------------------------------------------------------------------------
+{
+    // The guard is named after the .api file (which, like ifgen, strips two extensions).
+    std::string guardName = IncludeGuardName(StripExtension(m_Definition.filePath));
+    std::string text = std::string(WarningNotice) + "\n";
+
+    for (const auto& comment : headerComments)
+    {
+        text += comment + "\n";
+    }
+
+    text += FormatCode(IncludeGuardBeginTemplate, { { "fileName", guardName } }) + "\n";
+    text += startCode + "\n";
+
+    if (!m_Definition.importNames.empty())
+    {
+        text += "// Interface specific includes\n";
+        for (const auto& name : m_Definition.importNames)
+        {
+            text += "#include \"" + name + importSuffix + "\"\n";
+        }
+        text += "\n\n";
+    }
+
+    // If there are no functions or handlers, then the generic functions aren't needed either.
+    if (!m_Functions.empty() || !m_Handlers.empty())
+    {
+        for (const auto& item : genericFunctions)
+        {
+            text += GetFuncPrototype(*item.second) + ";\n\n";
+        }
+    }
+
+    for (const auto& item : m_Types)
+    {
+        const Type_t& type = *item.second;
+
+        if ((type.kind == Type_t::REFERENCE) || (type.kind == Type_t::DEFINE))
+        {
+            text += FormatCode(TypeDefinitionTemplate,
+                               {
+                                   { "comment", type.comment },
+                                   { "definition", type.definition },
+                               }) + "\n";
+        }
+        else
+        {
+            text += GetEnumDefinition(type) + "\n";
+        }
+    }
+
+    for (const auto& item : m_Handlers)
+    {
+        const Function_t& handler = *item.second;
+
+        text += FormatCode(HandlerTypeTemplate,
+                           {
+                               { "headerComment",
+                                 AddParamComments(handler.comment, handler.parmList) },
+                               { "name", handler.name },
+                               { "parms", Indent(PrintParmList(handler.parmList,
+                                                               "clientParmList")) },
+                           }) + "\n";
+    }
+
+    for (const auto& item : m_Functions)
+    {
+        const Function_t& func = *item.second;
+
+        if (isAsync && IsAsync(func))
+        {
+            text += GetRespondFuncPrototype(func, m_Definition.namePrefix) + ";\n\n";
+            text += GetServerAsyncFuncPrototype(func, m_Definition.namePrefix) + ";\n\n";
+        }
+        else
+        {
+            text += GetFuncPrototype(func) + ";\n\n";
+
+            if (isPipelined && IsPipelined(func))
+            {
+                for (const auto& prototype : GetPipelinedFuncPrototypes(func,
+                                                                        m_Definition.namePrefix))
+                {
+                    text += prototype + ";\n\n";
+                }
+            }
+        }
+    }
+
+    text += FormatCode(IncludeGuardEndTemplate, { { "fileName", guardName } }) + "\n";
+
+    return text;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * @return The contents of the client's interface header file.
+ */
+//--------------------------------------------------------------------------------------------------
+std::string ApiCodeGenerator_t::GetInterfaceHeader
+(
+)
+const
+//--------------------------------------------------------------------------------------------------
+{
+    std::string startCode;
+
+    if (m_Options.isPipelinedClient)
+    {
+        startCode = FormatCode(PipelinedInterfaceHeaderStartTemplate,
+                               {
+                                   { "pending",
+                                     AddNamePrefix(m_Definition.namePrefix, "Pending*") },
+                                   { "pendingRef",
+                                     AddNamePrefix(m_Definition.namePrefix, "PendingRef_t") },
+                               });
+    }
+    else
+    {
+        startCode = FormatCode(InterfaceHeaderStartTemplate, {});
+    }
+
+    return GetCommonInterface(startCode,
+                              m_ClientFunctions,
+                              m_Definition.headerComments,
+                              "_interface.h",
+                              false,
+                              m_Options.isPipelinedClient);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * @return The contents of the server's interface header file.
+ */
+//--------------------------------------------------------------------------------------------------
+std::string ApiCodeGenerator_t::GetServerHeader
+(
+)
+const
+//--------------------------------------------------------------------------------------------------
+{
+    std::string startCode;
+
+    if (m_Options.isAsyncServer)
+    {
+        startCode = FormatCode(AsyncServerHeaderStartTemplate,
+                               {
+                                   { "serverCmd",
+                                     AddNamePrefix(m_Definition.namePrefix, "ServerCmd*") },
+                                   { "serverCmdRef",
+                                     AddNamePrefix(m_Definition.namePrefix, "ServerCmdRef_t") },
+                               });
+    }
+    else
+    {
+        startCode = FormatCode(ServerHeaderStartTemplate, {});
+    }
+
+    return GetCommonInterface(startCode,
+                              m_ServerFunctions,
+                              std::list<std::string>(),
+                              "_server.h",
+                              m_Options.isAsyncServer,
+                              false);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * @return The contents of the local header file, which is shared by the client and the server.
+ */
+//--------------------------------------------------------------------------------------------------
+std::string ApiCodeGenerator_t::GetLocalHeader
+(
+    const std::string& fileName     ///< Name of the local header file.
+)
+const
+//--------------------------------------------------------------------------------------------------
+{
+    std::string guardName = IncludeGuardName(fileName);
+    std::string text = std::string(WarningNotice) + "\n";
+
+    // The buffer must be big enough for the biggest message.
+    size_t maxMsgSize = 8;
+    for (const auto& item : m_Functions)
+    {
+        for (const auto& layout : GetMessageLayouts(*item.second))
+        {
+            maxMsgSize = std::max(maxMsgSize, AlignSize(layout.fieldsSize + layout.dataSize));
+        }
+    }
+
+    text += FormatCode(IncludeGuardBeginTemplate, { { "fileName", guardName } }) + "\n";
+    text += FormatCode(LocalHeaderStartTemplate,
+                       {
+                           { "idString", m_Definition.hash },
+                           { "serviceName", m_Options.serviceName },
+                           { "maxMsgSize", std::to_string(maxMsgSize) },
+                       }) + "\n";
+
+    // The message IDs of the functions are their positions in the list.
+    size_t messageId = 0;
+    for (const auto& item : m_Functions)
+    {
+        text += "#define _MSGID_" + item.first + " " + std::to_string(messageId++) + "\n";
+    }
+    text += "\n";
+
+    text += FormatCode(IncludeGuardEndTemplate, { { "fileName", guardName } }) + "\n";
+
+    return text;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * @return The contents of the client's implementation file.
+ */
+//--------------------------------------------------------------------------------------------------
+std::string ApiCodeGenerator_t::GetClientCode
+(
+    const std::string& localFileName,
+    const std::string& interfaceFileName
+)
+const
+//--------------------------------------------------------------------------------------------------
+{
+    std::string text = std::string(WarningNotice) + "\n";
+
+    text += "\n#include \"" + localFileName + "\"\n#include \"" + interfaceFileName + "\"\n\n";
+    text += StripTrailingSpaces(GetMessageLayoutCode()) + "\n\n";
+    text += std::string(ClientGenericCode) + "\n";
+    text += FormatCode(ClientStartFuncTemplate,
+                       {
+                           { "startClientFunc",
+                             GetFuncPrototype(*m_ClientFunctions[0].second) },
+                           { "stopClientFunc",
+                             GetFuncPrototype(*m_ClientFunctions[1].second) },
+                       }) + "\n";
+    text += std::string(ClientStartClientCode) + "\n";
+
+    for (const auto& item : m_Functions)
+    {
+        const Function_t& func = *item.second;
+        bool isAddHandler = !func.addHandlerName.empty();
+        auto layouts = GetMessageLayouts(func);
+
+        if (isAddHandler)
+        {
+            const Function_t* handlerPtr = FindHandler(func);
+            if (handlerPtr != NULL)
+            {
+                text += FormatCode(ClientHandlerTemplate,
+                                   {
+                                       { "name", func.name },
+                                       { "handlerName", handlerPtr->name },
+                                       { "indicationType", layouts[2].typeName },
+                                       { "indicationHasData", layouts[2].hasData ? "1" : "" },
+                                       { "unpack", Indent(PrintParmList(handlerPtr->parmList,
+                                                                        "handlerUnpack",
+                                                                        "\n\n")) },
+                                       { "callArgs", PrintParmList(handlerPtr->parmList,
+                                                                   "unpackCallName",
+                                                                   ", ") },
+                                   }) + "\n";
+            }
+        }
+
+        std::string rangeChecks;
+        for (const auto& parmPtr : func.parmListIn)
+        {
+            if (parmPtr->IsTrue("maxValue") && !parmPtr->Get("maxValueCheck").empty())
+            {
+                rangeChecks += "    " + parmPtr->Format("maxValueCheck") + "\n";
+            }
+        }
+
+        // Await-style functions only suspend the calling coroutine (if any) while waiting for
+        // the server's response.
+        std::string requestFunc = m_Options.isAwaitClient ? "le_msg_RequestAwaitResponse"
+                                                          : "le_msg_RequestSyncResponse";
+
+        Values_t values =
+        {
+            { "prototype", GetFuncPrototype(func) },
+            { "name", func.name },
+            { "resultStorage", func.resultStorage },
+            { "rangeChecks", rangeChecks },
+            { "pack", Indent(PrintParmList(func.parmListIn, "clientPack", "\n")) },
+            { "requestFunc", requestFunc },
+            { "requestType", layouts[0].typeName },
+            { "responseType", layouts[1].typeName },
+            { "responseHasData", layouts[1].hasData ? "1" : "" },
+            { "hasResult", (func.type != "void") ? "1" : "" },
+            { "isAddHandler", isAddHandler ? "1" : "" },
+            { "unpack", Indent(PrintParmList(func.parmListOut, "clientUnpack", "\n")) },
+        };
+
+        text += FormatCode(func.isOneWay ? ClientOneWayFuncTemplate : ClientFuncTemplate,
+                           values) + "\n";
+
+        if (m_Options.isPipelinedClient && IsPipelined(func))
+        {
+            auto prototypes = GetPipelinedFuncPrototypes(func, m_Definition.namePrefix);
+
+            values["pendingRef"] = AddNamePrefix(m_Definition.namePrefix, "PendingRef_t");
+
+            values["prototype"] = prototypes[0];
+            text += FormatCode(ClientPipelinedStartTemplate, values) + "\n";
+
+            values["prototype"] = prototypes[1];
+            text += FormatCode(ClientPipelinedFinishTemplate, values) + "\n";
+        }
+    }
+
+    return text;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * @return The contents of the server's implementation file.
+ */
+//--------------------------------------------------------------------------------------------------
+std::string ApiCodeGenerator_t::GetServerCode
+(
+    const std::string& localFileName,
+    const std::string& serverHeaderFileName
+)
+const
+//--------------------------------------------------------------------------------------------------
+{
+    std::string serverCmdRef = AddNamePrefix(m_Definition.namePrefix, "ServerCmdRef_t");
+    std::string text = std::string(WarningNotice) + "\n";
+
+    text += "\n#include \"" + localFileName + "\"\n#include \"" + serverHeaderFileName + "\"\n\n";
+    text += StripTrailingSpaces(GetMessageLayoutCode()) + "\n\n";
+    text += std::string(ServerStartClientCode) + "\n";
+
+    std::string entries;
+
+    for (const auto& item : m_Functions)
+    {
+        const Function_t& func = *item.second;
+        bool isAddHandler = !func.addHandlerName.empty();
+        auto layouts = GetMessageLayouts(func);
+
+        if (isAddHandler)
+        {
+            const Function_t* handlerPtr = FindHandler(func);
+            if (handlerPtr != NULL)
+            {
+                text += FormatCode(ServerAsyncResponseTemplate,
+                                   {
+                                       { "name", func.name },
+                                       { "indicationType", layouts[2].typeName },
+                                       { "parms", Indent(PrintParmList(handlerPtr->parmList,
+                                                                       "clientParmList")) },
+                                       { "pack", Indent(PrintParmList(handlerPtr->parmList,
+                                                                      "clientPack",
+                                                                      "\n")) },
+                                   }) + "\n";
+            }
+        }
+
+        Values_t values =
+        {
+            { "name", func.name },
+            { "type", func.type },
+            { "hasResult", (func.type != "void") ? "1" : "" },
+            { "isAddHandler", isAddHandler ? "1" : "" },
+            { "unpack", Indent(PrintParmList(func.parmListIn, "handlerUnpack", "\n\n")) },
+            { "requestType", layouts[0].typeName },
+            { "requestHasData", layouts[0].hasData ? "1" : "" },
+            { "responseType", layouts[1].typeName },
+        };
+
+        if (func.isOneWay)
+        {
+            values["callArgs"] = PrintParmList(func.parmList, "unpackCallName", ", ");
+
+            text += FormatCode(OneWayServerHandlerTemplate, values) + "\n";
+        }
+        else if (IsAsync(func))
+        {
+            values["respondProto"] = GetRespondFuncPrototype(func, m_Definition.namePrefix);
+            values["outPack"] = Indent(PrintParmList(func.parmListOut, "asyncServerPack", "\n"));
+            values["serverCmdRef"] = serverCmdRef;
+            values["callArgs"] = PrintParmList(func.parmListInCall,
+                                               "asyncServerCallName",
+                                               ", ",
+                                               true);
+
+            text += FormatCode(AsyncServerHandlerTemplate, values) + "\n";
+        }
+        else
+        {
+            values["outStorage"] = Indent(PrintParmList(func.parmListOut,
+                                                        "handlerParmList",
+                                                        "\n"));
+            values["callArgs"] = PrintParmList(func.parmList, "unpackCallName", ", ");
+            values["removeName"] = ReplaceFirst(func.name, "Add", "Remove");
+            values["outPack"] = Indent(PrintParmList(func.parmListOut, "handlerPack", "\n"));
+
+            text += FormatCode(ServerHandlerTemplate, values) + "\n";
+        }
+
+        entries += Expand(ServerFuncEntryTemplate, { { "name", func.name } });
+    }
+
+    // The generic code comes last, since it refers to the functions above.
+    text += FormatCode(ServerGenericTemplate, { { "entries", entries } }) + "\n";
+    text += FormatCode(ServerStartFuncTemplate,
+                       {
+                           { "getServiceRef",
+                             GetFuncPrototype(*m_ServerFunctions[0].second) },
+                           { "getSessionRef",
+                             GetFuncPrototype(*m_ServerFunctions[1].second) },
+                           { "startServerFunc",
+                             GetFuncPrototype(*m_ServerFunctions[2].second) },
+                       }) + "\n";
+
+    return text;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write a generated file, unless it already has the same contents.
+ *
+ * @throw legato::Exception if the file can't be written.
+ */
+//--------------------------------------------------------------------------------------------------
+static void WriteFileIfChanged
+(
+    const std::string& path,
+    const std::string& contents
+)
+//--------------------------------------------------------------------------------------------------
+{
+    {
+        std::ifstream oldFile(path, std::ios::binary);
+        if (oldFile.is_open())
+        {
+            std::stringstream oldContents;
+            oldContents << oldFile.rdbuf();
+            if (oldContents.str() == contents)
+            {
+                return;
+            }
+        }
+    }
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file << contents;
+    file.close();
+
+    if (file.fail())
+    {
+        throw legato::Exception("Failed to write file '" + path + "'.");
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Generate the requested files.
+ *
+ * @throw legato::Exception on failure.
+ */
+//--------------------------------------------------------------------------------------------------
+void ApiCodeGenerator_t::Generate
+(
+)
+//--------------------------------------------------------------------------------------------------
+{
+    std::string prefix = m_Options.filePrefix.empty() ? "" : m_Options.filePrefix + "_";
+
+    std::string interfaceFileName = prefix + "interface.h";
+    std::string localFileName = prefix + "local.h";
+    std::string clientFileName = prefix + "client.c";
+    std::string serverFileName = prefix + "server.c";
+    std::string serverHeaderFileName = prefix + "server.h";
+
+    if (!m_Options.outputDir.empty())
+    {
+        legato::MakeDir(m_Options.outputDir);
+    }
+
+    auto outputPath = [this](const std::string& fileName)
+        {
+            return m_Options.outputDir.empty() ? fileName
+                                               : legato::CombinePath(m_Options.outputDir,
+                                                                     fileName);
+        };
+
+    if (m_Options.genInterface)
+    {
+        WriteFileIfChanged(outputPath(interfaceFileName), GetInterfaceHeader());
+    }
+
+    if (m_Options.genLocal)
+    {
+        WriteFileIfChanged(outputPath(localFileName), GetLocalHeader(localFileName));
+    }
+
+    if (m_Options.genClient)
+    {
+        WriteFileIfChanged(outputPath(clientFileName),
+                           GetClientCode(localFileName, interfaceFileName));
+    }
+
+    if (m_Options.genServerInterface)
+    {
+        WriteFileIfChanged(outputPath(serverHeaderFileName), GetServerHeader());
+    }
+
+    if (m_Options.genServer)
+    {
+        WriteFileIfChanged(outputPath(serverFileName),
+                           GetServerCode(localFileName, serverHeaderFileName));
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Generate the IPC code for a .api file.  Generated files are only written if their contents
+ * have changed, so that things that depend on them aren't rebuilt for nothing.
+ *
+ * @throw legato::Exception on failure.
+ */
+//--------------------------------------------------------------------------------------------------
+void GenerateApiCode
+(
+    const legato::api::Definition_t& definition,    ///< Definition of the .api file.
+    const ApiCodeOptions_t& options                 ///< What to generate.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    ApiCodeGenerator_t(definition, options).Generate();
+}
+
+
+}
@@ -0,0 +1,61 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * Definition of the IPC code generator used by mkif.
+ *
+ * The generator turns the definition of a .api file into the C code that implements the IPC
+ * interface: the interface header files for clients and servers, the local header file shared
+ * by both, and the client and server implementation files.  The generated code is the same, byte
+ * for byte, as what ifgen generates.
+ *
+ * Copyright (C) Sierra Wireless, Inc. 2014.  Use of this work is subject to license.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#ifndef API_CODE_GENERATOR_H_INCLUDE_GUARD
+#define API_CODE_GENERATOR_H_INCLUDE_GUARD
+
+namespace mk
+{
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * What code to generate, and where to put it.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    bool genInterface;          ///< Generate the client interface header file (interface.h).
+    bool genLocal;              ///< Generate the local header file (local.h).
+    bool genClient;             ///< Generate the client implementation file (client.c).
+    bool genServerInterface;    ///< Generate the server interface header file (server.h).
+    bool genServer;             ///< Generate the server implementation file (server.c).
+    bool isAsyncServer;         ///< Generate asynchronous-style server functions.
+    bool isAwaitClient;         ///< Generate client functions that only suspend the caller's
+                                ///  coroutine (if any) while waiting for the server's response.
+    bool isPipelinedClient;     ///< Also generate Start and Finish client functions, which send
+                                ///  a request and collect its response separately.
+    std::string filePrefix;     ///< Prefix for the generated file names ("" = none).
+    std::string serviceName;    ///< Service instance name.
+    std::string outputDir;      ///< Directory to put the generated files in ("" = current dir).
+}
+ApiCodeOptions_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Generate the IPC code for a .api file.  Generated files are only written if their contents
+ * have changed, so that things that depend on them aren't rebuilt for nothing.
+ *
+ * @throw legato::Exception on failure.
+ */
+//--------------------------------------------------------------------------------------------------
+void GenerateApiCode
+(
+    const legato::api::Definition_t& definition,    ///< Definition of the .api file.
+    const ApiCodeOptions_t& options                 ///< What to generate.
+);
+
+
+}
+
+#endif // API_CODE_GENERATOR_H_INCLUDE_GUARD
@@ -12,6 +12,7 @@
 #include "ComponentBuilder.h"
 #include "ExecutableBuilder.h"
 #include "Utilities.h"
+#include "Profiler.h"
 
 
 //--------------------------------------------------------------------------------------------------
@@ -411,6 +412,26 @@ static void GenerateProcessConfig
                       << procEnv.MaxFileDescriptors().Get() << "]"
                       << std::endl;
 
+            if (procEnv.MaxStackBytes().IsSet())
+            {
+                cfgStream << "      \"maxStackBytes\" [" << procEnv.MaxStackBytes().Get() << "]"
+                          << std::endl;
+            }
+
+            // The CPU affinity is an indexed list of CPU numbers.
+            if (!procEnv.CpuAffinity().empty())
+            {
+                cfgStream << "      \"cpuAffinity\"" << std::endl;
+                cfgStream << "      {" << std::endl;
+                int cpuIndex = 0;
+                for (int cpu : procEnv.CpuAffinity())
+                {
+                    cfgStream << "        \"" << cpuIndex << "\" [" << cpu << "]" << std::endl;
+                    cpuIndex++;
+                }
+                cfgStream << "      }" << std::endl;
+            }
+
             if (procEnv.WatchdogTimeout().IsSet())
             {
                 cfgStream << "      \"watchdogTimeout\" [" << procEnv.WatchdogTimeout().Get() << "]"
@@ -824,6 +845,34 @@ void CheckForLimitsConflicts
 
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add the paths of the Component.cdef files and bundled directories of a component and all its
+ * sub-components to the lists of things that determine what goes into the app's staging area.
+ **/
+//--------------------------------------------------------------------------------------------------
+static void GetStagingInputs
+(
+    const legato::Component& component,
+    std::list<std::string>& defFiles,       ///< [IN/OUT] List to add the .cdef file paths to.
+    std::list<std::string>& bundledDirs     ///< [IN/OUT] List to add the bundled dir paths to.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    for (const auto& mapEntry : component.SubComponents())
+    {
+        GetStagingInputs(*mapEntry.second, defFiles, bundledDirs);
+    }
+
+    defFiles.push_back(legato::CombinePath(component.Path(), "Component.cdef"));
+
+    for (const auto& fileMapping : component.BundledDirs())
+    {
+        bundledDirs.push_back(fileMapping.m_SourcePath);
+    }
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Build a component and all its sub-components and copy all their bundled files into the
@@ -877,6 +926,8 @@ void ApplicationBuilder_t::Build
 )
 //--------------------------------------------------------------------------------------------------
 {
+    mk::ProfilePhase_t phase("app", app.Name());
+
     CheckForLimitsConflicts(app);
 
     // Construct the working directory structure, which consists of an "work" directory and
@@ -898,8 +949,18 @@ void ApplicationBuilder_t::Build
     buildParams.ExeOutputDir(stagingDirPath + "/bin");
     buildParams.ObjOutputDir(m_Params.ObjOutputDir() + "/work");
 
-    // Clean the staging area.
-    legato::CleanDir(stagingDirPath);
+    // Clean the staging area, if anything might have been removed from it.
+    std::list<std::string> defFiles = { app.DefFilePath() };
+    std::list<std::string> bundledDirs;
+    for (const auto& mapEntry : app.ComponentMap())
+    {
+        GetStagingInputs(*mapEntry.second, defFiles, bundledDirs);
+    }
+    for (const auto& fileMapping : app.BundledDirs())
+    {
+        bundledDirs.push_back(fileMapping.m_SourcePath);
+    }
+    mk::CleanStagingDir(stagingDirPath, defFiles, bundledDirs, buildParams);
 
     // Create directories.
     legato::MakeDir(buildParams.ObjOutputDir());
@@ -965,7 +1026,7 @@ void ApplicationBuilder_t::Build
         std::cout << std::endl << "$ " << tarCommandLine << std::endl << std::endl;
     }
 
-    mk::ExecuteCommandLine(tarCommandLine);
+    mk::PackageStagingDir(tarCommandLine, stagingDirPath, outputPath);
 }
 
 
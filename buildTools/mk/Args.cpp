@@ -345,11 +345,12 @@ static void GetLongParamArg
 
 //--------------------------------------------------------------------------------------------------
 /**
- *  Internal function called to extract a short param argument ("-f bar" style) from the
- *  argument list.
+ *  Internal function called to extract a short param argument ("-f bar" or "-fbar" style) from
+ *  the argument list.
  *
  *  @return
- *      A value of true if an arg was found, false otherwise.
+ *      A value of true if the next item in the argument list was consumed as the value, false
+ *      otherwise.
  */
 //--------------------------------------------------------------------------------------------------
 static bool GetShortParamArg
@@ -368,14 +369,29 @@ static bool GetShortParamArg
     {
         std::string paramArg;
 
-        if (paramIter.shortName == (argv[index] + 1))
+        if (paramIter.shortName[0] == argv[index][1])
         {
+            // Anything after the name is the value ("-j8").  Flags don't take values.
+            const char* attachedValue = argv[index] + 2;
+
             if (paramIter.type == ParamInfo::FLAG)
             {
+                if (attachedValue[0] != '\0')
+                {
+                    throw std::runtime_error(std::string("Bad short name parameter flag, ")
+                                             + argv[index] + ".");
+                }
+
                 SetParamValue(const_cast<ParamInfo&>(paramIter), "");
 
                 return false;
             }
+            else if (attachedValue[0] != '\0')
+            {
+                SetParamValue(const_cast<ParamInfo&>(paramIter), attachedValue);
+
+                return false;
+            }
             else
             {
                 if ((index + 1) >= argc)
@@ -557,14 +573,6 @@ void le_arg_Scan
         {
             // TODO: Support single name flags, bunched together, '-xyz'.
 
-            // We only support a single character for the short name parameters.
-            if (len > 2)
-            {
-                throw std::runtime_error(std::string("Bad short name parameter flag, ") + next +
-                                         ".");
-            }
-
-
             // Check if the user is asking for help.
             if (std::strcmp(next, "-h") == 0)
             {
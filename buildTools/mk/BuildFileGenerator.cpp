@@ -0,0 +1,576 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * Implementation of the generation of build files for other build tools.
+ *
+ * Recorded jobs are turned into Ninja build statements as follows:
+ *
+ *  - Paths that are existing directories are only used by the job scheduler to order jobs (e.g.,
+ *    an mkif run into a directory must finish before a compile that searches that directory for
+ *    headers).  They are left out of the build statements and turned into order-only
+ *    dependencies on the jobs that write to them.
+ *  - Ninja doesn't allow more than one build statement to produce the same file, so a job that
+ *    is identical to an earlier one is dropped, and a file written by more than one job is left
+ *    out of all their outputs.  A job that ends up with no outputs gets a stamp file instead.
+ *    Jobs that read such a file depend on the outputs (or stamps) of the jobs that write it,
+ *    as implicit dependencies, instead of on the file itself.
+ *  - Compiles use their dependency files (deps = gcc), and mkif runs use restat, because
+ *    generating headers that haven't changed shouldn't cause everything to be recompiled.
+ *
+ * Copyright (C) 2014, Sierra Wireless Inc.  Use of this work is subject to license.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include <vector>
+#include "LegatoObjectModel.h"
+#include "BuildFileGenerator.h"
+#include "JobScheduler.h"
+#include "../Parser/Parser.h"
+
+
+namespace mk
+{
+
+/// Path of the build file to generate ("" = no generator selected).
+static std::string BuildFilePath;
+
+/// Directory where the build file and other generated files go.
+static std::string GeneratorDir;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A recorded job, as it will appear in the Ninja build file.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    const JobInfo_t* jobPtr;            ///< The recorded job.
+    std::list<std::string> outputs;     ///< Files the build statement produces.
+    std::list<std::string> inputs;      ///< Explicit inputs.
+    std::set<size_t> implicitJobs;      ///< Indexes of the jobs whose outputs are implicit inputs.
+    std::set<size_t> orderOnlyJobs;     ///< Indexes of the jobs that must be run before this one.
+    std::string stampPath;              ///< Stamp file ("" = the job has real outputs).
+}
+NinjaJob_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check whether a path is an existing directory.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool IsDir
+(
+    const std::string& path
+)
+//--------------------------------------------------------------------------------------------------
+{
+    return legato::DirectoryExists(path);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Escape a path for use in a Ninja build statement.
+ */
+//--------------------------------------------------------------------------------------------------
+static std::string NinjaPath
+(
+    const std::string& path
+)
+//--------------------------------------------------------------------------------------------------
+{
+    std::string result;
+
+    for (char c : path)
+    {
+        if ((c == '$') || (c == ' ') || (c == ':'))
+        {
+            result += '$';
+        }
+        result += c;
+    }
+
+    return result;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Escape a string for use as the value of a Ninja variable.
+ */
+//--------------------------------------------------------------------------------------------------
+static std::string NinjaValue
+(
+    const std::string& value
+)
+//--------------------------------------------------------------------------------------------------
+{
+    std::string result;
+
+    for (char c : value)
+    {
+        if (c == '$')
+        {
+            result += '$';
+        }
+        result += c;
+    }
+
+    return result;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Escape a string for use inside double quotes in a JSON file.
+ */
+//--------------------------------------------------------------------------------------------------
+static std::string JsonString
+(
+    const std::string& value
+)
+//--------------------------------------------------------------------------------------------------
+{
+    std::string result;
+
+    for (char c : value)
+    {
+        if ((c == '"') || (c == '\\'))
+        {
+            result += '\\';
+            result += c;
+        }
+        else if (c == '\n')
+        {
+            result += "\\n";
+        }
+        else if (c == '\t')
+        {
+            result += "\\t";
+        }
+        else
+        {
+            result += c;
+        }
+    }
+
+    return result;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Quote a command-line argument for the shell, if it needs it.
+ */
+//--------------------------------------------------------------------------------------------------
+static std::string ShellQuote
+(
+    const std::string& arg
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (!arg.empty() && (arg.find_first_not_of("abcdefghijklmnopqrstuvwxyz"
+                                               "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+                                               "0123456789_-+=./,:@%") == std::string::npos))
+    {
+        return arg;
+    }
+
+    std::string result = "'";
+
+    for (char c : arg)
+    {
+        if (c == '\'')
+        {
+            result += "'\\''";
+        }
+        else
+        {
+            result += c;
+        }
+    }
+
+    return result + "'";
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Work out the build statements for all the recorded jobs.
+ */
+//--------------------------------------------------------------------------------------------------
+static std::vector<NinjaJob_t> GetNinjaJobs
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    std::vector<NinjaJob_t> ninjaJobs;
+    std::set<std::string> commandLines;
+
+    // Indexes of the jobs that write each path, and the number of jobs that write each file.
+    std::map<std::string, std::set<size_t>> writers;
+    std::map<std::string, size_t> fileWriterCounts;
+
+    for (const auto& job : GetRecordedJobs())
+    {
+        // Running the same command twice produces the same result, so drop duplicates.
+        if (!commandLines.insert(job.commandLine).second)
+        {
+            continue;
+        }
+
+        NinjaJob_t ninjaJob;
+        ninjaJob.jobPtr = &job;
+
+        // Depend on the jobs that write anything this job reads or writes, like the scheduler.
+        for (const auto* pathListPtr : { &job.inputs, &job.outputs })
+        {
+            for (const auto& path : *pathListPtr)
+            {
+                auto i = writers.find(path);
+
+                if (i != writers.end())
+                {
+                    ninjaJob.orderOnlyJobs.insert(i->second.begin(), i->second.end());
+                }
+            }
+        }
+
+        size_t index = ninjaJobs.size();
+
+        for (const auto& path : job.outputs)
+        {
+            writers[path].insert(index);
+
+            if (!IsDir(path))
+            {
+                fileWriterCounts[path]++;
+            }
+        }
+
+        ninjaJobs.push_back(ninjaJob);
+    }
+
+    // Now that we know which files are written by more than one job, decide on the inputs and
+    // outputs.
+    for (size_t i = 0; i < ninjaJobs.size(); i++)
+    {
+        auto& ninjaJob = ninjaJobs[i];
+
+        for (const auto& path : ninjaJob.jobPtr->inputs)
+        {
+            auto countIter = fileWriterCounts.find(path);
+
+            if ((countIter != fileWriterCounts.end()) && (countIter->second > 1))
+            {
+                // No build statement produces this file, so depend on the earlier jobs that write
+                // it instead.  (Later ones are run after this job, like in the scheduler.)
+                for (auto index : writers[path])
+                {
+                    if (index < i)
+                    {
+                        ninjaJob.implicitJobs.insert(index);
+                    }
+                }
+            }
+            else if (!IsDir(path))
+            {
+                ninjaJob.inputs.push_back(path);
+            }
+        }
+
+        for (const auto& path : ninjaJob.jobPtr->outputs)
+        {
+            auto countIter = fileWriterCounts.find(path);
+
+            if ((countIter != fileWriterCounts.end()) && (countIter->second == 1))
+            {
+                ninjaJob.outputs.push_back(path);
+            }
+        }
+
+        if (ninjaJob.outputs.empty())
+        {
+            std::stringstream stampPath;
+            stampPath << legato::CombinePath(GeneratorDir, "stamps") << "/job" << i << ".stamp";
+
+            ninjaJob.stampPath = stampPath.str();
+            ninjaJob.outputs.push_back(ninjaJob.stampPath);
+        }
+    }
+
+    return ninjaJobs;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write the Ninja build file.
+ *
+ * @throw   legato::Exception on failure.
+ */
+//--------------------------------------------------------------------------------------------------
+static void WriteNinjaFile
+(
+    const std::vector<NinjaJob_t>& ninjaJobs,
+    const std::string& regenCommandLine
+)
+//--------------------------------------------------------------------------------------------------
+{
+    std::ofstream file(BuildFilePath, std::ofstream::trunc);
+
+    if (!file.is_open())
+    {
+        throw legato::Exception("Failed to open '" + BuildFilePath + "' for writing.");
+    }
+
+    file << "# Build file generated by mk.  Do not edit.  Use 'ninja -f " << BuildFilePath
+         << "' from the directory mk was run in." << std::endl
+         << std::endl
+         << "ninja_required_version = 1.3" << std::endl
+         << std::endl
+         << "rule cc" << std::endl
+         << "  command = $cmd" << std::endl
+         << "  depfile = $depfile" << std::endl
+         << "  deps = gcc" << std::endl
+         << "  description = Compiling $out" << std::endl
+         << std::endl
+         << "rule mkif" << std::endl
+         << "  command = $cmd" << std::endl
+         << "  restat = 1" << std::endl
+         << "  description = Generating $out" << std::endl
+         << std::endl
+         << "rule run" << std::endl
+         << "  command = $cmd" << std::endl
+         << "  description = Building $out" << std::endl
+         << std::endl
+         << "rule regen" << std::endl
+         << "  command = $cmd" << std::endl
+         << "  generator = 1" << std::endl
+         << "  description = Regenerating $out" << std::endl
+         << std::endl;
+
+    // Re-run mk whenever any of the files it parsed change.
+    file << "build " << NinjaPath(BuildFilePath) << ": regen";
+    for (const auto& path : legato::parser::GetParsedFiles())
+    {
+        file << " " << NinjaPath(path);
+    }
+    file << std::endl
+         << "  cmd = " << NinjaValue(regenCommandLine) << std::endl
+         << std::endl;
+
+    for (const auto& ninjaJob : ninjaJobs)
+    {
+        const JobInfo_t& job = *ninjaJob.jobPtr;
+
+        std::string rule = "run";
+        if (!job.depFilePath.empty())
+        {
+            rule = "cc";
+        }
+        else if (job.commandLine.compare(0, 5, "mkif ") == 0)
+        {
+            rule = "mkif";
+        }
+
+        file << "build";
+        for (const auto& path : ninjaJob.outputs)
+        {
+            file << " " << NinjaPath(path);
+        }
+        file << ": " << rule;
+        for (const auto& path : ninjaJob.inputs)
+        {
+            file << " " << NinjaPath(path);
+        }
+
+        // Outputs of the jobs that write files this job reads, where those files can't be named.
+        std::set<std::string> listedInputs(ninjaJob.inputs.begin(), ninjaJob.inputs.end());
+        std::list<std::string> implicitPaths;
+        for (auto index : ninjaJob.implicitJobs)
+        {
+            for (const auto& path : ninjaJobs[index].outputs)
+            {
+                if (listedInputs.insert(path).second)
+                {
+                    implicitPaths.push_back(path);
+                }
+            }
+        }
+        if (!implicitPaths.empty())
+        {
+            file << " |";
+            for (const auto& path : implicitPaths)
+            {
+                file << " " << NinjaPath(path);
+            }
+        }
+
+        // Jobs that must run first, but whose outputs aren't already inputs.
+        std::list<std::string> orderOnlyPaths;
+        for (auto index : ninjaJob.orderOnlyJobs)
+        {
+            for (const auto& path : ninjaJobs[index].outputs)
+            {
+                if (listedInputs.count(path) == 0)
+                {
+                    orderOnlyPaths.push_back(path);
+                }
+            }
+        }
+        if (!orderOnlyPaths.empty())
+        {
+            file << " ||";
+            for (const auto& path : orderOnlyPaths)
+            {
+                file << " " << NinjaPath(path);
+            }
+        }
+        file << std::endl;
+
+        std::string commandLine = job.commandLine;
+        if (!ninjaJob.stampPath.empty())
+        {
+            commandLine = "(" + commandLine + ") && touch \"" + ninjaJob.stampPath + "\"";
+        }
+        file << "  cmd = " << NinjaValue(commandLine) << std::endl;
+
+        if (!job.depFilePath.empty())
+        {
+            file << "  depfile = " << NinjaValue(job.depFilePath) << std::endl;
+        }
+
+        file << std::endl;
+    }
+
+    if (!file.flush())
+    {
+        throw legato::Exception("Failed to write to '" + BuildFilePath + "'.");
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write a compile_commands.json file listing all the compiles.
+ *
+ * @throw   legato::Exception on failure.
+ */
+//--------------------------------------------------------------------------------------------------
+static void WriteCompileCommands
+(
+    const std::vector<NinjaJob_t>& ninjaJobs
+)
+//--------------------------------------------------------------------------------------------------
+{
+    std::string filePath = legato::CombinePath(GeneratorDir, "compile_commands.json");
+    std::ofstream file(filePath, std::ofstream::trunc);
+
+    if (!file.is_open())
+    {
+        throw legato::Exception("Failed to open '" + filePath + "' for writing.");
+    }
+
+    std::string workingDir = JsonString(legato::GetWorkingDir());
+    bool isFirst = true;
+
+    file << "[";
+
+    for (const auto& ninjaJob : ninjaJobs)
+    {
+        const JobInfo_t& job = *ninjaJob.jobPtr;
+
+        // Compiles are the jobs with dependency files.  The source file is their first input.
+        if (job.depFilePath.empty() || job.inputs.empty())
+        {
+            continue;
+        }
+
+        file << (isFirst ? "" : ",") << std::endl
+             << "  {" << std::endl
+             << "    \"directory\": \"" << workingDir << "\"," << std::endl
+             << "    \"command\": \"" << JsonString(job.commandLine) << "\"," << std::endl
+             << "    \"file\": \"" << JsonString(job.inputs.front()) << "\"" << std::endl
+             << "  }";
+
+        isFirst = false;
+    }
+
+    file << std::endl << "]" << std::endl;
+
+    if (!file.flush())
+    {
+        throw legato::Exception("Failed to write to '" + filePath + "'.");
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Select a build file generator.  Must be called before any build steps are started.
+ *
+ * @throw   legato::Exception if the generator name is not recognized.
+ */
+//--------------------------------------------------------------------------------------------------
+void SetBuildFileGenerator
+(
+    const std::string& generatorName,   ///< Name of the generator (e.g., "ninja").
+    const std::string& workingDir       ///< Directory where the build file should be put.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (generatorName != "ninja")
+    {
+        throw legato::Exception("Unknown build file generator '" + generatorName
+                                + "' (only 'ninja' is supported).");
+    }
+
+    GeneratorDir = workingDir;
+    BuildFilePath = legato::CombinePath(workingDir, "build.ninja");
+
+    RecordJobsOnly();
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write the build file from the build steps that have been recorded.  Does nothing if no
+ * generator has been selected.
+ *
+ * @throw   legato::Exception on failure.
+ */
+//--------------------------------------------------------------------------------------------------
+void GenerateBuildFile
+(
+    int argc,           ///< Number of command-line arguments the mk tool was run with.
+    const char** argv   ///< Command-line arguments (used to re-run the mk tool).
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (BuildFilePath.empty())
+    {
+        return;
+    }
+
+    std::string regenCommandLine;
+    for (int i = 0; i < argc; i++)
+    {
+        regenCommandLine += (i == 0 ? "" : " ") + ShellQuote(argv[i]);
+    }
+
+    legato::MakeDir(legato::CombinePath(GeneratorDir, "stamps"));
+
+    std::vector<NinjaJob_t> ninjaJobs = GetNinjaJobs();
+
+    WriteNinjaFile(ninjaJobs, regenCommandLine);
+    WriteCompileCommands(ninjaJobs);
+
+    std::cout << "Generated '" << BuildFilePath << "'.  Run 'ninja -f " << BuildFilePath
+              << "' to build." << std::endl;
+}
+
+
+}  // namespace mk
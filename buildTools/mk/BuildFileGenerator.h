@@ -0,0 +1,53 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * Generation of build files for other build tools (currently only Ninja) from the build steps
+ * that the mk tools would otherwise run themselves.
+ *
+ * When a generator is selected, the build steps are recorded instead of being run (see
+ * mk::RecordJobsOnly()).  Once the mk tool has finished, a build file is written that contains
+ * those steps, with dependencies worked out from their inputs and outputs, plus a rule that
+ * re-runs the mk tool when any of the definition (.sdef, .adef, .cdef) or .api files change.
+ * A compile_commands.json file is written alongside it for use by editors and code analysis tools.
+ *
+ * Copyright (C) 2014, Sierra Wireless Inc.  Use of this work is subject to license.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#ifndef BUILD_FILE_GENERATOR_INCLUDE_GUARD_H
+#define BUILD_FILE_GENERATOR_INCLUDE_GUARD_H
+
+namespace mk
+{
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Select a build file generator.  Must be called before any build steps are started.
+ *
+ * @throw   legato::Exception if the generator name is not recognized.
+ */
+//--------------------------------------------------------------------------------------------------
+void SetBuildFileGenerator
+(
+    const std::string& generatorName,   ///< Name of the generator (e.g., "ninja").
+    const std::string& workingDir       ///< Directory where the build file should be put.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write the build file from the build steps that have been recorded.  Does nothing if no
+ * generator has been selected.
+ *
+ * @throw   legato::Exception on failure.
+ */
+//--------------------------------------------------------------------------------------------------
+void GenerateBuildFile
+(
+    int argc,           ///< Number of command-line arguments the mk tool was run with.
+    const char** argv   ///< Command-line arguments (used to re-run the mk tool).
+);
+
+
+}
+
+#endif // BUILD_FILE_GENERATOR_INCLUDE_GUARD_H
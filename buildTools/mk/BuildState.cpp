@@ -0,0 +1,680 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * Implementation of the build state database used by the mk tools to skip build steps that are
+ * already up to date.
+ *
+ * The database file is a text file with one record per line:
+ *
+ * @verbatim
+   F <content hash> <size> <modification time (ns)> <path>
+   S <command-line hash> <input signature>
+   @endverbatim
+ *
+ * Hashes are 64-bit FNV-1a, written in hex.
+ *
+ * Copyright (C) 2014, Sierra Wireless Inc.  Use of this work is subject to license.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include <stdint.h>
+#include "LegatoObjectModel.h"
+#include "BuildState.h"
+#include "Parser.h"
+
+extern "C" {
+    #include <sys/stat.h>
+    #include <dirent.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <stdio.h>
+    #include <time.h>
+}
+
+
+namespace mk
+{
+
+/// Name of the database file, in the working directory.
+static const char StateFileName[] = "mk.state";
+
+/// Name of the parser's definition file cache, in the working directory.
+static const char DefinitionCacheFileName[] = "mk.defs";
+
+/// First line of the database file.  Files that don't start with this are ignored.
+static const char StateFileHeader[] = "# mk build state 1";
+
+/// Path of the database file ("" = LoadBuildState() hasn't been called).
+static std::string StateFilePath;
+
+/// true = treat everything as out of date.
+static bool IsForced = false;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * What we know about the contents of a file.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint64_t hash;          ///< Content hash.
+    off_t size;             ///< Size of the file when the hash was computed.
+    int64_t modTime;        ///< Modification time (ns) of the file when the hash was computed.
+}
+FileInfo_t;
+
+
+/// Content hashes of files, by path.
+static std::map<std::string, FileInfo_t> Files;
+
+/// Input signatures of build steps that have been done, by command-line hash.
+static std::map<uint64_t, uint64_t> Steps;
+
+
+/// 64-bit FNV-1a hash parameters.
+static const uint64_t FnvOffsetBasis = 0xcbf29ce484222325ULL;
+static const uint64_t FnvPrime = 0x100000001b3ULL;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add some bytes to a running FNV-1a hash.
+ *
+ * @return The new hash value.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint64_t HashBytes
+(
+    uint64_t hash,
+    const void* bytesPtr,
+    size_t numBytes
+)
+//--------------------------------------------------------------------------------------------------
+{
+    const uint8_t* bytePtr = static_cast<const uint8_t*>(bytesPtr);
+
+    for (size_t i = 0; i < numBytes; i++)
+    {
+        hash ^= bytePtr[i];
+        hash *= FnvPrime;
+    }
+
+    return hash;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add a string (including its terminating null) to a running FNV-1a hash.
+ *
+ * @return The new hash value.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint64_t HashString
+(
+    uint64_t hash,
+    const std::string& string
+)
+//--------------------------------------------------------------------------------------------------
+{
+    return HashBytes(hash, string.c_str(), string.length() + 1);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the content hash of a regular file, re-using the hash computed earlier if the file's size
+ * and modification time haven't changed since then.
+ *
+ * @return true if successful, false if the path isn't a regular file or can't be read.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool GetFileHash
+(
+    const std::string& path,
+    uint64_t& hash              ///< [OUT] Content hash.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    struct stat fileStat;
+
+    if ((stat(path.c_str(), &fileStat) != 0) || !S_ISREG(fileStat.st_mode))
+    {
+        return false;
+    }
+
+    int64_t modTime = (int64_t)fileStat.st_mtim.tv_sec * 1000000000 + fileStat.st_mtim.tv_nsec;
+
+    auto i = Files.find(path);
+
+    if (   (i != Files.end())
+        && (i->second.size == fileStat.st_size)
+        && (i->second.modTime == modTime) )
+    {
+        hash = i->second.hash;
+        return true;
+    }
+
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    uint64_t newHash = FnvOffsetBasis;
+    char buffer[16 * 1024];
+    ssize_t bytesRead;
+
+    while ((bytesRead = read(fd, buffer, sizeof(buffer))) > 0)
+    {
+        newHash = HashBytes(newHash, buffer, bytesRead);
+    }
+
+    close(fd);
+
+    if (bytesRead < 0)
+    {
+        return false;
+    }
+
+    FileInfo_t& info = Files[path];
+    info.hash = newHash;
+    info.size = fileStat.st_size;
+    info.modTime = modTime;
+
+    hash = newHash;
+    return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read a make-style dependency file generated by the compiler (-MMD) and add to a list all
+ * the files that the target depends on.
+ *
+ * @return false if the dependency file couldn't be read.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool ReadDepFile
+(
+    const std::string& depFilePath,
+    std::list<std::string>& files   ///< [OUT] Paths are added to this list.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    std::ifstream depFile(depFilePath);
+
+    if (!depFile.is_open())
+    {
+        return false;
+    }
+
+    std::string contents((std::istreambuf_iterator<char>(depFile)),
+                         std::istreambuf_iterator<char>());
+
+    // Skip the target, which is everything up to the first ": ".
+    size_t pos = contents.find(": ");
+    if (pos == std::string::npos)
+    {
+        return false;
+    }
+    pos += 2;
+
+    // The rest is a list of paths separated by white space, with "\<newline>" used to continue
+    // the list onto the next line and "\ " used for spaces inside a path.
+    std::string path;
+
+    for (; pos < contents.length(); pos++)
+    {
+        char c = contents[pos];
+
+        if ((c == '\\') && (pos + 1 < contents.length()))
+        {
+            char next = contents[pos + 1];
+
+            if ((next == ' ') || (next == '#') || (next == '\\'))
+            {
+                path += next;
+                pos++;
+                continue;
+            }
+        }
+
+        if ((c == ' ') || (c == '\t') || (c == '\n') || (c == '\r') || (c == '\\'))
+        {
+            if (!path.empty())
+            {
+                files.push_back(path);
+                path.clear();
+            }
+        }
+        else
+        {
+            path += c;
+        }
+    }
+
+    if (!path.empty())
+    {
+        files.push_back(path);
+    }
+
+    return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add a file's path and content hash to an input signature.
+ */
+//--------------------------------------------------------------------------------------------------
+static void AddToSignature
+(
+    InputSnapshot_t& snapshot,
+    const std::string& path,
+    uint64_t hash
+)
+//--------------------------------------------------------------------------------------------------
+{
+    snapshot.signature = HashString(snapshot.signature, path);
+    snapshot.signature = HashBytes(snapshot.signature, &hash, sizeof(hash));
+    snapshot.fileCount++;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add the files listed in a dependency file to an input signature.
+ *
+ * @return false if the dependency file is missing, a file listed in it is missing, or a file
+ *         listed in it was modified after the snapshot was taken (if checkTime is true).
+ */
+//--------------------------------------------------------------------------------------------------
+static bool AddDepFileToSignature
+(
+    InputSnapshot_t& snapshot,
+    const std::string& depFilePath,
+    bool checkTime
+)
+//--------------------------------------------------------------------------------------------------
+{
+    std::list<std::string> depFiles;
+
+    if (!ReadDepFile(depFilePath, depFiles))
+    {
+        return false;
+    }
+
+    for (const auto& path : depFiles)
+    {
+        uint64_t hash;
+
+        if (!GetFileHash(path, hash))
+        {
+            return false;
+        }
+
+        // GetFileHash() has just recorded the file's current modification time.
+        if (checkTime && (Files[path].modTime > snapshot.startTime))
+        {
+            return false;
+        }
+
+        AddToSignature(snapshot, path, hash);
+    }
+
+    return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Compute the input signature of a build step from the contents of all the files it reads.
+ *
+ * @return true if successful, false if the signature couldn't be computed (e.g., because there
+ *         are no input files, a dependency file is missing, or a file listed in it is missing).
+ */
+//--------------------------------------------------------------------------------------------------
+static bool GetSignature
+(
+    const std::list<std::string>& inputs,
+    const std::string& depFilePath,
+    uint64_t& signature             ///< [OUT]
+)
+//--------------------------------------------------------------------------------------------------
+{
+    InputSnapshot_t snapshot = SnapshotInputs(inputs);
+
+    if (!depFilePath.empty() && !AddDepFileToSignature(snapshot, depFilePath, false))
+    {
+        return false;
+    }
+
+    if (snapshot.fileCount == 0)
+    {
+        return false;
+    }
+
+    signature = snapshot.signature;
+    return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Load the build state database from a given working directory.  Must be called before any
+ * build steps are started, or any definition files are parsed.  Also loads the parser's cache of
+ * parsed definition files from the same directory.
+ */
+//--------------------------------------------------------------------------------------------------
+void LoadBuildState
+(
+    const std::string& workingDir,  ///< Directory where intermediate build output goes.
+    bool isForced                   ///< true = treat everything as out of date.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    StateFilePath = legato::CombinePath(workingDir, StateFileName);
+    IsForced = isForced;
+
+    // Parsed definition files are cached by content, so they can be reused even if forced.
+    legato::parser::LoadDefinitionCache(legato::CombinePath(workingDir, DefinitionCacheFileName));
+
+    std::ifstream stateFile(StateFilePath);
+    std::string line;
+
+    if (!std::getline(stateFile, line) || (line != StateFileHeader))
+    {
+        return;
+    }
+
+    while (std::getline(stateFile, line))
+    {
+        std::istringstream lineStream(line);
+        std::string recordType;
+
+        lineStream >> recordType >> std::hex;
+
+        if (recordType == "F")
+        {
+            FileInfo_t info;
+            std::string path;
+
+            lineStream >> info.hash >> std::dec >> info.size >> info.modTime;
+            lineStream.get();   // Skip the space before the path, which may contain spaces.
+            std::getline(lineStream, path);
+
+            if (lineStream && !path.empty())
+            {
+                Files[path] = info;
+            }
+        }
+        else if (recordType == "S")
+        {
+            uint64_t key;
+            uint64_t signature;
+
+            lineStream >> key >> signature;
+
+            if (lineStream)
+            {
+                Steps[key] = signature;
+            }
+        }
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Save the build state database (and the parser's definition file cache) back to the files they
+ * were loaded from.  Does nothing if LoadBuildState() hasn't been called.
+ *
+ * @throw   legato::Exception on failure.
+ */
+//--------------------------------------------------------------------------------------------------
+void SaveBuildState
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (StateFilePath.empty())
+    {
+        return;
+    }
+
+    legato::MakeDir(legato::GetContainingDir(StateFilePath));
+
+    // Write to a temporary file first, so an interrupted build can't leave a corrupted database.
+    std::string tempFilePath = StateFilePath + ".tmp";
+    {
+        std::ofstream stateFile(tempFilePath, std::ofstream::trunc);
+
+        if (!stateFile.is_open())
+        {
+            throw legato::Exception("Failed to open '" + tempFilePath + "' for writing.");
+        }
+
+        stateFile << StateFileHeader << '\n';
+
+        for (const auto& mapEntry : Files)
+        {
+            const FileInfo_t& info = mapEntry.second;
+
+            stateFile << "F " << std::hex << info.hash << std::dec
+                      << ' ' << info.size << ' ' << info.modTime << ' ' << mapEntry.first << '\n';
+        }
+
+        stateFile << std::hex;
+
+        for (const auto& mapEntry : Steps)
+        {
+            stateFile << "S " << mapEntry.first << ' ' << mapEntry.second << '\n';
+        }
+
+        if (!stateFile.flush())
+        {
+            throw legato::Exception("Failed to write to '" + tempFilePath + "'.");
+        }
+    }
+
+    if (rename(tempFilePath.c_str(), StateFilePath.c_str()) != 0)
+    {
+        throw legato::Exception("Failed to rename '" + tempFilePath + "' to '" + StateFilePath
+                                + "'.");
+    }
+
+    legato::parser::SaveDefinitionCache();
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check whether a build step is up to date.
+ *
+ * Paths in the inputs list that are directories (or don't exist) are ignored.  A step that has no
+ * input files at all is never up to date.
+ *
+ * @return true if the step doesn't need to be done.
+ */
+//--------------------------------------------------------------------------------------------------
+bool IsUpToDate
+(
+    const std::string& commandLine,         ///< Command-line (or other unique key) of the step.
+    const std::list<std::string>& inputs,   ///< Paths of files read by the step.
+    const std::list<std::string>& outputs,  ///< Paths of files written by the step.
+    const std::string& depFilePath          ///< Dependency file written by the step (or "").
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (StateFilePath.empty() || IsForced)
+    {
+        return false;
+    }
+
+    auto i = Steps.find(HashString(FnvOffsetBasis, commandLine));
+
+    if (i == Steps.end())
+    {
+        return false;
+    }
+
+    for (const auto& path : outputs)
+    {
+        struct stat pathStat;
+
+        if (stat(path.c_str(), &pathStat) != 0)
+        {
+            return false;
+        }
+    }
+
+    uint64_t signature;
+
+    return (GetSignature(inputs, depFilePath, signature) && (signature == i->second));
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Take a snapshot of the input files of a build step that is about to be started.  If an input
+ * changes while the step runs, the step's output is based on the old contents, so the step is
+ * recorded with those (and is done again by the next build).
+ *
+ * Paths in the inputs list that are directories (or don't exist) are ignored.
+ */
+//--------------------------------------------------------------------------------------------------
+InputSnapshot_t SnapshotInputs
+(
+    const std::list<std::string>& inputs    ///< Paths of files read by the step.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    InputSnapshot_t snapshot = { FnvOffsetBasis, 0, 0 };
+    struct timespec now;
+
+    // File modification times can lag this clock by up to a clock tick, so a file modified just
+    // after this might not be noticed, but one modified before it never looks newer.
+    clock_gettime(CLOCK_REALTIME, &now);
+    snapshot.startTime = (int64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+
+    for (const auto& path : inputs)
+    {
+        uint64_t hash;
+
+        // Directories are only used for ordering build steps, so they don't count.
+        if (GetFileHash(path, hash))
+        {
+            AddToSignature(snapshot, path, hash);
+        }
+    }
+
+    return snapshot;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Record that a build step has been done successfully, with the inputs it was started with.
+ *
+ * The files listed in the step's dependency file can only be hashed now.  If any of them was
+ * modified after the step was started, the step isn't recorded (so it is done again next time).
+ */
+//--------------------------------------------------------------------------------------------------
+void MarkUpToDate
+(
+    const std::string& commandLine,         ///< Command-line (or other unique key) of the step.
+    const InputSnapshot_t& snapshot,        ///< Inputs, from when the step was started.
+    const std::string& depFilePath          ///< Dependency file written by the step (or "").
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (StateFilePath.empty())
+    {
+        return;
+    }
+
+    uint64_t key = HashString(FnvOffsetBasis, commandLine);
+    InputSnapshot_t result = snapshot;
+
+    if (   (depFilePath.empty() || AddDepFileToSignature(result, depFilePath, true))
+        && (result.fileCount > 0) )
+    {
+        Steps[key] = result.signature;
+    }
+    else
+    {
+        Steps.erase(key);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add the paths of all the files in a directory and its sub-directories to a set.
+ */
+//--------------------------------------------------------------------------------------------------
+static void AddFilesInDir
+(
+    std::set<std::string>& files,
+    const std::string& dirPath
+)
+//--------------------------------------------------------------------------------------------------
+{
+    DIR* dirPtr = opendir(dirPath.c_str());
+
+    if (dirPtr == NULL)
+    {
+        return;
+    }
+
+    struct dirent* entryPtr;
+
+    while ((entryPtr = readdir(dirPtr)) != NULL)
+    {
+        std::string name = entryPtr->d_name;
+
+        if ((name == ".") || (name == ".."))
+        {
+            continue;
+        }
+
+        std::string path = legato::CombinePath(dirPath, name);
+        struct stat pathStat;
+
+        if ((lstat(path.c_str(), &pathStat) == 0) && S_ISDIR(pathStat.st_mode))
+        {
+            AddFilesInDir(files, path);
+        }
+        else
+        {
+            files.insert(path);
+        }
+    }
+
+    closedir(dirPtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the paths of all the files in a directory and its sub-directories, in sorted order.
+ */
+//--------------------------------------------------------------------------------------------------
+std::list<std::string> GetFilesInDir
+(
+    const std::string& dirPath
+)
+//--------------------------------------------------------------------------------------------------
+{
+    std::set<std::string> files;
+
+    AddFilesInDir(files, dirPath);
+
+    return std::list<std::string>(files.begin(), files.end());
+}
+
+
+}  // namespace mk
@@ -0,0 +1,128 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * Build state database used by the mk tools to skip build steps that are already up to date.
+ *
+ * For each build step that has been done, the database records a hash of the step's
+ * command-line and a signature made from the content hashes of all the files the step read
+ * (including the headers listed in compiler-generated dependency files).  A step is up to date
+ * if its command-line is unchanged, none of those files have changed and all its outputs exist.
+ *
+ * To avoid reading every file on every build, the content hash of each file is remembered along
+ * with its size and modification time, and only re-computed if either of those changes.
+ *
+ * The database is kept in a file in the working (object file) directory.
+ *
+ * Copyright (C) 2014, Sierra Wireless Inc.  Use of this work is subject to license.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#ifndef BUILD_STATE_INCLUDE_GUARD_H
+#define BUILD_STATE_INCLUDE_GUARD_H
+
+namespace mk
+{
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Load the build state database from a given working directory.  Must be called before any
+ * build steps are started, or any definition files are parsed.  Also loads the parser's cache of
+ * parsed definition files from the same directory.
+ */
+//--------------------------------------------------------------------------------------------------
+void LoadBuildState
+(
+    const std::string& workingDir,  ///< Directory where intermediate build output goes.
+    bool isForced                   ///< true = treat everything as out of date.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Save the build state database (and the parser's definition file cache) back to the files they
+ * were loaded from.  Does nothing if LoadBuildState() hasn't been called.
+ */
+//--------------------------------------------------------------------------------------------------
+void SaveBuildState
+(
+    void
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check whether a build step is up to date.
+ *
+ * Paths in the inputs list that are directories (or don't exist) are ignored.  A step that has no
+ * input files at all is never up to date.
+ *
+ * @return true if the step doesn't need to be done.
+ */
+//--------------------------------------------------------------------------------------------------
+bool IsUpToDate
+(
+    const std::string& commandLine,         ///< Command-line (or other unique key) of the step.
+    const std::list<std::string>& inputs,   ///< Paths of files read by the step.
+    const std::list<std::string>& outputs,  ///< Paths of files written by the step.
+    const std::string& depFilePath = ""     ///< Dependency file written by the step (or "").
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Contents of the input files of a build step, as they were when the step was started.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint64_t signature;     ///< Signature made from the content hashes of the input files.
+    size_t fileCount;       ///< Number of input files in the signature.
+    int64_t startTime;      ///< When the snapshot was taken (ns, same clock as file mod times).
+}
+InputSnapshot_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Take a snapshot of the input files of a build step that is about to be started.  If an input
+ * changes while the step runs, the step's output is based on the old contents, so the step is
+ * recorded with those (and is done again by the next build).
+ *
+ * Paths in the inputs list that are directories (or don't exist) are ignored.
+ */
+//--------------------------------------------------------------------------------------------------
+InputSnapshot_t SnapshotInputs
+(
+    const std::list<std::string>& inputs    ///< Paths of files read by the step.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Record that a build step has been done successfully, with the inputs it was started with.
+ *
+ * The files listed in the step's dependency file can only be hashed now.  If any of them was
+ * modified after the step was started, the step isn't recorded (so it is done again next time).
+ */
+//--------------------------------------------------------------------------------------------------
+void MarkUpToDate
+(
+    const std::string& commandLine,         ///< Command-line (or other unique key) of the step.
+    const InputSnapshot_t& snapshot,        ///< Inputs, from when the step was started.
+    const std::string& depFilePath = ""     ///< Dependency file written by the step (or "").
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the paths of all the files in a directory and its sub-directories, in sorted order.
+ */
+//--------------------------------------------------------------------------------------------------
+std::list<std::string> GetFilesInDir
+(
+    const std::string& dirPath
+);
+
+
+}
+
+#endif // BUILD_STATE_INCLUDE_GUARD_H
@@ -10,6 +10,65 @@
 #include "ComponentBuilder.h"
 #include "InterfaceBuilder.h"
 #include "Utilities.h"
+#include "JobScheduler.h"
+#include "Profiler.h"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the paths of the compile job's inputs: the source file and all the directories on the
+ * include search path.  This makes the compile wait for any jobs generating headers into those
+ * directories.
+ */
+//--------------------------------------------------------------------------------------------------
+static std::list<std::string> GetCompileInputs
+(
+    const legato::Component& component,
+    const std::string& sourcePath,
+    const legato::BuildParams_t& buildParams
+)
+//--------------------------------------------------------------------------------------------------
+{
+    std::list<std::string> inputs = { sourcePath };
+
+    for (const auto& dir : buildParams.InterfaceDirs())
+    {
+        inputs.push_back(dir);
+    }
+    for (const auto& dir : component.IncludePath())
+    {
+        inputs.push_back(dir);
+    }
+
+    return inputs;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Adds to a list the paths of the libraries built for all of a component's sub-components
+ * (and their sub-components, etc.).
+ */
+//--------------------------------------------------------------------------------------------------
+static void GetSubComponentLibs
+(
+    std::list<std::string>& libs,
+    const legato::Component& component
+)
+//--------------------------------------------------------------------------------------------------
+{
+    for (const auto& mapEntry : component.SubComponents())
+    {
+        auto componentPtr = mapEntry.second;
+
+        if (componentPtr->Lib().Exists())
+        {
+            libs.push_back(componentPtr->Lib().BuildOutputPath());
+        }
+
+        GetSubComponentLibs(libs, *componentPtr);
+    }
+}
 
 
 //--------------------------------------------------------------------------------------------------
@@ -217,7 +276,7 @@ void ComponentBuilder_t::Bundle
             Bundle(*(mapEntry.second));
         }
     }
-    catch (legato::DependencyException e)
+    catch (legato::DependencyException& e)
     {
         throw legato::DependencyException(e.what() + std::string(" required by ")
                                           + component.Name());
@@ -274,6 +333,8 @@ void ComponentBuilder_t::Build
     }
     else
     {
+        mk::ProfilePhase_t phase("component", component.Name());
+
         // Print progress message.
         if (m_Params.IsVerbose())
         {
@@ -296,6 +357,16 @@ void ComponentBuilder_t::Build
                           << std::endl;
             }
         }
+        else if (m_Params.DoStaticLink())
+        {
+            // The object files will be linked straight into the executables that use the
+            // component, instead of into a library.
+            if (m_Params.IsVerbose())
+            {
+                std::cout << "Component '" << component.Name() << "' will be linked statically."
+                          << std::endl;
+            }
+        }
         else
         {
             // Create the library from the compiled object files.
@@ -323,8 +394,6 @@ void ComponentBuilder_t::CompileCSourceFile
 )
 //--------------------------------------------------------------------------------------------------
 {
-    // TODO: Check file timestamps to see if compiling is actually needed.
-
     // Start the command line with the path to the appropriate compiler executable.
     std::stringstream commandLine;
     std::string compilerPath = mk::GetCompilerPath(m_Params.Target(), legato::LANG_C);
@@ -345,23 +414,26 @@ void ComponentBuilder_t::CompileCSourceFile
     // Compile to position-independent code so it can be linked into a shared library.
     commandLine << " -fPIC";
 
+    // Add the flags for the optimization goal (if any).
+    mk::GetOptimizationCompileFlags(commandLine, compilerPath, m_Params);
+
     // Specify the source code file to be compiled.
-    commandLine << " -c \"" ;
+    std::string sourcePath = sourceFile;
     if ((component.Path() != "") && (!legato::IsAbsolutePath(sourceFile)))
     {
-        commandLine << legato::CombinePath(component.Path(), sourceFile);
-    }
-    else
-    {
-        commandLine << sourceFile;
+        sourcePath = legato::CombinePath(component.Path(), sourceFile);
     }
-    commandLine << "\"";
+    commandLine << " -c \"" << sourcePath << "\"";
 
     // Specify the output (.o) file path.
     std::string objectFile = legato::CombinePath(outputDir, legato::GetLastPathNode(sourceFile))
                            + ".o";
     commandLine << " -o \"" << objectFile << "\"";
 
+    // Have the compiler list the header files it reads, so we can tell when it needs to be re-run.
+    std::string depFile = objectFile + ".d";
+    commandLine << " -MMD -MF \"" << depFile << "\"";
+
     // Add the object file to the Component's list.
     component.ObjectFiles().push_back(objectFile);
 
@@ -396,7 +468,10 @@ void ComponentBuilder_t::CompileCSourceFile
         std::cout << std::endl << "$ " << commandLine.str() << std::endl << std::endl;
     }
 
-    mk::ExecuteCommandLine(commandLine);
+    mk::StartJob(commandLine,
+                 GetCompileInputs(component, sourcePath, m_Params),
+                 { objectFile },
+                 depFile);
 }
 
 
@@ -416,8 +491,6 @@ void ComponentBuilder_t::CompileCxxSourceFile
 )
 //--------------------------------------------------------------------------------------------------
 {
-    // TODO: Check file timestamps to see if compiling is actually needed.
-
     // Start the command line with the path to the appropriate compiler executable.
     std::stringstream commandLine;
     std::string compilerPath = mk::GetCompilerPath(m_Params.Target(), legato::LANG_CXX);
@@ -438,23 +511,26 @@ void ComponentBuilder_t::CompileCxxSourceFile
     // Compile to position-independent code so it can be linked into a shared library.
     commandLine << " -fPIC";
 
+    // Add the flags for the optimization goal (if any).
+    mk::GetOptimizationCompileFlags(commandLine, compilerPath, m_Params);
+
     // Specify the source code file to be compiled.
-    commandLine << " -c \"" ;
+    std::string sourcePath = sourceFile;
     if ((component.Path() != "") && (!legato::IsAbsolutePath(sourceFile)))
     {
-        commandLine << legato::CombinePath(component.Path(), sourceFile);
+        sourcePath = legato::CombinePath(component.Path(), sourceFile);
     }
-    else
-    {
-        commandLine << sourceFile;
-    }
-    commandLine << "\"";
+    commandLine << " -c \"" << sourcePath << "\"";
 
     // Specify the output (.o) file path.
     std::string objectFile = legato::CombinePath(outputDir, legato::GetLastPathNode(sourceFile))
                            + ".o";
     commandLine << " -o \"" << objectFile << "\"";
 
+    // Have the compiler list the header files it reads, so we can tell when it needs to be re-run.
+    std::string depFile = objectFile + ".d";
+    commandLine << " -MMD -MF \"" << depFile << "\"";
+
     // Add the object file to the Component's list.
     component.ObjectFiles().push_back(objectFile);
 
@@ -489,7 +565,10 @@ void ComponentBuilder_t::CompileCxxSourceFile
         std::cout << std::endl << "$ " << commandLine.str() << std::endl << std::endl;
     }
 
-    mk::ExecuteCommandLine(commandLine);
+    mk::StartJob(commandLine,
+                 GetCompileInputs(component, sourcePath, m_Params),
+                 { objectFile },
+                 depFile);
 }
 
 
@@ -551,8 +630,6 @@ void ComponentBuilder_t::LinkSharedLib
 )
 //--------------------------------------------------------------------------------------------------
 {
-    // TODO: Check file timestamps to see if linking is actually needed.
-
     // Determine which programming language toolchain to use.
     legato::ProgrammingLanguage_t language = legato::LANG_C;
     if (component.HasCxxSources())
@@ -562,7 +639,8 @@ void ComponentBuilder_t::LinkSharedLib
 
     // Start constructing the command-line.
     std::stringstream commandLine;
-    commandLine << mk::GetCompilerPath(m_Params.Target(), language)
+    std::string compilerPath = mk::GetCompilerPath(m_Params.Target(), language);
+    commandLine << compilerPath
                 << " -shared"
                 << " -o \"" << component.Lib().BuildOutputPath() << "\"";
 
@@ -578,6 +656,9 @@ void ComponentBuilder_t::LinkSharedLib
         commandLine << " " << arg;
     }
 
+    // Add the flags for the optimization goal (if any).
+    mk::GetOptimizationLinkFlags(commandLine, compilerPath, m_Params);
+
     // On the localhost, set the DT_RUNPATH variable inside the library to include the
     // expected locations of the sub-libraries needed.
     if (m_Params.Target() == "localhost")
@@ -616,7 +697,14 @@ void ComponentBuilder_t::LinkSharedLib
         std::cout << std::endl << "$ " << commandLine.str() << std::endl << std::endl;
     }
 
-    mk::ExecuteCommandLine(commandLine);
+    // The link has to wait for the object files and the sub-component libraries, and has to be
+    // redone if a prebuilt library or the runtime library changes.
+    std::list<std::string> inputs = component.ObjectFiles();
+    GetSubComponentLibs(inputs, component);
+    mk::GetComponentBundledLibs(inputs, component);
+    inputs.push_back(mk::GetLegatoLibPath());
+
+    mk::StartJob(commandLine, inputs, { component.Lib().BuildOutputPath() });
 }
 
 
@@ -631,14 +719,13 @@ void ComponentBuilder_t::LinkStaticLib
 )
 //--------------------------------------------------------------------------------------------------
 {
-    // TODO: Check file timestamps to see if linking is actually needed.
-
-    // Remove the old version of the library to be safe.
-    legato::CleanFile(component.Lib().BuildOutputPath());
-
-    // Construct the link command line, beginning with the appropriate archiver, based on the
-    // target platform that we are building for.
+    // Construct the link command line.  Start by removing the old version of the library to be
+    // safe (this is done by the job, so it isn't removed if the library is up to date).
     std::stringstream commandLine;
+    commandLine << "rm -f \"" << component.Lib().BuildOutputPath() << "\" && ";
+
+    // Continue with the appropriate archiver, based on the target platform that we are building
+    // for.
     commandLine << mk::GetArchiverPath(m_Params.Target());
 
     // Add the archiver command flags and the path to the library file to construct.
@@ -655,5 +742,7 @@ void ComponentBuilder_t::LinkStaticLib
         std::cout << std::endl << "$ " << commandLine.str() << std::endl << std::endl;
     }
 
-    mk::ExecuteCommandLine(commandLine);
+    std::list<std::string> inputs = component.ObjectFiles();
+
+    mk::StartJob(commandLine, inputs, { component.Lib().BuildOutputPath() });
 }
@@ -11,6 +11,8 @@
 #include "ComponentBuilder.h"
 #include "ComponentInstanceBuilder.h"
 #include "Utilities.h"
+#include "JobScheduler.h"
+#include "Profiler.h"
 
 //--------------------------------------------------------------------------------------------------
 /**
@@ -338,7 +340,8 @@ void ExecutableBuilder_t::GenerateMain
 static void LinkComponent
 (
     legato::Component& component,
-    std::stringstream& commandLine
+    std::stringstream& commandLine,
+    std::list<std::string>& libs    ///< Paths of the libraries linked are added to this list.
 )
 //--------------------------------------------------------------------------------------------------
 {
@@ -347,6 +350,7 @@ static void LinkComponent
     {
         // Link the component.
         commandLine << " -l" << component.Lib().ShortName();
+        libs.push_back(component.Lib().BuildOutputPath());
     }
 
     // Link all the sub-components it depends on.
@@ -360,7 +364,56 @@ static void LinkComponent
                                     " of component '" + component.Name() + "'.");
         }
 
-        LinkComponent(*componentPtr, commandLine);
+        LinkComponent(*componentPtr, commandLine, libs);
+    }
+}
+
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add to the build command-line the object files (and linker flags) of a given component and all
+ * the components it is directly or indirectly dependent on, for linking them statically.
+ *
+ * Sub-components come before the components that depend on them, the same as the order their
+ * component initializers are called in, so that any static constructors run in that order too.
+ */
+//--------------------------------------------------------------------------------------------------
+static void LinkComponentObjects
+(
+    const legato::Component& component,
+    std::set<const legato::Component*>& linkedSet,  ///< Components already linked.
+    std::stringstream& commandLine,
+    std::list<std::string>& inputs  ///< Paths of the object files linked are added to this list.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    // A component used by more than one component instance must only be linked once.
+    if (!linkedSet.insert(&component).second)
+    {
+        return;
+    }
+
+    for (const auto& mapEntry : component.SubComponents())
+    {
+        if (mapEntry.second == NULL)
+        {
+            throw legato::Exception("Unresolved sub-component '" + mapEntry.first + "'"
+                                    " of component '" + component.Name() + "'.");
+        }
+
+        LinkComponentObjects(*mapEntry.second, linkedSet, commandLine, inputs);
+    }
+
+    for (const auto& objectFile : component.ObjectFiles())
+    {
+        commandLine << " \"" << objectFile << "\"";
+        inputs.push_back(objectFile);
+    }
+
+    for (const auto& arg : component.LdFlags())
+    {
+        commandLine << " " << arg;
     }
 }
 
@@ -375,7 +428,9 @@ static void LinkComponent
 static void LinkComponentInstance
 (
     legato::ComponentInstance& componentInstance,
-    std::stringstream& commandLine
+    std::stringstream& commandLine,
+    std::list<std::string>& libs,   ///< Paths of the libraries linked are added to this list.
+    bool isStatic                   ///< true = the components' object files are linked instead.
 )
 //--------------------------------------------------------------------------------------------------
 {
@@ -385,10 +440,14 @@ static void LinkComponentInstance
         auto& interface = mapEntry.second;
 
         commandLine << " -l" << interface.Lib().ShortName();
+        libs.push_back(interface.Lib().BuildOutputPath());
     }
 
     // Link the component library and all its sub-components.
-    LinkComponent(componentInstance.GetComponent(), commandLine);
+    if (!isStatic)
+    {
+        LinkComponent(componentInstance.GetComponent(), commandLine, libs);
+    }
 
     // Re-link all the async and manual-start server-side APIs (because there are functions
     // in there that the component will need to call).
@@ -413,6 +472,7 @@ static void LinkComponentInstance
             const legato::Library& lib = interface.Lib();
 
             commandLine << " -l" << lib.ShortName();
+            libs.push_back(lib.BuildOutputPath());
         }
     }
 }
@@ -424,7 +484,7 @@ static void LinkComponentInstance
  * create the executable file.
  *
  * @note Assumes that all components other than the default component have been compiled and linked
- *       into libraries already.
+ *       into libraries already (or, when linking statically, just compiled).
  */
 //--------------------------------------------------------------------------------------------------
 void ExecutableBuilder_t::Build
@@ -434,6 +494,8 @@ void ExecutableBuilder_t::Build
 )
 //--------------------------------------------------------------------------------------------------
 {
+    mk::ProfilePhase_t phase("exe", legato::GetLastPathNode(executable.OutputPath()));
+
     // Build all the component instances.
     ComponentInstanceBuilder_t componentInstanceBuilder(m_Params);
     for (auto& instance : executable.ComponentInstances())
@@ -474,8 +536,25 @@ void ExecutableBuilder_t::Build
     std::stringstream commandLine;
     commandLine << compilerPath << " -o " << outputPath;
 
-    // Link with the default component's library.
-    commandLine << " " << defaultComponent.Lib().BuildOutputPath();
+    std::list<std::string> libs;
+
+    if (m_Params.DoStaticLink())
+    {
+        // Link the object files of all the components straight into the executable, with the
+        // default component's last.
+        std::set<const legato::Component*> linkedSet;
+        for (const auto& componentInstance : executable.ComponentInstances())
+        {
+            LinkComponentObjects(componentInstance.GetComponent(), linkedSet, commandLine, libs);
+        }
+        LinkComponentObjects(defaultComponent, linkedSet, commandLine, libs);
+    }
+    else
+    {
+        // Link with the default component's library.
+        commandLine << " " << defaultComponent.Lib().BuildOutputPath();
+        libs.push_back(defaultComponent.Lib().BuildOutputPath());
+    }
 
     // Add the library output directory as a library search directory.
     commandLine << " -L" << m_Params.LibOutputDir();
@@ -485,7 +564,7 @@ void ExecutableBuilder_t::Build
     auto instanceList = executable.ComponentInstances();
     for (auto componentInstance : instanceList)
     {
-        LinkComponentInstance(componentInstance, commandLine);
+        LinkComponentInstance(componentInstance, commandLine, libs, m_Params.DoStaticLink());
     }
 
     // Link with other libraries that are needed by the default component.
@@ -498,10 +577,12 @@ void ExecutableBuilder_t::Build
     for (const auto& i : instanceList)
     {
         mk::GetComponentLibLinkDirectives(commandLine, i.GetComponent());
+        mk::GetComponentBundledLibs(libs, i.GetComponent());
     }
 
     // Link with the Legato C runtime library.
     commandLine << " \"-L$LEGATO_ROOT/build/" << m_Params.Target() << "/bin/lib\"" << " -llegato";
+    libs.push_back(mk::GetLegatoLibPath());
 
     // Link with the real-time library, pthreads library, and the math library, just in case they're
     // needed too.
@@ -510,6 +591,9 @@ void ExecutableBuilder_t::Build
     // Insert LDFLAGS on the command-line.
     commandLine << m_Params.LinkerFlags();
 
+    // Add the flags for the optimization goal (if any).
+    mk::GetOptimizationLinkFlags(commandLine, compilerPath, m_Params);
+
     // On the localhost, set the DT_RUNPATH variable inside the executable to include the
     // expected locations of the libraries needed.
     if (m_Params.Target() == "localhost")
@@ -531,7 +615,9 @@ void ExecutableBuilder_t::Build
         std::cout << std::endl << "$ " << commandLine.str() << std::endl << std::endl;
     }
 
-    mk::ExecuteCommandLine(commandLine);
+    // The link has to wait for all the libraries it links with to be built, and has to be redone
+    // if any of them changes.
+    mk::StartJob(commandLine, libs, { outputPath });
 }
 
 
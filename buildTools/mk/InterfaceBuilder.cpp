@@ -9,11 +9,54 @@
 #include "LegatoObjectModel.h"
 #include "InterfaceBuilder.h"
 #include "Utilities.h"
+#include "JobScheduler.h"
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Generate a string containing --import-dir arguments for ifgen.
+ * Add to a list the paths of an .api file and all the .api files it imports types from.
+ */
+//--------------------------------------------------------------------------------------------------
+static void GetApiFiles
+(
+    std::list<std::string>& files,
+    const legato::Api_t& api
+)
+//--------------------------------------------------------------------------------------------------
+{
+    files.push_back(api.FilePath());
+
+    for (auto apiPtr : api.Dependencies())
+    {
+        GetApiFiles(files, *apiPtr);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the paths of the inputs of an mkif job: the output directory (so that mkif runs into the
+ * same directory are ordered) and the .api files that mkif will read.
+ */
+//--------------------------------------------------------------------------------------------------
+static std::list<std::string> GetMkifInputs
+(
+    const legato::Api_t& api,
+    const std::string& outputDir
+)
+//--------------------------------------------------------------------------------------------------
+{
+    std::list<std::string> inputs = { outputDir };
+
+    GetApiFiles(inputs, api);
+
+    return inputs;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Generate a string containing --import-dir arguments for mkif.
  *
  * @return The string.
  **/
@@ -55,13 +98,13 @@ const
 {
     std::stringstream commandLine;
 
-    // Use the ifgen tool to generate the API code.
-    commandLine << "ifgen --gen-local --gen-interface";
+    // Use the mkif tool to generate the API code.
+    commandLine << "mkif --gen-local --gen-interface";
 
     // Specify the output directory.
     commandLine << " --output-dir \"" << outputDir << "\"";
 
-    // Specify where ifgen should look for any additional .api files it might need.
+    // Specify where mkif should look for any additional .api files it might need.
     commandLine << GenerateImportDirArgs(api);
 
     // Specify the path to the protocol file.
@@ -72,7 +115,11 @@ const
         std::cout << std::endl << "$ " << commandLine.str() << std::endl << std::endl;
     }
 
-    mk::ExecuteCommandLine(commandLine.str());
+    // The output directory is both read and written, so mkif runs into the same directory are
+    // done one at a time, and compiles that search that directory for headers wait for them.
+    mk::StartJob(commandLine,
+                 GetMkifInputs(api, outputDir),
+                 { outputDir, legato::CombinePath(outputDir, api.Name() + "_interface.h") });
 
     // Now do the same for any other APIs that this API depends on.
     for (auto apiPtr : api.Dependencies())
@@ -97,8 +144,8 @@ const
 {
     std::stringstream commandLine;
 
-    // Use the ifgen tool to generate the API code.
-    commandLine << "ifgen --gen-local --gen-interface";
+    // Use the mkif tool to generate the API code.
+    commandLine << "mkif --gen-local --gen-interface";
 
     // Set the C identifier prefix.
     commandLine << " --name-prefix " << interface.InternalName() << "_";
@@ -112,7 +159,7 @@ const
     // Specify the output directory.
     commandLine << " --output-dir \"" << outputDir << "\"";
 
-    // Specify where ifgen should look for any additional .api files it might need.
+    // Specify where mkif should look for any additional .api files it might need.
     commandLine << GenerateImportDirArgs(interface.Api());
 
     // Specify the path to the protocol file.
@@ -123,7 +170,10 @@ const
         std::cout << std::endl << "$ " << commandLine.str() << std::endl << std::endl;
     }
 
-    mk::ExecuteCommandLine(commandLine.str());
+    std::string headerPath = legato::CombinePath(outputDir,
+                                                 interface.InternalName() + "_interface.h");
+
+    mk::StartJob(commandLine, GetMkifInputs(interface.Api(), outputDir), { outputDir, headerPath });
 
     // Now do the same for any other APIs that this API depends on.
     for (auto apiPtr : interface.Api().Dependencies())
@@ -148,10 +198,10 @@ const
 {
     std::string commandLine;
 
-    // Use the ifgen tool to generate the API code.
-    commandLine = "ifgen --gen-local --gen-server-interface";
+    // Use the mkif tool to generate the API code.
+    commandLine = "mkif --gen-local --gen-server-interface";
 
-    // Tell ifgen if the server needs to handle requests asynchronously.
+    // Tell mkif if the server needs to handle requests asynchronously.
     if (interface.IsAsync())
     {
         commandLine += " --async-server";
@@ -172,7 +222,7 @@ const
     // Specify the path to the .api file.
     commandLine += " \"" + interface.Api().FilePath() + "\"";
 
-    // Specify where ifgen should look for any additional .api files it might need.
+    // Specify where mkif should look for any additional .api files it might need.
     commandLine += GenerateImportDirArgs(interface.Api());
 
     if (m_Params.IsVerbose())
@@ -180,14 +230,17 @@ const
         std::cout << std::endl << "$ " << commandLine << std::endl << std::endl;
     }
 
-    mk::ExecuteCommandLine(commandLine);
+    std::string headerPath = legato::CombinePath(outputDir,
+                                                 interface.InternalName() + "_server.h");
+
+    mk::StartJob(commandLine, GetMkifInputs(interface.Api(), outputDir), { outputDir, headerPath });
 
     // For each API that this API imports types from, also generate that API's server header.
     for (auto apiPtr : interface.Api().Dependencies())
     {
-        commandLine = "ifgen --gen-server-interface";
+        commandLine = "mkif --gen-server-interface";
 
-        // Tell ifgen if the server needs to handle requests asynchronously.
+        // Tell mkif if the server needs to handle requests asynchronously.
         if (interface.IsAsync())
         {
             commandLine += " --async-server";
@@ -199,7 +252,7 @@ const
         // Specify the path to the protocol file.
         commandLine += " \"" + apiPtr->FilePath() + "\"";
 
-        // Specify where ifgen should look for any additional .api files it might need.
+        // Specify where mkif should look for any additional .api files it might need.
         commandLine += GenerateImportDirArgs(interface.Api());
 
         if (m_Params.IsVerbose())
@@ -207,7 +260,9 @@ const
             std::cout << std::endl << "$ " << commandLine << std::endl << std::endl;
         }
 
-        mk::ExecuteCommandLine(commandLine);
+        mk::StartJob(commandLine,
+                     GetMkifInputs(*apiPtr, outputDir),
+                     { outputDir, legato::CombinePath(outputDir, apiPtr->Name() + "_server.h") });
     }
 }
 
@@ -229,8 +284,20 @@ const
 {
     std::stringstream commandLine;
 
-    // Use the ifgen tool to generate the API code.
-    commandLine << "ifgen --gen-client --gen-interface --gen-local";
+    // Use the mkif tool to generate the API code.
+    commandLine << "mkif --gen-client --gen-interface --gen-local";
+
+    // Tell mkif if the client functions should only suspend the calling coroutine.
+    if (interface.IsAwait())
+    {
+        commandLine << " --await-client";
+    }
+
+    // Tell mkif if Start and Finish functions should be generated too.
+    if (interface.IsPipelined())
+    {
+        commandLine << " --pipelined-client";
+    }
 
     // Set the C identifier prefix.
     commandLine << " --name-prefix " << interface.InternalName() << "_";
@@ -244,7 +311,7 @@ const
     // Specify the path to the .api file.
     commandLine << " \"" << interface.Api().FilePath() << "\"";
 
-    // Specify where ifgen should look for any additional .api files it might need.
+    // Specify where mkif should look for any additional .api files it might need.
     commandLine << GenerateImportDirArgs(interface.Api());
 
     if (m_Params.IsVerbose())
@@ -252,9 +319,13 @@ const
         std::cout << std::endl << "$ " << commandLine.str() << std::endl << std::endl;
     }
 
-    mk::ExecuteCommandLine(commandLine.str());
+    std::string sourceFilePath = legato::CombinePath(outputDir,
+                                                     interface.Api().Name() + "_client.c");
+
+    mk::StartJob(commandLine, GetMkifInputs(interface.Api(), outputDir),
+                 { outputDir, sourceFilePath });
 
-    return legato::CombinePath(outputDir, interface.Api().Name() + "_client.c");
+    return sourceFilePath;
 }
 
 
@@ -277,10 +348,10 @@ const
 {
     std::string commandLine;
 
-    // Use the ifgen tool to generate the API code.
-    commandLine = "ifgen --gen-server --gen-server-interface --gen-local";
+    // Use the mkif tool to generate the API code.
+    commandLine = "mkif --gen-server --gen-server-interface --gen-local";
 
-    // Tell ifgen if the server needs to handle requests asynchronously.
+    // Tell mkif if the server needs to handle requests asynchronously.
     if (interface.IsAsync())
     {
         commandLine += " --async-server";
@@ -298,7 +369,7 @@ const
     // Specify the path to the protocol file.
     commandLine += " \"" + interface.Api().FilePath() + "\"";
 
-    // Specify where ifgen should look for any additional .api files it might need.
+    // Specify where mkif should look for any additional .api files it might need.
     commandLine += GenerateImportDirArgs(interface.Api());
 
     if (m_Params.IsVerbose())
@@ -306,14 +377,18 @@ const
         std::cout << std::endl << "$ " << commandLine << std::endl << std::endl;
     }
 
-    mk::ExecuteCommandLine(commandLine);
+    std::string sourceFilePath = legato::CombinePath(outputDir,
+                                                     interface.Api().Name() + "_server.c");
+
+    mk::StartJob(commandLine, GetMkifInputs(interface.Api(), outputDir),
+                 { outputDir, sourceFilePath });
 
     // For each API that this API imports types from, also generate that API's server header.
     for (auto apiPtr : interface.Api().Dependencies())
     {
-        commandLine = "ifgen --gen-server-interface";
+        commandLine = "mkif --gen-server-interface";
 
-        // Tell ifgen if the server needs to handle requests asynchronously.
+        // Tell mkif if the server needs to handle requests asynchronously.
         if (interface.IsAsync())
         {
             commandLine += " --async-server";
@@ -336,10 +411,12 @@ const
             std::cout << std::endl << "$ " << commandLine << std::endl << std::endl;
         }
 
-        mk::ExecuteCommandLine(commandLine);
+        mk::StartJob(commandLine,
+                     GetMkifInputs(*apiPtr, outputDir),
+                     { outputDir, legato::CombinePath(outputDir, apiPtr->Name() + "_server.h") });
     }
 
-    return legato::CombinePath(outputDir, interface.Api().Name() + "_server.c");
+    return sourceFilePath;
 }
 
 
@@ -409,7 +486,11 @@ void InterfaceBuilder_t::BuildInterfaceLibrary
         std::cout << std::endl << "$ " << commandLine.str() << std::endl << std::endl;
     }
 
-    mk::ExecuteCommandLine(commandLine);
+    std::list<std::string> inputs = { sourceFilePath,
+                                      legato::GetContainingDir(sourceFilePath),
+                                      mk::GetLegatoLibPath() };
+
+    mk::StartJob(commandLine, inputs, { lib.BuildOutputPath() });
 
     lib.MarkUpToDate();
     lib.MarkExisting();
@@ -429,7 +510,7 @@ void InterfaceBuilder_t::Build
 )
 //--------------------------------------------------------------------------------------------------
 {
-    // NOTE: For now, ifgen can't share code between multiple server-side instances of the same API
+    // NOTE: For now, mkif can't share code between multiple server-side instances of the same API
     //       in the same process, so we have to generate a unique .so for each.
 
     // If this interface has already been built, we shouldn't do it again.
@@ -488,7 +569,7 @@ void InterfaceBuilder_t::Build
 )
 //--------------------------------------------------------------------------------------------------
 {
-    // NOTE: For now, ifgen can't share code between multiple client-side instances of the same API
+    // NOTE: For now, mkif can't share code between multiple client-side instances of the same API
     //       in the same process, so we have to generate a unique .so for each.
 
     // If this interface has already been built, we shouldn't do it again.
@@ -0,0 +1,812 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * Implementation of the parallel build job scheduler used by the mk tools.
+ *
+ * Each job is run by forking a child process that runs the command-line using /bin/sh, with its
+ * stdout and stderr redirected into a pipe.  The scheduler reads from the pipes of all the running
+ * jobs while it waits, so that a job never blocks because nobody is draining its output.
+ *
+ * Dependencies are worked out when a job is started: the new job depends on every unfinished
+ * job that writes one of the paths that the new job reads or writes.  Because a job can only
+ * depend on jobs that were started before it, there can be no dependency loops.
+ *
+ * When a job's dependencies have finished, the build state database is checked to see whether
+ * the job's inputs have changed since it was last run.  If not, the job is skipped.
+ *
+ * Jobs that run mkif are not run using the shell.  Instead, they are run right here in the mk
+ * process, so that each .api file only has to be parsed once per build, no matter how many
+ * interfaces use it.  Generating code from a parsed .api file is quick compared to forking a
+ * child, so these jobs are simply run one after another as they become ready.
+ *
+ * Copyright (C) 2014, Sierra Wireless Inc.  Use of this work is subject to license.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include <vector>
+#include "LegatoObjectModel.h"
+#include "JobScheduler.h"
+#include "BuildState.h"
+#include "mkif.h"
+#include "NativeCommands.h"
+#include "Profiler.h"
+
+extern "C" {
+    #include <unistd.h>
+    #include <fcntl.h>
+    #include <poll.h>
+    #include <errno.h>
+    #include <string.h>
+    #include <signal.h>
+    #include <sys/wait.h>
+    #include <sys/resource.h>
+}
+
+
+namespace mk
+{
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A build job.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    std::string commandLine;        ///< Shell command-line to run.
+    std::set<size_t> dependencies;  ///< IDs of jobs that must finish before this one can run.
+    std::list<std::string> inputs;  ///< Paths read by the job.
+    std::list<std::string> outputs; ///< Paths written by the job.
+    std::string depFilePath;        ///< Dependency file written by the job ("" = none).
+    InputSnapshot_t inputSnapshot;  ///< The job's inputs, as they were when it was started.
+    pid_t pid;                      ///< Process ID of the child running the job (0 = not started).
+    int outputFd;                   ///< Read end of the pipe carrying the job's output.
+    std::string output;             ///< Output collected so far.
+    ProfileMark_t profileMark;      ///< When (and in which build phases) the job was started.
+}
+Job_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * The job scheduler.
+ *
+ * There is only one of these.  If the build is aborted, mk::StopJobs() lets the running jobs
+ * finish (so that the ones that succeed are remembered) before the build state is saved.  As a
+ * last resort, the destructor kills any jobs that are still running.
+ */
+//--------------------------------------------------------------------------------------------------
+class JobScheduler_t
+{
+    public:
+
+        JobScheduler_t()
+        :   m_MaxJobs(1), m_NextJobId(1), m_NumRunning(0), m_ExitCode(0), m_IsRecording(false)
+        {}
+        ~JobScheduler_t();
+
+    private:
+
+        size_t m_MaxJobs;           ///< Maximum number of jobs that can run at the same time.
+        size_t m_NextJobId;         ///< ID to give to the next job that is started.
+        size_t m_NumRunning;        ///< Number of jobs that are running now.
+        int m_ExitCode;             ///< Exit code of the first job that failed (0 = none failed).
+        std::string m_FailedCommandLine;    ///< Command-line of the first job that failed.
+        bool m_IsRecording;         ///< true = only record jobs, don't run them.
+
+        /// Jobs recorded while m_IsRecording is true, in the order they were started.
+        std::list<JobInfo_t> m_RecordedJobs;
+
+        /// Unfinished jobs, by ID.
+        std::map<size_t, Job_t> m_Jobs;
+
+        /// IDs of the unfinished jobs that write to each path.
+        std::map<std::string, std::set<size_t>> m_Writers;
+
+    public:
+
+        void MaxJobs(size_t maxJobs) { m_MaxJobs = maxJobs; }
+
+        void RecordOnly() { WaitAll(); m_IsRecording = true; }
+        bool IsRecording() const { return m_IsRecording; }
+        const std::list<JobInfo_t>& RecordedJobs() const { return m_RecordedJobs; }
+
+        void Start(const std::string& commandLine,
+                   const std::list<std::string>& inputs,
+                   const std::list<std::string>& outputs,
+                   const std::string& depFilePath);
+
+        void WaitAll();
+        void Stop();
+
+    private:
+
+        void AddDependencies(std::set<size_t>& dependencies, const std::string& path) const;
+        bool IsReady(const Job_t& job) const;
+        void Launch(Job_t& job);
+        void RunInProcess(size_t jobId, Job_t& job);
+        void LaunchReadyJobs();
+        void Poll(bool canBlock);
+        void Finish(size_t jobId, int exitCode);
+        void Forget(size_t jobId);
+        void ThrowIfFailed() const;
+};
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * The one and only job scheduler.
+ */
+//--------------------------------------------------------------------------------------------------
+static JobScheduler_t Scheduler;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Destructor.  Kills any jobs that are still running, and waits for them to die.
+ *
+ * This is run during static destruction, after the build state and the profiler may have been
+ * destroyed, so the jobs' outcomes are not reported or recorded.  Only the shell that runs each
+ * job is killed (the jobs stay in mk's process group so that Ctrl-C reaches them), so this is
+ * just a last resort for when mk::StopJobs() wasn't called.
+ */
+//--------------------------------------------------------------------------------------------------
+JobScheduler_t::~JobScheduler_t
+(
+)
+//--------------------------------------------------------------------------------------------------
+{
+    for (auto& mapEntry : m_Jobs)
+    {
+        Job_t& job = mapEntry.second;
+
+        if (job.pid != 0)
+        {
+            kill(job.pid, SIGTERM);
+            close(job.outputFd);
+
+            while ((waitpid(job.pid, NULL, 0) < 0) && (errno == EINTR))
+            {
+            }
+        }
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add to a set of dependencies all the unfinished jobs that write to a given path.
+ */
+//--------------------------------------------------------------------------------------------------
+void JobScheduler_t::AddDependencies
+(
+    std::set<size_t>& dependencies,
+    const std::string& path
+)
+const
+//--------------------------------------------------------------------------------------------------
+{
+    auto i = m_Writers.find(path);
+
+    if (i != m_Writers.end())
+    {
+        dependencies.insert(i->second.begin(), i->second.end());
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check whether a job that hasn't been started yet can be started now.
+ *
+ * @return true if all the jobs it depends on have finished.
+ */
+//--------------------------------------------------------------------------------------------------
+bool JobScheduler_t::IsReady
+(
+    const Job_t& job
+)
+const
+//--------------------------------------------------------------------------------------------------
+{
+    for (auto jobId : job.dependencies)
+    {
+        if (m_Jobs.find(jobId) != m_Jobs.end())
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Fork a child process to run a job.
+ *
+ * @throw   legato::Exception on failure.
+ */
+//--------------------------------------------------------------------------------------------------
+void JobScheduler_t::Launch
+(
+    Job_t& job
+)
+//--------------------------------------------------------------------------------------------------
+{
+    int fds[2];
+
+    if (pipe2(fds, O_CLOEXEC) != 0)
+    {
+        throw legato::Exception(std::string("Failed to create pipe: ") + strerror(errno));
+    }
+
+    // Make sure anything we've printed so far doesn't get printed again by the child.
+    std::cout.flush();
+    std::cerr.flush();
+
+    pid_t pid = fork();
+
+    if (pid < 0)
+    {
+        close(fds[0]);
+        close(fds[1]);
+
+        throw legato::Exception(std::string("Failed to fork: ") + strerror(errno));
+    }
+
+    if (pid == 0)
+    {
+        // Child: send stdout and stderr into the pipe and run the command-line.
+        dup2(fds[1], STDOUT_FILENO);
+        dup2(fds[1], STDERR_FILENO);
+
+        execl("/bin/sh", "sh", "-c", job.commandLine.c_str(), (char*)NULL);
+
+        _exit(127);
+    }
+
+    close(fds[1]);
+
+    RestartProfileMark(job.profileMark);
+
+    job.pid = pid;
+    job.outputFd = fds[0];
+
+    m_NumRunning++;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Run a job that runs mkif, or a command that mk has a native implementation of, in this
+ * process, and finish it.
+ */
+//--------------------------------------------------------------------------------------------------
+void JobScheduler_t::RunInProcess
+(
+    size_t jobId,
+    Job_t& job
+)
+//--------------------------------------------------------------------------------------------------
+{
+    m_NumRunning++;
+
+    RestartProfileMark(job.profileMark);
+
+    int exitCode = EXIT_SUCCESS;
+
+    if (IsMkifCommandLine(job.commandLine))
+    {
+        exitCode = RunMkifCommandLine(job.commandLine, job.output);
+    }
+    else
+    {
+        try
+        {
+            RunNativeCommandLine(job.commandLine);
+        }
+        catch (const std::runtime_error& e)
+        {
+            job.output += std::string("** ERROR: ") + e.what() + "\n";
+            exitCode = EXIT_FAILURE;
+        }
+    }
+
+    RecordJobProfile(job.profileMark,
+                     job.commandLine,
+                     job.outputs.empty() ? "" : job.outputs.front(),
+                     -1);
+
+    Finish(jobId, exitCode);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start as many waiting jobs as possible, oldest first.
+ */
+//--------------------------------------------------------------------------------------------------
+void JobScheduler_t::LaunchReadyJobs
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    auto i = m_Jobs.begin();
+
+    // Once a job has failed, the build is going to stop, so don't start anything new.  (A job
+    // run in this process can fail while we're going through the list.)
+    while ((i != m_Jobs.end()) && (m_NumRunning < m_MaxJobs) && (m_ExitCode == 0))
+    {
+        size_t jobId = i->first;
+        Job_t& job = i->second;
+
+        // Move on before the job might be forgotten.  Jobs only depend on jobs with lower IDs,
+        // so any jobs that become ready because this one is skipped are still ahead of us.
+        ++i;
+
+        if ((job.pid == 0) && IsReady(job))
+        {
+            if (IsUpToDate(job.commandLine, job.inputs, job.outputs, job.depFilePath))
+            {
+                Forget(jobId);
+                continue;
+            }
+
+            // Changes made to the inputs while the job runs must not be taken as what it used.
+            job.inputSnapshot = SnapshotInputs(job.inputs);
+
+            if (IsMkifCommandLine(job.commandLine) || IsNativeCommandLine(job.commandLine))
+            {
+                RunInProcess(jobId, job);
+            }
+            else
+            {
+                Launch(job);
+            }
+        }
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Collect output from running jobs and clean up after any jobs that have finished.
+ */
+//--------------------------------------------------------------------------------------------------
+void JobScheduler_t::Poll
+(
+    bool canBlock   ///< true = wait until at least one job has something to report.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    std::vector<struct pollfd> pollFds;
+    std::vector<size_t> jobIds;
+
+    for (auto& mapEntry : m_Jobs)
+    {
+        if (mapEntry.second.pid != 0)
+        {
+            struct pollfd pollFd = { mapEntry.second.outputFd, POLLIN, 0 };
+
+            pollFds.push_back(pollFd);
+            jobIds.push_back(mapEntry.first);
+        }
+    }
+
+    if (pollFds.empty())
+    {
+        return;
+    }
+
+    int result = poll(pollFds.data(), pollFds.size(), canBlock ? -1 : 0);
+
+    if ((result < 0) && (errno != EINTR))
+    {
+        throw legato::Exception(std::string("poll() failed: ") + strerror(errno));
+    }
+
+    for (size_t i = 0; (result > 0) && (i < pollFds.size()); i++)
+    {
+        if (pollFds[i].revents == 0)
+        {
+            continue;
+        }
+
+        Job_t& job = m_Jobs[jobIds[i]];
+
+        char buffer[4096];
+        ssize_t bytesRead = read(job.outputFd, buffer, sizeof(buffer));
+
+        if (bytesRead > 0)
+        {
+            job.output.append(buffer, bytesRead);
+        }
+        else if ((bytesRead == 0) || (errno != EINTR))
+        {
+            // End of the output means the child is done (or about to be).
+            int status;
+            struct rusage usage;
+
+            close(job.outputFd);
+
+            while ((wait4(job.pid, &status, 0, &usage) < 0) && (errno == EINTR))
+            {
+            }
+
+            RecordJobProfile(job.profileMark,
+                             job.commandLine,
+                             job.outputs.empty() ? "" : job.outputs.front(),
+                               usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6
+                             + usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6);
+
+            Finish(jobIds[i], WIFEXITED(status) ? WEXITSTATUS(status) : (128 + WTERMSIG(status)));
+        }
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Report the outcome of a job that has finished and forget about it.
+ */
+//--------------------------------------------------------------------------------------------------
+void JobScheduler_t::Finish
+(
+    size_t jobId,
+    int exitCode    ///< Exit code of the job (128 + signal number if it was killed by a signal).
+)
+//--------------------------------------------------------------------------------------------------
+{
+    Job_t& job = m_Jobs[jobId];
+
+    bool isOk = (exitCode == EXIT_SUCCESS);
+
+    // Print the job's output all in one piece.
+    if (isOk)
+    {
+        std::cout << job.output << std::flush;
+
+        MarkUpToDate(job.commandLine, job.inputSnapshot, job.depFilePath);
+    }
+    else
+    {
+        std::cerr << job.output << std::flush;
+
+        if (m_ExitCode == 0)
+        {
+            m_ExitCode = exitCode;
+            m_FailedCommandLine = job.commandLine;
+        }
+    }
+
+    m_NumRunning--;
+
+    Forget(jobId);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Forget about a job that has finished (or didn't need to be run), so that jobs that depend on
+ * it can be started.
+ */
+//--------------------------------------------------------------------------------------------------
+void JobScheduler_t::Forget
+(
+    size_t jobId
+)
+//--------------------------------------------------------------------------------------------------
+{
+    Job_t& job = m_Jobs[jobId];
+
+    for (const auto& path : job.outputs)
+    {
+        auto i = m_Writers.find(path);
+
+        i->second.erase(jobId);
+
+        if (i->second.empty())
+        {
+            m_Writers.erase(i);
+        }
+    }
+
+    m_Jobs.erase(jobId);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Throw an exception if any job has failed.
+ *
+ * @throw   legato::Exception if any job has failed.
+ */
+//--------------------------------------------------------------------------------------------------
+void JobScheduler_t::ThrowIfFailed
+(
+    void
+)
+const
+//--------------------------------------------------------------------------------------------------
+{
+    if (m_ExitCode != 0)
+    {
+        std::stringstream buffer;
+
+        buffer << "Command execution failure, exit code: " << m_ExitCode << "." << std::endl
+               << "    Command was: " << m_FailedCommandLine;
+
+        throw legato::Exception(buffer.str());
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start a job.
+ *
+ * @throw   legato::Exception if a previously started job failed.
+ */
+//--------------------------------------------------------------------------------------------------
+void JobScheduler_t::Start
+(
+    const std::string& commandLine,
+    const std::list<std::string>& inputs,
+    const std::list<std::string>& outputs,
+    const std::string& depFilePath
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (m_IsRecording)
+    {
+        m_RecordedJobs.push_back({ commandLine, inputs, outputs, depFilePath });
+        return;
+    }
+
+    // Pick up anything that has finished, so a failure stops the build as soon as possible.
+    Poll(false);
+
+    if (m_ExitCode != 0)
+    {
+        WaitAll();
+    }
+
+    size_t jobId = m_NextJobId++;
+    Job_t& job = m_Jobs[jobId];
+
+    job.commandLine = commandLine;
+    job.inputs = inputs;
+    job.outputs = outputs;
+    job.depFilePath = depFilePath;
+    job.pid = 0;
+    job.outputFd = -1;
+    job.profileMark = MarkProfileStart();
+
+    // Anything that writes what this job reads must finish first.  So must anything that writes
+    // what this job writes, so that the last job to write a file always wins.
+    for (const auto& path : inputs)
+    {
+        AddDependencies(job.dependencies, path);
+    }
+    for (const auto& path : outputs)
+    {
+        AddDependencies(job.dependencies, path);
+
+        m_Writers[path].insert(jobId);
+    }
+
+    LaunchReadyJobs();
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Wait for all jobs to finish.
+ *
+ * @throw   legato::Exception if any job failed.
+ */
+//--------------------------------------------------------------------------------------------------
+void JobScheduler_t::WaitAll
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    for (;;)
+    {
+        LaunchReadyJobs();
+
+        if (m_NumRunning == 0)
+        {
+            break;
+        }
+
+        Poll(true);
+    }
+
+    // If a job failed, there may be jobs left that were never started.
+    m_Jobs.clear();
+    m_Writers.clear();
+
+    ThrowIfFailed();
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Wait for the jobs that are running to finish, without starting any more.  Their outcomes are
+ * reported and recorded as usual, but a failure doesn't cause an exception.
+ *
+ * @throw   legato::Exception if the jobs can't be waited for.
+ */
+//--------------------------------------------------------------------------------------------------
+void JobScheduler_t::Stop
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    while (m_NumRunning > 0)
+    {
+        Poll(true);
+    }
+
+    m_Jobs.clear();
+    m_Writers.clear();
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set the maximum number of jobs that can be run at the same time.
+ */
+//--------------------------------------------------------------------------------------------------
+void SetMaxJobs
+(
+    int maxJobs     ///< Maximum number of jobs, or 0 (or less) for one per online CPU.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (maxJobs <= 0)
+    {
+        maxJobs = sysconf(_SC_NPROCESSORS_ONLN);
+
+        if (maxJobs <= 0)
+        {
+            maxJobs = 1;
+        }
+    }
+
+    Scheduler.MaxJobs(maxJobs);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start a job that runs a shell command-line.  The job will run in the background once all the
+ * jobs that it depends on have finished.
+ *
+ * @throw   legato::Exception if a previously started job failed.
+ */
+//--------------------------------------------------------------------------------------------------
+void StartJob
+(
+    const std::string& commandLine,
+    const std::list<std::string>& inputs,   ///< Paths of files/directories read by the job.
+    const std::list<std::string>& outputs,  ///< Paths of files/directories written by the job.
+    const std::string& depFilePath          ///< Dependency file written by the job (or "").
+)
+//--------------------------------------------------------------------------------------------------
+{
+    Scheduler.Start(commandLine, inputs, outputs, depFilePath);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start a job that runs a shell command-line.  The job will run in the background once all the
+ * jobs that it depends on have finished.
+ *
+ * @throw   legato::Exception if a previously started job failed.
+ */
+//--------------------------------------------------------------------------------------------------
+void StartJob
+(
+    const std::stringstream& commandLine,
+    const std::list<std::string>& inputs,   ///< Paths of files/directories read by the job.
+    const std::list<std::string>& outputs,  ///< Paths of files/directories written by the job.
+    const std::string& depFilePath          ///< Dependency file written by the job (or "").
+)
+//--------------------------------------------------------------------------------------------------
+{
+    Scheduler.Start(commandLine.str(), inputs, outputs, depFilePath);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Stop running jobs.  From now on, jobs that are started are only recorded (so a build file for
+ * another build tool can be generated from them).
+ */
+//--------------------------------------------------------------------------------------------------
+void RecordJobsOnly
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    Scheduler.RecordOnly();
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check whether jobs are only being recorded.
+ *
+ * @return true if RecordJobsOnly() has been called.
+ */
+//--------------------------------------------------------------------------------------------------
+bool IsRecordingJobs
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    return Scheduler.IsRecording();
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the jobs that have been recorded since RecordJobsOnly() was called, in the order they
+ * were started.
+ */
+//--------------------------------------------------------------------------------------------------
+const std::list<JobInfo_t>& GetRecordedJobs
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    return Scheduler.RecordedJobs();
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Wait for all jobs that have been started to finish.
+ *
+ * @throw   legato::Exception if any job failed.
+ */
+//--------------------------------------------------------------------------------------------------
+void WaitForJobs
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    Scheduler.WaitAll();
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Stop the build: wait for the jobs that are running to finish, but don't start any more.  Must
+ * be called when the build is aborted, before the build state is saved, so that the jobs that
+ * succeed are remembered.
+ *
+ * @throw   legato::Exception if the jobs can't be waited for.
+ */
+//--------------------------------------------------------------------------------------------------
+void StopJobs
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    Scheduler.Stop();
+}
+
+
+}  // namespace mk
@@ -0,0 +1,153 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * Parallel build job scheduler used by the mk tools.
+ *
+ * Build steps (compiles, links, mkif runs, file copies) are started as jobs.  Each job is a
+ * shell command-line plus the lists of files (or directories) that it reads and writes.  A job
+ * won't be run until all previously started jobs that write any of the files it reads or writes
+ * have finished, and no more than a given number of jobs are run at the same time.
+ *
+ * A job whose inputs haven't changed since it was last run successfully is skipped (see
+ * BuildState.h).
+ *
+ * The output (stdout and stderr) of each job is collected and printed all in one piece when the
+ * job finishes, so the output of jobs that run at the same time doesn't get mixed up.
+ *
+ * Copyright (C) 2014, Sierra Wireless Inc.  Use of this work is subject to license.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#ifndef JOB_SCHEDULER_INCLUDE_GUARD_H
+#define JOB_SCHEDULER_INCLUDE_GUARD_H
+
+namespace mk
+{
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Description of a job, as recorded when the scheduler is only recording jobs.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    std::string commandLine;        ///< Shell command-line to run.
+    std::list<std::string> inputs;  ///< Paths read by the job.
+    std::list<std::string> outputs; ///< Paths written by the job.
+    std::string depFilePath;        ///< Dependency file written by the job ("" = none).
+}
+JobInfo_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set the maximum number of jobs that can be run at the same time.
+ */
+//--------------------------------------------------------------------------------------------------
+void SetMaxJobs
+(
+    int maxJobs     ///< Maximum number of jobs, or 0 (or less) for one per online CPU.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start a job that runs a shell command-line.  The job will run in the background once all the
+ * jobs that it depends on have finished.
+ *
+ * @throw   legato::Exception if a previously started job failed.
+ */
+//--------------------------------------------------------------------------------------------------
+void StartJob
+(
+    const std::string& commandLine,
+    const std::list<std::string>& inputs,   ///< Paths of files/directories read by the job.
+    const std::list<std::string>& outputs,  ///< Paths of files/directories written by the job.
+    const std::string& depFilePath = ""     ///< Dependency file written by the job (or "").
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start a job that runs a shell command-line.  The job will run in the background once all the
+ * jobs that it depends on have finished.
+ *
+ * @throw   legato::Exception if a previously started job failed.
+ */
+//--------------------------------------------------------------------------------------------------
+void StartJob
+(
+    const std::stringstream& commandLine,
+    const std::list<std::string>& inputs,   ///< Paths of files/directories read by the job.
+    const std::list<std::string>& outputs,  ///< Paths of files/directories written by the job.
+    const std::string& depFilePath = ""     ///< Dependency file written by the job (or "").
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Stop running jobs.  From now on, jobs that are started are only recorded (so a build file for
+ * another build tool can be generated from them).
+ */
+//--------------------------------------------------------------------------------------------------
+void RecordJobsOnly
+(
+    void
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check whether jobs are only being recorded.
+ *
+ * @return true if RecordJobsOnly() has been called.
+ */
+//--------------------------------------------------------------------------------------------------
+bool IsRecordingJobs
+(
+    void
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the jobs that have been recorded since RecordJobsOnly() was called, in the order they
+ * were started.
+ */
+//--------------------------------------------------------------------------------------------------
+const std::list<JobInfo_t>& GetRecordedJobs
+(
+    void
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Wait for all jobs that have been started to finish.
+ *
+ * @throw   legato::Exception if any job failed.
+ */
+//--------------------------------------------------------------------------------------------------
+void WaitForJobs
+(
+    void
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Stop the build: wait for the jobs that are running to finish, but don't start any more.  Must
+ * be called when the build is aborted, before the build state is saved, so that the jobs that
+ * succeed are remembered.
+ *
+ * @throw   legato::Exception if the jobs can't be waited for.
+ */
+//--------------------------------------------------------------------------------------------------
+void StopJobs
+(
+    void
+);
+
+
+}
+
+#endif // JOB_SCHEDULER_INCLUDE_GUARD_H
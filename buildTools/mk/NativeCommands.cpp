@@ -0,0 +1,125 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * Native implementations of the shell commands that the mk tools use for file operations.
+ *
+ * Copyright (C) 2014, Sierra Wireless Inc.  Use of this work is subject to license.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include <vector>
+#include "LegatoObjectModel.h"
+#include "NativeCommands.h"
+#include "TarWriter.h"
+#include "Utilities.h"
+
+
+namespace mk
+{
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Split a command-line into arguments, if it is one that can be run natively.
+ *
+ * @return true if it can be run natively.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool SplitNativeCommandLine
+(
+    const std::string& commandLine,
+    std::vector<std::string>& args  ///< [out] The arguments.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    // Anything that needs the shell to expand something (or to do more than run one program)
+    // has to go to the shell.
+    if (commandLine.find_first_of(";&|<>`$*?[~(){}") != std::string::npos)
+    {
+        return false;
+    }
+
+    try
+    {
+        args = SplitCommandLine(commandLine);
+    }
+    catch (const legato::Exception&)
+    {
+        return false;
+    }
+
+    if (args.empty())
+    {
+        return false;
+    }
+
+    if (args[0] == "cp")
+    {
+        return (   (args.size() == 3)
+                || ((args.size() == 4) && (args[1] == "-r")) );
+    }
+
+    if (args[0] == "tar")
+    {
+        return (   (args.size() == 6)
+                && ((args[1] == "cf") || (args[1] == "cjf"))
+                && (args[3] == "-C")
+                && (args[5] == ".") );
+    }
+
+    return false;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check whether a command-line can be run by RunNativeCommandLine() instead of a shell.  These
+ * are:
+ *  - cp [-r] <source> <destination>
+ *  - tar cf|cjf <archive> -C <dir> .
+ */
+//--------------------------------------------------------------------------------------------------
+bool IsNativeCommandLine
+(
+    const std::string& commandLine
+)
+//--------------------------------------------------------------------------------------------------
+{
+    std::vector<std::string> args;
+
+    return SplitNativeCommandLine(commandLine, args);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Do what a command-line accepted by IsNativeCommandLine() would do, in this process.
+ *
+ * @throw   legato::Exception on failure.
+ */
+//--------------------------------------------------------------------------------------------------
+void RunNativeCommandLine
+(
+    const std::string& commandLine
+)
+//--------------------------------------------------------------------------------------------------
+{
+    std::vector<std::string> args;
+
+    if (!SplitNativeCommandLine(commandLine, args))
+    {
+        throw legato::Exception("Command-line can't be run without a shell: " + commandLine);
+    }
+
+    if (args[0] == "cp")
+    {
+        bool isRecursive = (args.size() == 4);
+
+        legato::CopyPath(args[args.size() - 2], args[args.size() - 1], isRecursive);
+    }
+    else
+    {
+        WriteTarFile(args[4], args[2], (args[1] == "cjf"));
+    }
+}
+
+
+}  // namespace mk
@@ -0,0 +1,48 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * Native implementations of the shell commands that the mk tools use for file operations (file
+ * copies and packaging), so that running them doesn't fork a shell and a program.
+ *
+ * Build steps are still described by shell command-lines (which are what is recorded in the
+ * build state and written to generated build files), but when mk runs a step whose command-line
+ * is one of the simple forms that mk itself writes, it does the work in-process instead.
+ *
+ * Copyright (C) 2014, Sierra Wireless Inc.  Use of this work is subject to license.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#ifndef NATIVE_COMMANDS_INCLUDE_GUARD_H
+#define NATIVE_COMMANDS_INCLUDE_GUARD_H
+
+namespace mk
+{
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check whether a command-line can be run by RunNativeCommandLine() instead of a shell.  These
+ * are:
+ *  - cp [-r] <source> <destination>
+ *  - tar cf|cjf <archive> -C <dir> .
+ */
+//--------------------------------------------------------------------------------------------------
+bool IsNativeCommandLine
+(
+    const std::string& commandLine
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Do what a command-line accepted by IsNativeCommandLine() would do, in this process.
+ *
+ * @throw   legato::Exception on failure.
+ */
+//--------------------------------------------------------------------------------------------------
+void RunNativeCommandLine
+(
+    const std::string& commandLine
+);
+
+}
+
+#endif // NATIVE_COMMANDS_INCLUDE_GUARD_H
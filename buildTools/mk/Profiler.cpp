@@ -0,0 +1,678 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * Implementation of the build-time profiler used by the mk tools.
+ *
+ * Wall-clock time is measured using the monotonic clock.  The CPU time of a phase is the CPU time
+ * used by the whole mk process while the phase was in progress (including any definition files
+ * being parsed on worker threads).  The CPU time of a build job is the user + system time of the
+ * child process that ran it (and that process's children), as reported when it is reaped.
+ *
+ * Copyright (C) 2014, Sierra Wireless Inc.  Use of this work is subject to license.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include <vector>
+#include <iomanip>
+#include <algorithm>
+#include "LegatoObjectModel.h"
+#include "Profiler.h"
+
+extern "C" {
+    #include <time.h>
+}
+
+
+namespace mk
+{
+
+/// Names of the profile files, in the working directory.
+static const char TraceFileName[] = "mk.profile.json";
+static const char SummaryFileName[] = "mk.profile.txt";
+
+/// Number of jobs listed in the "slowest jobs" part of the summary.
+static const size_t MaxSlowJobs = 20;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Something that was profiled: a phase or a job.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    std::string category;           ///< "job", or the phase's category.
+    std::string name;               ///< Name of the phase or job.
+    std::list<std::string> scope;   ///< Phases it was done in, outermost first.
+    double startTime;               ///< When it started (seconds since profiling was enabled).
+    double wallTime;                ///< Wall-clock time it took (seconds).
+    double cpuTime;                 ///< CPU time it took (seconds).
+    std::string commandLine;        ///< Command-line (jobs only).
+}
+Event_t;
+
+
+/// true = profiling is enabled.
+static bool IsEnabled = false;
+
+/// Directory where the profile files will be written.
+static std::string WorkingDir;
+
+/// When profiling was enabled.
+static struct timespec StartTime;
+
+/// Phases in progress, outermost first.
+static std::list<std::string> CurrentScope;
+
+/// Phases that have finished, in the order they finished.
+static std::list<Event_t> Phases;
+
+/// Jobs that have finished, in the order they finished.
+static std::list<Event_t> Jobs;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the wall-clock time since profiling was enabled.
+ *
+ * @return The time (seconds).
+ */
+//--------------------------------------------------------------------------------------------------
+static double GetWallTime
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (now.tv_sec - StartTime.tv_sec) + (now.tv_nsec - StartTime.tv_nsec) / 1e9;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the CPU time used by the mk process so far.
+ *
+ * @return The time (seconds).
+ */
+//--------------------------------------------------------------------------------------------------
+static double GetCpuTime
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &now);
+
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Join the phases in a scope into one string.
+ *
+ * @return The string (e.g., "app foo / exe bar"), or "-" if the scope is empty.
+ */
+//--------------------------------------------------------------------------------------------------
+static std::string ScopeString
+(
+    const std::list<std::string>& scope
+)
+//--------------------------------------------------------------------------------------------------
+{
+    std::string result;
+
+    for (const auto& phase : scope)
+    {
+        if (!result.empty())
+        {
+            result += " / ";
+        }
+        result += phase;
+    }
+
+    return (result.empty() ? "-" : result);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get a short name for a job, made from the name of the program it runs and the name of the
+ * file it writes (e.g., "gcc foo.c.o").
+ *
+ * @return The name.
+ */
+//--------------------------------------------------------------------------------------------------
+static std::string GetJobName
+(
+    const std::string& commandLine,
+    const std::string& outputPath
+)
+//--------------------------------------------------------------------------------------------------
+{
+    size_t start = commandLine.find_first_not_of(" \t\"");
+    size_t end = commandLine.find_first_of(" \t\"", start);
+
+    std::string name;
+
+    if (start != std::string::npos)
+    {
+        name = legato::GetLastPathNode(commandLine.substr(start, end - start));
+    }
+
+    if (!outputPath.empty())
+    {
+        name += " " + legato::GetLastPathNode(outputPath);
+    }
+
+    return name;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write a string as a JSON string literal.
+ */
+//--------------------------------------------------------------------------------------------------
+static void WriteJsonString
+(
+    std::ostream& stream,
+    const std::string& string
+)
+//--------------------------------------------------------------------------------------------------
+{
+    stream << '"';
+
+    for (unsigned char c : string)
+    {
+        if ((c == '"') || (c == '\\'))
+        {
+            stream << '\\' << c;
+        }
+        else if (c < 0x20)
+        {
+            stream << "\\u" << std::hex << std::setw(4) << std::setfill('0') << (int)c
+                   << std::dec << std::setfill(' ');
+        }
+        else
+        {
+            stream << c;
+        }
+    }
+
+    stream << '"';
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write an event to the trace file, as a "complete" event.
+ */
+//--------------------------------------------------------------------------------------------------
+static void WriteTraceEvent
+(
+    std::ostream& stream,
+    const Event_t& event,
+    size_t threadId                 ///< Row to show the event on.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    stream << ",\n{\"name\":";
+    WriteJsonString(stream, event.name);
+    stream << ",\"cat\":";
+    WriteJsonString(stream, event.category);
+    stream << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << threadId
+           << ",\"ts\":" << (uint64_t)(event.startTime * 1e6)
+           << ",\"dur\":" << (uint64_t)(event.wallTime * 1e6)
+           << ",\"args\":{\"cpu_ms\":" << (uint64_t)(event.cpuTime * 1e3) << ",\"scope\":";
+    WriteJsonString(stream, ScopeString(event.scope));
+
+    if (!event.commandLine.empty())
+    {
+        stream << ",\"command\":";
+        WriteJsonString(stream, event.commandLine);
+    }
+
+    stream << "}}";
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write the trace file.  Phases are shown on one row ("thread"), and jobs on as many rows as are
+ * needed so that jobs on the same row don't overlap.
+ *
+ * @throw   legato::Exception on failure.
+ */
+//--------------------------------------------------------------------------------------------------
+static void WriteTraceFile
+(
+    const std::string& path
+)
+//--------------------------------------------------------------------------------------------------
+{
+    std::ofstream stream(path, std::ofstream::trunc);
+
+    if (!stream.is_open())
+    {
+        throw legato::Exception("Failed to open '" + path + "' for writing.");
+    }
+
+    stream << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n"
+              "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"mk\"}},\n"
+              "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,"
+              "\"args\":{\"name\":\"mk\"}}";
+
+    for (const auto& event : Phases)
+    {
+        WriteTraceEvent(stream, event, 0);
+    }
+
+    std::vector<const Event_t*> jobs;
+    for (const auto& event : Jobs)
+    {
+        jobs.push_back(&event);
+    }
+    std::stable_sort(jobs.begin(), jobs.end(),
+                     [](const Event_t* a, const Event_t* b)
+                     { return a->startTime < b->startTime; });
+
+    // End time of the last job put on each job row.
+    std::vector<double> rowEndTimes;
+
+    for (auto eventPtr : jobs)
+    {
+        size_t row = 0;
+
+        while ((row < rowEndTimes.size()) && (rowEndTimes[row] > eventPtr->startTime))
+        {
+            row++;
+        }
+
+        if (row == rowEndTimes.size())
+        {
+            rowEndTimes.push_back(0);
+
+            stream << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << row + 1
+                   << ",\"args\":{\"name\":\"jobs " << row + 1 << "\"}}";
+        }
+
+        rowEndTimes[row] = eventPtr->startTime + eventPtr->wallTime;
+
+        WriteTraceEvent(stream, *eventPtr, row + 1);
+    }
+
+    stream << "\n]}\n";
+
+    if (!stream.flush())
+    {
+        throw legato::Exception("Failed to write to '" + path + "'.");
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write a line of the summary file.
+ */
+//--------------------------------------------------------------------------------------------------
+static void WriteSummaryLine
+(
+    std::ostream& stream,
+    double wallTime,
+    double cpuTime,
+    const std::string& count,       ///< Text for the count column ("" = no such column).
+    const std::string& description
+)
+//--------------------------------------------------------------------------------------------------
+{
+    stream << std::setw(10) << wallTime << std::setw(10) << cpuTime;
+
+    if (!count.empty())
+    {
+        stream << std::setw(7) << count;
+    }
+
+    stream << "  " << description << '\n';
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write the summary file.
+ *
+ * @throw   legato::Exception on failure.
+ */
+//--------------------------------------------------------------------------------------------------
+static void WriteSummaryFile
+(
+    const std::string& path,
+    double totalWallTime,
+    double totalCpuTime
+)
+//--------------------------------------------------------------------------------------------------
+{
+    std::ofstream stream(path, std::ofstream::trunc);
+
+    if (!stream.is_open())
+    {
+        throw legato::Exception("Failed to open '" + path + "' for writing.");
+    }
+
+    stream << std::fixed << std::setprecision(3);
+
+    // Each job's time is put down to each of the App, Component and Executable phases that it
+    // was started in (and the totals are put down to "all jobs").
+    typedef struct
+    {
+        double wallTime;
+        double cpuTime;
+        size_t count;
+    }
+    Total_t;
+
+    std::map<std::string, Total_t> totals;
+    Total_t& allJobs = totals["all jobs"];
+    allJobs = { 0, 0, 0 };
+
+    for (const auto& event : Jobs)
+    {
+        std::list<std::string> keys = { "all jobs" };
+
+        for (const auto& phase : event.scope)
+        {
+            if (   (phase.compare(0, 4, "app ") == 0)
+                || (phase.compare(0, 10, "component ") == 0)
+                || (phase.compare(0, 4, "exe ") == 0) )
+            {
+                keys.push_back(phase);
+            }
+        }
+
+        for (const auto& key : keys)
+        {
+            auto i = totals.find(key);
+
+            if (i == totals.end())
+            {
+                i = totals.insert(std::make_pair(key, Total_t({ 0, 0, 0 }))).first;
+            }
+
+            i->second.wallTime += event.wallTime;
+            i->second.cpuTime += event.cpuTime;
+            i->second.count++;
+        }
+    }
+
+    stream << "mk build profile\n"
+              "\n"
+              "Total wall-clock time: " << totalWallTime << " s\n"
+              "Total CPU time of mk itself: " << totalCpuTime << " s\n"
+              "Total CPU time of build jobs: " << allJobs.cpuTime << " s ("
+           << allJobs.count << " jobs)\n"
+              "\n"
+              "Times are in seconds.  The times of jobs that ran in parallel overlap, so they can\n"
+              "add up to more than the total wall-clock time.\n";
+
+    // Build jobs, by App, Component and Executable.
+    std::vector<std::pair<std::string, Total_t>> sortedTotals(totals.begin(), totals.end());
+    std::stable_sort(sortedTotals.begin(), sortedTotals.end(),
+                     [](const std::pair<std::string, Total_t>& a,
+                        const std::pair<std::string, Total_t>& b)
+                     { return a.second.wallTime > b.second.wallTime; });
+
+    stream << "\n"
+              "Build jobs, by App, Component and Executable:\n"
+              "\n"
+              "      Wall       CPU   Jobs  Started in\n";
+
+    for (const auto& entry : sortedTotals)
+    {
+        WriteSummaryLine(stream, entry.second.wallTime, entry.second.cpuTime,
+                         std::to_string(entry.second.count), entry.first);
+    }
+
+    // Slowest jobs.
+    std::vector<const Event_t*> jobs;
+    for (const auto& event : Jobs)
+    {
+        jobs.push_back(&event);
+    }
+    std::stable_sort(jobs.begin(), jobs.end(),
+                     [](const Event_t* a, const Event_t* b) { return a->wallTime > b->wallTime; });
+
+    if (jobs.size() > MaxSlowJobs)
+    {
+        jobs.resize(MaxSlowJobs);
+    }
+
+    stream << "\n"
+              "Slowest build jobs:\n"
+              "\n"
+              "      Wall       CPU  Job [started in]\n";
+
+    for (auto eventPtr : jobs)
+    {
+        WriteSummaryLine(stream, eventPtr->wallTime, eventPtr->cpuTime, "",
+                         eventPtr->name + " [" + ScopeString(eventPtr->scope) + "]");
+    }
+
+    // Phases done by mk itself.
+    std::vector<const Event_t*> phases;
+    for (const auto& event : Phases)
+    {
+        phases.push_back(&event);
+    }
+    std::stable_sort(phases.begin(), phases.end(),
+                     [](const Event_t* a, const Event_t* b) { return a->wallTime > b->wallTime; });
+
+    stream << "\n"
+              "Phases of the build done by mk itself:\n"
+              "\n"
+              "      Wall       CPU  Phase [inside]\n";
+
+    for (auto eventPtr : phases)
+    {
+        WriteSummaryLine(stream, eventPtr->wallTime, eventPtr->cpuTime, "",
+                         eventPtr->category + " " + eventPtr->name
+                         + " [" + ScopeString(eventPtr->scope) + "]");
+    }
+
+    if (!stream.flush())
+    {
+        throw legato::Exception("Failed to write to '" + path + "'.");
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Constructor.  Starts a phase.
+ */
+//--------------------------------------------------------------------------------------------------
+ProfilePhase_t::ProfilePhase_t
+(
+    const std::string& category,    ///< Kind of phase ("parse", "app", "component", "exe", ...)
+    const std::string& name         ///< Name of the phase (e.g., the app's name).
+)
+//--------------------------------------------------------------------------------------------------
+:   m_Category(category),
+    m_Name(name),
+    m_Start(MarkProfileStart())
+{
+    if (IsEnabled)
+    {
+        CurrentScope.push_back(category + " " + name);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Destructor.  Ends the phase.
+ */
+//--------------------------------------------------------------------------------------------------
+ProfilePhase_t::~ProfilePhase_t
+(
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (IsEnabled)
+    {
+        CurrentScope.pop_back();
+
+        Phases.push_back({ m_Category,
+                           m_Name,
+                           m_Start.scope,
+                           m_Start.wallTime,
+                           GetWallTime() - m_Start.wallTime,
+                           GetCpuTime() - m_Start.cpuTime,
+                           "" });
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Enable profiling.  Must be called before anything is done that should be profiled.
+ */
+//--------------------------------------------------------------------------------------------------
+void EnableProfiling
+(
+    const std::string& workingDir   ///< Directory where the profile files will be written.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    IsEnabled = true;
+    WorkingDir = workingDir;
+
+    clock_gettime(CLOCK_MONOTONIC, &StartTime);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check whether profiling has been enabled.
+ *
+ * @return true if EnableProfiling() has been called.
+ */
+//--------------------------------------------------------------------------------------------------
+bool IsProfiling
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    return IsEnabled;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Record when and where (in which phases) something is being started.
+ *
+ * @return The mark.
+ */
+//--------------------------------------------------------------------------------------------------
+ProfileMark_t MarkProfileStart
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    ProfileMark_t mark = { 0, 0, CurrentScope };
+
+    RestartProfileMark(mark);
+
+    return mark;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reset the time of a mark to now, keeping the phases it was made in.  Used for build jobs, which
+ * are labelled with the phases they were started in, but may not be run until later.
+ */
+//--------------------------------------------------------------------------------------------------
+void RestartProfileMark
+(
+    ProfileMark_t& mark
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (IsEnabled)
+    {
+        mark.wallTime = GetWallTime();
+        mark.cpuTime = GetCpuTime();
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Record a build job that has finished.  Does nothing if profiling isn't enabled.
+ */
+//--------------------------------------------------------------------------------------------------
+void RecordJobProfile
+(
+    const ProfileMark_t& start,         ///< Mark made when the job was started.
+    const std::string& commandLine,     ///< The job's command-line.
+    const std::string& outputPath,      ///< The job's (first) output file ("" if none).
+    double childCpuTime                 ///< CPU time used by the job's child processes (seconds),
+                                        ///  or a negative number if the job ran in mk itself.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (IsEnabled)
+    {
+        Jobs.push_back({ "job",
+                         GetJobName(commandLine, outputPath),
+                         start.scope,
+                         start.wallTime,
+                         GetWallTime() - start.wallTime,
+                         (childCpuTime < 0) ? (GetCpuTime() - start.cpuTime) : childCpuTime,
+                         commandLine });
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write the profile files, if profiling is enabled.
+ *
+ * @throw   legato::Exception on failure.
+ */
+//--------------------------------------------------------------------------------------------------
+void WriteProfile
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (!IsEnabled)
+    {
+        return;
+    }
+
+    double totalWallTime = GetWallTime();
+    double totalCpuTime = GetCpuTime();
+
+    legato::MakeDir(WorkingDir);
+
+    std::string tracePath = legato::CombinePath(WorkingDir, TraceFileName);
+    std::string summaryPath = legato::CombinePath(WorkingDir, SummaryFileName);
+
+    WriteTraceFile(tracePath);
+    WriteSummaryFile(summaryPath, totalWallTime, totalCpuTime);
+
+    std::cout << "Build profile written to '" << summaryPath << "' and '" << tracePath << "'."
+              << std::endl;
+}
+
+
+}  // namespace mk
@@ -0,0 +1,142 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * Build-time profiler used by the mk tools (enabled by the --profile option).
+ *
+ * Records the wall-clock time and CPU time taken by each phase of the build that mk does itself
+ * (parsing, building an app, a component or an executable, etc.) and by each build job (compile,
+ * link, mkif, copy, tar, etc.).  Each job is labelled with the phases that were in progress when
+ * it was started, so its time can be put down to the App, Component or Executable it was for.
+ *
+ * When the build is done, two files are written to the working (object file) directory:
+ *  - mk.profile.json, in Chrome's trace event format (load it in chrome://tracing), and
+ *  - mk.profile.txt, a text summary sorted by wall-clock time.
+ *
+ * Copyright (C) 2014, Sierra Wireless Inc.  Use of this work is subject to license.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#ifndef PROFILER_INCLUDE_GUARD_H
+#define PROFILER_INCLUDE_GUARD_H
+
+namespace mk
+{
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Where and when something that is being profiled was started.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    double wallTime;                ///< Wall-clock time (seconds since profiling was enabled).
+    double cpuTime;                 ///< CPU time used by the mk process so far (seconds).
+    std::list<std::string> scope;   ///< Phases that were in progress, outermost first
+                                    ///  (e.g. "app foo", "exe bar").
+}
+ProfileMark_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A phase of the build, for profiling.  The phase lasts as long as the object does.  Phases can
+ * be nested.  Does nothing if profiling isn't enabled.
+ */
+//--------------------------------------------------------------------------------------------------
+class ProfilePhase_t
+{
+    public:
+
+        ProfilePhase_t(const std::string& category, const std::string& name);
+        ~ProfilePhase_t();
+
+    private:
+
+        ProfilePhase_t(const ProfilePhase_t&) = delete;
+        ProfilePhase_t& operator=(const ProfilePhase_t&) = delete;
+
+        std::string m_Category;     ///< Kind of phase ("parse", "app", "component", "exe", ...)
+        std::string m_Name;         ///< Name of the phase (e.g., the app's name).
+        ProfileMark_t m_Start;      ///< When the phase started.
+};
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Enable profiling.  Must be called before anything is done that should be profiled.
+ */
+//--------------------------------------------------------------------------------------------------
+void EnableProfiling
+(
+    const std::string& workingDir   ///< Directory where the profile files will be written.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check whether profiling has been enabled.
+ *
+ * @return true if EnableProfiling() has been called.
+ */
+//--------------------------------------------------------------------------------------------------
+bool IsProfiling
+(
+    void
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Record when and where (in which phases) something is being started.
+ *
+ * @return The mark.
+ */
+//--------------------------------------------------------------------------------------------------
+ProfileMark_t MarkProfileStart
+(
+    void
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reset the time of a mark to now, keeping the phases it was made in.  Used for build jobs, which
+ * are labelled with the phases they were started in, but may not be run until later.
+ */
+//--------------------------------------------------------------------------------------------------
+void RestartProfileMark
+(
+    ProfileMark_t& mark
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Record a build job that has finished.  Does nothing if profiling isn't enabled.
+ */
+//--------------------------------------------------------------------------------------------------
+void RecordJobProfile
+(
+    const ProfileMark_t& start,         ///< Mark made when the job was started.
+    const std::string& commandLine,     ///< The job's command-line.
+    const std::string& outputPath,      ///< The job's (first) output file ("" if none).
+    double childCpuTime                 ///< CPU time used by the job's child processes (seconds),
+                                        ///  or a negative number if the job ran in mk itself.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write the profile files, if profiling is enabled.
+ *
+ * @throw   legato::Exception on failure.
+ */
+//--------------------------------------------------------------------------------------------------
+void WriteProfile
+(
+    void
+);
+
+
+}
+
+#endif // PROFILER_INCLUDE_GUARD_H
@@ -0,0 +1,696 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * Implementation of the tar archive writer used by the mk tools.
+ *
+ * Copyright (C) 2014, Sierra Wireless Inc.  Use of this work is subject to license.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include <vector>
+#include <algorithm>
+#include "LegatoObjectModel.h"
+#include "TarWriter.h"
+
+extern "C" {
+    #include <stdio.h>
+    #include <string.h>
+    #include <errno.h>
+    #include <unistd.h>
+    #include <dirent.h>
+    #include <pwd.h>
+    #include <grp.h>
+    #include <bzlib.h>
+}
+
+
+namespace mk
+{
+
+/// Size of a tar block.  Headers and file contents are padded to a whole number of blocks.
+static const size_t BlockSize = 512;
+
+/// Size of a tar record.  The archive is padded to a whole number of records (like GNU tar's
+/// default blocking factor of 20).
+static const size_t RecordSize = 20 * BlockSize;
+
+/// Name GNU tar uses for the pseudo-members that carry names too long for a header.
+static const char LongLinkName[] = "././@LongLink";
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Header block of a member of a tar archive, in GNU format.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    char name[100];
+    char mode[8];
+    char uid[8];
+    char gid[8];
+    char size[12];
+    char mtime[12];
+    char checksum[8];
+    char typeFlag;
+    char linkName[100];
+    char magic[8];                  ///< "ustar  " (GNU), including the version field.
+    char userName[32];
+    char groupName[32];
+    char devMajor[8];
+    char devMinor[8];
+    char padding[167];
+}
+TarHeader_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Tar archive file being written.
+ */
+//--------------------------------------------------------------------------------------------------
+class TarFile_t
+{
+    public:
+
+        TarFile_t(const std::string& path, bool isBzip2);
+        ~TarFile_t();
+
+        void AddTree(const std::string& dirPath, const std::string& memberName);
+        void Close();
+
+    private:
+
+        TarFile_t(const TarFile_t&) = delete;
+        TarFile_t& operator=(const TarFile_t&) = delete;
+
+        void Write(const void* dataPtr, size_t size);
+        void WritePadding(size_t size);
+        void WriteHeader(const std::string& name,
+                         const struct stat& fileStat,
+                         char typeFlag,
+                         uint64_t size,
+                         const std::string& linkName);
+        void WriteLongName(char typeFlag, const std::string& name);
+        void WriteFileContents(const std::string& path, uint64_t size);
+        void AddEntry(const std::string& path, const std::string& memberName);
+        const std::string& GetUserName(uid_t uid);
+        const std::string& GetGroupName(gid_t gid);
+
+        std::string m_Path;         ///< Path of the archive file.
+        FILE* m_FilePtr;            ///< The archive file (NULL once closed).
+        BZFILE* m_BzFilePtr;        ///< bzip2 stream written to the file (NULL = not compressed).
+        uint64_t m_Size;            ///< Number of (uncompressed) bytes written so far.
+        std::map<uid_t, std::string> m_UserNames;   ///< Names of user IDs looked up so far.
+        std::map<gid_t, std::string> m_GroupNames;  ///< Names of group IDs looked up so far.
+};
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Constructor.  Creates the archive file.
+ *
+ * @throw   legato::Exception on failure.
+ */
+//--------------------------------------------------------------------------------------------------
+TarFile_t::TarFile_t
+(
+    const std::string& path,
+    bool isBzip2
+)
+//--------------------------------------------------------------------------------------------------
+:   m_Path(path),
+    m_FilePtr(fopen(path.c_str(), "we")),
+    m_BzFilePtr(NULL),
+    m_Size(0)
+{
+    if (m_FilePtr == NULL)
+    {
+        throw legato::Exception("Failed to create '" + path + "' (" + strerror(errno) + ").");
+    }
+
+    if (isBzip2)
+    {
+        int bzError;
+
+        // Same block size (900k) as the bzip2 program uses by default.
+        m_BzFilePtr = BZ2_bzWriteOpen(&bzError, m_FilePtr, 9, 0, 0);
+
+        if (bzError != BZ_OK)
+        {
+            fclose(m_FilePtr);
+            m_FilePtr = NULL;
+
+            throw legato::Exception("Failed to start bzip2 compression of '" + path + "'.");
+        }
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Destructor.  Abandons the archive if it wasn't closed.
+ */
+//--------------------------------------------------------------------------------------------------
+TarFile_t::~TarFile_t
+(
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (m_BzFilePtr != NULL)
+    {
+        int bzError;
+
+        BZ2_bzWriteClose64(&bzError, m_BzFilePtr, 1 /* abandon */, NULL, NULL, NULL, NULL);
+    }
+
+    if (m_FilePtr != NULL)
+    {
+        fclose(m_FilePtr);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write data to the archive (compressing it, if the archive is compressed).
+ *
+ * @throw   legato::Exception on failure.
+ */
+//--------------------------------------------------------------------------------------------------
+void TarFile_t::Write
+(
+    const void* dataPtr,
+    size_t size
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (m_BzFilePtr != NULL)
+    {
+        int bzError;
+
+        BZ2_bzWrite(&bzError, m_BzFilePtr, const_cast<void*>(dataPtr), size);
+
+        if (bzError != BZ_OK)
+        {
+            throw legato::Exception("Failed to write to '" + m_Path + "' (bzip2 error "
+                                    + std::to_string(bzError) + ").");
+        }
+    }
+    else if (fwrite(dataPtr, 1, size, m_FilePtr) != size)
+    {
+        throw legato::Exception("Failed to write to '" + m_Path + "' (" + strerror(errno)
+                                + ").");
+    }
+
+    m_Size += size;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write zeros to the archive, to pad what was just written (of a given size) to a whole number
+ * of blocks.
+ *
+ * @throw   legato::Exception on failure.
+ */
+//--------------------------------------------------------------------------------------------------
+void TarFile_t::WritePadding
+(
+    size_t size
+)
+//--------------------------------------------------------------------------------------------------
+{
+    static const char zeros[BlockSize] = { 0 };
+
+    size_t remainder = size % BlockSize;
+
+    if (remainder != 0)
+    {
+        Write(zeros, BlockSize - remainder);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write a number into a header field, in octal, followed by a null character.
+ */
+//--------------------------------------------------------------------------------------------------
+template <size_t fieldSize>
+static void SetOctalField
+(
+    char (&field)[fieldSize],
+    uint64_t value
+)
+//--------------------------------------------------------------------------------------------------
+{
+    snprintf(field, fieldSize, "%0*llo", (int)(fieldSize - 1), (unsigned long long)value);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Copy a string into a header field, truncating it if it is too long.  If it fills the field,
+ * it isn't null-terminated.
+ */
+//--------------------------------------------------------------------------------------------------
+template <size_t fieldSize>
+static void SetStringField
+(
+    char (&field)[fieldSize],
+    const std::string& value
+)
+//--------------------------------------------------------------------------------------------------
+{
+    memcpy(field, value.c_str(), std::min(value.size(), fieldSize));
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write a member's header block.
+ *
+ * @throw   legato::Exception on failure.
+ */
+//--------------------------------------------------------------------------------------------------
+void TarFile_t::WriteHeader
+(
+    const std::string& name,        ///< Member name (truncated if too long).
+    const struct stat& fileStat,    ///< Status of the file the member was made from.
+    char typeFlag,                  ///< '0' = file, '2' = symbolic link, '5' = directory, etc.
+    uint64_t size,                  ///< Size of the member's contents.
+    const std::string& linkName     ///< Symbolic link target (truncated if too long).
+)
+//--------------------------------------------------------------------------------------------------
+{
+    // The largest size that fits in the 11 octal digits of the size field.
+    static const uint64_t maxSize = 077777777777ULL;
+
+    if (size > maxSize)
+    {
+        throw legato::Exception("File '" + name + "' is too big to put in a tar archive.");
+    }
+
+    TarHeader_t header;
+    memset(&header, 0, sizeof(header));
+
+    SetStringField(header.name, name);
+    SetOctalField(header.mode, fileStat.st_mode & 07777);
+    SetOctalField(header.uid, fileStat.st_uid);
+    SetOctalField(header.gid, fileStat.st_gid);
+    SetOctalField(header.size, size);
+    SetOctalField(header.mtime, (fileStat.st_mtime < 0) ? 0 : fileStat.st_mtime);
+    header.typeFlag = typeFlag;
+    SetStringField(header.linkName, linkName);
+    memcpy(header.magic, "ustar  ", sizeof(header.magic));
+    SetStringField(header.userName, GetUserName(fileStat.st_uid));
+    SetStringField(header.groupName, GetGroupName(fileStat.st_gid));
+
+    // The checksum is the sum of the header's bytes, counting the checksum field as spaces.
+    memset(header.checksum, ' ', sizeof(header.checksum));
+
+    unsigned int checksum = 0;
+    const unsigned char* bytePtr = reinterpret_cast<const unsigned char*>(&header);
+    for (size_t i = 0; i < sizeof(header); i++)
+    {
+        checksum += bytePtr[i];
+    }
+
+    snprintf(header.checksum, sizeof(header.checksum), "%06o", checksum);
+    header.checksum[7] = ' ';
+
+    Write(&header, sizeof(header));
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write a GNU long name pseudo-member, which holds the name or link target of the next member
+ * when it is too long to fit in the next member's header.
+ *
+ * @throw   legato::Exception on failure.
+ */
+//--------------------------------------------------------------------------------------------------
+void TarFile_t::WriteLongName
+(
+    char typeFlag,                  ///< 'L' = long member name, 'K' = long link target.
+    const std::string& name
+)
+//--------------------------------------------------------------------------------------------------
+{
+    struct stat fileStat;
+    memset(&fileStat, 0, sizeof(fileStat));
+
+    // The name is stored with its null terminator.
+    WriteHeader(LongLinkName, fileStat, typeFlag, name.size() + 1, "");
+    Write(name.c_str(), name.size() + 1);
+    WritePadding(name.size() + 1);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write the contents of a file as the contents of a member.
+ *
+ * @throw   legato::Exception on failure, or if the file's size changes while it is being read.
+ */
+//--------------------------------------------------------------------------------------------------
+void TarFile_t::WriteFileContents
+(
+    const std::string& path,
+    uint64_t size                   ///< Size given in the member's header.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+
+    if (fd < 0)
+    {
+        throw legato::Exception("Failed to open '" + path + "' (" + strerror(errno) + ").");
+    }
+
+    std::vector<char> buffer(64 * 1024);
+    uint64_t remaining = size;
+
+    try
+    {
+        while (remaining > 0)
+        {
+            ssize_t bytesRead = read(fd, buffer.data(), std::min<uint64_t>(remaining,
+                                                                           buffer.size()));
+            if (bytesRead < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+
+                throw legato::Exception("Failed to read '" + path + "' (" + strerror(errno)
+                                        + ").");
+            }
+            else if (bytesRead == 0)
+            {
+                throw legato::Exception("File '" + path + "' shrank while it was being"
+                                        " archived.");
+            }
+
+            Write(buffer.data(), bytesRead);
+            remaining -= bytesRead;
+        }
+    }
+    catch (...)
+    {
+        close(fd);
+        throw;
+    }
+
+    close(fd);
+
+    WritePadding(size);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add a file system object to the archive (and, if it is a directory, everything in it).
+ *
+ * @throw   legato::Exception on failure.
+ */
+//--------------------------------------------------------------------------------------------------
+void TarFile_t::AddEntry
+(
+    const std::string& path,
+    const std::string& memberName
+)
+//--------------------------------------------------------------------------------------------------
+{
+    struct stat fileStat;
+
+    if (lstat(path.c_str(), &fileStat) != 0)
+    {
+        throw legato::Exception("Can't archive '" + path + "' (" + strerror(errno) + ").");
+    }
+
+    if (S_ISDIR(fileStat.st_mode))
+    {
+        AddTree(path, memberName);
+        return;
+    }
+
+    std::string linkName;
+    uint64_t size = 0;
+    char typeFlag;
+
+    if (S_ISREG(fileStat.st_mode))
+    {
+        typeFlag = '0';
+        size = fileStat.st_size;
+    }
+    else if (S_ISLNK(fileStat.st_mode))
+    {
+        typeFlag = '2';
+
+        std::vector<char> target(fileStat.st_size + 1);
+        ssize_t length = readlink(path.c_str(), target.data(), target.size());
+
+        if ((length < 0) || ((size_t)length >= target.size()))
+        {
+            throw legato::Exception("Failed to read symbolic link '" + path + "'.");
+        }
+
+        linkName.assign(target.data(), length);
+    }
+    else if (S_ISFIFO(fileStat.st_mode))
+    {
+        typeFlag = '6';
+    }
+    else
+    {
+        throw legato::Exception("Can't archive '" + path + "': not a file, directory, symbolic"
+                                " link or FIFO.");
+    }
+
+    if (linkName.size() > sizeof(TarHeader_t().linkName))
+    {
+        WriteLongName('K', linkName);
+    }
+    if (memberName.size() > sizeof(TarHeader_t().name))
+    {
+        WriteLongName('L', memberName);
+    }
+
+    WriteHeader(memberName, fileStat, typeFlag, size, linkName);
+
+    if (size > 0)
+    {
+        WriteFileContents(path, size);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add a directory and everything in it to the archive.
+ *
+ * @throw   legato::Exception on failure.
+ */
+//--------------------------------------------------------------------------------------------------
+void TarFile_t::AddTree
+(
+    const std::string& dirPath,
+    const std::string& memberName   ///< Member name of the directory (e.g., ".").
+)
+//--------------------------------------------------------------------------------------------------
+{
+    struct stat dirStat;
+
+    if (stat(dirPath.c_str(), &dirStat) != 0)
+    {
+        throw legato::Exception("Can't archive '" + dirPath + "' (" + strerror(errno) + ").");
+    }
+
+    // Directory member names end with a slash.
+    std::string dirName = memberName + "/";
+
+    if (dirName.size() > sizeof(TarHeader_t().name))
+    {
+        WriteLongName('L', dirName);
+    }
+
+    WriteHeader(dirName, dirStat, '5', 0, "");
+
+    DIR* dirPtr = opendir(dirPath.c_str());
+
+    if (dirPtr == NULL)
+    {
+        throw legato::Exception("Failed to open directory '" + dirPath + "' (" + strerror(errno)
+                                + ").");
+    }
+
+    std::vector<std::string> names;
+    struct dirent* entryPtr;
+
+    while ((entryPtr = readdir(dirPtr)) != NULL)
+    {
+        if ((strcmp(entryPtr->d_name, ".") != 0) && (strcmp(entryPtr->d_name, "..") != 0))
+        {
+            names.push_back(entryPtr->d_name);
+        }
+    }
+
+    closedir(dirPtr);
+
+    std::sort(names.begin(), names.end());
+
+    for (const auto& name : names)
+    {
+        AddEntry(legato::CombinePath(dirPath, name), dirName + name);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Finish the archive: write the end-of-archive blocks, pad it to a whole number of records and
+ * close the file.
+ *
+ * @throw   legato::Exception on failure.
+ */
+//--------------------------------------------------------------------------------------------------
+void TarFile_t::Close
+(
+)
+//--------------------------------------------------------------------------------------------------
+{
+    static const char zeros[BlockSize] = { 0 };
+
+    // Two empty blocks mark the end of the archive.
+    Write(zeros, BlockSize);
+    Write(zeros, BlockSize);
+
+    while ((m_Size % RecordSize) != 0)
+    {
+        Write(zeros, BlockSize);
+    }
+
+    if (m_BzFilePtr != NULL)
+    {
+        int bzError;
+
+        BZ2_bzWriteClose64(&bzError, m_BzFilePtr, 0, NULL, NULL, NULL, NULL);
+        m_BzFilePtr = NULL;
+
+        if (bzError != BZ_OK)
+        {
+            throw legato::Exception("Failed to finish bzip2 compression of '" + m_Path + "'.");
+        }
+    }
+
+    int result = fclose(m_FilePtr);
+    m_FilePtr = NULL;
+
+    if (result != 0)
+    {
+        throw legato::Exception("Failed to write to '" + m_Path + "' (" + strerror(errno)
+                                + ").");
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the name of a user, for a member header.
+ *
+ * @return The name, or "" if the user ID has no name.
+ */
+//--------------------------------------------------------------------------------------------------
+const std::string& TarFile_t::GetUserName
+(
+    uid_t uid
+)
+//--------------------------------------------------------------------------------------------------
+{
+    auto i = m_UserNames.find(uid);
+
+    if (i == m_UserNames.end())
+    {
+        struct passwd* entryPtr = getpwuid(uid);
+
+        i = m_UserNames.insert(std::make_pair(uid,
+                                              entryPtr ? entryPtr->pw_name : "")).first;
+    }
+
+    return i->second;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the name of a group, for a member header.
+ *
+ * @return The name, or "" if the group ID has no name.
+ */
+//--------------------------------------------------------------------------------------------------
+const std::string& TarFile_t::GetGroupName
+(
+    gid_t gid
+)
+//--------------------------------------------------------------------------------------------------
+{
+    auto i = m_GroupNames.find(gid);
+
+    if (i == m_GroupNames.end())
+    {
+        struct group* entryPtr = getgrgid(gid);
+
+        i = m_GroupNames.insert(std::make_pair(gid,
+                                               entryPtr ? entryPtr->gr_name : "")).first;
+    }
+
+    return i->second;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write everything in a directory to a tar archive file.  The file is replaced only once the
+ * whole archive has been written.
+ *
+ * @throw   legato::Exception on failure.
+ */
+//--------------------------------------------------------------------------------------------------
+void WriteTarFile
+(
+    const std::string& dirPath,     ///< Directory whose contents are to be archived.
+    const std::string& outputPath,  ///< Path of the archive file.
+    bool isBzip2                    ///< true = compress the archive with bzip2 (like "tar cjf").
+)
+//--------------------------------------------------------------------------------------------------
+{
+    std::string tempPath = outputPath + ".tmp";
+
+    try
+    {
+        TarFile_t tarFile(tempPath, isBzip2);
+
+        tarFile.AddTree(dirPath, ".");
+        tarFile.Close();
+    }
+    catch (...)
+    {
+        unlink(tempPath.c_str());
+        throw;
+    }
+
+    if (rename(tempPath.c_str(), outputPath.c_str()) != 0)
+    {
+        int error = errno;
+        unlink(tempPath.c_str());
+
+        throw legato::Exception("Failed to replace '" + outputPath + "' (" + strerror(error)
+                                + ").");
+    }
+}
+
+
+}  // namespace mk
@@ -0,0 +1,37 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * Tar archive writer used by the mk tools to package staging directories, so that packaging
+ * doesn't have to run tar (and bzip2) in a shell.
+ *
+ * The archives are in GNU tar format, with the same member names that "tar cf <file> -C <dir> ."
+ * would give them ("./", "./bin/", "./bin/foo", ...).  Directory entries are written in sorted
+ * order, so the same directory contents always give the same archive.
+ *
+ * Copyright (C) 2014, Sierra Wireless Inc.  Use of this work is subject to license.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#ifndef TAR_WRITER_INCLUDE_GUARD_H
+#define TAR_WRITER_INCLUDE_GUARD_H
+
+namespace mk
+{
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write everything in a directory to a tar archive file.  The file is replaced only once the
+ * whole archive has been written.
+ *
+ * @throw   legato::Exception on failure.
+ */
+//--------------------------------------------------------------------------------------------------
+void WriteTarFile
+(
+    const std::string& dirPath,     ///< Directory whose contents are to be archived.
+    const std::string& outputPath,  ///< Path of the archive file.
+    bool isBzip2                    ///< true = compress the archive with bzip2 (like "tar cjf").
+);
+
+}
+
+#endif // TAR_WRITER_INCLUDE_GUARD_H
@@ -16,6 +16,9 @@
 #include <list>
 #include "LegatoObjectModel.h"
 #include "Utilities.h"
+#include "JobScheduler.h"
+#include "BuildState.h"
+#include "NativeCommands.h"
 #include "../Parser/Parser.h"
 #include <string.h>
 
@@ -31,6 +34,12 @@ namespace mk
 /// Map of API file paths (after env var substitution) to protocol hashes.
 static std::map<std::string, std::string> ApiHashCache;
 
+/// Map of compiler paths to the sysroot paths they reported.
+static std::map<std::string, std::string> SysRootCache;
+
+/// Map of compiler paths to whether they can do link-time optimization.
+static std::map<std::string, bool> LtoSupportCache;
+
 
 //--------------------------------------------------------------------------------------------------
 /**
@@ -269,7 +278,8 @@ std::string GetArchiverPath
 
 //----------------------------------------------------------------------------------------------
 /**
- * Get the sysroot path to use when linking for a given compiler.
+ * Get the sysroot path to use when linking for a given compiler.  Each compiler is only asked
+ * once; after that, the answer is remembered.
  *
  * @return  The path to the sysroot base directory.
  *
@@ -288,6 +298,12 @@ std::string GetSysRootPath
         return "/";
     }
 
+    auto i = SysRootCache.find(compilerPath);
+    if (i != SysRootCache.end())
+    {
+        return i->second;
+    }
+
     std::string commandLine = compilerPath + " --print-sysroot";
 
     FILE* output = popen(commandLine.c_str(), "r");
@@ -347,10 +363,128 @@ std::string GetSysRootPath
         throw legato::Exception(msg.str());
     }
 
+    SysRootCache[compilerPath] = buffer;
+
     return buffer;
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check whether a compiler (and the linker it uses) can do link-time optimization, by having it
+ * build a trivial program with -flto.  Each compiler is only checked once.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool IsLtoSupported
+(
+    const std::string& compilerPath
+)
+//--------------------------------------------------------------------------------------------------
+{
+    auto i = LtoSupportCache.find(compilerPath);
+    if (i != LtoSupportCache.end())
+    {
+        return i->second;
+    }
+
+    std::string commandLine = "echo 'int main(void) { return 0; }' | " + compilerPath
+                            + " -flto -x c - -o /dev/null > /dev/null 2>&1";
+
+    bool isSupported = (system(commandLine.c_str()) == EXIT_SUCCESS);
+
+    LtoSupportCache[compilerPath] = isSupported;
+
+    return isSupported;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set the optimization goal given on the command-line in the build parameters.
+ *
+ * @throw   std::runtime_error if the goal isn't "size", "speed" or "" (none).
+ */
+//--------------------------------------------------------------------------------------------------
+void SetOptimizationGoal
+(
+    legato::BuildParams_t& buildParams,
+    const std::string& goal
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if ((goal != "") && (goal != "size") && (goal != "speed"))
+    {
+        throw std::runtime_error("Unknown optimization goal '" + goal + "' (must be 'size' or"
+                                 " 'speed').");
+    }
+
+    buildParams.Optimization(goal);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Print to a given output stream the compiler flags for the optimization goal given in the build
+ * parameters (if any): the optimization level, one section per function and data object (so the
+ * linker can drop what isn't used), and link-time optimization if the compiler supports it.
+ */
+//--------------------------------------------------------------------------------------------------
+void GetOptimizationCompileFlags
+(
+    std::ostream& outputStream,
+    const std::string& compilerPath,
+    const legato::BuildParams_t& buildParams
+)
+//--------------------------------------------------------------------------------------------------
+{
+    const std::string& goal = buildParams.Optimization();
+
+    if (goal.empty())
+    {
+        return;
+    }
+
+    outputStream << ((goal == "size") ? " -Os" : " -O2")
+                 << " -ffunction-sections -fdata-sections";
+
+    if (IsLtoSupported(compilerPath))
+    {
+        outputStream << " -flto";
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Print to a given output stream the linker flags for the optimization goal given in the build
+ * parameters (if any).  Code is generated at link time when link-time optimization is used, so
+ * these include the optimization level too.
+ */
+//--------------------------------------------------------------------------------------------------
+void GetOptimizationLinkFlags
+(
+    std::ostream& outputStream,
+    const std::string& compilerPath,
+    const legato::BuildParams_t& buildParams
+)
+//--------------------------------------------------------------------------------------------------
+{
+    const std::string& goal = buildParams.Optimization();
+
+    if (goal.empty())
+    {
+        return;
+    }
+
+    outputStream << ((goal == "size") ? " -Os" : " -O2") << " -Wl,--gc-sections";
+
+    if (IsLtoSupported(compilerPath))
+    {
+        outputStream << " -flto";
+    }
+}
+
+
 //----------------------------------------------------------------------------------------------
 /**
  * Adds target-specific environment variables (e.g., LEGATO_TARGET) to the process's environment.
@@ -393,7 +527,91 @@ void SetTargetSpecificEnvVars
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Execute a shell command-line string.
+ * Split a command-line into arguments, the way the shell does for simple command-lines: white
+ * space separates arguments, except inside single or double quotes, and a backslash escapes the
+ * next character (inside double quotes, only if it is special there).
+ *
+ * @return The arguments.
+ *
+ * @throw legato::Exception if there is no closing quote.
+ */
+//--------------------------------------------------------------------------------------------------
+std::vector<std::string> SplitCommandLine
+(
+    const std::string& commandLine
+)
+//--------------------------------------------------------------------------------------------------
+{
+    std::vector<std::string> args;
+    std::string arg;
+    bool isInArg = false;
+    size_t i = 0;
+
+    while (i < commandLine.size())
+    {
+        char c = commandLine[i++];
+
+        if (isspace(c))
+        {
+            if (isInArg)
+            {
+                args.push_back(arg);
+                arg.clear();
+                isInArg = false;
+            }
+            continue;
+        }
+
+        isInArg = true;
+
+        if (c == '\\')
+        {
+            if (i < commandLine.size())
+            {
+                arg += commandLine[i++];
+            }
+        }
+        else if ((c == '\'') || (c == '"'))
+        {
+            size_t endPos = i;
+            while ((endPos < commandLine.size()) && (commandLine[endPos] != c))
+            {
+                if (   (c == '"')
+                    && (commandLine[endPos] == '\\')
+                    && (endPos + 1 < commandLine.size())
+                    && (strchr("\\\"$`", commandLine[endPos + 1]) != NULL))
+                {
+                    endPos++;
+                }
+                arg += commandLine[endPos++];
+            }
+
+            if (endPos >= commandLine.size())
+            {
+                throw legato::Exception("No closing quotation in command-line: " + commandLine);
+            }
+
+            i = endPos + 1;
+        }
+        else
+        {
+            arg += c;
+        }
+    }
+
+    if (isInArg)
+    {
+        args.push_back(arg);
+    }
+
+    return args;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Execute a shell command-line string.  Waits for all build jobs that have already been started
+ * to finish first, so the command sees all their outputs.
  *
  * @throw   legato::Exception on failure.
  */
@@ -404,6 +622,8 @@ void ExecuteCommandLine
 )
 //--------------------------------------------------------------------------------------------------
 {
+    WaitForJobs();
+
     int ret = system(commandLine.c_str());
 
     if (ret != EXIT_SUCCESS)
@@ -483,6 +703,136 @@ const std::string& WatchdogApiHash
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Clean a staging directory, unless nothing that determines what goes into it has changed since it
+ * was last cleaned.
+ *
+ * Files can only be left over in the staging directory from a previous build if something was
+ * removed from a definition file, a file was removed from a bundled directory, or the build
+ * parameters changed what gets built (e.g., static linking leaves out the component libraries).
+ * If none of those have changed, everything in the staging directory will be overwritten or left
+ * as it is, and it doesn't need to be rebuilt from scratch.
+ **/
+//--------------------------------------------------------------------------------------------------
+void CleanStagingDir
+(
+    const std::string& stagingDirPath,          ///< Build host file system path to staging dir.
+    const std::list<std::string>& defFiles,     ///< Paths of the .adef/.cdef/.sdef files.
+    const std::list<std::string>& bundledDirs,  ///< Paths of directories bundled into staging.
+    const legato::BuildParams_t& buildParams
+)
+//--------------------------------------------------------------------------------------------------
+{
+    // The build parameters and the names of the files in the bundled directories go in the key,
+    // so a change to any of them makes the clean step out of date, just like a change to the
+    // contents of a definition file does.
+    std::ostringstream key;
+
+    key << "clean " << stagingDirPath
+        << "\ntarget " << buildParams.Target()
+        << "\ncflags " << buildParams.CCompilerFlags()
+        << "\ncxxflags " << buildParams.CxxCompilerFlags()
+        << "\nldflags " << buildParams.LinkerFlags()
+        << "\nstatic " << buildParams.DoStaticLink()
+        << "\noptimize " << buildParams.Optimization();
+
+    for (const auto& dirPath : buildParams.InterfaceDirs())
+    {
+        key << "\ninterface dir " << dirPath;
+    }
+
+    for (const auto& dirPath : buildParams.SourceDirs())
+    {
+        key << "\nsource dir " << dirPath;
+    }
+
+    for (const auto& dirPath : bundledDirs)
+    {
+        key << "\nbundled dir " << dirPath;
+
+        for (const auto& filePath : GetFilesInDir(dirPath))
+        {
+            key << "\n  " << filePath;
+        }
+    }
+
+    // When generating a build file, anything left in the staging directory would be taken to be
+    // something that mk put there itself, so always start from scratch.
+    if (IsRecordingJobs() || !IsUpToDate(key.str(), defFiles, { stagingDirPath }))
+    {
+        InputSnapshot_t snapshot = SnapshotInputs(defFiles);
+
+        legato::CleanDir(stagingDirPath);
+
+        MarkUpToDate(key.str(), snapshot);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Run a command-line that packages the contents of a staging directory, unless nothing in the
+ * staging directory has changed since the last time it was run.
+ *
+ * @throw   legato::Exception on failure.
+ **/
+//--------------------------------------------------------------------------------------------------
+void PackageStagingDir
+(
+    const std::string& commandLine,     ///< Command-line that creates the package.
+    const std::string& stagingDirPath,  ///< Build host file system path to staging directory.
+    const std::string& outputPath       ///< Path of the package file.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    // When generating a build file, the staging directory hasn't been filled yet, so the package
+    // is made from whatever the recorded jobs will put in it, plus anything that mk has put
+    // there itself.
+    if (IsRecordingJobs())
+    {
+        std::list<std::string> inputs = GetFilesInDir(stagingDirPath);
+        std::string dirPrefix = stagingDirPath + "/";
+
+        for (const auto& job : GetRecordedJobs())
+        {
+            for (const auto& path : job.outputs)
+            {
+                if (path.compare(0, dirPrefix.length(), dirPrefix) == 0)
+                {
+                    inputs.push_back(path);
+                }
+            }
+        }
+
+        StartJob(commandLine, inputs, { outputPath });
+
+        return;
+    }
+
+    // Everything has to be in the staging directory before we can tell if it has changed.
+    WaitForJobs();
+
+    std::list<std::string> stagedFiles = GetFilesInDir(stagingDirPath);
+
+    if (!IsUpToDate(commandLine, stagedFiles, { outputPath }))
+    {
+        InputSnapshot_t snapshot = SnapshotInputs(stagedFiles);
+
+        if (IsNativeCommandLine(commandLine))
+        {
+            RunNativeCommandLine(commandLine);
+        }
+        else
+        {
+            ExecuteCommandLine(commandLine);
+        }
+
+        MarkUpToDate(commandLine, snapshot);
+    }
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Copy a file or directory from the build host's file system to the application's staging
@@ -508,16 +858,29 @@ void CopyToStaging
     auto pos = destPath.rfind('/');
     legato::MakeDir(destPath.substr(0, pos));
 
-    // Construct the copy shell command to use.
+    // Construct the copy shell command to use.  (When mk runs it, it does the copy itself; see
+    // NativeCommands.h.)
+    // NOTE: A directory is copied as "<source>/.", so that if the staging directory wasn't cleaned
+    //       and the destination directory is already there, the source directory's contents are
+    //       copied over it, instead of into a new sub-directory of it.
     std::string copyCommand = "cp";
+    std::list<std::string> inputs = { sourcePath };
 
     if (isDirectory)
     {
         copyCommand += " -r";
+
+        inputs.splice(inputs.end(), GetFilesInDir(sourcePath));
     }
 
     copyCommand += " \"";
     copyCommand += sourcePath;
+
+    if (isDirectory)
+    {
+        copyCommand += "/.";
+    }
+
     copyCommand += "\" \"";
     copyCommand += destPath;
     copyCommand += "\"";
@@ -527,7 +890,9 @@ void CopyToStaging
         std::cout << std::endl << "$ " << copyCommand << std::endl << std::endl;
     }
 
-    mk::ExecuteCommandLine(copyCommand);
+    // Copies into the same staging directory are done in order, so if more than one thing is
+    // copied to the same place, the last one wins, as it would if they were done one at a time.
+    mk::StartJob(copyCommand, inputs, { stagingDirPath, destPath });
 }
 
 
@@ -605,4 +970,47 @@ void GetComponentLibLinkDirectives
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add to a list the paths of the library files bundled by a given Component and all its
+ * sub-components (the prebuilt libraries that GetComponentLibLinkDirectives() links with).
+ **/
+//--------------------------------------------------------------------------------------------------
+void GetComponentBundledLibs
+(
+    std::list<std::string>& libs,
+    const legato::Component& component
+)
+//--------------------------------------------------------------------------------------------------
+{
+    for (const auto& lib : component.BundledLibs())
+    {
+        libs.push_back(lib);
+    }
+
+    for (const auto& mapEntry : component.SubComponents())
+    {
+        GetComponentBundledLibs(libs, *mapEntry.second);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the path of the Legato C runtime library (liblegato.so) that is linked with everything
+ * built for the current target.
+ *
+ * @throw   Exception if LEGATO_BUILD hasn't been set (see SetTargetSpecificEnvVars()).
+ **/
+//--------------------------------------------------------------------------------------------------
+std::string GetLegatoLibPath
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    return legato::CombinePath(GetRequiredEnvValue("LEGATO_BUILD"), "bin/lib/liblegato.so");
+}
+
+
 }  // namespace mk
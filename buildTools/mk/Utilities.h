@@ -74,7 +74,8 @@ std::string GetArchiverPath
 
 //----------------------------------------------------------------------------------------------
 /**
- * Get the sysroot path to use when linking for a given compiler.
+ * Get the sysroot path to use when linking for a given compiler.  Each compiler is only asked
+ * once; after that, the answer is remembered.
  *
  * @return  The path to the sysroot base directory.
  *
@@ -87,6 +88,50 @@ std::string GetSysRootPath
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set the optimization goal given on the command-line in the build parameters.
+ *
+ * @throw   std::runtime_error if the goal isn't "size", "speed" or "" (none).
+ */
+//--------------------------------------------------------------------------------------------------
+void SetOptimizationGoal
+(
+    legato::BuildParams_t& buildParams,
+    const std::string& goal
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Print to a given output stream the compiler flags for the optimization goal given in the build
+ * parameters (if any): the optimization level, one section per function and data object (so the
+ * linker can drop what isn't used), and link-time optimization if the compiler supports it.
+ */
+//--------------------------------------------------------------------------------------------------
+void GetOptimizationCompileFlags
+(
+    std::ostream& outputStream,
+    const std::string& compilerPath,
+    const legato::BuildParams_t& buildParams
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Print to a given output stream the linker flags for the optimization goal given in the build
+ * parameters (if any).  Code is generated at link time when link-time optimization is used, so
+ * these include the optimization level too.
+ */
+//--------------------------------------------------------------------------------------------------
+void GetOptimizationLinkFlags
+(
+    std::ostream& outputStream,
+    const std::string& compilerPath,
+    const legato::BuildParams_t& buildParams
+);
+
+
 //----------------------------------------------------------------------------------------------
 /**
  * Adds target-specific environment variables (e.g., LEGATO_TARGET) to the process's environment.
@@ -102,6 +147,23 @@ void SetTargetSpecificEnvVars
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Split a command-line into arguments, the way the shell does for simple command-lines: white
+ * space separates arguments, except inside single or double quotes, and a backslash escapes the
+ * next character (inside double quotes, only if it is special there).
+ *
+ * @return The arguments.
+ *
+ * @throw legato::Exception if there is no closing quote.
+ */
+//--------------------------------------------------------------------------------------------------
+std::vector<std::string> SplitCommandLine
+(
+    const std::string& commandLine
+);
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Execute a shell command-line string.
@@ -154,6 +216,38 @@ const std::string& WatchdogApiHash
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Clean a staging directory, unless nothing that determines what goes into it (definition files,
+ * the names of the files in bundled directories and the build parameters) has changed since it
+ * was last cleaned.
+ **/
+//--------------------------------------------------------------------------------------------------
+void CleanStagingDir
+(
+    const std::string& stagingDirPath,          ///< Build host file system path to staging dir.
+    const std::list<std::string>& defFiles,     ///< Paths of the .adef/.cdef/.sdef files.
+    const std::list<std::string>& bundledDirs,  ///< Paths of directories bundled into staging.
+    const legato::BuildParams_t& buildParams
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Run a command-line that packages the contents of a staging directory, unless nothing in the
+ * staging directory has changed since the last time it was run.
+ *
+ * @throw   legato::Exception on failure.
+ **/
+//--------------------------------------------------------------------------------------------------
+void PackageStagingDir
+(
+    const std::string& commandLine,     ///< Command-line that creates the package.
+    const std::string& stagingDirPath,  ///< Build host file system path to staging directory.
+    const std::string& outputPath       ///< Path of the package file.
+);
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Copy a file or directory from the build host's file system to the application's staging
@@ -195,6 +289,31 @@ void GetComponentLibLinkDirectives
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add to a list the paths of the library files bundled by a given Component and all its
+ * sub-components (the prebuilt libraries that GetComponentLibLinkDirectives() links with).
+ **/
+//--------------------------------------------------------------------------------------------------
+void GetComponentBundledLibs
+(
+    std::list<std::string>& libs,
+    const legato::Component& component
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the path of the Legato C runtime library (liblegato.so) that is linked with everything
+ * built for the current target.
+ **/
+//--------------------------------------------------------------------------------------------------
+std::string GetLegatoLibPath
+(
+    void
+);
+
+
 
 }
 
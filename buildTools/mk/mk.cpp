@@ -12,11 +12,15 @@
 #include <stdexcept>
 
 #include "LegatoObjectModel.h"
-//#include "mkif.h"
+#include "mkif.h"
 #include "mkcomp.h"
 #include "mkexe.h"
 #include "mkapp.h"
 #include "mksys.h"
+#include "JobScheduler.h"
+#include "BuildState.h"
+#include "Profiler.h"
+#include "BuildFileGenerator.h"
 
 using namespace legato;
 
@@ -47,15 +51,47 @@ int main(int argc, const char** argv)
         {
             MakeSystem(argc, argv);
         }
+        else if (fileName == "mkif")
+        {
+            MakeInterface(argc, argv);
+        }
         else
         {
             std::cerr << "*** ERROR: unknown command name '" << fileName << "'." << std::endl;
             return EXIT_FAILURE;
         }
+
+        // Wait for any build steps that are still running.
+        {
+            mk::ProfilePhase_t phase("wait", "jobs");
+            mk::WaitForJobs();
+        }
+
+        // If a build file was asked for instead of a build, write it now.
+        mk::GenerateBuildFile(argc, argv);
+
+        // Remember what was built, so it won't be built again next time unless it has to be.
+        mk::SaveBuildState();
+
+        // If a profile of the build was asked for, write it now.
+        mk::WriteProfile();
     }
     catch (std::runtime_error& e)
     {
         std::cerr << "** ERROR: " << e.what() << std::endl;
+
+        // Let the steps that are running finish, and still remember the ones that did succeed.
+        try
+        {
+            mk::StopJobs();
+            mk::SaveBuildState();
+            mk::WriteProfile();
+        }
+        catch (std::runtime_error& saveError)
+        {
+            std::cerr << "** ERROR: " << saveError.what() << std::endl;
+        }
+
         return EXIT_FAILURE;
     }
 
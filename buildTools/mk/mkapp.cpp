@@ -23,6 +23,10 @@
 #include "mkapp.h"
 #include "ApplicationBuilder.h"
 #include "Utilities.h"
+#include "JobScheduler.h"
+#include "BuildState.h"
+#include "Profiler.h"
+#include "BuildFileGenerator.h"
 
 
 /// Object that stores build parameters that we gather.
@@ -58,6 +62,21 @@ static void GetCommandLineArgs
     std::string target;
     bool isVerbose = false;
 
+    // Maximum number of build jobs to run at the same time (0 = one per CPU).
+    int jobCount = 0;
+
+    // true = rebuild everything, even if it looks up to date.
+    bool isForced = false;
+
+    // true = write a profile of where the build's time went.
+    bool isProfiling = false;
+
+    // Name of the build tool to generate a build file for ("" = build now).
+    std::string generator;
+
+    // What to optimize the code for ("size", "speed" or "" = don't optimize).
+    std::string optimization;
+
     // Path to the directory where intermediate build output files (such as generated
     // source code and object code files) should be put.
     std::string objectFilesDir;
@@ -161,6 +180,39 @@ static void GetCommandLineArgs
                            "verbose",
                            "Set into verbose mode for extra diagnostic information.");
 
+    le_arg_AddOptionalInt(&jobCount,
+                          0,
+                          'j',
+                          "jobs",
+                          "Run up to this many build steps (and definition file parses) in parallel"
+                          " (default: one per CPU).");
+
+    le_arg_AddOptionalFlag(&isForced,
+                           'f',
+                           "force",
+                           "Rebuild everything, even things that are already up to date.");
+
+    le_arg_AddOptionalFlag(&isProfiling,
+                           'P',
+                           "profile",
+                           "Record how long each build step takes, and write a report"
+                           " (mk.profile.txt and mk.profile.json) to the working directory.");
+
+    le_arg_AddOptionalString(&optimization,
+                             "",
+                             'O',
+                             "optimize",
+                             "Optimize for 'size' or 'speed': drop unused code and data, use"
+                             " link-time optimization if the compiler supports it, and link"
+                             " components statically into executables.");
+
+    le_arg_AddOptionalString(&generator,
+                             "",
+                             'g',
+                             "generate",
+                             "Generate a build file for the given build tool (ninja) instead of"
+                             " building.");
+
     le_arg_AddMultipleString('C',
                              "cflags",
                              "Specify extra flags to be passed to the C compiler.",
@@ -196,6 +248,15 @@ static void GetCommandLineArgs
         objectFilesDir = "./_build_" + App.Name() + "/" + target;
     }
     BuildParams.ObjOutputDir(objectFilesDir);
+    if (isProfiling)
+    {
+        mk::EnableProfiling(BuildParams.ObjOutputDir());
+    }
+    mk::LoadBuildState(BuildParams.ObjOutputDir(), isForced);
+    if (!generator.empty())
+    {
+        mk::SetBuildFileGenerator(generator, BuildParams.ObjOutputDir());
+    }
     BuildParams.StagingDir(legato::CombinePath(objectFilesDir, "staging"));
 
     // Add the directory containing the .adef file to the list of source search directories
@@ -209,10 +270,14 @@ static void GetCommandLineArgs
     {
         BuildParams.SetVerbose();
     }
+    mk::SetMaxJobs(jobCount);
+    legato::parser::SetMaxParseThreads(jobCount);
     BuildParams.SetTarget(target);
     BuildParams.CCompilerFlags(cFlags);
     BuildParams.CxxCompilerFlags(cxxFlags);
     BuildParams.LinkerFlags(ldFlags);
+    mk::SetOptimizationGoal(BuildParams, optimization);
+    BuildParams.DoStaticLink(!optimization.empty());
 }
 
 
@@ -230,7 +295,10 @@ static void ConstructObjectModel
 {
     // Parse the .adef file and any Component.cdef files that it refers to.
     // This constructs the object model under the App object that we give it.
-    legato::parser::ParseApp(&App, BuildParams);
+    {
+        mk::ProfilePhase_t phase("parse", App.Name());
+        legato::parser::ParseApp(&App, BuildParams);
+    }
 
     // Append the version suffix to the App's version.
     if (VersionSuffix != "")
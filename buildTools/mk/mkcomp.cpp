@@ -16,6 +16,10 @@
 #include "ComponentBuilder.h"
 #include "InterfaceBuilder.h"
 #include "Utilities.h"
+#include "JobScheduler.h"
+#include "BuildState.h"
+#include "Profiler.h"
+#include "BuildFileGenerator.h"
 
 
 /// Object that stores build parameters that we gather.
@@ -51,6 +55,21 @@ static void GetCommandLineArgs
     // Non-zero = say what we are doing on stdout.
     bool isVerbose = false;
 
+    // Maximum number of build jobs to run at the same time (0 = one per CPU).
+    int jobCount = 0;
+
+    // true = rebuild everything, even if it looks up to date.
+    bool isForced = false;
+
+    // true = write a profile of where the build's time went.
+    bool isProfiling = false;
+
+    // Name of the build tool to generate a build file for ("" = build now).
+    std::string generator;
+
+    // What to optimize the code for ("size", "speed" or "" = don't optimize).
+    std::string optimization;
+
     // Full path of the library file to be generated. "" = use default file name.
     std::string buildOutputPath = "";
 
@@ -150,6 +169,38 @@ static void GetCommandLineArgs
                            "verbose",
                            "Set into verbose mode for extra diagnostic information.");
 
+    le_arg_AddOptionalInt(&jobCount,
+                          0,
+                          'j',
+                          "jobs",
+                          "Run up to this many build steps (and definition file parses) in parallel"
+                          " (default: one per CPU).");
+
+    le_arg_AddOptionalFlag(&isForced,
+                           'f',
+                           "force",
+                           "Rebuild everything, even things that are already up to date.");
+
+    le_arg_AddOptionalFlag(&isProfiling,
+                           'P',
+                           "profile",
+                           "Record how long each build step takes, and write a report"
+                           " (mk.profile.txt and mk.profile.json) to the working directory.");
+
+    le_arg_AddOptionalString(&optimization,
+                             "",
+                             'O',
+                             "optimize",
+                             "Optimize for 'size' or 'speed': drop unused code and data, and use"
+                             " link-time optimization if the compiler supports it.");
+
+    le_arg_AddOptionalString(&generator,
+                             "",
+                             'g',
+                             "generate",
+                             "Generate a build file for the given build tool (ninja) instead of"
+                             " building.");
+
     le_arg_AddMultipleString('C',
                              "cflags",
                              "Specify extra flags to be passed to the C compiler.",
@@ -199,12 +250,24 @@ static void GetCommandLineArgs
     {
         BuildParams.SetVerbose();
     }
+    mk::SetMaxJobs(jobCount);
+    legato::parser::SetMaxParseThreads(jobCount);
     BuildParams.SetTarget(target);
     BuildParams.LibOutputDir(libOutputDir);
     BuildParams.ObjOutputDir(objOutputDir);
+    if (isProfiling)
+    {
+        mk::EnableProfiling(BuildParams.ObjOutputDir());
+    }
+    mk::LoadBuildState(BuildParams.ObjOutputDir(), isForced);
+    if (!generator.empty())
+    {
+        mk::SetBuildFileGenerator(generator, BuildParams.ObjOutputDir());
+    }
     BuildParams.CCompilerFlags(cFlags);
     BuildParams.CxxCompilerFlags(cxxFlags);
     BuildParams.LinkerFlags(ldFlags);
+    mk::SetOptimizationGoal(BuildParams, optimization);
     if (buildOutputPath != "")
     {
         Component.Lib().BuildOutputPath(buildOutputPath);
@@ -224,6 +287,8 @@ static void ConstructObjectModel
 )
 //--------------------------------------------------------------------------------------------------
 {
+    mk::ProfilePhase_t phase("parse", Component.Name());
+
     legato::parser::ParseComponent(&Component, BuildParams);
 }
 
@@ -18,6 +18,10 @@
 #include "ComponentInstanceBuilder.h"
 #include "ExecutableBuilder.h"
 #include "Utilities.h"
+#include "JobScheduler.h"
+#include "BuildState.h"
+#include "Profiler.h"
+#include "BuildFileGenerator.h"
 
 
 /// Object that stores build parameters that we gather.
@@ -58,6 +62,21 @@ static void GetCommandLineArgs
     // true = say what we are doing on stdout.
     bool isVerbose = false;
 
+    // Maximum number of build jobs to run at the same time (0 = one per CPU).
+    int jobCount = 0;
+
+    // true = rebuild everything, even if it looks up to date.
+    bool isForced = false;
+
+    // true = write a profile of where the build's time went.
+    bool isProfiling = false;
+
+    // Name of the build tool to generate a build file for ("" = build now).
+    std::string generator;
+
+    // What to optimize the code for ("size", "speed" or "" = don't optimize).
+    std::string optimization;
+
     // Path to the directory where generated runtime libs should be put.
     std::string libOutputDir = ".";
 
@@ -142,6 +161,39 @@ static void GetCommandLineArgs
                            "verbose",
                            "Set into verbose mode for extra diagnostic information.");
 
+    le_arg_AddOptionalInt(&jobCount,
+                          0,
+                          'j',
+                          "jobs",
+                          "Run up to this many build steps (and definition file parses) in parallel"
+                          " (default: one per CPU).");
+
+    le_arg_AddOptionalFlag(&isForced,
+                           'f',
+                           "force",
+                           "Rebuild everything, even things that are already up to date.");
+
+    le_arg_AddOptionalFlag(&isProfiling,
+                           'P',
+                           "profile",
+                           "Record how long each build step takes, and write a report"
+                           " (mk.profile.txt and mk.profile.json) to the working directory.");
+
+    le_arg_AddOptionalString(&optimization,
+                             "",
+                             'O',
+                             "optimize",
+                             "Optimize for 'size' or 'speed': drop unused code and data, use"
+                             " link-time optimization if the compiler supports it, and link"
+                             " components statically into executables.");
+
+    le_arg_AddOptionalString(&generator,
+                             "",
+                             'g',
+                             "generate",
+                             "Generate a build file for the given build tool (ninja) instead of"
+                             " building.");
+
     le_arg_AddMultipleString('C',
                              "cflags",
                              "Specify extra flags to be passed to the C compiler.",
@@ -176,12 +228,25 @@ static void GetCommandLineArgs
     {
         BuildParams.SetVerbose();
     }
+    mk::SetMaxJobs(jobCount);
+    legato::parser::SetMaxParseThreads(jobCount);
     BuildParams.SetTarget(target);
     BuildParams.LibOutputDir(libOutputDir);
     BuildParams.ObjOutputDir(objOutputDir);
+    if (isProfiling)
+    {
+        mk::EnableProfiling(BuildParams.ObjOutputDir());
+    }
+    mk::LoadBuildState(BuildParams.ObjOutputDir(), isForced);
+    if (!generator.empty())
+    {
+        mk::SetBuildFileGenerator(generator, BuildParams.ObjOutputDir());
+    }
     BuildParams.CCompilerFlags(cFlags);
     BuildParams.CxxCompilerFlags(cxxFlags);
     BuildParams.LinkerFlags(ldFlags);
+    mk::SetOptimizationGoal(BuildParams, optimization);
+    BuildParams.DoStaticLink(!optimization.empty());
 }
 
 
@@ -229,6 +294,8 @@ static legato::Executable& ConstructObjectModel
 )
 //--------------------------------------------------------------------------------------------------
 {
+    mk::ProfilePhase_t phase("parse", legato::GetLastPathNode(ExePath));
+
     bool errorFound = false;
 
     // Create a new Executable object.
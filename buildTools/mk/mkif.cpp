@@ -0,0 +1,504 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Implements the "mkif" functionality of the "mk" tool: generating IPC code from .api files.
+ *
+ *  The command-line is the same as ifgen's, and so is the generated code.  Run 'mkif --help' for
+ *  command-line options and usage help.
+ *
+ *  mkif is also run in-process by the job scheduler, for build steps that generate IPC code, so
+ *  that each .api file is only read and parsed once per build, however many interfaces use it.
+ *
+ *  Copyright (C) Sierra Wireless, Inc. 2014.  Use of this work is subject to license.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include <iostream>
+#include <sstream>
+#include <string.h>
+#include "LegatoObjectModel.h"
+#include "Parser.h"
+#include "mkif.h"
+#include "ApiCodeGenerator.h"
+#include "Utilities.h"
+
+
+namespace mk
+{
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Command-line help text.
+ */
+//--------------------------------------------------------------------------------------------------
+static const char* const HelpText =
+    "usage: mkif [-h] [--gen-all] [--gen-interface] [--gen-local] [--gen-client]\n"
+    "            [--gen-server-interface] [--gen-server] [--async-server]\n"
+    "            [--await-client] [--pipelined-client] [--name-prefix NAMEPREFIX]\n"
+    "            [--file-prefix FILEPREFIX] [--service-name SERVICENAME]\n"
+    "            [--output-dir OUTPUTDIR] [--get-import-list]\n"
+    "            [--import-dir IMPORTDIRS] [--no-default-prefix] [--hash] [--dump]\n"
+    "            FILE\n"
+    "\n"
+    "Interface Code Generator\n"
+    "\n"
+    "positional arguments:\n"
+    "  FILE                  name of interface file\n"
+    "\n"
+    "optional arguments:\n"
+    "  -h, --help            show this help message and exit\n"
+    "  --gen-all             generate all files; overrides individual file options\n"
+    "  --gen-interface       generate interface header file\n"
+    "  --gen-local           generate local header file\n"
+    "  --gen-client          generate client IPC implementation file\n"
+    "  --gen-server-interface\n"
+    "                        generate server interface header file\n"
+    "  --gen-server          generate server IPC implementation file\n"
+    "  --async-server        generate asynchronous-style server functions\n"
+    "  --await-client        generate client functions that only suspend the calling\n"
+    "                        coroutine (if any) while waiting for the server's response\n"
+    "  --pipelined-client    also generate Start and Finish client functions, which send a\n"
+    "                        request and collect its response separately\n"
+    "  --name-prefix NAMEPREFIX\n"
+    "                        optional prefix for generated functions/types; defaults to\n"
+    "                        input filename\n"
+    "  --file-prefix FILEPREFIX\n"
+    "                        optional prefix for generated files; defaults to input file\n"
+    "                        name\n"
+    "  --service-name SERVICENAME\n"
+    "                        optional service instance name; defaults to input file name\n"
+    "  --output-dir OUTPUTDIR\n"
+    "                        optional output directory for generated files\n"
+    "  --get-import-list     print out the list of imported files\n"
+    "  --import-dir IMPORTDIRS\n"
+    "                        optional directory for imported files; may be given multiple\n"
+    "                        times\n"
+    "  --no-default-prefix   do not use default file or name prefix if none is specified\n"
+    "  --hash                print SHA256 hash for interface; NO files are generated\n"
+    "  --dump                print info on parsed functions; NO files are generated\n";
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Everything given on a mkif command-line.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    std::string interfaceFile;          ///< Path of the .api file.
+    ApiCodeOptions_t codeOptions;       ///< What code to generate.
+    std::string namePrefix;             ///< Prefix for generated function and type names.
+    std::list<std::string> importDirs;  ///< Where to look for imported .api files.
+    bool isNoDefaultPrefix;             ///< Don't default the prefixes to the .api file's name.
+    bool isGetImportList;               ///< Print the imported files instead of generating code.
+    bool isHash;                        ///< Print the protocol hash instead of generating code.
+    bool isDump;                        ///< Print the parsed definitions instead of generating.
+    bool isHelp;                        ///< Print the help text and do nothing else.
+}
+MkifArgs_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Make a path absolute and normalize it, the way Python's os.path.abspath() does, so that paths
+ * come out the same as ifgen's.
+ *
+ * @return The absolute path.
+ */
+//--------------------------------------------------------------------------------------------------
+static std::string PyAbsPath
+(
+    const std::string& path
+)
+//--------------------------------------------------------------------------------------------------
+{
+    std::vector<std::string> nodes;
+    std::istringstream pathStream(legato::AbsolutePath(path));
+    std::string node;
+
+    while (std::getline(pathStream, node, '/'))
+    {
+        if (node == "..")
+        {
+            if (!nodes.empty())
+            {
+                nodes.pop_back();
+            }
+        }
+        else if (!node.empty() && (node != "."))
+        {
+            nodes.push_back(node);
+        }
+    }
+
+    std::string result;
+    for (const auto& n : nodes)
+    {
+        result += "/" + n;
+    }
+
+    return result.empty() ? "/" : result;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Parse mkif's command-line arguments (not including the program name).  Options can be given
+ * as "--option value" or "--option=value".  Defaults are filled in the same way as ifgen does.
+ *
+ * @return The arguments.
+ *
+ * @throw legato::Exception if the arguments are not valid.
+ */
+//--------------------------------------------------------------------------------------------------
+static MkifArgs_t ParseArgs
+(
+    const std::vector<std::string>& argList
+)
+//--------------------------------------------------------------------------------------------------
+{
+    MkifArgs_t args;
+    ApiCodeOptions_t& codeOptions = args.codeOptions;
+    bool isGenAll = false;
+    std::string outputDir;
+
+    codeOptions.genInterface = false;
+    codeOptions.genLocal = false;
+    codeOptions.genClient = false;
+    codeOptions.genServerInterface = false;
+    codeOptions.genServer = false;
+    codeOptions.isAsyncServer = false;
+    codeOptions.isAwaitClient = false;
+    codeOptions.isPipelinedClient = false;
+    args.isNoDefaultPrefix = false;
+    args.isGetImportList = false;
+    args.isHash = false;
+    args.isDump = false;
+    args.isHelp = false;
+
+    const std::map<std::string, bool*> flags =
+    {
+        { "--gen-all", &isGenAll },
+        { "--gen-interface", &codeOptions.genInterface },
+        { "--gen-local", &codeOptions.genLocal },
+        { "--gen-client", &codeOptions.genClient },
+        { "--gen-server-interface", &codeOptions.genServerInterface },
+        { "--gen-server", &codeOptions.genServer },
+        { "--async-server", &codeOptions.isAsyncServer },
+        { "--await-client", &codeOptions.isAwaitClient },
+        { "--pipelined-client", &codeOptions.isPipelinedClient },
+        { "--get-import-list", &args.isGetImportList },
+        { "--no-default-prefix", &args.isNoDefaultPrefix },
+        { "--hash", &args.isHash },
+        { "--dump", &args.isDump },
+        { "--help", &args.isHelp },
+        { "-h", &args.isHelp },
+    };
+
+    const std::map<std::string, std::string*> strings =
+    {
+        { "--name-prefix", &args.namePrefix },
+        { "--file-prefix", &codeOptions.filePrefix },
+        { "--service-name", &codeOptions.serviceName },
+        { "--output-dir", &outputDir },
+    };
+
+    for (size_t i = 0; i < argList.size(); i++)
+    {
+        std::string arg = argList[i];
+
+        if ((arg.size() < 2) || (arg[0] != '-'))
+        {
+            if (!args.interfaceFile.empty())
+            {
+                throw legato::Exception("mkif: unrecognized arguments: " + arg);
+            }
+            args.interfaceFile = arg;
+            continue;
+        }
+
+        // Split "--option=value".
+        std::string value;
+        bool hasValue = false;
+        size_t equalsPos = arg.find('=');
+        if (equalsPos != std::string::npos)
+        {
+            value = arg.substr(equalsPos + 1);
+            arg.erase(equalsPos);
+            hasValue = true;
+        }
+
+        auto flagIter = flags.find(arg);
+        if ((flagIter != flags.end()) && !hasValue)
+        {
+            *(flagIter->second) = true;
+            continue;
+        }
+
+        bool isImportDir = (arg == "--import-dir");
+        auto stringIter = strings.find(arg);
+        if ((stringIter == strings.end()) && !isImportDir)
+        {
+            throw legato::Exception("mkif: unrecognized arguments: " + argList[i]);
+        }
+
+        if (!hasValue)
+        {
+            if (i + 1 >= argList.size())
+            {
+                throw legato::Exception("mkif: argument " + arg + ": expected one argument");
+            }
+            value = argList[++i];
+        }
+
+        if (isImportDir)
+        {
+            args.importDirs.push_back(value.empty() ? value : PyAbsPath(value));
+        }
+        else
+        {
+            *(stringIter->second) = value;
+        }
+    }
+
+    if (args.isHelp)
+    {
+        return args;
+    }
+
+    if (args.interfaceFile.empty())
+    {
+        throw legato::Exception("mkif: too few arguments");
+    }
+
+    if (isGenAll)
+    {
+        codeOptions.genInterface = true;
+        codeOptions.genLocal = true;
+        codeOptions.genClient = true;
+        codeOptions.genServerInterface = true;
+        codeOptions.genServer = true;
+    }
+
+    // The default prefixes and service name are the .api file's name, without the ".api".
+    std::string apiName = legato::GetLastPathNode(args.interfaceFile);
+    size_t dotPos = apiName.rfind('.');
+    if ((dotPos != std::string::npos) && (apiName.find_first_not_of('.') < dotPos))
+    {
+        apiName.erase(dotPos);
+    }
+
+    if (!args.isNoDefaultPrefix)
+    {
+        if (args.namePrefix.empty())
+        {
+            args.namePrefix = apiName;
+        }
+        if (codeOptions.filePrefix.empty())
+        {
+            codeOptions.filePrefix = apiName;
+        }
+    }
+
+    if (codeOptions.serviceName.empty())
+    {
+        codeOptions.serviceName = apiName;
+    }
+
+    if (!args.namePrefix.empty() && (args.namePrefix.back() == '_'))
+    {
+        args.namePrefix.erase(args.namePrefix.size() - 1);
+    }
+
+    if (!codeOptions.filePrefix.empty() && (codeOptions.filePrefix.back() == '_'))
+    {
+        codeOptions.filePrefix.erase(codeOptions.filePrefix.size() - 1);
+    }
+
+    if (!outputDir.empty())
+    {
+        codeOptions.outputDir = PyAbsPath(outputDir);
+    }
+
+    return args;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * @return What "mkif --dump" prints: the parsed definitions, and the .api to C type mapping.
+ */
+//--------------------------------------------------------------------------------------------------
+static std::string DumpDefinition
+(
+    const legato::api::Definition_t& definition
+)
+//--------------------------------------------------------------------------------------------------
+{
+    std::string text;
+
+    for (const auto& codeList : { &definition.importedCode, &definition.code })
+    {
+        for (const auto& itemPtr : *codeList)
+        {
+            text += std::string(10, '-') + "\n" + itemPtr->ToString() + "\n";
+        }
+    }
+
+    text += std::string(40, '=') + "\n\n";
+
+    for (const auto& type : definition.types)
+    {
+        std::string name = type.first;
+        if (name.size() < 20)
+        {
+            name.resize(20, ' ');
+        }
+        text += name + " => " + type.second + "\n";
+    }
+    text += std::string(40, '-') + "\n";
+
+    return text;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Run mkif.
+ *
+ * @throw legato::Exception on failure.
+ */
+//--------------------------------------------------------------------------------------------------
+static void Run
+(
+    const std::vector<std::string>& argList,    ///< [in] Arguments, without the program name.
+    std::string& output                         ///< [out] Text to print on stdout.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    MkifArgs_t args = ParseArgs(argList);
+
+    if (args.isHelp)
+    {
+        output += HelpText;
+        return;
+    }
+
+    if (args.isGetImportList)
+    {
+        auto importList = legato::parser::GetApiImportList(args.interfaceFile, args.importDirs);
+
+        for (const auto& path : importList)
+        {
+            output += path + "\n";
+        }
+        if (importList.empty())
+        {
+            output += "\n";
+        }
+        return;
+    }
+
+    const legato::api::Definition_t& definition =
+                    legato::parser::GetApiDefinition(args.interfaceFile,
+                                                     args.namePrefix,
+                                                     args.importDirs);
+
+    output += definition.messages;
+
+    if (args.isDump)
+    {
+        output += (args.isHash ? definition.HashString() + "\n" : DumpDefinition(definition));
+        return;
+    }
+
+    if (args.isHash)
+    {
+        output += definition.hash + "\n";
+        return;
+    }
+
+    GenerateApiCode(definition, args.codeOptions);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check whether a build step's command-line runs mkif, in which case it can be run by
+ * RunMkifCommandLine() instead of a shell.
+ */
+//--------------------------------------------------------------------------------------------------
+bool IsMkifCommandLine
+(
+    const std::string& commandLine
+)
+//--------------------------------------------------------------------------------------------------
+{
+    // Command-lines that do more than run mkif have to go to the shell.
+    return (   (commandLine.compare(0, 5, "mkif ") == 0)
+            && (commandLine.find_first_of(";&|<>`$") == std::string::npos));
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Run a mkif command-line (as written for the shell) in this process.  Parsed .api files are
+ * kept, so later runs that read the same files don't parse them again.
+ *
+ * @return The exit code mkif would have returned (0 = success).
+ */
+//--------------------------------------------------------------------------------------------------
+int RunMkifCommandLine
+(
+    const std::string& commandLine, ///< [in] The command-line, starting with "mkif".
+    std::string& output             ///< [out] What mkif would have printed, errors included.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    try
+    {
+        auto argList = SplitCommandLine(commandLine);
+        argList.erase(argList.begin());
+
+        Run(argList, output);
+    }
+    catch (std::runtime_error& e)
+    {
+        output += std::string("** ERROR: ") + e.what() + "\n";
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Implements the mkif functionality, which generates IPC code from .api files.  The command-line
+ * is the same as ifgen's.
+ */
+//--------------------------------------------------------------------------------------------------
+void MakeInterface
+(
+    int argc,           ///< Count of the number of command line parameters.
+    const char** argv   ///< Pointer to an array of pointers to command line argument strings.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    std::string output;
+
+    try
+    {
+        mk::Run(std::vector<std::string>(argv + 1, argv + argc), output);
+    }
+    catch (...)
+    {
+        std::cout << output;
+        throw;
+    }
+
+    std::cout << output;
+}
@@ -0,0 +1,54 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * Copyright (C) Sierra Wireless, Inc. 2014.  Use of this work is subject to license.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#ifndef MKIF_H_INCLUDE_GUARD
+#define MKIF_H_INCLUDE_GUARD
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Implements the mkif functionality, which generates IPC code from .api files.  The command-line
+ * is the same as ifgen's.
+ */
+//--------------------------------------------------------------------------------------------------
+void MakeInterface
+(
+    int argc,           ///< Count of the number of command line parameters.
+    const char** argv   ///< Pointer to an array of pointers to command line argument strings.
+);
+
+
+namespace mk
+{
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check whether a build step's command-line runs mkif, in which case it can be run by
+ * RunMkifCommandLine() instead of a shell.
+ */
+//--------------------------------------------------------------------------------------------------
+bool IsMkifCommandLine
+(
+    const std::string& commandLine
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Run a mkif command-line (as written for the shell) in this process.  Parsed .api files are
+ * kept, so later runs that read the same files don't parse them again.
+ *
+ * @return The exit code mkif would have returned (0 = success).
+ */
+//--------------------------------------------------------------------------------------------------
+int RunMkifCommandLine
+(
+    const std::string& commandLine, ///< [in] The command-line, starting with "mkif".
+    std::string& output             ///< [out] What mkif would have printed, errors included.
+);
+
+}
+
+#endif // MKIF_H_INCLUDE_GUARD
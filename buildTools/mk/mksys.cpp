@@ -26,6 +26,10 @@
 #include "ExecutableBuilder.h"
 #include "ApplicationBuilder.h"
 #include "Utilities.h"
+#include "JobScheduler.h"
+#include "BuildState.h"
+#include "Profiler.h"
+#include "BuildFileGenerator.h"
 
 
 /// Object that stores build parameters that we gather.
@@ -58,6 +62,21 @@ static void GetCommandLineArgs
 
     bool isVerbose = false;
 
+    // Maximum number of build jobs to run at the same time (0 = one per CPU).
+    int jobCount = 0;
+
+    // true = rebuild everything, even if it looks up to date.
+    bool isForced = false;
+
+    // true = write a profile of where the build's time went.
+    bool isProfiling = false;
+
+    // Name of the build tool to generate a build file for ("" = build now).
+    std::string generator;
+
+    // What to optimize the code for ("size", "speed" or "" = don't optimize).
+    std::string optimization;
+
     // Path to the directory where intermediate build output files (such as generated
     // source code and object code files) should be put.
     std::string objectFilesDir;
@@ -135,6 +154,39 @@ static void GetCommandLineArgs
                            "verbose",
                            "Set into verbose mode for extra diagnostic information.");
 
+    le_arg_AddOptionalInt(&jobCount,
+                          0,
+                          'j',
+                          "jobs",
+                          "Run up to this many build steps (and definition file parses) in parallel"
+                          " (default: one per CPU).");
+
+    le_arg_AddOptionalFlag(&isForced,
+                           'f',
+                           "force",
+                           "Rebuild everything, even things that are already up to date.");
+
+    le_arg_AddOptionalFlag(&isProfiling,
+                           'P',
+                           "profile",
+                           "Record how long each build step takes, and write a report"
+                           " (mk.profile.txt and mk.profile.json) to the working directory.");
+
+    le_arg_AddOptionalString(&optimization,
+                             "",
+                             'O',
+                             "optimize",
+                             "Optimize for 'size' or 'speed': drop unused code and data, use"
+                             " link-time optimization if the compiler supports it, and link"
+                             " components statically into executables.");
+
+    le_arg_AddOptionalString(&generator,
+                             "",
+                             'g',
+                             "generate",
+                             "Generate a build file for the given build tool (ninja) instead of"
+                             " building.");
+
     le_arg_AddMultipleString('C',
                              "cflags",
                              "Specify extra flags to be passed to the C compiler.",
@@ -165,6 +217,15 @@ static void GetCommandLineArgs
         objectFilesDir = "./_build_" + System.Name() + "/" + target;
     }
     BuildParams.ObjOutputDir(objectFilesDir);
+    if (isProfiling)
+    {
+        mk::EnableProfiling(BuildParams.ObjOutputDir());
+    }
+    mk::LoadBuildState(BuildParams.ObjOutputDir(), isForced);
+    if (!generator.empty())
+    {
+        mk::SetBuildFileGenerator(generator, BuildParams.ObjOutputDir());
+    }
 
     // Add the directory containing the .sdef file to the list of source search directories
     // and the list of interface search directories.
@@ -177,9 +238,13 @@ static void GetCommandLineArgs
     {
         BuildParams.SetVerbose();
     }
+    mk::SetMaxJobs(jobCount);
+    legato::parser::SetMaxParseThreads(jobCount);
     BuildParams.SetTarget(target);
     BuildParams.CCompilerFlags(cFlags);
     BuildParams.LinkerFlags(ldFlags);
+    mk::SetOptimizationGoal(BuildParams, optimization);
+    BuildParams.DoStaticLink(!optimization.empty());
 }
 
 
@@ -259,8 +324,8 @@ static void Build
     std::string objDirPath = BuildParams.ObjOutputDir() + "/obj";
     std::string stagingDirPath = BuildParams.ObjOutputDir() + "/staging";
 
-    // Clean the staging area.
-    legato::CleanDir(stagingDirPath);
+    // Clean the staging area, if anything might have been removed from it.
+    mk::CleanStagingDir(stagingDirPath, { System.DefFilePath() }, { }, BuildParams);
 
     // Create the staging and working directories.
     legato::MakeDir(objDirPath);
@@ -303,7 +368,7 @@ static void Build
         std::cout << "Packaging system into '" << outputPath << "'." << std::endl;
         std::cout << std::endl << "$ "<< tarCommandLine << std::endl << std::endl;
     }
-    mk::ExecuteCommandLine(tarCommandLine);
+    mk::PackageStagingDir(tarCommandLine, stagingDirPath, outputPath);
 }
 
 
@@ -326,7 +391,10 @@ void MakeSystem
     mk::SetTargetSpecificEnvVars(BuildParams.Target());
 
     // Parse the .sdef file, populating the System object with the results.
-    legato::parser::ParseSystem(&System, BuildParams);
+    {
+        mk::ProfilePhase_t phase("parse", System.Name());
+        legato::parser::ParseSystem(&System, BuildParams);
+    }
 
     Build();
 }
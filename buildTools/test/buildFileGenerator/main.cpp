@@ -0,0 +1,266 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * Unit test for the Ninja build file generator (see BuildFileGenerator.h).
+ *
+ * Jobs are recorded the way the mk tools record them, a build file is generated from them, and
+ * its build statements are checked:
+ *
+ *  - no file is produced by more than one build statement,
+ *  - every input is either produced by a build statement or already exists (otherwise Ninja
+ *    stops with "missing and no known rule to make it"),
+ *  - a job that reads a file written by more than one job depends on all the jobs that wrote it.
+ *
+ * Copyright (C) 2014, Sierra Wireless Inc.  Use of this work is subject to license.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "LegatoObjectModel.h"
+#include "BuildFileGenerator.h"
+#include "JobScheduler.h"
+
+extern "C" {
+    #include <stdlib.h>
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A build statement read back from the generated build file.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    std::list<std::string> outputs;
+    std::list<std::string> inputs;      ///< Explicit and implicit inputs.
+    std::list<std::string> orderOnly;
+    std::string command;
+}
+BuildStatement_t;
+
+
+static int NumFailures = 0;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Report a failed check.
+ */
+//--------------------------------------------------------------------------------------------------
+#define CHECK(condition, message) \
+    if (!(condition)) \
+    { \
+        std::cerr << "FAILED: " << message << std::endl; \
+        NumFailures++; \
+    }
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read the build statements from a Ninja build file.  Only handles what the generator writes
+ * for the paths used in this test (no escaped characters).
+ */
+//--------------------------------------------------------------------------------------------------
+static std::list<BuildStatement_t> ReadBuildStatements
+(
+    const std::string& filePath
+)
+//--------------------------------------------------------------------------------------------------
+{
+    std::list<BuildStatement_t> statements;
+    std::ifstream file(filePath);
+    std::string line;
+
+    while (std::getline(file, line))
+    {
+        if (line.compare(0, 6, "build ") == 0)
+        {
+            BuildStatement_t statement;
+            std::stringstream words(line.substr(6));
+            std::string word;
+            enum { OUTPUTS, RULE, INPUTS, ORDER_ONLY } part = OUTPUTS;
+
+            while (words >> word)
+            {
+                if ((part == OUTPUTS) && (word.back() == ':'))
+                {
+                    word.pop_back();
+                    if (!word.empty())
+                    {
+                        statement.outputs.push_back(word);
+                    }
+                    part = RULE;
+                }
+                else if (part == OUTPUTS)
+                {
+                    statement.outputs.push_back(word);
+                }
+                else if (part == RULE)
+                {
+                    part = INPUTS;
+                }
+                else if (word == "|")
+                {
+                    // Implicit inputs have to exist or be built just like explicit ones.
+                }
+                else if (word == "||")
+                {
+                    part = ORDER_ONLY;
+                }
+                else if (part == INPUTS)
+                {
+                    statement.inputs.push_back(word);
+                }
+                else
+                {
+                    statement.orderOnly.push_back(word);
+                }
+            }
+
+            statements.push_back(statement);
+        }
+        else if ((line.compare(0, 8, "  cmd = ") == 0) && !statements.empty())
+        {
+            statements.back().command = line.substr(8);
+        }
+    }
+
+    return statements;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Find the build statement whose command contains a given string.
+ */
+//--------------------------------------------------------------------------------------------------
+static const BuildStatement_t* FindStatement
+(
+    const std::list<BuildStatement_t>& statements,
+    const std::string& commandPart
+)
+//--------------------------------------------------------------------------------------------------
+{
+    for (const auto& statement : statements)
+    {
+        if (statement.command.find(commandPart) != std::string::npos)
+        {
+            return &statement;
+        }
+    }
+
+    return NULL;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check that a build statement depends on all the outputs of another one.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CheckDependsOn
+(
+    const BuildStatement_t& statement,
+    const BuildStatement_t& writer
+)
+//--------------------------------------------------------------------------------------------------
+{
+    std::set<std::string> inputs(statement.inputs.begin(), statement.inputs.end());
+
+    for (const auto& path : writer.outputs)
+    {
+        CHECK(inputs.count(path) == 1,
+              "'" << statement.command << "' doesn't depend on '" << path << "'");
+    }
+}
+
+
+int main(int argc, const char** argv)
+{
+    char dirTemplate[] = "/tmp/testBuildFileGeneratorXXXXXX";
+
+    if (mkdtemp(dirTemplate) == NULL)
+    {
+        std::cerr << "Failed to create a temporary directory." << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::string dir = dirTemplate;
+    std::string source = dir + "/gen.api";
+    std::string shared = dir + "/shared.h";
+
+    std::ofstream(source) << "FUNCTION Dummy();" << std::endl;
+
+    try
+    {
+        mk::SetBuildFileGenerator("ninja", dir);
+
+        // Two different jobs write the same file (and the first one also writes a file of its
+        // own), a compile reads it, and a link uses the compile's output.
+        mk::StartJob("gen-a " + source, { source }, { dir, shared, dir + "/a.h" });
+        mk::StartJob("gen-b " + source, { source }, { dir, shared });
+        mk::StartJob("cc-user", { dir + "/user.c", shared, dir + "/a.h", dir },
+                     { dir + "/user.o" });
+        mk::StartJob("link-user", { dir + "/user.o" }, { dir + "/user" });
+
+        std::ofstream(dir + "/user.c") << "#include \"shared.h\"" << std::endl;
+
+        mk::GenerateBuildFile(argc, argv);
+    }
+    catch (legato::Exception& e)
+    {
+        std::cerr << "Exception: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    auto statements = ReadBuildStatements(dir + "/build.ninja");
+
+    // The first statement is the one that regenerates the build file.
+    CHECK(statements.size() == 5, "Expected 5 build statements, got " << statements.size());
+
+    std::set<std::string> outputs;
+    for (const auto& statement : statements)
+    {
+        for (const auto& path : statement.outputs)
+        {
+            CHECK(outputs.insert(path).second, "'" << path << "' is built more than once");
+            CHECK(path != shared, "'" << path << "' is written by more than one job");
+        }
+    }
+
+    for (const auto& statement : statements)
+    {
+        for (const auto* pathListPtr : { &statement.inputs, &statement.orderOnly })
+        {
+            for (const auto& path : *pathListPtr)
+            {
+                CHECK((outputs.count(path) == 1) || legato::FileExists(path),
+                      "'" << path << "', needed by '" << statement.command
+                          << "', is missing and no statement builds it");
+            }
+        }
+    }
+
+    auto genAPtr = FindStatement(statements, "gen-a ");
+    auto genBPtr = FindStatement(statements, "gen-b ");
+    auto compilePtr = FindStatement(statements, "cc-user");
+    auto linkPtr = FindStatement(statements, "link-user");
+
+    CHECK(genAPtr && genBPtr && compilePtr && linkPtr, "A job is missing from the build file");
+
+    if (genAPtr && genBPtr && compilePtr && linkPtr)
+    {
+        CheckDependsOn(*compilePtr, *genAPtr);
+        CheckDependsOn(*compilePtr, *genBPtr);
+        CheckDependsOn(*linkPtr, *compilePtr);
+    }
+
+    if (NumFailures == 0)
+    {
+        legato::CleanDir(dir);
+        std::cout << "PASSED" << std::endl;
+        return EXIT_SUCCESS;
+    }
+
+    std::cerr << NumFailures << " check(s) failed.  See '" << dir << "'." << std::endl;
+    return EXIT_FAILURE;
+}
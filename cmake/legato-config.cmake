@@ -83,6 +83,11 @@ if(AUTOMOTIVE_TARGET)
     set (LEGATO_AUTOMOTIVE_TARGET_OPTION --cflags=-DAUTOMOTIVE_TARGET)
 endif()
 
+# Optimize executables and apps for "size" or "speed" (linking components statically into them).
+if(LEGATO_OPTIMIZE)
+    set (LEGATO_OPTIMIZE_OPTION --optimize=${LEGATO_OPTIMIZE})
+endif()
+
 # Function to build a Legato executable using mkexe.
 # The executable will be put in the appropriate target's bin directory.
 # Supporting libraries will be put in the target's lib directory.
@@ -101,6 +106,7 @@ function(mkexe EXE_NAME)
                           -t ${LEGATO_TARGET}
                           ${LEGATO_EMBEDDED_OPTION}
                           ${LEGATO_AUTOMOTIVE_TARGET_OPTION}
+                          ${LEGATO_OPTIMIZE_OPTION}
                           -v
                           ${ARGN}
             WORKING_DIRECTORY ${CMAKE_CURRENT_SOURCE_DIR}
@@ -140,6 +146,7 @@ function(mkapp ADEF)
                         -o ${APP_OUTPUT_PATH}
                         ${LEGATO_EMBEDDED_OPTION}
                         ${LEGATO_AUTOMOTIVE_TARGET_OPTION}
+                        ${LEGATO_OPTIMIZE_OPTION}
                         -v
                         ${ARGN}
             COMMAND
@@ -182,6 +189,7 @@ function(mkcomp COMP_PATH)
                         -l ${LIBRARY_OUTPUT_PATH}
                         ${LEGATO_EMBEDDED_OPTION}
                         ${LEGATO_AUTOMOTIVE_TARGET_OPTION}
+                        ${LEGATO_OPTIMIZE_OPTION}
                         -v
                         ${ARGN}
             DEPENDS ${COMP_PATH}/Component.cdef
@@ -203,5 +203,20 @@ le_onoff_t;
 //--------------------------------------------------------------------------------------------------
 #define STRINGIZE_EXPAND(x)     #x   // Needed to expand macros.
 
+/* @cond PrivateMacros */
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Marks a framework-internal function that has to be exported from liblegato because it is used
+ * by the framework's daemons and tools or by generated main() code.
+ *
+ * liblegato is built with hidden symbol visibility, so nothing else is visible outside it except
+ * the public API (see legato.h).
+ */
+//--------------------------------------------------------------------------------------------------
+#define LE_SHARED   __attribute__((visibility("default")))
+
+/* @endcond */
+
 
 #endif // LEGATO_BASICS_INCLUDE_GUARD
@@ -0,0 +1,251 @@
+/**
+ * @page c_coro Coroutine API
+ *
+ * @ref le_coro.h "API Reference"
+ *
+ * <HR>
+ *
+ * @ref coroCreating <br>
+ * @ref coroSuspending <br>
+ * @ref coroAwait <br>
+ * @ref coroLimitations <br>
+ *
+ * A Coroutine is a function that runs on its own stack, in the thread that created it, and that
+ * can suspend itself part-way through without blocking that thread.  While a coroutine is
+ * suspended, the thread's @ref c_eventLoop "Event Loop" goes on running other handlers.  When
+ * the coroutine is resumed, it is scheduled by the Event Loop like any other queued function and
+ * carries on from where it left off, with all its local variables intact.
+ *
+ * This makes it possible to write a sequence of slow operations (e.g., a series of IPC calls) as
+ * straight-line code, instead of as a state machine spread across a set of callbacks, without
+ * holding up the rest of the thread while waiting for each operation to finish.
+ *
+ * @section coroCreating Creating and Starting a Coroutine
+ *
+ * A coroutine is created by calling le_coro_Create().  Its stack size can be changed with
+ * le_coro_SetStackSize() before it is started with le_coro_Start().  Starting a coroutine doesn't
+ * run it immediately; it queues it to the calling thread's Event Loop, which runs it the next
+ * time it gets to it.
+ *
+ * A coroutine is deleted automatically when its main function returns.
+ *
+ * @code
+ * static void UpdateMain(void* contextPtr)
+ * {
+ *     ...
+ * }
+ *
+ * ...
+ *     le_coro_Ref_t coroRef = le_coro_Create("update", UpdateMain, NULL);
+ *     le_coro_SetStackSize(coroRef, 16 * 1024);
+ *     le_coro_Start(coroRef);
+ * @endcode
+ *
+ * @section coroSuspending Suspending and Resuming
+ *
+ * A coroutine gives the thread back to the Event Loop by calling:
+ *  - le_coro_Suspend() to wait until some other code calls le_coro_Resume() with its reference
+ *    (typically from an event handler or a completion callback), or
+ *  - le_coro_Yield() to let other queued work run and then continue.
+ *
+ * le_coro_Resume() can be called from any thread, but the coroutine always runs in the thread
+ * that created it.  If le_coro_Resume() is called while the coroutine is still running (e.g., a
+ * callback fires in another thread before the coroutine has got around to suspending itself),
+ * the resume is remembered and the next call to le_coro_Suspend() returns immediately.  This
+ * means that le_coro_Suspend() can return because of a resume that was meant for an earlier
+ * wait, so a coroutine should always check that whatever it was waiting for has really happened,
+ * and suspend again if not, as in the example below.  Resuming a coroutine that has already
+ * finished does nothing.
+ *
+ * le_coro_GetCurrent() returns the reference of the running coroutine, or NULL if it is called
+ * from outside a coroutine.
+ *
+ * @code
+ * static void ResultHandler(le_result_t result, void* contextPtr)
+ * {
+ *     Op_t* opPtr = contextPtr;
+ *
+ *     opPtr->result = result;
+ *     opPtr->isDone = true;
+ *     le_coro_Resume(opPtr->coroRef);
+ * }
+ *
+ * static le_result_t DoOperation(void)
+ * {
+ *     Op_t op = { .coroRef = le_coro_GetCurrent(), .isDone = false };
+ *
+ *     StartOperation(ResultHandler, &op);
+ *
+ *     while (!op.isDone)
+ *     {
+ *         le_coro_Suspend();
+ *     }
+ *
+ *     return op.result;
+ * }
+ * @endcode
+ *
+ * @section coroAwait Await-Style IPC Calls
+ *
+ * Client-side IPC stubs normally wait for the server's response using
+ * le_msg_RequestSyncResponse(), which blocks the whole thread.  If an interface's client code is
+ * generated with @c ifgen @c --await-client (or the interface is marked @c [await] in the
+ * @c requires: section of the component's @c Component.cdef), the stubs use
+ * le_msg_RequestAwaitResponse() instead.  When called from inside a coroutine, that suspends only
+ * the calling coroutine until the response arrives.  When called from outside a coroutine, it
+ * behaves exactly like le_msg_RequestSyncResponse(), so the same stubs can be used from both.
+ *
+ * @section coroLimitations Limitations
+ *
+ * Coroutine stacks are allocated when the coroutine is started and are not grown automatically.
+ * The page below the bottom of each stack is a guard page, so an overflow results in a
+ * segmentation fault rather than silent corruption of other memory.
+ *
+ * A coroutine must not:
+ *  - call le_event_RunLoop(),
+ *  - call le_coro_Suspend() while it holds a mutex that the code that will resume it needs,
+ *  - be suspended while another thread is waiting for it to release something,
+ *  - call pthread_exit() or le_thread_Exit().
+ *
+ * Blocking calls (e.g., le_sem_Wait() or read() on a blocking file descriptor) made from inside a
+ * coroutine still block the whole thread.
+ *
+ * <HR>
+ *
+ * Copyright (C) Sierra Wireless, Inc. 2014.  Use of this work is subject to license.
+ */
+
+
+/** @file le_coro.h
+ *
+ * Legato @ref c_coro include file.
+ *
+ * Copyright (C) Sierra Wireless, Inc. 2014.  Use of this work is subject to license.
+ */
+
+#ifndef LEGATO_CORO_INCLUDE_GUARD
+#define LEGATO_CORO_INCLUDE_GUARD
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reference to a Coroutine.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct le_coro* le_coro_Ref_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Prototype for a coroutine's main function.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef void (*le_coro_Func_t)
+(
+    void* contextPtr    ///< [IN] Value passed to le_coro_Create() as contextPtr.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Creates a Coroutine in the calling thread.  The coroutine won't run until le_coro_Start() is
+ * called.
+ *
+ * @return
+ *      A reference to the Coroutine (doesn't return if failed).
+ */
+//--------------------------------------------------------------------------------------------------
+le_coro_Ref_t le_coro_Create
+(
+    const char*     name,       ///< [IN] Name of the coroutine (for diagnostics).
+    le_coro_Func_t  mainFunc,   ///< [IN] Main function of the coroutine.
+    void*           contextPtr  ///< [IN] Value to pass to the main function.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sets the stack size of a Coroutine.  Must be called before le_coro_Start().
+ *
+ * @return
+ *      - LE_OK if successful.
+ *      - LE_OVERFLOW if the stack size requested is too small.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t le_coro_SetStackSize
+(
+    le_coro_Ref_t   coroRef,    ///< [IN]
+    size_t          size        ///< [IN] Stack size, in bytes.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Starts a Coroutine.  Its main function will be called from the creating thread's Event Loop.
+ *
+ * @note Must be called from the thread that created the coroutine.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_coro_Start
+(
+    le_coro_Ref_t   coroRef     ///< [IN]
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the reference of the calling Coroutine.
+ *
+ * @return
+ *      A reference to the running Coroutine, or NULL if not called from inside a coroutine.
+ */
+//--------------------------------------------------------------------------------------------------
+le_coro_Ref_t le_coro_GetCurrent
+(
+    void
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Suspends the calling Coroutine until le_coro_Resume() is called for it.  Other handlers in the
+ * thread's Event Loop run in the meantime.
+ *
+ * @note Must be called from inside a coroutine.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_coro_Suspend
+(
+    void
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Resumes a suspended Coroutine.  The coroutine will continue running from the thread's Event
+ * Loop.  Can be called from any thread.
+ *
+ * If the coroutine isn't suspended, its next call to le_coro_Suspend() will return immediately.
+ * If the coroutine has already finished, this does nothing.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_coro_Resume
+(
+    le_coro_Ref_t   coroRef     ///< [IN]
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Lets everything that is currently queued to the calling thread's Event Loop run, and then
+ * continues running the calling Coroutine.
+ *
+ * @note Must be called from inside a coroutine.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_coro_Yield
+(
+    void
+);
+
+
+#endif // LEGATO_CORO_INCLUDE_GUARD
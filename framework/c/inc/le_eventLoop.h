@@ -325,6 +325,42 @@ static void MyReadHandler(int fd)
  * example, if data arrives and the far end closes the connection, the "readable" event handler
  * would be called before the "read hang up" event handler.
  *
+ * By default, file descriptors are monitored in "level-triggered" mode: a handler will be called
+ * again and again for as long as its event's trigger condition remains true.  This means
+ * a handler only needs to read (or write) as much as it wants to each time it's called.  For busy
+ * file descriptors (e.g., sockets carrying a lot of small messages), it's cheaper to switch the
+ * File Descriptor Monitor to "edge-triggered" mode, by calling le_event_SetFdMonitorEdgeTriggered()
+ * after creating it.  Then the handler is only called when the condition @e becomes true
+ * (e.g., when new data arrives), so it must keep reading until read() fails with @c EAGAIN,
+ * or it won't hear about the data that's left over until more data arrives.
+ *
+ * @code
+static void MyEdgeTriggeredReadHandler(int fd)
+{
+    char buff[MY_BUFF_SIZE];
+
+    for (;;)
+    {
+        ssize_t bytesRead = read(fd, buff, sizeof(buff));
+
+        if (bytesRead > 0)
+        {
+            ProcessData(buff, bytesRead);
+        }
+        else if ((bytesRead < 0) && (errno == EINTR))
+        {
+            continue;
+        }
+        else
+        {
+            break;  // EAGAIN (drained), end of file, or error.
+        }
+    }
+}
+ * @endcode
+ *
+ * @note Edge-triggered mode only works with file descriptors in non-blocking mode.
+ *
  * When a file descriptor no longer needs to be monitored, the File Descriptor Monitor object
  * is deleted by calling le_event_DeleteFdMonitor().  There's no need to remove its handlers first.
  *
@@ -576,8 +612,16 @@ static void ContinueWriting(int fd)
  * For example, the keyword "P/T/events" controls logging for a thread named "T" running inside
  * a process named "P".
  *
- * @todo Add a reference to the Process Inspector and its capabilities for inspecting Event Queues,
- * Event Loops, Handlers and Event Report statistics.
+ * Each thread's Event Loop keeps counts of how many times it has woken up, how many Event Reports
+ * and file descriptor events it has handled, and the largest number of Event Reports it has
+ * found waiting on its Event Queue at once.  These can be viewed from outside the process using
+ * the @ref toolsInspect "inspect eventloops" command.
+ *
+ * A handler that takes a long time to run delays every other event in its thread.  To find such
+ * handlers, start the process with the environment variable @c LE_EVENT_STALL_MS set to a number
+ * of milliseconds.  Every handler call will then be timed, the run times of each handler function
+ * will be shown by @c inspect @c eventloops, and a warning will be logged (with the address of the
+ * handler function) whenever a single call takes longer than that many milliseconds.
  *
  * @section c_event_integratingLegacyPosix Integrating with Legacy POSIX Code
  *
@@ -962,6 +1006,24 @@ le_event_FdMonitorRef_t le_event_CreateFdMonitor
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Switches a File Descriptor Monitor to edge-triggered mode.  Handlers will then only be called
+ * when an event's trigger condition becomes true, so they must read (or write) until the file
+ * descriptor reports @c EAGAIN.
+ *
+ * See @ref c_event_files.
+ *
+ * @note The file descriptor must be in non-blocking mode.  There's no way to switch back to
+ *       level-triggered mode.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_event_SetFdMonitorEdgeTriggered
+(
+    le_event_FdMonitorRef_t monitorRef  ///< [in] Reference to the File Descriptor Monitor object.
+);
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Registers a handler for a specific type of file descriptor event with a given
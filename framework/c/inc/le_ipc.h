@@ -0,0 +1,417 @@
+/**
+ * @file le_ipc.h
+ *
+ * Runtime support for the IPC code that ifgen and mk generate from .api files.
+ *
+ * The generated client and server code only holds what is specific to each interface: the message
+ * layouts, and the code that packs and unpacks each function's parameters.  Everything that is the
+ * same for all interfaces lives here, in liblegato, so that a process (or a system) with lots of
+ * IPC bindings only has one copy of it:
+ *  - the functions that pack and unpack the strings and arrays in messages,
+ *  - the client's per-thread sessions and the plumbing for handlers that are registered with the
+ *    server (see le_ipc_ConnectService() and le_ipc_NewClientHandler()),
+ *  - the requests that pipelined client functions send and collect the responses to separately
+ *    (see le_ipc_StartRequest()),
+ *  - the server's service and the plumbing for handlers that are registered by its clients (see
+ *    le_ipc_AdvertiseService() and le_ipc_NewServerHandler()).
+ *
+ * None of this is meant to be used by hand-written code.
+ *
+ * Copyright (C) Sierra Wireless, Inc. 2014.  Use of this work is subject to license.
+ */
+
+#ifndef LEGATO_IPC_INCLUDE_GUARD
+#define LEGATO_IPC_INCLUDE_GUARD
+
+/* @cond PrivateMacros */
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Rounds a size up to a multiple of 8 bytes.
+ *
+ * Each message starts with a struct that holds its fixed-size fields, which are read and written
+ * in place.  The strings and arrays follow the struct, each as an 8-byte header that holds the
+ * number of bytes of data, and then the data itself (including the null character, for strings),
+ * padded to a multiple of 8 bytes.  Everything in a message is thus naturally aligned.
+ */
+//--------------------------------------------------------------------------------------------------
+#define LE_IPC_ALIGN_SIZE(size) ( ((size) + 7) & ~(size_t)7 )
+
+
+//--------------------------------------------------------------------------------------------------
+// Packing and unpacking.
+//
+// The unpack functions check everything they get from the message, since it comes from another
+// process.  If anything is wrong, they set the message buffer pointer to NULL, and any later
+// unpack function then does nothing, so the message buffer pointer only has to be checked once,
+// after everything has been unpacked.
+//--------------------------------------------------------------------------------------------------
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Packs an array into a message.  It is a fatal error if it doesn't fit.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_ipc_PackArray
+(
+    uint8_t** msgBufPtrPtr,     ///< [IN/OUT] Where to pack the array.  Moved past it.
+    uint8_t* msgBufEndPtr,      ///< [IN] End of the message buffer.
+    const void* dataPtr,        ///< [IN] The array.
+    size_t dataSize             ///< [IN] Size of the array, in bytes.
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Packs a string into a message.  It is a fatal error if it is longer than the maximum given in
+ * the .api file, or if it doesn't fit.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_ipc_PackString
+(
+    uint8_t** msgBufPtrPtr,     ///< [IN/OUT] Where to pack the string.  Moved past it.
+    uint8_t* msgBufEndPtr,      ///< [IN] End of the message buffer.
+    const char* dataStr,        ///< [IN] The string.
+    size_t maxLength            ///< [IN] Maximum length, not including the null character.
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the next array in a message, which must be dataSize bytes.  The array is not copied.
+ *
+ * @return Pointer to the array, in the message buffer, or NULL if it is not valid.
+ */
+//--------------------------------------------------------------------------------------------------
+void* le_ipc_UnpackArray
+(
+    uint8_t** msgBufPtrPtr,     ///< [IN/OUT] Where the array is.  Moved past it, or set to NULL.
+    uint8_t* msgBufEndPtr,      ///< [IN] End of the message buffer.
+    size_t dataSize             ///< [IN] Expected size of the array, in bytes.
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Copies the next array in a message, which must be dataSize bytes, to a buffer.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_ipc_UnpackArrayCopy
+(
+    uint8_t** msgBufPtrPtr,     ///< [IN/OUT] Where the array is.  Moved past it, or set to NULL.
+    uint8_t* msgBufEndPtr,      ///< [IN] End of the message buffer.
+    void* dataPtr,              ///< [OUT] Buffer to copy the array to.
+    size_t dataSize             ///< [IN] Expected size of the array, in bytes.
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the next string in a message, which can be up to maxLength bytes, not including the null
+ * character.  The string is not copied.
+ *
+ * @return Pointer to the string, in the message buffer, or NULL if it is not valid.
+ */
+//--------------------------------------------------------------------------------------------------
+const char* le_ipc_UnpackString
+(
+    uint8_t** msgBufPtrPtr,     ///< [IN/OUT] Where the string is.  Moved past it, or set to NULL.
+    uint8_t* msgBufEndPtr,      ///< [IN] End of the message buffer.
+    size_t maxLength            ///< [IN] Maximum length, not including the null character.
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Copies the next string in a message to a buffer.  If the string doesn't fit, it is truncated
+ * (at a UTF-8 character boundary).
+ */
+//--------------------------------------------------------------------------------------------------
+void le_ipc_UnpackStringCopy
+(
+    uint8_t** msgBufPtrPtr,     ///< [IN/OUT] Where the string is.  Moved past it, or set to NULL.
+    uint8_t* msgBufEndPtr,      ///< [IN] End of the message buffer.
+    char* dataPtr,              ///< [OUT] Buffer to copy the string to.
+    size_t dataSize             ///< [IN] Size of the buffer, in bytes.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * The client side of an interface.  The generated client code has one of these, initialized
+ * using LE_IPC_CLIENT_INIT().
+ *
+ * Each thread that uses the interface gets its own session with the server.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    const char*     protocolId;     ///< Protocol ID (the interface's hash).
+    const char*     serviceName;    ///< Name of the service instance.
+    size_t          messageSize;    ///< Size of the interface's messages.
+    bool            isInitialized;  ///< true once threadDataKey has been created.
+    pthread_key_t   threadDataKey;  ///< Key of the calling thread's session data.
+}
+le_ipc_Client_t;
+
+/// Static initializer for le_ipc_Client_t.
+#define LE_IPC_CLIENT_INIT(protocolId, serviceName, messageSize) \
+    { (protocolId), (serviceName), (messageSize), false }
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Connects the calling thread to the service.  If the thread is already connected, the session is
+ * shared, and stays open until each connection has been disconnected.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_ipc_ConnectService
+(
+    le_ipc_Client_t* clientPtr      ///< [IN]
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Disconnects the calling thread from the service.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_ipc_DisconnectService
+(
+    le_ipc_Client_t* clientPtr      ///< [IN]
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the calling thread's session with the server.  It is a fatal error if the thread is not
+ * connected.
+ */
+//--------------------------------------------------------------------------------------------------
+le_msg_SessionRef_t le_ipc_GetSessionRef
+(
+    le_ipc_Client_t* clientPtr      ///< [IN]
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A handler that the client has registered with the server.  A pointer to it is sent to the
+ * server as the context pointer, and the server sends it back at the start of each message
+ * (indication) that is meant for the handler.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    le_event_HandlerFunc_t  handlerPtr;         ///< The client's handler function.
+    void*                   contextPtr;         ///< The client's context pointer.
+    le_event_HandlerRef_t   handlerRef;         ///< Handler reference returned by the server.
+    le_thread_Ref_t         callersThreadRef;   ///< Thread that registered the handler.
+    le_event_DeferredFunc_t handleFunc;         ///< Generated function that unpacks indications
+                                                ///  and calls the handler.  It is queued to the
+                                                ///  thread that registered the handler, and gets
+                                                ///  the message and this object as parameters.
+}
+le_ipc_ClientHandler_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Creates a client handler object, before an "add handler" request is sent to the server.
+ */
+//--------------------------------------------------------------------------------------------------
+le_ipc_ClientHandler_t* le_ipc_NewClientHandler
+(
+    le_event_HandlerFunc_t  handlerPtr,     ///< [IN]
+    void*                   contextPtr,     ///< [IN]
+    le_event_DeferredFunc_t handleFunc      ///< [IN]
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Stores the server's handler reference in a client handler object, once the server has added the
+ * handler.
+ *
+ * @return The reference that is returned to the client, which identifies the handler object.
+ */
+//--------------------------------------------------------------------------------------------------
+void* le_ipc_AddClientHandler
+(
+    le_ipc_ClientHandler_t* handlerPtr,     ///< [IN]
+    le_event_HandlerRef_t   handlerRef      ///< [IN] Handler reference returned by the server.
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Deletes a client handler object, before a "remove handler" request is sent to the server.  It is
+ * a fatal error if the reference is not valid.
+ *
+ * @return The server's handler reference.
+ */
+//--------------------------------------------------------------------------------------------------
+le_event_HandlerRef_t le_ipc_RemoveClientHandler
+(
+    void* ref       ///< [IN] Reference returned by le_ipc_AddClientHandler().
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reference to a request that was sent by le_ipc_StartRequest(), and whose response hasn't been
+ * collected yet.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct le_ipc_Pending* le_ipc_PendingRef_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sends a request to the server without waiting for the response.  The requests are sent in
+ * order, and any number of them can be waiting for their responses.
+ *
+ * @return The reference to pass to le_ipc_FinishRequest().
+ */
+//--------------------------------------------------------------------------------------------------
+le_ipc_PendingRef_t le_ipc_StartRequest
+(
+    le_msg_MessageRef_t msgRef      ///< [IN] The request.
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the response to a request that was sent by le_ipc_StartRequest(), waiting for it if it
+ * hasn't arrived yet.  This must be done exactly once for each request, by the thread that sent
+ * it.  It is a fatal error if the response is not for the expected message ID.
+ *
+ * @return The response, or NULL if the session closed before it arrived.
+ */
+//--------------------------------------------------------------------------------------------------
+le_msg_MessageRef_t le_ipc_FinishRequest
+(
+    le_ipc_PendingRef_t pendingRef, ///< [IN]
+    uint32_t msgId                  ///< [IN] Message ID of the request.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A server function: unpacks a client's request, calls the server's implementation of the API
+ * function, and responds.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    const char* name;                                   ///< Name of the API function.
+    void (*handleFunc)(le_msg_MessageRef_t msgRef);     ///< Handles a request.
+}
+le_ipc_ServerFunc_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Call statistics for a server function.  These are read by the inspect tool (inspect ipc).
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint64_t    numCalls;       ///< Number of requests handled.
+    uint64_t    totalNs;        ///< Total time spent handling them (nanoseconds).
+}
+le_ipc_ServerFuncStats_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * The server side of an interface.  The generated server code has one of these, initialized
+ * using LE_IPC_SERVER_INIT().
+ *
+ * Requests are dispatched through funcTable, which is indexed by message ID, and their call
+ * statistics are kept in the matching entries of funcStats.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    const char*                 protocolId;         ///< Protocol ID (the interface's hash).
+    const char*                 serviceName;        ///< Name of the service instance.
+    size_t                      messageSize;        ///< Size of the interface's messages.
+    const le_ipc_ServerFunc_t*  funcTable;          ///< Server function for each message ID.
+    le_ipc_ServerFuncStats_t*   funcStats;          ///< Statistics for each message ID.
+    size_t                      numFuncs;           ///< Number of entries in the two tables.
+    le_msg_ServiceRef_t         serviceRef;         ///< Set by le_ipc_AdvertiseService().
+    le_msg_SessionRef_t         clientSessionRef;   ///< Session of the request being handled,
+                                                    ///  if any.
+    le_dls_Link_t               link;               ///< Link in the process's list of servers.
+}
+le_ipc_Server_t;
+
+/// Static initializer for le_ipc_Server_t.  funcTable and funcStats must be arrays of the same
+/// size.
+#define LE_IPC_SERVER_INIT(protocolId, serviceName, messageSize, funcTable, funcStats) \
+    { (protocolId), (serviceName), (messageSize), (funcTable), (funcStats), \
+      NUM_ARRAY_MEMBERS(funcTable), NULL, NULL, { NULL, NULL } }
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Creates and advertises the service.  Handlers that a client registered are removed when the
+ * client's session closes.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_ipc_AdvertiseService
+(
+    le_ipc_Server_t* serverPtr      ///< [IN]
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Function that removes a handler that was registered by a client.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef void (*le_ipc_RemoveHandlerFunc_t)(void* handlerRef);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A handler that a client has registered with the server.  A pointer to it is given to the server
+ * function as the context pointer.  Only the client that registered it can remove it.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    le_msg_ServiceRef_t         serviceRef;         ///< The service the handler was added to.
+    le_msg_SessionRef_t         clientSessionRef;   ///< The client to send indications to.
+    void*                       contextPtr;         ///< The client's context pointer.
+    le_event_HandlerRef_t       handlerRef;         ///< Handler reference returned by the server
+                                                    ///  function.
+    le_ipc_RemoveHandlerFunc_t  removeHandlerFunc;  ///< Server function to remove the handler.
+}
+le_ipc_ServerHandler_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Creates a server handler object, before the server's "add handler" function is called.
+ */
+//--------------------------------------------------------------------------------------------------
+le_ipc_ServerHandler_t* le_ipc_NewServerHandler
+(
+    le_msg_MessageRef_t msgRef,     ///< [IN] The "add handler" request.
+    void*               contextPtr  ///< [IN] The client's context pointer.
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Stores the server's handler reference in a server handler object, once the server has added the
+ * handler.
+ *
+ * @return The reference that is returned to the client, which identifies the handler object.
+ */
+//--------------------------------------------------------------------------------------------------
+void* le_ipc_AddServerHandler
+(
+    le_ipc_ServerHandler_t*     handlerPtr,         ///< [IN]
+    le_event_HandlerRef_t       handlerRef,         ///< [IN]
+    le_ipc_RemoveHandlerFunc_t  removeHandlerFunc   ///< [IN]
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Deletes a server handler object, before the server's "remove handler" function is called.  A
+ * client that gives a reference that is not valid, or that refers to a handler added by another
+ * client or to another service, is killed.
+ *
+ * @return The server's handler reference, or NULL if the reference is not valid.
+ */
+//--------------------------------------------------------------------------------------------------
+le_event_HandlerRef_t le_ipc_RemoveServerHandler
+(
+    le_msg_MessageRef_t msgRef,     ///< [IN] The "remove handler" request.
+    void*               ref         ///< [IN] Reference returned by le_ipc_AddServerHandler().
+);
+
+/* @endcond */
+
+#endif // LEGATO_IPC_INCLUDE_GUARD
@@ -179,6 +179,15 @@
  * blocked and would therefore be unable to receive the request and respond to it, resulting in
  * a deadlock.
  *
+ * A client running inside a @ref c_coro "coroutine" can use le_msg_RequestAwaitResponse()
+ * instead.  It looks like le_msg_RequestSyncResponse() to the caller, but only the calling
+ * coroutine waits for the response; the rest of the thread's event handlers keep running.
+ * Outside a coroutine, it behaves exactly like le_msg_RequestSyncResponse().
+ *
+ * @code
+ *     responseMsgRef = le_msg_RequestAwaitResponse(msgRef);
+ * @endcode
+ *
  * When the client is finished with it, the <b> client must release its reference
  * to the response message </b> by calling le_msg_ReleaseMsg().
  *
@@ -1397,6 +1406,30 @@ le_msg_MessageRef_t le_msg_RequestSyncResponse
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Requests a response from a server by sending it a request, and waits for the response to arrive
+ * or for the transaction to terminate without a response.
+ *
+ * When called from inside a coroutine (see @ref c_coro), only the calling coroutine waits.  The
+ * thread's event loop keeps running other handlers until the response arrives.  When called from
+ * outside a coroutine, this is the same as le_msg_RequestSyncResponse().
+ *
+ * @return  Reference to the response message, or NULL if the transaction terminated without a
+ *          response.
+ *
+ * @note
+ *        - This function can only be used on the client side of a session.
+ *        - Unlike le_msg_RequestSyncResponse(), a coroutine can use this when the client and
+ *          server are running in the same thread.
+ */
+//--------------------------------------------------------------------------------------------------
+le_msg_MessageRef_t le_msg_RequestAwaitResponse
+(
+    le_msg_MessageRef_t msgRef      ///< [in] Reference to the request message.
+);
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Sends a response back to the client that send the request message.
@@ -135,7 +135,12 @@
  * 
  * The tool threadlook will report if a given thread is currently
  * holding the lock on a mutex or waiting for a mutex along with the mutex name.
- * 
+ *
+ * To keep locking cheap, the list of mutexes held by a thread is only maintained for Traceable
+ * mutexes, and a thread only shows up as waiting on a mutex when it actually has to block.  To
+ * track every mutex held by every thread (at some cost in speed), build the framework with
+ * LOCK_TRACKING=1.
+ *
  * If there are Traceable mutexes in a process, it's possible to use the
  * log tool to enable or disable tracing on that mutex.  The trace keyword name is
  * the name of the process, the name of the component, and the name of the mutex, separated by
@@ -42,7 +42,7 @@
  *   -# For diagnostics.
  *
  * Threads are created in a suspended state.  In this state, attributes like
- * scheduling priority and stack size can use the appropriate "Set" functions.
+ * scheduling priority, stack size and CPU affinity can use the appropriate "Set" functions.
  * All attributes have default values so it is not necessary to set any
  * attributes (other than the name and main function address, which are passed into
  * le_thread_Create() ).  When all attributes have been set, the thread can be started by calling
@@ -309,6 +309,32 @@ le_result_t le_thread_SetStackSize
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Restricts a thread to running on a given set of CPUs (cores).
+ *
+ * Bit N of the mask selects CPU N (as numbered by the kernel, e.g., in /proc/cpuinfo).  CPUs that
+ * are not online are ignored, but at least one CPU in the mask must be online.
+ *
+ * This can be called either before or after the thread is started.  Threads created by a thread
+ * inherit its CPU affinity.
+ *
+ * @note It's generally not necessary to set the CPU affinity.  The kernel's scheduler does a good
+ *       job of spreading threads across CPUs.  Pinning is useful for keeping latency-sensitive
+ *       threads away from each other, or for keeping a thread's working set in one core's cache.
+ *
+ * @return
+ *      - LE_OK if successful.
+ *      - LE_OUT_OF_RANGE if none of the CPUs in the mask are online.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t le_thread_SetCpuAffinity
+(
+    le_thread_Ref_t     thread,     ///< [IN]
+    uint64_t            cpuMask     ///< [IN] Bit mask of CPUs the thread may run on.
+);
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Makes a thread "joinable", meaning that when it finishes, it will remain in existence until
@@ -0,0 +1,241 @@
+/**
+ * @page c_threadPool Thread Pool API
+ *
+ * @ref le_threadPool.h "API Reference"
+ *
+ * <HR>
+ *
+ * @ref threadPoolCreating <br>
+ * @ref threadPoolSubmitting <br>
+ * @ref threadPoolScheduling <br>
+ * @ref threadPoolDeleting <br>
+ *
+ * A Thread Pool is a fixed set of worker threads that run functions on behalf of other threads.
+ * It is intended for work that is too slow to be done inside an event handler (e.g., compression,
+ * checksumming, parsing a large file) but too short-lived to justify creating a dedicated
+ * thread with its own event loop.
+ *
+ * Each piece of work is a pair of functions:
+ *  - a @b work function that runs in one of the pool's worker threads, and
+ *  - an optional @b completion function that runs afterwards in the thread that submitted the
+ *    work, from that thread's @ref c_eventLoop "Event Loop".
+ *
+ * This means that the submitting thread never needs to lock anything to find out that its work is
+ * done: the result shows up as just another event.
+ *
+ * @section threadPoolCreating Creating a Thread Pool
+ *
+ * A Thread Pool is created by calling le_threadPool_Create().  Like threads, pools are created in
+ * a suspended state, so that attributes of the worker threads can be set before they are started:
+ *  - le_threadPool_SetPriority() sets the scheduling priority of the workers.
+ *  - le_threadPool_SetStackSize() sets the stack size of the workers.
+ *  - le_threadPool_SetCpuAffinity() restricts the workers to a given set of CPUs.
+ *
+ * When all attributes have been set, the workers are started by calling le_threadPool_Start().
+ *
+ * @code
+ * le_threadPool_Ref_t poolRef = le_threadPool_Create("crunchers", 0); // One worker per CPU.
+ * le_threadPool_SetStackSize(poolRef, 32 * 1024);
+ * le_threadPool_Start(poolRef);
+ * @endcode
+ *
+ * @section threadPoolSubmitting Submitting Work
+ *
+ * Work is given to a pool using le_threadPool_Submit().
+ *
+ * @code
+ * static void ComputeChecksum(void* param1Ptr, void* param2Ptr)
+ * {
+ *     Job_t* jobPtr = param1Ptr;
+ *
+ *     jobPtr->checksum = crc32(jobPtr->buffPtr, jobPtr->size);    // Runs in a worker thread.
+ * }
+ *
+ * static void ChecksumDone(void* param1Ptr, void* param2Ptr)
+ * {
+ *     Job_t* jobPtr = param1Ptr;
+ *
+ *     SendReply(jobPtr);                                          // Runs in the submitter thread.
+ * }
+ *
+ * ...
+ *     le_threadPool_Submit(poolRef, ComputeChecksum, ChecksumDone, jobPtr, NULL);
+ * @endcode
+ *
+ * Work functions can themselves submit more work to the same pool.
+ *
+ * @warning If a completion function is given, the submitting thread must be running its Event
+ *          Loop, or the completion function will never be called.
+ *
+ * @section threadPoolScheduling Scheduling
+ *
+ * Each worker has its own queue of work.  Work submitted from outside the pool is spread across
+ * the workers' queues in turn, while work submitted by a worker is put on that worker's own queue
+ * (where it is likely to find its data still in the CPU cache).  A worker always takes the newest
+ * work from its own queue first.  When its own queue is empty, it "steals" the oldest work from
+ * the other workers' queues, so no worker is idle while there is work waiting anywhere in the
+ * pool.
+ *
+ * There are no guarantees about the order in which submitted work is run.  If order matters,
+ * submit the next piece of work from the completion function of the previous one.
+ *
+ * @section threadPoolDeleting Deleting a Thread Pool
+ *
+ * le_threadPool_Delete() waits for all work that has already been submitted to finish running
+ * and then stops and joins all the worker threads.  Completion functions for that work will still
+ * be queued to their submitting threads' Event Loops.
+ *
+ * Nothing must be submitted to a pool once it is being deleted.
+ *
+ * <HR>
+ *
+ * Copyright (C) Sierra Wireless, Inc. 2014.  Use of this work is subject to license.
+ */
+
+
+/** @file le_threadPool.h
+ *
+ * Legato @ref c_threadPool include file.
+ *
+ * Copyright (C) Sierra Wireless, Inc. 2014.  Use of this work is subject to license.
+ */
+
+#ifndef LEGATO_THREAD_POOL_INCLUDE_GUARD
+#define LEGATO_THREAD_POOL_INCLUDE_GUARD
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reference to a Thread Pool.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct le_threadPool* le_threadPool_Ref_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Prototype for work and completion functions.
+ *
+ * The two parameters are the ones that were passed to le_threadPool_Submit().
+ */
+//--------------------------------------------------------------------------------------------------
+typedef void (*le_threadPool_Func_t)
+(
+    void* param1Ptr,    ///< [IN] Value passed to le_threadPool_Submit() as param1Ptr.
+    void* param2Ptr     ///< [IN] Value passed to le_threadPool_Submit() as param2Ptr.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Creates a Thread Pool.  The worker threads won't start until le_threadPool_Start() is called.
+ *
+ * @return
+ *      A reference to the Thread Pool (doesn't return if failed).
+ */
+//--------------------------------------------------------------------------------------------------
+le_threadPool_Ref_t le_threadPool_Create
+(
+    const char* name,           ///< [IN] Name of the pool.  Worker threads are named after it.
+    size_t      numWorkers      ///< [IN] Number of worker threads, or 0 for one per online CPU.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sets the priority of the worker threads of a Thread Pool.  Must be called before
+ * le_threadPool_Start().
+ *
+ * @return
+ *      - LE_OK if successful.
+ *      - LE_OUT_OF_RANGE if the priority level requested is out of range.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t le_threadPool_SetPriority
+(
+    le_threadPool_Ref_t     pool,       ///< [IN]
+    le_thread_Priority_t    priority    ///< [IN]
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sets the stack size of the worker threads of a Thread Pool.  Must be called before
+ * le_threadPool_Start().
+ *
+ * @return
+ *      - LE_OK if successful.
+ *      - LE_OVERFLOW if the stack size requested is too small.
+ *      - LE_OUT_OF_RANGE if the stack size requested is too large.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t le_threadPool_SetStackSize
+(
+    le_threadPool_Ref_t     pool,       ///< [IN]
+    size_t                  size        ///< [IN] Stack size, in bytes.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Restricts the worker threads of a Thread Pool to a given set of CPUs.  Must be called before
+ * le_threadPool_Start().  See le_thread_SetCpuAffinity().
+ *
+ * @return
+ *      - LE_OK if successful.
+ *      - LE_OUT_OF_RANGE if none of the CPUs in the mask are online.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t le_threadPool_SetCpuAffinity
+(
+    le_threadPool_Ref_t     pool,       ///< [IN]
+    uint64_t                cpuMask     ///< [IN] Bit mask of CPUs the workers may run on.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Starts the worker threads of a Thread Pool.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_threadPool_Start
+(
+    le_threadPool_Ref_t     pool        ///< [IN]
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Submits work to a Thread Pool.
+ *
+ * The work function will be called in one of the pool's worker threads.  When it returns, the
+ * completion function (if not NULL) will be queued to the calling thread's Event Loop.
+ *
+ * Work can be submitted before the pool is started; it will be run once the workers start.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_threadPool_Submit
+(
+    le_threadPool_Ref_t     pool,           ///< [IN]
+    le_threadPool_Func_t    workFunc,       ///< [IN] Function to run in a worker thread.
+    le_threadPool_Func_t    completionFunc, ///< [IN] Function to run in the calling thread
+                                            ///       afterwards (or NULL).
+    void*                   param1Ptr,      ///< [IN] Value to pass to both functions.
+    void*                   param2Ptr       ///< [IN] Value to pass to both functions.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Deletes a Thread Pool.  Blocks until all work that was submitted to the pool has been run and
+ * all the worker threads have exited.
+ *
+ * @warning Must not be called from one of the pool's own worker threads.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_threadPool_Delete
+(
+    le_threadPool_Ref_t     pool        ///< [IN]
+);
+
+
+#endif // LEGATO_THREAD_POOL_INCLUDE_GUARD
@@ -20,11 +20,13 @@
  * @subpage c_pathIter  <br>
  * @subpage c_print  <br>
  * @subpage c_clock  <br>
+ * @subpage c_coro  <br>
  * @subpage c_safeRef  <br>
  * @subpage c_semaphore  <br>
  * @subpage c_signals  <br>
  * @subpage c_singlyLinkedList  <br>
  * @subpage c_threading  <br>
+ * @subpage c_threadPool  <br>
  * @subpage c_timer  <br>
  * @subpage c_test  <br>
  * @subpage c_utf8  <br>
@@ -138,6 +140,10 @@
 extern "C" {
 #endif
 
+// liblegato is built with -fvisibility=hidden.  Everything declared in the public API headers
+// is exported from it.
+#pragma GCC visibility push(default)
+
 #include "le_basics.h"
 #include "le_doublyLinkedList.h"
 #include "le_singlyLinkedList.h"
@@ -149,12 +155,15 @@ extern "C" {
 #include "le_semaphore.h"
 #include "le_safeRef.h"
 #include "le_thread.h"
+#include "le_threadPool.h"
 #include "le_eventLoop.h"
+#include "le_coro.h"
 #include "le_hashmap.h"
 #include "le_signals.h"
 #include "le_args.h"
 #include "le_timer.h"
 #include "le_messaging.h"
+#include "le_ipc.h"
 #include "le_test.h"
 #include "le_path.h"
 #include "le_pathIter.h"
@@ -162,6 +171,8 @@ extern "C" {
 #include "le_dir.h"
 #include "le_fileLock.h"
 
+#pragma GCC visibility pop
+
 #ifdef __cplusplus
 }
 #endif
@@ -5,6 +5,7 @@
  */
 
 #include "legato.h"
+#include "args.h"
 
 
 //--------------------------------------------------------------------------------------------------
@@ -20,7 +20,7 @@
  * function.
  */
 //--------------------------------------------------------------------------------------------------
-void arg_SetArgs
+LE_SHARED void arg_SetArgs
 (
     const size_t    argc,   ///< [IN] argc from main.
     char**          argv    ///< [IN] argv from main.
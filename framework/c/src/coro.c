@@ -0,0 +1,562 @@
+/** @file coro.c
+ *
+ * Coroutine implementation.  See le_coro.h for the user-visible behaviour.
+ *
+ * Each coroutine has its own stack, allocated with mmap() when the coroutine is started, and its
+ * own machine context (ucontext_t).  A coroutine only ever runs inside RunCoro(), which is a
+ * function queued to the owning thread's Event Loop.  RunCoro() switches from the Event Loop's
+ * stack to the coroutine's stack, and the coroutine switches back to RunCoro() when it suspends,
+ * yields or returns from its main function.  So, from the Event Loop's point of view, each
+ * "slice" of a coroutine's execution is just another queued function.
+ *
+ * Resuming a coroutine queues RunCoro() to the owning thread again.  Exactly one RunCoro() is
+ * ever outstanding for a given coroutine at a time, which is enforced by the coroutine's state
+ * (protected by the module's mutex, because le_coro_Resume() can be called from any thread).
+ *
+ * When the main function returns, the coroutine context ends and control passes (through the
+ * context's uc_link) back to RunCoro(), which frees the stack now that nothing is running on it.
+ *
+ * Copyright (C) Sierra Wireless, Inc. 2014.  Use of this work is subject to license.
+ */
+
+#include "legato.h"
+#include "coro.h"
+
+#include <ucontext.h>
+#include <sys/mman.h>
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum coroutine name size in bytes.
+ */
+//--------------------------------------------------------------------------------------------------
+#define MAX_CORO_NAME_BYTES     24
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Default stack size of a coroutine, in bytes.
+ */
+//--------------------------------------------------------------------------------------------------
+#define DEFAULT_STACK_SIZE      (64 * 1024)
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of Coroutine objects to pre-allocate.
+ */
+//--------------------------------------------------------------------------------------------------
+#define DEFAULT_CORO_POOL_SIZE  8
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * State of a coroutine.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef enum
+{
+    CORO_STATE_CREATED,     ///< Created, but not started yet.
+    CORO_STATE_RUNNABLE,    ///< RunCoro() has been queued to the owning thread's Event Loop.
+    CORO_STATE_RUNNING,     ///< Running on its own stack.
+    CORO_STATE_SUSPENDED,   ///< Waiting for le_coro_Resume().
+    CORO_STATE_DONE         ///< Main function has returned.
+}
+CoroState_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Coroutine object.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct le_coro
+{
+    char            name[MAX_CORO_NAME_BYTES];  ///< Name of the coroutine.
+    le_coro_Func_t  mainFunc;       ///< Main function.
+    void*           contextPtr;     ///< Value to pass to the main function.
+    le_thread_Ref_t threadRef;      ///< Thread that created the coroutine (and runs it).
+    le_coro_Ref_t   safeRef;        ///< Safe reference to this object.
+    CoroState_t     state;          ///< Current state.
+    bool            resumePending;  ///< true = resumed while not suspended.
+    size_t          stackSize;      ///< Usable size of the stack, in bytes.
+    void*           mapPtr;         ///< Start of the stack mapping (guard page), or NULL.
+    size_t          mapSize;        ///< Size of the stack mapping, including the guard page.
+    ucontext_t      context;        ///< Saved context of the coroutine.
+    ucontext_t      returnContext;  ///< Saved context of the RunCoro() that is running it.
+}
+Coro_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Pool from which Coroutine objects are allocated.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_mem_PoolRef_t CoroPool;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Safe reference map for Coroutines.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_ref_MapRef_t CoroRefMap;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Key under which a thread keeps a pointer to the Coroutine that it is currently running, in
+ * thread-local storage.  NULL when the thread isn't running a coroutine.
+ */
+//--------------------------------------------------------------------------------------------------
+static pthread_key_t CurrentCoroKey;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Mutex used to protect the safe reference map and the state of all coroutines.
+ */
+//--------------------------------------------------------------------------------------------------
+static pthread_mutex_t Mutex = PTHREAD_MUTEX_INITIALIZER;   // POSIX "Fast" mutex.
+
+/// Locks the mutex.
+#define LOCK    LE_ASSERT(pthread_mutex_lock(&Mutex) == 0);
+
+/// Unlocks the mutex.
+#define UNLOCK  LE_ASSERT(pthread_mutex_unlock(&Mutex) == 0);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get a pointer to the Coroutine that is running in the calling thread.  Kills the process if
+ * not called from inside a coroutine.
+ */
+//--------------------------------------------------------------------------------------------------
+static Coro_t* GetCurrentCoroPtr
+(
+    void
+)
+{
+    Coro_t* coroPtr = pthread_getspecific(CurrentCoroKey);
+
+    LE_FATAL_IF(coroPtr == NULL, "Not called from inside a coroutine.");
+
+    return coroPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get a pointer to a Coroutine from its safe reference.  Kills the process if the reference is
+ * not valid.
+ *
+ * @note Must be called with the mutex locked.
+ */
+//--------------------------------------------------------------------------------------------------
+static Coro_t* LookupCoroPtr
+(
+    le_coro_Ref_t   coroRef
+)
+{
+    Coro_t* coroPtr = le_ref_Lookup(CoroRefMap, coroRef);
+
+    LE_FATAL_IF(coroPtr == NULL, "Invalid coroutine reference %p.", coroRef);
+
+    return coroPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Switch from a coroutine back to the RunCoro() that is running it.  Returns when the coroutine
+ * is next run.
+ */
+//--------------------------------------------------------------------------------------------------
+static void SwitchOut
+(
+    Coro_t* coroPtr
+)
+{
+    LE_ASSERT(swapcontext(&coroPtr->context, &coroPtr->returnContext) == 0);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Delete a Coroutine whose main function has returned.
+ */
+//--------------------------------------------------------------------------------------------------
+static void DeleteCoro
+(
+    Coro_t* coroPtr
+)
+{
+    LE_ASSERT(munmap(coroPtr->mapPtr, coroPtr->mapSize) == 0);
+
+    LOCK
+    le_ref_DeleteRef(CoroRefMap, coroPtr->safeRef);
+    UNLOCK
+
+    le_mem_Release(coroPtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Entry point of every coroutine context.  Runs the coroutine's main function.  When this returns,
+ * control passes to the context's uc_link (the RunCoro() that is running the coroutine).
+ */
+//--------------------------------------------------------------------------------------------------
+static void CoroMain
+(
+    void
+)
+{
+    Coro_t* coroPtr = GetCurrentCoroPtr();
+
+    coroPtr->mainFunc(coroPtr->contextPtr);
+
+    LOCK
+    coroPtr->state = CORO_STATE_DONE;
+    UNLOCK
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Queued function that runs a coroutine until it next suspends, yields or finishes.
+ */
+//--------------------------------------------------------------------------------------------------
+static void RunCoro
+(
+    void* coroRef,      ///< Safe reference to the coroutine.
+    void* unused
+)
+{
+    LOCK
+    Coro_t* coroPtr = LookupCoroPtr(coroRef);
+    LE_ASSERT(coroPtr->state == CORO_STATE_RUNNABLE);
+    coroPtr->state = CORO_STATE_RUNNING;
+    UNLOCK
+
+    LE_FATAL_IF(pthread_getspecific(CurrentCoroKey) != NULL,
+                "Coroutine '%s' run from inside another coroutine.",
+                coroPtr->name);
+
+    LE_ASSERT(pthread_setspecific(CurrentCoroKey, coroPtr) == 0);
+
+    LE_ASSERT(swapcontext(&coroPtr->returnContext, &coroPtr->context) == 0);
+
+    LE_ASSERT(pthread_setspecific(CurrentCoroKey, NULL) == 0);
+
+    // Only this thread sets the DONE state, so no need to lock to check for it.
+    if (coroPtr->state == CORO_STATE_DONE)
+    {
+        DeleteCoro(coroPtr);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initializes the Coroutine module.  This function must be called at start-up, after the
+ * memory pool, safe reference, thread and event loop modules are initialized.
+ */
+//--------------------------------------------------------------------------------------------------
+void coro_Init
+(
+    void
+)
+{
+    CoroPool = le_mem_CreatePool("Coroutines", sizeof(Coro_t));
+    le_mem_ExpandPool(CoroPool, DEFAULT_CORO_POOL_SIZE);
+
+    CoroRefMap = le_ref_CreateMap("Coroutines", DEFAULT_CORO_POOL_SIZE);
+
+    LE_ASSERT(pthread_key_create(&CurrentCoroKey, NULL) == 0);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Creates a Coroutine in the calling thread.  The coroutine won't run until le_coro_Start() is
+ * called.
+ *
+ * @return
+ *      A reference to the Coroutine (doesn't return if failed).
+ */
+//--------------------------------------------------------------------------------------------------
+le_coro_Ref_t le_coro_Create
+(
+    const char*     name,       ///< [IN] Name of the coroutine (for diagnostics).
+    le_coro_Func_t  mainFunc,   ///< [IN] Main function of the coroutine.
+    void*           contextPtr  ///< [IN] Value to pass to the main function.
+)
+{
+    Coro_t* coroPtr = le_mem_ForceAlloc(CoroPool);
+
+    memset(coroPtr, 0, sizeof(*coroPtr));
+
+    LE_WARN_IF(le_utf8_Copy(coroPtr->name, name, sizeof(coroPtr->name), NULL) == LE_OVERFLOW,
+               "Coroutine name '%s' truncated to '%s'.",
+               name,
+               coroPtr->name);
+
+    coroPtr->mainFunc = mainFunc;
+    coroPtr->contextPtr = contextPtr;
+    coroPtr->threadRef = le_thread_GetCurrent();
+    coroPtr->state = CORO_STATE_CREATED;
+    coroPtr->stackSize = DEFAULT_STACK_SIZE;
+
+    LOCK
+    coroPtr->safeRef = le_ref_CreateRef(CoroRefMap, coroPtr);
+    UNLOCK
+
+    return coroPtr->safeRef;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sets the stack size of a Coroutine.  Must be called before le_coro_Start().
+ *
+ * @return
+ *      - LE_OK if successful.
+ *      - LE_OVERFLOW if the stack size requested is too small.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t le_coro_SetStackSize
+(
+    le_coro_Ref_t   coroRef,    ///< [IN]
+    size_t          size        ///< [IN] Stack size, in bytes.
+)
+{
+    le_result_t result = LE_OK;
+
+    LOCK
+
+    Coro_t* coroPtr = LookupCoroPtr(coroRef);
+
+    LE_FATAL_IF(coroPtr->state != CORO_STATE_CREATED,
+                "Attempt to set stack size of coroutine '%s' after it was started.",
+                coroPtr->name);
+
+    if (size < PTHREAD_STACK_MIN)
+    {
+        result = LE_OVERFLOW;
+    }
+    else
+    {
+        coroPtr->stackSize = size;
+    }
+
+    UNLOCK
+
+    return result;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Starts a Coroutine.  Its main function will be called from the creating thread's Event Loop.
+ *
+ * @note Must be called from the thread that created the coroutine.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_coro_Start
+(
+    le_coro_Ref_t   coroRef     ///< [IN]
+)
+{
+    LOCK
+    Coro_t* coroPtr = LookupCoroPtr(coroRef);
+    UNLOCK
+
+    LE_FATAL_IF(coroPtr->state != CORO_STATE_CREATED,
+                "Coroutine '%s' has already been started.",
+                coroPtr->name);
+
+    LE_FATAL_IF(coroPtr->threadRef != le_thread_GetCurrent(),
+                "Coroutine '%s' started by a thread other than the one that created it.",
+                coroPtr->name);
+
+    // Round the stack up to a whole number of pages and put a guard page below it.
+    size_t pageSize = (size_t)sysconf(_SC_PAGESIZE);
+    size_t stackSize = (coroPtr->stackSize + pageSize - 1) & ~(pageSize - 1);
+
+    coroPtr->mapSize = stackSize + pageSize;
+    coroPtr->mapPtr = mmap(NULL,
+                           coroPtr->mapSize,
+                           PROT_READ | PROT_WRITE,
+                           MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK,
+                           -1,
+                           0);
+
+    LE_FATAL_IF(coroPtr->mapPtr == MAP_FAILED,
+                "Failed to allocate %zu byte stack for coroutine '%s' (%m).",
+                stackSize,
+                coroPtr->name);
+
+    LE_ASSERT(mprotect(coroPtr->mapPtr, pageSize, PROT_NONE) == 0);
+
+    LE_ASSERT(getcontext(&coroPtr->context) == 0);
+
+    coroPtr->context.uc_stack.ss_sp = (uint8_t*)coroPtr->mapPtr + pageSize;
+    coroPtr->context.uc_stack.ss_size = stackSize;
+    coroPtr->context.uc_link = &coroPtr->returnContext;
+
+    makecontext(&coroPtr->context, CoroMain, 0);
+
+    LOCK
+    coroPtr->state = CORO_STATE_RUNNABLE;
+    UNLOCK
+
+    le_event_QueueFunction(RunCoro, coroRef, NULL);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the reference of the calling Coroutine.
+ *
+ * @return
+ *      A reference to the running Coroutine, or NULL if not called from inside a coroutine.
+ */
+//--------------------------------------------------------------------------------------------------
+le_coro_Ref_t le_coro_GetCurrent
+(
+    void
+)
+{
+    Coro_t* coroPtr = pthread_getspecific(CurrentCoroKey);
+
+    if (coroPtr == NULL)
+    {
+        return NULL;
+    }
+
+    return coroPtr->safeRef;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Suspends the calling Coroutine until le_coro_Resume() is called for it.  Other handlers in the
+ * thread's Event Loop run in the meantime.
+ *
+ * @note Must be called from inside a coroutine.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_coro_Suspend
+(
+    void
+)
+{
+    Coro_t* coroPtr = GetCurrentCoroPtr();
+
+    LOCK
+
+    if (coroPtr->resumePending)
+    {
+        coroPtr->resumePending = false;
+
+        UNLOCK
+
+        return;
+    }
+
+    // Once this is unlocked, another thread may queue RunCoro() to this thread, but it can't
+    // run until this thread gets back to its Event Loop.
+    coroPtr->state = CORO_STATE_SUSPENDED;
+
+    UNLOCK
+
+    SwitchOut(coroPtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Resumes a suspended Coroutine.  The coroutine will continue running from the thread's Event
+ * Loop.  Can be called from any thread.
+ *
+ * If the coroutine isn't suspended, its next call to le_coro_Suspend() will return immediately.
+ * If the coroutine has already finished, this does nothing.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_coro_Resume
+(
+    le_coro_Ref_t   coroRef     ///< [IN]
+)
+{
+    bool needsRun = false;
+
+    LOCK
+
+    // A coroutine may finish before a callback in another thread gets around to resuming it.
+    Coro_t* coroPtr = le_ref_Lookup(CoroRefMap, coroRef);
+
+    if (coroPtr == NULL)
+    {
+        UNLOCK
+
+        return;
+    }
+
+    le_thread_Ref_t threadRef = coroPtr->threadRef;
+
+    switch (coroPtr->state)
+    {
+        case CORO_STATE_CREATED:
+            LE_FATAL("Attempt to resume coroutine '%s' before it was started.", coroPtr->name);
+            break;
+
+        case CORO_STATE_SUSPENDED:
+            coroPtr->state = CORO_STATE_RUNNABLE;
+            needsRun = true;
+            break;
+
+        case CORO_STATE_RUNNABLE:
+        case CORO_STATE_RUNNING:
+            coroPtr->resumePending = true;
+            break;
+
+        case CORO_STATE_DONE:
+            // Finishing; nothing left to resume.
+            break;
+    }
+
+    UNLOCK
+
+    if (needsRun)
+    {
+        le_event_QueueFunctionToThread(threadRef, RunCoro, coroRef, NULL);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Lets everything that is currently queued to the calling thread's Event Loop run, and then
+ * continues running the calling Coroutine.
+ *
+ * @note Must be called from inside a coroutine.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_coro_Yield
+(
+    void
+)
+{
+    Coro_t* coroPtr = GetCurrentCoroPtr();
+
+    LOCK
+    coroPtr->state = CORO_STATE_RUNNABLE;
+    UNLOCK
+
+    le_event_QueueFunction(RunCoro, coroPtr->safeRef, NULL);
+
+    SwitchOut(coroPtr);
+}
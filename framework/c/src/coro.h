@@ -0,0 +1,25 @@
+/** @file coro.h
+ *
+ * Coroutine module's intra-framework header file.  This file exposes type definitions and
+ * function interfaces to other modules inside the framework implementation.
+ *
+ * Copyright (C) Sierra Wireless, Inc. 2014.  Use of this work is subject to license.
+ */
+
+#ifndef LEGATO_SRC_CORO_H_INCLUDE_GUARD
+#define LEGATO_SRC_CORO_H_INCLUDE_GUARD
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initializes the Coroutine module.  This function must be called at start-up, after the
+ * memory pool, safe reference, thread and event loop modules are initialized.
+ */
+//--------------------------------------------------------------------------------------------------
+void coro_Init
+(
+    void
+);
+
+
+#endif  // LEGATO_SRC_CORO_H_INCLUDE_GUARD
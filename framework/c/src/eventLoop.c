@@ -73,8 +73,8 @@
  * The Event Loop is an infinite loop that calls epoll_wait() and then responds to any fd events
  * that epoll_wait() reports.  If epoll_wait() reports an event on the eventfd, then an Event Report
  * is popped off the Event Queue and processed.  If epoll_wait() reports an event on any other fd,
- * FD Event Reports are created and pushed onto Event Queues according to what handlers are
- * registered for those events.  All pending Event Reports are processed until the Event Queue is
+ * the handlers registered for those events are called directly (see fdMonitor.c), without going
+ * through the Event Queue.  All pending Event Reports are processed until the Event Queue is
  * empty before returning to epoll_wait().  (NOTE: This choice was made to save system call
  * overhead in times of heavy load.  Unfortunately, it also means that if event handlers always add
  * new events to the queue, then epoll_wait() will never be called and therefore fd events will
@@ -88,6 +88,10 @@
  * multithreaded race conditions.  A Mutex is provided for that purpose, and it can be locked
  * and unlocked using the macros LOCK and UNLOCK.
  *
+ * The exception is the Event Queue itself, which is a lock-free Multi-Producer, Single-Consumer
+ * queue (see mpscQueue.h).  Any thread can push Reports onto it without holding the Mutex, and
+ * only the thread that owns it ever pops Reports off of it.
+ *
  * ----
  *
  * Copyright (C) Sierra Wireless, Inc. 2013. All rights reserved. Use of this work is subject to license.
@@ -97,6 +101,9 @@
 #include "eventLoop.h"
 #include "thread.h"
 #include "fdMonitor.h"
+#include "addr.h"
+#include "files.h"
+#include "fileDescriptor.h"
 
 #include <pthread.h>
 #include <sys/epoll.h>
@@ -343,6 +350,49 @@ static pthread_mutex_t Mutex = PTHREAD_MUTEX_INITIALIZER;   // POSIX "Fast" mute
 #define UNLOCK  LE_ASSERT(pthread_mutex_unlock(&Mutex) == 0);
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * List of all the threads' Event Loop statistics records (event_LoopStats_t).  The inspect tool
+ * finds this in other processes, so it must stay a file-scope variable in liblegato.
+ *
+ * @warning Protected by the Mutex.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_dls_List_t ListOfLoopStats = LE_DLS_LIST_INIT;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Handler calls that take longer than this many nanoseconds are logged as stalls.  0 means handler
+ * profiling is disabled.  Set from the LE_EVENT_STALL_MS environment variable at start-up.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint64_t StallThresholdNs = 0;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Iterator object for stepping through the Event Loop statistics in a remote process.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct event_iter_t
+{
+    int procMemFd;                  ///< The file descriptor to the remote process's /proc/pid/mem.
+    le_dls_List_t statsList;        ///< The list of statistics records in the remote process.
+    le_dls_Link_t* headLinkPtr;     ///< Pointer to the first record's link.
+    event_LoopStats_t currStats;    ///< The current record from the list.
+}
+LoopStatsIter_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Local memory pool that is used for allocating Event Loop statistics iterators.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_mem_PoolRef_t IteratorPool;
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Trace reference used for controlling tracing in this module.
@@ -540,12 +590,9 @@ static void ProcessOneEventReport
     Report_t* reportObjPtr;
     Handler_t* handlerPtr;
 
-    LOCK
-
-    // Pop an Event Report off the head of the Event Queue (inside a critical section).
-    linkPtr = le_sls_Pop(&perThreadRecPtr->eventQueue);
-
-    UNLOCK
+    // Pop an Event Report off the head of the Event Queue.  No need to lock the Mutex for this,
+    // because the calling thread is the only consumer of its own Event Queue.
+    linkPtr = mpscq_Pop(&perThreadRecPtr->eventQueue);
 
     if (linkPtr == NULL)
     {
@@ -562,9 +609,13 @@ static void ProcessOneEventReport
         QueuedFunctionReport_t* queuedFuncReportPtr;
         queuedFuncReportPtr = CONTAINER_OF(reportObjPtr, QueuedFunctionReport_t, baseClass);
 
+        le_event_DeferredFunc_t func = queuedFuncReportPtr->function;
+        uint64_t startTime = event_ProfileStart();
+
         // Call the function.
-        queuedFuncReportPtr->function(queuedFuncReportPtr->param1Ptr,
-                                      queuedFuncReportPtr->param2Ptr);
+        func(queuedFuncReportPtr->param1Ptr, queuedFuncReportPtr->param2Ptr);
+
+        event_ProfileEnd(perThreadRecPtr, EVENT_HANDLER_QUEUED_FUNC, (void*)func, startTime);
 
     }
     // If it's a publish-subscribe event report,
@@ -615,12 +666,23 @@ static void ProcessOneEventReport
             UNLOCK  // Unlock the mutex before calling the handler function.
                     // Don't access the Handler object anymore after this.
 
+            uint64_t startTime = event_ProfileStart();
+
             firstLayerFunc(reportPtr, secondLayerFunc);
+
+            // Charge the time to the client's handler function, rather than to the first layer
+            // (which is often shared by all the handlers of an API).
+            event_ProfileEnd(perThreadRecPtr,
+                             EVENT_HANDLER_PUB_SUB,
+                             (secondLayerFunc != NULL) ? secondLayerFunc : (void*)firstLayerFunc,
+                             startTime);
         }
     }
 
     // NOTE: The Mutex should be unlocked by this point.
 
+    perThreadRecPtr->stats.numReports++;
+
     // We are done with this report.
     le_mem_Release(reportObjPtr);
 }
@@ -641,6 +703,11 @@ static void ProcessEventReports
     // to zero.
     uint64_t numReports = ReadEventFd(perThreadRecPtr);
 
+    if (numReports > perThreadRecPtr->stats.queueHighWater)
+    {
+        perThreadRecPtr->stats.queueHighWater = numReports;
+    }
+
     for (; numReports > 0; numReports--)
     {
         ProcessOneEventReport(perThreadRecPtr);
@@ -697,15 +764,11 @@ static void QueueFunction
     reportPtr->param1Ptr = param1Ptr;
     reportPtr->param2Ptr = param2Ptr;
 
-    LOCK
-
-    // Queue it to the Event Queue.
-    le_sls_Queue(&perThreadRecPtr->eventQueue, &reportPtr->baseClass.link);
+    // Queue it to the Event Queue.  The Event Queue is lock-free, so the Mutex isn't needed.
+    mpscq_Push(&perThreadRecPtr->eventQueue, &reportPtr->baseClass.link);
 
     // Write to the eventfd to notify the Event Loop that there is something on the queue.
     WriteEventFd(perThreadRecPtr);
-
-    UNLOCK
 }
 
 
@@ -728,6 +791,139 @@ void CallComponentInitializer
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Turns on handler profiling if the LE_EVENT_STALL_MS environment variable is set.  Its value is
+ * the number of milliseconds a single handler call may take before it is logged as a stall.
+ **/
+//--------------------------------------------------------------------------------------------------
+static void ReadStallThresholdFromEnv
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    const char* envStrPtr = getenv("LE_EVENT_STALL_MS");
+
+    if (envStrPtr != NULL)
+    {
+        char* endPtr;
+        errno = 0;
+
+        unsigned long ms = strtoul(envStrPtr, &endPtr, 10);
+
+        if ((errno == 0) && (envStrPtr[0] != '\0') && (*endPtr == '\0') && (ms > 0))
+        {
+            StallThresholdNs = (uint64_t)ms * 1000000;
+        }
+        else
+        {
+            LE_ERROR("LE_EVENT_STALL_MS environment variable has invalid value '%s'.", envStrPtr);
+        }
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the current value of the monotonic clock.
+ *
+ * @return The time, in nanoseconds.
+ **/
+//--------------------------------------------------------------------------------------------------
+static uint64_t GetNanoseconds
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    struct timespec now;
+
+    LE_ASSERT(clock_gettime(CLOCK_MONOTONIC, &now) == 0);
+
+    return ((uint64_t)now.tv_sec * 1000000000ULL) + now.tv_nsec;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Finds the statistics slot for a handler function in a thread's Event Loop statistics, claiming
+ * an unused one if the function hasn't been seen before.
+ *
+ * @return Pointer to the slot, or NULL if the table is full.
+ **/
+//--------------------------------------------------------------------------------------------------
+static event_HandlerStats_t* FindHandlerStats
+(
+    event_LoopStats_t*  statsPtr,   ///< [in] The thread's statistics.
+    void*               funcPtr     ///< [in] The handler function.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    // Open addressing, starting from a hash of the function address.
+    size_t start = ((size_t)funcPtr >> 4) % EVENT_MAX_PROFILED_HANDLERS;
+    size_t i;
+
+    for (i = 0; i < EVENT_MAX_PROFILED_HANDLERS; i++)
+    {
+        event_HandlerStats_t* slotPtr =
+                                &statsPtr->handlers[(start + i) % EVENT_MAX_PROFILED_HANDLERS];
+
+        if (slotPtr->funcPtr == funcPtr)
+        {
+            return slotPtr;
+        }
+
+        if (slotPtr->funcPtr == NULL)
+        {
+            slotPtr->funcPtr = funcPtr;
+            return slotPtr;
+        }
+    }
+
+    return NULL;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the address of the list of Event Loop statistics for the specified process.  The address is
+ * in the address space of the specified process.
+ *
+ * @return
+ *      LE_OK if successful.
+ *      LE_NOT_FOUND if the list address was not found.
+ *      LE_FAULT if there was an error.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t GetLoopStatsListAddress
+(
+    pid_t pid,                          // Process to to get the address for.
+    off_t* addrPtr                      // The address of the list.
+)
+{
+    // Get the address of our framework library.
+    off_t libAddr;
+    if (addr_GetLibDataSection(0, "liblegato.so", &libAddr) != LE_OK)
+    {
+        return LE_FAULT;
+    }
+
+    // The list is at the same offset from the start of the framework library in the remote
+    // process as it is in ours.
+    off_t offset = (off_t)(&ListOfLoopStats) - libAddr;
+
+    le_result_t result = addr_GetLibDataSection(pid, "liblegato.so", &libAddr);
+    if (result != LE_OK)
+    {
+        return result;
+    }
+
+    *addrPtr = libAddr + offset;
+    return LE_OK;
+}
+
+
 // ==============================================
 //  INTER-MODULE FUNCTIONS
 // ==============================================
@@ -766,9 +962,15 @@ void event_Init
     EventRefMap = le_ref_CreateMap("Events", DEFAULT_EVENT_POOL_SIZE);
     HandlerRefMap = le_ref_CreateMap("EventHandlers", DEFAULT_HANDLER_POOL_SIZE);
 
+    // Create the pool from which statistics iterators (used by the inspect tool) are allocated.
+    IteratorPool = le_mem_CreatePool("EventLoopIterators", sizeof(LoopStatsIter_t));
+
     // Get a reference to the trace keyword that is used to control tracing in this module.
     TraceRef = le_log_GetTraceRef("eventLoop");
 
+    // Turn on handler profiling, if requested.
+    ReadStallThresholdFromEnv();
+
     // Initialize the FD Monitor module.
     fdMon_Init();
 }
@@ -799,7 +1001,7 @@ void event_InitThread
     event_PerThreadRec_t* recPtr = thread_GetEventRecPtr();
 
     // Initialize the various thread-specific lists and queues.
-    recPtr->eventQueue = LE_SLS_LIST_INIT;
+    mpscq_Init(&recPtr->eventQueue);
     recPtr->handlerList = LE_DLS_LIST_INIT;
     recPtr->fdMonitorList = LE_DLS_LIST_INIT;
 
@@ -829,6 +1031,18 @@ void event_InitThread
     // Set the context pointer to NULL for safety's sake.
     recPtr->contextPtr = NULL;
 
+    // Initialize the statistics and make them visible to the inspect tool.
+    memset(&recPtr->stats, 0, sizeof(recPtr->stats));
+    recPtr->stats.link = LE_DLS_LINK_INIT;
+    recPtr->stats.stallThresholdNs = StallThresholdNs;
+    le_utf8_Copy(recPtr->stats.threadName,
+                 le_thread_GetMyName(),
+                 sizeof(recPtr->stats.threadName),
+                 NULL);
+    LOCK
+    le_dls_Queue(&ListOfLoopStats, &recPtr->stats.link);
+    UNLOCK
+
     // Initialize the FD Monitor module's thread-specific stuff.
     fdMon_InitThread(recPtr);
 
@@ -887,6 +1101,9 @@ void event_DestructThread
     // now, it's a fatal error.
     perThreadRecPtr->state = LE_EVENT_LOOP_DESTRUCTED;
 
+    // Remove this thread's statistics from the list seen by the inspect tool.
+    le_dls_Remove(&ListOfLoopStats, &perThreadRecPtr->stats.link);
+
     // Delete all the handlers for this thread.
     while (NULL != (doubleLinkPtr = le_dls_Peek(&perThreadRecPtr->handlerList)))
     {
@@ -906,7 +1123,7 @@ void event_DestructThread
     fdMon_DestructThread(perThreadRecPtr);
 
     // Discard everything on the Event Queue.
-    while (NULL != (singleLinkPtr = le_sls_Pop(&perThreadRecPtr->eventQueue)))
+    while (NULL != (singleLinkPtr = mpscq_Pop(&perThreadRecPtr->eventQueue)))
     {
         Report_t* reportPtr = CONTAINER_OF(singleLinkPtr, Report_t, link);
 
@@ -975,6 +1192,262 @@ void event_SetCurrentContextPtr
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the start time for profiling a handler call.  Pass the result to event_ProfileEnd() when
+ * the handler returns.
+ *
+ * @return The current time (nanoseconds), or 0 if handler profiling is disabled.
+ */
+//--------------------------------------------------------------------------------------------------
+uint64_t event_ProfileStart
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (StallThresholdNs == 0)
+    {
+        return 0;
+    }
+
+    return GetNanoseconds();
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Records the time spent in a handler call in the calling thread's Event Loop statistics, and
+ * logs a warning if it took longer than the stall threshold.
+ */
+//--------------------------------------------------------------------------------------------------
+void event_ProfileEnd
+(
+    event_PerThreadRec_t*   perThreadRecPtr,    ///< [in] Calling thread's per-thread record.
+    event_HandlerType_t     type,               ///< [in] Kind of handler that was called.
+    void*                   funcPtr,            ///< [in] Handler function that was called.
+    uint64_t                startTime           ///< [in] Value returned by event_ProfileStart().
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (startTime == 0)
+    {
+        return;
+    }
+
+    event_LoopStats_t* statsPtr = &perThreadRecPtr->stats;
+    uint64_t elapsedNs = GetNanoseconds() - startTime;
+
+    // NOTE: Only this thread ever writes to its own statistics, so no locking is needed.  The
+    //       inspect tool may see a partially updated record, which is fine for diagnostics.
+    event_HandlerStats_t* handlerStatsPtr = FindHandlerStats(statsPtr, funcPtr);
+
+    if (handlerStatsPtr == NULL)
+    {
+        statsPtr->numUnprofiledCalls++;
+    }
+    else
+    {
+        handlerStatsPtr->type = type;
+        handlerStatsPtr->numCalls++;
+        handlerStatsPtr->totalNs += elapsedNs;
+
+        if (elapsedNs > handlerStatsPtr->maxNs)
+        {
+            handlerStatsPtr->maxNs = elapsedNs;
+        }
+    }
+
+    if (elapsedNs > statsPtr->stallThresholdNs)
+    {
+        statsPtr->numStalls++;
+
+        LE_WARN("Event handler %p blocked thread '%s' for %"PRIu64" ms.",
+                funcPtr,
+                statsPtr->threadName,
+                elapsedNs / 1000000);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Creates an iterator that can be used to iterate over the Event Loop statistics of the threads
+ * in a specific process.
+ *
+ * @note
+ *      The specified pid must be greater than zero.
+ *
+ *      The calling process must be root or have appropriate capabilities for this function and all
+ *      subsequent operations on the iterator to succeed.
+ *
+ *      If NULL is returned the errorPtr will be set appropriately.  Possible values are:
+ *      LE_NOT_POSSIBLE if the specified process is not a Legato process.
+ *      LE_FAULT if there was some other error.
+ *
+ * @return
+ *      An iterator to the list of Event Loop statistics for the specified process.
+ *      NULL if there was an error.
+ */
+//--------------------------------------------------------------------------------------------------
+event_Iter_Ref_t event_iter_Create
+(
+    pid_t pid,                  ///< [IN] The process to get the iterator for.
+    le_result_t *errorPtr       ///< [OUT] Error code.  See comment block for more details.
+)
+{
+    LE_ASSERT(errorPtr != NULL);
+
+    if (pid <= 0)
+    {
+        LE_ERROR("Invalid PID %d.", pid);
+        *errorPtr = LE_FAULT;
+        return NULL;
+    }
+
+    // Open the mem file for the specified process.
+    char memFilePath[LIMIT_MAX_PATH_BYTES];
+    int snprintSize = snprintf(memFilePath, sizeof(memFilePath), "/proc/%d/mem", pid);
+
+    if ((snprintSize < 0) || (snprintSize >= sizeof(memFilePath)))
+    {
+        LE_ERROR("Could not build mem file path for process %d.", pid);
+        *errorPtr = LE_FAULT;
+        return NULL;
+    }
+
+    int fd = open(memFilePath, O_RDONLY);
+
+    if (fd == -1)
+    {
+        LE_ERROR("Could not open %s.  %m.", memFilePath);
+        *errorPtr = LE_FAULT;
+        return NULL;
+    }
+
+    // Get the address of the list of statistics in the process to inspect.
+    off_t listAddr;
+
+    le_result_t result = GetLoopStatsListAddress(pid, &listAddr);
+
+    if (result != LE_OK)
+    {
+        fd_Close(fd);
+
+        if (result == LE_NOT_FOUND)
+        {
+            LE_ERROR("There is no framework library so process %d is not a legato process.", pid);
+            *errorPtr = LE_NOT_POSSIBLE;
+        }
+        else
+        {
+            LE_ERROR("Could not read Event Loop statistics address for process %d.", pid);
+            *errorPtr = LE_FAULT;
+        }
+        return NULL;
+    }
+
+    // Create the iterator.
+    LoopStatsIter_t* iteratorPtr = le_mem_ForceAlloc(IteratorPool);
+    iteratorPtr->headLinkPtr = NULL;
+    iteratorPtr->procMemFd = fd;
+
+    // Read the list itself from the process-under-inspection.
+    if (files_ReadFromOffset(fd, listAddr, &(iteratorPtr->statsList),
+                             sizeof(iteratorPtr->statsList)) != LE_OK)
+    {
+        le_mem_Release(iteratorPtr);
+        fd_Close(fd);
+        *errorPtr = LE_FAULT;
+        return NULL;
+    }
+
+    return iteratorPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the next thread's Event Loop statistics from the specified iterator.
+ *
+ * @warning
+ *      The link inside the returned record points into the address space of the remote process.
+ *
+ * @return
+ *      Pointer to a copy of the thread's statistics (valid until the next call).
+ *      NULL if there are no more threads in the list.
+ */
+//--------------------------------------------------------------------------------------------------
+const event_LoopStats_t* event_iter_GetNextLoop
+(
+    event_Iter_Ref_t iterator   ///< [IN] The iterator to get the next thread's statistics from.
+)
+{
+    LE_ASSERT(iterator != NULL);
+
+    // The links read from the remote process point into its address space, so walk them using
+    // a fake single-element list that can't lead the list functions into our own memory.
+    // (See mem_iter_GetNextPool().)
+    le_dls_List_t fakeList = LE_DLS_LIST_INIT;
+    le_dls_Link_t fakeLink = LE_DLS_LINK_INIT;
+    le_dls_Stack(&fakeList, &fakeLink);
+
+    le_dls_Link_t* linkPtr;
+
+    if (iterator->headLinkPtr == NULL)
+    {
+        iterator->headLinkPtr = le_dls_Peek(&(iterator->statsList));
+        linkPtr = iterator->headLinkPtr;
+    }
+    else
+    {
+        linkPtr = le_dls_PeekNext(&fakeList, &(iterator->currStats.link));
+
+        if (linkPtr == iterator->headLinkPtr)
+        {
+            // Looped back to the first record so there are no more.
+            return NULL;
+        }
+    }
+
+    if (linkPtr == NULL)
+    {
+        return NULL;
+    }
+
+    event_LoopStats_t* statsPtr = CONTAINER_OF(linkPtr, event_LoopStats_t, link);
+
+    if (files_ReadFromOffset(iterator->procMemFd, (ssize_t)statsPtr, &(iterator->currStats),
+                             sizeof(iterator->currStats)) != LE_OK)
+    {
+        return NULL;
+    }
+
+    // Make sure the name is terminated, in case the record was caught half-written.
+    iterator->currStats.threadName[sizeof(iterator->currStats.threadName) - 1] = '\0';
+
+    return &(iterator->currStats);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Deletes the iterator.
+ */
+//--------------------------------------------------------------------------------------------------
+void event_iter_Delete
+(
+    event_Iter_Ref_t iterator   ///< [IN] The iterator to delete.
+)
+{
+    LE_ASSERT(iterator != NULL);
+
+    fd_Close(iterator->procMemFd);
+
+    le_mem_Release(iterator);
+}
+
+
 // ==============================================
 //  PUBLIC API FUNCTIONS
 // ==============================================
@@ -1205,7 +1678,7 @@ void le_event_Report
         reportObjPtr->handlerRef = handlerPtr->safeRef;
         memset(reportObjPtr->payload, 0, eventPtr->payloadSize);
         memcpy(reportObjPtr->payload, payloadPtr, payloadSize);
-        le_sls_Queue(&perThreadRecPtr->eventQueue, &reportObjPtr->baseClass.link);
+        mpscq_Push(&perThreadRecPtr->eventQueue, &reportObjPtr->baseClass.link);
 
         // Increment the eventfd for the handler's thread's Event Queue.
         // This will wake up the thread and tell it that it has something on its Event Queue.
@@ -1266,7 +1739,7 @@ void le_event_ReportWithRefCounting
         reportObjPtr->handlerRef = handlerPtr->safeRef;
         reportObjPtr->payload[0] = objectPtr;
         le_mem_AddRef(objectPtr);
-        le_sls_Queue(&perThreadRecPtr->eventQueue, &reportObjPtr->baseClass.link);
+        mpscq_Push(&perThreadRecPtr->eventQueue, &reportObjPtr->baseClass.link);
 
         // Increment the eventfd for the handler's thread's Event Queue.
         // This will wake up the thread and tell it that it has something on its Event Queue.
@@ -1413,13 +1886,16 @@ void le_event_RunLoop
         if (result > 0)
         {
             int i;
+            bool eventQueueReady = false;
+
+            perThreadRecPtr->stats.numWakeUps++;
 
             // Check if someone has cancelled the thread and terminate the thread now, if so.
             pthread_testcancel();
 
             // For each fd event reported by epoll_wait(), if it is any file descriptor other
             // than the eventfd (which is used to indicate that there is something on the
-            // Event Queue), queue an Event Report to the Event Queue for that fd.
+            // Event Queue), call the handlers for that fd right away.
             for (i = 0; i < result; i++)
             {
                 // Get the pointer that we registered with epoll_ctl(2) along with this fd.
@@ -1430,12 +1906,22 @@ void le_event_RunLoop
 
                 if (safeRef != NULL)
                 {
-                    fdMon_Report(safeRef, epollEventList[i].events);
+                    fdMon_Dispatch(safeRef, epollEventList[i].events);
+                }
+                else
+                {
+                    eventQueueReady = true;
                 }
             }
 
-            // Process all the Event Reports on the Event Queue.
-            ProcessEventReports(perThreadRecPtr);
+            // Process all the Event Reports on the Event Queue.  If the eventfd wasn't reported,
+            // then there is nothing on the queue (or something was only just added by one of the
+            // fd event handlers, in which case epoll_wait() will return again immediately).
+            // NOTE: The eventfd must not be read when its count is zero, because it would block.
+            if (eventQueueReady)
+            {
+                ProcessEventReports(perThreadRecPtr);
+            }
         }
         // Otherwise, if an epoll_wait() reported an error, hopefully it's just an interruption
         // by a signal (EINTR).  Anything else is a fatal error.
@@ -1516,6 +2002,8 @@ le_result_t le_event_ServiceLoop
     {
         int i;
 
+        perThreadRecPtr->stats.numWakeUps++;
+
         // Check if someone has cancelled the thread and terminate the thread now, if so.
         pthread_testcancel();
 
@@ -1561,26 +2049,18 @@ le_result_t le_event_ServiceLoop
     (void)ReadEventFd(perThreadRecPtr);
 
     // If there is something on the Event Queue, process one thing.
-    LOCK
-
-    if (!le_sls_IsEmpty(&perThreadRecPtr->eventQueue))
+    if (!mpscq_IsEmpty(&perThreadRecPtr->eventQueue))
     {
-        UNLOCK
-
         ProcessOneEventReport(perThreadRecPtr); // This function assumes the mutex is NOT locked.
-
-        LOCK
     }
 
     // The caller needs to know if there is more stuff waiting on the Event Queue.
     le_result_t returnCode = LE_OK;
-    if (le_sls_IsEmpty(&perThreadRecPtr->eventQueue))
+    if (mpscq_IsEmpty(&perThreadRecPtr->eventQueue))
     {
         returnCode = LE_WOULD_BLOCK;
     }
 
-    UNLOCK
-
     return returnCode;
 }
 
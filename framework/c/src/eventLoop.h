@@ -12,6 +12,9 @@
 #ifndef LEGATO_SRC_EVENTLOOP_H_INCLUDE_GUARD
 #define LEGATO_SRC_EVENTLOOP_H_INCLUDE_GUARD
 
+#include "mpscQueue.h"
+#include "limit.h"
+
 
 //--------------------------------------------------------------------------------------------------
 /**
@@ -38,6 +41,74 @@ typedef enum
 event_LoopState_t;
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum number of different handler functions whose run times can be tracked for each thread.
+ * Calls to any other handler functions are counted in the numUnprofiledCalls member of the
+ * thread's event_LoopStats_t.
+ */
+//--------------------------------------------------------------------------------------------------
+#define EVENT_MAX_PROFILED_HANDLERS     32
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Enumeration of the kinds of handler that can be called by an Event Loop.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef enum
+{
+    EVENT_HANDLER_QUEUED_FUNC,      ///< Function queued using le_event_QueueFunction() et. al.
+    EVENT_HANDLER_PUB_SUB,          ///< Publish-Subscribe Event handler.
+    EVENT_HANDLER_FD,               ///< File descriptor event handler.
+}
+event_HandlerType_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Run-time statistics for one handler function.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    void*               funcPtr;        ///< Address of the handler function (NULL = unused slot).
+    event_HandlerType_t type;           ///< Kind of handler.
+    uint64_t            numCalls;       ///< Number of times it has been called.
+    uint64_t            totalNs;        ///< Total time spent in it (nanoseconds).
+    uint64_t            maxNs;          ///< Longest time spent in a single call (nanoseconds).
+}
+event_HandlerStats_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Event Loop statistics for one thread.
+ *
+ * These are kept on a process-wide list so that they can be read by the inspect tool from outside
+ * the process (see event_iter_Create()).
+ *
+ * The counters are always maintained.  The handler run times (and the stall detector) are only
+ * maintained if the LE_EVENT_STALL_MS environment variable was set when the process started,
+ * in which case stallThresholdNs is non-zero.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    le_dls_Link_t       link;               ///< Link in the process's list of Event Loop stats.
+    char                threadName[LIMIT_MAX_THREAD_NAME_BYTES]; ///< Name of the thread.
+    uint64_t            numWakeUps;         ///< Number of times epoll_wait() has returned.
+    uint64_t            numReports;         ///< Number of Event Reports processed.
+    uint64_t            numFdEvents;        ///< Number of fd events dispatched to handlers.
+    uint64_t            queueHighWater;     ///< Most Event Reports ever waiting at once.
+    uint64_t            stallThresholdNs;   ///< Stall threshold (nanoseconds), 0 = not profiling.
+    uint64_t            numStalls;          ///< Number of handler calls longer than the threshold.
+    uint64_t            numUnprofiledCalls; ///< Handler calls that didn't fit in handlers[].
+    event_HandlerStats_t handlers[EVENT_MAX_PROFILED_HANDLERS]; ///< Per-handler run times.
+}
+event_LoopStats_t;
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Event Loop's per-thread record.
@@ -51,13 +122,14 @@ event_LoopState_t;
 //--------------------------------------------------------------------------------------------------
 typedef struct
 {
-    le_sls_List_t       eventQueue;         ///< The thread's event queue.
+    mpscq_Queue_t       eventQueue;         ///< The thread's event queue (lock-free).
     le_dls_List_t       handlerList;        ///< List of handlers registered with this thread.
     le_dls_List_t       fdMonitorList;      ///< List of FD Monitors created by this thread.
     int                 epollFd;            ///< epoll(7) file descriptor.
     int                 eventQueueFd;       ///< eventfd(2) file descriptor for the Event Queue.
     void*               contextPtr;         ///< Context pointer from last Handler called.
     event_LoopState_t   state;              ///< Current state of the event loop.
+    event_LoopStats_t   stats;              ///< Statistics (can be read by the inspect tool).
 }
 event_PerThreadRec_t;
 
@@ -103,7 +175,7 @@ void event_InitThread
  * started (i.e., when le_event_RunLoop() is called) for the process's main thread.
  */
 //--------------------------------------------------------------------------------------------------
-void event_QueueComponentInit
+LE_SHARED void event_QueueComponentInit
 (
     const event_ComponentInitFunc_t func    /// The initialization function to call.
 );
@@ -139,4 +211,97 @@ void event_SetCurrentContextPtr
 
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the start time for profiling a handler call.  Pass the result to event_ProfileEnd() when
+ * the handler returns.
+ *
+ * @return The current time (nanoseconds), or 0 if handler profiling is disabled.
+ */
+//--------------------------------------------------------------------------------------------------
+uint64_t event_ProfileStart
+(
+    void
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Records the time spent in a handler call in the calling thread's Event Loop statistics, and
+ * logs a warning if it took longer than the stall threshold.
+ */
+//--------------------------------------------------------------------------------------------------
+void event_ProfileEnd
+(
+    event_PerThreadRec_t*   perThreadRecPtr,    ///< [in] Calling thread's per-thread record.
+    event_HandlerType_t     type,               ///< [in] Kind of handler that was called.
+    void*                   funcPtr,            ///< [in] Handler function that was called.
+    uint64_t                startTime           ///< [in] Value returned by event_ProfileStart().
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reference to an iterator over the Event Loop statistics of a remote process.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct event_iter_t* event_Iter_Ref_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Creates an iterator that can be used to iterate over the Event Loop statistics of the threads
+ * in a specific process.
+ *
+ * @note
+ *      The specified pid must be greater than zero.
+ *
+ *      The calling process must be root or have appropriate capabilities for this function and all
+ *      subsequent operations on the iterator to succeed.
+ *
+ *      If NULL is returned the errorPtr will be set appropriately.  Possible values are:
+ *      LE_NOT_POSSIBLE if the specified process is not a Legato process.
+ *      LE_FAULT if there was some other error.
+ *
+ * @return
+ *      An iterator to the list of Event Loop statistics for the specified process.
+ *      NULL if there was an error.
+ */
+//--------------------------------------------------------------------------------------------------
+LE_SHARED event_Iter_Ref_t event_iter_Create
+(
+    pid_t pid,                  ///< [IN] The process to get the iterator for.
+    le_result_t *errorPtr       ///< [OUT] Error code.  See comment block for more details.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the next thread's Event Loop statistics from the specified iterator.
+ *
+ * @warning
+ *      The link inside the returned record points into the address space of the remote process.
+ *
+ * @return
+ *      Pointer to a copy of the thread's statistics (valid until the next call).
+ *      NULL if there are no more threads in the list.
+ */
+//--------------------------------------------------------------------------------------------------
+LE_SHARED const event_LoopStats_t* event_iter_GetNextLoop
+(
+    event_Iter_Ref_t iterator   ///< [IN] The iterator to get the next thread's statistics from.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Deletes the iterator.
+ */
+//--------------------------------------------------------------------------------------------------
+LE_SHARED void event_iter_Delete
+(
+    event_Iter_Ref_t iterator   ///< [IN] The iterator to delete.
+);
+
+
 #endif // LEGATO_SRC_EVENTLOOP_H_INCLUDE_GUARD
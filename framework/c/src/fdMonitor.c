@@ -10,11 +10,22 @@
  *
  * @section fdMon_Algorithm     Algorithm
  *
- * When a file descriptor event is detected by the Event Loop, fdMon_Report() is called with
- * the FD Monitor Reference (a safe reference) and the type of event that was detected.
- * fdMon_Report() queues a function call (DispatchToHandler) to the calling thread. When that
- * function gets called, it does a look-up of the safe reference.  If it finds an FD Monitor
+ * When a file descriptor event is detected by the Event Loop, fdMon_Dispatch() is called with
+ * the FD Monitor Reference (a safe reference) and the types of event that were detected.
+ * fdMon_Dispatch() calls DispatchToHandler() directly, once for each type of event.
+ * DispatchToHandler() does a look-up of the safe reference.  If it finds an FD Monitor
  * object matching that reference, then it calls its registered handler function for that event.
+ * Because the safe reference is looked up again before each handler is called, a handler can
+ * safely delete its own FD Monitor (or any other).
+ *
+ * Dispatching directly from the Event Loop saves allocating an Event Report and writing and
+ * reading the thread's eventfd for every fd event.  le_event_ServiceLoop(), however, must only
+ * do one thing per call, so it uses fdMon_Report() instead, which queues a function call
+ * (DispatchToHandler) to the calling thread for each type of event.
+ *
+ * FD Monitors are registered with epoll in "level-triggered" mode, unless
+ * le_event_SetFdMonitorEdgeTriggered() has been called for them, in which case EPOLLET is added
+ * to their epoll event flags.
  *
  * The reason it was decided not to use Publish-Subscribe Events for this feature is that Event IDs
  * can't be deleted, and yet FD Monitors can.
@@ -358,11 +369,20 @@ static void DispatchToHandler
 
         if (handlerPtr->handlerFunc != NULL)
         {
+            // Copy the handler function pointer, because the handler could delete its
+            // FD Monitor object.
+            le_event_FdHandlerFunc_t handlerFunc = handlerPtr->handlerFunc;
+
             // Set the thread's Context Pointer.
             event_SetCurrentContextPtr(handlerPtr->contextPtr);
 
+            perThreadRecPtr->stats.numFdEvents++;
+            uint64_t startTime = event_ProfileStart();
+
             // Call the handler function.
-            handlerPtr->handlerFunc(fdMonitorPtr->fd);
+            handlerFunc(fdMonitorPtr->fd);
+
+            event_ProfileEnd(perThreadRecPtr, EVENT_HANDLER_FD, (void*)handlerFunc, startTime);
         }
         else
         {
@@ -530,8 +550,8 @@ void fdMon_InitThread
 /**
  * Report FD Events.
  *
- * This is called by the Event Loop when it detects events on a file descriptor that is being
- * monitored.
+ * This is called by le_event_ServiceLoop() when it detects events on a file descriptor that is
+ * being monitored.  A call to the handler is queued to the Event Queue for each event.
  */
 //--------------------------------------------------------------------------------------------------
 void fdMon_Report
@@ -579,6 +599,38 @@ void fdMon_Report
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Dispatch FD Events.
+ *
+ * This is called by the Event Loop when it detects events on a file descriptor that is being
+ * monitored.  Unlike fdMon_Report(), the handlers are called immediately, in the same order as
+ * the event types appear in the le_event_FdEventType_t enumeration.
+ */
+//--------------------------------------------------------------------------------------------------
+void fdMon_Dispatch
+(
+    void*       safeRef,        ///< [in] Safe Reference for the FD Monitor object for the fd.
+    uint32_t    eventFlags      ///< [in] OR'd together event flags from epoll_wait().
+)
+//--------------------------------------------------------------------------------------------------
+{
+    le_event_FdEventType_t eventType;
+
+    for (eventType = 0; eventType < LE_EVENT_NUM_FD_EVENT_TYPES; eventType++)
+    {
+        if (eventFlags & ConvertToEPollFlag(eventType))
+        {
+            DispatchToHandler(safeRef, (void*)(size_t)eventType);
+        }
+    }
+
+    LE_CRIT_IF(eventFlags & ~(EPOLLIN | EPOLLPRI | EPOLLOUT | EPOLLHUP | EPOLLRDHUP | EPOLLERR),
+               "Extra flags found in fd event report. (%xd)",
+               eventFlags);
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Delete all FD Monitor objects for the calling thread.
@@ -640,7 +692,8 @@ le_event_FdMonitorRef_t le_event_CreateFdMonitor
 
     // To start with, no events are in the set to be monitored.  They will be added as handlers
     // are registered for them. (Although, EPOLLHUP and EPOLLERR will always be monitored
-    // regardless of what flags we specify).  We use epoll in "level-triggered mode".
+    // regardless of what flags we specify).  We use epoll in "level-triggered mode", unless
+    // le_event_SetFdMonitorEdgeTriggered() is called later.
     fdMonitorPtr->epollEvents = 0;
 
     // Copy the name into it.
@@ -672,6 +725,45 @@ le_event_FdMonitorRef_t le_event_CreateFdMonitor
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Switches a File Descriptor Monitor to edge-triggered mode.
+ *
+ * In edge-triggered mode, an event is only reported when the state of the file descriptor changes
+ * (e.g., when new data arrives), rather than every time through the Event Loop for as long as the
+ * condition persists.  Handlers must therefore keep reading (or writing) until the operation
+ * fails with EAGAIN or EWOULDBLOCK, or they won't be called again for data that is already there.
+ * The file descriptor must be in non-blocking mode.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_event_SetFdMonitorEdgeTriggered
+(
+    le_event_FdMonitorRef_t monitorRef  ///< [in] Reference to the File Descriptor Monitor object.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    LOCK
+    FdMonitor_t* monitorPtr = le_ref_Lookup(FdMonitorRefMap, monitorRef);
+    UNLOCK
+
+    LE_FATAL_IF(monitorPtr == NULL, "File Descriptor Monitor %p doesn't exist!", monitorRef);
+    LE_FATAL_IF(thread_GetEventRecPtr() != monitorPtr->threadRecPtr,
+                "FD Monitor '%s' (fd %d) is owned by another thread.",
+                monitorPtr->name,
+                monitorPtr->fd);
+
+    TRACE("FD Monitor '%s' (fd %d) switched to edge-triggered mode.",
+          monitorPtr->name,
+          monitorPtr->fd);
+
+    // The EPOLLET flag stays in the set for the life of the monitor.  Enabling and disabling
+    // individual events only touches their own flags.
+    monitorPtr->epollEvents |= EPOLLET;
+
+    UpdateEpollFd(monitorPtr);
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Registers a handler for a specific type of file descriptor event with a given
@@ -45,8 +45,8 @@ void fdMon_InitThread
 /**
  * Report FD Events.
  *
- * This is called by the Event Loop when it detects events on a file descriptor that is being
- * monitored.
+ * This is called by le_event_ServiceLoop() when it detects events on a file descriptor that is
+ * being monitored.  A call to the handler is queued to the Event Queue for each event.
  */
 //--------------------------------------------------------------------------------------------------
 void fdMon_Report
@@ -56,6 +56,21 @@ void fdMon_Report
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Dispatch FD Events.
+ *
+ * This is called by the Event Loop when it detects events on a file descriptor that is being
+ * monitored.  The handlers are called immediately, instead of being queued to the Event Queue.
+ */
+//--------------------------------------------------------------------------------------------------
+void fdMon_Dispatch
+(
+    void*       safeRef,        ///< [in] Safe Reference for the FD Monitor object for the fd.
+    uint32_t    eventFlags      ///< [in] OR'd together event flags from epoll_wait().
+);
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Delete all FD Monitor objects for the calling thread.
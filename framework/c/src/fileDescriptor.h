@@ -40,7 +40,7 @@ void fd_SetBlocking
  *       and logging a critical error if close() fails.
  */
 //--------------------------------------------------------------------------------------------------
-void fd_Close
+LE_SHARED void fd_Close
 (
     int fd
 );
@@ -52,7 +52,7 @@ void fd_Close
  * which are usually the standard file descriptors, stdin, stdout, stderr.
  */
 //--------------------------------------------------------------------------------------------------
-void fd_CloseAllNonStd
+LE_SHARED void fd_CloseAllNonStd
 (
     void
 );
@@ -68,7 +68,7 @@ void fd_CloseAllNonStd
  *      LE_FAULT if there is an error.
  */
 //--------------------------------------------------------------------------------------------------
-ssize_t fd_ReadSize
+LE_SHARED ssize_t fd_ReadSize
 (
     int fd,                               ///<[IN] File to read.
     void* bufPtr,                         ///<[OUT] Buffer to store the read bytes in.
@@ -86,7 +86,7 @@ ssize_t fd_ReadSize
  *      LE_FAULT if there is an error.
  */
 //--------------------------------------------------------------------------------------------------
-ssize_t fd_WriteSize
+LE_SHARED ssize_t fd_WriteSize
 (
     int fd,                               ///<[IN] File to write.
     void* bufPtr,                         ///<[IN] Buffer which will be written to file.
@@ -0,0 +1,76 @@
+/** @file futex.c
+ *
+ * Wrappers around the Linux futex(2) system call.  See futex.h for details.
+ *
+ * Process-private futex operations are used, because Legato mutexes and semaphores can't be
+ * shared between processes.
+ *
+ * Copyright (C) Sierra Wireless, Inc. 2014. All rights reserved. Use of this work is subject to license.
+ */
+
+#include "legato.h"
+#include "futex.h"
+
+#include <linux/futex.h>
+#include <sys/syscall.h>
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Block the calling thread until another thread wakes it up using futex_Wake(), as long as the
+ * futex word still contains an expected value.
+ *
+ * @return
+ *  - LE_OK if woken up (or interrupted by a signal, which the caller must treat as a spurious
+ *    wake-up and re-check the futex word).
+ *  - LE_WOULD_BLOCK if the futex word did not contain the expected value when checked.
+ *  - LE_TIMEOUT if the timeout expired.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t futex_Wait
+(
+    int32_t*                addrPtr,    ///< [in] Address of the futex word.
+    int32_t                 value,      ///< [in] Value the futex word is expected to contain.
+    const struct timespec*  timeoutPtr  ///< [in] Relative time-out, or NULL to wait forever.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (syscall(SYS_futex, addrPtr, FUTEX_WAIT_PRIVATE, value, timeoutPtr, NULL, 0) == 0)
+    {
+        return LE_OK;
+    }
+
+    switch (errno)
+    {
+        case EAGAIN:
+            return LE_WOULD_BLOCK;
+
+        case ETIMEDOUT:
+            return LE_TIMEOUT;
+
+        case EINTR:
+            return LE_OK;
+
+        default:
+            LE_FATAL("futex(FUTEX_WAIT) failed on %p. errno = %d (%m).", addrPtr, errno);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Wake up threads that are blocked in futex_Wait() on a given futex word.
+ */
+//--------------------------------------------------------------------------------------------------
+void futex_Wake
+(
+    int32_t*    addrPtr,    ///< [in] Address of the futex word.
+    int32_t     count       ///< [in] Maximum number of threads to wake up.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (syscall(SYS_futex, addrPtr, FUTEX_WAKE_PRIVATE, count, NULL, NULL, 0) == -1)
+    {
+        LE_FATAL("futex(FUTEX_WAKE) failed on %p. errno = %d (%m).", addrPtr, errno);
+    }
+}
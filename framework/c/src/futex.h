@@ -0,0 +1,51 @@
+/** @file futex.h
+ *
+ * Futex module's intra-framework header file.  This file exposes thin wrappers around the Linux
+ * futex(2) system call that are used by the mutex and semaphore modules to block and wake threads
+ * when (and only when) there is contention.
+ *
+ * The futex word itself is always manipulated by the caller using atomic operations; these
+ * functions are only ever needed on the slow (contended) path.
+ *
+ * Copyright (C) Sierra Wireless, Inc. 2014. All rights reserved. Use of this work is subject to license.
+ */
+
+#ifndef LEGATO_SRC_FUTEX_H_INCLUDE_GUARD
+#define LEGATO_SRC_FUTEX_H_INCLUDE_GUARD
+
+#include <time.h>
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Block the calling thread until another thread wakes it up using futex_Wake(), as long as the
+ * futex word still contains an expected value.
+ *
+ * @return
+ *  - LE_OK if woken up (or interrupted by a signal, which the caller must treat as a spurious
+ *    wake-up and re-check the futex word).
+ *  - LE_WOULD_BLOCK if the futex word did not contain the expected value when checked.
+ *  - LE_TIMEOUT if the timeout expired.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t futex_Wait
+(
+    int32_t*                addrPtr,    ///< [in] Address of the futex word.
+    int32_t                 value,      ///< [in] Value the futex word is expected to contain.
+    const struct timespec*  timeoutPtr  ///< [in] Relative time-out, or NULL to wait forever.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Wake up threads that are blocked in futex_Wait() on a given futex word.
+ */
+//--------------------------------------------------------------------------------------------------
+void futex_Wake
+(
+    int32_t*    addrPtr,    ///< [in] Address of the futex word.
+    int32_t     count       ///< [in] Maximum number of threads to wake up.
+);
+
+
+#endif /* LEGATO_SRC_FUTEX_H_INCLUDE_GUARD */
@@ -11,8 +11,11 @@
 #include "hashmap.h"
 #include "safeRef.h"
 #include "messaging.h"
+#include "ipc.h"
 #include "log.h"
 #include "thread.h"
+#include "threadPool.h"
+#include "coro.h"
 #include "signals.h"
 #include "eventLoop.h"
 #include "timer.h"
@@ -49,9 +52,12 @@ __attribute__((constructor)) void _legato_InitFramework
     mutex_Init();      // Uses memory pools.
     sem_Init();        // Uses memory pools.
     thread_Init();     // Uses memory pools and safe references.
+    threadPool_Init(); // Uses memory pools.
     event_Init();      // Uses thread API.
+    coro_Init();       // Uses memory pools, safe references and event loop.
     timer_Init();      // Uses event loop.
     msg_Init();        // Uses event loop.
+    ipc_Init();        // Uses memory pools and safe references.
 
     // This must be called last, because it calls several subsystems to perform the
     // thread-specific initialization for the main thread.
@@ -0,0 +1,1233 @@
+/** @file ipc.c
+ *
+ * Runtime support for generated IPC code.  See le_ipc.h for what is (and isn't) done here.
+ *
+ * All the interfaces in the process share the same pools of handler and thread data objects, and
+ * the same safe reference maps, so the generated code for each interface doesn't need its own.
+ * The maps are shared by all threads, and so are protected by a mutex.
+ *
+ * Each server's requests are dispatched through its table of server functions, which is indexed
+ * by message ID, and the number of calls to each function and the time spent in it are counted.
+ * The servers are kept on a process-wide list, so that the inspect tool can read the counts from
+ * outside the process (see ipc_iter_Create()).
+ *
+ * Copyright (C) Sierra Wireless, Inc. 2014.  Use of this work is subject to license.
+ */
+
+#include "legato.h"
+#include "ipc.h"
+#include "addr.h"
+#include "files.h"
+#include "fileDescriptor.h"
+#include "limit.h"
+#include "messagingSession.h"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of handler objects to pre-allocate.
+ */
+//--------------------------------------------------------------------------------------------------
+#define DEFAULT_HANDLER_POOL_SIZE   4
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Offset of the buffer in a message.  Each message starts with its 32-bit ID, followed by the
+ * buffer, which is 8-byte aligned.
+ */
+//--------------------------------------------------------------------------------------------------
+#define MSG_BUFFER_OFFSET   8
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A client thread's session with the server of an interface.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    le_msg_SessionRef_t sessionRef;     ///< The session.
+    int                 clientCount;    ///< Number of connections sharing the session.
+}
+ClientThreadData_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Pool of client thread data objects.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_mem_PoolRef_t ClientThreadDataPool;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Pool of client handler objects.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_mem_PoolRef_t ClientHandlerPool;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Safe references to client handler objects.
+ *
+ * @warning Protected by Mutex.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_ref_MapRef_t ClientHandlerRefMap;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Pool of server handler objects.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_mem_PoolRef_t ServerHandlerPool;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Safe references to server handler objects.  These are shared by all the servers in the process,
+ * so each handler object records which service and client it belongs to.
+ *
+ * @warning Protected by Mutex.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_ref_MapRef_t ServerHandlerRefMap;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * List of the servers that have been started in this process.  It is read by the inspect tool,
+ * which finds it at the same offset from liblegato's data section as it is in its own process.
+ *
+ * @warning Protected by Mutex.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_dls_List_t ListOfServers = LE_DLS_LIST_INIT;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Iterator object for stepping through the servers in a remote process, and the functions of each.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct ipc_iter_t
+{
+    int procMemFd;                  ///< The file descriptor to the remote process's /proc/pid/mem.
+    le_dls_List_t serverList;       ///< The list of servers in the remote process.
+    le_dls_Link_t* headLinkPtr;     ///< Pointer to the first server's link.
+    le_ipc_Server_t currServer;     ///< The current server from the list.
+    size_t funcIndex;               ///< Index of the current server's next function.
+    char serviceName[LIMIT_MAX_SERVICE_NAME_BYTES];  ///< Current server's service name.
+    char funcName[IPC_MAX_FUNC_NAME_BYTES];          ///< Current function's name.
+}
+ServerIter_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Pool of server iterators (used by the inspect tool).
+ */
+//--------------------------------------------------------------------------------------------------
+static le_mem_PoolRef_t IteratorPool;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Request that was sent by le_ipc_StartRequest() and whose response hasn't been collected yet.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct le_ipc_Pending
+{
+    le_msg_SessionRef_t sessionRef;     ///< The session the request was sent on.
+    le_msg_MessageRef_t responseRef;    ///< The response, or NULL if it hasn't arrived.
+    bool                isDone;         ///< true when the response arrived or the session closed.
+}
+Pending_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Pool of pending requests.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_mem_PoolRef_t PendingPool;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Mutex that protects the safe reference maps, the list of servers, and the creation of client
+ * thread data keys.
+ */
+//--------------------------------------------------------------------------------------------------
+static pthread_mutex_t Mutex = PTHREAD_MUTEX_INITIALIZER;   // POSIX "Fast" mutex.
+
+/// Locks the mutex.
+#define LOCK    LE_ASSERT(pthread_mutex_lock(&Mutex) == 0);
+
+/// Unlocks the mutex.
+#define UNLOCK  LE_ASSERT(pthread_mutex_unlock(&Mutex) == 0);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the next string or array in a message, which must fit in the message buffer.
+ *
+ * @return Pointer to the data, or NULL if it is not valid (or an earlier item was not valid).
+ */
+//--------------------------------------------------------------------------------------------------
+static uint8_t* UnpackItem
+(
+    uint8_t** msgBufPtrPtr,     ///< [IN/OUT] Where the item is.  Moved past it, or set to NULL.
+    uint8_t* msgBufEndPtr,      ///< [IN] End of the message buffer.
+    size_t* dataSizePtr         ///< [OUT] Size of the data, in bytes.
+)
+{
+    uint8_t* msgBufPtr = *msgBufPtrPtr;
+
+    if ( (msgBufPtr != NULL) && ((size_t)(msgBufEndPtr - msgBufPtr) >= 8) )
+    {
+        uint64_t dataSize = *(uint64_t*)msgBufPtr;
+
+        if ( dataSize <= (size_t)(msgBufEndPtr - msgBufPtr) - 8 )
+        {
+            *dataSizePtr = dataSize;
+            *msgBufPtrPtr = msgBufPtr + 8 + LE_IPC_ALIGN_SIZE(dataSize);
+            return ( msgBufPtr + 8 );
+        }
+    }
+
+    *msgBufPtrPtr = NULL;
+    return NULL;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Receives indications (messages from the server to a client handler), and queues them to the
+ * thread that registered the handler.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ClientIndicationRecvHandler
+(
+    le_msg_MessageRef_t msgRef,
+    void*               contextPtr
+)
+{
+    // The client handler object pointer (which the client sent to the server as the context
+    // pointer) is always the first field of an indication.
+    uint8_t* msgPtr = le_msg_GetPayloadPtr(msgRef);
+    le_ipc_ClientHandler_t* handlerPtr = *(le_ipc_ClientHandler_t**)(msgPtr + MSG_BUFFER_OFFSET);
+
+    le_event_QueueFunctionToThread(handlerPtr->callersThreadRef,
+                                   handlerPtr->handleFunc,
+                                   msgRef,
+                                   handlerPtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the current value of the monotonic clock.
+ *
+ * @return The time, in nanoseconds.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint64_t GetNanoseconds
+(
+    void
+)
+{
+    struct timespec now;
+
+    LE_ASSERT(clock_gettime(CLOCK_MONOTONIC, &now) == 0);
+
+    return ((uint64_t)now.tv_sec * 1000000000ULL) + now.tv_nsec;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Receives requests from clients, and dispatches them to the server functions by message ID.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ServerMsgRecvHandler
+(
+    le_msg_MessageRef_t msgRef,
+    void*               contextPtr
+)
+{
+    le_ipc_Server_t* serverPtr = contextPtr;
+
+    // Every message starts with its 32-bit ID.
+    uint32_t id = *(uint32_t*)le_msg_GetPayloadPtr(msgRef);
+
+    if (id >= serverPtr->numFuncs)
+    {
+        LE_KILL_CLIENT("Unknown message ID %"PRIu32" for service '%s'.",
+                       id,
+                       serverPtr->serviceName);
+        le_msg_ReleaseMsg(msgRef);
+        return;
+    }
+
+    // The server function can get the client's session (e.g., to find out the client's user ID)
+    // while it is handling the request.
+    serverPtr->clientSessionRef = le_msg_GetSession(msgRef);
+
+    // Only this thread changes the statistics, so they don't need to be protected.  The inspect
+    // tool may read a torn value, but it only needs to be about right.
+    le_ipc_ServerFuncStats_t* statsPtr = &serverPtr->funcStats[id];
+    uint64_t startNs = GetNanoseconds();
+
+    serverPtr->funcTable[id].handleFunc(msgRef);
+
+    statsPtr->totalNs += GetNanoseconds() - startNs;
+    statsPtr->numCalls++;
+
+    serverPtr->clientSessionRef = NULL;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Removes the handlers that a client registered, when its session is closed.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CleanupClientData
+(
+    le_msg_SessionRef_t sessionRef,
+    void*               contextPtr      ///< The server whose client's session closed.
+)
+{
+    le_ipc_Server_t* serverPtr = contextPtr;
+
+    LE_DEBUG("Client %p is closed !!!", sessionRef);
+
+    LOCK
+
+    le_ref_IterRef_t iterRef = le_ref_GetIterator(ServerHandlerRefMap);
+
+    while (le_ref_NextNode(iterRef) == LE_OK)
+    {
+        le_ipc_ServerHandler_t* handlerPtr = (le_ipc_ServerHandler_t*)le_ref_GetValue(iterRef);
+
+        if (   (handlerPtr->serviceRef == serverPtr->serviceRef)
+            && (handlerPtr->clientSessionRef == sessionRef) )
+        {
+            LE_DEBUG("Removing handler %p for client %p", handlerPtr->handlerRef, sessionRef);
+
+            handlerPtr->removeHandlerFunc(handlerPtr->handlerRef);
+            le_ref_DeleteRef(ServerHandlerRefMap, (void*)le_ref_GetSafeRef(iterRef));
+            le_mem_Release(handlerPtr);
+
+            // The iterator is no longer valid once the map has been changed, so start over.  Some
+            // handlers get looked at more than once, but they all get looked at.
+            iterRef = le_ref_GetIterator(ServerHandlerRefMap);
+        }
+    }
+
+    UNLOCK
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initializes the IPC runtime module.  This function must be called at start-up, after the
+ * memory pool and safe reference modules are initialized.
+ */
+//--------------------------------------------------------------------------------------------------
+void ipc_Init
+(
+    void
+)
+{
+    ClientThreadDataPool = le_mem_CreatePool("IpcClientThreads", sizeof(ClientThreadData_t));
+
+    ClientHandlerPool = le_mem_CreatePool("IpcClientHandlers", sizeof(le_ipc_ClientHandler_t));
+    le_mem_ExpandPool(ClientHandlerPool, DEFAULT_HANDLER_POOL_SIZE);
+    ClientHandlerRefMap = le_ref_CreateMap("IpcClientHandlers", DEFAULT_HANDLER_POOL_SIZE);
+
+    ServerHandlerPool = le_mem_CreatePool("IpcServerHandlers", sizeof(le_ipc_ServerHandler_t));
+    le_mem_ExpandPool(ServerHandlerPool, DEFAULT_HANDLER_POOL_SIZE);
+    ServerHandlerRefMap = le_ref_CreateMap("IpcServerHandlers", DEFAULT_HANDLER_POOL_SIZE);
+
+    IteratorPool = le_mem_CreatePool("IpcServerIterators", sizeof(ServerIter_t));
+
+    PendingPool = le_mem_CreatePool("IpcPendingRequests", sizeof(Pending_t));
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the address of the list of servers in a process.
+ *
+ * @return
+ *      LE_OK if successful.
+ *      LE_NOT_FOUND if the process doesn't use the framework library.
+ *      LE_FAULT if there was some other error.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t GetServerListAddress
+(
+    pid_t pid,                          // Process to to get the address for.
+    off_t* addrPtr                      // The address of the list.
+)
+{
+    // Get the address of our framework library.
+    off_t libAddr;
+    if (addr_GetLibDataSection(0, "liblegato.so", &libAddr) != LE_OK)
+    {
+        return LE_FAULT;
+    }
+
+    // The list is at the same offset from the start of the framework library in the remote
+    // process as it is in ours.
+    off_t offset = (off_t)(&ListOfServers) - libAddr;
+
+    le_result_t result = addr_GetLibDataSection(pid, "liblegato.so", &libAddr);
+    if (result != LE_OK)
+    {
+        return result;
+    }
+
+    *addrPtr = libAddr + offset;
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reads a null-terminated string from a remote process.  It is truncated if it doesn't fit.
+ *
+ * @return
+ *      LE_OK if successful.
+ *      LE_FAULT if the string could not be read.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t ReadRemoteString
+(
+    int procMemFd,          ///< [IN] The remote process's /proc/pid/mem.
+    const char* strPtr,     ///< [IN] Address of the string in the remote process.
+    char* bufPtr,           ///< [OUT] Where to put the string.
+    size_t bufSize          ///< [IN] Size of the buffer.
+)
+{
+    size_t i;
+
+    // The string may end right before the end of a mapping, so read it a byte at a time.  Names
+    // are short, and this is only done by the inspect tool.
+    for (i = 0; i < bufSize - 1; i++)
+    {
+        if (files_ReadFromOffset(procMemFd, (ssize_t)(strPtr + i), &bufPtr[i], 1) != LE_OK)
+        {
+            bufPtr[0] = '\0';
+            return LE_FAULT;
+        }
+
+        if (bufPtr[i] == '\0')
+        {
+            return LE_OK;
+        }
+    }
+
+    bufPtr[i] = '\0';
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Creates an iterator that can be used to iterate over the IPC servers in a specific process,
+ * and the call statistics of their functions.
+ *
+ * @note
+ *      The specified pid must be greater than zero.
+ *
+ *      The calling process must be root or have appropriate capabilities for this function and all
+ *      subsequent operations on the iterator to succeed.
+ *
+ *      If NULL is returned the errorPtr will be set appropriately.  Possible values are:
+ *      LE_NOT_POSSIBLE if the specified process is not a Legato process.
+ *      LE_FAULT if there was some other error.
+ *
+ * @return
+ *      An iterator to the list of servers for the specified process.
+ *      NULL if there was an error.
+ */
+//--------------------------------------------------------------------------------------------------
+ipc_Iter_Ref_t ipc_iter_Create
+(
+    pid_t pid,                  ///< [IN] The process to get the iterator for.
+    le_result_t *errorPtr       ///< [OUT] Error code.  See comment block for more details.
+)
+{
+    LE_ASSERT(errorPtr != NULL);
+
+    if (pid <= 0)
+    {
+        LE_ERROR("Invalid PID %d.", pid);
+        *errorPtr = LE_FAULT;
+        return NULL;
+    }
+
+    // Open the mem file for the specified process.
+    char memFilePath[LIMIT_MAX_PATH_BYTES];
+    int snprintSize = snprintf(memFilePath, sizeof(memFilePath), "/proc/%d/mem", pid);
+
+    if ((snprintSize < 0) || (snprintSize >= sizeof(memFilePath)))
+    {
+        LE_ERROR("Could not build mem file path for process %d.", pid);
+        *errorPtr = LE_FAULT;
+        return NULL;
+    }
+
+    int fd = open(memFilePath, O_RDONLY);
+
+    if (fd == -1)
+    {
+        LE_ERROR("Could not open %s.  %m.", memFilePath);
+        *errorPtr = LE_FAULT;
+        return NULL;
+    }
+
+    // Get the address of the list of servers in the process to inspect.
+    off_t listAddr;
+
+    le_result_t result = GetServerListAddress(pid, &listAddr);
+
+    if (result != LE_OK)
+    {
+        fd_Close(fd);
+
+        if (result == LE_NOT_FOUND)
+        {
+            LE_ERROR("There is no framework library so process %d is not a legato process.", pid);
+            *errorPtr = LE_NOT_POSSIBLE;
+        }
+        else
+        {
+            LE_ERROR("Could not read IPC server list address for process %d.", pid);
+            *errorPtr = LE_FAULT;
+        }
+        return NULL;
+    }
+
+    // Create the iterator.
+    ServerIter_t* iteratorPtr = le_mem_ForceAlloc(IteratorPool);
+    iteratorPtr->procMemFd = fd;
+    iteratorPtr->headLinkPtr = NULL;
+    iteratorPtr->funcIndex = 0;
+    iteratorPtr->currServer.numFuncs = 0;
+
+    // Read the list itself from the process-under-inspection.
+    if (files_ReadFromOffset(fd, listAddr, &(iteratorPtr->serverList),
+                             sizeof(iteratorPtr->serverList)) != LE_OK)
+    {
+        le_mem_Release(iteratorPtr);
+        fd_Close(fd);
+        *errorPtr = LE_FAULT;
+        return NULL;
+    }
+
+    return iteratorPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Moves the iterator to the next server.
+ *
+ * @return
+ *      The server's service name (valid until the next call).
+ *      NULL if there are no more servers in the list.
+ */
+//--------------------------------------------------------------------------------------------------
+const char* ipc_iter_GetNextServer
+(
+    ipc_Iter_Ref_t iterator     ///< [IN] The iterator.
+)
+{
+    LE_ASSERT(iterator != NULL);
+
+    // The links read from the remote process point into its address space, so walk them using
+    // a fake single-element list that can't lead the list functions into our own memory.
+    // (See mem_iter_GetNextPool().)
+    le_dls_List_t fakeList = LE_DLS_LIST_INIT;
+    le_dls_Link_t fakeLink = LE_DLS_LINK_INIT;
+    le_dls_Stack(&fakeList, &fakeLink);
+
+    le_dls_Link_t* linkPtr;
+
+    if (iterator->headLinkPtr == NULL)
+    {
+        iterator->headLinkPtr = le_dls_Peek(&(iterator->serverList));
+        linkPtr = iterator->headLinkPtr;
+    }
+    else
+    {
+        linkPtr = le_dls_PeekNext(&fakeList, &(iterator->currServer.link));
+
+        if (linkPtr == iterator->headLinkPtr)
+        {
+            // Looped back to the first server so there are no more.
+            return NULL;
+        }
+    }
+
+    if (linkPtr == NULL)
+    {
+        return NULL;
+    }
+
+    le_ipc_Server_t* serverPtr = CONTAINER_OF(linkPtr, le_ipc_Server_t, link);
+
+    iterator->funcIndex = 0;
+
+    if (files_ReadFromOffset(iterator->procMemFd, (ssize_t)serverPtr, &(iterator->currServer),
+                             sizeof(iterator->currServer)) != LE_OK)
+    {
+        iterator->currServer.numFuncs = 0;
+        return NULL;
+    }
+
+    if (ReadRemoteString(iterator->procMemFd,
+                         iterator->currServer.serviceName,
+                         iterator->serviceName,
+                         sizeof(iterator->serviceName)) != LE_OK)
+    {
+        return NULL;
+    }
+
+    return iterator->serviceName;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the call statistics of the current server's next function.
+ *
+ * @return
+ *      The function's name (valid until the next call).
+ *      NULL if the server has no more functions.
+ */
+//--------------------------------------------------------------------------------------------------
+const char* ipc_iter_GetNextFunc
+(
+    ipc_Iter_Ref_t iterator,            ///< [IN] The iterator.
+    le_ipc_ServerFuncStats_t* statsPtr  ///< [OUT] The function's call statistics.
+)
+{
+    LE_ASSERT(iterator != NULL);
+
+    if (iterator->funcIndex >= iterator->currServer.numFuncs)
+    {
+        return NULL;
+    }
+
+    size_t i = iterator->funcIndex++;
+    le_ipc_ServerFunc_t func;
+
+    if ( (files_ReadFromOffset(iterator->procMemFd,
+                               (ssize_t)(iterator->currServer.funcTable + i),
+                               &func,
+                               sizeof(func)) != LE_OK)
+        || (files_ReadFromOffset(iterator->procMemFd,
+                                 (ssize_t)(iterator->currServer.funcStats + i),
+                                 statsPtr,
+                                 sizeof(*statsPtr)) != LE_OK)
+        || (ReadRemoteString(iterator->procMemFd,
+                             func.name,
+                             iterator->funcName,
+                             sizeof(iterator->funcName)) != LE_OK) )
+    {
+        return NULL;
+    }
+
+    return iterator->funcName;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Deletes the iterator.
+ */
+//--------------------------------------------------------------------------------------------------
+void ipc_iter_Delete
+(
+    ipc_Iter_Ref_t iterator     ///< [IN] The iterator to delete.
+)
+{
+    LE_ASSERT(iterator != NULL);
+
+    fd_Close(iterator->procMemFd);
+
+    le_mem_Release(iterator);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Packs an array into a message.  It is a fatal error if it doesn't fit.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_ipc_PackArray
+(
+    uint8_t** msgBufPtrPtr,     ///< [IN/OUT] Where to pack the array.  Moved past it.
+    uint8_t* msgBufEndPtr,      ///< [IN] End of the message buffer.
+    const void* dataPtr,        ///< [IN] The array.
+    size_t dataSize             ///< [IN] Size of the array, in bytes.
+)
+{
+    uint8_t* msgBufPtr = *msgBufPtrPtr;
+    size_t bufSize = msgBufEndPtr - msgBufPtr;
+
+    LE_FATAL_IF( (bufSize < 8) || (dataSize > bufSize - 8),
+                 "Message buffer overflow (%zu bytes of data)", dataSize );
+
+    *(uint64_t*)msgBufPtr = dataSize;
+    memcpy( msgBufPtr + 8, dataPtr, dataSize );
+    *msgBufPtrPtr = msgBufPtr + 8 + LE_IPC_ALIGN_SIZE(dataSize);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Packs a string into a message.  It is a fatal error if it is longer than the maximum given in
+ * the .api file, or if it doesn't fit.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_ipc_PackString
+(
+    uint8_t** msgBufPtrPtr,     ///< [IN/OUT] Where to pack the string.  Moved past it.
+    uint8_t* msgBufEndPtr,      ///< [IN] End of the message buffer.
+    const char* dataStr,        ///< [IN] The string.
+    size_t maxLength            ///< [IN] Maximum length, not including the null character.
+)
+{
+    // Don't look any further than needed to know whether the string is too long.
+    size_t length = strnlen( dataStr, maxLength + 1 );
+
+    LE_FATAL_IF( length > maxLength, "String is longer than the maximum of %zu bytes", maxLength );
+
+    // Add one for the null character
+    le_ipc_PackArray( msgBufPtrPtr, msgBufEndPtr, dataStr, length + 1 );
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the next array in a message, which must be dataSize bytes.  The array is not copied.
+ *
+ * @return Pointer to the array, in the message buffer, or NULL if it is not valid.
+ */
+//--------------------------------------------------------------------------------------------------
+void* le_ipc_UnpackArray
+(
+    uint8_t** msgBufPtrPtr,     ///< [IN/OUT] Where the array is.  Moved past it, or set to NULL.
+    uint8_t* msgBufEndPtr,      ///< [IN] End of the message buffer.
+    size_t dataSize             ///< [IN] Expected size of the array, in bytes.
+)
+{
+    size_t size;
+    uint8_t* dataPtr = UnpackItem( msgBufPtrPtr, msgBufEndPtr, &size );
+
+    if ( (dataPtr != NULL) && (size != dataSize) )
+    {
+        *msgBufPtrPtr = NULL;
+        return NULL;
+    }
+
+    return dataPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Copies the next array in a message, which must be dataSize bytes, to a buffer.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_ipc_UnpackArrayCopy
+(
+    uint8_t** msgBufPtrPtr,     ///< [IN/OUT] Where the array is.  Moved past it, or set to NULL.
+    uint8_t* msgBufEndPtr,      ///< [IN] End of the message buffer.
+    void* dataPtr,              ///< [OUT] Buffer to copy the array to.
+    size_t dataSize             ///< [IN] Expected size of the array, in bytes.
+)
+{
+    void* arrayPtr = le_ipc_UnpackArray( msgBufPtrPtr, msgBufEndPtr, dataSize );
+
+    if ( arrayPtr != NULL )
+    {
+        memcpy( dataPtr, arrayPtr, dataSize );
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the next string in a message, which can be up to maxLength bytes, not including the null
+ * character.  The string is not copied.
+ *
+ * @return Pointer to the string, in the message buffer, or NULL if it is not valid.
+ */
+//--------------------------------------------------------------------------------------------------
+const char* le_ipc_UnpackString
+(
+    uint8_t** msgBufPtrPtr,     ///< [IN/OUT] Where the string is.  Moved past it, or set to NULL.
+    uint8_t* msgBufEndPtr,      ///< [IN] End of the message buffer.
+    size_t maxLength            ///< [IN] Maximum length, not including the null character.
+)
+{
+    size_t size;
+    char* dataStr = (char*)UnpackItem( msgBufPtrPtr, msgBufEndPtr, &size );
+
+    if ( (dataStr != NULL) &&
+         ((size == 0) || (size - 1 > maxLength) || (dataStr[size - 1] != '\0')) )
+    {
+        *msgBufPtrPtr = NULL;
+        return NULL;
+    }
+
+    return dataStr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Copies the next string in a message to a buffer.  If the string doesn't fit, it is truncated
+ * (at a UTF-8 character boundary).
+ */
+//--------------------------------------------------------------------------------------------------
+void le_ipc_UnpackStringCopy
+(
+    uint8_t** msgBufPtrPtr,     ///< [IN/OUT] Where the string is.  Moved past it, or set to NULL.
+    uint8_t* msgBufEndPtr,      ///< [IN] End of the message buffer.
+    char* dataPtr,              ///< [OUT] Buffer to copy the string to.
+    size_t dataSize             ///< [IN] Size of the buffer, in bytes.
+)
+{
+    size_t size;
+    const char* dataStr = (const char*)UnpackItem( msgBufPtrPtr, msgBufEndPtr, &size );
+
+    if ( dataStr == NULL )
+    {
+        return;
+    }
+
+    if ( (size == 0) || (dataStr[size - 1] != '\0') )
+    {
+        *msgBufPtrPtr = NULL;
+    }
+    else if ( size <= dataSize )
+    {
+        memcpy( dataPtr, dataStr, size );
+    }
+    else if ( dataSize > 0 )
+    {
+        le_utf8_Copy( dataPtr, dataStr, dataSize, NULL );
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Connects the calling thread to the service.  If the thread is already connected, the session is
+ * shared, and stays open until each connection has been disconnected.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_ipc_ConnectService
+(
+    le_ipc_Client_t* clientPtr      ///< [IN]
+)
+{
+    LOCK
+    if (!clientPtr->isInitialized)
+    {
+        LE_ASSERT(pthread_key_create(&clientPtr->threadDataKey, NULL) == 0);
+        clientPtr->isInitialized = true;
+    }
+    UNLOCK
+
+    ClientThreadData_t* threadDataPtr = pthread_getspecific(clientPtr->threadDataKey);
+
+    if (threadDataPtr != NULL)
+    {
+        // There is only one session per thread, and it is shared by all of its connections.
+        threadDataPtr->clientCount++;
+
+        LE_DEBUG("======= Starting another client for '%s' service ========",
+                 clientPtr->serviceName);
+        return;
+    }
+
+    le_msg_ProtocolRef_t protocolRef = le_msg_GetProtocolRef(clientPtr->protocolId,
+                                                             clientPtr->messageSize);
+    le_msg_SessionRef_t sessionRef = le_msg_CreateSession(protocolRef, clientPtr->serviceName);
+    le_msg_SetSessionRecvHandler(sessionRef, ClientIndicationRecvHandler, NULL);
+    le_msg_OpenSessionSync(sessionRef);
+
+    threadDataPtr = le_mem_ForceAlloc(ClientThreadDataPool);
+    threadDataPtr->sessionRef = sessionRef;
+    threadDataPtr->clientCount = 1;
+
+    LE_FATAL_IF(pthread_setspecific(clientPtr->threadDataKey, threadDataPtr) != 0,
+                "pthread_setspecific() failed!");
+
+    LE_DEBUG("======= Starting client for '%s' service ========", clientPtr->serviceName);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Disconnects the calling thread from the service.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_ipc_DisconnectService
+(
+    le_ipc_Client_t* clientPtr      ///< [IN]
+)
+{
+    ClientThreadData_t* threadDataPtr = NULL;
+
+    if (clientPtr->isInitialized)
+    {
+        threadDataPtr = pthread_getspecific(clientPtr->threadDataKey);
+    }
+
+    if (threadDataPtr == NULL)
+    {
+        LE_CRIT("Trying to stop non-existent client session for '%s' service",
+                clientPtr->serviceName);
+    }
+    else if (threadDataPtr->clientCount > 1)
+    {
+        threadDataPtr->clientCount--;
+
+        LE_DEBUG("======= Stopping another client for '%s' service ========",
+                 clientPtr->serviceName);
+    }
+    else
+    {
+        // This was the thread's last connection, so close the session.  If the thread connects
+        // again, it gets a new one.
+        le_msg_CloseSession(threadDataPtr->sessionRef);
+        le_mem_Release(threadDataPtr);
+
+        LE_FATAL_IF(pthread_setspecific(clientPtr->threadDataKey, NULL) != 0,
+                    "pthread_setspecific() failed!");
+
+        LE_DEBUG("======= Stopping client for '%s' service ========", clientPtr->serviceName);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the calling thread's session with the server.  It is a fatal error if the thread is not
+ * connected.
+ */
+//--------------------------------------------------------------------------------------------------
+le_msg_SessionRef_t le_ipc_GetSessionRef
+(
+    le_ipc_Client_t* clientPtr      ///< [IN]
+)
+{
+    ClientThreadData_t* threadDataPtr = NULL;
+
+    if (clientPtr->isInitialized)
+    {
+        threadDataPtr = pthread_getspecific(clientPtr->threadDataKey);
+    }
+
+    LE_FATAL_IF(threadDataPtr == NULL, "No client session for current thread");
+
+    return threadDataPtr->sessionRef;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Creates a client handler object, before an "add handler" request is sent to the server.
+ */
+//--------------------------------------------------------------------------------------------------
+le_ipc_ClientHandler_t* le_ipc_NewClientHandler
+(
+    le_event_HandlerFunc_t  handlerPtr,     ///< [IN]
+    void*                   contextPtr,     ///< [IN]
+    le_event_DeferredFunc_t handleFunc      ///< [IN]
+)
+{
+    le_ipc_ClientHandler_t* clientHandlerPtr = le_mem_ForceAlloc(ClientHandlerPool);
+
+    clientHandlerPtr->handlerPtr = handlerPtr;
+    clientHandlerPtr->contextPtr = contextPtr;
+    clientHandlerPtr->handlerRef = NULL;
+    clientHandlerPtr->callersThreadRef = le_thread_GetCurrent();
+    clientHandlerPtr->handleFunc = handleFunc;
+
+    return clientHandlerPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Stores the server's handler reference in a client handler object, once the server has added the
+ * handler.
+ *
+ * @return The reference that is returned to the client, which identifies the handler object.
+ */
+//--------------------------------------------------------------------------------------------------
+void* le_ipc_AddClientHandler
+(
+    le_ipc_ClientHandler_t* handlerPtr,     ///< [IN]
+    le_event_HandlerRef_t   handlerRef      ///< [IN] Handler reference returned by the server.
+)
+{
+    handlerPtr->handlerRef = handlerRef;
+
+    LOCK
+    void* ref = le_ref_CreateRef(ClientHandlerRefMap, handlerPtr);
+    UNLOCK
+
+    return ref;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Deletes a client handler object, before a "remove handler" request is sent to the server.  It is
+ * a fatal error if the reference is not valid.
+ *
+ * @return The server's handler reference.
+ */
+//--------------------------------------------------------------------------------------------------
+le_event_HandlerRef_t le_ipc_RemoveClientHandler
+(
+    void* ref       ///< [IN] Reference returned by le_ipc_AddClientHandler().
+)
+{
+    LOCK
+    le_ipc_ClientHandler_t* handlerPtr = le_ref_Lookup(ClientHandlerRefMap, ref);
+    if (handlerPtr != NULL)
+    {
+        le_ref_DeleteRef(ClientHandlerRefMap, ref);
+    }
+    UNLOCK
+
+    LE_FATAL_IF(handlerPtr == NULL, "Invalid handler reference %p", ref);
+
+    le_event_HandlerRef_t handlerRef = handlerPtr->handlerRef;
+    le_mem_Release(handlerPtr);
+
+    return handlerRef;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Called when the response to a pending request arrives, or when the session closes before it
+ * does (in which case responseRef is NULL).
+ */
+//--------------------------------------------------------------------------------------------------
+static void PendingResponseHandler
+(
+    le_msg_MessageRef_t responseRef,    ///< [IN]
+    void*               contextPtr      ///< [IN] The pending request.
+)
+{
+    Pending_t* pendingPtr = contextPtr;
+
+    pendingPtr->responseRef = responseRef;
+    pendingPtr->isDone = true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sends a request to the server without waiting for the response.  The requests are sent in
+ * order, and any number of them can be waiting for their responses.
+ *
+ * @return The reference to pass to le_ipc_FinishRequest().
+ */
+//--------------------------------------------------------------------------------------------------
+le_ipc_PendingRef_t le_ipc_StartRequest
+(
+    le_msg_MessageRef_t msgRef      ///< [IN] The request.
+)
+{
+    Pending_t* pendingPtr = le_mem_ForceAlloc(PendingPool);
+
+    pendingPtr->sessionRef = le_msg_GetSession(msgRef);
+    pendingPtr->responseRef = NULL;
+    pendingPtr->isDone = false;
+
+    le_msg_RequestResponse(msgRef, PendingResponseHandler, pendingPtr);
+
+    return pendingPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the response to a request that was sent by le_ipc_StartRequest(), waiting for it if it
+ * hasn't arrived yet.  This must be done exactly once for each request, by the thread that sent
+ * it.  It is a fatal error if the response is not for the expected message ID.
+ *
+ * @return The response, or NULL if the session closed before it arrived.
+ */
+//--------------------------------------------------------------------------------------------------
+le_msg_MessageRef_t le_ipc_FinishRequest
+(
+    le_ipc_PendingRef_t pendingRef, ///< [IN]
+    uint32_t msgId                  ///< [IN] Message ID of the request.
+)
+{
+    Pending_t* pendingPtr = pendingRef;
+
+    if (!pendingPtr->isDone)
+    {
+        msgSession_WaitForResponses(pendingPtr->sessionRef, &pendingPtr->isDone);
+    }
+
+    le_msg_MessageRef_t responseRef = pendingPtr->responseRef;
+    le_mem_Release(pendingPtr);
+
+    if (responseRef != NULL)
+    {
+        uint32_t responseId;
+
+        memcpy(&responseId, le_msg_GetPayloadPtr(responseRef), sizeof(responseId));
+        LE_FATAL_IF(responseId != msgId,
+                    "Response to message ID %u received while waiting for message ID %u.",
+                    responseId,
+                    msgId);
+    }
+
+    return responseRef;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Creates and advertises the service.  Handlers that a client registered are removed when the
+ * client's session closes.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_ipc_AdvertiseService
+(
+    le_ipc_Server_t* serverPtr      ///< [IN]
+)
+{
+    LE_DEBUG("======= Starting Server %s ========", serverPtr->serviceName);
+
+    le_msg_ProtocolRef_t protocolRef = le_msg_GetProtocolRef(serverPtr->protocolId,
+                                                             serverPtr->messageSize);
+    serverPtr->serviceRef = le_msg_CreateService(protocolRef, serverPtr->serviceName);
+    le_msg_SetServiceRecvHandler(serverPtr->serviceRef, ServerMsgRecvHandler, serverPtr);
+    le_msg_AdvertiseService(serverPtr->serviceRef);
+
+    le_msg_AddServiceCloseHandler(serverPtr->serviceRef, CleanupClientData, serverPtr);
+
+    LOCK
+    le_dls_Queue(&ListOfServers, &serverPtr->link);
+    UNLOCK
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Creates a server handler object, before the server's "add handler" function is called.
+ */
+//--------------------------------------------------------------------------------------------------
+le_ipc_ServerHandler_t* le_ipc_NewServerHandler
+(
+    le_msg_MessageRef_t msgRef,     ///< [IN] The "add handler" request.
+    void*               contextPtr  ///< [IN] The client's context pointer.
+)
+{
+    le_ipc_ServerHandler_t* serverHandlerPtr = le_mem_ForceAlloc(ServerHandlerPool);
+
+    serverHandlerPtr->clientSessionRef = le_msg_GetSession(msgRef);
+    serverHandlerPtr->serviceRef = le_msg_GetSessionService(serverHandlerPtr->clientSessionRef);
+    serverHandlerPtr->contextPtr = contextPtr;
+    serverHandlerPtr->handlerRef = NULL;
+    serverHandlerPtr->removeHandlerFunc = NULL;
+
+    return serverHandlerPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Stores the server's handler reference in a server handler object, once the server has added the
+ * handler.
+ *
+ * @return The reference that is returned to the client, which identifies the handler object.
+ */
+//--------------------------------------------------------------------------------------------------
+void* le_ipc_AddServerHandler
+(
+    le_ipc_ServerHandler_t*     handlerPtr,         ///< [IN]
+    le_event_HandlerRef_t       handlerRef,         ///< [IN]
+    le_ipc_RemoveHandlerFunc_t  removeHandlerFunc   ///< [IN]
+)
+{
+    handlerPtr->handlerRef = handlerRef;
+    handlerPtr->removeHandlerFunc = removeHandlerFunc;
+
+    LOCK
+    void* ref = le_ref_CreateRef(ServerHandlerRefMap, handlerPtr);
+    UNLOCK
+
+    return ref;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Deletes a server handler object, before the server's "remove handler" function is called.  A
+ * client that gives a reference that is not valid, or that refers to a handler added by another
+ * client or to another service, is killed.
+ *
+ * @return The server's handler reference, or NULL if the reference is not valid.
+ */
+//--------------------------------------------------------------------------------------------------
+le_event_HandlerRef_t le_ipc_RemoveServerHandler
+(
+    le_msg_MessageRef_t msgRef,     ///< [IN] The "remove handler" request.
+    void*               ref         ///< [IN] Reference returned by le_ipc_AddServerHandler().
+)
+{
+    le_msg_SessionRef_t sessionRef = le_msg_GetSession(msgRef);
+    le_msg_ServiceRef_t serviceRef = le_msg_GetSessionService(sessionRef);
+
+    LOCK
+    le_ipc_ServerHandler_t* handlerPtr = le_ref_Lookup(ServerHandlerRefMap, ref);
+    if (   (handlerPtr != NULL)
+        && (   (handlerPtr->serviceRef != serviceRef)
+            || (handlerPtr->clientSessionRef != sessionRef) ) )
+    {
+        // Leave another client's handler alone.
+        handlerPtr = NULL;
+    }
+    if (handlerPtr != NULL)
+    {
+        le_ref_DeleteRef(ServerHandlerRefMap, ref);
+    }
+    UNLOCK
+
+    if (handlerPtr == NULL)
+    {
+        LE_KILL_CLIENT("Invalid handler reference %p", ref);
+        return NULL;
+    }
+
+    le_event_HandlerRef_t handlerRef = handlerPtr->handlerRef;
+    le_mem_Release(handlerPtr);
+
+    return handlerRef;
+}
@@ -0,0 +1,111 @@
+/** @file ipc.h
+ *
+ * IPC runtime module's intra-framework header file.  This file exposes type definitions and
+ * function interfaces to other modules inside the framework implementation.
+ *
+ * Copyright (C) Sierra Wireless, Inc. 2014.  Use of this work is subject to license.
+ */
+
+#ifndef LEGATO_SRC_IPC_H_INCLUDE_GUARD
+#define LEGATO_SRC_IPC_H_INCLUDE_GUARD
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum number of bytes (including the null-terminator) of a server function name returned by
+ * ipc_iter_GetNextFunc().  Longer names are truncated.
+ */
+//--------------------------------------------------------------------------------------------------
+#define IPC_MAX_FUNC_NAME_BYTES     64
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initializes the IPC runtime module.  This function must be called at start-up, after the
+ * memory pool and safe reference modules are initialized.
+ */
+//--------------------------------------------------------------------------------------------------
+void ipc_Init
+(
+    void
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reference to an iterator over the IPC servers of a remote process.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct ipc_iter_t* ipc_Iter_Ref_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Creates an iterator that can be used to iterate over the IPC servers in a specific process,
+ * and the call statistics of their functions.
+ *
+ * @note
+ *      The specified pid must be greater than zero.
+ *
+ *      The calling process must be root or have appropriate capabilities for this function and all
+ *      subsequent operations on the iterator to succeed.
+ *
+ *      If NULL is returned the errorPtr will be set appropriately.  Possible values are:
+ *      LE_NOT_POSSIBLE if the specified process is not a Legato process.
+ *      LE_FAULT if there was some other error.
+ *
+ * @return
+ *      An iterator to the list of servers for the specified process.
+ *      NULL if there was an error.
+ */
+//--------------------------------------------------------------------------------------------------
+LE_SHARED ipc_Iter_Ref_t ipc_iter_Create
+(
+    pid_t pid,                  ///< [IN] The process to get the iterator for.
+    le_result_t *errorPtr       ///< [OUT] Error code.  See comment block for more details.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Moves the iterator to the next server.
+ *
+ * @return
+ *      The server's service name (valid until the next call).
+ *      NULL if there are no more servers in the list.
+ */
+//--------------------------------------------------------------------------------------------------
+LE_SHARED const char* ipc_iter_GetNextServer
+(
+    ipc_Iter_Ref_t iterator     ///< [IN] The iterator.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the call statistics of the current server's next function.
+ *
+ * @return
+ *      The function's name (valid until the next call).
+ *      NULL if the server has no more functions.
+ */
+//--------------------------------------------------------------------------------------------------
+LE_SHARED const char* ipc_iter_GetNextFunc
+(
+    ipc_Iter_Ref_t iterator,            ///< [IN] The iterator.
+    le_ipc_ServerFuncStats_t* statsPtr  ///< [OUT] The function's call statistics.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Deletes the iterator.
+ */
+//--------------------------------------------------------------------------------------------------
+LE_SHARED void ipc_iter_Delete
+(
+    ipc_Iter_Ref_t iterator     ///< [IN] The iterator to delete.
+);
+
+
+#endif  // LEGATO_SRC_IPC_H_INCLUDE_GUARD
@@ -63,7 +63,7 @@ void log_Init
  * process before any component initialization functions are run.
  */
 //--------------------------------------------------------------------------------------------------
-void log_ConnectToControlDaemon
+LE_SHARED void log_ConnectToControlDaemon
 (
     void
 );
@@ -77,7 +77,7 @@ void log_ConnectToControlDaemon
  *      through a local macro with the name LE_LOG_SESSION.
  */
 //--------------------------------------------------------------------------------------------------
-le_log_SessionRef_t log_RegComponent
+LE_SHARED le_log_SessionRef_t log_RegComponent
 (
     const char* componentNamePtr,       ///< [IN] A pointer to the component's name.
     le_log_Level_t** levelFilterPtrPtr  ///< [OUT] Set to point to the component's level filter.
@@ -108,7 +108,7 @@ le_log_TraceRef_t log_RegTraceKeyword
  *      -1 if the string is an invalid log level.
  */
 //--------------------------------------------------------------------------------------------------
-le_log_Level_t log_StrToSeverityLevel
+LE_SHARED le_log_Level_t log_StrToSeverityLevel
 (
     const char* levelStr    ///< [IN] The severity level string.
 );
@@ -123,7 +123,7 @@ le_log_Level_t log_StrToSeverityLevel
  *      NULL if the value is out of range.
  */
 //--------------------------------------------------------------------------------------------------
-const char* log_SeverityLevelToStr
+LE_SHARED const char* log_SeverityLevelToStr
 (
     le_log_Level_t level    ///< [IN] Severity level.
 );
@@ -134,7 +134,7 @@ const char* log_SeverityLevelToStr
  * Log messages from the framework.  Used for testing only.
  */
 //--------------------------------------------------------------------------------------------------
-void log_TestFrameworkMsgs
+LE_SHARED void log_TestFrameworkMsgs
 (
     void
 );
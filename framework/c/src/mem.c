@@ -56,6 +56,12 @@
 #define GUARD_WORD ((uint32_t)0xDEADBEEF)
 #define GUARD_BAND_SIZE (sizeof(GUARD_WORD) * NUM_GUARD_BAND_WORDS)
 
+/// Objects are 8-byte aligned, even on 32-bit targets, so that they can hold 64-bit fields (e.g.,
+/// IPC message payloads).
+#define BLOCK_ALIGNMENT 8
+
+_Static_assert((GUARD_BAND_SIZE % BLOCK_ALIGNMENT) == 0, "Guard band would misalign objects");
+
 
 /// The default number of Sub Pool objects in the Sub Pools Pool.
 /// @todo Make this configurable.
@@ -113,8 +119,9 @@ typedef struct
     size_t refCount;            ///< The number of external references to this memory block's
                                 ///     user object. (0 = free)
 
-    uint8_t  data[];            ///< This block's data content (Has a guard band at the
-                                ///     start and end if USE_GUARD_BAND is defined).
+    /// This block's data content (Has a guard band at the start and end if USE_GUARD_BAND is
+    /// defined).
+    uint8_t  data[] __attribute__((aligned(BLOCK_ALIGNMENT)));
 }
 MemBlock_t;
 
@@ -304,11 +311,12 @@ static void InitPool
     }
     #endif
 
-    // Round up the block size to the nearest multiple of the processor word size.
-    size_t remainder = blockSize % sizeof(void*);
+    // Round up the block size to the nearest multiple of the block alignment, so that every block
+    // in a chunk is aligned (malloc() returns memory that is at least 8-byte aligned).
+    size_t remainder = blockSize % BLOCK_ALIGNMENT;
     if (remainder != 0)
     {
-        blockSize += (sizeof(void*) - remainder);
+        blockSize += (BLOCK_ALIGNMENT - remainder);
     }
 
     pool->poolLink = LE_DLS_LINK_INIT;
@@ -59,7 +59,7 @@ typedef struct mem_iter_t* mem_Iter_Ref_t;
  *      NULL if there was an error.
  */
 //--------------------------------------------------------------------------------------------------
-mem_Iter_Ref_t mem_iter_Create
+LE_SHARED mem_Iter_Ref_t mem_iter_Create
 (
     pid_t pid,                  ///< [IN] The process to get the iterator for.
     le_result_t *errorPtr       ///< [OUT] Error code.  See comment block for more details.
@@ -82,7 +82,7 @@ mem_Iter_Ref_t mem_iter_Create
  *      NULL if there are no more memory pools in the list.
  */
 //--------------------------------------------------------------------------------------------------
-le_mem_PoolRef_t mem_iter_GetNextPool
+LE_SHARED le_mem_PoolRef_t mem_iter_GetNextPool
 (
     mem_Iter_Ref_t iterator     ///< [IN] The iterator to get the next mem pool from.
 );
@@ -93,7 +93,7 @@ le_mem_PoolRef_t mem_iter_GetNextPool
  * Deletes the iterator.
  */
 //--------------------------------------------------------------------------------------------------
-void mem_iter_Delete
+LE_SHARED void mem_iter_Delete
 (
     mem_Iter_Ref_t iterator     ///< [IN] The iterator to delete.
 );
@@ -15,6 +15,18 @@
 #include "fileDescriptor.h"
 #include "unixSocket.h"
 
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of bytes sent ahead of the payload: the transaction ID plus any padding needed to align
+ * the payload (4 bytes of padding on 32-bit targets).
+ */
+//--------------------------------------------------------------------------------------------------
+#define HEADER_SIZE (offsetof(Message_t, payload) - offsetof(Message_t, txnId))
+
+_Static_assert((offsetof(Message_t, payload) % 8) == 0, "Message payload is not 8-byte aligned");
+
+
 // =======================================
 //  PRIVATE FUNCTIONS
 // =======================================
@@ -160,7 +172,7 @@ le_result_t msgMessage_Send
     // from our Message object's payload section, which comes right after the transaction ID.
     return unixSocket_SendMsg(  socketFd,
                                 &msgPtr->txnId,
-                                sizeof(msgPtr->txnId) + le_msg_GetMaxPayloadSize(msgPtr),
+                                HEADER_SIZE + le_msg_GetMaxPayloadSize(msgPtr),
                                 msgPtr->fd,
                                 false   ); // Don't send process credentials.
 }
@@ -186,7 +198,7 @@ le_result_t msgMessage_Receive
 {
     // Receive the first bytes into our transaction ID and the rest (if any)
     // into our Message object's payload section.
-    size_t byteCount = sizeof(msgRef->txnId) + le_msg_GetMaxPayloadSize(msgRef);
+    size_t byteCount = HEADER_SIZE + le_msg_GetMaxPayloadSize(msgRef);
     le_result_t result = unixSocket_ReceiveMsg( socketFd,
                                                 &msgRef->txnId,
                                                 &byteCount,
@@ -262,8 +274,9 @@ le_msg_MessageRef_t le_msg_CreateMsg
         msgPtr->clientServer.server.responseFd = -1;
     }
     msgPtr->fd = -1;
-    msgPtr->txnId = 0;
-    memset(msgPtr->payload, 0, le_msg_GetProtocolMaxMsgSize(protocolRef));
+
+    // Clear the transaction ID, the padding after it (which gets sent too) and the payload.
+    memset(&msgPtr->txnId, 0, HEADER_SIZE + le_msg_GetProtocolMaxMsgSize(protocolRef));
 
     return msgPtr;
 }
@@ -529,6 +542,87 @@ le_msg_MessageRef_t le_msg_RequestSyncResponse
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Record of a request-response transaction that a coroutine is waiting for.  Lives on the
+ * waiting coroutine's stack.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    le_coro_Ref_t       coroRef;        ///< The coroutine that is waiting.
+    le_msg_MessageRef_t responseRef;    ///< The response (or NULL if the transaction failed).
+    bool                isDone;         ///< true = the transaction has finished.
+}
+AwaitRecord_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Response callback used by le_msg_RequestAwaitResponse().  Called by the thread that is attached
+ * to the session, which is not necessarily the thread that runs the waiting coroutine.
+ */
+//--------------------------------------------------------------------------------------------------
+static void AwaitResponseHandler
+(
+    le_msg_MessageRef_t responseRef,    ///< [in] The response, or NULL if the transaction failed.
+    void*               contextPtr      ///< [in] Pointer to the AwaitRecord_t.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    AwaitRecord_t* recordPtr = contextPtr;
+
+    // Take a copy of the coroutine reference, because the record can go away as soon as the
+    // coroutine sees isDone.
+    le_coro_Ref_t coroRef = recordPtr->coroRef;
+
+    recordPtr->responseRef = responseRef;
+    __atomic_store_n(&recordPtr->isDone, true, __ATOMIC_RELEASE);
+
+    le_coro_Resume(coroRef);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Requests a response from a server by sending it a request, and waits for the response to arrive
+ * or for the transaction to terminate without a response.
+ *
+ * When called from inside a coroutine, only the calling coroutine waits.  When called from
+ * outside a coroutine, this is the same as le_msg_RequestSyncResponse().
+ *
+ * @return  A reference to the response message, or NULL if the transaction terminated without a
+ *          response.
+ */
+//--------------------------------------------------------------------------------------------------
+le_msg_MessageRef_t le_msg_RequestAwaitResponse
+(
+    le_msg_MessageRef_t msgRef      ///< [in] Reference to the request message.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    le_coro_Ref_t coroRef = le_coro_GetCurrent();
+
+    if (coroRef == NULL)
+    {
+        return le_msg_RequestSyncResponse(msgRef);
+    }
+
+    AwaitRecord_t record = { .coroRef = coroRef, .responseRef = NULL, .isDone = false };
+
+    le_msg_RequestResponse(msgRef, AwaitResponseHandler, &record);
+
+    // Someone else may resume this coroutine for their own reasons, so keep waiting until the
+    // response handler has actually run.
+    while (!__atomic_load_n(&record.isDone, __ATOMIC_ACQUIRE))
+    {
+        le_coro_Suspend();
+    }
+
+    return record.responseRef;
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Sends a response back to the client that send the request message.
@@ -42,7 +42,12 @@ typedef struct le_msg_Message
 
     int                         fd;         ///< File descriptor to send or received (-1 = no fd)
     void*                       txnId;      ///< Safe reference value used as a transaction ID.
-    void*                       payload[0]; ///< Variable-length payload buffer appears at the end.
+
+    /// Variable-length payload buffer appears at the end.  It is 8-byte aligned, even on 32-bit
+    /// targets, because the generated IPC code puts 64-bit fields at the start of it.  The
+    /// transaction ID and the payload are sent as one buffer, so any padding between them is
+    /// sent as well.
+    void*                       payload[0] __attribute__((aligned(8)));
 }
 Message_t;
 
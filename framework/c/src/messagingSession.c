@@ -367,7 +367,8 @@ static void RemoveFromTxnList
  * Removes all messages from the Transaction List, calls their completion callbacks (indicating
  * transaction failure for each) and deletes them.
  *
- * @note    This is used only on the server side.
+ * @note    This is used on the server side when the session closes, and on the client side when
+ *          the connection fails while waiting for responses (see msgSession_WaitForResponses()).
  */
 //--------------------------------------------------------------------------------------------------
 static void PurgeTxnList
@@ -1546,6 +1547,10 @@ le_msg_MessageRef_t msgSession_DoSyncRequestResponse
     // Put the socket into blocking mode.
     fd_SetBlocking(sessionRef->socketFd);
 
+    // Anything that is still waiting on the Transmit Queue (e.g., one-way or pipelined requests)
+    // has to go first, so that the server sees the requests in the order they were made.
+    SendFromTransmitQueue(sessionRef);
+
     // Send the Request Message.
     msgMessage_Send(sessionRef->socketFd, msgRef);
 
@@ -1601,6 +1606,94 @@ le_msg_MessageRef_t msgSession_DoSyncRequestResponse
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Wait, without running the Event Loop, for the responses to asynchronous request-response
+ * transactions until a given flag is set by one of their completion callbacks.
+ *
+ * Requests that are still on the Transmit Queue are sent first.  Each response that arrives has its
+ * completion callback called right away, as does each response that a synchronous transaction has
+ * already received and put on the Receive Queue.  Any other (indication) messages are left for the
+ * Event Loop, like they are during a synchronous transaction.
+ *
+ * If the connection fails, all of the session's transactions are terminated (i.e., their
+ * completion callbacks are called without a response).
+ */
+//--------------------------------------------------------------------------------------------------
+void msgSession_WaitForResponses
+(
+    le_msg_SessionRef_t sessionRef,
+    const bool* isDonePtr           ///< [in] The flag to wait for.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    // Only the thread that is handling events on this socket is allowed to wait on it.
+    LE_FATAL_IF(le_thread_GetCurrent() != sessionRef->threadRef,
+                "Attempted synchronous operation by thread that doesn't own session '%s'.",
+                le_msg_GetServiceName(le_msg_GetSessionService(sessionRef)));
+
+    // Look for responses that are already on the Receive Queue.
+    le_dls_Link_t* linkPtr = le_dls_Peek(&sessionRef->receiveQueue);
+
+    while ((linkPtr != NULL) && !(*isDonePtr))
+    {
+        le_dls_Link_t* nextLinkPtr = le_dls_PeekNext(&sessionRef->receiveQueue, linkPtr);
+        le_msg_MessageRef_t rxMsgRef = msgMessage_GetMessageContainingLink(linkPtr);
+
+        if (LookupTxnId(rxMsgRef) != NULL)
+        {
+            le_dls_Remove(&sessionRef->receiveQueue, linkPtr);
+            ProcessMessageFromServer(sessionRef, rxMsgRef);
+        }
+
+        linkPtr = nextLinkPtr;
+    }
+
+    if (*isDonePtr)
+    {
+        return;
+    }
+
+    // Put the socket into blocking mode, and make sure the requests have all been sent.
+    fd_SetBlocking(sessionRef->socketFd);
+    SendFromTransmitQueue(sessionRef);
+
+    while (!(*isDonePtr))
+    {
+        le_msg_MessageRef_t rxMsgRef = le_msg_CreateMsg(sessionRef);
+
+        if (msgMessage_Receive(sessionRef->socketFd, rxMsgRef) != LE_OK)
+        {
+            // The socket experienced an error or the connection was closed, so none of the
+            // outstanding responses will arrive.
+            le_msg_ReleaseMsg(rxMsgRef);
+            PurgeTransmitQueue(sessionRef);
+            PurgeTxnList(sessionRef);
+            break;
+        }
+
+        if (LookupTxnId(rxMsgRef) != NULL)
+        {
+            ProcessMessageFromServer(sessionRef, rxMsgRef);
+        }
+        else
+        {
+            // Queue the indication message for later processing by the Event Loop, kick starting
+            // the processing if the Receive Queue was empty (see msgSession_DoSyncRequestResponse).
+            if (le_dls_IsEmpty(&sessionRef->receiveQueue))
+            {
+                TriggerDeferredProcessing(sessionRef);
+            }
+
+            PushReceiveQueue(sessionRef, rxMsgRef);
+        }
+    }
+
+    // Put the socket back into non-blocking mode.
+    fd_SetNonBlocking(sessionRef->socketFd);
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Fetches the service reference for a given Session object.
@@ -84,6 +84,19 @@ le_msg_MessageRef_t msgSession_DoSyncRequestResponse
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Wait, without running the Event Loop, for the responses to asynchronous request-response
+ * transactions until a given flag is set by one of their completion callbacks.
+ */
+//--------------------------------------------------------------------------------------------------
+void msgSession_WaitForResponses
+(
+    le_msg_SessionRef_t sessionRef,
+    const bool* isDonePtr
+);
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Fetches the service reference for a given Session object.
@@ -157,7 +170,7 @@ le_msg_SessionRef_t msgSession_CreateServerSideSession
  *          error being logged and the client process being killed.
  */
 //--------------------------------------------------------------------------------------------------
-le_result_t msgSession_TryOpenSessionSync
+LE_SHARED le_result_t msgSession_TryOpenSessionSync
 (
     le_msg_SessionRef_t             sessionRef      ///< [in] Reference to the session.
 );
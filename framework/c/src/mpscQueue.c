@@ -0,0 +1,165 @@
+/** @file mpscQueue.c
+ *
+ * Lock-free Multi-Producer, Single-Consumer Queue implementation.  See mpscQueue.h for details.
+ *
+ * The queue always contains at least one link: the @c stub link that lives inside the queue
+ * object itself.  Producers atomically swap themselves into @c headPtr and then link the previous
+ * head to themselves.  The consumer follows the chain from @c tailPtr.  Between those two steps
+ * of a push, the new link is in the queue but can't yet be reached from the tail; the consumer
+ * detects this (the head has moved but the tail's next pointer is still NULL) and waits for the
+ * producer to finish.
+ *
+ * Copyright (C) Sierra Wireless, Inc. 2014. All rights reserved. Use of this work is subject to license.
+ */
+
+#include "legato.h"
+#include "mpscQueue.h"
+
+#include <sched.h>
+
+
+// ==============================
+//  PRIVATE FUNCTIONS
+// ==============================
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Wait for a producer to finish linking a new link behind a given link.
+ *
+ * @return Pointer to the next link.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_sls_Link_t* WaitForNext
+(
+    le_sls_Link_t*  linkPtr     ///< [in] Link whose next pointer is being set by a producer.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    le_sls_Link_t* nextPtr;
+
+    // The producer is only ever a couple of instructions away from storing the pointer, so this
+    // should almost never actually need to yield.
+    while ((nextPtr = __atomic_load_n(&linkPtr->nextPtr, __ATOMIC_ACQUIRE)) == NULL)
+    {
+        sched_yield();
+    }
+
+    return nextPtr;
+}
+
+
+// ==============================
+//  INTRA-FRAMEWORK FUNCTIONS
+// ==============================
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initialize an MPSC Queue.  Must be called before any other thread can access the queue.
+ */
+//--------------------------------------------------------------------------------------------------
+void mpscq_Init
+(
+    mpscq_Queue_t*  queuePtr    ///< [in] Queue to initialize.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    queuePtr->stub = LE_SLS_LINK_INIT;
+    queuePtr->headPtr = &queuePtr->stub;
+    queuePtr->tailPtr = &queuePtr->stub;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Push a link onto the tail of an MPSC Queue.  Can be called by any thread.
+ */
+//--------------------------------------------------------------------------------------------------
+void mpscq_Push
+(
+    mpscq_Queue_t*  queuePtr,   ///< [in] Queue to push onto.
+    le_sls_Link_t*  linkPtr     ///< [in] Link to push.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    __atomic_store_n(&linkPtr->nextPtr, NULL, __ATOMIC_RELAXED);
+
+    le_sls_Link_t* prevPtr = __atomic_exchange_n(&queuePtr->headPtr, linkPtr, __ATOMIC_ACQ_REL);
+
+    // NOTE: Until this store is done, the consumer can't reach the new link (see WaitForNext()).
+    __atomic_store_n(&prevPtr->nextPtr, linkPtr, __ATOMIC_RELEASE);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Pop a link off the head of an MPSC Queue.  Must only be called by the queue's consumer thread.
+ *
+ * If a producer is part way through pushing a link onto the queue, this waits (yielding the CPU)
+ * for the producer to finish linking it in, so a link whose push has completed is never missed.
+ *
+ * @return Pointer to the link, or NULL if the queue is empty.
+ */
+//--------------------------------------------------------------------------------------------------
+le_sls_Link_t* mpscq_Pop
+(
+    mpscq_Queue_t*  queuePtr    ///< [in] Queue to pop from.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    le_sls_Link_t* tailPtr = queuePtr->tailPtr;
+    le_sls_Link_t* nextPtr = __atomic_load_n(&tailPtr->nextPtr, __ATOMIC_ACQUIRE);
+
+    // Skip over the stub, if it's at the tail.
+    if (tailPtr == &queuePtr->stub)
+    {
+        if (nextPtr == NULL)
+        {
+            if (__atomic_load_n(&queuePtr->headPtr, __ATOMIC_ACQUIRE) == tailPtr)
+            {
+                return NULL;
+            }
+
+            nextPtr = WaitForNext(tailPtr);
+        }
+
+        queuePtr->tailPtr = nextPtr;
+        tailPtr = nextPtr;
+        nextPtr = __atomic_load_n(&tailPtr->nextPtr, __ATOMIC_ACQUIRE);
+    }
+
+    // If there's something behind the tail, the tail can be detached.
+    if (nextPtr != NULL)
+    {
+        queuePtr->tailPtr = nextPtr;
+        return tailPtr;
+    }
+
+    // The tail looks like the last link.  If the head has moved, a producer is mid-push;
+    // otherwise, put the stub back in behind the tail so the tail can be detached.
+    if (__atomic_load_n(&queuePtr->headPtr, __ATOMIC_ACQUIRE) == tailPtr)
+    {
+        mpscq_Push(queuePtr, &queuePtr->stub);
+    }
+
+    queuePtr->tailPtr = WaitForNext(tailPtr);
+
+    return tailPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check whether an MPSC Queue is empty.  Must only be called by the queue's consumer thread.
+ *
+ * @return true if the queue is empty (nothing has been pushed that hasn't been popped).
+ */
+//--------------------------------------------------------------------------------------------------
+bool mpscq_IsEmpty
+(
+    mpscq_Queue_t*  queuePtr    ///< [in] Queue to check.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    return (   (queuePtr->tailPtr == &queuePtr->stub)
+            && (__atomic_load_n(&queuePtr->headPtr, __ATOMIC_ACQUIRE) == &queuePtr->stub) );
+}
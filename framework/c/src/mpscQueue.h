@@ -0,0 +1,90 @@
+/** @file mpscQueue.h
+ *
+ * Multi-Producer, Single-Consumer (MPSC) Queue module's intra-framework header file.
+ *
+ * This is an intrusive, lock-free queue (based on Dmitry Vyukov's MPSC node-based queue).  Any
+ * number of threads can push onto the queue concurrently without taking a lock, but only a single
+ * thread (the owner of the queue) may pop from it.  This is exactly the access pattern of a
+ * thread's Event Queue: anyone can report an event to a thread, but only that thread's Event Loop
+ * takes reports off of its queue.
+ *
+ * Items are linked into the queue using the same link type as the @ref c_singlyLinkedList, so
+ * objects that used to be queued on an le_sls_List_t can be queued on an MPSC Queue without
+ * changes to their layout.
+ *
+ * Copyright (C) Sierra Wireless, Inc. 2014. All rights reserved. Use of this work is subject to license.
+ */
+
+#ifndef LEGATO_SRC_MPSC_QUEUE_H_INCLUDE_GUARD
+#define LEGATO_SRC_MPSC_QUEUE_H_INCLUDE_GUARD
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * MPSC Queue object.
+ *
+ * @warning No code outside of the MPSC Queue module (mpscQueue.c) should ever access the members
+ *          of this structure.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    le_sls_Link_t*  headPtr;    ///< Most recently pushed link.  Swapped atomically by producers.
+    le_sls_Link_t*  tailPtr;    ///< Next link to be popped.  Only accessed by the consumer.
+    le_sls_Link_t   stub;       ///< Dummy link that keeps the queue from ever becoming unlinked.
+}
+mpscq_Queue_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initialize an MPSC Queue.  Must be called before any other thread can access the queue.
+ */
+//--------------------------------------------------------------------------------------------------
+void mpscq_Init
+(
+    mpscq_Queue_t*  queuePtr    ///< [in] Queue to initialize.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Push a link onto the tail of an MPSC Queue.  Can be called by any thread.
+ */
+//--------------------------------------------------------------------------------------------------
+void mpscq_Push
+(
+    mpscq_Queue_t*  queuePtr,   ///< [in] Queue to push onto.
+    le_sls_Link_t*  linkPtr     ///< [in] Link to push.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Pop a link off the head of an MPSC Queue.  Must only be called by the queue's consumer thread.
+ *
+ * If a producer is part way through pushing a link onto the queue, this waits (yielding the CPU)
+ * for the producer to finish linking it in, so a link whose push has completed is never missed.
+ *
+ * @return Pointer to the link, or NULL if the queue is empty.
+ */
+//--------------------------------------------------------------------------------------------------
+le_sls_Link_t* mpscq_Pop
+(
+    mpscq_Queue_t*  queuePtr    ///< [in] Queue to pop from.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check whether an MPSC Queue is empty.  Must only be called by the queue's consumer thread.
+ *
+ * @return true if the queue is empty (nothing has been pushed that hasn't been popped).
+ */
+//--------------------------------------------------------------------------------------------------
+bool mpscq_IsEmpty
+(
+    mpscq_Queue_t*  queuePtr    ///< [in] Queue to check.
+);
+
+
+#endif /* LEGATO_SRC_MPSC_QUEUE_H_INCLUDE_GUARD */
@@ -14,7 +14,9 @@
  * Some of the tricky features of the Mutexes have to do with the diagnostic capabilities provided
  * by command-line tools.  That is, the command-line tools can ask:
  *  -# What mutexes are currently held by a given thread?
- *    - To support this, a list of locked mutexes is kept per-thread.
+ *    - To support this, a list of locked mutexes is kept per-thread.  This is only maintained
+ *      for Traceable mutexes, or for all mutexes if the framework is built with lock tracking
+ *      enabled (LEGATO_LOCK_TRACKING), because it costs a list insertion on every lock.
  *  -# What mutex is a given thread currently waiting on?
  *    - A single mutex reference per thread keeps track of this (NULL if not waiting).
  *  -# What mutexes currently exist in the process?
@@ -28,6 +30,12 @@
  *  -# What type of mutex is a given mutex? (recursive? traceable?)
  *    - These are stored in each Mutex object as boolean flags.
  *
+ * The mutexes themselves are implemented directly on top of a Linux futex (see futex.h) rather
+ * than a pthreads mutex.  The futex word is 0 when unlocked, 1 when locked, and 2 when locked with
+ * (possibly) other threads waiting.  Locking an uncontended mutex is a single atomic
+ * compare-and-swap and unlocking it is a single atomic decrement; the kernel is only entered, and
+ * the waiting list is only updated, when a thread actually has to wait for the lock.
+ *
  * The command-line tools communicate with the mutex module using IPC datagram messages.
  * This file implements handling functions for those messages and sends back responses.
  *
@@ -43,6 +51,7 @@
 #include "limit.h"
 #include "mutex.h"
 #include "thread.h"
+#include "futex.h"
 
 #include <pthread.h>
 
@@ -58,6 +67,19 @@
 /// TODO: Change this to be configurable per-process.
 #define DEFAULT_POOL_SIZE 4
 
+/// true if all mutexes should be added to their holding thread's locked mutex list, not just
+/// Traceable ones.  Turned on by building with LOCK_TRACKING=1.
+#ifdef LEGATO_LOCK_TRACKING
+#define TRACK_ALL_MUTEXES true
+#else
+#define TRACK_ALL_MUTEXES false
+#endif
+
+/// Futex word values.
+#define FUTEX_UNLOCKED  0   ///< Not locked.
+#define FUTEX_LOCKED    1   ///< Locked, nobody waiting.
+#define FUTEX_CONTENDED 2   ///< Locked, and other threads may be waiting.
+
 
 //--------------------------------------------------------------------------------------------------
 /**
@@ -73,8 +95,9 @@ typedef struct le_mutex
     pthread_mutex_t     waitingListMutex;   ///< Pthreads mutex used to protect the waiting list.
     bool                isTraceable;        ///< true if traceable, false otherwise.
     bool                isRecursive;        ///< true if recursive, false otherwise.
+    bool                isTracked;          ///< true = kept on the holder's locked mutex list.
     int                 lockCount;      ///< Number of lock calls not yet matched by unlock calls.
-    pthread_mutex_t     mutex;          ///< Pthreads mutex that does the real work. :)
+    int32_t             futex;          ///< Futex word that does the real work. :)
     char                name[MAX_NAME_BYTES]; ///< The name of the mutex (UTF8 string).
 }
 Mutex_t;
@@ -155,32 +178,14 @@ le_mutex_Ref_t CreateMutex
     pthread_mutex_init(&mutexPtr->waitingListMutex, NULL);  // Default attributes = Fast mutex.
     mutexPtr->isTraceable = isTraceable;
     mutexPtr->isRecursive = isRecursive;
+    mutexPtr->isTracked = (isTraceable || TRACK_ALL_MUTEXES);
     mutexPtr->lockCount = 0;
+    mutexPtr->futex = FUTEX_UNLOCKED;
     if (le_utf8_Copy(mutexPtr->name, nameStr, sizeof(mutexPtr->name), NULL) == LE_OVERFLOW)
     {
         LE_WARN("Mutex name '%s' truncated to '%s'.", nameStr, mutexPtr->name);
     }
 
-    // Initialize the underlying POSIX mutex according to whether the mutex is recursive or not.
-    pthread_mutexattr_t mutexAttrs;
-    pthread_mutexattr_init(&mutexAttrs);
-    int mutexType;
-    if (isRecursive)
-    {
-        mutexType = PTHREAD_MUTEX_RECURSIVE_NP;
-    }
-    else
-    {
-        mutexType = PTHREAD_MUTEX_ERRORCHECK_NP;
-    }
-    int result = pthread_mutexattr_settype(&mutexAttrs, mutexType);
-    if (result != 0)
-    {
-        LE_FATAL("Failed to set the mutex type to %d.  errno = %d (%m).", mutexType, errno);
-    }
-    pthread_mutex_init(&mutexPtr->mutex, &mutexAttrs);
-    pthread_mutexattr_destroy(&mutexAttrs);
-
     // Add the mutex to the process's Mutex List.
     LOCK_MUTEX_LIST();
     le_dls_Queue(&MutexList, &mutexPtr->mutexListLink);
@@ -237,24 +242,30 @@ static void RemoveFromWaitingList
  * This updates all the data structures to reflect the fact that this mutex was just locked
  * by the calling thread.
  *
- * @note    Assumes that the lock count has already been updated before this function was called.
- *
- * @warning Assumes that the calling thread already holds the pthreads mutex lock.
+ * @warning Assumes that the calling thread already holds the futex lock.
  */
 //--------------------------------------------------------------------------------------------------
 static void MarkLocked
 (
-    mutex_ThreadRec_t*  perThreadRecPtr,    ///< [in] Pointer to the thread's mutex info record.
-    Mutex_t*            mutexPtr            ///< [in] Pointer to the Mutex object that was locked.
+    Mutex_t*            mutexPtr,           ///< [in] Pointer to the Mutex object that was locked.
+    le_thread_Ref_t     currentThreadRef    ///< [in] Reference to the calling thread.
 )
 //--------------------------------------------------------------------------------------------------
 {
-    // Push it onto the calling thread's list of locked mutexes.
+    // NOTE: the lock count is protected by the mutex itself.  That is, it can never be
+    //       updated by anyone who doesn't hold the lock on the mutex.
+    mutexPtr->lockCount = 1;
+
+    // Push it onto the calling thread's list of locked mutexes, if it is being tracked.
     // NOTE: Mutexes tend to be locked and unlocked in a nested manner, so treat this like a stack.
-    le_dls_Stack(&perThreadRecPtr->lockedMutexList, &mutexPtr->lockedByThreadLink);
+    if (mutexPtr->isTracked)
+    {
+        le_dls_Stack(&thread_GetMutexRecPtr()->lockedMutexList, &mutexPtr->lockedByThreadLink);
+    }
 
     // Record the current thread in the Mutex object as the thread that currently holds the lock.
-    mutexPtr->lockingThreadRef = le_thread_GetCurrent();
+    // NOTE: Other threads read this without holding the lock (see IsHeldByCaller()).
+    __atomic_store_n(&mutexPtr->lockingThreadRef, currentThreadRef, __ATOMIC_RELAXED);
 }
 
 
@@ -267,7 +278,7 @@ static void MarkLocked
  *
  * @note    Assumes that the lock count has already been updated before this function was called.
  *
- * @warning Assumes that the calling thread actually still holds the pthreads mutex lock.
+ * @warning Assumes that the calling thread actually still holds the futex lock.
  */
 //--------------------------------------------------------------------------------------------------
 static void MarkUnlocked
@@ -276,14 +287,111 @@ static void MarkUnlocked
 )
 //--------------------------------------------------------------------------------------------------
 {
-    mutex_ThreadRec_t* perThreadRecPtr = thread_GetMutexRecPtr();
-
     // Remove it the calling thread's list of locked mutexes.
     // TODO: Should we warn if mutexes are not unlocked in the reverse order of being locked?
-    le_dls_Remove(&perThreadRecPtr->lockedMutexList, &mutexPtr->lockedByThreadLink);
+    if (mutexPtr->isTracked)
+    {
+        le_dls_Remove(&thread_GetMutexRecPtr()->lockedMutexList, &mutexPtr->lockedByThreadLink);
+    }
 
     // Record in the Mutex object that no thread currently holds the lock.
-    mutexPtr->lockingThreadRef = NULL;
+    __atomic_store_n(&mutexPtr->lockingThreadRef, NULL, __ATOMIC_RELAXED);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check whether the calling thread holds the lock on a mutex.
+ *
+ * @note This is safe to call without holding the lock, because the only thread that can ever
+ *       set the mutex's locking thread reference to the calling thread is the calling thread.
+ *
+ * @return true if the calling thread holds the lock.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline bool IsHeldByCaller
+(
+    Mutex_t*            mutexPtr,
+    le_thread_Ref_t     currentThreadRef
+)
+//--------------------------------------------------------------------------------------------------
+{
+    return (__atomic_load_n(&mutexPtr->lockingThreadRef, __ATOMIC_RELAXED) == currentThreadRef);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Try to take the futex lock without blocking.
+ *
+ * @return true if the lock was acquired.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline bool TryLockFutex
+(
+    Mutex_t* mutexPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    int32_t expected = FUTEX_UNLOCKED;
+
+    return __atomic_compare_exchange_n(&mutexPtr->futex,
+                                       &expected,
+                                       FUTEX_LOCKED,
+                                       false,
+                                       __ATOMIC_ACQUIRE,
+                                       __ATOMIC_RELAXED);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Take the futex lock when it is held by another thread (the slow path).
+ *
+ * This is the only place where the calling thread is recorded as waiting on the mutex.
+ */
+//--------------------------------------------------------------------------------------------------
+static void LockFutexContended
+(
+    Mutex_t* mutexPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    mutex_ThreadRec_t* perThreadRecPtr = thread_GetMutexRecPtr();
+
+    perThreadRecPtr->waitingOnMutex = mutexPtr;
+    AddToWaitingList(mutexPtr, perThreadRecPtr);
+
+    // Mark the futex contended so the holder knows to wake someone when it unlocks.  If it
+    // turns out to have been unlocked in the meantime, then we got it (and may have marked it
+    // contended unnecessarily, which just costs the next unlock a wake-up system call).
+    while (__atomic_exchange_n(&mutexPtr->futex, FUTEX_CONTENDED, __ATOMIC_ACQUIRE)
+           != FUTEX_UNLOCKED)
+    {
+        futex_Wait(&mutexPtr->futex, FUTEX_CONTENDED, NULL);
+    }
+
+    RemoveFromWaitingList(mutexPtr, perThreadRecPtr);
+    perThreadRecPtr->waitingOnMutex = NULL;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Release the futex lock, waking up one waiting thread if there might be any.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline void UnlockFutex
+(
+    Mutex_t* mutexPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (__atomic_fetch_sub(&mutexPtr->futex, 1, __ATOMIC_RELEASE) != FUTEX_LOCKED)
+    {
+        __atomic_store_n(&mutexPtr->futex, FUTEX_UNLOCKED, __ATOMIC_RELEASE);
+        futex_Wake(&mutexPtr->futex, 1);
+    }
 }
 
 
@@ -439,10 +547,8 @@ void le_mutex_Delete
     le_dls_Remove(&MutexList, &mutexRef->mutexListLink);
     UNLOCK_MUTEX_LIST();
 
-    if (mutexRef->lockingThreadRef != NULL)
-
-    // Destroy the pthreads mutex.
-    if (pthread_mutex_destroy(&mutexRef->mutex) != 0)
+    // Make sure no one holds the lock.
+    if (__atomic_load_n(&mutexRef->futex, __ATOMIC_ACQUIRE) != FUTEX_UNLOCKED)
     {
         char threadName[LIMIT_MAX_THREAD_NAME_BYTES];
         le_thread_GetName(mutexRef->lockingThreadRef, threadName, sizeof(threadName));
@@ -451,6 +557,8 @@ void le_mutex_Delete
                     threadName  );
     }
 
+    pthread_mutex_destroy(&mutexRef->waitingListMutex);
+
     // Release the Mutex object back to the Mutex Pool.
     le_mem_Release(mutexRef);
 }
@@ -477,51 +585,33 @@ void le_mutex_Lock
     else
     */
     {
-        int result;
-
-        mutex_ThreadRec_t* perThreadRecPtr = thread_GetMutexRecPtr();
-
-        perThreadRecPtr->waitingOnMutex = mutexRef;
-        AddToWaitingList(mutexRef, perThreadRecPtr);
-
-        result = pthread_mutex_lock(&mutexRef->mutex);
-
-        RemoveFromWaitingList(mutexRef, perThreadRecPtr);
-        perThreadRecPtr->waitingOnMutex = NULL;
+        le_thread_Ref_t currentThread = le_thread_GetCurrent();
 
-        if (result == 0)
+        // If the calling thread already holds the lock, this is either a recursive lock or
+        // a deadlock.
+        if (IsHeldByCaller(mutexRef, currentThread))
         {
-            // Got the lock!
-
-            // NOTE: the lock count is protected by the mutex itself.  That is, it can never be
-            //       updated by anyone who doesn't hold the lock on the mutex.
-
-            // If the mutex wasn't already locked by this thread before, we need to update
-            // the data structures to indicate that it now holds the lock.
-            if (mutexRef->lockCount == 0)
+            if (!mutexRef->isRecursive)
             {
-                MarkLocked(perThreadRecPtr, mutexRef);
+                LE_FATAL("DEADLOCK DETECTED! Thread '%s' attempting to re-lock mutex '%s'.",
+                         le_thread_GetMyName(),
+                         mutexRef->name);
             }
 
-            // Update the lock count.
+            // NOTE: the lock count is protected by the mutex itself.
             mutexRef->lockCount++;
+
+            return;
         }
-        else
+
+        // Fast path: a single compare-and-swap if nobody holds the lock.
+        if (!TryLockFutex(mutexRef))
         {
-            if (result == EDEADLK)
-            {
-                LE_FATAL("DEADLOCK DETECTED! Thread '%s' attempting to re-lock mutex '%s'.",
-                         le_thread_GetMyName(),
-                         mutexRef->name);
-            }
-            else
-            {
-                LE_FATAL("Thread '%s' failed to lock mutex '%s'. Error code %d (%m).",
-                         le_thread_GetMyName(),
-                         mutexRef->name,
-                         result );
-            }
+            LockFutexContended(mutexRef);
         }
+
+        // Got the lock!
+        MarkLocked(mutexRef, currentThread);
     }
 }
 
@@ -551,36 +641,28 @@ le_result_t le_mutex_TryLock
     else
     */
     {
-        int result = pthread_mutex_trylock(&mutexRef->mutex);
+        le_thread_Ref_t currentThread = le_thread_GetCurrent();
 
-        if (result == 0)
+        if (IsHeldByCaller(mutexRef, currentThread))
         {
-            // Got the lock!
-
-            // NOTE: the lock count is protected by the mutex itself.  That is, it can never be
-            //       updated by anyone who doesn't hold the lock on the mutex.
-
-            // If the mutex wasn't already locked by this thread before, we need to update
-            // the data structures to indicate that it now holds the lock.
-            if (mutexRef->lockCount == 0)
+            // A non-recursive mutex already held by the caller can't be locked again.
+            if (!mutexRef->isRecursive)
             {
-                MarkLocked(thread_GetMutexRecPtr(), mutexRef);
+                return LE_WOULD_BLOCK;
             }
 
-            // Update the lock count.
+            // NOTE: the lock count is protected by the mutex itself.
             mutexRef->lockCount++;
         }
-        else if (result == EBUSY)
+        else if (TryLockFutex(mutexRef))
         {
-            // The mutex is already held by someone else.
-            return LE_WOULD_BLOCK;
+            // Got the lock!
+            MarkLocked(mutexRef, currentThread);
         }
         else
         {
-            LE_FATAL("Thread '%s' failed to trylock mutex '%s'. Error code %d (%m).",
-                     le_thread_GetMyName(),
-                     mutexRef->name,
-                     result );
+            // The mutex is already held by someone else.
+            return LE_WOULD_BLOCK;
         }
 
         return LE_OK;
@@ -609,19 +691,16 @@ void le_mutex_Unlock
     else
     */
     {
-        int result;
-
-        le_thread_Ref_t lockingThread = mutexRef->lockingThreadRef;
-        le_thread_Ref_t currentThread = le_thread_GetCurrent();
-
-        // Make sure that the lock count is at least 1.
-        LE_FATAL_IF(mutexRef->lockCount <= 0,
-                    "Mutex '%s' unlocked too many times!",
-                    mutexRef->name);
-
         // Make sure that the current thread is the one holding the mutex lock.
-        if (lockingThread != currentThread)
+        if (!IsHeldByCaller(mutexRef, le_thread_GetCurrent()))
         {
+            le_thread_Ref_t lockingThread = __atomic_load_n(&mutexRef->lockingThreadRef,
+                                                            __ATOMIC_RELAXED);
+
+            LE_FATAL_IF(lockingThread == NULL,
+                        "Mutex '%s' unlocked too many times!",
+                        mutexRef->name);
+
             char threadName[LIMIT_MAX_THREAD_NAME_BYTES];
             le_thread_GetName(lockingThread, threadName, sizeof(threadName));
             LE_FATAL("Attempt to unlock mutex '%s' held by other thread '%s'.",
@@ -640,16 +719,9 @@ void le_mutex_Unlock
         if (mutexRef->lockCount == 0)
         {
             MarkUnlocked(mutexRef);
-        }
 
-        // Warning!  If the lock count is now zero, then as soon as we call this function another
-        // thread may grab the lock.
-        result = pthread_mutex_unlock(&mutexRef->mutex);
-        if (result != 0)
-        {
-            LE_FATAL("Failed to unlock mutex '%s'. Errno = %d (%m).",
-                     mutexRef->name,
-                     result );
+            // Warning!  As soon as we call this function another thread may grab the lock.
+            UnlockFutex(mutexRef);
         }
     }
 }
@@ -24,7 +24,7 @@
 
 /// Default number of Map objects in the Map Pool.
 /// @todo Make this configurable.
-#define DEFAULT_MAP_POOL_SIZE 10
+#define DEFAULT_MAP_POOL_SIZE 12
 
 /// Name used for diagnostics.
 static const char ModuleName[] = "ref";
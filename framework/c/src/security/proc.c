@@ -88,6 +88,17 @@
 //--------------------------------------------------------------------------------------------------
 #define CFG_NODE_FAULT_ACTION                       "faultAction"
 
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * The name of the node in the config tree that contains the list of CPUs that a process is allowed
+ * to run on.  Each child node is an integer CPU number (0 = first CPU).
+ *
+ * If this entry in the config tree is missing or is empty, the process may run on any CPU.
+ */
+//--------------------------------------------------------------------------------------------------
+#define CFG_NODE_CPU_AFFINITY                       "cpuAffinity"
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Fault action string definitions.
@@ -378,6 +389,60 @@ static void SetSchedulingPriority
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sets the CPU affinity for the specified process based on the process' configuration settings in
+ * the config tree.  Must be done while the process is still single-threaded, so that all threads
+ * it creates later inherit the affinity.
+ *
+ * @note This function kills the specified process if there is an error.
+ */
+//--------------------------------------------------------------------------------------------------
+static void SetCpuAffinity
+(
+    proc_Ref_t procRef      ///< [IN] The process to set the CPU affinity for.
+)
+{
+    le_cfg_IteratorRef_t procCfg = le_cfg_CreateReadTxn(procRef->cfgPathRoot);
+    le_cfg_GoToNode(procCfg, CFG_NODE_CPU_AFFINITY);
+
+    if (le_cfg_GoToFirstChild(procCfg) != LE_OK)
+    {
+        // Not configured, so the process may run on any CPU.
+        le_cfg_CancelTxn(procCfg);
+        return;
+    }
+
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+
+    do
+    {
+        int cpu = le_cfg_GetInt(procCfg, "", -1);
+
+        if ((cpu < 0) || (cpu >= CPU_SETSIZE))
+        {
+            LE_WARN("Ignoring invalid CPU number %d in CPU affinity of process '%s'.",
+                    cpu,
+                    procRef->name);
+        }
+        else
+        {
+            CPU_SET(cpu, &cpuSet);
+        }
+    }
+    while (le_cfg_GoToNextSibling(procCfg) == LE_OK);
+
+    le_cfg_CancelTxn(procCfg);
+
+    if (sched_setaffinity(procRef->pid, sizeof(cpuSet), &cpuSet) == -1)
+    {
+        LE_ERROR("Could not set CPU affinity of process '%s'.  %m.", procRef->name);
+        LE_ASSERT(kill(procRef->pid, SIGKILL) == 0);
+    }
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Gets the environment variable from the list of environment variables in the config tree.
@@ -757,6 +822,9 @@ static inline le_result_t StartProc
     // Set the scheduling priority for the child process while the child process is blocked.
     SetSchedulingPriority(procRef);
 
+    // Pin the child process to its CPUs while it is still blocked (and single-threaded).
+    SetCpuAffinity(procRef);
+
     // Set the resource limits for the child process while the child process is blocked.
     if (resLim_SetProcLimits(procRef) != LE_OK)
     {
@@ -132,6 +132,18 @@
 #define CFG_NODE_LIMIT_MAX_FILE_DESCRIPTORS             "maxFileDescriptors"
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * The name of the node in the config tree that contains a process's stack size limit.  Because
+ * the C library uses the stack size limit as the default stack size for new threads, this also
+ * sets the stack size of any threads the process creates without setting a stack size explicitly.
+ *
+ * If this entry in the config tree is missing or is empty, the stack size limit is not changed.
+ */
+//--------------------------------------------------------------------------------------------------
+#define CFG_NODE_LIMIT_MAX_STACK_BYTES                  "maxStackBytes"
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Resource limit defaults.
@@ -396,6 +408,13 @@ le_result_t resLim_SetProcLimits
     SetRLimit(pid, procCfg, CFG_NODE_LIMIT_MAX_FILE_DESCRIPTORS, RLIMIT_NOFILE,
               DEFAULT_LIMIT_MAX_FILE_DESCRIPTORS);
 
+    // There's no sensible default for the stack size other than the system's own, so only set it
+    // if it has been configured.
+    if (!le_cfg_IsEmpty(procCfg, CFG_NODE_LIMIT_MAX_STACK_BYTES))
+    {
+        SetRLimit(pid, procCfg, CFG_NODE_LIMIT_MAX_STACK_BYTES, RLIMIT_STACK, 0);
+    }
+
     // Set the application limits.
     //
     // @note Even though these are application limits they still need to be set for the process
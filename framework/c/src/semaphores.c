@@ -24,6 +24,12 @@
  *  -# What type of semaphore is a given semaphore? (traceable?)
  *    - These are stored in each Semaphore object as boolean flags.
  *
+ * The semaphores themselves are implemented directly on top of a Linux futex (see futex.h) that
+ * holds the semaphore's value, plus a count of threads that are waiting.  Waiting on a semaphore
+ * whose value is positive is a single atomic compare-and-swap, and posting to a semaphore that
+ * nobody is waiting on is a single atomic increment.  Only when a thread actually has to block
+ * does it get added to the semaphore's waiting list and enter the kernel.
+ *
  * The command-line tools communicate with the semaphore module using IPC datagram messages.
  * This file implements handling functions for those messages and sends back responses.
  *
@@ -39,9 +45,9 @@
 #include "limit.h"
 #include "semaphores.h"
 #include "thread.h"
+#include "futex.h"
 
 #include <pthread.h>
-#include <semaphore.h>
 
 // ==============================
 //  PRIVATE DATA
@@ -63,7 +69,8 @@ typedef struct le_sem_t
     le_dls_List_t       waitingList;         ///< List of threads waiting for this semaphore.
     pthread_mutex_t     waitingListMutex;    ///< Pthreads mutex used to protect the waiting list.
     bool                isTraceable;         ///< true if traceable, false otherwise.
-    sem_t               semaphore;           ///< Pthreads semaphore that does the real work. :)
+    int32_t             value;               ///< Futex word holding the semaphore's value.
+    int32_t             waiterCount;         ///< Number of threads blocked (or about to block).
     char                nameStr[LIMIT_MAX_SEMAPHORE_NAME_BYTES]; ///< The name of the semaphore (UTF8 string).
 }
 Semaphore_t;
@@ -140,14 +147,19 @@ le_sem_Ref_t CreateSemaphore
     semaphorePtr->waitingList = LE_DLS_LIST_INIT;
     pthread_mutex_init(&semaphorePtr->waitingListMutex, NULL);  // Default attributes = Fast mutex.
     semaphorePtr->isTraceable = isTraceable;
-
-    // Initialize the underlying POSIX semaphore shared between thread.
-    int result = sem_init(&semaphorePtr->semaphore,0, initialCount);
-    if (result != 0)
+    semaphorePtr->waiterCount = 0;
+    if (le_utf8_Copy(semaphorePtr->nameStr, nameStr, sizeof(semaphorePtr->nameStr), NULL)
+        == LE_OVERFLOW)
     {
-        LE_FATAL("Failed to set the semaphore . errno = %d (%m).", errno);
+        LE_WARN("Semaphore name '%s' truncated to '%s'.", nameStr, semaphorePtr->nameStr);
     }
 
+    LE_FATAL_IF(initialCount < 0,
+                "Semaphore '%s' given negative initial count %d.",
+                semaphorePtr->nameStr,
+                initialCount);
+    semaphorePtr->value = initialCount;
+
     // Add the semaphore to the process's Semaphore List.
     LOCK_SEMAPHORE_LIST();
     le_dls_Queue(&SemaphoreList, &semaphorePtr->semaphoreListLink);
@@ -196,6 +208,109 @@ static void RemoveFromWaitingList
     UNLOCK_WAITING_LIST(semaphorePtr);
 }
 
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Try to decrement a semaphore's value without blocking.
+ *
+ * @return true if the value was decremented, false if it was zero.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline bool TryDecrement
+(
+    Semaphore_t*        semaphorePtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    // NOTE: This load must be sequentially consistent with the increment of the waiter count
+    //       in WaitContended(), so that a Post() racing with a waiter can't be missed by both.
+    int32_t value = __atomic_load_n(&semaphorePtr->value, __ATOMIC_SEQ_CST);
+
+    while (value > 0)
+    {
+        if (__atomic_compare_exchange_n(&semaphorePtr->value,
+                                        &value,
+                                        value - 1,
+                                        true,
+                                        __ATOMIC_ACQUIRE,
+                                        __ATOMIC_RELAXED))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Block until a semaphore can be decremented (the slow path of a wait).
+ *
+ * This is the only place where the calling thread is recorded as waiting on the semaphore.
+ *
+ * @return
+ *      - LE_OK         The semaphore was decremented.
+ *      - LE_TIMEOUT    The time-out expired first.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t WaitContended
+(
+    Semaphore_t*            semaphorePtr,
+    const le_clk_Time_t*    timeToWaitPtr   ///< [in] Time-out, or NULL to wait forever.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    le_result_t result = LE_OK;
+    le_clk_Time_t wakeUpTime = { 0, 0 };
+
+    if (timeToWaitPtr != NULL)
+    {
+        wakeUpTime = le_clk_Add(le_clk_GetRelativeTime(), *timeToWaitPtr);
+    }
+
+    // Save into waiting list
+    sem_ThreadRec_t* perThreadRecPtr = thread_GetSemaphoreRecPtr();
+    perThreadRecPtr->waitingOnSemaphore = semaphorePtr;
+    AddToWaitingList(semaphorePtr, perThreadRecPtr);
+
+    __atomic_add_fetch(&semaphorePtr->waiterCount, 1, __ATOMIC_SEQ_CST);
+
+    while (!TryDecrement(semaphorePtr))
+    {
+        struct timespec timeOut;
+        struct timespec* timeOutPtr = NULL;
+
+        if (timeToWaitPtr != NULL)
+        {
+            le_clk_Time_t currentTime = le_clk_GetRelativeTime();
+            if (!le_clk_GreaterThan(wakeUpTime, currentTime))
+            {
+                result = LE_TIMEOUT;
+                break;
+            }
+
+            le_clk_Time_t remainingTime = le_clk_Sub(wakeUpTime, currentTime);
+            timeOut.tv_sec = remainingTime.sec;
+            timeOut.tv_nsec = remainingTime.usec * 1000;
+            timeOutPtr = &timeOut;
+        }
+
+        // Sleep until posted to (or the value is no longer zero, or we time out).  Either way,
+        // loop back and re-check.
+        futex_Wait(&semaphorePtr->value, 0, timeOutPtr);
+    }
+
+    __atomic_sub_fetch(&semaphorePtr->waiterCount, 1, __ATOMIC_SEQ_CST);
+
+    // Remove from waiting list
+    RemoveFromWaitingList(semaphorePtr, perThreadRecPtr);
+    perThreadRecPtr->waitingOnSemaphore = NULL;
+
+    return result;
+}
+
+
 // ==============================
 //  INTRA-FRAMEWORK FUNCTIONS
 // ==============================
@@ -309,12 +424,6 @@ void le_sem_Delete
             LE_FATAL(   "Semaphore '%s' could not destroy internal mutex!",
                         semaphorePtr->nameStr);
         }
-            // Destroy the semaphore.
-        if (sem_destroy(&semaphorePtr->semaphore) != 0)
-        {
-            LE_FATAL(   "Semaphore '%s' is not a valid semaphore!",
-                        semaphorePtr->nameStr);
-        }
     } else {
         UNLOCK_WAITING_LIST(semaphorePtr);
         // TODO print more information
@@ -362,22 +471,11 @@ void le_sem_Wait
 //     }
 //     else
     {
-        int result;
-
-        sem_ThreadRec_t* perThreadRecPtr = thread_GetSemaphoreRecPtr();
-
-        perThreadRecPtr->waitingOnSemaphore = semaphorePtr;
-        AddToWaitingList(semaphorePtr, perThreadRecPtr);
-
-        result = sem_wait(&semaphorePtr->semaphore);
-
-        RemoveFromWaitingList(semaphorePtr, perThreadRecPtr);
-        perThreadRecPtr->waitingOnSemaphore = NULL;
-
-        LE_FATAL_IF( (result!=0), "Thread '%s' failed to wait on semaphore '%s'. Error code %d (%m).",
-                    le_thread_GetMyName(),
-                    semaphorePtr->nameStr,
-                    result);
+        // Fast path: a single compare-and-swap if the value is positive.
+        if (!TryDecrement(semaphorePtr))
+        {
+            WaitContended(semaphorePtr, NULL);
+        }
     }
 }
 
@@ -404,20 +502,9 @@ le_result_t le_sem_TryWait
 //     }
 //     else
     {
-        int result;
-
-        result = sem_trywait(&semaphorePtr->semaphore);
-
-        if (result != 0)
+        if (!TryDecrement(semaphorePtr))
         {
-            if ( errno == EAGAIN ) {
-                return LE_WOULD_BLOCK;
-            } else {
-                LE_FATAL("Thread '%s' failed to trywait on semaphore '%s'. Error code %d (%m).",
-                        le_thread_GetMyName(),
-                        semaphorePtr->nameStr,
-                        result);
-            }
+            return LE_WOULD_BLOCK;
         }
     }
 
@@ -447,37 +534,9 @@ le_result_t le_sem_WaitWithTimeOut
 //     }
 //     else
     {
-        struct timespec timeOut;
-        int result;
-
-        // Prepare the timer
-        le_clk_Time_t currentUtcTime = le_clk_GetAbsoluteTime();
-        le_clk_Time_t wakeUpTime = le_clk_Add(currentUtcTime,timeToWait);
-        timeOut.tv_sec = wakeUpTime.sec;
-        timeOut.tv_nsec = wakeUpTime.usec;
-
-        // Retrieve reference thread
-        sem_ThreadRec_t* perThreadRecPtr = thread_GetSemaphoreRecPtr();
-        // Save into waiting list
-        perThreadRecPtr->waitingOnSemaphore = semaphorePtr;
-        AddToWaitingList(semaphorePtr, perThreadRecPtr);
-
-        result = sem_timedwait(&semaphorePtr->semaphore,&timeOut);
-
-        // Remove from waiting list
-        RemoveFromWaitingList(semaphorePtr, perThreadRecPtr);
-        perThreadRecPtr->waitingOnSemaphore = NULL;
-
-        if (result != 0)
+        if (!TryDecrement(semaphorePtr))
         {
-            if ( errno == ETIMEDOUT ) {
-                return LE_TIMEOUT;
-            } else {
-                LE_FATAL("Thread '%s' failed to wait on semaphore '%s'. Error code %d (%m).",
-                        le_thread_GetMyName(),
-                        semaphorePtr->nameStr,
-                        result);
-            }
+            return WaitContended(semaphorePtr, &timeToWait);
         }
     }
 
@@ -502,13 +561,15 @@ void le_sem_Post
     //     }
     //     else
     {
-        int result;
+        int32_t newValue = __atomic_add_fetch(&semaphorePtr->value, 1, __ATOMIC_SEQ_CST);
 
-        result = sem_post (&semaphorePtr->semaphore);
+        LE_FATAL_IF(newValue <= 0, "Semaphore '%s' overflowed.", semaphorePtr->nameStr);
 
-        LE_FATAL_IF((result!=0),"Failed to post on semaphore '%s'. Errno = %d (%m).",
-                    semaphorePtr->nameStr,
-                    result);
+        // Only enter the kernel if someone might be blocked waiting.
+        if (__atomic_load_n(&semaphorePtr->waiterCount, __ATOMIC_SEQ_CST) > 0)
+        {
+            futex_Wake(&semaphorePtr->value, 1);
+        }
     }
 }
 
@@ -524,12 +585,5 @@ int le_sem_GetValue
     le_sem_Ref_t    semaphorePtr   ///< [IN] Pointer to the semaphore
 )
 {
-    int value;
-
-    if ( sem_getvalue(&(semaphorePtr->semaphore),&value) != 0)
-    {
-        LE_FATAL("Cannot get %s semaphore value",semaphorePtr->nameStr);
-    }
-
-    return value;
+    return __atomic_load_n(&semaphorePtr->value, __ATOMIC_RELAXED);
 }
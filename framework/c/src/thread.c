@@ -531,6 +531,79 @@ timer_ThreadRec_t* thread_GetTimerRecPtr
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets a bit mask of the CPUs that are currently online (bit N is CPU N).  CPUs numbered 64 and
+ * above are not represented.
+ */
+//--------------------------------------------------------------------------------------------------
+uint64_t thread_GetOnlineCpuMask
+(
+    void
+)
+{
+    uint64_t mask = 0;
+    char buffer[256];
+
+    // The online CPUs can be sparse (e.g., after hot-unplugging), so their count is not enough.
+    // The kernel lists them as comma-separated numbers and ranges, e.g., "0,2-3".
+    FILE* filePtr = fopen("/sys/devices/system/cpu/online", "r");
+
+    if (filePtr != NULL)
+    {
+        if (fgets(buffer, sizeof(buffer), filePtr) != NULL)
+        {
+            char* cursorPtr = buffer;
+
+            while (isdigit((unsigned char)*cursorPtr))
+            {
+                unsigned long first = strtoul(cursorPtr, &cursorPtr, 10);
+                unsigned long last = first;
+                unsigned long cpu;
+
+                if (*cursorPtr == '-')
+                {
+                    last = strtoul(cursorPtr + 1, &cursorPtr, 10);
+                }
+
+                for (cpu = first; (cpu <= last) && (cpu < 64); cpu++)
+                {
+                    mask |= (1ULL << cpu);
+                }
+
+                if (*cursorPtr == ',')
+                {
+                    cursorPtr++;
+                }
+            }
+        }
+
+        fclose(filePtr);
+    }
+
+    if (mask == 0)
+    {
+        // sysfs is not available, assume that all the configured CPUs are online.
+        long numCpus = sysconf(_SC_NPROCESSORS_CONF);
+
+        if (numCpus >= 64)
+        {
+            mask = UINT64_MAX;
+        }
+        else if (numCpus <= 0)
+        {
+            mask = 1;
+        }
+        else
+        {
+            mask = (1ULL << numCpus) - 1;
+        }
+    }
+
+    return mask;
+}
+
+
 // ===================================
 //  PUBLIC API FUNCTIONS
 // ===================================
@@ -675,6 +748,83 @@ le_result_t le_thread_SetStackSize
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Restricts a thread to running on a given set of CPUs (cores).
+ *
+ * Bit N of the mask selects CPU N.  CPUs that are not online are ignored, but at least one CPU in
+ * the mask must be online.
+ *
+ * @return
+ *      - LE_OK if successful.
+ *      - LE_OUT_OF_RANGE if none of the CPUs in the mask are online.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t le_thread_SetCpuAffinity
+(
+    le_thread_Ref_t     thread,     ///< [in]
+    uint64_t            cpuMask     ///< [in] Bit mask of CPUs the thread may run on.
+)
+{
+    Lock();
+
+    ThreadObj_t* threadPtr = le_ref_Lookup(ThreadRefMap, thread);
+
+    Unlock();
+
+    LE_ASSERT(threadPtr != NULL);
+
+    // Build the CPU set from the mask, skipping any CPUs that aren't currently online.
+    uint64_t onlineMask = cpuMask & thread_GetOnlineCpuMask();
+    cpu_set_t cpuSet;
+    int cpu;
+
+    CPU_ZERO(&cpuSet);
+
+    for (cpu = 0; cpu < 64; cpu++)
+    {
+        if (onlineMask & (1ULL << cpu))
+        {
+            CPU_SET(cpu, &cpuSet);
+        }
+    }
+
+    if (CPU_COUNT(&cpuSet) == 0)
+    {
+        return LE_OUT_OF_RANGE;
+    }
+
+    // If the thread is already running, change its affinity directly.  Otherwise, store it in the
+    // attributes that will be used to start it.
+    int result;
+
+    if (threadPtr->isStarted)
+    {
+        result = pthread_setaffinity_np(threadPtr->threadHandle, sizeof(cpuSet), &cpuSet);
+    }
+    else
+    {
+        result = pthread_attr_setaffinity_np(&(threadPtr->attr), sizeof(cpuSet), &cpuSet);
+    }
+
+    if (result == EINVAL)
+    {
+        // The online CPUs in the mask went offline since the online mask was read.
+        return LE_OUT_OF_RANGE;
+    }
+    else if (result != 0)
+    {
+        LE_CRIT("Failed to set CPU affinity (mask 0x%" PRIx64 ") for thread '%s' (error %d).",
+                cpuMask,
+                threadPtr->name,
+                result);
+        return LE_OUT_OF_RANGE;
+    }
+
+    return LE_OK;
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Makes a thread "joinable", meaning that when it finishes, it will remain in existence until
@@ -97,4 +97,15 @@ timer_ThreadRec_t* thread_GetTimerRecPtr
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets a bit mask of the CPUs that are currently online (bit N is CPU N).
+ */
+//--------------------------------------------------------------------------------------------------
+uint64_t thread_GetOnlineCpuMask
+(
+    void
+);
+
+
 #endif  // THREAD_INCLUDE_GUARD
@@ -0,0 +1,597 @@
+/** @file threadPool.c
+ *
+ * Thread Pool implementation.  See le_threadPool.h for the user-visible behaviour.
+ *
+ * Every worker thread has its own queue of Job objects, protected by its own mutex, so that
+ * workers hardly ever contend with each other.  A worker pushes and pops work at the head of its
+ * own queue (newest first), while other workers steal from the tail (oldest first).
+ *
+ * A single counting semaphore per pool holds the number of jobs that have been queued but not yet
+ * claimed.  Every push onto any worker's queue is followed by one post, and every worker waits on
+ * the semaphore once before claiming each job.  So, a worker that gets past the semaphore knows
+ * that there is at least one unclaimed job somewhere in the pool, even if it has to look through
+ * the other workers' queues (possibly more than once, if others steal from under it) to find it.
+ *
+ * Deleting a pool sets a "stopping" flag and then posts the semaphore once per worker.  A worker
+ * that gets past the semaphore, finds no job, and sees the stopping flag exits.
+ *
+ * Copyright (C) Sierra Wireless, Inc. 2014.  Use of this work is subject to license.
+ */
+
+#include "legato.h"
+#include "threadPool.h"
+#include "thread.h"
+
+#include <sched.h>
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum pool name size in bytes.  Worker thread names are the pool name followed by a
+ * dash and the worker number, so this is kept a bit shorter than the maximum thread name.
+ */
+//--------------------------------------------------------------------------------------------------
+#define MAX_POOL_NAME_BYTES     16
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum number of worker threads in a pool.
+ */
+//--------------------------------------------------------------------------------------------------
+#define MAX_WORKERS             32
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of Job objects to pre-allocate.
+ */
+//--------------------------------------------------------------------------------------------------
+#define DEFAULT_JOB_POOL_SIZE   32
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A piece of work submitted to a Thread Pool.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    le_dls_Link_t           link;           ///< Link in a worker's job queue.
+    le_threadPool_Func_t    workFunc;       ///< Function to run in the worker thread.
+    le_threadPool_Func_t    completionFunc; ///< Function to queue back to the submitter (or NULL).
+    void*                   param1Ptr;      ///< First parameter to pass to the functions.
+    void*                   param2Ptr;      ///< Second parameter to pass to the functions.
+    le_thread_Ref_t         submitterRef;   ///< Thread to run the completion function in.
+}
+Job_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A worker thread in a Thread Pool.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    struct le_threadPool*   poolPtr;        ///< The pool that the worker belongs to.
+    size_t                  index;          ///< Index of this worker in the pool's worker array.
+    le_thread_Ref_t         threadRef;      ///< The worker's thread.
+    pthread_mutex_t         queueMutex;     ///< Protects the job queue.
+    le_dls_List_t           queue;          ///< Job queue.  Owner uses the head, thieves the tail.
+}
+Worker_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Thread Pool object.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct le_threadPool
+{
+    char                    name[MAX_POOL_NAME_BYTES];  ///< Name of the pool.
+    size_t                  numWorkers;     ///< Number of entries in use in the workers array.
+    Worker_t                workers[MAX_WORKERS];       ///< The worker threads.
+    le_sem_Ref_t            jobSem;         ///< Count of queued jobs that haven't been claimed.
+    size_t                  nextWorker;     ///< Worker to give the next outside job to.
+    bool                    isStarted;      ///< true = le_threadPool_Start() has been called.
+    bool                    isStopping;     ///< true = le_threadPool_Delete() has been called.
+    le_thread_Priority_t    priority;       ///< Priority of the worker threads.
+    size_t                  stackSize;      ///< Stack size of the worker threads (0 = default).
+    uint64_t                cpuMask;        ///< CPU affinity of the worker threads (0 = any).
+}
+Pool_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Pool from which Thread Pool objects are allocated.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_mem_PoolRef_t PoolPool;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Pool from which Job objects are allocated.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_mem_PoolRef_t JobPool;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Key under which a worker thread keeps a pointer to its Worker_t in thread-local storage.
+ * NULL in threads that are not Thread Pool workers.
+ */
+//--------------------------------------------------------------------------------------------------
+static pthread_key_t WorkerKey;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Push a job onto the head of a worker's queue and announce it to the pool.
+ */
+//--------------------------------------------------------------------------------------------------
+static void PushJob
+(
+    Worker_t*   workerPtr,
+    Job_t*      jobPtr
+)
+{
+    LE_ASSERT(pthread_mutex_lock(&workerPtr->queueMutex) == 0);
+    le_dls_Stack(&workerPtr->queue, &jobPtr->link);
+    LE_ASSERT(pthread_mutex_unlock(&workerPtr->queueMutex) == 0);
+
+    le_sem_Post(workerPtr->poolPtr->jobSem);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Take a job from a worker's queue.
+ *
+ * @return Pointer to the job, or NULL if the queue is empty.
+ */
+//--------------------------------------------------------------------------------------------------
+static Job_t* TakeJob
+(
+    Worker_t*   workerPtr,
+    bool        isOwner     ///< true = take the newest job (head), false = steal the oldest (tail).
+)
+{
+    le_dls_Link_t* linkPtr;
+
+    LE_ASSERT(pthread_mutex_lock(&workerPtr->queueMutex) == 0);
+    linkPtr = isOwner ? le_dls_Pop(&workerPtr->queue) : le_dls_PopTail(&workerPtr->queue);
+    LE_ASSERT(pthread_mutex_unlock(&workerPtr->queueMutex) == 0);
+
+    if (linkPtr == NULL)
+    {
+        return NULL;
+    }
+
+    return CONTAINER_OF(linkPtr, Job_t, link);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Find a job for a worker, looking first in its own queue and then stealing from the others,
+ * starting with its neighbour.
+ *
+ * @return Pointer to the job, or NULL if all queues were empty.
+ */
+//--------------------------------------------------------------------------------------------------
+static Job_t* FindJob
+(
+    Worker_t*   workerPtr
+)
+{
+    Pool_t* poolPtr = workerPtr->poolPtr;
+
+    Job_t* jobPtr = TakeJob(workerPtr, true);
+
+    size_t i;
+    for (i = 1; (jobPtr == NULL) && (i < poolPtr->numWorkers); i++)
+    {
+        jobPtr = TakeJob(&poolPtr->workers[(workerPtr->index + i) % poolPtr->numWorkers], false);
+    }
+
+    return jobPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Run a job and hand its completion function back to the thread that submitted it.
+ */
+//--------------------------------------------------------------------------------------------------
+static void RunJob
+(
+    Job_t*  jobPtr
+)
+{
+    jobPtr->workFunc(jobPtr->param1Ptr, jobPtr->param2Ptr);
+
+    if (jobPtr->completionFunc != NULL)
+    {
+        le_event_QueueFunctionToThread(jobPtr->submitterRef,
+                                       jobPtr->completionFunc,
+                                       jobPtr->param1Ptr,
+                                       jobPtr->param2Ptr);
+    }
+
+    le_mem_Release(jobPtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Main function of a worker thread.
+ */
+//--------------------------------------------------------------------------------------------------
+static void* WorkerMain
+(
+    void* contextPtr    ///< Pointer to the Worker_t.
+)
+{
+    Worker_t* workerPtr = contextPtr;
+    Pool_t* poolPtr = workerPtr->poolPtr;
+
+    LE_ASSERT(pthread_setspecific(WorkerKey, workerPtr) == 0);
+
+    for (;;)
+    {
+        le_sem_Wait(poolPtr->jobSem);
+
+        // There is at least one unclaimed job somewhere in the pool, unless this wake-up was one
+        // of the ones posted by le_threadPool_Delete().  Another worker may steal the job we were
+        // woken for while we are looking for it, but then the job that worker was woken for must
+        // still be out there, so keep looking.
+        Job_t* jobPtr;
+        while ((jobPtr = FindJob(workerPtr)) == NULL)
+        {
+            if (__atomic_load_n(&poolPtr->isStopping, __ATOMIC_ACQUIRE))
+            {
+                return NULL;
+            }
+
+            sched_yield();
+        }
+
+        RunJob(jobPtr);
+    }
+}
+
+
+// ==============================
+//  INTRA-FRAMEWORK FUNCTIONS
+// ==============================
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initializes the Thread Pool module.  This function must be called at start-up, after the
+ * memory pool and thread modules are initialized.
+ */
+//--------------------------------------------------------------------------------------------------
+void threadPool_Init
+(
+    void
+)
+{
+    PoolPool = le_mem_CreatePool("threadPool", sizeof(Pool_t));
+
+    JobPool = le_mem_CreatePool("threadPoolJob", sizeof(Job_t));
+    le_mem_ExpandPool(JobPool, DEFAULT_JOB_POOL_SIZE);
+
+    LE_ASSERT(pthread_key_create(&WorkerKey, NULL) == 0);
+}
+
+
+// ==============================
+//  PUBLIC API FUNCTIONS
+// ==============================
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Creates a Thread Pool.  The worker threads won't start until le_threadPool_Start() is called.
+ *
+ * @return
+ *      A reference to the Thread Pool (doesn't return if failed).
+ */
+//--------------------------------------------------------------------------------------------------
+le_threadPool_Ref_t le_threadPool_Create
+(
+    const char* name,           ///< [in] Name of the pool.  Worker threads are named after it.
+    size_t      numWorkers      ///< [in] Number of worker threads, or 0 for one per online CPU.
+)
+{
+    if (numWorkers == 0)
+    {
+        long numCpus = sysconf(_SC_NPROCESSORS_ONLN);
+
+        numWorkers = (numCpus > 0) ? (size_t)numCpus : 1;
+    }
+
+    if (numWorkers > MAX_WORKERS)
+    {
+        LE_WARN("Thread pool '%s' limited to %d workers (%zu requested).",
+                name,
+                MAX_WORKERS,
+                numWorkers);
+
+        numWorkers = MAX_WORKERS;
+    }
+
+    Pool_t* poolPtr = le_mem_ForceAlloc(PoolPool);
+    memset(poolPtr, 0, sizeof(*poolPtr));
+
+    if (le_utf8_Copy(poolPtr->name, name, sizeof(poolPtr->name), NULL) == LE_OVERFLOW)
+    {
+        LE_WARN("Thread pool name '%s' truncated to '%s'.", name, poolPtr->name);
+    }
+
+    poolPtr->numWorkers = numWorkers;
+    poolPtr->jobSem = le_sem_Create(poolPtr->name, 0);
+    poolPtr->priority = LE_THREAD_PRIORITY_NORMAL;
+
+    size_t i;
+    for (i = 0; i < numWorkers; i++)
+    {
+        Worker_t* workerPtr = &poolPtr->workers[i];
+
+        workerPtr->poolPtr = poolPtr;
+        workerPtr->index = i;
+        workerPtr->queue = LE_DLS_LIST_INIT;
+        LE_ASSERT(pthread_mutex_init(&workerPtr->queueMutex, NULL) == 0);
+    }
+
+    return poolPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sets the priority of the worker threads of a Thread Pool.  Must be called before
+ * le_threadPool_Start().
+ *
+ * @return
+ *      - LE_OK if successful.
+ *      - LE_OUT_OF_RANGE if the priority level requested is out of range.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t le_threadPool_SetPriority
+(
+    le_threadPool_Ref_t     pool,       ///< [in]
+    le_thread_Priority_t    priority    ///< [in]
+)
+{
+    LE_FATAL_IF(pool->isStarted, "Thread pool '%s' already started.", pool->name);
+
+    if (priority > LE_THREAD_PRIORITY_RT_HIGHEST)
+    {
+        return LE_OUT_OF_RANGE;
+    }
+
+    pool->priority = priority;
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sets the stack size of the worker threads of a Thread Pool.  Must be called before
+ * le_threadPool_Start().
+ *
+ * @return
+ *      - LE_OK if successful.
+ *      - LE_OVERFLOW if the stack size requested is too small.
+ *      - LE_OUT_OF_RANGE if the stack size requested is too large.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t le_threadPool_SetStackSize
+(
+    le_threadPool_Ref_t     pool,       ///< [in]
+    size_t                  size        ///< [in] Stack size, in bytes.
+)
+{
+    LE_FATAL_IF(pool->isStarted, "Thread pool '%s' already started.", pool->name);
+
+    if (size < PTHREAD_STACK_MIN)
+    {
+        return LE_OVERFLOW;
+    }
+
+    // Check the size the same way pthread_create() will, so errors are reported here instead
+    // of when the pool is started.
+    pthread_attr_t attr;
+    LE_ASSERT(pthread_attr_init(&attr) == 0);
+    int result = pthread_attr_setstacksize(&attr, size);
+    pthread_attr_destroy(&attr);
+
+    if (result != 0)
+    {
+        return LE_OUT_OF_RANGE;
+    }
+
+    pool->stackSize = size;
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Restricts the worker threads of a Thread Pool to a given set of CPUs.  Must be called before
+ * le_threadPool_Start().  See le_thread_SetCpuAffinity().
+ *
+ * @return
+ *      - LE_OK if successful.
+ *      - LE_OUT_OF_RANGE if none of the CPUs in the mask are online.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t le_threadPool_SetCpuAffinity
+(
+    le_threadPool_Ref_t     pool,       ///< [in]
+    uint64_t                cpuMask     ///< [in] Bit mask of CPUs the workers may run on.
+)
+{
+    LE_FATAL_IF(pool->isStarted, "Thread pool '%s' already started.", pool->name);
+
+    if ((cpuMask & thread_GetOnlineCpuMask()) == 0)
+    {
+        return LE_OUT_OF_RANGE;
+    }
+
+    pool->cpuMask = cpuMask;
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Starts the worker threads of a Thread Pool.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_threadPool_Start
+(
+    le_threadPool_Ref_t     pool        ///< [in]
+)
+{
+    LE_FATAL_IF(pool->isStarted, "Thread pool '%s' already started.", pool->name);
+
+    pool->isStarted = true;
+
+    size_t i;
+    for (i = 0; i < pool->numWorkers; i++)
+    {
+        Worker_t* workerPtr = &pool->workers[i];
+        char threadName[MAX_POOL_NAME_BYTES + 12];
+
+        snprintf(threadName, sizeof(threadName), "%s-%u", pool->name, (unsigned int)i);
+
+        workerPtr->threadRef = le_thread_Create(threadName, WorkerMain, workerPtr);
+
+        le_thread_SetJoinable(workerPtr->threadRef);
+
+        if (pool->priority != LE_THREAD_PRIORITY_NORMAL)
+        {
+            LE_ASSERT(le_thread_SetPriority(workerPtr->threadRef, pool->priority) == LE_OK);
+        }
+
+        if (pool->stackSize != 0)
+        {
+            LE_ASSERT(le_thread_SetStackSize(workerPtr->threadRef, pool->stackSize) == LE_OK);
+        }
+
+        if (pool->cpuMask != 0)
+        {
+            LE_ASSERT(le_thread_SetCpuAffinity(workerPtr->threadRef, pool->cpuMask) == LE_OK);
+        }
+
+        le_thread_Start(workerPtr->threadRef);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Submits work to a Thread Pool.
+ *
+ * The work function will be called in one of the pool's worker threads.  When it returns, the
+ * completion function (if not NULL) will be queued to the calling thread's Event Loop.
+ *
+ * Work can be submitted before the pool is started; it will be run once the workers start.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_threadPool_Submit
+(
+    le_threadPool_Ref_t     pool,           ///< [in]
+    le_threadPool_Func_t    workFunc,       ///< [in] Function to run in a worker thread.
+    le_threadPool_Func_t    completionFunc, ///< [in] Function to run in the calling thread
+                                            ///       afterwards (or NULL).
+    void*                   param1Ptr,      ///< [in] Value to pass to both functions.
+    void*                   param2Ptr       ///< [in] Value to pass to both functions.
+)
+{
+    LE_ASSERT(workFunc != NULL);
+
+    Job_t* jobPtr = le_mem_ForceAlloc(JobPool);
+
+    jobPtr->link = LE_DLS_LINK_INIT;
+    jobPtr->workFunc = workFunc;
+    jobPtr->completionFunc = completionFunc;
+    jobPtr->param1Ptr = param1Ptr;
+    jobPtr->param2Ptr = param2Ptr;
+    jobPtr->submitterRef = (completionFunc != NULL) ? le_thread_GetCurrent() : NULL;
+
+    // Work submitted by one of the pool's own workers stays with that worker.  Anything else is
+    // handed out to the workers in turn.
+    Worker_t* workerPtr = pthread_getspecific(WorkerKey);
+
+    if ((workerPtr == NULL) || (workerPtr->poolPtr != pool))
+    {
+        size_t next = __atomic_fetch_add(&pool->nextWorker, 1, __ATOMIC_RELAXED);
+
+        workerPtr = &pool->workers[next % pool->numWorkers];
+    }
+
+    PushJob(workerPtr, jobPtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Deletes a Thread Pool.  Blocks until all work that was submitted to the pool has been run and
+ * all the worker threads have exited.
+ *
+ * @warning Must not be called from one of the pool's own worker threads.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_threadPool_Delete
+(
+    le_threadPool_Ref_t     pool        ///< [in]
+)
+{
+    Worker_t* currentWorkerPtr = pthread_getspecific(WorkerKey);
+
+    LE_FATAL_IF((currentWorkerPtr != NULL) && (currentWorkerPtr->poolPtr == pool),
+                "Thread pool '%s' deleted by one of its own workers.",
+                pool->name);
+
+    // Work that has already been submitted must still get run.
+    if (!pool->isStarted)
+    {
+        le_threadPool_Start(pool);
+    }
+
+    __atomic_store_n(&pool->isStopping, true, __ATOMIC_RELEASE);
+
+    size_t i;
+    for (i = 0; i < pool->numWorkers; i++)
+    {
+        le_sem_Post(pool->jobSem);
+    }
+
+    for (i = 0; i < pool->numWorkers; i++)
+    {
+        LE_ASSERT(le_thread_Join(pool->workers[i].threadRef, NULL) == LE_OK);
+    }
+
+    // Only tear down the queues once no worker can be trying to steal from them anymore.
+    for (i = 0; i < pool->numWorkers; i++)
+    {
+        Worker_t* workerPtr = &pool->workers[i];
+
+        LE_ASSERT(le_dls_IsEmpty(&workerPtr->queue));
+        LE_ASSERT(pthread_mutex_destroy(&workerPtr->queueMutex) == 0);
+    }
+
+    le_sem_Delete(pool->jobSem);
+
+    le_mem_Release(pool);
+}
@@ -0,0 +1,25 @@
+/** @file threadPool.h
+ *
+ * Thread Pool module's intra-framework header file.  This file exposes type definitions and
+ * function interfaces to other modules inside the framework implementation.
+ *
+ * Copyright (C) Sierra Wireless, Inc. 2014.  Use of this work is subject to license.
+ */
+
+#ifndef LEGATO_SRC_THREAD_POOL_H_INCLUDE_GUARD
+#define LEGATO_SRC_THREAD_POOL_H_INCLUDE_GUARD
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initializes the Thread Pool module.  This function must be called at start-up, after the
+ * memory pool and thread modules are initialized.
+ */
+//--------------------------------------------------------------------------------------------------
+void threadPool_Init
+(
+    void
+);
+
+
+#endif  // LEGATO_SRC_THREAD_POOL_H_INCLUDE_GUARD
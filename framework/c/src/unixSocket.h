@@ -329,7 +329,7 @@ le_result_t unixSocket_CreateDatagramPair
  * - LE_FAULT if failed for some other reason (check your logs).
  */
 //--------------------------------------------------------------------------------------------------
-int unixSocket_CreateSeqPacketNamed
+LE_SHARED int unixSocket_CreateSeqPacketNamed
 (
     const char* pathStr ///< [IN] File system path to bind to the socket.
 );
@@ -414,7 +414,7 @@ le_result_t unixSocket_Connect
  *          jails.
  */
 //--------------------------------------------------------------------------------------------------
-le_result_t unixSocket_SendMsg
+LE_SHARED le_result_t unixSocket_SendMsg
 (
     int localSocketFd,          ///< [IN] fd of the local socket that will be used to send.
     void* dataPtr,              ///< [IN] Pointer to the data payload to be sent (NULL if none).
@@ -439,7 +439,7 @@ le_result_t unixSocket_SendMsg
  *                  space to send right now. Wait for the "writeable" event on the file descriptor.
  */
 //--------------------------------------------------------------------------------------------------
-le_result_t unixSocket_SendDataMsg
+LE_SHARED le_result_t unixSocket_SendDataMsg
 (
     int localSocketFd,          ///< [IN] fd of the local socket that will be used to send.
     void* dataPtr,              ///< [IN] Pointer to the data payload to be sent (NULL if none).
@@ -508,7 +508,7 @@ le_result_t unixSocket_ReceiveMsg
  *          the receive buffer will have been lost.
  */
 //--------------------------------------------------------------------------------------------------
-le_result_t unixSocket_ReceiveDataMsg
+LE_SHARED le_result_t unixSocket_ReceiveDataMsg
 (
     int localSocketFd,      ///< [IN] fd of local socket that will be used to receive the message.
     void* dataBuffPtr,      ///< [OUT] Pointer to where any received data payload will be put.
@@ -18,7 +18,7 @@
  * Initialize the user system.  This should be called before any other functions in this API.
  */
 //--------------------------------------------------------------------------------------------------
-void user_Init
+LE_SHARED void user_Init
 (
     void
 );
@@ -34,7 +34,7 @@ void user_Init
  * interrupted by a power outage this function will restore the back up files.
  */
 //--------------------------------------------------------------------------------------------------
-void user_RestoreBackup
+LE_SHARED void user_RestoreBackup
 (
     void
 );
@@ -54,7 +54,7 @@ void user_RestoreBackup
  *      LE_FAULT if there was an error.
  */
 //--------------------------------------------------------------------------------------------------
-le_result_t user_Create
+LE_SHARED le_result_t user_Create
 (
     const char* usernamePtr,    ///< [IN] Pointer to the name of the user and group to create.
     uid_t* uidPtr,              ///< [OUT] Pinter to a location to store the uid for the created
@@ -75,7 +75,7 @@ le_result_t user_Create
  *      LE_FAULT if there was an error.
  */
 //--------------------------------------------------------------------------------------------------
-le_result_t user_CreateGroup
+LE_SHARED le_result_t user_CreateGroup
 (
     const char* groupNamePtr,    ///< [IN] Pointer to the name of the group to create.
     gid_t* gidPtr                ///< [OUT] Pointer to store the gid.
@@ -92,7 +92,7 @@ le_result_t user_CreateGroup
  *      LE_FAULT if there was an error.
  */
 //--------------------------------------------------------------------------------------------------
-le_result_t user_Delete
+LE_SHARED le_result_t user_Delete
 (
     const char* usernamePtr     ///< [IN] Pointer to the name of the user to delete.
 );
@@ -108,7 +108,7 @@ le_result_t user_Delete
  *      LE_FAULT if there was an error.
  */
 //--------------------------------------------------------------------------------------------------
-le_result_t user_DeleteGroup
+LE_SHARED le_result_t user_DeleteGroup
 (
     const char* groupNamePtr     ///< [IN] Pointer to the name of the group to delete.
 );
@@ -125,7 +125,7 @@ le_result_t user_DeleteGroup
  *      LE_FAULT if there was an error.
  */
 //--------------------------------------------------------------------------------------------------
-le_result_t user_GetIDs
+LE_SHARED le_result_t user_GetIDs
 (
     const char* usernamePtr,    ///< [IN] Pointer to the name of the user to get.
     uid_t* uidPtr,              ///< [OUT] Pinter to a location to store the uid for this user.
@@ -145,7 +145,7 @@ le_result_t user_GetIDs
  *      LE_FAULT if there was an error.
  */
 //--------------------------------------------------------------------------------------------------
-le_result_t user_GetUid
+LE_SHARED le_result_t user_GetUid
 (
     const char* usernamePtr,    ///< [IN] Pointer to the name of the user to get.
     uid_t* uidPtr               ///< [OUT] Pointer to store the uid.
@@ -162,7 +162,7 @@ le_result_t user_GetUid
  *      LE_FAULT if there was an error.
  */
 //--------------------------------------------------------------------------------------------------
-le_result_t user_GetGid
+LE_SHARED le_result_t user_GetGid
 (
     const char* groupNamePtr,   ///< [IN] Pointer to the name of the group.
     gid_t* gidPtr                ///< [OUT] Pointer to store the gid.
@@ -180,7 +180,7 @@ le_result_t user_GetGid
  *      LE_FAULT if there was an error getting the user name.
  */
 //--------------------------------------------------------------------------------------------------
-le_result_t user_GetName
+LE_SHARED le_result_t user_GetName
 (
     uid_t uid,                  ///< [IN] The uid of the user to get the name for.
     char* nameBufPtr,           ///< [OUT] The buffer to store the user name in.
@@ -199,7 +199,7 @@ le_result_t user_GetName
  *      LE_FAULT if there was an error getting the group name.
  */
 //--------------------------------------------------------------------------------------------------
-le_result_t user_GetGroupName
+LE_SHARED le_result_t user_GetGroupName
 (
     gid_t gid,                  ///< [IN] The gid of the group to get the name for.
     char* nameBufPtr,           ///< [OUT] The buffer to store the group name in.
@@ -217,7 +217,7 @@ le_result_t user_GetGroupName
  *      LE_NOT_FOUND if the user does not have an application or may have multiple applications.
  */
 //--------------------------------------------------------------------------------------------------
-le_result_t user_GetAppName
+LE_SHARED le_result_t user_GetAppName
 (
     uid_t uid,                  ///< [IN] The uid of the user.
     char* nameBufPtr,           ///< [OUT] The buffer to store the app name in.
@@ -234,7 +234,7 @@ le_result_t user_GetAppName
  *      LE_OVERFLOW if the provided buffer is too small and only part of the name was copied.
  */
 //--------------------------------------------------------------------------------------------------
-le_result_t user_AppNameToUserName
+LE_SHARED le_result_t user_AppNameToUserName
 (
     const char* appName,        ///< [IN] The application's name.
     char* nameBufPtr,           ///< [OUT] The buffer to store the user name in.
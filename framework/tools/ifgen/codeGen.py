@@ -90,73 +90,115 @@ Environment.filters["addNamePrefix"] = codeTypes.AddNamePrefix
 # Templates, canned code, etc
 #---------------------------------------------------------------------------------------------------
 
-DefaultPackerUnpacker = """
-//--------------------------------------------------------------------------------------------------
-// Generic Pack/Unpack Functions
-//--------------------------------------------------------------------------------------------------
 
-// todo: These functions could be moved to a separate library, to reduce overall code size and RAM
-//       usage because they are common to each client and server.  However, they would then likely
-//       need to be more generic, and provide better parameter checking and return results.  With
-//       the way they are now, they can be customized to the specific needs of the generated code,
-//       so for now, they will be kept with the generated code.  This may need revisiting later.
+#---------------------------------------------------------------------------------------------------
+# Message layouts
+#---------------------------------------------------------------------------------------------------
 
-// Unused attribute is needed because this function may not always get used
-__attribute__((unused)) static void* PackData(void* msgBufPtr, const void* dataPtr, size_t dataSize)
-{
-    // todo: should check for buffer overflow, but not sure what to do if it happens
-    //       i.e. is it a fatal error, or just return a result
+# Upper bounds on the sizes of C types that are not defined in the .api files.  Any type that is
+# not listed here, or defined in the .api files, is assumed to be no bigger than 16 bytes.
+TypeSizeBounds = dict( uint8_t=1, int8_t=1, bool=1, char=1,
+                       uint16_t=2, int16_t=2,
+                       uint32_t=4, int32_t=4,
+                       size_t=8, le_result_t=8, le_onoff_t=8 )
+TypeSizeBounds["void*"] = 8
 
-    memcpy( msgBufPtr, dataPtr, dataSize );
-    return ( msgBufPtr + dataSize );
-}
+def GetTypeSizeBound(cType):
+    if cType in TypeSizeBounds:
+        return TypeSizeBounds[cType]
 
-// Unused attribute is needed because this function may not always get used
-__attribute__((unused)) static void* UnpackData(void* msgBufPtr, void* dataPtr, size_t dataSize)
-{
-    memcpy( dataPtr, msgBufPtr, dataSize );
-    return ( msgBufPtr + dataSize );
-}
+    # Types defined in the .api files are references, enums or integers
+    if cType in codeTypes.DefinedInterfaceTypes.values():
+        return 8
 
-// Unused attribute is needed because this function may not always get used
-__attribute__((unused)) static void* PackString(void* msgBufPtr, const char* dataStr)
-{
-    // todo: should check for buffer overflow, but not sure what to do if it happens
-    //       i.e. is it a fatal error, or just return a result
+    return 16
 
-    // Add one for the null character
-    size_t dataSize = strlen(dataStr) + 1;
+def AlignSize(size):
+    return (size + 7) & ~7
 
-    memcpy( msgBufPtr, dataStr, dataSize );
-    return ( msgBufPtr + dataSize );
-}
+# Upper bound on the size of a string or array parameter, when it is in a message.
+def GetDataSizeBound(parm):
+    if isinstance(parm, codeTypes.StringData):
+        if parm.direction == codeTypes.DIR_IN:
+            count = parm.maxValue + 1
+        else:
+            count = parm.minSize
+    elif parm.direction == codeTypes.DIR_IN:
+        count = parm.maxSize * GetTypeSizeBound(parm.type)
+    else:
+        count = parm.minSize * GetTypeSizeBound(parm.type)
 
-// Unused attribute is needed because this function may not always get used
-__attribute__((unused)) static void* UnpackString(void* msgBufPtr, const char** dataStrPtr)
-{
-    // Add one for the null character
-    size_t dataSize = strlen(msgBufPtr) + 1;
+    # Each item has an 8 byte length header, and is padded to a multiple of 8 bytes
+    return 8 + AlignSize(count)
 
-    // Strings do not have to be word aligned, so just return a pointer
-    // into the message buffer
-    *dataStrPtr = msgBufPtr;
-    return ( msgBufPtr + dataSize );
-}
 
-// todo: This function may eventually replace all usage of UnpackString() above.
-//       Maybe there should also be a PackDataString() function as well?
-// Unused attribute is needed because this function may not always get used
-__attribute__((unused)) static void* UnpackDataString(void* msgBufPtr, void* dataPtr, size_t dataSize)
-{
-    // Number of bytes copied from msg buffer, not including null terminator
-    size_t numBytes;
+class MessageLayout(object):
+    """
+    Layout of one kind of message: the struct of fixed-size fields at the start of the message,
+    followed by any strings and arrays.
+
+    typeName is empty if the message has no fixed-size fields.  Any extra fields, such as the
+    result, are given as (type, name) pairs, and come before the parameters.
+    """
+    def __init__(self, typeName, parmList, extraFields=[]):
+        parmList = [ p for p in parmList if not isinstance(p, codeTypes.VoidData) ]
+        fieldParms = [ p for p in parmList if p.fieldDefinition ]
+        dataParms = [ p for p in parmList
+                      if isinstance(p, (codeTypes.ArrayData, codeTypes.StringData)) ]
+
+        self.fields = ( [ "%s %s;" % f for f in extraFields ] +
+                        [ p.fieldDefinition.format(parm=p) for p in fieldParms ] )
+        self.typeName = typeName if self.fields else ""
+        self.hasData = bool(dataParms)
+
+        fieldTypes = [ t for t, n in extraFields ] + [ p.type for p in fieldParms ]
+        self.fieldsSize = sum( 8 if GetTypeSizeBound(t) <= 8 else 16 for t in fieldTypes )
+        self.dataSize = sum( GetDataSizeBound(p) for p in dataParms )
+        self.size = self.fieldsSize + self.dataSize
+
+
+# Get the request, response and (for AddHandler functions) handler indication message layouts
+def GetMessageLayouts(func, handler=None):
+    resultFields = [ (func.type, "_result") ] if func.type != "void" else []
+    layouts = [ MessageLayout("_Req_%s_t" % func.name, func.parmListIn),
+                MessageLayout("_Rsp_%s_t" % func.name, func.parmListOut, resultFields) ]
+
+    if handler:
+        layouts.append( MessageLayout("_Ind_%s_t" % func.name,
+                                      handler.parmList,
+                                      [ ("void*", "_clientContextPtr") ]) )
+
+    return layouts
+
+# Get the layouts of all the messages for the functions
+def GetAllMessageLayouts(pf, ph):
+    layouts = []
+    for f in pf.values():
+        handler = ph.get(f.addHandlerName) if f.addHandlerName else None
+        layouts.extend( GetMessageLayouts(f, handler) )
 
-    // todo: For now, assume the string will always fit in the buffer. This may not always be true.
-    le_utf8_Copy( dataPtr, msgBufPtr, dataSize, &numBytes );
-    return ( msgBufPtr + (numBytes + 1) );
+    return layouts
+
+
+MessageLayoutTemplate = """
+//--------------------------------------------------------------------------------------------------
+// Message Layouts
+//--------------------------------------------------------------------------------------------------
+{% for layout in layouts if layout.typeName %}
+
+typedef struct
+{
+    {{ layout.fields | join("\n") | indent }}
 }
+{{layout.typeName}};
+_Static_assert( LE_IPC_ALIGN_SIZE(sizeof({{layout.typeName}})) + {{layout.dataSize}} <= _MAX_MSG_SIZE,
+                "{{layout.typeName}} does not fit in a message" );
+{% endfor %}
 """
 
+def WriteMessageLayouts(fp, pf, ph):
+    print >>fp, FormatCode(MessageLayoutTemplate, layouts=GetAllMessageLayouts(pf, ph))
+
 
 #---------------------------------------------------------------------------------------------------
 
@@ -359,6 +401,86 @@ def GetServerAsyncFuncPrototypeStr(func):
 
 
 
+#---------------------------------------------------------------------------------------------------
+
+
+PipelinedFuncPrototypeTemplate = dict(
+
+    start = """
+//--------------------------------------------------------------------------------------------------
+/**
+ * Pipelined client function: sends the request for {{func.name}}() without waiting for the
+ * response, which must be collected with {{func.name}}Finish()
+ */
+//--------------------------------------------------------------------------------------------------
+{{ "PendingRef_t" | addNamePrefix }} {{func.name}}Start
+(
+    {{ func | printStartParmList | indent }}
+)
+""",
+
+    finish = """
+//--------------------------------------------------------------------------------------------------
+/**
+ * Pipelined client function: waits for the response to {{func.name}}Start(), unless it has
+ * already arrived, and returns the result and OUT parameters of {{func.name}}()
+ */
+//--------------------------------------------------------------------------------------------------
+{{func.type}} {{func.name}}Finish
+(
+    {{ func | printFinishParmList | indent }}
+)
+"""
+)
+
+
+#
+# Pipelined variants are only generated for the functions that get a response, and whose OUT
+# parameters don't need a buffer size in the request.
+#
+def IsPipelined(func):
+    return ( not func.isOneWay
+             and not func.addHandlerName
+             and not func.isRemoveHandler
+             and all( isinstance(p, codeTypes.PointerData) and p.direction == codeTypes.DIR_OUT
+                      for p in func.parmListOut ) )
+
+
+#
+# Define and register the filters for processing the Start and Finish parameter lists
+#
+def PrintStartParmList(func):
+    resultList = [ p.clientParmList.format(parm=p) for p in func.parmList
+                       if p.direction == codeTypes.DIR_IN
+                          and not isinstance(p, codeTypes.VoidData) ]
+
+    return ',\n'.join( resultList ) if resultList else "void"
+
+Environment.filters["printStartParmList"] = PrintStartParmList
+
+
+def PrintFinishParmList(func):
+    # This parameter always exists
+    resultList = [ "%s %s" % (codeTypes.AddNamePrefix("PendingRef_t"), "_pendingRef") ]
+
+    # Add OUT parameters, if there are any
+    resultList += [ p.clientParmList.format(parm=p) for p in func.parmListOut ]
+
+    return ',\n'.join( resultList )
+
+Environment.filters["printFinishParmList"] = PrintFinishParmList
+
+
+#
+# Create the strings for the pipelined function prototypes/declarations, which are used in both the
+# header file and the client file.
+#
+def GetPipelinedFuncPrototypeStrs(func):
+    return [ FormatCode(PipelinedFuncPrototypeTemplate[n], func=func).strip()
+                 for n in ("start", "finish") ]
+
+
+
 #---------------------------------------------------------------------------------------------------
 # Type defintion related functions and code
 #---------------------------------------------------------------------------------------------------
@@ -439,63 +561,62 @@ def WriteEnumDefinition(fp, enumDef):
 # Client templates/code
 #---------------------------------------------------------------------------------------------------
 
-FuncImplTemplate = dict(
-
-    function = """
-{{prototype}}
-{
-    le_msg_MessageRef_t _msgRef;
-    le_msg_MessageRef_t _responseMsgRef;
-    _Message_t* _msgPtr;
-
-    // Will not be used if no data is sent/received from server.
-    __attribute__((unused)) uint8_t* _msgBufPtr;
-
-    {{func.resultStorage}}
-
+# The parts of the client functions that build and send the request, and that unpack the response
+# from the server.  These are shared by the regular, one-way and pipelined client functions.
+ClientRequestCode = """
     // Range check values, if appropriate
     $ for p in func.parmListIn
-    $ if p.maxValue:
+    $ if p.maxValue and p.maxValueCheck:
     {{ p.maxValueCheck.format( parm=p ) }}
     $ endif
     $ endfor
     {{""}}
 
     // Create a new message object and get the message buffer
-    _msgRef = le_msg_CreateMsg(GetCurrentSessionRef());
+    _msgRef = le_msg_CreateMsg(le_ipc_GetSessionRef(&_Client));
     _msgPtr = le_msg_GetPayloadPtr(_msgRef);
     _msgPtr->id = _MSGID_{{func.name}};
     _msgBufPtr = _msgPtr->buffer;
+    _msgBufEndPtr = _msgPtr->buffer + _MAX_MSG_SIZE;
+    {% if request.typeName %}
+
+    // The fixed-size fields are at the start of the message
+    {{request.typeName}}* _txFieldsPtr = ({{request.typeName}}*)_msgBufPtr;
+    _msgBufPtr += LE_IPC_ALIGN_SIZE(sizeof({{request.typeName}}));
+    {% endif %}
 
     // Pack the input parameters
     {{ func.parmListIn | printParmList("clientPack", sep="\n") | indent }}
+"""
 
-    // Send a request to the server and get the response.
-    LE_DEBUG("Sending message to server and waiting for response");
-    _responseMsgRef = le_msg_RequestSyncResponse(_msgRef);
-    // It is a serious error if we don't get a valid response from the server
-    LE_FATAL_IF(_responseMsgRef == NULL, "Valid response was not received from server");
-
+ClientResponseCode = """
     // Process the result and/or output parameters, if there are any.
     _msgPtr = le_msg_GetPayloadPtr(_responseMsgRef);
     _msgBufPtr = _msgPtr->buffer;
+    _msgBufEndPtr = _msgPtr->buffer + _MAX_MSG_SIZE;
+    {% if response.typeName %}
+
+    // The fixed-size fields are at the start of the message
+    {{response.typeName}}* _rxFieldsPtr = ({{response.typeName}}*)_msgBufPtr;
+    _msgBufPtr += LE_IPC_ALIGN_SIZE(sizeof({{response.typeName}}));
+    {% endif %}
 
     {% if func.type != "void" -%}
     // Unpack the result first
-    _msgBufPtr = UnpackData( _msgBufPtr, &_result, sizeof(_result) );
+    _result = _rxFieldsPtr->_result;
 
     $ if func.addHandlerName:
-    // Put the handler reference result into the client data object, and
-    // then return a safe reference to the client data object as the reference.
-    _clientDataPtr->handlerRef = (le_event_HandlerRef_t)_result;
-    _LOCK
-    _result = le_ref_CreateRef(_HandlerRefMap, _clientDataPtr);
-    _UNLOCK
+    // Put the handler reference result into the client handler object, and
+    // then return a safe reference to the client handler object as the reference.
+    _result = le_ipc_AddClientHandler(_clientHandlerPtr, (le_event_HandlerRef_t)_result);
     $ endif
     {% endif %}
 
     // Unpack any "out" parameters
     {{ func.parmListOut | printParmList("clientUnpack", sep="\n") | indent }}
+    {% if response.hasData -%}
+    LE_FATAL_IF(_msgBufPtr == NULL, "Invalid response received from server");
+    {% endif %}
 
     // Release the message object, now that all results/output has been copied.
     le_msg_ReleaseMsg(_responseMsgRef);
@@ -506,13 +627,108 @@ FuncImplTemplate = dict(
     $ endif
 }
 """
+
+FuncImplTemplate = dict(
+
+    function = """
+{{prototype}}
+{
+    le_msg_MessageRef_t _msgRef;
+    le_msg_MessageRef_t _responseMsgRef;
+    _Message_t* _msgPtr;
+
+    // Will not be used if no data is sent/received from server.
+    __attribute__((unused)) uint8_t* _msgBufPtr;
+    __attribute__((unused)) uint8_t* _msgBufEndPtr;
+
+    {{func.resultStorage}}
+""" + ClientRequestCode + """
+    // Send a request to the server and get the response.
+    LE_DEBUG("Sending message to server and waiting for response");
+    _responseMsgRef = {{requestFunc}}(_msgRef);
+    // It is a serious error if we don't get a valid response from the server
+    LE_FATAL_IF(_responseMsgRef == NULL, "Valid response was not received from server");
+""" + ClientResponseCode,
+
+    oneWay = """
+{{prototype}}
+{
+    le_msg_MessageRef_t _msgRef;
+    _Message_t* _msgPtr;
+
+    // Will not be used if no data is sent to the server.
+    __attribute__((unused)) uint8_t* _msgBufPtr;
+    __attribute__((unused)) uint8_t* _msgBufEndPtr;
+""" + ClientRequestCode + """
+    // Send the request to the server.  The server doesn't respond to a one-way function.
+    LE_DEBUG("Sending one-way message to server");
+    le_msg_Send(_msgRef);
+}
+""",
+
+    start = """
+{{startPrototype}}
+{
+    le_msg_MessageRef_t _msgRef;
+    _Message_t* _msgPtr;
+
+    // Will not be used if no data is sent to the server.
+    __attribute__((unused)) uint8_t* _msgBufPtr;
+    __attribute__((unused)) uint8_t* _msgBufEndPtr;
+""" + ClientRequestCode + """
+    // Send the request to the server, without waiting for the response.
+    LE_DEBUG("Sending message to server");
+    return ({{ "PendingRef_t" | addNamePrefix }})le_ipc_StartRequest(_msgRef);
+}
+""",
+
+    finish = """
+{{finishPrototype}}
+{
+    le_msg_MessageRef_t _responseMsgRef;
+    _Message_t* _msgPtr;
+
+    // Will not be used if no data is received from server.
+    __attribute__((unused)) uint8_t* _msgBufPtr;
+    __attribute__((unused)) uint8_t* _msgBufEndPtr;
+
+    {{func.resultStorage}}
+
+    // Get the response to the request, waiting for it if it hasn't arrived yet.
+    LE_DEBUG("Waiting for response from server");
+    _responseMsgRef = le_ipc_FinishRequest((le_ipc_PendingRef_t)_pendingRef, _MSGID_{{func.name}});
+    // It is a serious error if we don't get a valid response from the server
+    LE_FATAL_IF(_responseMsgRef == NULL, "Valid response was not received from server");
+""" + ClientResponseCode
 )
 
 
-def WriteFuncCode(func, template):
-    funcStr = FormatCode(template['function'], func=func, prototype=GetFuncPrototypeStr(func))
+def WriteFuncCode(func, template, genAwait, genPipelined):
+    # Await-style stubs only suspend the calling coroutine (if any) while waiting for the server.
+    requestFunc = "le_msg_RequestAwaitResponse" if genAwait else "le_msg_RequestSyncResponse"
+
+    request, response = GetMessageLayouts(func)[:2]
+
+    funcStr = FormatCode(template['oneWay' if func.isOneWay else 'function'],
+                         func=func,
+                         prototype=GetFuncPrototypeStr(func),
+                         requestFunc=requestFunc,
+                         request=request,
+                         response=response)
     print >>ClientFileText, funcStr
 
+    if genPipelined and IsPipelined(func):
+        startProto, finishProto = GetPipelinedFuncPrototypeStrs(func)
+
+        for name in ("start", "finish"):
+            funcStr = FormatCode(template[name],
+                                 func=func,
+                                 startPrototype=startProto,
+                                 finishPrototype=finishProto,
+                                 request=request,
+                                 response=response)
+            print >>ClientFileText, funcStr
+
 
 #---------------------------------------------------------------------------------------------------
 
@@ -520,28 +736,34 @@ ClientHandlerTemplate = dict(
 
     handler = """
 // This function parses the message buffer received from the server, and then calls the user
-// registered handler, which is stored in a client data object.
+// registered handler, which is stored in a client handler object.
 static void _Handle_{{func.name}}
 (
     void* _reportPtr,
-    void* _notUsed
+    void* _dataPtr
 )
 {
     le_msg_MessageRef_t _msgRef = _reportPtr;
     _Message_t* _msgPtr = le_msg_GetPayloadPtr(_msgRef);
-    uint8_t* _msgBufPtr = _msgPtr->buffer;
+    __attribute__((unused)) uint8_t* _msgBufPtr = _msgPtr->buffer;
+    __attribute__((unused)) uint8_t* _msgBufEndPtr = _msgPtr->buffer + _MAX_MSG_SIZE;
 
-    // The clientContextPtr always exists and is always first.
-    void* _clientContextPtr;
-    _msgBufPtr = UnpackData( _msgBufPtr, &_clientContextPtr, sizeof(void*) );
+    // The fixed-size fields are at the start of the message
+    __attribute__((unused)) {{indication.typeName}}* _rxFieldsPtr =
+        ({{indication.typeName}}*)_msgBufPtr;
+    _msgBufPtr += LE_IPC_ALIGN_SIZE(sizeof({{indication.typeName}}));
 
-    // Pull out additional data from the context pointer
-    _ClientData_t* _clientDataPtr = _clientContextPtr;
-    {{handler.name}} _handlerRef_{{func.name}} = ({{handler.name}})_clientDataPtr->handlerPtr;
-    void* contextPtr = _clientDataPtr->contextPtr;
+    // The IPC runtime has already looked up the client handler object, which the server sends
+    // back as the first field of the message.
+    le_ipc_ClientHandler_t* _clientHandlerPtr = _dataPtr;
+    {{handler.name}} _handlerRef_{{func.name}} = ({{handler.name}})_clientHandlerPtr->handlerPtr;
+    void* contextPtr = _clientHandlerPtr->contextPtr;
 
     // Unpack the remaining parameters
     {{ handler.parmList | printParmList("handlerUnpack", sep="\n\n") | indent }}
+    {% if indication.hasData -%}
+    LE_FATAL_IF(_msgBufPtr == NULL, "Invalid message received from server");
+    {% endif %}
 
     // Call the registered handler
     if ( _handlerRef_{{func.name}} != NULL )
@@ -561,56 +783,11 @@ static void _Handle_{{func.name}}
 )
 
 def WriteClientHandler(func, handler, template):
-    funcStr = FormatCode(template["handler"], func=func, handler=handler)
+    indication = GetMessageLayouts(func, handler)[2]
+    funcStr = FormatCode(template["handler"], func=func, handler=handler, indication=indication)
     print >>ClientFileText, funcStr
 
 
-#---------------------------------------------------------------------------------------------------
-
-AsyncHandlerTemplate = dict(
-
-    msgHandler = """
-static void ClientIndicationRecvHandler
-(
-    le_msg_MessageRef_t  msgRef,
-    void*                contextPtr
-)
-{
-    // Get the message payload
-    _Message_t* msgPtr = le_msg_GetPayloadPtr(msgRef);
-    uint8_t* _msgBufPtr = msgPtr->buffer;
-
-    // Have to partially unpack the received message in order to know which thread
-    // the queued function should actually go to.
-    void* clientContextPtr;
-    _msgBufPtr = UnpackData( _msgBufPtr, &clientContextPtr, sizeof(void*) );
-
-    // Pull out the callers thread
-    _ClientData_t* clientDataPtr = clientContextPtr;
-    le_thread_Ref_t callersThreadRef = clientDataPtr->callersThreadRef;
-
-    // Trigger the appropriate event
-    switch (msgPtr->id)
-    {
-        $ for func in funcList
-        case _MSGID_{{func.name}} :
-            le_event_QueueFunctionToThread(callersThreadRef, _Handle_{{func.name}}, msgRef, NULL);
-            break;
-            {{""}}
-        $ endfor
-
-        default: LE_ERROR("Unknowm msg id = %i for client thread = %p", msgPtr->id, callersThreadRef);
-    }
-}
-""",
-
-)
-
-
-def WriteAsyncHandler(flist, template):
-    print >>ClientFileText, FormatCode(template["msgHandler"], funcList=flist)
-
-
 #---------------------------------------------------------------------------------------------------
 # Server templates/code
 #---------------------------------------------------------------------------------------------------
@@ -630,25 +807,31 @@ static void AsyncResponse_{{func.name}}
 {
     le_msg_MessageRef_t _msgRef;
     _Message_t* _msgPtr;
-    _ServerData_t* serverDataPtr = (_ServerData_t*)contextPtr;
+    le_ipc_ServerHandler_t* _serverHandlerPtr = contextPtr;
 
     // Will not be used if no data is sent back to client
     __attribute__((unused)) uint8_t* _msgBufPtr;
+    __attribute__((unused)) uint8_t* _msgBufEndPtr;
 
     // Create a new message object and get the message buffer
-    _msgRef = le_msg_CreateMsg(serverDataPtr->clientSessionRef);
+    _msgRef = le_msg_CreateMsg(_serverHandlerPtr->clientSessionRef);
     _msgPtr = le_msg_GetPayloadPtr(_msgRef);
     _msgPtr->id = _MSGID_{{func.name}};
     _msgBufPtr = _msgPtr->buffer;
+    _msgBufEndPtr = _msgPtr->buffer + _MAX_MSG_SIZE;
+
+    // The fixed-size fields are at the start of the message
+    {{indication.typeName}}* _txFieldsPtr = ({{indication.typeName}}*)_msgBufPtr;
+    _msgBufPtr += LE_IPC_ALIGN_SIZE(sizeof({{indication.typeName}}));
 
     // Always pack the client context pointer first
-    _msgBufPtr = PackData( _msgBufPtr, &(serverDataPtr->contextPtr), sizeof(void*) );
+    _txFieldsPtr->_clientContextPtr = _serverHandlerPtr->contextPtr;
 
     // Pack the input parameters
     {{ handler.parmList | printParmList("clientPack", sep="\n") | indent }}
 
     // Send the async response to the client
-    LE_DEBUG("Sending message to client session %p", serverDataPtr->clientSessionRef);
+    LE_DEBUG("Sending message to client session %p", _serverHandlerPtr->clientSessionRef);
     le_msg_Send(_msgRef);
 }
 """
@@ -656,7 +839,8 @@ static void AsyncResponse_{{func.name}}
 )
 
 def WriteAsyncFuncCode(func, handler, template):
-    handlerStr = FormatCode(template['function'], func=func, handler=handler)
+    indication = GetMessageLayouts(func, handler)[2]
+    handlerStr = FormatCode(template['function'], func=func, handler=handler, indication=indication)
     print >>ServerFileText, handlerStr
 
 
@@ -676,20 +860,35 @@ static void Handle_{{func.name}}
 )
 {
     // Get the message buffer pointer
-    uint8_t* _msgBufPtr = ((_Message_t*)le_msg_GetPayloadPtr(_msgRef))->buffer;
+    __attribute__((unused)) uint8_t* _msgBufPtr = ((_Message_t*)le_msg_GetPayloadPtr(_msgRef))->buffer;
+    __attribute__((unused)) uint8_t* _msgBufEndPtr = _msgBufPtr + _MAX_MSG_SIZE;
 
     // Needed if we are returning a result or output values
     uint8_t* _msgBufStartPtr = _msgBufPtr;
+    {% if request.typeName %}
+
+    // The fixed-size fields are at the start of the message
+    {{request.typeName}}* _rxFieldsPtr = ({{request.typeName}}*)_msgBufPtr;
+    _msgBufPtr += LE_IPC_ALIGN_SIZE(sizeof({{request.typeName}}));
+    {% endif %}
 
     // Unpack the input parameters from the message
     {{ func.parmListIn | printParmList("handlerUnpack", sep="\n\n") | indent }}
+    {% if request.hasData %}
+
+    // The client is dropped if anything in the message is not valid
+    if ( _msgBufPtr == NULL )
+    {
+        LE_KILL_CLIENT("Invalid message received from client");
+        le_msg_ReleaseMsg(_msgRef);
+        return;
+    }
+    {% endif %}
 
     {% if func.addHandlerName -%}
-    // Create a new server data object and fill it in
-    _ServerData_t* serverDataPtr = le_mem_ForceAlloc(_ServerDataPool);
-    serverDataPtr->clientSessionRef = le_msg_GetSession(_msgRef);
-    serverDataPtr->contextPtr = contextPtr;
-    contextPtr = serverDataPtr;
+    // Create a new server handler object, which is passed to the function as the context pointer
+    le_ipc_ServerHandler_t* _serverHandlerPtr = le_ipc_NewServerHandler(_msgRef, contextPtr);
+    contextPtr = _serverHandlerPtr;
     {% endif %}
 
     // Define storage for output parameters
@@ -707,25 +906,28 @@ static void Handle_{{func.name}}
 
     {% if func.addHandlerName -%}
     // Put the handler reference result and a pointer to the associated remove function
-    // into the server data object.  This function pointer is needed in case the client
-    // is closed and the handlers need to be removed.
-    serverDataPtr->handlerRef = (le_event_HandlerRef_t)_result;
-    serverDataPtr->removeHandlerFunc = (RemoveHandlerFunc_t){{func.name | replace("Add", "Remove", 1)}};
-
-    // Return a safe reference to the server data object as the reference.
-    _LOCK
-    _result = le_ref_CreateRef(_HandlerRefMap, serverDataPtr);
-    _UNLOCK
+    // into the server handler object.  This function pointer is needed in case the client
+    // is closed and the handlers need to be removed.  A safe reference to the server handler
+    // object is returned as the reference.
+    _result = le_ipc_AddServerHandler(_serverHandlerPtr,
+                                      (le_event_HandlerRef_t)_result,
+                                      (le_ipc_RemoveHandlerFunc_t){{func.name | replace("Add", "Remove", 1)}});
     {% endif %}
 
     {% endif %}
 
     // Re-use the message buffer for the response
     _msgBufPtr = _msgBufStartPtr;
+    {% if response.typeName %}
+
+    // The fixed-size fields are at the start of the message
+    {{response.typeName}}* _txFieldsPtr = ({{response.typeName}}*)_msgBufPtr;
+    _msgBufPtr += LE_IPC_ALIGN_SIZE(sizeof({{response.typeName}}));
+    {% endif %}
 
     {% if func.type != "void" -%}
     // Pack the result first
-    _msgBufPtr = PackData( _msgBufPtr, &_result, sizeof(_result) );
+    _txFieldsPtr->_result = _result;
     {% endif %}
 
     // Pack any "out" parameters
@@ -750,16 +952,23 @@ AsyncFuncHandlerTemplate = dict(
     le_msg_MessageRef_t _msgRef = (le_msg_MessageRef_t)_cmdRef;
     _Message_t* _msgPtr = le_msg_GetPayloadPtr(_msgRef);
     __attribute__((unused)) uint8_t* _msgBufPtr = _msgPtr->buffer;
+    __attribute__((unused)) uint8_t* _msgBufEndPtr = _msgPtr->buffer + _MAX_MSG_SIZE;
 
     // Ensure the passed in msgRef is for the correct message
     LE_ASSERT(_msgPtr->id == _MSGID_{{func.name}});
 
     // Ensure that this Respond function has not already been called
     LE_FATAL_IF( !le_msg_NeedsResponse(_msgRef), "Response has already been sent");
+    {% if response.typeName %}
+
+    // The fixed-size fields are at the start of the message
+    {{response.typeName}}* _txFieldsPtr = ({{response.typeName}}*)_msgBufPtr;
+    _msgBufPtr += LE_IPC_ALIGN_SIZE(sizeof({{response.typeName}}));
+    {% endif %}
 
     {% if func.type != "void" -%}
     // Pack the result first
-    _msgBufPtr = PackData( _msgBufPtr, &_result, sizeof(_result) );
+    _txFieldsPtr->_result = _result;
     {% endif %}
 
     // Pack any "out" parameters
@@ -777,9 +986,26 @@ static void Handle_{{func.name}}
 {
     // Get the message buffer pointer
     __attribute__((unused)) uint8_t* _msgBufPtr = ((_Message_t*)le_msg_GetPayloadPtr(_msgRef))->buffer;
+    __attribute__((unused)) uint8_t* _msgBufEndPtr = _msgBufPtr + _MAX_MSG_SIZE;
+    {% if request.typeName %}
+
+    // The fixed-size fields are at the start of the message
+    {{request.typeName}}* _rxFieldsPtr = ({{request.typeName}}*)_msgBufPtr;
+    _msgBufPtr += LE_IPC_ALIGN_SIZE(sizeof({{request.typeName}}));
+    {% endif %}
 
     // Unpack the input parameters from the message
     {{ func.parmListIn | printParmList("handlerUnpack", sep="\n\n") | indent }}
+    {% if request.hasData %}
+
+    // The client is dropped if anything in the message is not valid
+    if ( _msgBufPtr == NULL )
+    {
+        LE_KILL_CLIENT("Invalid message received from client");
+        le_msg_ReleaseMsg(_msgRef);
+        return;
+    }
+    {% endif %}
 
     // Call the function
     {{func.name}} ( ({{ "ServerCmdRef_t" | addNamePrefix }})_msgRef
@@ -789,58 +1015,103 @@ static void Handle_{{func.name}}
 )
 
 
+OneWayFuncHandlerTemplate = dict(
+
+    handler = """
+static void Handle_{{func.name}}
+(
+    le_msg_MessageRef_t _msgRef
+)
+{
+    // Get the message buffer pointer
+    __attribute__((unused)) uint8_t* _msgBufPtr = ((_Message_t*)le_msg_GetPayloadPtr(_msgRef))->buffer;
+    __attribute__((unused)) uint8_t* _msgBufEndPtr = _msgBufPtr + _MAX_MSG_SIZE;
+    {% if request.typeName %}
+
+    // The fixed-size fields are at the start of the message
+    {{request.typeName}}* _rxFieldsPtr = ({{request.typeName}}*)_msgBufPtr;
+    _msgBufPtr += LE_IPC_ALIGN_SIZE(sizeof({{request.typeName}}));
+    {% endif %}
+
+    // Unpack the input parameters from the message
+    {{ func.parmListIn | printParmList("handlerUnpack", sep="\n\n") | indent }}
+    {% if request.hasData %}
+
+    // The client is dropped if anything in the message is not valid
+    if ( _msgBufPtr == NULL )
+    {
+        LE_KILL_CLIENT("Invalid message received from client");
+        le_msg_ReleaseMsg(_msgRef);
+        return;
+    }
+    {% endif %}
+
+    // Call the function
+    {{func.name}} ( {{ func.parmList | printParmList("unpackCallName", sep=", ") }} );
+
+    // The client doesn't wait for a response to a one-way function.
+    le_msg_ReleaseMsg(_msgRef);
+}
+"""
+)
+
+
 
 def WriteHandlerCode(func, template):
     # The prototype parameter is only needed for the AsyncFuncHandlerTemplate, but it does no
     # harm to always include it.  It will be ignored for the other template(s).
+    request, response = GetMessageLayouts(func)[:2]
+
     funcStr = FormatCode(template["handler"],
                          func=func,
-                         respondProto=GetRespondFuncPrototypeStr(func))
+                         respondProto=GetRespondFuncPrototypeStr(func),
+                         request=request,
+                         response=response)
     print >>ServerFileText, funcStr
 
 
 #---------------------------------------------------------------------------------------------------
-# This function take the message from the client, and then based on the message ID, calls
-# the appropriate handler.
+# The table through which the IPC runtime dispatches the messages from the clients, indexed by
+# message ID, and the server object that refers to it.
 #---------------------------------------------------------------------------------------------------
 
-MsgHandlerTemplate = dict(
+ServerGenericCode = """
+//--------------------------------------------------------------------------------------------------
+// Generic Server Types, Variables and Functions
+//--------------------------------------------------------------------------------------------------
 
-    msgHandler = """
-static void ServerMsgRecvHandler
-(
-    le_msg_MessageRef_t msgRef,
-    void*               contextPtr
-)
+//--------------------------------------------------------------------------------------------------
+/**
+ * The server function for each message ID.  The IPC runtime (see le_ipc.h) dispatches the requests
+ * from clients through this table.
+ */
+//--------------------------------------------------------------------------------------------------
+static const le_ipc_ServerFunc_t _ServerFuncs[] =
 {
-    // Get the message payload so that we can get the message "id"
-    _Message_t* msgPtr = le_msg_GetPayloadPtr(msgRef);
-
-    // Get the client session ref for the current message.  This ref is used by the server to
-    // get info about the client process, such as user id.  If there are multiple clients, then
-    // the session ref may be different for each message, hence it has to be queried each time.
-    _ClientSessionRef = le_msg_GetSession(msgRef);
+    $ for func in funcList
+    [_MSGID_{{func.name}}] = { "{{func.name}}", Handle_{{func.name}} },
+    $ endfor
+};
 
-    // Dispatch to appropriate message handler and get response
-    switch (msgPtr->id)
-    {
-        $ for func in funcList
-        case _MSGID_{{func.name}} : Handle_{{func.name}}(msgRef); break;
-        $ endfor
-        {{""}}
-        default: LE_ERROR("Unknowm msg id = %i", msgPtr->id);
-    }
 
-    // Clear the client session ref associated with the current message, since the message
-    // has now been processed.
-    _ClientSessionRef = 0;
-}
-"""
-)
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of calls to each server function, and the time spent in them (see "inspect ipc").
+ */
+//--------------------------------------------------------------------------------------------------
+static le_ipc_ServerFuncStats_t _ServerFuncStats[NUM_ARRAY_MEMBERS(_ServerFuncs)];
 
 
-def WriteMsgHandler(flist, template):
-    print >>ServerFileText, FormatCode(template["msgHandler"], funcList=flist)
+//--------------------------------------------------------------------------------------------------
+/**
+ * The server side of the interface.  The IPC runtime keeps the handlers that clients have
+ * registered, and removes them when the clients' sessions close.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_ipc_Server_t _Server =
+    LE_IPC_SERVER_INIT(PROTOCOL_ID_STR, SERVICE_INSTANCE_NAME, sizeof(_Message_t),
+                       _ServerFuncs, _ServerFuncStats);
+"""
 
 
 #---------------------------------------------------------------------------------------------------
@@ -897,7 +1168,8 @@ def WriteCommonInterface(fp,
                          fileName,
                          genericFunctions,
                          headerComments,
-                         genAsync):
+                         genAsync,
+                         genPipelined):
 
     WriteWarning(fp)
 
@@ -939,13 +1211,18 @@ def WriteCommonInterface(fp,
     for f in pf.values():
         #print f
 
-        # The Add and Remove handler functions are never asynchronous.
-        if genAsync and not f.addHandlerName and not f.isRemoveHandler :
+        # The Add and Remove handler functions are never asynchronous, and there is nothing to
+        # respond with for one-way functions.
+        if genAsync and not f.addHandlerName and not f.isRemoveHandler and not f.isOneWay:
             print >>fp, "%s;\n" % GetRespondFuncPrototypeStr(f)
             print >>fp, "%s;\n" % GetServerAsyncFuncPrototypeStr(f)
         else:
             print >>fp, "%s;\n" % GetFuncPrototypeStr(f)
 
+            if genPipelined and IsPipelined(f):
+                for proto in GetPipelinedFuncPrototypeStrs(f):
+                    print >>fp, "%s;\n" % proto
+
     WriteIncludeGuardEnd(fp, fileName)
 
 
@@ -956,16 +1233,36 @@ InterfaceHeaderStartTemplate = """
 #include "legato.h"
 """
 
+
+PipelinedInterfaceHeaderStartTemplate = """
+#include "legato.h"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reference to a request sent by a pipelined client function (see the Start functions).  The
+ * corresponding Finish function must be called exactly once with it, to collect the response.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct {{ "Pending*" | addNamePrefix }} {{ "PendingRef_t" | addNamePrefix }};
+"""
+
+
 def WriteInterfaceHeaderFile(pf,
                              ph,
                              pt,
                              importList,
                              genericFunctions,
                              fileName,
-                             headerComments):
+                             headerComments,
+                             genPipelined):
+
+    if genPipelined:
+        headerTemplate = PipelinedInterfaceHeaderStartTemplate
+    else:
+        headerTemplate = InterfaceHeaderStartTemplate
 
     WriteCommonInterface(InterfaceHeaderFileText,
-                         InterfaceHeaderStartTemplate,
+                         headerTemplate,
                          pf,
                          ph,
                          pt,
@@ -973,7 +1270,8 @@ def WriteInterfaceHeaderFile(pf,
                          fileName,
                          genericFunctions,
                          headerComments,
-                         False)
+                         False,
+                         genPipelined)
 
 
 #---------------------------------------------------------------------------------------------------
@@ -987,16 +1285,15 @@ LocalHeaderStartTemplate = """
 #define SERVICE_INSTANCE_NAME "{{serviceName}}"
 
 
-// todo: This will need to depend on the particular protocol, but the exact size is not easy to
-//       calculate right now, so in the meantime, pick a reasonably large size.  Once interface
-//       type support has been added, this will be replaced by a more appropriate size.
-#define _MAX_MSG_SIZE 1000
+// Upper bound on the size of any of the messages, worked out from the sizes given in the
+// interface.  The generated code checks that each message's fields fit.
+#define _MAX_MSG_SIZE {{maxMsgSize}}
 
 // Define the message type for communicating between client and server
 typedef struct
 {
     uint32_t id;
-    uint8_t buffer[_MAX_MSG_SIZE];
+    uint8_t buffer[_MAX_MSG_SIZE] __attribute__((aligned(8)));
 }
 _Message_t;
 """
@@ -1005,9 +1302,12 @@ def WriteLocalHeaderFile(pf, ph, hashValue, fileName, serviceName):
     WriteWarning(LocalHeaderFileText)
     WriteIncludeGuardBegin(LocalHeaderFileText, fileName)
 
+    maxMsgSize = max( [8] + [ AlignSize(l.size) for l in GetAllMessageLayouts(pf, ph) ] )
+
     print >>LocalHeaderFileText, FormatCode(LocalHeaderStartTemplate,
                                             idString=hashValue,
-                                            serviceName=serviceName)
+                                            serviceName=serviceName,
+                                            maxMsgSize=maxMsgSize)
 
     # Write out the message IDs for the functions
     for i, name in enumerate(pf):
@@ -1026,266 +1326,23 @@ ClientGenericCode = """
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Client Data Objects
- *
- * This object is used for each registered handler.  This is needed since we are not using
- * events, but are instead queueing functions directly with the event loop.
- */
-//--------------------------------------------------------------------------------------------------
-typedef struct
-{
-    le_event_HandlerFunc_t handlerPtr;          ///< Registered handler function
-    void*                  contextPtr;          ///< ContextPtr registered with handler
-    le_event_HandlerRef_t  handlerRef;          ///< HandlerRef for the registered handler
-    le_thread_Ref_t        callersThreadRef;    ///< Caller's thread.
-}
-_ClientData_t;
-
-
-//--------------------------------------------------------------------------------------------------
-/**
- * The memory pool for client data objects
- */
-//--------------------------------------------------------------------------------------------------
-static le_mem_PoolRef_t _ClientDataPool;
-
-
-//--------------------------------------------------------------------------------------------------
-/**
- * Client Thread Objects
- *
- * This object is used to contain thread specific data for each IPC client.
- */
-//--------------------------------------------------------------------------------------------------
-typedef struct
-{
-    le_msg_SessionRef_t sessionRef;     ///< Client Session Reference
-    int                 clientCount;    ///< Number of clients sharing this thread
-}
-_ClientThreadData_t;
-
-
-//--------------------------------------------------------------------------------------------------
-/**
- * The memory pool for client thread objects
- */
-//--------------------------------------------------------------------------------------------------
-static le_mem_PoolRef_t _ClientThreadDataPool;
-
-
-//--------------------------------------------------------------------------------------------------
-/**
- * Key under which the pointer to the Thread Object (_ClientThreadData_t) will be kept in
- * thread-local storage.  This allows a thread to quickly get a pointer to its own Thread Object.
- */
-//--------------------------------------------------------------------------------------------------
-static pthread_key_t _ThreadDataKey;
-
-
-//--------------------------------------------------------------------------------------------------
-/**
- * Safe Reference Map for use with Add/Remove handler references
- *
- * @warning Use _Mutex, defined below, to protect accesses to this data.
- */
-//--------------------------------------------------------------------------------------------------
-static le_ref_MapRef_t _HandlerRefMap;
-
-
-//--------------------------------------------------------------------------------------------------
-/**
- * Mutex and associated macros for use with the above HandlerRefMap.
- *
- * Unused attribute is needed because this variable may not always get used.
- */
-//--------------------------------------------------------------------------------------------------
-__attribute__((unused)) static pthread_mutex_t _Mutex = PTHREAD_MUTEX_INITIALIZER;   // POSIX "Fast" mutex.
-
-/// Locks the mutex.
-#define _LOCK    LE_ASSERT(pthread_mutex_lock(&_Mutex) == 0);
-
-/// Unlocks the mutex.
-#define _UNLOCK  LE_ASSERT(pthread_mutex_unlock(&_Mutex) == 0);
-
-
-//--------------------------------------------------------------------------------------------------
-/* This global flag is shared by all client threads, and is used to indicate whether the common
- * data has been initialized.  It is only initialized once by the main thread, and is only read by
- * the other threads.  Thus, a mutex is not needed for accesses to this variable.
- */
-//--------------------------------------------------------------------------------------------------
-static bool CommonDataInitialized = false;
-
-
-//--------------------------------------------------------------------------------------------------
-/**
- * Forward declaration needed by InitClientThreadData
- */
-//--------------------------------------------------------------------------------------------------
-static void ClientIndicationRecvHandler
-(
-    le_msg_MessageRef_t  msgRef,
-    void*                contextPtr
-);
-
-
-//--------------------------------------------------------------------------------------------------
-/**
- * Init thread specific data
- */
-//--------------------------------------------------------------------------------------------------
-static void InitClientThreadData
-(
-    void
-)
-{
-    // Open a session.
-    le_msg_ProtocolRef_t protocolRef;
-    le_msg_SessionRef_t sessionRef;
-
-    protocolRef = le_msg_GetProtocolRef(PROTOCOL_ID_STR, sizeof(_Message_t));
-    sessionRef = le_msg_CreateSession(protocolRef, SERVICE_INSTANCE_NAME);
-    le_msg_SetSessionRecvHandler(sessionRef, ClientIndicationRecvHandler, NULL);
-    le_msg_OpenSessionSync(sessionRef);
-
-    // Store the client sessionRef in thread-local storage, since each thread requires
-    // its own sessionRef.
-    _ClientThreadData_t* clientThreadPtr = le_mem_ForceAlloc(_ClientThreadDataPool);
-    clientThreadPtr->sessionRef = sessionRef;
-    if (pthread_setspecific(_ThreadDataKey, clientThreadPtr) != 0)
-    {
-        LE_FATAL("pthread_setspecific() failed!");
-    }
-
-    // This is the first client for the current thread
-    clientThreadPtr->clientCount = 1;
-}
-
-
-//--------------------------------------------------------------------------------------------------
-/**
- * Get a pointer to the client thread data for the current thread.
- *
- * If the current thread does not have client data, then NULL is returned
- */
-//--------------------------------------------------------------------------------------------------
-static _ClientThreadData_t* GetClientThreadDataPtr
-(
-    void
-)
-{
-    return pthread_getspecific(_ThreadDataKey);
-}
-
-
-//--------------------------------------------------------------------------------------------------
-/**
- * Return the sessionRef for the current thread.
- *
- * If the current thread does not have a session ref, then this is a fatal error.
- */
-//--------------------------------------------------------------------------------------------------
-__attribute__((unused)) static le_msg_SessionRef_t GetCurrentSessionRef
-(
-    void
-)
-{
-    _ClientThreadData_t* clientThreadPtr = GetClientThreadDataPtr();
-
-    // If the thread specific data is NULL, then the session ref has not been created.
-    LE_FATAL_IF(clientThreadPtr==NULL, "No client session for current thread");
-
-    return clientThreadPtr->sessionRef;
-}
-
-
-//--------------------------------------------------------------------------------------------------
-/**
- * Init data that is common across all threads.
+ * The client side of the interface.  The IPC runtime (see le_ipc.h) keeps each thread's session
+ * with the server, and the handlers that have been registered with the server.
  */
 //--------------------------------------------------------------------------------------------------
-static void InitCommonData(void)
-{
-    // Allocate the client data pool
-    _ClientDataPool = le_mem_CreatePool("ClientData", sizeof(_ClientData_t));
-
-    // Allocate the client thread pool
-    _ClientThreadDataPool = le_mem_CreatePool("ClientThreadData", sizeof(_ClientThreadData_t));
-
-    // Create the thread-local data key to be used to store a pointer to each thread object.
-    LE_ASSERT(pthread_key_create(&_ThreadDataKey, NULL) == 0);
-
-    // Create safe reference map for handler references.
-    // The size of the map should be based on the number of handlers defined multiplied by
-    // the number of client threads.  Since this number can't be completely determined at
-    // build time, just make a reasonable guess.
-    _HandlerRefMap = le_ref_CreateMap("ClientHandlers", 5);
-}
+static le_ipc_Client_t _Client =
+    LE_IPC_CLIENT_INIT(PROTOCOL_ID_STR, SERVICE_INSTANCE_NAME, sizeof(_Message_t));
 """
 
 ClientStartFuncCode = """
 {{ proto['startClientFunc'] }}
 {
-    // If this is the first time the function is called, init the client common data.
-    if ( ! CommonDataInitialized )
-    {
-        InitCommonData();
-        CommonDataInitialized = true;
-    }
-
-    _ClientThreadData_t* clientThreadPtr = GetClientThreadDataPtr();
-
-    // If the thread specific data is NULL, then there is no current client session.
-    if (clientThreadPtr == NULL)
-    {
-        InitClientThreadData();
-        LE_DEBUG("======= Starting client for '%s' service ========", SERVICE_INSTANCE_NAME);
-    }
-    else
-    {
-        // Keep track of the number of clients for the current thread.  There is only one
-        // connection per thread, and it is shared by all clients.
-        clientThreadPtr->clientCount++;
-        LE_DEBUG("======= Starting another client for '%s' service ========", SERVICE_INSTANCE_NAME);
-    }
+    le_ipc_ConnectService(&_Client);
 }
 
 {{ proto['stopClientFunc'] }}
 {
-    _ClientThreadData_t* clientThreadPtr = GetClientThreadDataPtr();
-
-    // If the thread specific data is NULL, then there is no current client session.
-    if (clientThreadPtr == NULL)
-    {
-        LE_CRIT("Trying to stop non-existent client session for '%s' service",
-                SERVICE_INSTANCE_NAME);
-    }
-    else
-    {
-        // This is the last client for this thread, so close the session.
-        if ( clientThreadPtr->clientCount == 1 )
-        {
-            le_msg_CloseSession( clientThreadPtr->sessionRef );
-
-            // Need to delete the thread specific data, since it is no longer valid.  If a new
-            // client session is started, new thread specific data will be allocated.
-            le_mem_Release(clientThreadPtr);
-            if (pthread_setspecific(_ThreadDataKey, NULL) != 0)
-            {
-                LE_FATAL("pthread_setspecific() failed!");
-            }
-
-            LE_DEBUG("======= Stopping client for '%s' service ========", SERVICE_INSTANCE_NAME);
-        }
-        else
-        {
-            // There is one less client sharing this thread's connection.
-            clientThreadPtr->clientCount--;
-
-            LE_DEBUG("======= Stopping another client for '%s' service ========",
-                     SERVICE_INSTANCE_NAME);
-        }
-    }
+    le_ipc_DisconnectService(&_Client);
 }
 """
 
@@ -1296,11 +1353,11 @@ ClientStartClientCode = """
 """
 
 
-def WriteClientFile(headerFiles, pf, ph, genericFunctions):
+def WriteClientFile(headerFiles, pf, ph, genericFunctions, genAwait, genPipelined):
     WriteWarning(ClientFileText)
 
     print >>ClientFileText, '\n' + '\n'.join('#include "%s"'%h for h in headerFiles) + '\n'
-    print >>ClientFileText, DefaultPackerUnpacker
+    WriteMessageLayouts(ClientFileText, pf, ph)
     print >>ClientFileText, ClientGenericCode
 
     # Note that this does not need to be an ordered dictionary, unlike genericFunctions
@@ -1320,201 +1377,28 @@ def WriteClientFile(headerFiles, pf, ph, genericFunctions):
                     break
 
         # Write out the functions next
-        WriteFuncCode(f, FuncImplTemplate)
-
-    addHandlerFuncs = [ f for f in pf.values() if f.addHandlerName ]
-    WriteAsyncHandler(addHandlerFuncs, AsyncHandlerTemplate)
+        WriteFuncCode(f, FuncImplTemplate, genAwait, genPipelined)
 
 
 
 #---------------------------------------------------------------------------------------------------
 
-ServerGenericCode = """
-//--------------------------------------------------------------------------------------------------
-// Generic Server Types, Variables and Functions
-//--------------------------------------------------------------------------------------------------
-
-//--------------------------------------------------------------------------------------------------
-/**
- * Type definition for generic function to remove a handler, given the handler ref.
- */
-//--------------------------------------------------------------------------------------------------
-typedef void(* RemoveHandlerFunc_t)(void *handlerRef);
-
-
-//--------------------------------------------------------------------------------------------------
-/**
- * Server Data Objects
- *
- * This object is used to store additional context info for each request
- */
-//--------------------------------------------------------------------------------------------------
-typedef struct
-{
-    le_msg_SessionRef_t   clientSessionRef;     ///< The client to send the response to
-    void*                 contextPtr;           ///< ContextPtr registered with handler
-    le_event_HandlerRef_t handlerRef;           ///< HandlerRef for the registered handler
-    RemoveHandlerFunc_t   removeHandlerFunc;    ///< Function to remove the registered handler
-}
-_ServerData_t;
-
-
-//--------------------------------------------------------------------------------------------------
-/**
- * The memory pool for server data objects
- */
-//--------------------------------------------------------------------------------------------------
-static le_mem_PoolRef_t _ServerDataPool;
-
-
-//--------------------------------------------------------------------------------------------------
-/**
- * Safe Reference Map for use with Add/Remove handler references
- *
- * @warning Use _Mutex, defined below, to protect accesses to this data.
- */
-//--------------------------------------------------------------------------------------------------
-static le_ref_MapRef_t _HandlerRefMap;
-
-
-//--------------------------------------------------------------------------------------------------
-/**
- * Mutex and associated macros for use with the above HandlerRefMap.
- *
- * Unused attribute is needed because this variable may not always get used.
- */
-//--------------------------------------------------------------------------------------------------
-__attribute__((unused)) static pthread_mutex_t _Mutex = PTHREAD_MUTEX_INITIALIZER;   // POSIX "Fast" mutex.
-
-/// Locks the mutex.
-#define _LOCK    LE_ASSERT(pthread_mutex_lock(&_Mutex) == 0);
-
-/// Unlocks the mutex.
-#define _UNLOCK  LE_ASSERT(pthread_mutex_unlock(&_Mutex) == 0);
-
-
-//--------------------------------------------------------------------------------------------------
-/**
- * Forward declaration needed by StartServer
- */
-//--------------------------------------------------------------------------------------------------
-static void ServerMsgRecvHandler
-(
-    le_msg_MessageRef_t msgRef,
-    void*               contextPtr
-);
-
-
-//--------------------------------------------------------------------------------------------------
-/**
- * Server Service Reference
- */
-//--------------------------------------------------------------------------------------------------
-static le_msg_ServiceRef_t _ServerServiceRef;
-
-
-//--------------------------------------------------------------------------------------------------
-/**
- * Client Session Reference for the current message received from a client
- */
-//--------------------------------------------------------------------------------------------------
-static le_msg_SessionRef_t _ClientSessionRef;
-
-
-//--------------------------------------------------------------------------------------------------
-/**
- * Cleanup client data if the client is no longer connected
- */
-//--------------------------------------------------------------------------------------------------
-static void CleanupClientData
-(
-    le_msg_SessionRef_t sessionRef,
-    void *contextPtr
-)
-{
-    LE_DEBUG("Client %p is closed !!!", sessionRef);
-
-    // Iterate over the server data reference map and remove anything that matches
-    // the client session.
-    _LOCK
-
-    le_ref_IterRef_t iterRef = le_ref_GetIterator(_HandlerRefMap);
-    le_result_t result = le_ref_NextNode(iterRef);
-    _ServerData_t const* serverDataPtr;
-
-    while ( result == LE_OK )
-    {
-        serverDataPtr =  le_ref_GetValue(iterRef);
-
-        if ( sessionRef != serverDataPtr->clientSessionRef )
-        {
-            LE_DEBUG("Found session ref %p; does not match",
-                     serverDataPtr->clientSessionRef);
-        }
-        else
-        {
-            LE_DEBUG("Found session ref %p; match found, so needs cleanup",
-                     serverDataPtr->clientSessionRef);
-
-            // Remove the handler
-            serverDataPtr->removeHandlerFunc( serverDataPtr->handlerRef );
-
-            // Release the server data block
-            le_mem_Release((void*)serverDataPtr);
-
-            // Delete the associated safeRef
-            le_ref_DeleteRef( _HandlerRefMap, (void*)le_ref_GetSafeRef(iterRef) );
-
-            // Since the reference map was modified, the iterator is no longer valid and
-            // so has to be re-initalized.  This means that some values may get revisited,
-            // but eventually this will iterate over the whole reference map.
-            // todo: Is there an easier way?
-            iterRef = le_ref_GetIterator(_HandlerRefMap);
-        }
-
-        // Get the next value in the reference mpa
-        result = le_ref_NextNode(iterRef);
-    }
-
-    _UNLOCK
-}
-"""
-
 ServerStartFuncCode = """
 {{ proto['getServiceRef'] }}
 {
-    return _ServerServiceRef;
+    return _Server.serviceRef;
 }
 
 
 {{ proto['getSessionRef'] }}
 {
-    return _ClientSessionRef;
+    return _Server.clientSessionRef;
 }
 
 
 {{ proto['startServerFunc'] }}
 {
-    LE_DEBUG("======= Starting Server %s ========", SERVICE_INSTANCE_NAME);
-
-    le_msg_ProtocolRef_t protocolRef;
-
-    // Create the server data pool
-    _ServerDataPool = le_mem_CreatePool("ServerData", sizeof(_ServerData_t));
-
-    // Create safe reference map for handler references.
-    // The size of the map should be based on the number of handlers defined for the server.
-    // Don't expect that to be more than 2-3, so use 3 as a reasonable guess.
-    _HandlerRefMap = le_ref_CreateMap("ServerHandlers", 3);
-
-    // Start the server side of the service
-    protocolRef = le_msg_GetProtocolRef(PROTOCOL_ID_STR, sizeof(_Message_t));
-    _ServerServiceRef = le_msg_CreateService(protocolRef, SERVICE_INSTANCE_NAME);
-    le_msg_SetServiceRecvHandler(_ServerServiceRef, ServerMsgRecvHandler, NULL);
-    le_msg_AdvertiseService(_ServerServiceRef);
-
-    // Register for client sessions being closed
-    le_msg_AddServiceCloseHandler(_ServerServiceRef, CleanupClientData, NULL);
+    le_ipc_AdvertiseService(&_Server);
 }
 """
 
@@ -1528,13 +1412,7 @@ def WriteServerFile(headerFiles, pf, ph, genericFunctions, genAsync):
     WriteWarning(ServerFileText)
 
     print >>ServerFileText, '\n' + '\n'.join('#include "%s"'%h for h in headerFiles) + '\n'
-    print >>ServerFileText, DefaultPackerUnpacker
-    print >>ServerFileText, ServerGenericCode
-
-    # Note that this does not need to be an ordered dictionary, unlike genericFunctions
-    protoDict = { n: GetFuncPrototypeStr(f) for n,f in genericFunctions.items() }
-    print >>ServerFileText, FormatCode(ServerStartFuncCode, proto=protoDict)
-
+    WriteMessageLayouts(ServerFileText, pf, ph)
     print >>ServerFileText, ServerStartClientCode
 
     for f in pf.values():
@@ -1547,13 +1425,21 @@ def WriteServerFile(headerFiles, pf, ph, genericFunctions, genAsync):
                     break
 
         # Write out the functions next.
-        # The Add and Remove handler functions are never asynchronous.
-        if genAsync and not f.addHandlerName and not f.isRemoveHandler :
+        # The Add and Remove handler functions are never asynchronous, and there is nothing to
+        # respond with for one-way functions.
+        if f.isOneWay:
+            WriteHandlerCode(f, OneWayFuncHandlerTemplate)
+        elif genAsync and not f.addHandlerName and not f.isRemoveHandler :
             WriteHandlerCode(f, AsyncFuncHandlerTemplate)
         else:
             WriteHandlerCode(f, FuncHandlerTemplate)
 
-    WriteMsgHandler(pf.values(), MsgHandlerTemplate)
+    # The generic code comes last, since it refers to the functions above
+    print >>ServerFileText, FormatCode(ServerGenericCode, funcList=pf.values())
+
+    # Note that this does not need to be an ordered dictionary, unlike genericFunctions
+    protoDict = { n: GetFuncPrototypeStr(f) for n,f in genericFunctions.items() }
+    print >>ServerFileText, FormatCode(ServerStartFuncCode, proto=protoDict)
 
 
 #---------------------------------------------------------------------------------------------------
@@ -1600,7 +1486,8 @@ def WriteServerHeaderFile(pf,
                          fileName,
                          genericFunctions,
                          [],
-                         genAsync)
+                         genAsync,
+                         False)
 
 
 #---------------------------------------------------------------------------------------------------
@@ -1703,17 +1590,17 @@ def PostProcessAddHandler(f, flist, tlist):
     addParm.funcType = addHandler.type
 
     addParm.clientPack = """\
-// The input parameters are stored in the client data object, and it is
+// The input parameters are stored in a client handler object, and it is
 // a pointer to this object that is passed down.
-// Create a new client data object and fill it in
-_ClientData_t* _clientDataPtr = le_mem_ForceAlloc(_ClientDataPool);
-_clientDataPtr->handlerPtr = (le_event_HandlerFunc_t)handlerPtr;
-_clientDataPtr->contextPtr = contextPtr;
-_clientDataPtr->callersThreadRef = le_thread_GetCurrent();
-contextPtr = _clientDataPtr;\
+le_ipc_ClientHandler_t* _clientHandlerPtr =
+    le_ipc_NewClientHandler((le_event_HandlerFunc_t)handlerPtr,
+                            contextPtr,
+                            _Handle_{parm.funcName});
+contextPtr = _clientHandlerPtr;\
 """
 
     addParm.handlerUnpack = ""
+    addParm.fieldDefinition = ""
     addParm.unpackCallName = "AsyncResponse_%s" % addParm.funcName
     # end of todo from above
 
@@ -1731,30 +1618,25 @@ contextPtr = _clientDataPtr;\
     # As a temporary solution, directly modify the templates for the parameter.
     # Note that the original clientPack is still needed, so prepend to it.
     removeParm.clientPack = """\
-// The passed in handlerRef is a safe reference for the client data object.  Need to get the
-// real handlerRef from the client data object and then delete both the safe reference and
-// the object since they are no longer needed.
-_LOCK
-_ClientData_t* clientDataPtr = le_ref_Lookup(_HandlerRefMap, addHandlerRef);
-le_ref_DeleteRef(_HandlerRefMap, addHandlerRef);
-_UNLOCK
-addHandlerRef = ({parm.parmType})clientDataPtr->handlerRef;
-le_mem_Release(clientDataPtr);
+// The passed in handlerRef is a safe reference for the client handler object.  Need to get the
+// real handlerRef from the client handler object, which is then deleted, since it is no longer
+// needed.
+addHandlerRef = ({parm.parmType})le_ipc_RemoveClientHandler(addHandlerRef);
 """ + removeParm.clientPack
 
     # After we have unpacked the parameter, need to use it to look up data, so append the actions
     # to the original handlerUnpack
     removeParm.handlerUnpack += """
-// The passed in handlerRef is a safe reference for the server data object.  Need to get the
-// real handlerRef from the server data object and then delete both the safe reference and
-// the object since they are no longer needed.
-_LOCK
-_ServerData_t* serverDataPtr = le_ref_Lookup(_HandlerRefMap, addHandlerRef);
-le_ref_DeleteRef(_HandlerRefMap, addHandlerRef);
-_UNLOCK
-addHandlerRef = ({func.type})serverDataPtr->handlerRef;
-le_mem_Release(serverDataPtr);
-""".format(func=addHandler)
+// The passed in handlerRef is a safe reference for the server handler object.  Need to get the
+// real handlerRef from the server handler object, which is then deleted, since it is no longer
+// needed.  The client is dropped if the reference is not valid or is not its own.
+addHandlerRef = ({parm.parmType})le_ipc_RemoveServerHandler(_msgRef, addHandlerRef);
+if ( addHandlerRef == NULL )
+{{
+    le_msg_ReleaseMsg(_msgRef);
+    return;
+}}
+"""
 
     removeHandler = codeTypes.FunctionData(
         "Remove" + f.baseName,
@@ -1871,7 +1753,8 @@ def WriteAllCode(commandArgs, parsedData, hashValue):
                                  genericFunctions,
                                  os.path.splitext( os.path.basename(commandArgs.interfaceFile) )[0],
                                  # interfaceFname,
-                                 headerComments)
+                                 headerComments,
+                                 commandArgs.pipelined)
         open(interfaceFpath, 'w').write( InterfaceHeaderFileText.getvalue() )
 
     if commandArgs.genLocal:
@@ -1886,7 +1769,9 @@ def WriteAllCode(commandArgs, parsedData, hashValue):
         WriteClientFile([localFname, interfaceFname],
                         parsedFunctions,
                         parsedHandlers,
-                        genericInterfaceFunctions)
+                        genericInterfaceFunctions,
+                        commandArgs.await,
+                        commandArgs.pipelined)
         open(clientFpath, 'w').write( ClientFileText.getvalue() )
 
     if commandArgs.genServerInterface:
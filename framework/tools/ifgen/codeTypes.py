@@ -182,12 +182,20 @@ class SimpleData(object):
 {parm.parmType} {parm.parmName}\
 """
 
+    # Member of the struct that holds the fixed-size fields at the start of each message.  Strings,
+    # arrays and file descriptors are not in the struct, so they don't have one.
+    fieldDefinition = """\
+{parm.type} {parm.name};\
+"""
+
+    # Fields are read and written in place, through _txFieldsPtr in the message being sent, and
+    # _rxFieldsPtr in the message that was received.
     clientPack = """\
-_msgBufPtr = PackData( _msgBufPtr, {parm.address}, {parm.numBytes} );\
+_txFieldsPtr->{parm.name} = {parm.value};\
 """
 
     clientUnpack = """\
-_msgBufPtr = UnpackData( _msgBufPtr, {parm.address}, {parm.numBytes} );\
+{parm.value} = _rxFieldsPtr->{parm.name};\
 """
 
     handlerParmList = """\
@@ -195,12 +203,11 @@ _msgBufPtr = UnpackData( _msgBufPtr, {parm.address}, {parm.numBytes} );\
 """
 
     handlerUnpack = """\
-{parm.unpackType} {parm.unpackName};
-_msgBufPtr = UnpackData( _msgBufPtr, {parm.unpackAddr}, {parm.numBytes} );\
+{parm.unpackType} {parm.unpackName} = _rxFieldsPtr->{parm.name};\
 """
 
     handlerPack = """\
-_msgBufPtr = PackData( _msgBufPtr, {parm.unpackAddr}, {parm.numBytes} );\
+_txFieldsPtr->{parm.name} = {parm.name};\
 """
 
     asyncServerParmList = """\
@@ -208,7 +215,7 @@ _msgBufPtr = PackData( _msgBufPtr, {parm.unpackAddr}, {parm.numBytes} );\
 """
 
     asyncServerPack = """\
-_msgBufPtr = PackData( _msgBufPtr, {parm.unpackAddr}, {parm.numBytes} );\
+_txFieldsPtr->{parm.name} = {parm.name};\
 """
 
     # Ensure that the array/string length is not greater than the maximum from the API definition.
@@ -357,6 +364,9 @@ class FileInData(SimpleData):
         #       allowable values: DIR_IN or DIR_OUT.
         self.direction = direction
 
+        # The file descriptor is sent with the message, rather than in it.
+        self.fieldDefinition = ""
+
         self.clientPack = """\
 le_msg_SetFd(_msgRef, {parm.parmName});\
 """
@@ -376,6 +386,9 @@ class FileOutData(PointerData):
         #       allowable values: DIR_IN or DIR_OUT.
         self.direction = direction
 
+    # The file descriptor is sent with the message, rather than in it.
+    fieldDefinition = ""
+
     clientUnpack = """\
 {parm.value} = le_msg_GetFd(_responseMsgRef);\
 """
@@ -418,10 +431,22 @@ class ArrayData(SimpleData):
         self.unpackName = "%s[%s]" % (self.name, self.sizeVar)
         self.unpackAddr = self.name
 
+        # Arrays follow the message's fields.
+        self.fieldDefinition = ""
+
         # Some details depend on direction
         if self.direction == DIR_IN:
             # IN arrays should be "const"
             self.parmType = "const " + self.parmType
+
+            self.clientPack = """\
+le_ipc_PackArray( &_msgBufPtr, _msgBufEndPtr, {parm.parmName}, {parm.numBytes} );\
+"""
+
+            # The server uses the array in place, in the message buffer.
+            self.handlerUnpack = """\
+const {parm.type}* {parm.name} = le_ipc_UnpackArray( &_msgBufPtr, _msgBufEndPtr, {parm.numBytes} );\
+"""
         else:
             # OUT arrays have INOUT size parameters, and so the arrays have different expressions
             # for numBytes on the client and server side.  Rather than defining two different
@@ -430,17 +455,21 @@ class ArrayData(SimpleData):
 
             # Definition for the client side -- size is a pointer variable
             self.numBytes = "%s*sizeof(%s)" % ('*%sPtr'%self.sizeVar, self.type)
-            self.clientUnpack = self.clientUnpack.format(parm=self)
+            self.clientUnpack = """\
+le_ipc_UnpackArrayCopy( &_msgBufPtr, _msgBufEndPtr, {parm.address}, {parm.numBytes} );\
+""".format(parm=self)
 
             # Definition for the server side -- size is not a pointer variable
             self.numBytes = "%s*sizeof(%s)" % (self.sizeVar, self.type)
-            self.handlerPack = self.handlerPack.format(parm=self)
+            self.handlerPack = """\
+le_ipc_PackArray( &_msgBufPtr, _msgBufEndPtr, {parm.unpackAddr}, {parm.numBytes} );\
+""".format(parm=self)
 
             # For the respond function, need a slightly different packing rule, and then go
             # ahead and pre-evaluate it, to ensure the correct numBytes is used.
             # todo: do we really need to pre-evaluate this?
             self.asyncServerPack = """\
-_msgBufPtr = PackData( _msgBufPtr, {parm.unpackAddr}Ptr, {parm.numBytes} );\
+le_ipc_PackArray( &_msgBufPtr, _msgBufEndPtr, {parm.unpackAddr}Ptr, {parm.numBytes} );\
 """.format(parm=self)
 
 
@@ -478,13 +507,20 @@ class StringData(SimpleData):
         # IN strings should be "const"
         self.parmType = "const " + self.parmType
 
+        # Strings follow the message's fields.
+        self.fieldDefinition = ""
+
+        # le_ipc_PackString() checks the length against maxValue, so that the client only has to
+        # look through the string once.
+        self.maxValueCheck = ""
+
         self.clientPack = """\
-_msgBufPtr = PackString( _msgBufPtr, {parm.parmName} );\
+le_ipc_PackString( &_msgBufPtr, _msgBufEndPtr, {parm.parmName}, {parm.maxValue} );\
 """
 
+        # The server uses the string in place, in the message buffer.
         self.handlerUnpack = """\
-{parm.parmType} {parm.parmName};
-_msgBufPtr = UnpackString( _msgBufPtr, &{parm.name} );\
+{parm.parmType} {parm.parmName} = le_ipc_UnpackString( &_msgBufPtr, _msgBufEndPtr, {parm.maxValue} );\
 """
 
 
@@ -509,18 +545,15 @@ _msgBufPtr = UnpackString( _msgBufPtr, &{parm.name} );\
         self.unpackName = "%s[%s]" % (self.name, self.sizeVar)
         self.unpackAddr = self.name
 
-        # todo:
-        # Originally OUT strings were handled the same as any other data, and used the regular
-        # PackData and UnpackData functions, and thus these definitions were not necessary.
-        #
-        # However, this will not work for server-side async function support, since the Respond
-        # function does not (easily) have the necessary data size.  The solution is to use
-        # PackString() on the server side, and UnpackDataString() on the client side.  The one
-        # problem with this solution is if the server returns a string that is too long for the
-        # client buffer, the string will get truncated.  TBD whether it is acceptable to truncate
-        # the string in this case, or whether something else should be done.
+        # Strings follow the message's fields.
+        self.fieldDefinition = ""
+
+        # The Respond function of a server-side async function does not (easily) have the size of
+        # the client's buffer, so the server sends the string with its length, which can be up to
+        # the size given in the interface, and the client copies as much of it as fits in its
+        # buffer.  If the string is too long for the client's buffer, it gets truncated.
         self.asyncServerPack = """\
-_msgBufPtr = PackString( _msgBufPtr, {parm.unpackAddr} );\
+le_ipc_PackString( &_msgBufPtr, _msgBufEndPtr, {parm.unpackAddr}, {parm.baseMinSize} );\
 """
 
         # This is not strictly necessary, but ensures that strings get packed the same way
@@ -528,7 +561,7 @@ _msgBufPtr = PackString( _msgBufPtr, {parm.unpackAddr} );\
         self.handlerPack = self.asyncServerPack
 
         self.clientUnpack = """\
-_msgBufPtr = UnpackDataString( _msgBufPtr, {parm.address}, {parm.numBytes} );\
+le_ipc_UnpackStringCopy( &_msgBufPtr, _msgBufEndPtr, {parm.address}, {parm.numBytes} );\
 """
 
 
@@ -566,6 +599,7 @@ class VoidData(SimpleData):
         super(VoidData, self).__init__('', 'void')
 
         # Nothing to pack or unpack
+        self.fieldDefinition = ""
         self.clientPack = ""
         self.handlerUnpack = ""
 
@@ -611,6 +645,10 @@ class BaseFunctionData(object):
         """
         resultList = [ self.ClassName ]
 
+        # Client and server have to agree on whether there is a response.
+        if getattr(self, 'isOneWay', False):
+            resultList.append("ONE_WAY")
+
         # Some classes only have a type or a name, but not both.  It will be an empty string,
         # if not available
         if self.baseType:
@@ -648,6 +686,9 @@ class FunctionData(BaseFunctionData):
         self.addHandlerName = None
         self.isRemoveHandler = False
 
+        # One-way functions (see ONE_WAY) don't get a response from the server.
+        self.isOneWay = False
+
         if self.type != 'void':
             self.resultStorage = "%s _result;" % self.type
         else:
@@ -699,6 +740,11 @@ class FunctionData(BaseFunctionData):
                     if hasattr(p, 'minSize'):
                         sizeParm.minValue = p.minSize
 
+                    # The server can't trust the size it is sent, so if it is too big, the message
+                    # is treated as invalid (see le_ipc_UnpackArray()).
+                    sizeParm.handlerUnpack += """
+if ( {parm.name} > {parm.maxValue} ) _msgBufPtr = NULL;\
+"""
 
                     newParmList.append(sizeParm)
 
@@ -745,6 +791,16 @@ class FunctionData(BaseFunctionData):
                     if hasattr(p, 'minSize'):
                         sizeParm.minValue = p.minSize
 
+                        # The server never has to return more elements than the interface allows.
+                        sizeParm.handlerUnpack += """
+if ( {parm.name} > {parm.minValue} ) {parm.name} = {parm.minValue};\
+"""
+
+                    # The client only accepts as many elements as fit in its buffer.
+                    sizeParm.clientUnpack = """\
+if ( _rxFieldsPtr->{parm.name} > {parm.value} ) _msgBufPtr = NULL;
+{parm.value} = _rxFieldsPtr->{parm.name};\
+"""
 
                     # Add the parameter to the appropriate lists.  Note that it goes into both
                     # the IN and OUT lists, since it is an INOUT parameter.
@@ -776,6 +832,12 @@ class FunctionData(BaseFunctionData):
                     if hasattr(p, 'baseMinSize'):
                         sizeParm.baseMinValue = p.baseMinSize
 
+                    # The server never has to return a longer string than the interface allows.
+                    if hasattr(p, 'minSize'):
+                        sizeParm.handlerUnpack += """
+if ( {parm.name} > {parm.minValue} ) {parm.name} = {parm.minValue};\
+"""
+
                     newParmList.append(sizeParm)
 
                     inList.append(sizeParm)
@@ -808,6 +870,7 @@ class HandlerFunctionData(BaseFunctionData):
 
         # The contextPtr is always explicitly packed and unpacked, so don't need to do it with
         # the rest of the parameters for the handler.
+        contextParm.fieldDefinition = ""
         contextParm.handlerUnpack = ""
         contextParm.clientPack = ""
 
@@ -943,11 +1006,18 @@ class ImportData(object):
 # Hash related functions
 #--------------------------------------------------------------------------
 
+#
+# Version of the layout of the messages sent by the generated code.  It is part of the hash, so that
+# client and server code generated for different message layouts can't be used together.
+#
+WireFormatVersion = 2
+
 #
 # Generate a string representation of the interface, suitable for generating a hash/digest
 #
 def GetHashString(codeList):
-    hashString = '\n'.join ( c.getHashString() for c in codeList )
+    hashString = '\n'.join ( [ "WIRE_FORMAT %d" % WireFormatVersion ] +
+                             [ c.getHashString() for c in codeList ] )
     return hashString
 
 
@@ -52,6 +52,7 @@ StringReference = 'REFERENCE'
 StringDefine = 'DEFINE'
 StringEnum = 'ENUM'
 StringBitMask = 'BITMASK'
+StringOneWay = 'ONE_WAY'
 
 # Originally, the keyword was 'IMPORT', but this was changed to 'USETYPES' to better convey what
 # actually happens when importing a .api file.  Within the implementation, this is still called
@@ -67,6 +68,7 @@ KeywordReference = pyparsing.Keyword(StringReference)
 KeywordDefine = pyparsing.Keyword(StringDefine)
 KeywordEnum = pyparsing.Keyword(StringEnum)
 KeywordBitMask = pyparsing.Keyword(StringBitMask)
+KeywordOneWay = pyparsing.Keyword(StringOneWay)
 KeywordImport = pyparsing.Keyword(StringImport)
 
 # List of valid keywords, used when handling parser errors in FailFunc()
@@ -436,8 +438,20 @@ def ProcessFunc(tokens):
         tokens.comment
     )
 
+    if tokens.oneWay:
+        f.isOneWay = True
+
     return f
 
+def CheckOneWayFunc(tokens):
+    # The client doesn't wait for a one-way function, so there is nothing to send back to it.
+    if tokens.oneWay:
+        if ( tokens.functype != TokenNotSet or
+             [ p for p in tokens.body if getattr(p, 'direction', None) == codeTypes.DIR_OUT ] ):
+            raise pyparsing.ParseException(
+                "ONE_WAY function '%s' can't have a return type or OUT parameters" %
+                tokens.funcname)
+
 def MakeFuncExpr():
 
     # The expressions are checked in the given order, so the order must not be changed.
@@ -450,10 +464,14 @@ def MakeFuncExpr():
     body = MakeListExpr(all_parameters)
     # todo: Should this be ZeroOrMore comments, rather than just Optional?
     # todo: Should use something else other than pyparsing.cStyleComment
+    # The ONE_WAY check is done on the signature rather than on the whole expression, so that
+    # its error is reported by FailFunc().
+    signature = pyparsing.Optional(KeywordOneWay)("oneWay") + typeNameInfo + body("body")
+    signature.setParseAction(CheckOneWayFunc)
+
     all = ( pyparsing.Optional(pyparsing.cStyleComment)("comment")
             + KeywordFunction
-            + typeNameInfo
-            + body("body")
+            + signature
             + Semicolon )
     all.setParseAction(ProcessFunc)
     all.setFailAction(functools.partial(FailFunc, expected=StringFunction))
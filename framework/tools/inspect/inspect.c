@@ -5,7 +5,8 @@
  *
  * Must be run as root.
  *
- * @todo Only supports memory pools right now.  Add support for other timers, threads, etc.
+ * @todo Only supports memory pools, event loops and IPC servers right now.  Add support for timers, threads,
+ *       etc.
  *
  * @todo Add inspect by process name.
  *
@@ -14,6 +15,8 @@
 
 #include "legato.h"
 #include "mem.h"
+#include "eventLoop.h"
+#include "ipc.h"
 #include "limit.h"
 
 
@@ -25,6 +28,14 @@
 #define DEFAULT_REFRESH_INTERVAL            3
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * ASCII escape character, used to start the terminal control sequences that redraw the screen.
+ */
+//--------------------------------------------------------------------------------------------------
+#define ESCAPE_CHAR                         27
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * PID of the process to inspect.
@@ -61,10 +72,21 @@ static void PrintHelp
         "\n"
         "SYNOPSIS:\n"
         "    inspect pools [OPTIONS] PID\n"
+        "    inspect eventloops [OPTIONS] PID\n"
+        "    inspect ipc [OPTIONS] PID\n"
         "\n"
         "DESCRIPTION:\n"
         "    inspect pools              Prints the memory pools usage for the specified process. \n"
         "\n"
+        "    inspect eventloops         Prints the event loop statistics of each thread in the \n"
+        "                               specified process.  Handler run times are only \n"
+        "                               available if the process was started with the \n"
+        "                               LE_EVENT_STALL_MS environment variable set.\n"
+        "\n"
+        "    inspect ipc                Prints the number of calls to each function of each \n"
+        "                               IPC service that the specified process serves, and \n"
+        "                               the time spent handling them.\n"
+        "\n"
         "OPTIONS:\n"
         "    -f\n"
         "        Periodically prints updated information for the process.\n"
@@ -405,8 +427,6 @@ static void InspectMemoryPools
     pid_t pid           // The process to inspect.
 )
 {
-#define ESCAPE_CHAR         27
-
     // Create the memory pool iterator.
     le_result_t result;
     mem_Iter_Ref_t memIter = mem_iter_Create(pid, &result);
@@ -448,6 +468,255 @@ static void InspectMemoryPools
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets a human readable name for a kind of event handler.
+ *
+ * @return Pointer to the name.
+ */
+//--------------------------------------------------------------------------------------------------
+static const char* GetHandlerTypeName
+(
+    event_HandlerType_t type
+)
+{
+    switch (type)
+    {
+        case EVENT_HANDLER_QUEUED_FUNC:
+            return "queued";
+
+        case EVENT_HANDLER_PUB_SUB:
+            return "event";
+
+        case EVENT_HANDLER_FD:
+            return "fd";
+    }
+
+    return "?";
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Print one thread's event loop statistics to stdout.
+ *
+ * @return
+ *      The number of lines printed.
+ */
+//--------------------------------------------------------------------------------------------------
+static int PrintEventLoopInfo
+(
+    const event_LoopStats_t* statsPtr
+)
+{
+    int lineCount = 0;
+    size_t i;
+
+    printf("\n");
+    lineCount++;
+
+    printf("Thread '%s': %"PRIu64" wake-ups, %"PRIu64" reports, %"PRIu64" fd events, "
+           "queue high-water %"PRIu64"\n",
+           statsPtr->threadName, statsPtr->numWakeUps, statsPtr->numReports,
+           statsPtr->numFdEvents, statsPtr->queueHighWater);
+    lineCount++;
+
+    if (statsPtr->stallThresholdNs == 0)
+    {
+        printf("    (Handler profiling is off.)\n");
+        lineCount++;
+
+        return lineCount;
+    }
+
+    printf("    %"PRIu64" stalls over %"PRIu64" ms, %"PRIu64" calls not profiled\n",
+           statsPtr->numStalls, statsPtr->stallThresholdNs / 1000000,
+           statsPtr->numUnprofiledCalls);
+    lineCount++;
+
+    printf("    %10s %12s %10s %10s  %-6s  %s\n",
+           "CALLS", "TOTAL us", "AVG us", "MAX us", "TYPE", "HANDLER");
+    lineCount++;
+
+    for (i = 0; i < EVENT_MAX_PROFILED_HANDLERS; i++)
+    {
+        const event_HandlerStats_t* handlerPtr = &statsPtr->handlers[i];
+
+        if ((handlerPtr->funcPtr != NULL) && (handlerPtr->numCalls > 0))
+        {
+            printf("    %10"PRIu64" %12"PRIu64" %10"PRIu64" %10"PRIu64"  %-6s  %p\n",
+                   handlerPtr->numCalls,
+                   handlerPtr->totalNs / 1000,
+                   (handlerPtr->totalNs / handlerPtr->numCalls) / 1000,
+                   handlerPtr->maxNs / 1000,
+                   GetHandlerTypeName(handlerPtr->type),
+                   handlerPtr->funcPtr);
+            lineCount++;
+        }
+    }
+
+    return lineCount;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Inspects the event loops of the threads in the specified process.  Prints the results to stdout.
+ */
+//--------------------------------------------------------------------------------------------------
+static void InspectEventLoops
+(
+    pid_t pid           // The process to inspect.
+)
+{
+    // Create the event loop statistics iterator.
+    le_result_t result;
+    event_Iter_Ref_t iter = event_iter_Create(pid, &result);
+
+    if (iter == NULL)
+    {
+        if (result == LE_NOT_POSSIBLE)
+        {
+            fprintf(stderr, "The specified process is not a Legato process.\n");
+        }
+        else
+        {
+             fprintf(stderr, "Could not access specified process.\n");
+        }
+        exit(EXIT_FAILURE);
+    }
+
+    // Print header information.
+    static int lineCount = 0;
+
+    printf("%c[1G", ESCAPE_CHAR);   // Move cursor to the column 1.
+    printf("%c[%dA", ESCAPE_CHAR, lineCount); // Move cursor up to the top of the table.
+    printf("%c[0J", ESCAPE_CHAR);    // Clear Screen.
+
+    printf("\nLegato Event Loop Inspector\nInspecting process %d\n", pid);
+    lineCount = 3;
+
+    // Iterate through the list of threads.
+    const event_LoopStats_t* statsPtr = event_iter_GetNextLoop(iter);
+
+    while (statsPtr != NULL)
+    {
+        lineCount += PrintEventLoopInfo(statsPtr);
+
+        statsPtr = event_iter_GetNextLoop(iter);
+    }
+
+    event_iter_Delete(iter);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Print the call statistics of one IPC server's functions to stdout.
+ *
+ * @return
+ *      The number of lines printed.
+ */
+//--------------------------------------------------------------------------------------------------
+static int PrintIpcServerInfo
+(
+    ipc_Iter_Ref_t iter,        // Iterator positioned on the server.
+    const char* serviceName     // The server's service name.
+)
+{
+    int lineCount = 0;
+    uint64_t totalCalls = 0;
+    le_ipc_ServerFuncStats_t funcStats;
+
+    printf("\n");
+    lineCount++;
+
+    printf("Service '%s'\n", serviceName);
+    lineCount++;
+
+    printf("    %10s %12s %10s  %s\n", "CALLS", "TOTAL us", "AVG us", "FUNCTION");
+    lineCount++;
+
+    const char* funcName = ipc_iter_GetNextFunc(iter, &funcStats);
+
+    while (funcName != NULL)
+    {
+        if (funcStats.numCalls > 0)
+        {
+            printf("    %10"PRIu64" %12"PRIu64" %10"PRIu64"  %s\n",
+                   funcStats.numCalls,
+                   funcStats.totalNs / 1000,
+                   (funcStats.totalNs / funcStats.numCalls) / 1000,
+                   funcName);
+            lineCount++;
+
+            totalCalls += funcStats.numCalls;
+        }
+
+        funcName = ipc_iter_GetNextFunc(iter, &funcStats);
+    }
+
+    if (totalCalls == 0)
+    {
+        printf("    (No calls yet.)\n");
+        lineCount++;
+    }
+
+    return lineCount;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Inspects the IPC servers in the specified process.  Prints the results to stdout.
+ */
+//--------------------------------------------------------------------------------------------------
+static void InspectIpc
+(
+    pid_t pid           // The process to inspect.
+)
+{
+    // Create the IPC server iterator.
+    le_result_t result;
+    ipc_Iter_Ref_t iter = ipc_iter_Create(pid, &result);
+
+    if (iter == NULL)
+    {
+        if (result == LE_NOT_POSSIBLE)
+        {
+            fprintf(stderr, "The specified process is not a Legato process.\n");
+        }
+        else
+        {
+             fprintf(stderr, "Could not access specified process.\n");
+        }
+        exit(EXIT_FAILURE);
+    }
+
+    // Print header information.
+    static int lineCount = 0;
+
+    printf("%c[1G", ESCAPE_CHAR);   // Move cursor to the column 1.
+    printf("%c[%dA", ESCAPE_CHAR, lineCount); // Move cursor up to the top of the table.
+    printf("%c[0J", ESCAPE_CHAR);    // Clear Screen.
+
+    printf("\nLegato IPC Inspector\nInspecting process %d\n", pid);
+    lineCount = 3;
+
+    // Iterate through the list of servers.
+    const char* serviceName = ipc_iter_GetNextServer(iter);
+
+    while (serviceName != NULL)
+    {
+        lineCount += PrintIpcServerInfo(iter, serviceName);
+
+        serviceName = ipc_iter_GetNextServer(iter);
+    }
+
+    ipc_iter_Delete(iter);
+}
+
+
 COMPONENT_INIT
 {
     if (IsOptionSelected("--help"))
@@ -464,6 +733,14 @@ COMPONENT_INIT
     {
         inspectFunc = InspectMemoryPools;
     }
+    else if (IsOptionSelected("eventloops"))
+    {
+        inspectFunc = InspectEventLoops;
+    }
+    else if (IsOptionSelected("ipc"))
+    {
+        inspectFunc = InspectIpc;
+    }
     else
     {
         fprintf(stderr, "Missing required command parameter.\n");